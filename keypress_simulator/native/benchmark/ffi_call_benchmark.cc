@@ -0,0 +1,68 @@
+// Measures an action through the exported ks_key() function, down to the
+// InjectionWorker post of an empty task. This is the native cost only. It is
+// not a comparison with the simulateAction method channel, which cannot run
+// here, and the dart:ffi call around ks_key() is not included.
+//
+// Run: ./ffi_call_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "keypress_simulator_core/ffi_bridge.h"
+#include "keypress_simulator_core/injection_worker.h"
+
+using keypress_simulator_core::ActionId;
+using keypress_simulator_core::ChordPhase;
+using keypress_simulator_core::FfiBackend;
+using keypress_simulator_core::InjectionWorker;
+
+namespace {
+
+constexpr int kCalls = 100000;
+constexpr ActionId kAction = 7;
+
+// What the plugins do for an action: post its keys.
+class BenchmarkBackend : public FfiBackend {
+ public:
+  explicit BenchmarkBackend(InjectionWorker* worker) : worker_(worker) {}
+
+  int32_t Key(ActionId id, ChordPhase phase, TimePoint origin) override {
+    while (!worker_->Post([] { return true; })) {
+      std::this_thread::yield();
+    }
+    return KS_OK;
+  }
+  int32_t Click(double x, double y, bool down) override { return KS_OK; }
+
+ private:
+  InjectionWorker* worker_;
+};
+
+double MeasureFfi() {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kCalls; i++) {
+    if (ks_key(static_cast<int32_t>(kAction), KS_KEY_TAP) != KS_OK) {
+      fprintf(stderr, "ks_key failed\n");
+    }
+  }
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kCalls;
+}
+
+}  // namespace
+
+int main() {
+  InjectionWorker worker;
+  BenchmarkBackend backend(&worker);
+  keypress_simulator_core::InstallFfiBackend(&backend);
+
+  double ffi = MeasureFfi();
+
+  keypress_simulator_core::UninstallFfiBackend(&backend);
+  printf("calls: %d\n", kCalls);
+  printf("ks_key (ffi):  %10.3f us/call\n", ffi);
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Compares the compile-time key table with the runtime lookups the plugins
+// used to do: a string-keyed std::unordered_map for media keys and an if
+// chain for the extended-key flag, plus a hash map of the same table.
+//
+// Run: ./key_table_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "keypress_simulator_core/key_table.h"
+
+using keypress_simulator_core::KeyCodes;
+using keypress_simulator_core::kKeyTable;
+
+namespace {
+
+constexpr int kLookups = 1000000;
+
+// Keeps the compiler from optimising the lookups away.
+volatile uint32_t g_sink;
+
+template <typename Fn>
+double MeasureNanos(Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kLookups; i++) {
+    fn(i);
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kLookups;
+}
+
+// The extended-key check the Windows plugin used to do.
+bool IsExtendedKey(uint32_t vk) {
+  return vk == 0x25 || vk == 0x27 || vk == 0x26 || vk == 0x28 || vk == 0x2D ||
+         vk == 0x2E || vk == 0x24 || vk == 0x23 || vk == 0x21 || vk == 0x22;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<uint32_t> physical_keys;
+  std::vector<uint32_t> virtual_keys;
+  std::unordered_map<uint32_t, KeyCodes> by_physical_key;
+  for (const auto& entry : kKeyTable) {
+    physical_keys.push_back(entry.physical_key);
+    by_physical_key.emplace(entry.physical_key, entry.codes);
+    if (entry.codes.windows_vk != 0) {
+      virtual_keys.push_back(entry.codes.windows_vk);
+    }
+  }
+  const std::unordered_map<std::string, uint32_t> media_map = {
+      {"playPause", 0xB3}, {"stop", 0xB2},     {"next", 0xB0},
+      {"previous", 0xB1},  {"volumeUp", 0xAF}, {"volumeDown", 0xAE}};
+  const std::vector<std::string> media_names = {
+      "playPause", "stop", "next", "previous", "volumeUp", "volumeDown"};
+
+  double table = MeasureNanos([&](int i) {
+    const KeyCodes* codes = keypress_simulator_core::KeyCodesForPhysicalKey(
+        physical_keys[i % physical_keys.size()]);
+    g_sink = codes->evdev;
+  });
+  double hash = MeasureNanos([&](int i) {
+    g_sink = by_physical_key.find(physical_keys[i % physical_keys.size()])
+                 ->second.evdev;
+  });
+  double extended_table = MeasureNanos([&](int i) {
+    g_sink = keypress_simulator_core::KeyCodesForVirtualKey(
+                 virtual_keys[i % virtual_keys.size()])
+                 ->windows_extended;
+  });
+  double extended_chain = MeasureNanos([&](int i) {
+    g_sink = IsExtendedKey(virtual_keys[i % virtual_keys.size()]);
+  });
+  double media_table = MeasureNanos([&](int i) {
+    g_sink = keypress_simulator_core::KeyCodesForMediaKey(
+                 media_names[i % media_names.size()])
+                 ->windows_vk;
+  });
+  double media_hash = MeasureNanos([&](int i) {
+    g_sink = media_map.find(media_names[i % media_names.size()])->second;
+  });
+
+  printf("keys: %zu, lookups: %d\n", std::size(kKeyTable), kLookups);
+  printf("%-26s %10.3f ns/lookup\n", "physical key (table):", table);
+  printf("%-26s %10.3f ns/lookup\n", "physical key (hash map):", hash);
+  printf("%-26s %10.3f ns/lookup\n", "extended flag (table):", extended_table);
+  printf("%-26s %10.3f ns/lookup\n", "extended flag (if chain):",
+         extended_chain);
+  printf("%-26s %10.3f ns/lookup\n", "media key (table):", media_table);
+  printf("%-26s %10.3f ns/lookup\n", "media key (hash map):", media_hash);
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "keypress_simulator_core/drag_gesture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace keypress_simulator_core {
+
+bool EasingFromName(const std::string& name, Easing* easing) {
+  if (name == "linear") {
+    *easing = Easing::kLinear;
+  } else if (name == "easeIn") {
+    *easing = Easing::kEaseIn;
+  } else if (name == "easeOut") {
+    *easing = Easing::kEaseOut;
+  } else if (name == "easeInOut") {
+    *easing = Easing::kEaseInOut;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+double ApplyEasing(Easing easing, double t) {
+  t = std::clamp(t, 0.0, 1.0);
+  switch (easing) {
+    case Easing::kLinear:
+      return t;
+    case Easing::kEaseIn:
+      return t * t * t;
+    case Easing::kEaseOut: {
+      double u = 1 - t;
+      return 1 - u * u * u;
+    }
+    case Easing::kEaseInOut:
+      if (t < 0.5) {
+        return 4 * t * t * t;
+      } else {
+        double u = -2 * t + 2;
+        return 1 - u * u * u / 2;
+      }
+  }
+  return t;
+}
+
+const char* BuildDragGesture(const double* xy,
+                             size_t count,
+                             int64_t duration_ms,
+                             const std::string& easing,
+                             DragGesture* gesture) {
+  if (count < 2 || count % 2 != 0) {
+    return "path must hold at least one x, y pair";
+  }
+  if (count / 2 > kMaxDragPathPoints) {
+    return "path has too many points";
+  }
+  if (duration_ms < 0 || duration_ms > kMaxDragDuration.count()) {
+    return "durationMs is out of range";
+  }
+  if (!EasingFromName(easing, &gesture->easing)) {
+    return "Unknown easing";
+  }
+  gesture->path.clear();
+  for (size_t i = 0; i < count; i += 2) {
+    gesture->path.push_back({xy[i], xy[i + 1]});
+  }
+  gesture->duration = std::chrono::milliseconds(duration_ms);
+  return nullptr;
+}
+
+DragPlan::DragPlan(const DragGesture& gesture,
+                   std::chrono::milliseconds interval)
+    : path_(gesture.path),
+      duration_(gesture.duration),
+      easing_(gesture.easing) {
+  cumulative_.reserve(path_.size());
+  double length = 0;
+  for (size_t i = 0; i < path_.size(); i++) {
+    if (i > 0) {
+      length += std::hypot(path_[i].x - path_[i - 1].x,
+                           path_[i].y - path_[i - 1].y);
+    }
+    cumulative_.push_back(length);
+  }
+
+  auto ticks = interval.count() > 0 ? duration_ / interval : 0;
+  steps_ = std::max<size_t>(1, static_cast<size_t>(ticks));
+}
+
+std::chrono::nanoseconds DragPlan::TimeOf(size_t i) const {
+  return duration_ * static_cast<int64_t>(std::min(i, steps_)) /
+         static_cast<int64_t>(steps_);
+}
+
+PointF DragPlan::PointOf(size_t i) const {
+  double t = static_cast<double>(std::min(i, steps_)) / steps_;
+  return PointAtDistance(ApplyEasing(easing_, t) * cumulative_.back());
+}
+
+PointF DragPlan::PointAtDistance(double distance) const {
+  // First vertex at or beyond |distance|; the point lies on the segment
+  // leading up to it.
+  auto it = std::lower_bound(cumulative_.begin(), cumulative_.end(), distance);
+  if (it == cumulative_.begin()) {
+    return path_.front();
+  }
+  if (it == cumulative_.end()) {
+    return path_.back();
+  }
+  size_t i = it - cumulative_.begin();
+  double segment = cumulative_[i] - cumulative_[i - 1];
+  double f = segment > 0 ? (distance - cumulative_[i - 1]) / segment : 1;
+  return {path_[i - 1].x + (path_[i].x - path_[i - 1].x) * f,
+          path_[i - 1].y + (path_[i].y - path_[i - 1].y) * f};
+}
+
+DragClock::TimePoint SteadyDragClock::Now() {
+  return std::chrono::steady_clock::now();
+}
+
+void SteadyDragClock::SleepUntil(TimePoint deadline) {
+  std::this_thread::sleep_until(deadline);
+}
+
+bool PerformDrag(const DragGesture& gesture,
+                 PointerSink* sink,
+                 DragClock* clock,
+                 std::chrono::milliseconds interval) {
+  DragPlan plan(gesture, interval);
+  const DragClock::TimePoint start = clock->Now();
+  if (!sink->Button(plan.PointOf(0), true)) {
+    return false;
+  }
+  bool succeeded = true;
+  for (size_t i = 1; i <= plan.steps() && succeeded; i++) {
+    clock->SleepUntil(start + plan.TimeOf(i));
+    succeeded = sink->Move(plan.PointOf(i));
+  }
+  // Never leave the button held, even if a move failed.
+  return sink->Button(plan.PointOf(plan.steps()), false) && succeeded;
+}
+
+}  // namespace keypress_simulator_core
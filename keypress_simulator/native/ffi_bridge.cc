@@ -0,0 +1,96 @@
+#include "keypress_simulator_core/ffi_bridge.h"
+
+#include <cmath>
+
+#include "keypress_simulator_core/latency_stats.h"
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// Guarded by FfiBridgeMutex().
+FfiBackend* g_backend = nullptr;
+
+// The ks_* functions, once their arguments are checked.
+int32_t CallKey(ActionId id, ChordPhase phase, int64_t origin_micros) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_backend == nullptr) {
+    return KS_ERROR_UNAVAILABLE;
+  }
+  return g_backend->Key(id, phase, LatencyOriginFromMicros(origin_micros));
+}
+
+int32_t CallClick(double x, double y, bool down) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_backend == nullptr) {
+    return KS_ERROR_UNAVAILABLE;
+  }
+  return g_backend->Click(x, y, down);
+}
+
+}  // namespace
+
+std::mutex& FfiBridgeMutex() {
+  // Never destroyed: ks_* may still be called while the process exits.
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+void InstallFfiBackend(FfiBackend* backend) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  g_backend = backend;
+}
+
+void UninstallFfiBackend(FfiBackend* backend) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_backend == backend) {
+    g_backend = nullptr;
+  }
+}
+
+}  // namespace keypress_simulator_core
+
+using keypress_simulator_core::ActionId;
+using keypress_simulator_core::ChordPhase;
+
+extern "C" {
+
+int32_t ks_abi_version(void) {
+  return KS_ABI_VERSION;
+}
+
+int32_t ks_key(int32_t action_id, int32_t down) {
+  return ks_key_traced(action_id, down, 0);
+}
+
+int32_t ks_key_traced(int32_t action_id, int32_t down, int64_t origin_micros) {
+  ChordPhase phase;
+  switch (down) {
+    case KS_KEY_UP:
+      phase = ChordPhase::kUp;
+      break;
+    case KS_KEY_DOWN:
+      phase = ChordPhase::kDown;
+      break;
+    case KS_KEY_TAP:
+      phase = ChordPhase::kTap;
+      break;
+    default:
+      return KS_ERROR_INVALID_ARGUMENT;
+  }
+  if (action_id < 0 || static_cast<ActionId>(action_id) >=
+                           keypress_simulator_core::kMaxActionId) {
+    return KS_ERROR_INVALID_ARGUMENT;
+  }
+  return keypress_simulator_core::CallKey(
+      static_cast<ActionId>(action_id), phase, origin_micros);
+}
+
+int32_t ks_click(double x, double y, int32_t down) {
+  if (!std::isfinite(x) || !std::isfinite(y)) {
+    return KS_ERROR_INVALID_ARGUMENT;
+  }
+  return keypress_simulator_core::CallClick(x, y, down != 0);
+}
+
+}  // extern "C"
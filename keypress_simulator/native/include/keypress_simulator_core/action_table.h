@@ -0,0 +1,134 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_ACTION_TABLE_H_
+#define KEYPRESS_SIMULATOR_CORE_ACTION_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "keypress_simulator_core/input_batch.h"
+
+namespace keypress_simulator_core {
+
+// Identifies a chord uploaded with registerKeymap. IDs are small and dense:
+// the Dart side numbers the key pairs of the active keymap.
+using ActionId = uint32_t;
+
+// Upper bound for action IDs, so a bogus registration cannot make the table
+// allocate without limit.
+constexpr ActionId kMaxActionId = 4096;
+
+// simulateAction carries a single integer: the action ID shifted left by two
+// with the ChordPhase in the low bits. A bare integer is the cheapest value
+// for the standard codec to encode and decode.
+constexpr int64_t EncodeActionCall(ActionId id, ChordPhase phase) {
+  return (static_cast<int64_t>(id) << 2) | static_cast<int64_t>(phase);
+}
+
+// Returns false if |value| is not a valid simulateAction argument.
+inline bool DecodeActionCall(int64_t value, ActionId* id, ChordPhase* phase) {
+  if (value < 0 || (value & 3) > static_cast<int64_t>(ChordPhase::kTap) ||
+      (value >> 2) >= kMaxActionId) {
+    return false;
+  }
+  *id = static_cast<ActionId>(value >> 2);
+  *phase = static_cast<ChordPhase>(value & 3);
+  return true;
+}
+
+// Chords compiled once at registration, so a key press only costs an array
+// lookup. |Event| is whatever the backend submits to the OS: a KeyTransition
+// for uinput, or a transition with its scan code already resolved on Windows.
+//
+// The press events of an action are stored directly before its release
+// events, so every phase is a single contiguous range.
+template <typename Event>
+class ActionTable {
+ public:
+  struct Range {
+    const Event* data = nullptr;
+    size_t size = 0;
+
+    const Event* begin() const { return data; }
+    const Event* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+  };
+
+  void Clear() {
+    slots_.clear();
+    events_.clear();
+  }
+
+  // Compiles the chord for |id|. |resolve| maps each KeyTransition of the
+  // chord to an Event and is only called here. Returns false if |id| is out
+  // of range.
+  template <typename Resolve>
+  bool SetChord(ActionId id,
+                uint8_t modifiers,
+                uint16_t code,
+                const ModifierKeyCodes& modifier_codes,
+                Resolve resolve) {
+    if (id >= kMaxActionId) {
+      return false;
+    }
+    KeyBatchBuilder batch(modifier_codes);
+    batch.AddChord(modifiers, code, ChordPhase::kDown);
+    const size_t press_count = batch.size();
+    batch.AddChord(modifiers, code, ChordPhase::kUp);
+
+    if (id >= slots_.size()) {
+      slots_.resize(id + 1);
+    }
+    Slot& slot = slots_[id];
+    slot.offset = events_.size();
+    slot.press_count = press_count;
+    slot.release_count = batch.size() - press_count;
+    slot.registered = true;
+    for (const KeyTransition& transition : batch.transitions()) {
+      events_.push_back(resolve(transition));
+    }
+    return true;
+  }
+
+  bool Contains(ActionId id) const {
+    return id < slots_.size() && slots_[id].registered;
+  }
+
+  // Returns the events for |phase| of |id|, or an empty range if |id| was
+  // never registered.
+  Range Get(ActionId id, ChordPhase phase) const {
+    if (!Contains(id)) {
+      return Range();
+    }
+    const Slot& slot = slots_[id];
+    Range range;
+    range.data = events_.data() + slot.offset;
+    switch (phase) {
+      case ChordPhase::kDown:
+        range.size = slot.press_count;
+        break;
+      case ChordPhase::kUp:
+        range.data += slot.press_count;
+        range.size = slot.release_count;
+        break;
+      case ChordPhase::kTap:
+        range.size = slot.press_count + slot.release_count;
+        break;
+    }
+    return range;
+  }
+
+ private:
+  struct Slot {
+    size_t offset = 0;
+    size_t press_count = 0;
+    size_t release_count = 0;
+    bool registered = false;
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<Event> events_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_ACTION_TABLE_H_
@@ -0,0 +1,130 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_DRAG_GESTURE_H_
+#define KEYPRESS_SIMULATOR_CORE_DRAG_GESTURE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace keypress_simulator_core {
+
+// Speed profile of a drag, as sent by Dart (`DragEasing.name`).
+enum class Easing {
+  kLinear,
+  kEaseIn,
+  kEaseOut,
+  kEaseInOut,
+};
+
+// Parses "linear", "easeIn", "easeOut" or "easeInOut". Returns false for
+// anything else.
+bool EasingFromName(const std::string& name, Easing* easing);
+
+// Maps progress in time |t| in [0, 1] to progress along the path (cubic
+// curves).
+double ApplyEasing(Easing easing, double t);
+
+struct PointF {
+  double x;
+  double y;
+};
+
+// Time between two pointer moves: 125 Hz, smooth for trainer apps without
+// flooding the input queue.
+constexpr std::chrono::milliseconds kDragInterval(8);
+
+// Limits for a single simulateDrag call, so a bogus request cannot hold the
+// injection worker for long.
+constexpr std::chrono::milliseconds kMaxDragDuration(10000);
+constexpr size_t kMaxDragPathPoints = 256;
+
+struct DragGesture {
+  // Polyline in screen coordinates; the pointer follows it at constant speed
+  // (before easing) regardless of how the points are spaced.
+  std::vector<PointF> path;
+  std::chrono::milliseconds duration{0};
+  Easing easing = Easing::kEaseInOut;
+};
+
+// Fills |gesture| from the simulateDrag arguments: |xy| holds |count|
+// interleaved x, y coordinates. Returns nullptr on success, or a message for
+// an INVALID_ARGUMENT error if the path is empty or too long, the duration is
+// out of range or the easing is unknown.
+const char* BuildDragGesture(const double* xy,
+                             size_t count,
+                             int64_t duration_ms,
+                             const std::string& easing,
+                             DragGesture* gesture);
+
+// The samples of a drag: sample 0 is the press at the start of the path and
+// the last one lies on its end, evenly spaced in time.
+class DragPlan {
+ public:
+  // |gesture| must have at least one point.
+  explicit DragPlan(const DragGesture& gesture,
+                    std::chrono::milliseconds interval = kDragInterval);
+
+  // Index of the last sample; there are steps() + 1 samples in total.
+  size_t steps() const { return steps_; }
+
+  // Offset of sample |i| from the start of the drag.
+  std::chrono::nanoseconds TimeOf(size_t i) const;
+
+  PointF PointOf(size_t i) const;
+
+ private:
+  // Point at |distance| along the path.
+  PointF PointAtDistance(double distance) const;
+
+  std::vector<PointF> path_;
+  // cumulative_[i] is the length of the path up to path_[i].
+  std::vector<double> cumulative_;
+  std::chrono::nanoseconds duration_;
+  Easing easing_;
+  size_t steps_;
+};
+
+// Receives the pointer events of a drag. Returning false aborts it.
+class PointerSink {
+ public:
+  virtual ~PointerSink() = default;
+
+  virtual bool Move(const PointF& point) = 0;
+  // Moves to |point| and presses or releases the primary button.
+  virtual bool Button(const PointF& point, bool down) = 0;
+};
+
+// Where a drag gets its time from. Tests substitute a fake clock that
+// advances when slept on.
+class DragClock {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~DragClock() = default;
+
+  virtual TimePoint Now() = 0;
+  virtual void SleepUntil(TimePoint deadline) = 0;
+};
+
+// std::chrono::steady_clock with std::this_thread::sleep_until(), which is
+// precise enough on Linux.
+class SteadyDragClock : public DragClock {
+ public:
+  TimePoint Now() override;
+  void SleepUntil(TimePoint deadline) override;
+};
+
+// Presses at the start of the path, moves along it at a steady rate and
+// releases at its end. Every sample is scheduled against the start time, so
+// a late wake-up does not delay the rest of the drag. Runs on the calling
+// thread, i.e. the injection worker. Returns false if the sink failed; the
+// button is still released in that case.
+bool PerformDrag(const DragGesture& gesture,
+                 PointerSink* sink,
+                 DragClock* clock,
+                 std::chrono::milliseconds interval = kDragInterval);
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_DRAG_GESTURE_H_
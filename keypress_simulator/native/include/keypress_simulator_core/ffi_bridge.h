@@ -0,0 +1,45 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_FFI_BRIDGE_H_
+#define KEYPRESS_SIMULATOR_CORE_FFI_BRIDGE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "keypress_simulator_core/action_table.h"
+#include "keypress_simulator_core/keypress_simulator_ffi.h"
+
+namespace keypress_simulator_core {
+
+// What the exported ks_* functions call into: implemented by each plugin on
+// top of its action table and injection worker. Returns KS_OK or one of the
+// KS_ERROR_* codes.
+//
+// Calls are made with FfiBridgeMutex() held, so they never overlap with each
+// other or with the plugin's method call handler.
+class FfiBackend {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~FfiBackend() = default;
+
+  virtual int32_t Key(ActionId id, ChordPhase phase, TimePoint origin) = 0;
+  virtual int32_t Click(double x, double y, bool down) = 0;
+};
+
+// Routes the ks_* functions to |backend| until UninstallFfiBackend(). Only
+// one backend is installed at a time; a second plugin instance replaces the
+// first.
+void InstallFfiBackend(FfiBackend* backend);
+
+// Does nothing if |backend| has been replaced since.
+void UninstallFfiBackend(FfiBackend* backend);
+
+// Held by every ks_* call. The plugin holds it while handling a method call,
+// so FFI callers on the Dart UI thread and channel calls on the platform
+// thread take turns at the action table and at the single-producer
+// injection queue.
+std::mutex& FfiBridgeMutex();
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_FFI_BRIDGE_H_
@@ -0,0 +1,108 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_INJECTION_WORKER_H_
+#define KEYPRESS_SIMULATOR_CORE_INJECTION_WORKER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "keypress_simulator_core/latency_stats.h"
+#include "keypress_simulator_core/repeat_scheduler.h"
+#include "keypress_simulator_core/spsc_queue.h"
+
+namespace keypress_simulator_core {
+
+// Runs input injection on a dedicated thread, so SendInput(), focus changes
+// and uinput writes never block the Flutter platform thread.
+//
+// Tasks are posted from a single thread (the platform thread) and run one at
+// a time in the order they were posted, so a key down can never overtake its
+// key up. Anything a task needs must be captured by value: the platform
+// thread may change plugin state while the task is still queued.
+//
+// The worker also times the repeats of held buttons: between tasks it sleeps
+// until the next repeat is due, so repeats are ordered with the other input
+// and need no thread of their own.
+//
+// Every posted task is timed into latency(): how long it waited in the queue,
+// how long it ran, and, when the caller passes the time the input originated,
+// how long it took to reach the worker.
+class InjectionWorker {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+  // Returns whether the injection succeeded.
+  using Task = std::function<bool()>;
+  // Called on the worker thread with the task's result.
+  using Completion = std::function<void(bool)>;
+
+  static constexpr size_t kQueueCapacity = 256;
+
+  InjectionWorker();
+  ~InjectionWorker();
+
+  InjectionWorker(const InjectionWorker&) = delete;
+  InjectionWorker& operator=(const InjectionWorker&) = delete;
+
+  // Queues |task|. Returns false if kQueueCapacity tasks are already
+  // pending; the task is then dropped without running. |origin| is when the
+  // input that caused the task happened, if known.
+  bool Post(Task task,
+            Completion on_done = nullptr,
+            TimePoint origin = TimePoint());
+
+  // Runs |tick| every |interval| from |initial_delay| after now, until
+  // StopRepeat(id) or Stop(). Starting a repeat for an |id| that is already
+  // repeating restarts it. Start and stop requests are queued like tasks, so
+  // a StopRepeat() posted before a key up takes effect before it. Returns
+  // false if the queue is full; the timing must be valid (see
+  // IsValidRepeatTiming()).
+  bool StartRepeat(ActionId id,
+                   std::chrono::milliseconds initial_delay,
+                   std::chrono::milliseconds interval,
+                   Task tick,
+                   Completion on_done = nullptr);
+  bool StopRepeat(ActionId id);
+
+  // Runs the tasks that are still queued and joins the worker thread. Post()
+  // must not be called afterwards.
+  void Stop();
+
+  // Safe to read and reset from any thread.
+  LatencyRecorder& latency() { return latency_; }
+
+ private:
+  struct Job {
+    Task task;
+    Completion on_done;
+    // Left default-constructed for the worker's own bookkeeping jobs, which
+    // are not timed.
+    TimePoint origin;
+    TimePoint enqueued;
+  };
+
+  bool Enqueue(Job job);
+  void Run();
+
+  SpscQueue<Job, kQueueCapacity> queue_;
+
+  // Only touched on the worker thread.
+  RepeatScheduler repeats_;
+
+  // The worker sleeps on |wake_| when the queue is empty, until the next
+  // repeat is due. |waiting_| lets
+  // Post() skip the mutex while the worker is busy.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::atomic<bool> waiting_{false};
+  std::atomic<bool> stopping_{false};
+
+  LatencyRecorder latency_;
+
+  std::thread thread_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_INJECTION_WORKER_H_
@@ -0,0 +1,69 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_INPUT_BATCH_H_
+#define KEYPRESS_SIMULATOR_CORE_INPUT_BATCH_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "keypress_simulator_core/key_codes.h"
+
+namespace keypress_simulator_core {
+
+// A single key transition to inject, in platform key codes (a Windows
+// virtual-key code or a Linux evdev code).
+struct KeyTransition {
+  uint16_t code;
+  bool down;
+
+  bool operator==(const KeyTransition& other) const {
+    return code == other.code && down == other.down;
+  }
+};
+
+// What a chord does with its key. The values are part of the
+// simulateAction wire format (see action_table.h).
+enum class ChordPhase : uint8_t {
+  kDown = 0,  // modifiers down, key down
+  kUp = 1,    // key up, modifiers up
+  kTap = 2,   // both of the above
+};
+
+// Platform key codes for each entry of kModifierOrder.
+using ModifierKeyCodes = std::array<uint16_t, 4>;
+
+// Assembles chords and macros into one contiguous list of transitions, so a
+// backend can submit them with a single SendInput(2)/write(2) and no other
+// input can interleave between a modifier and its key.
+//
+// Modifiers are pressed in kModifierOrder and released in reverse, so nested
+// chords unwind like a stack.
+class KeyBatchBuilder {
+ public:
+  explicit KeyBatchBuilder(const ModifierKeyCodes& modifier_codes)
+      : modifier_codes_(modifier_codes) {}
+
+  // |modifiers| is a mask of Modifier flags.
+  void AddChord(uint8_t modifiers, uint16_t code, ChordPhase phase);
+
+  void AddKey(uint16_t code, bool down) {
+    transitions_.push_back({code, down});
+  }
+
+  const std::vector<KeyTransition>& transitions() const {
+    return transitions_;
+  }
+  size_t size() const { return transitions_.size(); }
+  bool empty() const { return transitions_.empty(); }
+
+  void Clear() { transitions_.clear(); }
+
+ private:
+  void AddModifiers(uint8_t modifiers, bool down);
+
+  ModifierKeyCodes modifier_codes_;
+  std::vector<KeyTransition> transitions_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_INPUT_BATCH_H_
@@ -0,0 +1,40 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_KEY_CODES_H_
+#define KEYPRESS_SIMULATOR_CORE_KEY_CODES_H_
+
+#include <cstdint>
+#include <string>
+
+namespace keypress_simulator_core {
+
+// Bit flags for the modifier keys Dart sends as `ModifierKey.name`.
+enum Modifier : uint8_t {
+  kModifierNone = 0,
+  kModifierShift = 1 << 0,
+  kModifierControl = 1 << 1,
+  kModifierAlt = 1 << 2,
+  kModifierMeta = 1 << 3,
+};
+
+// Order in which modifiers are pressed; they are released in reverse.
+constexpr Modifier kModifierOrder[] = {kModifierShift, kModifierControl,
+                                       kModifierAlt, kModifierMeta};
+
+// Parses a Flutter modifier name such as "shiftModifier". Unknown names
+// (e.g. "functionModifier", which has no key of its own) map to
+// kModifierNone.
+Modifier ModifierFromName(const std::string& name);
+
+// Translates a Flutter physical key id (`PhysicalKeyboardKey.usbHidUsage`) to
+// a Linux evdev KEY_* code. Returns 0 (KEY_RESERVED) for unmapped keys.
+uint16_t EvdevKeyForPhysicalKey(uint32_t physical_key);
+
+// Returns the left-hand evdev KEY_* code for a single modifier flag.
+uint16_t EvdevKeyForModifier(Modifier modifier);
+
+// Translates a `simulateMediaKey` identifier ("playPause", "next", ...) to an
+// evdev KEY_* code. Returns 0 for unsupported identifiers.
+uint16_t EvdevKeyForMediaKey(const std::string& identifier);
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_KEY_CODES_H_
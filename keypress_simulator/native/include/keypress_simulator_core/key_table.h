@@ -0,0 +1,359 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_KEY_TABLE_H_
+#define KEYPRESS_SIMULATOR_CORE_KEY_TABLE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace keypress_simulator_core {
+
+// What one Flutter physical key is called on every backend.
+struct KeyCodes {
+  uint16_t windows_vk;     // VK_*, 0 if Windows has no virtual key for it
+  uint16_t windows_scan;   // set 1 make code, without the E0 prefix
+  bool windows_extended;   // E0-prefixed, i.e. needs KEYEVENTF_EXTENDEDKEY
+  uint16_t evdev;          // Linux KEY_*, 0 if unmapped
+  uint32_t x11_keysym;     // XK_* / XF86XK_*, 0 if unmapped
+};
+
+struct KeyTableEntry {
+  uint32_t physical_key;  // `PhysicalKeyboardKey.usbHidUsage`
+  KeyCodes codes;
+};
+
+// The translation table shared by all native backends. Flutter encodes
+// physical keys as USB HID usages: the keyboard page (0x07) and, for the
+// transport keys, the consumer page (0x0c). The evdev column follows the
+// kernel's hid-input driver.
+//
+// Lookups go through the indexes below, so the table is free to stay in
+// usage order and grow; it is built entirely at compile time.
+// clang-format off
+constexpr KeyTableEntry kKeyTable[] = {
+    {0x00070004, {0x41, 0x1e, false, 30, 0x0061}},  // KeyA
+    {0x00070005, {0x42, 0x30, false, 48, 0x0062}},  // KeyB
+    {0x00070006, {0x43, 0x2e, false, 46, 0x0063}},  // KeyC
+    {0x00070007, {0x44, 0x20, false, 32, 0x0064}},  // KeyD
+    {0x00070008, {0x45, 0x12, false, 18, 0x0065}},  // KeyE
+    {0x00070009, {0x46, 0x21, false, 33, 0x0066}},  // KeyF
+    {0x0007000a, {0x47, 0x22, false, 34, 0x0067}},  // KeyG
+    {0x0007000b, {0x48, 0x23, false, 35, 0x0068}},  // KeyH
+    {0x0007000c, {0x49, 0x17, false, 23, 0x0069}},  // KeyI
+    {0x0007000d, {0x4a, 0x24, false, 36, 0x006a}},  // KeyJ
+    {0x0007000e, {0x4b, 0x25, false, 37, 0x006b}},  // KeyK
+    {0x0007000f, {0x4c, 0x26, false, 38, 0x006c}},  // KeyL
+    {0x00070010, {0x4d, 0x32, false, 50, 0x006d}},  // KeyM
+    {0x00070011, {0x4e, 0x31, false, 49, 0x006e}},  // KeyN
+    {0x00070012, {0x4f, 0x18, false, 24, 0x006f}},  // KeyO
+    {0x00070013, {0x50, 0x19, false, 25, 0x0070}},  // KeyP
+    {0x00070014, {0x51, 0x10, false, 16, 0x0071}},  // KeyQ
+    {0x00070015, {0x52, 0x13, false, 19, 0x0072}},  // KeyR
+    {0x00070016, {0x53, 0x1f, false, 31, 0x0073}},  // KeyS
+    {0x00070017, {0x54, 0x14, false, 20, 0x0074}},  // KeyT
+    {0x00070018, {0x55, 0x16, false, 22, 0x0075}},  // KeyU
+    {0x00070019, {0x56, 0x2f, false, 47, 0x0076}},  // KeyV
+    {0x0007001a, {0x57, 0x11, false, 17, 0x0077}},  // KeyW
+    {0x0007001b, {0x58, 0x2d, false, 45, 0x0078}},  // KeyX
+    {0x0007001c, {0x59, 0x15, false, 21, 0x0079}},  // KeyY
+    {0x0007001d, {0x5a, 0x2c, false, 44, 0x007a}},  // KeyZ
+    {0x0007001e, {0x31, 0x02, false, 2, 0x0031}},  // Digit1
+    {0x0007001f, {0x32, 0x03, false, 3, 0x0032}},  // Digit2
+    {0x00070020, {0x33, 0x04, false, 4, 0x0033}},  // Digit3
+    {0x00070021, {0x34, 0x05, false, 5, 0x0034}},  // Digit4
+    {0x00070022, {0x35, 0x06, false, 6, 0x0035}},  // Digit5
+    {0x00070023, {0x36, 0x07, false, 7, 0x0036}},  // Digit6
+    {0x00070024, {0x37, 0x08, false, 8, 0x0037}},  // Digit7
+    {0x00070025, {0x38, 0x09, false, 9, 0x0038}},  // Digit8
+    {0x00070026, {0x39, 0x0a, false, 10, 0x0039}},  // Digit9
+    {0x00070027, {0x30, 0x0b, false, 11, 0x0030}},  // Digit0
+    {0x00070028, {0x0d, 0x1c, false, 28, 0xff0d}},  // Enter
+    {0x00070029, {0x1b, 0x01, false, 1, 0xff1b}},  // Escape
+    {0x0007002a, {0x08, 0x0e, false, 14, 0xff08}},  // Backspace
+    {0x0007002b, {0x09, 0x0f, false, 15, 0xff09}},  // Tab
+    {0x0007002c, {0x20, 0x39, false, 57, 0x0020}},  // Space
+    {0x0007002d, {0xbd, 0x0c, false, 12, 0x002d}},  // Minus
+    {0x0007002e, {0xbb, 0x0d, false, 13, 0x003d}},  // Equal
+    {0x0007002f, {0xdb, 0x1a, false, 26, 0x005b}},  // BracketLeft
+    {0x00070030, {0xdd, 0x1b, false, 27, 0x005d}},  // BracketRight
+    {0x00070031, {0xdc, 0x2b, false, 43, 0x005c}},  // Backslash
+    {0x00070032, {0x00, 0x2b, false, 43, 0x0000}},  // IntlHash
+    {0x00070033, {0xba, 0x27, false, 39, 0x003b}},  // Semicolon
+    {0x00070034, {0xde, 0x28, false, 40, 0x0027}},  // Quote
+    {0x00070035, {0xc0, 0x29, false, 41, 0x0060}},  // Backquote
+    {0x00070036, {0xbc, 0x33, false, 51, 0x002c}},  // Comma
+    {0x00070037, {0xbe, 0x34, false, 52, 0x002e}},  // Period
+    {0x00070038, {0xbf, 0x35, false, 53, 0x002f}},  // Slash
+    {0x00070039, {0x14, 0x3a, false, 58, 0xffe5}},  // CapsLock
+    {0x0007003a, {0x70, 0x3b, false, 59, 0xffbe}},  // F1
+    {0x0007003b, {0x71, 0x3c, false, 60, 0xffbf}},  // F2
+    {0x0007003c, {0x72, 0x3d, false, 61, 0xffc0}},  // F3
+    {0x0007003d, {0x73, 0x3e, false, 62, 0xffc1}},  // F4
+    {0x0007003e, {0x74, 0x3f, false, 63, 0xffc2}},  // F5
+    {0x0007003f, {0x75, 0x40, false, 64, 0xffc3}},  // F6
+    {0x00070040, {0x76, 0x41, false, 65, 0xffc4}},  // F7
+    {0x00070041, {0x77, 0x42, false, 66, 0xffc5}},  // F8
+    {0x00070042, {0x78, 0x43, false, 67, 0xffc6}},  // F9
+    {0x00070043, {0x79, 0x44, false, 68, 0xffc7}},  // F10
+    {0x00070044, {0x7a, 0x57, false, 87, 0xffc8}},  // F11
+    {0x00070045, {0x7b, 0x58, false, 88, 0xffc9}},  // F12
+    {0x00070046, {0x2c, 0x37, true, 99, 0xff61}},  // PrintScreen
+    {0x00070047, {0x91, 0x46, false, 70, 0xff14}},  // ScrollLock
+    {0x00070048, {0x13, 0x45, false, 119, 0xff13}},  // Pause
+    {0x00070049, {0x2d, 0x52, true, 110, 0xff63}},  // Insert
+    {0x0007004a, {0x24, 0x47, true, 102, 0xff50}},  // Home
+    {0x0007004b, {0x21, 0x49, true, 104, 0xff55}},  // PageUp
+    {0x0007004c, {0x2e, 0x53, true, 111, 0xffff}},  // Delete
+    {0x0007004d, {0x23, 0x4f, true, 107, 0xff57}},  // End
+    {0x0007004e, {0x22, 0x51, true, 109, 0xff56}},  // PageDown
+    {0x0007004f, {0x27, 0x4d, true, 106, 0xff53}},  // ArrowRight
+    {0x00070050, {0x25, 0x4b, true, 105, 0xff51}},  // ArrowLeft
+    {0x00070051, {0x28, 0x50, true, 108, 0xff54}},  // ArrowDown
+    {0x00070052, {0x26, 0x48, true, 103, 0xff52}},  // ArrowUp
+    {0x00070053, {0x90, 0x45, true, 69, 0xff7f}},  // NumLock
+    {0x00070054, {0x6f, 0x35, true, 98, 0xffaf}},  // NumpadDivide
+    {0x00070055, {0x6a, 0x37, false, 55, 0xffaa}},  // NumpadMultiply
+    {0x00070056, {0x6d, 0x4a, false, 74, 0xffad}},  // NumpadSubtract
+    {0x00070057, {0x6b, 0x4e, false, 78, 0xffab}},  // NumpadAdd
+    {0x00070058, {0x0d, 0x1c, true, 96, 0xff8d}},  // NumpadEnter
+    {0x00070059, {0x61, 0x4f, false, 79, 0xffb1}},  // Numpad1
+    {0x0007005a, {0x62, 0x50, false, 80, 0xffb2}},  // Numpad2
+    {0x0007005b, {0x63, 0x51, false, 81, 0xffb3}},  // Numpad3
+    {0x0007005c, {0x64, 0x4b, false, 75, 0xffb4}},  // Numpad4
+    {0x0007005d, {0x65, 0x4c, false, 76, 0xffb5}},  // Numpad5
+    {0x0007005e, {0x66, 0x4d, false, 77, 0xffb6}},  // Numpad6
+    {0x0007005f, {0x67, 0x47, false, 71, 0xffb7}},  // Numpad7
+    {0x00070060, {0x68, 0x48, false, 72, 0xffb8}},  // Numpad8
+    {0x00070061, {0x69, 0x49, false, 73, 0xffb9}},  // Numpad9
+    {0x00070062, {0x60, 0x52, false, 82, 0xffb0}},  // Numpad0
+    {0x00070063, {0x6e, 0x53, false, 83, 0xffae}},  // NumpadDecimal
+    {0x00070064, {0xe2, 0x56, false, 86, 0x003c}},  // IntlBackslash
+    {0x00070065, {0x5d, 0x5d, true, 127, 0xff67}},  // ContextMenu
+    {0x00070066, {0x00, 0x00, false, 116, 0x0000}},  // KEY_POWER
+    {0x00070067, {0x00, 0x00, false, 117, 0xffbd}},  // NumpadEqual
+    {0x00070068, {0x7c, 0x64, false, 183, 0xffca}},  // F13
+    {0x00070069, {0x7d, 0x65, false, 184, 0xffcb}},  // F14
+    {0x0007006a, {0x7e, 0x66, false, 185, 0xffcc}},  // F15
+    {0x0007006b, {0x7f, 0x67, false, 186, 0xffcd}},  // F16
+    {0x0007006c, {0x80, 0x68, false, 187, 0xffce}},  // F17
+    {0x0007006d, {0x81, 0x69, false, 188, 0xffcf}},  // F18
+    {0x0007006e, {0x82, 0x6a, false, 189, 0xffd0}},  // F19
+    {0x0007006f, {0x83, 0x6b, false, 190, 0xffd1}},  // F20
+    {0x00070070, {0x84, 0x6c, false, 191, 0xffd2}},  // F21
+    {0x00070071, {0x85, 0x6d, false, 192, 0xffd3}},  // F22
+    {0x00070072, {0x86, 0x6e, false, 193, 0xffd4}},  // F23
+    {0x00070073, {0x87, 0x76, false, 194, 0xffd5}},  // F24
+    {0x00070074, {0x00, 0x00, false, 134, 0x0000}},  // KEY_OPEN
+    {0x00070075, {0x00, 0x00, false, 138, 0x0000}},  // KEY_HELP
+    {0x00070076, {0x00, 0x00, false, 130, 0x0000}},  // KEY_PROPS
+    {0x00070077, {0x00, 0x00, false, 132, 0x0000}},  // KEY_FRONT
+    {0x00070078, {0x00, 0x00, false, 128, 0x0000}},  // KEY_STOP
+    {0x00070079, {0x00, 0x00, false, 129, 0x0000}},  // KEY_AGAIN
+    {0x0007007a, {0x00, 0x00, false, 131, 0x0000}},  // KEY_UNDO
+    {0x0007007b, {0x00, 0x00, false, 137, 0x0000}},  // KEY_CUT
+    {0x0007007c, {0x00, 0x00, false, 133, 0x0000}},  // KEY_COPY
+    {0x0007007d, {0x00, 0x00, false, 135, 0x0000}},  // KEY_PASTE
+    {0x0007007e, {0x00, 0x00, false, 136, 0x0000}},  // KEY_FIND
+    {0x0007007f, {0xad, 0x20, true, 113, 0x1008ff12}},  // AudioVolumeMute
+    {0x00070080, {0xaf, 0x30, true, 115, 0x1008ff13}},  // AudioVolumeUp
+    {0x00070081, {0xae, 0x2e, true, 114, 0x1008ff11}},  // AudioVolumeDown
+    {0x00070085, {0x00, 0x00, false, 121, 0x0000}},  // KEY_KPCOMMA
+    {0x00070087, {0x00, 0x00, false, 89, 0x0000}},  // KEY_RO
+    {0x00070088, {0x00, 0x00, false, 93, 0x0000}},  // KEY_KATAKANAHIRAGANA
+    {0x00070089, {0x00, 0x00, false, 124, 0x0000}},  // KEY_YEN
+    {0x0007008a, {0x00, 0x00, false, 92, 0x0000}},  // KEY_HENKAN
+    {0x0007008b, {0x00, 0x00, false, 94, 0x0000}},  // KEY_MUHENKAN
+    {0x0007008c, {0x00, 0x00, false, 95, 0x0000}},  // KEY_KPJPCOMMA
+    {0x00070090, {0x00, 0x00, false, 122, 0x0000}},  // KEY_HANGEUL
+    {0x00070091, {0x00, 0x00, false, 123, 0x0000}},  // KEY_HANJA
+    {0x00070092, {0x00, 0x00, false, 90, 0x0000}},  // KEY_KATAKANA
+    {0x00070093, {0x00, 0x00, false, 91, 0x0000}},  // KEY_HIRAGANA
+    {0x00070094, {0x00, 0x00, false, 85, 0x0000}},  // KEY_ZENKAKUHANKAKU
+    {0x0007009c, {0x00, 0x00, false, 111, 0x0000}},  // KEY_DELETE
+    {0x000700b6, {0x00, 0x00, false, 179, 0x0000}},  // KEY_KPLEFTPAREN
+    {0x000700b7, {0x00, 0x00, false, 180, 0x0000}},  // KEY_KPRIGHTPAREN
+    {0x000700d8, {0x00, 0x00, false, 111, 0x0000}},  // KEY_DELETE
+    {0x000700e0, {0xa2, 0x1d, false, 29, 0xffe3}},  // ControlLeft
+    {0x000700e1, {0xa0, 0x2a, false, 42, 0xffe1}},  // ShiftLeft
+    {0x000700e2, {0xa4, 0x38, false, 56, 0xffe9}},  // AltLeft
+    {0x000700e3, {0x5b, 0x5b, true, 125, 0xffeb}},  // MetaLeft
+    {0x000700e4, {0xa3, 0x1d, true, 97, 0xffe4}},  // ControlRight
+    {0x000700e5, {0xa1, 0x36, false, 54, 0xffe2}},  // ShiftRight
+    {0x000700e6, {0xa5, 0x38, true, 100, 0xffea}},  // AltRight
+    {0x000700e7, {0x5c, 0x5c, true, 126, 0xffec}},  // MetaRight
+    {0x000700e8, {0x00, 0x00, false, 164, 0x0000}},  // KEY_PLAYPAUSE
+    {0x000700e9, {0x00, 0x00, false, 166, 0x0000}},  // KEY_STOPCD
+    {0x000700ea, {0x00, 0x00, false, 165, 0x0000}},  // KEY_PREVIOUSSONG
+    {0x000700eb, {0x00, 0x00, false, 163, 0x0000}},  // KEY_NEXTSONG
+    {0x000700ec, {0x00, 0x00, false, 161, 0x0000}},  // KEY_EJECTCD
+    {0x000700ed, {0x00, 0x00, false, 115, 0x0000}},  // KEY_VOLUMEUP
+    {0x000700ee, {0x00, 0x00, false, 114, 0x0000}},  // KEY_VOLUMEDOWN
+    {0x000700ef, {0x00, 0x00, false, 113, 0x0000}},  // KEY_MUTE
+    {0x000700f0, {0x00, 0x00, false, 150, 0x0000}},  // KEY_WWW
+    {0x000700f1, {0x00, 0x00, false, 158, 0x0000}},  // KEY_BACK
+    {0x000700f2, {0x00, 0x00, false, 159, 0x0000}},  // KEY_FORWARD
+    {0x000700f3, {0x00, 0x00, false, 128, 0x0000}},  // KEY_STOP
+    {0x000700f4, {0x00, 0x00, false, 136, 0x0000}},  // KEY_FIND
+    {0x000700f5, {0x00, 0x00, false, 177, 0x0000}},  // KEY_SCROLLUP
+    {0x000700f6, {0x00, 0x00, false, 178, 0x0000}},  // KEY_SCROLLDOWN
+    {0x000700f7, {0x00, 0x00, false, 176, 0x0000}},  // KEY_EDIT
+    {0x000700f8, {0x00, 0x00, false, 142, 0x0000}},  // KEY_SLEEP
+    {0x000700f9, {0x00, 0x00, false, 152, 0x0000}},  // KEY_COFFEE
+    {0x000700fa, {0x00, 0x00, false, 173, 0x0000}},  // KEY_REFRESH
+    {0x000700fb, {0x00, 0x00, false, 140, 0x0000}},  // KEY_CALC
+    {0x000c00b5, {0xb0, 0x19, true, 163, 0x1008ff17}},  // MediaTrackNext
+    {0x000c00b6, {0xb1, 0x10, true, 165, 0x1008ff16}},  // MediaTrackPrevious
+    {0x000c00b7, {0xb2, 0x24, true, 166, 0x1008ff15}},  // MediaStop
+    {0x000c00cd, {0xb3, 0x22, true, 164, 0x1008ff14}},  // MediaPlayPause
+};
+// clang-format on
+
+namespace internal {
+
+constexpr uint32_t kHidPageMask = 0xFFFF0000;
+constexpr uint32_t kHidKeyboardPage = 0x00070000;
+constexpr uint32_t kHidConsumerPage = 0x000C0000;
+constexpr uint16_t kNoEntry = 0xFFFF;
+
+static_assert(std::size(kKeyTable) < kNoEntry, "kKeyTable is too large");
+
+using KeyIndex = std::array<uint16_t, 256>;
+
+// Maps the usage IDs of |page| below 0x100 to their kKeyTable entry.
+constexpr KeyIndex BuildUsageIndex(uint32_t page) {
+  KeyIndex index{};
+  for (uint16_t& entry : index) {
+    entry = kNoEntry;
+  }
+  for (size_t i = 0; i < std::size(kKeyTable); i++) {
+    uint32_t key = kKeyTable[i].physical_key;
+    if ((key & kHidPageMask) == page && (key & 0xFFFF) < index.size() &&
+        index[key & 0xFF] == kNoEntry) {
+      index[key & 0xFF] = static_cast<uint16_t>(i);
+    }
+  }
+  return index;
+}
+
+// Generic modifier virtual keys, as the plugins inject them, and the
+// left-hand key they stand for.
+struct VirtualKeyAlias {
+  uint16_t windows_vk;
+  uint32_t physical_key;
+};
+constexpr VirtualKeyAlias kVirtualKeyAliases[] = {
+    {0x10, 0x000700E1},  // VK_SHIFT -> ShiftLeft
+    {0x11, 0x000700E0},  // VK_CONTROL -> ControlLeft
+    {0x12, 0x000700E2},  // VK_MENU -> AltLeft
+};
+
+// Maps Windows virtual keys to the first kKeyTable entry using them, so the
+// main Enter key wins over NumpadEnter.
+constexpr KeyIndex BuildVirtualKeyIndex() {
+  KeyIndex index{};
+  for (uint16_t& entry : index) {
+    entry = kNoEntry;
+  }
+  for (size_t i = 0; i < std::size(kKeyTable); i++) {
+    uint16_t vk = kKeyTable[i].codes.windows_vk;
+    if (vk != 0 && vk < index.size() && index[vk] == kNoEntry) {
+      index[vk] = static_cast<uint16_t>(i);
+    }
+  }
+  for (const VirtualKeyAlias& alias : kVirtualKeyAliases) {
+    for (size_t i = 0; i < std::size(kKeyTable); i++) {
+      if (kKeyTable[i].physical_key == alias.physical_key) {
+        index[alias.windows_vk] = static_cast<uint16_t>(i);
+      }
+    }
+  }
+  return index;
+}
+
+// Maps evdev codes to their kKeyTable entry. Several usages share a code
+// (e.g. the keyboard and consumer page Mute keys); the first entry with an
+// X11 keysym wins, so the reverse lookup is usable on X11.
+constexpr KeyIndex BuildEvdevIndex() {
+  KeyIndex index{};
+  for (uint16_t& entry : index) {
+    entry = kNoEntry;
+  }
+  for (size_t i = 0; i < std::size(kKeyTable); i++) {
+    const KeyCodes& codes = kKeyTable[i].codes;
+    if (codes.evdev != 0 && codes.evdev < index.size() &&
+        (index[codes.evdev] == kNoEntry ||
+         (kKeyTable[index[codes.evdev]].codes.x11_keysym == 0 &&
+          codes.x11_keysym != 0))) {
+      index[codes.evdev] = static_cast<uint16_t>(i);
+    }
+  }
+  return index;
+}
+
+constexpr KeyIndex kKeyboardPageIndex = BuildUsageIndex(kHidKeyboardPage);
+constexpr KeyIndex kConsumerPageIndex = BuildUsageIndex(kHidConsumerPage);
+constexpr KeyIndex kVirtualKeyIndex = BuildVirtualKeyIndex();
+constexpr KeyIndex kEvdevIndex = BuildEvdevIndex();
+
+constexpr const KeyCodes* Lookup(const KeyIndex& index, uint32_t slot) {
+  if (slot >= index.size() || index[slot] == kNoEntry) {
+    return nullptr;
+  }
+  return &kKeyTable[index[slot]].codes;
+}
+
+}  // namespace internal
+
+// Returns the codes for a Flutter physical key id, or nullptr if no backend
+// knows the key.
+constexpr const KeyCodes* KeyCodesForPhysicalKey(uint32_t physical_key) {
+  uint32_t usage = physical_key & 0xFFFF;
+  switch (physical_key & internal::kHidPageMask) {
+    case internal::kHidKeyboardPage:
+      return internal::Lookup(internal::kKeyboardPageIndex, usage);
+    case internal::kHidConsumerPage:
+      return internal::Lookup(internal::kConsumerPageIndex, usage);
+    default:
+      return nullptr;
+  }
+}
+
+// Returns the codes for a Windows virtual key (e.g. `keyCode` as sent by
+// Dart on Windows), or nullptr if the table does not know it.
+constexpr const KeyCodes* KeyCodesForVirtualKey(uint32_t virtual_key) {
+  return internal::Lookup(internal::kVirtualKeyIndex, virtual_key);
+}
+
+// Returns the codes for a Linux evdev KEY_* code, e.g. to find the X11
+// keysym of a key the uinput backend would inject, or nullptr if the table
+// does not know it.
+constexpr const KeyCodes* KeyCodesForEvdevKey(uint16_t evdev) {
+  return internal::Lookup(internal::kEvdevIndex, evdev);
+}
+
+// The `simulateMediaKey` identifiers and the keys they press.
+struct MediaKeyName {
+  std::string_view identifier;
+  uint32_t physical_key;
+};
+constexpr MediaKeyName kMediaKeyNames[] = {
+    {"playPause", 0x000C00CD}, {"stop", 0x000C00B7},
+    {"next", 0x000C00B5},      {"previous", 0x000C00B6},
+    {"volumeUp", 0x00070080},  {"volumeDown", 0x00070081},
+};
+
+// Returns the codes for a `simulateMediaKey` identifier ("playPause", ...),
+// or nullptr for unsupported identifiers.
+constexpr const KeyCodes* KeyCodesForMediaKey(std::string_view identifier) {
+  for (const MediaKeyName& media_key : kMediaKeyNames) {
+    if (media_key.identifier == identifier) {
+      return KeyCodesForPhysicalKey(media_key.physical_key);
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_KEY_TABLE_H_
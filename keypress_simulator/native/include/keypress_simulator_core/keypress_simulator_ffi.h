@@ -0,0 +1,68 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_KEYPRESS_SIMULATOR_FFI_H_
+#define KEYPRESS_SIMULATOR_CORE_KEYPRESS_SIMULATOR_FFI_H_
+
+// C ABI exported by the native plugins for direct calls through dart:ffi,
+// skipping the method channel. Plain C so the Dart bindings can be written
+// (or generated) from this header alone.
+//
+// Functions may be called from any thread. Calls are serialised with the
+// plugin's method channel handler, and the input is queued on the same
+// injection worker, so FFI and channel calls that do not overlap in time are
+// injected in the order they were made.
+//
+// Compatible changes only add functions; anything else bumps KS_ABI_VERSION.
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define KS_EXPORT __declspec(dllexport)
+#else
+#define KS_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KS_ABI_VERSION 1
+
+// Results of the ks_* calls.
+enum {
+  KS_OK = 0,
+  // No plugin is registered, or its input device could not be opened. Use
+  // the method channel instead.
+  KS_ERROR_UNAVAILABLE = -1,
+  KS_ERROR_INVALID_ARGUMENT = -2,
+  // The action was not uploaded with registerKeymap.
+  KS_ERROR_UNKNOWN_ACTION = -3,
+  KS_ERROR_QUEUE_FULL = -4,
+};
+
+// The |down| argument of ks_key.
+enum {
+  KS_KEY_UP = 0,
+  KS_KEY_DOWN = 1,
+  // Press and release.
+  KS_KEY_TAP = 2,
+};
+
+KS_EXPORT int32_t ks_abi_version(void);
+
+// Queues the chord registered as |action_id| with registerKeymap.
+KS_EXPORT int32_t ks_key(int32_t action_id, int32_t down);
+
+// As ks_key, with the `Timeline.now` timestamp of the input behind the key
+// for the latency statistics.
+KS_EXPORT int32_t ks_key_traced(int32_t action_id,
+                                int32_t down,
+                                int64_t origin_micros);
+
+// Queues a left button press (|down| non-zero) or release at |x|, |y|, in
+// the same coordinates as simulateMouseClick.
+KS_EXPORT int32_t ks_click(double x, double y, int32_t down);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // KEYPRESS_SIMULATOR_CORE_KEYPRESS_SIMULATOR_FFI_H_
@@ -0,0 +1,112 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_LATENCY_STATS_H_
+#define KEYPRESS_SIMULATOR_CORE_LATENCY_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace keypress_simulator_core {
+
+// Percentiles of a LatencyHistogram, in microseconds.
+struct LatencySummary {
+  uint64_t count = 0;
+  uint64_t p50 = 0;
+  uint64_t p99 = 0;
+  uint64_t max = 0;
+};
+
+// Histogram of latencies in microseconds, in the style of HdrHistogram:
+// every power of two is split into kSubBucketCount linear buckets, so a
+// reported percentile is within 1/kSubBucketCount (6.25%) of the recorded
+// value while the whole histogram stays a few kilobytes.
+//
+// Record() is lock-free and may be called from any number of threads.
+// Summarize() and Reset() may run concurrently with it; a summary taken while
+// values are being recorded may miss some of them.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+  // Larger values are recorded as this (about 71 minutes).
+  static constexpr uint64_t kMaxTrackable = (uint64_t{1} << 32) - 1;
+  static constexpr size_t kBucketCount =
+      kSubBucketCount * (32 - kSubBucketBits + 1);
+
+  LatencyHistogram() = default;
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(uint64_t micros);
+
+  // Records |latency| rounded down to microseconds; negative values count
+  // as zero.
+  void Record(std::chrono::steady_clock::duration latency);
+
+  LatencySummary Summarize() const;
+
+  void Reset();
+
+  // The bucket |micros| is counted in, and the largest value counted in
+  // |bucket|. Exposed for tests.
+  static size_t BucketIndex(uint64_t micros);
+  static uint64_t BucketUpperBound(size_t bucket);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+  std::atomic<uint64_t> max_{0};
+};
+
+// The stages an injected event goes through, timed by the injection worker.
+enum class LatencyStage {
+  // From the event's origin (e.g. the BLE notification) to the plugin
+  // queueing it: Dart processing and the method channel.
+  kDispatch,
+  // Waiting in the injection queue.
+  kQueue,
+  // SendInput(), XTest or uinput writing the event.
+  kInject,
+  // From the origin to the end of the injection.
+  kTotal,
+};
+
+constexpr size_t kLatencyStageCount = 4;
+
+// The key getLatencyStats reports |stage| under.
+const char* LatencyStageName(LatencyStage stage);
+
+// One LatencyHistogram per LatencyStage.
+class LatencyRecorder {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  // Records one event. |origin| is optional: events posted without one
+  // (default-constructed) only count towards kQueue and kInject, and so do
+  // events whose origin is later than |enqueued|, which means the caller's
+  // clock is not the steady clock.
+  void Record(TimePoint origin,
+              TimePoint enqueued,
+              TimePoint dequeued,
+              TimePoint injected);
+
+  LatencySummary Summarize(LatencyStage stage) const {
+    return histograms_[static_cast<size_t>(stage)].Summarize();
+  }
+
+  void Reset();
+
+ private:
+  std::array<LatencyHistogram, kLatencyStageCount> histograms_;
+};
+
+// Converts a timestamp taken in Dart with `Timeline.now` to the steady clock.
+// Both read the OS monotonic clock (CLOCK_MONOTONIC on Linux,
+// QueryPerformanceCounter on Windows) and count from its zero. Returns a
+// default-constructed time point, i.e. no origin, for non-positive values.
+std::chrono::steady_clock::time_point LatencyOriginFromMicros(int64_t micros);
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_LATENCY_STATS_H_
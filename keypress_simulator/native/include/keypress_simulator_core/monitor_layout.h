@@ -0,0 +1,59 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_MONITOR_LAYOUT_H_
+#define KEYPRESS_SIMULATOR_CORE_MONITOR_LAYOUT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace keypress_simulator_core {
+
+// A monitor in virtual-screen coordinates. |right| and |bottom| are
+// exclusive, like a Win32 RECT.
+struct Monitor {
+  int32_t left;
+  int32_t top;
+  int32_t right;
+  int32_t bottom;
+  // DPI scale factor (dpi / 96 on Windows).
+  double scale;
+
+  bool Contains(int32_t x, int32_t y) const {
+    return x >= left && x < right && y >= top && y < bottom;
+  }
+};
+
+// Snapshot of the monitor topology, so a click only needs a lookup instead of
+// MonitorFromPoint() and a DPI query. The plugin rebuilds it when the display
+// configuration or a DPI setting changes.
+//
+// Monitors are indexed by their left edge together with a running maximum of
+// the right edges, so a lookup is a binary search plus a walk over the
+// monitors stacked in the same column.
+class MonitorLayout {
+ public:
+  MonitorLayout() = default;
+  explicit MonitorLayout(std::vector<Monitor> monitors);
+
+  // Returns the monitor containing (x, y). Points outside every monitor
+  // resolve to the nearest one, like MONITOR_DEFAULTTONEAREST. Returns
+  // nullptr only if the layout is empty.
+  const Monitor* Find(int32_t x, int32_t y) const;
+
+  // Scales (x, y) by the DPI scale of the monitor it falls on, which is how
+  // SimulateMouseClick turns a Dart position into a cursor position. Points
+  // are returned unchanged if the layout is empty.
+  void MapPoint(double x, double y, double* mapped_x, double* mapped_y) const;
+
+  size_t size() const { return monitors_.size(); }
+  bool empty() const { return monitors_.empty(); }
+
+ private:
+  // Sorted by |left|.
+  std::vector<Monitor> monitors_;
+  // max_right_[i] is the largest |right| of monitors_[0..i].
+  std::vector<int32_t> max_right_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_MONITOR_LAYOUT_H_
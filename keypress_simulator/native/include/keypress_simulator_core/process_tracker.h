@@ -0,0 +1,85 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_PROCESS_TRACKER_H_
+#define KEYPRESS_SIMULATOR_CORE_PROCESS_TRACKER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace keypress_simulator_core {
+
+// A process as seen in the process table.
+struct ProcessInfo {
+  int32_t pid;
+  // Executable file name, e.g. "MyWhoosh.exe".
+  std::string name;
+};
+
+// Keeps track of which trainer apps are running, from process launch and
+// exit notifications and from full scans of the process table. An app counts
+// as running while at least one of its processes is; only the first launch
+// and the last exit are reported.
+//
+// Platform-neutral and not thread-safe: the platform watchers feed it from
+// their own thread.
+class ProcessTracker {
+ public:
+  // An app started or stopped running.
+  struct Change {
+    // The entry of |app_names| as passed to the constructor.
+    std::string app;
+    // The process that started the app or was the last one to exit.
+    int32_t pid;
+    bool running;
+
+    bool operator==(const Change& other) const {
+      return app == other.app && pid == other.pid && running == other.running;
+    }
+  };
+
+  // |app_names| are executable file names, matched case-insensitively.
+  // Linux truncates process names to 15 characters, so longer entries match
+  // on that prefix.
+  explicit ProcessTracker(std::vector<std::string> app_names);
+
+  // |pid| was started, or has executed or renamed itself to |name|. A tracked
+  // process that now has an unknown name counts as exited.
+  void OnProcessNamed(int32_t pid,
+                      const std::string& name,
+                      std::vector<Change>* changes);
+
+  void OnProcessExited(int32_t pid, std::vector<Change>* changes);
+
+  // Reconciles with a listing of every process, e.g. when notifications may
+  // have been lost. Tracked processes missing from |processes| have exited.
+  void OnScan(const std::vector<ProcessInfo>& processes,
+              std::vector<Change>* changes);
+
+  bool IsTracked(int32_t pid) const { return pids_.count(pid) != 0; }
+
+  // The processes of all running apps, in no particular order.
+  std::vector<int32_t> TrackedPids() const;
+
+  // A `running` change for every running app, in |app_names| order, e.g. to
+  // bring a new listener up to date.
+  std::vector<Change> RunningApps() const;
+
+ private:
+  // Index into app_names_ for a process |name|, or -1.
+  int MatchName(const std::string& name) const;
+
+  void Track(int32_t pid, int app, std::vector<Change>* changes);
+  void Untrack(int32_t pid, std::vector<Change>* changes);
+
+  std::vector<std::string> app_names_;
+  // Lower-case and truncated like the names being matched.
+  std::vector<std::string> match_names_;
+  // Tracked process -> index into app_names_.
+  std::unordered_map<int32_t, int> pids_;
+  // Tracked processes per app.
+  std::vector<int> process_counts_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_PROCESS_TRACKER_H_
@@ -0,0 +1,104 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_PROCESS_WATCHER_H_
+#define KEYPRESS_SIMULATOR_CORE_PROCESS_WATCHER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "keypress_simulator_core/process_tracker.h"
+
+namespace keypress_simulator_core {
+
+// Reports trainer apps starting and exiting on Linux, from a thread of its
+// own that sleeps in epoll_wait() between events.
+//
+// Launches come from the kernel's process events connector (netlink
+// PROC_EVENT_EXEC and PROC_EVENT_COMM). Subscribing needs CAP_NET_ADMIN, so
+// for a regular desktop user the watcher falls back to scanning /proc every
+// poll interval. Exits are exact either way: every running app process is
+// watched through a pidfd, which becomes readable when the process exits.
+// A slow full scan also runs while the connector is in use, to recover from
+// dropped netlink messages.
+class ProcessWatcher {
+ public:
+  using Change = ProcessTracker::Change;
+  // Called on the watcher thread.
+  using Callback = std::function<void(const Change& change)>;
+
+  static constexpr std::chrono::milliseconds kPollInterval{2000};
+  static constexpr std::chrono::milliseconds kConnectorScanInterval{30000};
+
+  // |app_names| as for ProcessTracker.
+  ProcessWatcher(std::vector<std::string> app_names, Callback callback);
+  ~ProcessWatcher();
+
+  // Disallow copy and assign.
+  ProcessWatcher(const ProcessWatcher&) = delete;
+  ProcessWatcher& operator=(const ProcessWatcher&) = delete;
+
+  // Scans /proc once and starts watching. Apps found by that first scan are
+  // returned by RunningApps() but not passed to the callback. Returns false
+  // if the epoll set could not be created.
+  bool Start(bool use_proc_connector = true,
+             std::chrono::milliseconds poll_interval = kPollInterval);
+
+  // Stops the thread. Called automatically on destruction. No callback runs
+  // once this returns.
+  void Stop();
+
+  // The running apps as of the last change. May be called from any thread.
+  std::vector<Change> RunningApps() const;
+
+  // Whether launches are reported by the process events connector rather
+  // than found by polling. The kernel may refuse the subscription
+  // asynchronously, so this can turn false shortly after Start().
+  bool uses_proc_connector() const { return uses_proc_connector_; }
+
+ private:
+  void Run();
+
+  // Drains the process events connector into |changes|.
+  void ReadProcEvents(std::vector<Change>* changes);
+
+  // Switches to polling after the connector failed.
+  void CloseProcConnector();
+
+  // Starts the periodic scan with |interval|.
+  void ArmScanTimer(std::chrono::milliseconds interval);
+
+  // Opens pidfds for newly tracked processes and closes the ones of
+  // processes that are no longer tracked. Called with mutex_ held.
+  void SyncPidfds();
+
+  // Passes |changes| to the callback. Called without mutex_ held.
+  void Report(const std::vector<Change>& changes);
+
+  Callback callback_;
+  std::chrono::milliseconds poll_interval_{kPollInterval};
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int timer_fd_ = -1;
+  int netlink_fd_ = -1;
+  std::atomic<bool> uses_proc_connector_{false};
+
+  mutable std::mutex mutex_;
+  ProcessTracker tracker_;
+  // Tracked process -> its pidfd. Only used on the watcher thread once
+  // started.
+  std::unordered_map<int32_t, int> pidfds_;
+
+  std::thread thread_;
+};
+
+// Lists every live process in /proc with its name, leaving out zombies.
+std::vector<ProcessInfo> ListProcesses();
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_PROCESS_WATCHER_H_
@@ -0,0 +1,74 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_REPEAT_SCHEDULER_H_
+#define KEYPRESS_SIMULATOR_CORE_REPEAT_SCHEDULER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "keypress_simulator_core/action_table.h"
+
+namespace keypress_simulator_core {
+
+// Limits for startRepeat, so a bogus request cannot flood the target app.
+constexpr std::chrono::milliseconds kMinRepeatInterval(10);
+constexpr std::chrono::milliseconds kMaxRepeatDelay(10000);
+
+// Returns whether |initial_delay| and |interval| are within the limits above.
+bool IsValidRepeatTiming(std::chrono::milliseconds initial_delay,
+                         std::chrono::milliseconds interval);
+
+// The repeats of held buttons, e.g. gear shifts while a shifter is held.
+//
+// Ticks are scheduled on a fixed grid from the start time: the n-th tick is
+// due at start + initial_delay + n * interval no matter how late the previous
+// one ran, so repeats do not drift. After a stall longer than an interval
+// the missed ticks are skipped rather than sent in a burst.
+//
+// Not thread-safe; owned by the injection worker. Time is passed in, so tests
+// drive it with a fake clock.
+class RepeatScheduler {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+  using Tick = std::function<void()>;
+
+  // Upper bound of repeats running at the same time.
+  static constexpr size_t kMaxRepeats = 16;
+
+  // Starts calling |tick| for |id|, replacing a repeat already running for
+  // it. Returns false if the timing is invalid or kMaxRepeats other repeats
+  // are running.
+  bool Start(ActionId id,
+             TimePoint start,
+             std::chrono::milliseconds initial_delay,
+             std::chrono::milliseconds interval,
+             Tick tick);
+
+  // Returns false if no repeat was running for |id|.
+  bool Stop(ActionId id);
+
+  void Clear() { repeats_.clear(); }
+
+  bool empty() const { return repeats_.empty(); }
+
+  // When the earliest tick is due. Must not be called when empty().
+  TimePoint next_deadline() const;
+
+  // Calls every tick due at |now| once and schedules its next one. Returns
+  // the number of ticks called.
+  size_t RunDue(TimePoint now);
+
+ private:
+  struct Repeat {
+    ActionId id;
+    TimePoint deadline;
+    std::chrono::steady_clock::duration interval;
+    Tick tick;
+  };
+
+  std::vector<Repeat> repeats_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_REPEAT_SCHEDULER_H_
@@ -0,0 +1,70 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_SPSC_QUEUE_H_
+#define KEYPRESS_SIMULATOR_CORE_SPSC_QUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace keypress_simulator_core {
+
+// Bounded lock-free ring buffer for exactly one producer thread and one
+// consumer thread. Elements come out in the order they went in.
+//
+// |Capacity| must be a power of two. head_ and tail_ count pushes and pops
+// since construction and only wrap around at SIZE_MAX, so a full queue is
+// tail_ - head_ == Capacity.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+ public:
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer only. Returns false, leaving |value| untouched, if the queue is
+  // full.
+  bool TryPush(T&& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    slots_[tail & (Capacity - 1)] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if the queue is empty.
+  bool TryPop(T* value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (tail_.load(std::memory_order_acquire) == head) {
+      return false;
+    }
+    *value = std::move(slots_[head & (Capacity - 1)]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Either side; the answer may be stale by the time it is used.
+  bool empty() const {
+    return tail_.load(std::memory_order_acquire) ==
+           head_.load(std::memory_order_acquire);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+ private:
+  std::array<T, Capacity> slots_;
+
+  // Written by the consumer and the producer respectively; kept on separate
+  // cache lines so the two threads don't contend for one.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_SPSC_QUEUE_H_
@@ -0,0 +1,89 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_UINPUT_DEVICE_H_
+#define KEYPRESS_SIMULATOR_CORE_UINPUT_DEVICE_H_
+
+#include <linux/input.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "keypress_simulator_core/input_batch.h"
+
+namespace keypress_simulator_core {
+
+// The handful of syscalls UinputDevice needs. The default implementation talks
+// to the kernel; tests substitute a recording fake so the exact ioctl and
+// input_event stream can be checked without access to /dev/uinput.
+class UinputBackend {
+ public:
+  virtual ~UinputBackend() = default;
+
+  virtual int Open(const char* path, int flags) = 0;
+  virtual int Ioctl(int fd, unsigned long request, uintptr_t arg) = 0;
+  virtual ssize_t Write(int fd, const void* data, size_t size) = 0;
+  virtual int Close(int fd) = 0;
+};
+
+// Returns a backend that forwards to open(2), ioctl(2), write(2) and close(2).
+std::unique_ptr<UinputBackend> CreateSystemUinputBackend();
+
+// A persistent virtual keyboard + absolute pointer created through
+// /dev/uinput. The device is set up once and reused for every event, so an
+// injection costs a single write(2).
+class UinputDevice {
+ public:
+  static constexpr const char* kDevicePath = "/dev/uinput";
+  static constexpr const char* kDeviceName = "BikeControl Virtual Input";
+
+  // Upper bound of transitions sent in one write(2); longer sequences are
+  // split into several writes.
+  static constexpr size_t kMaxBatchTransitions = 16;
+
+  explicit UinputDevice(
+      std::unique_ptr<UinputBackend> backend = CreateSystemUinputBackend());
+  ~UinputDevice();
+
+  // Disallow copy and assign.
+  UinputDevice(const UinputDevice&) = delete;
+  UinputDevice& operator=(const UinputDevice&) = delete;
+
+  // Opens /dev/uinput and registers the device. The pointer axes span
+  // [0, screen_width) x [0, screen_height), which the compositor maps onto
+  // the whole desktop. Returns false if the device could not be created,
+  // typically because the user has no write access to /dev/uinput.
+  bool Create(int screen_width, int screen_height);
+
+  // Destroys the virtual device. Called automatically on destruction.
+  void Destroy();
+
+  bool is_open() const { return fd_ >= 0; }
+
+  // Injects |count| key transitions in order, each followed by a
+  // SYN_REPORT.
+  bool SendKeys(const KeyTransition* transitions, size_t count);
+
+  bool SendKey(uint16_t code, bool down);
+
+  // Presses and releases |code|, e.g. for media keys.
+  bool TapKey(uint16_t code);
+
+  // Moves the pointer to (x, y) and presses or releases the left button.
+  bool SendClick(int x, int y, bool down);
+
+  // Moves the pointer to (x, y) without touching the buttons, e.g. for the
+  // intermediate samples of a drag.
+  bool MovePointer(int x, int y);
+
+ private:
+  bool WriteEvents(const input_event* events, size_t count);
+
+  std::unique_ptr<UinputBackend> backend_;
+  int fd_ = -1;
+  int max_x_ = 0;
+  int max_y_ = 0;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_UINPUT_DEVICE_H_
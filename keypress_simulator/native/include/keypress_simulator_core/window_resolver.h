@@ -0,0 +1,86 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_WINDOW_RESOLVER_H_
+#define KEYPRESS_SIMULATOR_CORE_WINDOW_RESOLVER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace keypress_simulator_core {
+
+// Opaque native window handle (an HWND on Windows).
+using WindowHandle = uintptr_t;
+
+// Access to the desktop's top-level windows. The Win32 implementation wraps
+// EnumWindows and QueryFullProcessImageName; tests use a fake window table.
+class WindowEnumerator {
+ public:
+  virtual ~WindowEnumerator() = default;
+
+  // Calls |callback| for every visible, non-minimized top-level window until
+  // it returns false.
+  virtual void EnumerateWindows(
+      const std::function<bool(WindowHandle)>& callback) = 0;
+
+  // Whether |window| still exists and is visible and not minimized.
+  virtual bool IsUsable(WindowHandle window) = 0;
+
+  // File name of the executable owning |window| (e.g. "Rouvy.exe"), or an
+  // empty string if it cannot be determined. This is the expensive call the
+  // resolver caches.
+  virtual std::string GetProcessName(WindowHandle window) = 0;
+};
+
+// Finds the window of a compatible trainer app without scanning the desktop
+// on every key press.
+//
+// The window -> process name mapping is cached until the window is destroyed
+// or no longer enumerated, and the resolved target (or the fact that none is running) is cached until
+// a window notification says the answer may have changed.
+class TargetWindowResolver {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t process_queries = 0;
+  };
+
+  // |process_names| are matched case-insensitively; earlier entries win when
+  // several apps are running.
+  TargetWindowResolver(WindowEnumerator* enumerator,
+                       std::vector<std::string> process_names);
+
+  // Returns the target window, or 0 if no compatible app has a usable window.
+  // When |process_name| is given it receives the matching entry of
+  // |process_names|.
+  WindowHandle Resolve(std::string* process_name = nullptr);
+
+  // Window notifications. Created/shown windows may be a better target, so
+  // they schedule a rescan; destroyed windows are dropped from the cache.
+  void OnWindowShown(WindowHandle window);
+  void OnWindowHidden(WindowHandle window);
+  void OnWindowDestroyed(WindowHandle window);
+
+  // Drops everything, e.g. when notifications could not be installed.
+  void Invalidate();
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  // Index into process_names_ for |window|, or -1.
+  int MatchWindow(WindowHandle window);
+  void Rescan();
+
+  WindowEnumerator* enumerator_;
+  std::vector<std::string> process_names_;
+  std::unordered_map<WindowHandle, int> window_matches_;
+  WindowHandle target_ = 0;
+  int target_index_ = -1;
+  bool stale_ = true;
+  Stats stats_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_WINDOW_RESOLVER_H_
@@ -0,0 +1,80 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_X11_KEY_TARGET_H_
+#define KEYPRESS_SIMULATOR_CORE_X11_KEY_TARGET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/input_batch.h"
+#include "keypress_simulator_core/window_resolver.h"
+
+namespace keypress_simulator_core {
+
+// The X11 modifier state bit (ShiftMask, ControlMask, Mod1Mask or Mod4Mask)
+// that holding the evdev key |code| adds to key events, or 0 for keys that
+// are not modifiers.
+unsigned int X11ModifierMaskForEvdevKey(uint16_t code);
+
+// Sends keys straight to the X11 window of a compatible trainer app, so the
+// app receives input without being focused. This is the Linux counterpart of
+// the Windows plugin posting WM_KEYDOWN/WM_KEYUP to the target window.
+//
+// Top-level windows come from _NET_CLIENT_LIST, or from the children of the
+// root window when no window manager runs (e.g. on Xvfb). A window matches by
+// its WM_CLASS instance name, which Wine sets to the executable name, or else
+// by the name of its _NET_WM_PID process. The match is cached by a
+// TargetWindowResolver, which SubstructureNotify events on the root window
+// keep up to date.
+//
+// Keys go out with XSendEvent: XTest can only type into the focused window.
+//
+// Owns a display connection of its own, separate from GDK's. Not
+// thread-safe: once opened, use it from one thread only, normally the
+// injection worker.
+class X11KeyTarget {
+ public:
+  // |app_names| are matched case-insensitively; earlier entries win.
+  explicit X11KeyTarget(std::vector<std::string> app_names);
+  ~X11KeyTarget();
+
+  // Disallow copy and assign.
+  X11KeyTarget(const X11KeyTarget&) = delete;
+  X11KeyTarget& operator=(const X11KeyTarget&) = delete;
+
+  // Connects to |display_name|, or to $DISPLAY when it is null. Returns
+  // false if there is no X server, e.g. in a Wayland session without
+  // Xwayland.
+  bool Open(const char* display_name = nullptr);
+
+  // Closes the connection. Called automatically on destruction.
+  void Close();
+
+  bool is_open() const { return connection_ != nullptr; }
+
+  // Sends |count| key transitions to the target window, unless it is focused
+  // already. Returns false if nothing was sent because there is no target or
+  // it has the focus; the caller then injects the keys the usual way.
+  //
+  // Delivery is asynchronous: keys sent to a window that was destroyed in
+  // the meantime are dropped.
+  bool SendKeys(const KeyTransition* transitions, size_t count);
+
+  // The window SendKeys() would send to, or 0 if no compatible app has a
+  // viewable window. Processes pending window notifications first.
+  WindowHandle ResolveTarget();
+
+  // Cache statistics of the target lookup. Only valid while open.
+  const TargetWindowResolver::Stats& resolver_stats() const;
+
+ private:
+  class Connection;
+
+  std::vector<std::string> app_names_;
+  std::unique_ptr<Connection> connection_;
+};
+
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_X11_KEY_TARGET_H_
@@ -0,0 +1,114 @@
+#include "keypress_simulator_core/injection_worker.h"
+
+#include <utility>
+
+namespace keypress_simulator_core {
+
+InjectionWorker::InjectionWorker() : thread_(&InjectionWorker::Run, this) {}
+
+InjectionWorker::~InjectionWorker() {
+  Stop();
+}
+
+bool InjectionWorker::Post(Task task, Completion on_done, TimePoint origin) {
+  Job job = {std::move(task), std::move(on_done), origin,
+             std::chrono::steady_clock::now()};
+  return Enqueue(std::move(job));
+}
+
+bool InjectionWorker::Enqueue(Job job) {
+  if (!queue_.TryPush(std::move(job))) {
+    return false;
+  }
+  // Pairs with the fence in Run(): either the worker sees the new job before
+  // it sleeps, or we see |waiting_| and wake it.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_one();
+  }
+  return true;
+}
+
+bool InjectionWorker::StartRepeat(ActionId id,
+                                  std::chrono::milliseconds initial_delay,
+                                  std::chrono::milliseconds interval,
+                                  Task tick,
+                                  Completion on_done) {
+  // Measured from the request rather than from when the worker gets to it.
+  auto start = std::chrono::steady_clock::now();
+  RepeatScheduler::Tick repeat = [tick = std::move(tick),
+                                  on_done = std::move(on_done)] {
+    bool succeeded = tick();
+    if (on_done) {
+      on_done(succeeded);
+    }
+  };
+  Job job;
+  job.task = [this, id, start, initial_delay, interval,
+              repeat = std::move(repeat)]() mutable {
+    return repeats_.Start(id, start, initial_delay, interval,
+                          std::move(repeat));
+  };
+  return Enqueue(std::move(job));
+}
+
+bool InjectionWorker::StopRepeat(ActionId id) {
+  Job job;
+  job.task = [this, id] {
+    repeats_.Stop(id);
+    return true;
+  };
+  return Enqueue(std::move(job));
+}
+
+void InjectionWorker::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_.store(true);
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void InjectionWorker::Run() {
+  Job job;
+  while (true) {
+    if (queue_.TryPop(&job)) {
+      TimePoint dequeued = std::chrono::steady_clock::now();
+      bool succeeded = job.task();
+      if (job.enqueued != TimePoint()) {
+        latency_.Record(job.origin, job.enqueued, dequeued,
+                        std::chrono::steady_clock::now());
+      }
+      if (job.on_done) {
+        job.on_done(succeeded);
+      }
+      job = Job();
+      continue;
+    }
+    if (!repeats_.empty() &&
+        repeats_.RunDue(std::chrono::steady_clock::now()) > 0) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto has_work = [this] { return stopping_.load() || !queue_.empty(); };
+    if (repeats_.empty()) {
+      wake_.wait(lock, has_work);
+    } else {
+      wake_.wait_until(lock, repeats_.next_deadline(), has_work);
+    }
+    waiting_.store(false, std::memory_order_relaxed);
+    if (stopping_.load() && queue_.empty()) {
+      return;
+    }
+  }
+}
+
+}  // namespace keypress_simulator_core
@@ -0,0 +1,28 @@
+#include "keypress_simulator_core/input_batch.h"
+
+namespace keypress_simulator_core {
+
+void KeyBatchBuilder::AddChord(uint8_t modifiers,
+                               uint16_t code,
+                               ChordPhase phase) {
+  if (phase != ChordPhase::kUp) {
+    AddModifiers(modifiers, true);
+    AddKey(code, true);
+  }
+  if (phase != ChordPhase::kDown) {
+    AddKey(code, false);
+    AddModifiers(modifiers, false);
+  }
+}
+
+void KeyBatchBuilder::AddModifiers(uint8_t modifiers, bool down) {
+  constexpr size_t kCount = sizeof(kModifierOrder) / sizeof(kModifierOrder[0]);
+  for (size_t n = 0; n < kCount; n++) {
+    size_t i = down ? n : kCount - 1 - n;
+    if (modifiers & kModifierOrder[i]) {
+      AddKey(modifier_codes_[i], down);
+    }
+  }
+}
+
+}  // namespace keypress_simulator_core
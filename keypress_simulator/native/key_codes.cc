@@ -0,0 +1,45 @@
+#include "keypress_simulator_core/key_codes.h"
+
+#include "keypress_simulator_core/key_table.h"
+
+namespace keypress_simulator_core {
+
+Modifier ModifierFromName(const std::string& name) {
+  if (name == "shiftModifier") {
+    return kModifierShift;
+  } else if (name == "controlModifier") {
+    return kModifierControl;
+  } else if (name == "altModifier") {
+    return kModifierAlt;
+  } else if (name == "metaModifier") {
+    return kModifierMeta;
+  }
+  return kModifierNone;
+}
+
+uint16_t EvdevKeyForPhysicalKey(uint32_t physical_key) {
+  const KeyCodes* codes = KeyCodesForPhysicalKey(physical_key);
+  return codes != nullptr ? codes->evdev : 0;
+}
+
+uint16_t EvdevKeyForModifier(Modifier modifier) {
+  switch (modifier) {
+    case kModifierShift:
+      return 42;  // KEY_LEFTSHIFT
+    case kModifierControl:
+      return 29;  // KEY_LEFTCTRL
+    case kModifierAlt:
+      return 56;  // KEY_LEFTALT
+    case kModifierMeta:
+      return 125;  // KEY_LEFTMETA
+    default:
+      return 0;
+  }
+}
+
+uint16_t EvdevKeyForMediaKey(const std::string& identifier) {
+  const KeyCodes* codes = KeyCodesForMediaKey(identifier);
+  return codes != nullptr ? codes->evdev : 0;
+}
+
+}  // namespace keypress_simulator_core
@@ -0,0 +1,144 @@
+#include "keypress_simulator_core/latency_stats.h"
+
+#include <algorithm>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// Index of the highest set bit of a non-zero |value| below 2^32.
+int HighestBit(uint64_t value) {
+  int bit = 0;
+  for (int shift = 16; shift > 0; shift /= 2) {
+    if (value >> shift) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+}
+
+// The smallest recorded value at or above |percentile| percent of |counts|.
+uint64_t ValueAtPercentile(const uint64_t* counts,
+                           uint64_t total,
+                           uint64_t max,
+                           int percentile) {
+  // Rank of the value, counting from 1: ceil(total * percentile / 100).
+  uint64_t rank = std::max<uint64_t>((total * percentile + 99) / 100, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(LatencyHistogram::BucketUpperBound(i), max);
+    }
+  }
+  return max;
+}
+
+}  // namespace
+
+size_t LatencyHistogram::BucketIndex(uint64_t micros) {
+  micros = std::min(micros, kMaxTrackable);
+  if (micros < kSubBucketCount) {
+    return static_cast<size_t>(micros);
+  }
+  // Keep the kSubBucketBits bits below the highest one.
+  int shift = HighestBit(micros) - kSubBucketBits;
+  uint64_t sub_bucket = (micros >> shift) - kSubBucketCount;
+  return static_cast<size_t>((shift + 1) * kSubBucketCount + sub_bucket);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t bucket) {
+  if (bucket < kSubBucketCount) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket / kSubBucketCount) - 1;
+  uint64_t sub_bucket = bucket % kSubBucketCount;
+  return ((kSubBucketCount + sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t micros) {
+  micros = std::min(micros, kMaxTrackable);
+  counts_[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (micros > max &&
+         !max_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Record(std::chrono::steady_clock::duration latency) {
+  auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+  Record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+}
+
+LatencySummary LatencyHistogram::Summarize() const {
+  // Work on a copy so the percentiles agree with each other even while
+  // values are being recorded.
+  uint64_t counts[kBucketCount];
+  LatencySummary summary;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    counts[i] = counts_[i].load(std::memory_order_relaxed);
+    summary.count += counts[i];
+  }
+  if (summary.count == 0) {
+    return summary;
+  }
+  summary.max = max_.load(std::memory_order_relaxed);
+  summary.p50 = ValueAtPercentile(counts, summary.count, summary.max, 50);
+  summary.p99 = ValueAtPercentile(counts, summary.count, summary.max, 99);
+  return summary;
+}
+
+void LatencyHistogram::Reset() {
+  for (std::atomic<uint64_t>& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  max_.store(0, std::memory_order_relaxed);
+}
+
+const char* LatencyStageName(LatencyStage stage) {
+  switch (stage) {
+    case LatencyStage::kDispatch:
+      return "dispatch";
+    case LatencyStage::kQueue:
+      return "queue";
+    case LatencyStage::kInject:
+      return "inject";
+    case LatencyStage::kTotal:
+      return "total";
+  }
+  return "";
+}
+
+void LatencyRecorder::Record(TimePoint origin,
+                             TimePoint enqueued,
+                             TimePoint dequeued,
+                             TimePoint injected) {
+  auto histogram = [this](LatencyStage stage) -> LatencyHistogram& {
+    return histograms_[static_cast<size_t>(stage)];
+  };
+  if (origin != TimePoint() && origin <= enqueued) {
+    histogram(LatencyStage::kDispatch).Record(enqueued - origin);
+    histogram(LatencyStage::kTotal).Record(injected - origin);
+  }
+  histogram(LatencyStage::kQueue).Record(dequeued - enqueued);
+  histogram(LatencyStage::kInject).Record(injected - dequeued);
+}
+
+void LatencyRecorder::Reset() {
+  for (LatencyHistogram& histogram : histograms_) {
+    histogram.Reset();
+  }
+}
+
+std::chrono::steady_clock::time_point LatencyOriginFromMicros(int64_t micros) {
+  if (micros <= 0) {
+    return std::chrono::steady_clock::time_point();
+  }
+  return std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::microseconds(micros)));
+}
+
+}  // namespace keypress_simulator_core
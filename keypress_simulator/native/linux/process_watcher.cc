@@ -0,0 +1,386 @@
+#include "keypress_simulator_core/process_watcher.h"
+
+#include <dirent.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// What an epoll event is for: the kind in the high half of data.u64, and the
+// process ID in the low half for pidfds.
+enum EventSource : uint64_t {
+  kStopSource = 1,
+  kTimerSource,
+  kNetlinkSource,
+  kPidfdSource,
+};
+
+uint64_t EventData(EventSource source, int32_t pid = 0) {
+  return (static_cast<uint64_t>(source) << 32) | static_cast<uint32_t>(pid);
+}
+
+bool AddToEpoll(int epoll_fd, int fd, uint64_t data) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = data;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+int OpenPidfd(int32_t pid) {
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  return -1;
+#endif
+}
+
+// Name of process |pid|, or an empty string if it has already exited.
+std::string ReadProcessName(int32_t pid) {
+  std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+  std::string name;
+  std::getline(comm, name);
+  return name;
+}
+
+// Subscribes to or unsubscribes from process events. cn_msg ends in a
+// flexible array, so the message is laid out by hand.
+bool SendProcConnectorOp(int fd, proc_cn_mcast_op op) {
+  alignas(nlmsghdr) char buffer[NLMSG_SPACE(sizeof(cn_msg) + sizeof(op))];
+  memset(buffer, 0, sizeof(buffer));
+  nlmsghdr* header = reinterpret_cast<nlmsghdr*>(buffer);
+  header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(op));
+  header->nlmsg_type = NLMSG_DONE;
+  header->nlmsg_pid = static_cast<__u32>(getpid());
+  cn_msg* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+  message->id.idx = CN_IDX_PROC;
+  message->id.val = CN_VAL_PROC;
+  message->len = sizeof(op);
+  memcpy(message->data, &op, sizeof(op));
+  return send(fd, buffer, header->nlmsg_len, 0) ==
+         static_cast<ssize_t>(header->nlmsg_len);
+}
+
+// Opens a netlink socket subscribed to the process events connector, or
+// returns -1. A refusal for lack of CAP_NET_ADMIN only arrives later, as an
+// acknowledgement carrying the error.
+int OpenProcConnector() {
+  int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  NETLINK_CONNECTOR);
+  if (fd < 0) {
+    return -1;
+  }
+  sockaddr_nl address = {};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = CN_IDX_PROC;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      !SendProcConnectorOp(fd, PROC_CN_MCAST_LISTEN)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace
+
+std::vector<ProcessInfo> ListProcesses() {
+  std::vector<ProcessInfo> processes;
+  DIR* proc = opendir("/proc");
+  if (proc == nullptr) {
+    return processes;
+  }
+  while (dirent* entry = readdir(proc)) {
+    char* end = nullptr;
+    long pid = strtol(entry->d_name, &end, 10);
+    if (*end != '\0' || pid <= 0) {
+      continue;
+    }
+    // "<pid> (<name>) <state> ...". The name may contain anything, so it
+    // ends at the last parenthesis.
+    std::ifstream stat_file("/proc/" + std::string(entry->d_name) + "/stat");
+    std::string stat;
+    std::getline(stat_file, stat);
+    size_t name_begin = stat.find('(');
+    size_t name_end = stat.rfind(')');
+    if (name_begin == std::string::npos || name_end == std::string::npos ||
+        name_end < name_begin || name_end + 2 >= stat.size()) {
+      continue;
+    }
+    // Exited processes stay in /proc until reaped; their pidfds have fired
+    // already, so counting them would report them as running again.
+    char state = stat[name_end + 2];
+    if (state == 'Z' || state == 'X') {
+      continue;
+    }
+    processes.push_back({static_cast<int32_t>(pid),
+                         stat.substr(name_begin + 1,
+                                     name_end - name_begin - 1)});
+  }
+  closedir(proc);
+  return processes;
+}
+
+ProcessWatcher::ProcessWatcher(std::vector<std::string> app_names,
+                               Callback callback)
+    : callback_(std::move(callback)), tracker_(std::move(app_names)) {}
+
+ProcessWatcher::~ProcessWatcher() {
+  Stop();
+}
+
+bool ProcessWatcher::Start(bool use_proc_connector,
+                           std::chrono::milliseconds poll_interval) {
+  if (thread_.joinable()) {
+    return true;
+  }
+  poll_interval_ = poll_interval;
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || timer_fd_ < 0 ||
+      !AddToEpoll(epoll_fd_, stop_fd_, EventData(kStopSource)) ||
+      !AddToEpoll(epoll_fd_, timer_fd_, EventData(kTimerSource))) {
+    Stop();
+    return false;
+  }
+
+  // Subscribe before the first scan, so no launch falls between the two.
+  if (use_proc_connector) {
+    netlink_fd_ = OpenProcConnector();
+    if (netlink_fd_ >= 0 &&
+        !AddToEpoll(epoll_fd_, netlink_fd_, EventData(kNetlinkSource))) {
+      CloseFd(&netlink_fd_);
+    }
+  }
+  uses_proc_connector_ = netlink_fd_ >= 0;
+  ArmScanTimer(uses_proc_connector_ ? kConnectorScanInterval : poll_interval_);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Change> initial;
+    tracker_.OnScan(ListProcesses(), &initial);
+    SyncPidfds();
+  }
+
+  thread_ = std::thread(&ProcessWatcher::Run, this);
+  return true;
+}
+
+void ProcessWatcher::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  if (netlink_fd_ >= 0) {
+    SendProcConnectorOp(netlink_fd_, PROC_CN_MCAST_IGNORE);
+  }
+  for (auto& entry : pidfds_) {
+    close(entry.second);
+  }
+  pidfds_.clear();
+  CloseFd(&netlink_fd_);
+  CloseFd(&timer_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+  uses_proc_connector_ = false;
+}
+
+std::vector<ProcessWatcher::Change> ProcessWatcher::RunningApps() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tracker_.RunningApps();
+}
+
+void ProcessWatcher::Run() {
+  constexpr int kMaxEvents = 16;
+  epoll_event events[kMaxEvents];
+  while (true) {
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+
+    std::vector<Change> changes;
+    bool scan = false;
+    for (int i = 0; i < count; i++) {
+      uint64_t data = events[i].data.u64;
+      switch (static_cast<EventSource>(data >> 32)) {
+        case kStopSource:
+          return;
+        case kTimerSource: {
+          uint64_t expirations = 0;
+          if (read(timer_fd_, &expirations, sizeof(expirations)) > 0) {
+            scan = true;
+          }
+          break;
+        }
+        case kNetlinkSource:
+          ReadProcEvents(&changes);
+          // A closed connector means polling from now on; scan right away
+          // for what may have been missed.
+          scan = scan || netlink_fd_ < 0;
+          break;
+        case kPidfdSource: {
+          std::lock_guard<std::mutex> lock(mutex_);
+          tracker_.OnProcessExited(static_cast<int32_t>(data & 0xFFFFFFFF),
+                                   &changes);
+          break;
+        }
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (scan) {
+        tracker_.OnScan(ListProcesses(), &changes);
+      }
+      SyncPidfds();
+    }
+    Report(changes);
+  }
+}
+
+void ProcessWatcher::ReadProcEvents(std::vector<Change>* changes) {
+  alignas(nlmsghdr) char buffer[4096];
+  while (netlink_fd_ >= 0) {
+    ssize_t size = recv(netlink_fd_, buffer, sizeof(buffer), 0);
+    if (size < 0) {
+      if (errno == ENOBUFS) {
+        // Events were dropped; the next scan catches up.
+        ArmScanTimer(std::chrono::milliseconds(1));
+        continue;
+      }
+      if (errno != EAGAIN && errno != EINTR) {
+        CloseProcConnector();
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int remaining = static_cast<int>(size);
+    for (nlmsghdr* header = reinterpret_cast<nlmsghdr*>(buffer);
+         NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+      if (header->nlmsg_type == NLMSG_ERROR ||
+          header->nlmsg_type == NLMSG_NOOP) {
+        continue;
+      }
+      const cn_msg* message = static_cast<const cn_msg*>(NLMSG_DATA(header));
+      if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+        continue;
+      }
+      const proc_event* event =
+          reinterpret_cast<const proc_event*>(message->data);
+      switch (event->what) {
+        case proc_event::PROC_EVENT_NONE:
+          // The acknowledgement of PROC_CN_MCAST_LISTEN.
+          if (event->event_data.ack.err != 0) {
+            CloseProcConnector();
+            return;
+          }
+          break;
+        case proc_event::PROC_EVENT_EXEC: {
+          int32_t pid = event->event_data.exec.process_tgid;
+          tracker_.OnProcessNamed(pid, ReadProcessName(pid), changes);
+          break;
+        }
+        case proc_event::PROC_EVENT_COMM:
+          // Wine names its processes after the .exe only after starting.
+          if (event->event_data.comm.process_pid ==
+              event->event_data.comm.process_tgid) {
+            tracker_.OnProcessNamed(event->event_data.comm.process_tgid,
+                                    event->event_data.comm.comm, changes);
+          }
+          break;
+        case proc_event::PROC_EVENT_EXIT:
+          if (event->event_data.exit.process_pid ==
+              event->event_data.exit.process_tgid) {
+            tracker_.OnProcessExited(event->event_data.exit.process_tgid,
+                                     changes);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+void ProcessWatcher::CloseProcConnector() {
+  CloseFd(&netlink_fd_);
+  uses_proc_connector_ = false;
+  ArmScanTimer(poll_interval_);
+}
+
+void ProcessWatcher::ArmScanTimer(std::chrono::milliseconds interval) {
+  auto to_timespec = [](std::chrono::milliseconds value) {
+    timespec spec;
+    spec.tv_sec = static_cast<time_t>(value.count() / 1000);
+    spec.tv_nsec = static_cast<long>(value.count() % 1000) * 1000000;
+    return spec;
+  };
+  itimerspec spec;
+  spec.it_value = to_timespec(interval);
+  // After a one-off catch-up scan, fall back to the regular interval.
+  spec.it_interval = to_timespec(
+      uses_proc_connector_ ? kConnectorScanInterval : poll_interval_);
+  timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+void ProcessWatcher::SyncPidfds() {
+  std::vector<int32_t> tracked = tracker_.TrackedPids();
+  for (auto it = pidfds_.begin(); it != pidfds_.end();) {
+    if (!tracker_.IsTracked(it->first)) {
+      close(it->second);
+      it = pidfds_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (int32_t pid : tracked) {
+    if (pidfds_.count(pid) != 0) {
+      continue;
+    }
+    // Without pidfds (kernels before 5.3) exits are found by the scans.
+    int fd = OpenPidfd(pid);
+    if (fd < 0) {
+      continue;
+    }
+    if (!AddToEpoll(epoll_fd_, fd, EventData(kPidfdSource, pid))) {
+      close(fd);
+      continue;
+    }
+    pidfds_.emplace(pid, fd);
+  }
+}
+
+void ProcessWatcher::Report(const std::vector<Change>& changes) {
+  for (const Change& change : changes) {
+    callback_(change);
+  }
+}
+
+}  // namespace keypress_simulator_core
@@ -0,0 +1,181 @@
+#include "keypress_simulator_core/uinput_device.h"
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+class SystemUinputBackend : public UinputBackend {
+ public:
+  int Open(const char* path, int flags) override { return open(path, flags); }
+
+  int Ioctl(int fd, unsigned long request, uintptr_t arg) override {
+    return ioctl(fd, request, arg);
+  }
+
+  ssize_t Write(int fd, const void* data, size_t size) override {
+    return write(fd, data, size);
+  }
+
+  int Close(int fd) override { return close(fd); }
+};
+
+// Every key code below this value is a keyboard key; BTN_* codes start at
+// 0x100 and only the mouse buttons are enabled so the device is not
+// mistaken for a joystick or tablet.
+constexpr int kLastKeyboardKey = 0xff;
+
+input_event MakeEvent(uint16_t type, uint16_t code, int32_t value) {
+  input_event event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.code = code;
+  event.value = value;
+  return event;
+}
+
+}  // namespace
+
+std::unique_ptr<UinputBackend> CreateSystemUinputBackend() {
+  return std::make_unique<SystemUinputBackend>();
+}
+
+UinputDevice::UinputDevice(std::unique_ptr<UinputBackend> backend)
+    : backend_(std::move(backend)) {}
+
+UinputDevice::~UinputDevice() {
+  Destroy();
+}
+
+bool UinputDevice::Create(int screen_width, int screen_height) {
+  if (is_open()) {
+    return true;
+  }
+
+  int fd = backend_->Open(kDevicePath, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool ok = backend_->Ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 &&
+            backend_->Ioctl(fd, UI_SET_EVBIT, EV_ABS) == 0 &&
+            backend_->Ioctl(fd, UI_SET_EVBIT, EV_SYN) == 0;
+  for (int code = KEY_ESC; ok && code <= kLastKeyboardKey; code++) {
+    ok = backend_->Ioctl(fd, UI_SET_KEYBIT, code) == 0;
+  }
+  for (int button : {BTN_LEFT, BTN_RIGHT, BTN_MIDDLE}) {
+    ok = ok && backend_->Ioctl(fd, UI_SET_KEYBIT, button) == 0;
+  }
+
+  max_x_ = std::max(screen_width - 1, 1);
+  max_y_ = std::max(screen_height - 1, 1);
+  for (const auto& axis : {std::make_pair(ABS_X, max_x_),
+                           std::make_pair(ABS_Y, max_y_)}) {
+    if (!ok) {
+      break;
+    }
+    uinput_abs_setup abs_setup;
+    memset(&abs_setup, 0, sizeof(abs_setup));
+    abs_setup.code = axis.first;
+    abs_setup.absinfo.minimum = 0;
+    abs_setup.absinfo.maximum = axis.second;
+    ok = backend_->Ioctl(fd, UI_SET_ABSBIT, axis.first) == 0 &&
+         backend_->Ioctl(fd, UI_ABS_SETUP,
+                         reinterpret_cast<uintptr_t>(&abs_setup)) == 0;
+  }
+
+  if (ok) {
+    uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = 0xb1c0;
+    setup.id.version = 1;
+    strncpy(setup.name, kDeviceName, UINPUT_MAX_NAME_SIZE - 1);
+    ok = backend_->Ioctl(fd, UI_DEV_SETUP,
+                         reinterpret_cast<uintptr_t>(&setup)) == 0 &&
+         backend_->Ioctl(fd, UI_DEV_CREATE, 0) == 0;
+  }
+
+  if (!ok) {
+    backend_->Close(fd);
+    return false;
+  }
+  fd_ = fd;
+  return true;
+}
+
+void UinputDevice::Destroy() {
+  if (!is_open()) {
+    return;
+  }
+  backend_->Ioctl(fd_, UI_DEV_DESTROY, 0);
+  backend_->Close(fd_);
+  fd_ = -1;
+}
+
+bool UinputDevice::SendKeys(const KeyTransition* transitions, size_t count) {
+  input_event events[kMaxBatchTransitions * 2];
+  while (count > 0) {
+    size_t batch = std::min(count, kMaxBatchTransitions);
+    size_t n = 0;
+    for (size_t i = 0; i < batch; i++) {
+      events[n++] =
+          MakeEvent(EV_KEY, transitions[i].code, transitions[i].down ? 1 : 0);
+      events[n++] = MakeEvent(EV_SYN, SYN_REPORT, 0);
+    }
+    if (!WriteEvents(events, n)) {
+      return false;
+    }
+    transitions += batch;
+    count -= batch;
+  }
+  return true;
+}
+
+bool UinputDevice::SendKey(uint16_t code, bool down) {
+  KeyTransition transition = {code, down};
+  return SendKeys(&transition, 1);
+}
+
+bool UinputDevice::TapKey(uint16_t code) {
+  KeyTransition transitions[] = {{code, true}, {code, false}};
+  return SendKeys(transitions, 2);
+}
+
+bool UinputDevice::SendClick(int x, int y, bool down) {
+  const input_event events[] = {
+      MakeEvent(EV_ABS, ABS_X, std::clamp(x, 0, max_x_)),
+      MakeEvent(EV_ABS, ABS_Y, std::clamp(y, 0, max_y_)),
+      MakeEvent(EV_SYN, SYN_REPORT, 0),
+      MakeEvent(EV_KEY, BTN_LEFT, down ? 1 : 0),
+      MakeEvent(EV_SYN, SYN_REPORT, 0),
+  };
+  return WriteEvents(events, sizeof(events) / sizeof(events[0]));
+}
+
+bool UinputDevice::MovePointer(int x, int y) {
+  const input_event events[] = {
+      MakeEvent(EV_ABS, ABS_X, std::clamp(x, 0, max_x_)),
+      MakeEvent(EV_ABS, ABS_Y, std::clamp(y, 0, max_y_)),
+      MakeEvent(EV_SYN, SYN_REPORT, 0),
+  };
+  return WriteEvents(events, sizeof(events) / sizeof(events[0]));
+}
+
+bool UinputDevice::WriteEvents(const input_event* events, size_t count) {
+  if (!is_open()) {
+    return false;
+  }
+  const size_t size = count * sizeof(input_event);
+  return backend_->Write(fd_, events, size) == static_cast<ssize_t>(size);
+}
+
+}  // namespace keypress_simulator_core
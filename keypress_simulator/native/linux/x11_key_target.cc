@@ -0,0 +1,372 @@
+#include "keypress_simulator_core/x11_key_target.h"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <linux/input-event-codes.h>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/key_table.h"
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// evdev codes are X keycodes minus 8 on every server using the evdev or
+// libinput drivers, Xwayland included. Used for keys without a keysym.
+constexpr int kEvdevKeycodeOffset = 8;
+
+// Depth at which HasFocus() gives up looking for the target above the focus
+// window; toolkits nest a few levels at most.
+constexpr int kMaxFocusDepth = 8;
+
+// Xlib reports errors through one process-wide handler, and the default one
+// exits. Errors on the connections below are expected (windows vanish
+// between two requests) and ignored; GDK's and anyone else's are forwarded.
+std::mutex g_error_mutex;
+std::vector<Display*> g_ignored_displays;
+XErrorHandler g_previous_error_handler = nullptr;
+
+int HandleXError(Display* display, XErrorEvent* event) {
+  XErrorHandler previous = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_error_mutex);
+    if (std::find(g_ignored_displays.begin(), g_ignored_displays.end(),
+                  display) != g_ignored_displays.end()) {
+      return 0;
+    }
+    previous = g_previous_error_handler;
+  }
+  return previous != nullptr ? previous(display, event) : 0;
+}
+
+void IgnoreErrors(Display* display) {
+  static std::once_flag installed;
+  std::call_once(installed, [] {
+    XErrorHandler previous = XSetErrorHandler(HandleXError);
+    std::lock_guard<std::mutex> lock(g_error_mutex);
+    g_previous_error_handler = previous;
+  });
+  std::lock_guard<std::mutex> lock(g_error_mutex);
+  g_ignored_displays.push_back(display);
+}
+
+void StopIgnoringErrors(Display* display) {
+  std::lock_guard<std::mutex> lock(g_error_mutex);
+  g_ignored_displays.erase(std::remove(g_ignored_displays.begin(),
+                                       g_ignored_displays.end(), display),
+                           g_ignored_displays.end());
+}
+
+// Reads the name of process |pid| from procfs. Truncated to 15 characters by
+// the kernel, which is enough for the executable names we look for.
+std::string ProcessName(unsigned long pid) {
+  std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+  std::string name;
+  std::getline(comm, name);
+  return name;
+}
+
+class X11WindowEnumerator : public WindowEnumerator {
+ public:
+  explicit X11WindowEnumerator(Display* display)
+      : display_(display),
+        root_(DefaultRootWindow(display)),
+        client_list_(XInternAtom(display, "_NET_CLIENT_LIST", False)),
+        wm_pid_(XInternAtom(display, "_NET_WM_PID", False)) {}
+
+  void EnumerateWindows(
+      const std::function<bool(WindowHandle)>& callback) override {
+    for (Window window : TopLevelWindows()) {
+      if (IsUsable(window) && !callback(window)) {
+        return;
+      }
+    }
+  }
+
+  Atom client_list() const { return client_list_; }
+
+  // Selects structure notifications on every managed window and returns
+  // them. Reparenting window managers put clients into frame windows, so
+  // their map, unmap and destroy notifications never reach the root window.
+  std::vector<Window> WatchClients() {
+    std::vector<unsigned long> clients =
+        ReadListProperty(root_, client_list_, XA_WINDOW);
+    for (unsigned long client : clients) {
+      XSelectInput(display_, client, StructureNotifyMask);
+    }
+    return std::vector<Window>(clients.begin(), clients.end());
+  }
+
+  bool IsUsable(WindowHandle window) override {
+    // Fails with BadWindow once the window is gone.
+    XWindowAttributes attributes;
+    return XGetWindowAttributes(display_, static_cast<Window>(window),
+                                &attributes) != 0 &&
+           attributes.map_state == IsViewable;
+  }
+
+  std::string GetProcessName(WindowHandle window) override {
+    std::string name;
+    XClassHint class_hint = {nullptr, nullptr};
+    if (XGetClassHint(display_, static_cast<Window>(window), &class_hint)) {
+      if (class_hint.res_name != nullptr) {
+        name = class_hint.res_name;
+      }
+      XFree(class_hint.res_name);
+      XFree(class_hint.res_class);
+    }
+    if (name.empty()) {
+      std::vector<unsigned long> pid =
+          ReadListProperty(static_cast<Window>(window), wm_pid_, XA_CARDINAL);
+      if (!pid.empty()) {
+        name = ProcessName(pid[0]);
+      }
+    }
+    return name;
+  }
+
+ private:
+  // The managed windows when a window manager maintains _NET_CLIENT_LIST,
+  // otherwise the children of the root window.
+  std::vector<Window> TopLevelWindows() {
+    std::vector<unsigned long> clients =
+        ReadListProperty(root_, client_list_, XA_WINDOW);
+    if (!clients.empty()) {
+      return std::vector<Window>(clients.begin(), clients.end());
+    }
+    std::vector<Window> windows;
+    Window root = 0;
+    Window parent = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (XQueryTree(display_, root_, &root, &parent, &children, &count)) {
+      windows.assign(children, children + count);
+    }
+    if (children != nullptr) {
+      XFree(children);
+    }
+    return windows;
+  }
+
+  // Reads a 32-bit list property of |type|, e.g. a window list or a
+  // cardinal. Xlib hands format 32 out as longs.
+  std::vector<unsigned long> ReadListProperty(Window window,
+                                              Atom property,
+                                              Atom type) {
+    Atom actual_type = 0;
+    int actual_format = 0;
+    unsigned long count = 0;
+    unsigned long bytes_after = 0;
+    unsigned char* data = nullptr;
+    std::vector<unsigned long> values;
+    if (XGetWindowProperty(display_, window, property, 0, 4096, False, type,
+                           &actual_type, &actual_format, &count, &bytes_after,
+                           &data) == Success &&
+        actual_type == type && actual_format == 32 && data != nullptr) {
+      const unsigned long* items = reinterpret_cast<unsigned long*>(data);
+      values.assign(items, items + count);
+    }
+    if (data != nullptr) {
+      XFree(data);
+    }
+    return values;
+  }
+
+  Display* display_;
+  Window root_;
+  Atom client_list_;
+  Atom wm_pid_;
+};
+
+}  // namespace
+
+class X11KeyTarget::Connection {
+ public:
+  Connection(Display* display, const std::vector<std::string>& app_names)
+      : display(display),
+        root(DefaultRootWindow(display)),
+        enumerator(display),
+        resolver(&enumerator, app_names) {
+    IgnoreErrors(display);
+    // Window creation, mapping and destruction below the root window: the
+    // notifications the resolver needs to know when to rescan. The same
+    // for managed windows, which a window manager may have reparented, and
+    // changes to the list of them.
+    XSelectInput(display, root, SubstructureNotifyMask | PropertyChangeMask);
+    enumerator.WatchClients();
+  }
+
+  ~Connection() {
+    StopIgnoringErrors(display);
+    XCloseDisplay(display);
+  }
+
+  void ProcessEvents() {
+    while (XPending(display) > 0) {
+      XEvent event;
+      XNextEvent(display, &event);
+      switch (event.type) {
+        case CreateNotify:
+          resolver.OnWindowShown(event.xcreatewindow.window);
+          break;
+        case MapNotify:
+          resolver.OnWindowShown(event.xmap.window);
+          break;
+        case UnmapNotify:
+          resolver.OnWindowHidden(event.xunmap.window);
+          break;
+        case DestroyNotify:
+          resolver.OnWindowDestroyed(event.xdestroywindow.window);
+          break;
+        case PropertyNotify:
+          if (event.xproperty.atom == enumerator.client_list()) {
+            for (Window window : enumerator.WatchClients()) {
+              resolver.OnWindowShown(window);
+            }
+          }
+          break;
+        case MappingNotify:
+          // Sent to every client: the keysym -> keycode mapping changed.
+          XRefreshKeyboardMapping(&event.xmapping);
+          break;
+      }
+    }
+  }
+
+  // Whether the input focus is on |window| or one of its descendants.
+  bool HasFocus(Window window) {
+    Window focus = 0;
+    int revert_to = 0;
+    XGetInputFocus(display, &focus, &revert_to);
+    for (int depth = 0; depth < kMaxFocusDepth; depth++) {
+      if (focus == window) {
+        return true;
+      }
+      if (focus == None || focus == PointerRoot || focus == root) {
+        return false;
+      }
+      Window focus_root = 0;
+      Window parent = 0;
+      Window* children = nullptr;
+      unsigned int count = 0;
+      if (!XQueryTree(display, focus, &focus_root, &parent, &children,
+                      &count)) {
+        return false;
+      }
+      if (children != nullptr) {
+        XFree(children);
+      }
+      focus = parent;
+    }
+    return false;
+  }
+
+  KeyCode KeycodeForEvdevKey(uint16_t code) {
+    const KeyCodes* codes = KeyCodesForEvdevKey(code);
+    if (codes != nullptr && codes->x11_keysym != 0) {
+      KeyCode keycode = XKeysymToKeycode(display, codes->x11_keysym);
+      if (keycode != 0) {
+        return keycode;
+      }
+    }
+    return static_cast<KeyCode>(code + kEvdevKeycodeOffset);
+  }
+
+  Display* display;
+  Window root;
+  X11WindowEnumerator enumerator;
+  TargetWindowResolver resolver;
+};
+
+unsigned int X11ModifierMaskForEvdevKey(uint16_t code) {
+  switch (code) {
+    case KEY_LEFTSHIFT:
+    case KEY_RIGHTSHIFT:
+      return ShiftMask;
+    case KEY_LEFTCTRL:
+    case KEY_RIGHTCTRL:
+      return ControlMask;
+    case KEY_LEFTALT:
+    case KEY_RIGHTALT:
+      return Mod1Mask;
+    case KEY_LEFTMETA:
+    case KEY_RIGHTMETA:
+      return Mod4Mask;
+  }
+  return 0;
+}
+
+X11KeyTarget::X11KeyTarget(std::vector<std::string> app_names)
+    : app_names_(std::move(app_names)) {}
+
+X11KeyTarget::~X11KeyTarget() {
+  Close();
+}
+
+bool X11KeyTarget::Open(const char* display_name) {
+  if (is_open()) {
+    return true;
+  }
+  Display* display = XOpenDisplay(display_name);
+  if (display == nullptr) {
+    return false;
+  }
+  connection_ = std::make_unique<Connection>(display, app_names_);
+  return true;
+}
+
+void X11KeyTarget::Close() {
+  connection_.reset();
+}
+
+bool X11KeyTarget::SendKeys(const KeyTransition* transitions, size_t count) {
+  Window target = static_cast<Window>(ResolveTarget());
+  if (target == 0 || connection_->HasFocus(target)) {
+    return false;
+  }
+
+  // X key events carry the modifier state from just before the event, so
+  // the state is updated after each transition is sent.
+  unsigned int state = 0;
+  for (size_t i = 0; i < count; i++) {
+    XKeyEvent event = {};
+    event.type = transitions[i].down ? KeyPress : KeyRelease;
+    event.display = connection_->display;
+    event.window = target;
+    event.root = connection_->root;
+    event.subwindow = None;
+    event.time = CurrentTime;
+    event.same_screen = True;
+    event.state = state;
+    event.keycode = connection_->KeycodeForEvdevKey(transitions[i].code);
+    XSendEvent(connection_->display, target, True,
+               transitions[i].down ? KeyPressMask : KeyReleaseMask,
+               reinterpret_cast<XEvent*>(&event));
+
+    unsigned int mask = X11ModifierMaskForEvdevKey(transitions[i].code);
+    state = transitions[i].down ? state | mask : state & ~mask;
+  }
+  XFlush(connection_->display);
+  return true;
+}
+
+WindowHandle X11KeyTarget::ResolveTarget() {
+  if (!is_open()) {
+    return 0;
+  }
+  connection_->ProcessEvents();
+  return connection_->resolver.Resolve();
+}
+
+const TargetWindowResolver::Stats& X11KeyTarget::resolver_stats() const {
+  return connection_->resolver.stats();
+}
+
+}  // namespace keypress_simulator_core
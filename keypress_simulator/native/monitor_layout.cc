@@ -0,0 +1,80 @@
+#include "keypress_simulator_core/monitor_layout.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// Squared distance from (x, y) to the closest point of |monitor|.
+int64_t DistanceSquared(const Monitor& monitor, int32_t x, int32_t y) {
+  int64_t dx = 0;
+  if (x < monitor.left) {
+    dx = static_cast<int64_t>(monitor.left) - x;
+  } else if (x >= monitor.right) {
+    dx = static_cast<int64_t>(x) - (monitor.right - 1);
+  }
+  int64_t dy = 0;
+  if (y < monitor.top) {
+    dy = static_cast<int64_t>(monitor.top) - y;
+  } else if (y >= monitor.bottom) {
+    dy = static_cast<int64_t>(y) - (monitor.bottom - 1);
+  }
+  return dx * dx + dy * dy;
+}
+
+}  // namespace
+
+MonitorLayout::MonitorLayout(std::vector<Monitor> monitors)
+    : monitors_(std::move(monitors)) {
+  std::sort(monitors_.begin(), monitors_.end(),
+            [](const Monitor& a, const Monitor& b) { return a.left < b.left; });
+  max_right_.reserve(monitors_.size());
+  int32_t max_right = std::numeric_limits<int32_t>::min();
+  for (const Monitor& monitor : monitors_) {
+    max_right = std::max(max_right, monitor.right);
+    max_right_.push_back(max_right);
+  }
+}
+
+const Monitor* MonitorLayout::Find(int32_t x, int32_t y) const {
+  // Monitors after |end| start right of x. Walking back, once no earlier
+  // monitor reaches past x there is nothing left to check.
+  auto end = std::upper_bound(monitors_.begin(), monitors_.end(), x,
+                              [](int32_t value, const Monitor& monitor) {
+                                return value < monitor.left;
+                              });
+  for (size_t i = end - monitors_.begin(); i > 0 && max_right_[i - 1] > x;
+       i--) {
+    if (monitors_[i - 1].Contains(x, y)) {
+      return &monitors_[i - 1];
+    }
+  }
+
+  // Off-screen points are rare; a linear search is fine.
+  const Monitor* nearest = nullptr;
+  int64_t nearest_distance = std::numeric_limits<int64_t>::max();
+  for (const Monitor& monitor : monitors_) {
+    int64_t distance = DistanceSquared(monitor, x, y);
+    if (distance < nearest_distance) {
+      nearest = &monitor;
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+void MonitorLayout::MapPoint(double x,
+                             double y,
+                             double* mapped_x,
+                             double* mapped_y) const {
+  const Monitor* monitor =
+      Find(static_cast<int32_t>(x), static_cast<int32_t>(y));
+  double scale = monitor != nullptr ? monitor->scale : 1.0;
+  *mapped_x = x * scale;
+  *mapped_y = y * scale;
+}
+
+}  // namespace keypress_simulator_core
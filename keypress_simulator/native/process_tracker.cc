@@ -0,0 +1,132 @@
+#include "keypress_simulator_core/process_tracker.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+// TASK_COMM_LEN minus the terminator.
+constexpr size_t kMaxProcessNameLength = 15;
+
+std::string MatchKey(std::string name) {
+  if (name.size() > kMaxProcessNameLength) {
+    name.resize(kMaxProcessNameLength);
+  }
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char c) {
+                   return static_cast<char>(std::tolower(c));
+                 });
+  return name;
+}
+
+}  // namespace
+
+ProcessTracker::ProcessTracker(std::vector<std::string> app_names)
+    : app_names_(std::move(app_names)), process_counts_(app_names_.size()) {
+  for (const std::string& name : app_names_) {
+    match_names_.push_back(MatchKey(name));
+  }
+}
+
+void ProcessTracker::OnProcessNamed(int32_t pid,
+                                    const std::string& name,
+                                    std::vector<Change>* changes) {
+  int app = MatchName(name);
+  auto it = pids_.find(pid);
+  if (it != pids_.end() && it->second == app) {
+    return;
+  }
+  if (it != pids_.end()) {
+    Untrack(pid, changes);
+  }
+  if (app >= 0) {
+    Track(pid, app, changes);
+  }
+}
+
+void ProcessTracker::OnProcessExited(int32_t pid,
+                                     std::vector<Change>* changes) {
+  if (IsTracked(pid)) {
+    Untrack(pid, changes);
+  }
+}
+
+void ProcessTracker::OnScan(const std::vector<ProcessInfo>& processes,
+                            std::vector<Change>* changes) {
+  std::unordered_set<int32_t> seen;
+  for (const ProcessInfo& process : processes) {
+    seen.insert(process.pid);
+    OnProcessNamed(process.pid, process.name, changes);
+  }
+  std::vector<int32_t> gone;
+  for (const auto& entry : pids_) {
+    if (seen.count(entry.first) == 0) {
+      gone.push_back(entry.first);
+    }
+  }
+  // Report in a stable order rather than the hash map's.
+  std::sort(gone.begin(), gone.end());
+  for (int32_t pid : gone) {
+    Untrack(pid, changes);
+  }
+}
+
+std::vector<int32_t> ProcessTracker::TrackedPids() const {
+  std::vector<int32_t> pids;
+  pids.reserve(pids_.size());
+  for (const auto& entry : pids_) {
+    pids.push_back(entry.first);
+  }
+  return pids;
+}
+
+std::vector<ProcessTracker::Change> ProcessTracker::RunningApps() const {
+  // The lowest PID of each app, usually the one that started first.
+  std::vector<int32_t> pids(app_names_.size(), -1);
+  for (const auto& entry : pids_) {
+    int32_t& pid = pids[entry.second];
+    if (pid < 0 || entry.first < pid) {
+      pid = entry.first;
+    }
+  }
+  std::vector<Change> running;
+  for (size_t i = 0; i < app_names_.size(); i++) {
+    if (pids[i] >= 0) {
+      running.push_back({app_names_[i], pids[i], true});
+    }
+  }
+  return running;
+}
+
+int ProcessTracker::MatchName(const std::string& name) const {
+  const std::string key = MatchKey(name);
+  for (size_t i = 0; i < match_names_.size(); i++) {
+    if (match_names_[i] == key) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void ProcessTracker::Track(int32_t pid,
+                           int app,
+                           std::vector<Change>* changes) {
+  pids_.emplace(pid, app);
+  if (process_counts_[app]++ == 0) {
+    changes->push_back({app_names_[app], pid, true});
+  }
+}
+
+void ProcessTracker::Untrack(int32_t pid, std::vector<Change>* changes) {
+  auto it = pids_.find(pid);
+  int app = it->second;
+  pids_.erase(it);
+  if (--process_counts_[app] == 0) {
+    changes->push_back({app_names_[app], pid, false});
+  }
+}
+
+}  // namespace keypress_simulator_core
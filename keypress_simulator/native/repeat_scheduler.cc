@@ -0,0 +1,70 @@
+#include "keypress_simulator_core/repeat_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace keypress_simulator_core {
+
+bool IsValidRepeatTiming(std::chrono::milliseconds initial_delay,
+                         std::chrono::milliseconds interval) {
+  return initial_delay.count() >= 0 && initial_delay <= kMaxRepeatDelay &&
+         interval >= kMinRepeatInterval && interval <= kMaxRepeatDelay;
+}
+
+bool RepeatScheduler::Start(ActionId id,
+                            TimePoint start,
+                            std::chrono::milliseconds initial_delay,
+                            std::chrono::milliseconds interval,
+                            Tick tick) {
+  if (!IsValidRepeatTiming(initial_delay, interval)) {
+    return false;
+  }
+  Repeat repeat = {id, start + initial_delay, interval, std::move(tick)};
+  for (Repeat& running : repeats_) {
+    if (running.id == id) {
+      running = std::move(repeat);
+      return true;
+    }
+  }
+  if (repeats_.size() >= kMaxRepeats) {
+    return false;
+  }
+  repeats_.push_back(std::move(repeat));
+  return true;
+}
+
+bool RepeatScheduler::Stop(ActionId id) {
+  auto it =
+      std::find_if(repeats_.begin(), repeats_.end(),
+                   [id](const Repeat& repeat) { return repeat.id == id; });
+  if (it == repeats_.end()) {
+    return false;
+  }
+  repeats_.erase(it);
+  return true;
+}
+
+RepeatScheduler::TimePoint RepeatScheduler::next_deadline() const {
+  TimePoint next = repeats_.front().deadline;
+  for (const Repeat& repeat : repeats_) {
+    next = std::min(next, repeat.deadline);
+  }
+  return next;
+}
+
+size_t RepeatScheduler::RunDue(TimePoint now) {
+  size_t ran = 0;
+  for (Repeat& repeat : repeats_) {
+    if (repeat.deadline > now) {
+      continue;
+    }
+    repeat.tick();
+    ran++;
+    // Advance on the grid, past any ticks that were missed entirely.
+    auto missed = (now - repeat.deadline) / repeat.interval;
+    repeat.deadline += (missed + 1) * repeat.interval;
+  }
+  return ran;
+}
+
+}  // namespace keypress_simulator_core
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "keypress_simulator_core/action_table.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+constexpr uint16_t kShift = 101;
+constexpr uint16_t kControl = 102;
+constexpr uint16_t kKeyR = 1;
+constexpr uint16_t kKeyS = 2;
+
+const ModifierKeyCodes kModifierCodes = {kShift, kControl, 103, 104};
+
+KeyTransition Identity(const KeyTransition& transition) {
+  return transition;
+}
+
+std::vector<KeyTransition> ToVector(
+    const ActionTable<KeyTransition>::Range& range) {
+  return std::vector<KeyTransition>(range.begin(), range.end());
+}
+
+}  // namespace
+
+TEST(ActionTable, SplitsChordIntoPhases) {
+  ActionTable<KeyTransition> table;
+  ASSERT_TRUE(
+      table.SetChord(3, kModifierControl, kKeyR, kModifierCodes, Identity));
+
+  std::vector<KeyTransition> down = {{kControl, true}, {kKeyR, true}};
+  std::vector<KeyTransition> up = {{kKeyR, false}, {kControl, false}};
+  std::vector<KeyTransition> tap = {
+      {kControl, true}, {kKeyR, true}, {kKeyR, false}, {kControl, false}};
+  EXPECT_EQ(ToVector(table.Get(3, ChordPhase::kDown)), down);
+  EXPECT_EQ(ToVector(table.Get(3, ChordPhase::kUp)), up);
+  EXPECT_EQ(ToVector(table.Get(3, ChordPhase::kTap)), tap);
+}
+
+TEST(ActionTable, UnknownActionsAreEmpty) {
+  ActionTable<KeyTransition> table;
+  ASSERT_TRUE(table.SetChord(2, 0, kKeyR, kModifierCodes, Identity));
+
+  EXPECT_FALSE(table.Contains(0));
+  EXPECT_TRUE(table.Get(0, ChordPhase::kTap).empty());
+  EXPECT_TRUE(table.Get(7, ChordPhase::kTap).empty());
+  EXPECT_FALSE(
+      table.SetChord(kMaxActionId, 0, kKeyR, kModifierCodes, Identity));
+}
+
+TEST(ActionTable, ResolvesEventsOnlyAtRegistration) {
+  int resolve_calls = 0;
+  ActionTable<uint32_t> table;
+  table.SetChord(0, kModifierShift, kKeyS, kModifierCodes,
+                 [&](const KeyTransition& transition) {
+                   resolve_calls++;
+                   return transition.code * 10u + (transition.down ? 1 : 0);
+                 });
+  EXPECT_EQ(resolve_calls, 4);
+
+  auto range = table.Get(0, ChordPhase::kDown);
+  std::vector<uint32_t> down(range.begin(), range.end());
+  EXPECT_EQ(down, (std::vector<uint32_t>{kShift * 10 + 1, kKeyS * 10 + 1}));
+  table.Get(0, ChordPhase::kTap);
+  EXPECT_EQ(resolve_calls, 4);
+}
+
+TEST(ActionTable, ClearForgetsActions) {
+  ActionTable<KeyTransition> table;
+  table.SetChord(0, 0, kKeyR, kModifierCodes, Identity);
+  table.Clear();
+  EXPECT_FALSE(table.Contains(0));
+  EXPECT_TRUE(table.Get(0, ChordPhase::kDown).empty());
+}
+
+TEST(ActionCall, RoundTrips) {
+  ActionId id = 0;
+  ChordPhase phase = ChordPhase::kDown;
+  ASSERT_TRUE(
+      DecodeActionCall(EncodeActionCall(42, ChordPhase::kUp), &id, &phase));
+  EXPECT_EQ(id, 42u);
+  EXPECT_EQ(phase, ChordPhase::kUp);
+
+  EXPECT_FALSE(DecodeActionCall(-1, &id, &phase));
+  EXPECT_FALSE(DecodeActionCall(3, &id, &phase));
+  EXPECT_FALSE(DecodeActionCall(
+      EncodeActionCall(kMaxActionId, ChordPhase::kTap), &id, &phase));
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "keypress_simulator_core/drag_gesture.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+// Advances only when slept on, so timing can be checked exactly.
+class FakeDragClock : public DragClock {
+ public:
+  TimePoint Now() override { return now_; }
+  void SleepUntil(TimePoint deadline) override {
+    now_ = std::max(now_, deadline);
+  }
+
+  void Advance(nanoseconds delta) { now_ += delta; }
+
+ private:
+  TimePoint now_;
+};
+
+struct PointerEvent {
+  enum Kind { kDown, kMove, kUp };
+  Kind kind;
+  PointF point;
+  nanoseconds time;
+};
+
+class RecordingSink : public PointerSink {
+ public:
+  explicit RecordingSink(FakeDragClock* clock)
+      : clock_(clock), start_(clock->Now()) {}
+
+  bool Move(const PointF& point) override {
+    Record(PointerEvent::kMove, point);
+    return fail_after_ < 0 || static_cast<int>(events.size()) <= fail_after_;
+  }
+
+  bool Button(const PointF& point, bool down) override {
+    Record(down ? PointerEvent::kDown : PointerEvent::kUp, point);
+    return true;
+  }
+
+  std::vector<PointerEvent> events;
+  // Moves fail once this many events were recorded; -1 never fails.
+  int fail_after_ = -1;
+
+ private:
+  void Record(PointerEvent::Kind kind, const PointF& point) {
+    events.push_back({kind, point, clock_->Now() - start_});
+  }
+
+  FakeDragClock* clock_;
+  DragClock::TimePoint start_;
+};
+
+double Distance(const PointF& a, const PointF& b) {
+  return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+}  // namespace
+
+TEST(Easing, ParsesDartNames) {
+  Easing easing = Easing::kLinear;
+  EXPECT_TRUE(EasingFromName("easeInOut", &easing));
+  EXPECT_EQ(easing, Easing::kEaseInOut);
+  EXPECT_TRUE(EasingFromName("easeOut", &easing));
+  EXPECT_EQ(easing, Easing::kEaseOut);
+  EXPECT_FALSE(EasingFromName("bounce", &easing));
+}
+
+TEST(Easing, StartsAndEndsOnTheEndpoints) {
+  for (Easing easing : {Easing::kLinear, Easing::kEaseIn, Easing::kEaseOut,
+                        Easing::kEaseInOut}) {
+    EXPECT_DOUBLE_EQ(ApplyEasing(easing, 0), 0);
+    EXPECT_DOUBLE_EQ(ApplyEasing(easing, 1), 1);
+    EXPECT_NEAR(ApplyEasing(easing, 0.5) + ApplyEasing(easing, 0.5),
+                easing == Easing::kEaseIn    ? 0.25
+                : easing == Easing::kEaseOut ? 1.75
+                                             : 1.0,
+                1e-9);
+  }
+}
+
+TEST(BuildDragGesture, ValidatesArguments) {
+  DragGesture gesture;
+  const double xy[] = {1, 2, 30, 40};
+  EXPECT_EQ(BuildDragGesture(xy, 4, 250, "easeOut", &gesture), nullptr);
+  ASSERT_EQ(gesture.path.size(), 2u);
+  EXPECT_DOUBLE_EQ(gesture.path[1].x, 30);
+  EXPECT_DOUBLE_EQ(gesture.path[1].y, 40);
+  EXPECT_EQ(gesture.duration, milliseconds(250));
+  EXPECT_EQ(gesture.easing, Easing::kEaseOut);
+
+  EXPECT_NE(BuildDragGesture(xy, 0, 250, "linear", &gesture), nullptr);
+  EXPECT_NE(BuildDragGesture(xy, 3, 250, "linear", &gesture), nullptr);
+  EXPECT_NE(BuildDragGesture(xy, 4, -1, "linear", &gesture), nullptr);
+  EXPECT_NE(BuildDragGesture(xy, 4, kMaxDragDuration.count() + 1, "linear",
+                             &gesture),
+            nullptr);
+  EXPECT_NE(BuildDragGesture(xy, 4, 250, "bounce", &gesture), nullptr);
+  std::vector<double> long_path((kMaxDragPathPoints + 1) * 2);
+  EXPECT_NE(BuildDragGesture(long_path.data(), long_path.size(), 250,
+                             "linear", &gesture),
+            nullptr);
+}
+
+TEST(DragPlan, FollowsPolylineAtConstantSpeed) {
+  // An L-shaped path: 300 px right, then 100 px down.
+  DragGesture gesture = {{{0, 0}, {300, 0}, {300, 100}},
+                         milliseconds(400),
+                         Easing::kLinear};
+  DragPlan plan(gesture, milliseconds(100));
+  ASSERT_EQ(plan.steps(), 4u);
+
+  EXPECT_EQ(plan.TimeOf(0), nanoseconds(0));
+  EXPECT_EQ(plan.TimeOf(4), milliseconds(400));
+  EXPECT_DOUBLE_EQ(plan.PointOf(1).x, 100);
+  EXPECT_DOUBLE_EQ(plan.PointOf(3).x, 300);
+  EXPECT_DOUBLE_EQ(plan.PointOf(3).y, 0);
+  EXPECT_DOUBLE_EQ(plan.PointOf(4).y, 100);
+}
+
+TEST(DragPlan, SinglePointPathStaysPut) {
+  DragGesture gesture = {{{42, 7}}, milliseconds(0), Easing::kEaseInOut};
+  DragPlan plan(gesture);
+  EXPECT_EQ(plan.steps(), 1u);
+  EXPECT_DOUBLE_EQ(plan.PointOf(1).x, 42);
+  EXPECT_DOUBLE_EQ(plan.PointOf(1).y, 7);
+}
+
+TEST(PerformDrag, MovesAtASteadyRate) {
+  FakeDragClock clock;
+  RecordingSink sink(&clock);
+  DragGesture gesture = {{{0, 0}, {400, 0}}, milliseconds(200),
+                         Easing::kLinear};
+
+  ASSERT_TRUE(PerformDrag(gesture, &sink, &clock, milliseconds(8)));
+
+  // Press, 25 moves, release.
+  ASSERT_EQ(sink.events.size(), 27u);
+  EXPECT_EQ(sink.events.front().kind, PointerEvent::kDown);
+  EXPECT_EQ(sink.events.back().kind, PointerEvent::kUp);
+  EXPECT_DOUBLE_EQ(sink.events.back().point.x, 400);
+  for (size_t i = 1; i + 1 < sink.events.size(); i++) {
+    const PointerEvent& event = sink.events[i];
+    EXPECT_EQ(event.kind, PointerEvent::kMove);
+    EXPECT_EQ(event.time, milliseconds(8) * static_cast<int>(i));
+    EXPECT_NEAR(Distance(event.point, sink.events[i - 1].point), 16, 1e-9);
+  }
+}
+
+TEST(PerformDrag, EaseInOutIsSlowAtBothEnds) {
+  FakeDragClock clock;
+  RecordingSink sink(&clock);
+  DragGesture gesture = {{{0, 0}, {0, 1000}}, milliseconds(160),
+                         Easing::kEaseInOut};
+
+  ASSERT_TRUE(PerformDrag(gesture, &sink, &clock, milliseconds(8)));
+  ASSERT_EQ(sink.events.size(), 22u);
+
+  double first = Distance(sink.events[1].point, sink.events[0].point);
+  double middle = Distance(sink.events[11].point, sink.events[10].point);
+  double last = Distance(sink.events[20].point, sink.events[19].point);
+  EXPECT_LT(first, middle);
+  EXPECT_LT(last, middle);
+}
+
+TEST(PerformDrag, LateWakeUpsDoNotShiftLaterSamples) {
+  // A clock that always oversleeps by 3 ms.
+  class LateClock : public FakeDragClock {
+   public:
+    void SleepUntil(TimePoint deadline) override {
+      FakeDragClock::SleepUntil(deadline);
+      Advance(milliseconds(3));
+    }
+  };
+  LateClock clock;
+  RecordingSink sink(&clock);
+  DragGesture gesture = {{{0, 0}, {100, 0}}, milliseconds(80),
+                         Easing::kLinear};
+
+  ASSERT_TRUE(PerformDrag(gesture, &sink, &clock, milliseconds(8)));
+  // Without absolute deadlines the error would add up to 30 ms.
+  EXPECT_EQ(sink.events[sink.events.size() - 2].time, milliseconds(83));
+}
+
+TEST(PerformDrag, ReleasesButtonWhenAMoveFails) {
+  FakeDragClock clock;
+  RecordingSink sink(&clock);
+  sink.fail_after_ = 3;
+  DragGesture gesture = {{{0, 0}, {100, 0}}, milliseconds(80),
+                         Easing::kLinear};
+
+  EXPECT_FALSE(PerformDrag(gesture, &sink, &clock, milliseconds(8)));
+  ASSERT_EQ(sink.events.size(), 5u);
+  EXPECT_EQ(sink.events.back().kind, PointerEvent::kUp);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,81 @@
+#ifndef KEYPRESS_SIMULATOR_CORE_TEST_FAKE_WINDOW_ENUMERATOR_H_
+#define KEYPRESS_SIMULATOR_CORE_TEST_FAKE_WINDOW_ENUMERATOR_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/window_resolver.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+// An in-memory window table standing in for EnumWindows.
+class FakeWindowEnumerator : public WindowEnumerator {
+ public:
+  struct Window {
+    WindowHandle handle;
+    std::string process_name;
+    bool usable;
+  };
+
+  void Add(WindowHandle handle, const std::string& process_name) {
+    windows_.push_back({handle, process_name, true});
+  }
+
+  void Remove(WindowHandle handle) {
+    windows_.erase(std::remove_if(windows_.begin(), windows_.end(),
+                                  [handle](const Window& window) {
+                                    return window.handle == handle;
+                                  }),
+                   windows_.end());
+  }
+
+  void SetUsable(WindowHandle handle, bool usable) {
+    for (Window& window : windows_) {
+      if (window.handle == handle) {
+        window.usable = usable;
+      }
+    }
+  }
+
+  void EnumerateWindows(
+      const std::function<bool(WindowHandle)>& callback) override {
+    enumerations_++;
+    for (const Window& window : windows_) {
+      if (window.usable && !callback(window.handle)) {
+        return;
+      }
+    }
+  }
+
+  bool IsUsable(WindowHandle handle) override {
+    const Window* window = Find(handle);
+    return window != nullptr && window->usable;
+  }
+
+  std::string GetProcessName(WindowHandle handle) override {
+    const Window* window = Find(handle);
+    return window != nullptr ? window->process_name : "";
+  }
+
+  int enumerations() const { return enumerations_; }
+
+ private:
+  const Window* Find(WindowHandle handle) const {
+    for (const Window& window : windows_) {
+      if (window.handle == handle) {
+        return &window;
+      }
+    }
+    return nullptr;
+  }
+
+  std::vector<Window> windows_;
+  int enumerations_ = 0;
+};
+
+}  // namespace test
+}  // namespace keypress_simulator_core
+
+#endif  // KEYPRESS_SIMULATOR_CORE_TEST_FAKE_WINDOW_ENUMERATOR_H_
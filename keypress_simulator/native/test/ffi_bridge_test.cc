@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "keypress_simulator_core/ffi_bridge.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+class RecordingBackend : public FfiBackend {
+ public:
+  struct KeyCall {
+    ActionId id;
+    ChordPhase phase;
+    TimePoint origin;
+  };
+
+  int32_t Key(ActionId id, ChordPhase phase, TimePoint origin) override {
+    keys.push_back({id, phase, origin});
+    return id == kUnknownAction ? KS_ERROR_UNKNOWN_ACTION : KS_OK;
+  }
+
+  int32_t Click(double x, double y, bool down) override {
+    clicks.push_back({x, y, down ? 1.0 : 0.0});
+    return KS_OK;
+  }
+
+  static constexpr ActionId kUnknownAction = 99;
+
+  std::vector<KeyCall> keys;
+  std::vector<std::vector<double>> clicks;
+};
+
+// Installs |backend| for the duration of a test.
+class ScopedBackend {
+ public:
+  explicit ScopedBackend(FfiBackend* backend) : backend_(backend) {
+    InstallFfiBackend(backend_);
+  }
+  ~ScopedBackend() { UninstallFfiBackend(backend_); }
+
+ private:
+  FfiBackend* backend_;
+};
+
+}  // namespace
+
+TEST(FfiBridge, ReportsTheAbiVersion) {
+  EXPECT_EQ(ks_abi_version(), KS_ABI_VERSION);
+}
+
+TEST(FfiBridge, IsUnavailableWithoutABackend) {
+  EXPECT_EQ(ks_key(1, KS_KEY_DOWN), KS_ERROR_UNAVAILABLE);
+  EXPECT_EQ(ks_click(10, 20, 1), KS_ERROR_UNAVAILABLE);
+}
+
+TEST(FfiBridge, ForwardsKeysWithTheirPhase) {
+  RecordingBackend backend;
+  ScopedBackend scoped(&backend);
+
+  EXPECT_EQ(ks_key(3, KS_KEY_DOWN), KS_OK);
+  EXPECT_EQ(ks_key(3, KS_KEY_UP), KS_OK);
+  EXPECT_EQ(ks_key_traced(4, KS_KEY_TAP, 1500), KS_OK);
+  EXPECT_EQ(ks_key(RecordingBackend::kUnknownAction, KS_KEY_TAP),
+            KS_ERROR_UNKNOWN_ACTION);
+
+  ASSERT_EQ(backend.keys.size(), 4u);
+  EXPECT_EQ(backend.keys[0].id, 3u);
+  EXPECT_EQ(backend.keys[0].phase, ChordPhase::kDown);
+  EXPECT_EQ(backend.keys[0].origin, FfiBackend::TimePoint());
+  EXPECT_EQ(backend.keys[1].phase, ChordPhase::kUp);
+  EXPECT_EQ(backend.keys[2].id, 4u);
+  EXPECT_EQ(backend.keys[2].phase, ChordPhase::kTap);
+  EXPECT_EQ(backend.keys[2].origin - FfiBackend::TimePoint(),
+            std::chrono::microseconds(1500));
+}
+
+TEST(FfiBridge, RejectsInvalidArgumentsBeforeTheBackend) {
+  RecordingBackend backend;
+  ScopedBackend scoped(&backend);
+
+  EXPECT_EQ(ks_key(-1, KS_KEY_DOWN), KS_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(ks_key(static_cast<int32_t>(kMaxActionId), KS_KEY_DOWN),
+            KS_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(ks_key(1, 3), KS_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(ks_click(NAN, 0, 1), KS_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(ks_click(0, std::numeric_limits<double>::infinity(), 1),
+            KS_ERROR_INVALID_ARGUMENT);
+  EXPECT_TRUE(backend.keys.empty());
+  EXPECT_TRUE(backend.clicks.empty());
+}
+
+TEST(FfiBridge, ForwardsClicks) {
+  RecordingBackend backend;
+  ScopedBackend scoped(&backend);
+
+  EXPECT_EQ(ks_click(10.5, 20, 1), KS_OK);
+  EXPECT_EQ(ks_click(10.5, 20, 0), KS_OK);
+  EXPECT_EQ(backend.clicks, (std::vector<std::vector<double>>{
+                                {10.5, 20, 1}, {10.5, 20, 0}}));
+}
+
+TEST(FfiBridge, UninstallKeepsANewerBackend) {
+  RecordingBackend first;
+  RecordingBackend second;
+  InstallFfiBackend(&first);
+  InstallFfiBackend(&second);
+  UninstallFfiBackend(&first);
+
+  EXPECT_EQ(ks_key(1, KS_KEY_TAP), KS_OK);
+  EXPECT_TRUE(first.keys.empty());
+  EXPECT_EQ(second.keys.size(), 1u);
+
+  UninstallFfiBackend(&second);
+  EXPECT_EQ(ks_key(1, KS_KEY_TAP), KS_ERROR_UNAVAILABLE);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "keypress_simulator_core/injection_worker.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+TEST(InjectionWorker, RunsTasksInPostOrder) {
+  // Models a key down/up stream: every task must see the one posted right
+  // before it, even when the producer outruns the worker.
+  constexpr int kCount = 200000;
+  std::vector<int> ran;
+  ran.reserve(kCount);
+  {
+    InjectionWorker worker;
+    for (int i = 0; i < kCount; i++) {
+      while (!worker.Post([&ran, i] {
+        ran.push_back(i);
+        return true;
+      })) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  ASSERT_EQ(ran.size(), static_cast<size_t>(kCount));
+  for (int i = 0; i < kCount; i++) {
+    ASSERT_EQ(ran[i], i);
+  }
+}
+
+TEST(InjectionWorker, ReportsResultsToCompletion) {
+  std::vector<bool> results;
+  {
+    InjectionWorker worker;
+    auto record = [&results](bool succeeded) { results.push_back(succeeded); };
+    ASSERT_TRUE(worker.Post([] { return true; }, record));
+    ASSERT_TRUE(worker.Post([] { return false; }, record));
+    ASSERT_TRUE(worker.Post([] { return true; }));
+  }
+  EXPECT_EQ(results, (std::vector<bool>{true, false}));
+}
+
+TEST(InjectionWorker, RejectsPostsWhenQueueIsFull) {
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  std::atomic<int> ran(0);
+  InjectionWorker worker;
+
+  // The first task is taken off the queue and then blocks the worker.
+  ASSERT_TRUE(worker.Post([&] {
+    started.store(true);
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+    return true;
+  }));
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+
+  size_t accepted = 0;
+  while (worker.Post([&ran] {
+    ran++;
+    return true;
+  })) {
+    accepted++;
+  }
+  EXPECT_EQ(accepted, InjectionWorker::kQueueCapacity);
+
+  release.store(true);
+  worker.Stop();
+  EXPECT_EQ(static_cast<size_t>(ran.load()), accepted);
+}
+
+TEST(InjectionWorker, StopRunsPendingTasks) {
+  std::atomic<int> ran(0);
+  InjectionWorker worker;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(worker.Post([&ran] {
+      ran++;
+      return true;
+    }));
+  }
+  worker.Stop();
+  EXPECT_EQ(ran.load(), 10);
+  // A second Stop() is a no-op.
+  worker.Stop();
+}
+
+TEST(InjectionWorker, RepeatsUntilStopped) {
+  std::atomic<int> ticks(0);
+  InjectionWorker worker;
+  ASSERT_TRUE(worker.StartRepeat(7, std::chrono::milliseconds(0),
+                                 std::chrono::milliseconds(10), [&ticks] {
+                                   ticks++;
+                                   return true;
+                                 }));
+
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (ticks.load() < 3 && std::chrono::steady_clock::now() < give_up) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GE(ticks.load(), 3);
+
+  // Once a task posted after StopRepeat() has run, no tick may follow.
+  std::atomic<bool> stopped(false);
+  ASSERT_TRUE(worker.StopRepeat(7));
+  ASSERT_TRUE(worker.Post([&stopped] {
+    stopped.store(true);
+    return true;
+  }));
+  while (!stopped.load()) {
+    std::this_thread::yield();
+  }
+  int ticks_at_stop = ticks.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(ticks.load(), ticks_at_stop);
+}
+
+TEST(InjectionWorker, TimesPostedTasks) {
+  InjectionWorker worker;
+  auto origin =
+      std::chrono::steady_clock::now() - std::chrono::milliseconds(20);
+  ASSERT_TRUE(worker.Post(
+      [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return true;
+      },
+      nullptr, origin));
+  ASSERT_TRUE(worker.Post([] { return true; }));
+  // Bookkeeping jobs are not injections and must not be counted.
+  ASSERT_TRUE(worker.StopRepeat(1));
+  worker.Stop();
+
+  LatencyRecorder& latency = worker.latency();
+  EXPECT_EQ(latency.Summarize(LatencyStage::kQueue).count, 2u);
+  EXPECT_EQ(latency.Summarize(LatencyStage::kInject).count, 2u);
+  EXPECT_GE(latency.Summarize(LatencyStage::kInject).max, 5000u);
+  // Only the first task carried an origin.
+  EXPECT_EQ(latency.Summarize(LatencyStage::kDispatch).count, 1u);
+  EXPECT_GE(latency.Summarize(LatencyStage::kDispatch).max, 20000u);
+  EXPECT_GE(latency.Summarize(LatencyStage::kTotal).max, 25000u);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
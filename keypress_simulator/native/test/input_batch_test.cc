@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "keypress_simulator_core/input_batch.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+// Arbitrary codes that make the expected sequences easy to read.
+constexpr uint16_t kShift = 101;
+constexpr uint16_t kControl = 102;
+constexpr uint16_t kAlt = 103;
+constexpr uint16_t kMeta = 104;
+constexpr uint16_t kKeyR = 1;
+constexpr uint16_t kKeyS = 2;
+
+const ModifierKeyCodes kModifierCodes = {kShift, kControl, kAlt, kMeta};
+
+}  // namespace
+
+TEST(KeyBatchBuilder, PressesModifiersBeforeKey) {
+  KeyBatchBuilder batch(kModifierCodes);
+  batch.AddChord(kModifierControl | kModifierShift, kKeyR, ChordPhase::kDown);
+
+  std::vector<KeyTransition> expected = {
+      {kShift, true}, {kControl, true}, {kKeyR, true}};
+  EXPECT_EQ(batch.transitions(), expected);
+}
+
+TEST(KeyBatchBuilder, ReleasesKeyBeforeModifiersInReverse) {
+  KeyBatchBuilder batch(kModifierCodes);
+  batch.AddChord(kModifierControl | kModifierShift | kModifierMeta, kKeyR,
+                 ChordPhase::kUp);
+
+  std::vector<KeyTransition> expected = {
+      {kKeyR, false}, {kMeta, false}, {kControl, false}, {kShift, false}};
+  EXPECT_EQ(batch.transitions(), expected);
+}
+
+TEST(KeyBatchBuilder, TapIsDownThenUp) {
+  KeyBatchBuilder batch(kModifierCodes);
+  batch.AddChord(kModifierAlt, kKeyR, ChordPhase::kTap);
+
+  std::vector<KeyTransition> expected = {
+      {kAlt, true}, {kKeyR, true}, {kKeyR, false}, {kAlt, false}};
+  EXPECT_EQ(batch.transitions(), expected);
+}
+
+TEST(KeyBatchBuilder, PlainKeyHasNoModifiers) {
+  KeyBatchBuilder batch(kModifierCodes);
+  batch.AddChord(kModifierNone, kKeyR, ChordPhase::kTap);
+
+  std::vector<KeyTransition> expected = {{kKeyR, true}, {kKeyR, false}};
+  EXPECT_EQ(batch.transitions(), expected);
+}
+
+TEST(KeyBatchBuilder, MacroKeepsStepOrder) {
+  KeyBatchBuilder batch(kModifierCodes);
+  batch.AddChord(kModifierShift, kKeyR, ChordPhase::kTap);
+  batch.AddChord(kModifierNone, kKeyS, ChordPhase::kDown);
+  batch.AddChord(kModifierNone, kKeyS, ChordPhase::kUp);
+
+  std::vector<KeyTransition> expected = {
+      {kShift, true}, {kKeyR, true}, {kKeyR, false}, {kShift, false},
+      {kKeyS, true},  {kKeyS, false},
+  };
+  EXPECT_EQ(batch.transitions(), expected);
+
+  batch.Clear();
+  EXPECT_TRUE(batch.empty());
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <linux/input-event-codes.h>
+
+#include "keypress_simulator_core/key_codes.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+TEST(KeyCodes, TranslatesFlutterPhysicalKeysToEvdev) {
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070004), KEY_A);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x0007001d), KEY_Z);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x0007001e), KEY_1);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070028), KEY_ENTER);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x0007002c), KEY_SPACE);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x0007004f), KEY_RIGHT);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070050), KEY_LEFT);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070051), KEY_DOWN);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070052), KEY_UP);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x000700e1), KEY_LEFTSHIFT);
+}
+
+TEST(KeyCodes, TranslatesTransportKeysOnTheConsumerPage) {
+  // PhysicalKeyboardKey.mediaPlayPause lives on the consumer page.
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x000c00cd), KEY_PLAYPAUSE);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x000c00b5), KEY_NEXTSONG);
+}
+
+TEST(KeyCodes, RejectsUnknownKeys) {
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x000c0001), 0);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0x00070100), 0);
+  EXPECT_EQ(EvdevKeyForPhysicalKey(0), 0);
+}
+
+TEST(KeyCodes, ParsesModifierNames) {
+  EXPECT_EQ(ModifierFromName("shiftModifier"), kModifierShift);
+  EXPECT_EQ(ModifierFromName("controlModifier"), kModifierControl);
+  EXPECT_EQ(ModifierFromName("altModifier"), kModifierAlt);
+  EXPECT_EQ(ModifierFromName("metaModifier"), kModifierMeta);
+  EXPECT_EQ(ModifierFromName("functionModifier"), kModifierNone);
+
+  EXPECT_EQ(EvdevKeyForModifier(kModifierShift), KEY_LEFTSHIFT);
+  EXPECT_EQ(EvdevKeyForModifier(kModifierMeta), KEY_LEFTMETA);
+}
+
+TEST(KeyCodes, TranslatesMediaKeyIdentifiers) {
+  EXPECT_EQ(EvdevKeyForMediaKey("playPause"), KEY_PLAYPAUSE);
+  EXPECT_EQ(EvdevKeyForMediaKey("stop"), KEY_STOPCD);
+  EXPECT_EQ(EvdevKeyForMediaKey("next"), KEY_NEXTSONG);
+  EXPECT_EQ(EvdevKeyForMediaKey("previous"), KEY_PREVIOUSSONG);
+  EXPECT_EQ(EvdevKeyForMediaKey("volumeUp"), KEY_VOLUMEUP);
+  EXPECT_EQ(EvdevKeyForMediaKey("volumeDown"), KEY_VOLUMEDOWN);
+  EXPECT_EQ(EvdevKeyForMediaKey("eject"), 0);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
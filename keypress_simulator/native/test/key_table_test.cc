@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <linux/input-event-codes.h>
+#include <X11/XF86keysym.h>
+#include <X11/keysym.h>
+
+#include <iterator>
+#include <set>
+
+#include "keypress_simulator_core/key_table.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+// Windows virtual keys, from WinUser.h.
+constexpr uint16_t kVkReturn = 0x0D;
+constexpr uint16_t kVkShift = 0x10;
+constexpr uint16_t kVkControl = 0x11;
+constexpr uint16_t kVkMenu = 0x12;
+constexpr uint16_t kVkLeft = 0x25;
+constexpr uint16_t kVkDelete = 0x2E;
+constexpr uint16_t kVkLWin = 0x5B;
+constexpr uint16_t kVkF1 = 0x70;
+constexpr uint16_t kVkMediaPlayPause = 0xB3;
+
+// Resolved at compile time: the table needs no initialisation.
+static_assert(KeyCodesForPhysicalKey(0x00070004)->evdev == KEY_A,
+              "KeyA must be constexpr");
+static_assert(KeyCodesForVirtualKey(kVkLeft)->windows_extended,
+              "ArrowLeft is an extended key");
+static_assert(KeyCodesForMediaKey("playPause") != nullptr,
+              "media keys must be constexpr");
+
+struct Expected {
+  uint32_t physical_key;
+  uint16_t evdev;
+  uint32_t keysym;
+};
+
+}  // namespace
+
+TEST(KeyTable, MatchesLinuxAndX11Headers) {
+  const Expected kExpected[] = {
+      {0x00070004, KEY_A, XK_a},
+      {0x0007001d, KEY_Z, XK_z},
+      {0x0007001e, KEY_1, XK_1},
+      {0x00070027, KEY_0, XK_0},
+      {0x00070028, KEY_ENTER, XK_Return},
+      {0x00070029, KEY_ESC, XK_Escape},
+      {0x0007002c, KEY_SPACE, XK_space},
+      {0x00070038, KEY_SLASH, XK_slash},
+      {0x0007003a, KEY_F1, XK_F1},
+      {0x00070045, KEY_F12, XK_F12},
+      {0x0007004a, KEY_HOME, XK_Home},
+      {0x0007004c, KEY_DELETE, XK_Delete},
+      {0x0007004f, KEY_RIGHT, XK_Right},
+      {0x00070052, KEY_UP, XK_Up},
+      {0x00070058, KEY_KPENTER, XK_KP_Enter},
+      {0x00070062, KEY_KP0, XK_KP_0},
+      {0x00070068, KEY_F13, XK_F13},
+      {0x00070073, KEY_F24, XK_F24},
+      {0x00070080, KEY_VOLUMEUP, XF86XK_AudioRaiseVolume},
+      {0x00070081, KEY_VOLUMEDOWN, XF86XK_AudioLowerVolume},
+      {0x000700e0, KEY_LEFTCTRL, XK_Control_L},
+      {0x000700e1, KEY_LEFTSHIFT, XK_Shift_L},
+      {0x000700e6, KEY_RIGHTALT, XK_Alt_R},
+      {0x000700e7, KEY_RIGHTMETA, XK_Super_R},
+      {0x000c00b5, KEY_NEXTSONG, XF86XK_AudioNext},
+      {0x000c00b6, KEY_PREVIOUSSONG, XF86XK_AudioPrev},
+      {0x000c00b7, KEY_STOPCD, XF86XK_AudioStop},
+      {0x000c00cd, KEY_PLAYPAUSE, XF86XK_AudioPlay},
+  };
+  for (const Expected& expected : kExpected) {
+    SCOPED_TRACE(testing::Message() << std::hex << expected.physical_key);
+    const KeyCodes* codes = KeyCodesForPhysicalKey(expected.physical_key);
+    ASSERT_NE(codes, nullptr);
+    EXPECT_EQ(codes->evdev, expected.evdev);
+    EXPECT_EQ(codes->x11_keysym, expected.keysym);
+  }
+}
+
+TEST(KeyTable, KeysAreUniqueAndInUsageOrder) {
+  for (size_t i = 1; i < std::size(kKeyTable); i++) {
+    EXPECT_LT(kKeyTable[i - 1].physical_key, kKeyTable[i].physical_key);
+  }
+  for (const KeyTableEntry& entry : kKeyTable) {
+    EXPECT_EQ(KeyCodesForPhysicalKey(entry.physical_key), &entry.codes);
+  }
+}
+
+TEST(KeyTable, WindowsScanCodesAgreeWithEvdev) {
+  // evdev codes up to KEY_F12 are the PC/AT set 1 scan codes, so every
+  // unprefixed key in that range must carry the same number. Pause is sent
+  // as its Windows scan code 0x45, not the E1 sequence evdev numbers.
+  for (const KeyTableEntry& entry : kKeyTable) {
+    const KeyCodes& codes = entry.codes;
+    if (codes.windows_vk == 0 || codes.windows_extended ||
+        codes.evdev > KEY_F12 || codes.evdev == KEY_PAUSE) {
+      continue;
+    }
+    SCOPED_TRACE(testing::Message() << std::hex << entry.physical_key);
+    EXPECT_EQ(codes.windows_scan, codes.evdev);
+  }
+}
+
+TEST(KeyTable, ExtendedKeysIncludeTheNavigationCluster) {
+  // The keys the Windows plugin used to flag with an if chain.
+  for (uint16_t vk : {0x25, 0x26, 0x27, 0x28, 0x2D, 0x2E, 0x24, 0x23, 0x21,
+                      0x22}) {
+    const KeyCodes* codes = KeyCodesForVirtualKey(vk);
+    ASSERT_NE(codes, nullptr) << vk;
+    EXPECT_TRUE(codes->windows_extended) << vk;
+  }
+  EXPECT_FALSE(KeyCodesForVirtualKey(kVkF1)->windows_extended);
+  EXPECT_TRUE(KeyCodesForVirtualKey(kVkLWin)->windows_extended);
+}
+
+TEST(KeyTable, VirtualKeyIndexPrefersTheMainKey) {
+  // NumpadEnter shares VK_RETURN but is the extended variant.
+  const KeyCodes* enter = KeyCodesForVirtualKey(kVkReturn);
+  ASSERT_NE(enter, nullptr);
+  EXPECT_FALSE(enter->windows_extended);
+  EXPECT_EQ(enter->evdev, KEY_ENTER);
+
+  // Generic modifiers resolve to the left-hand keys.
+  EXPECT_EQ(KeyCodesForVirtualKey(kVkShift)->evdev, KEY_LEFTSHIFT);
+  EXPECT_EQ(KeyCodesForVirtualKey(kVkControl)->evdev, KEY_LEFTCTRL);
+  EXPECT_EQ(KeyCodesForVirtualKey(kVkMenu)->evdev, KEY_LEFTALT);
+
+  EXPECT_EQ(KeyCodesForVirtualKey(kVkDelete)->windows_scan, 0x53);
+  EXPECT_EQ(KeyCodesForVirtualKey(0), nullptr);
+  EXPECT_EQ(KeyCodesForVirtualKey(0x1000), nullptr);
+}
+
+TEST(KeyTable, VirtualKeysRoundTrip) {
+  std::set<uint16_t> seen;
+  for (const KeyTableEntry& entry : kKeyTable) {
+    uint16_t vk = entry.codes.windows_vk;
+    if (vk == 0 || !seen.insert(vk).second) {
+      continue;
+    }
+    const KeyCodes* codes = KeyCodesForVirtualKey(vk);
+    ASSERT_NE(codes, nullptr) << vk;
+    EXPECT_EQ(codes, &entry.codes) << vk;
+  }
+}
+
+TEST(KeyTable, EvdevIndexFindsAKeysymForEveryCode) {
+  for (const KeyTableEntry& entry : kKeyTable) {
+    uint16_t evdev = entry.codes.evdev;
+    SCOPED_TRACE(evdev);
+    const KeyCodes* codes = KeyCodesForEvdevKey(evdev);
+    ASSERT_NE(codes, nullptr);
+    EXPECT_EQ(codes->evdev, evdev);
+    if (entry.codes.x11_keysym != 0) {
+      EXPECT_NE(codes->x11_keysym, 0u);
+    }
+  }
+  EXPECT_EQ(KeyCodesForEvdevKey(KEY_A)->x11_keysym,
+            static_cast<uint32_t>(XK_a));
+  EXPECT_EQ(KeyCodesForEvdevKey(KEY_PLAYPAUSE)->x11_keysym,
+            static_cast<uint32_t>(XF86XK_AudioPlay));
+  EXPECT_EQ(KeyCodesForEvdevKey(KEY_RESERVED), nullptr);
+  EXPECT_EQ(KeyCodesForEvdevKey(KEY_MAX), nullptr);
+}
+
+TEST(KeyTable, MediaKeysHaveEveryBackend) {
+  for (const MediaKeyName& media_key : kMediaKeyNames) {
+    SCOPED_TRACE(media_key.identifier);
+    const KeyCodes* codes = KeyCodesForMediaKey(media_key.identifier);
+    ASSERT_NE(codes, nullptr);
+    EXPECT_NE(codes->windows_vk, 0);
+    EXPECT_TRUE(codes->windows_extended);
+    EXPECT_NE(codes->evdev, 0);
+    EXPECT_NE(codes->x11_keysym, 0u);
+  }
+  EXPECT_EQ(KeyCodesForMediaKey("playPause")->windows_vk, kVkMediaPlayPause);
+  EXPECT_EQ(KeyCodesForMediaKey("eject"), nullptr);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
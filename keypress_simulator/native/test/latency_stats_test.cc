@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "keypress_simulator_core/latency_stats.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using TimePoint = LatencyRecorder::TimePoint;
+
+}  // namespace
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+  for (uint64_t micros = 0; micros < 2 * LatencyHistogram::kSubBucketCount;
+       micros++) {
+    size_t bucket = LatencyHistogram::BucketIndex(micros);
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(bucket), micros);
+  }
+}
+
+TEST(LatencyHistogram, BucketsCoverEveryValueWithBoundedError) {
+  uint64_t previous_upper_bound = 0;
+  for (size_t bucket = 1; bucket < LatencyHistogram::kBucketCount; bucket++) {
+    uint64_t upper_bound = LatencyHistogram::BucketUpperBound(bucket);
+    uint64_t lower_bound = previous_upper_bound + 1;
+    EXPECT_EQ(LatencyHistogram::BucketIndex(lower_bound), bucket);
+    EXPECT_EQ(LatencyHistogram::BucketIndex(upper_bound), bucket);
+    // A bucket is at most 1/kSubBucketCount of its values wide.
+    EXPECT_LE((upper_bound - lower_bound) * LatencyHistogram::kSubBucketCount,
+              lower_bound);
+    previous_upper_bound = upper_bound;
+  }
+  EXPECT_EQ(previous_upper_bound, LatencyHistogram::kMaxTrackable);
+}
+
+TEST(LatencyHistogram, SummarizesPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Summarize().count, 0u);
+
+  // 1..1000 us: p50 is 500 and p99 is 990, within a bucket.
+  for (uint64_t micros = 1; micros <= 1000; micros++) {
+    histogram.Record(micros);
+  }
+  LatencySummary summary = histogram.Summarize();
+  EXPECT_EQ(summary.count, 1000u);
+  EXPECT_GE(summary.p50, 500u);
+  EXPECT_LE(summary.p50, 500u + 500u / LatencyHistogram::kSubBucketCount);
+  EXPECT_GE(summary.p99, 990u);
+  EXPECT_LE(summary.p99, 1000u);
+  EXPECT_EQ(summary.max, 1000u);
+}
+
+TEST(LatencyHistogram, PercentilesNeverExceedTheMaximum) {
+  LatencyHistogram histogram;
+  histogram.Record(1025);
+  LatencySummary summary = histogram.Summarize();
+  EXPECT_EQ(summary.p50, 1025u);
+  EXPECT_EQ(summary.p99, 1025u);
+  EXPECT_EQ(summary.max, 1025u);
+}
+
+TEST(LatencyHistogram, ClampsOutOfRangeValues) {
+  LatencyHistogram histogram;
+  histogram.Record(std::chrono::steady_clock::duration(-5));
+  histogram.Record(LatencyHistogram::kMaxTrackable * 4);
+  LatencySummary summary = histogram.Summarize();
+  EXPECT_EQ(summary.count, 2u);
+  EXPECT_EQ(summary.p50, 0u);
+  EXPECT_EQ(summary.max, LatencyHistogram::kMaxTrackable);
+}
+
+TEST(LatencyHistogram, ResetForgetsValues) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(250));
+  histogram.Reset();
+  LatencySummary summary = histogram.Summarize();
+  EXPECT_EQ(summary.count, 0u);
+  EXPECT_EQ(summary.max, 0u);
+}
+
+TEST(LatencyHistogram, RecordsFromManyThreads) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 50000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&histogram, t] {
+      for (int i = 0; i < kPerThread; i++) {
+        histogram.Record(static_cast<uint64_t>(t * 100 + i % 100));
+      }
+    });
+  }
+  // Summaries may be taken while the threads are recording.
+  while (histogram.Summarize().count < kThreads * kPerThread / 2) {
+    std::this_thread::yield();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  LatencySummary summary = histogram.Summarize();
+  EXPECT_EQ(summary.count, static_cast<uint64_t>(kThreads * kPerThread));
+  EXPECT_EQ(summary.max, static_cast<uint64_t>((kThreads - 1) * 100 + 99));
+}
+
+TEST(LatencyRecorder, RecordsEveryStage) {
+  LatencyRecorder recorder;
+  TimePoint origin = TimePoint() + milliseconds(1000);
+  recorder.Record(origin, origin + microseconds(4000),
+                  origin + microseconds(4100), origin + microseconds(4130));
+
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kDispatch).max, 4000u);
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kQueue).max, 100u);
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kInject).max, 30u);
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kTotal).max, 4130u);
+
+  recorder.Reset();
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kTotal).count, 0u);
+}
+
+TEST(LatencyRecorder, SkipsMissingOrImpossibleOrigins) {
+  LatencyRecorder recorder;
+  TimePoint enqueued = TimePoint() + milliseconds(1000);
+  recorder.Record(TimePoint(), enqueued, enqueued, enqueued);
+  // An origin after the enqueue time comes from another clock.
+  recorder.Record(enqueued + milliseconds(1), enqueued, enqueued, enqueued);
+
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kQueue).count, 2u);
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kDispatch).count, 0u);
+  EXPECT_EQ(recorder.Summarize(LatencyStage::kTotal).count, 0u);
+}
+
+TEST(LatencyRecorder, NamesStages) {
+  EXPECT_STREQ(LatencyStageName(LatencyStage::kDispatch), "dispatch");
+  EXPECT_STREQ(LatencyStageName(LatencyStage::kQueue), "queue");
+  EXPECT_STREQ(LatencyStageName(LatencyStage::kInject), "inject");
+  EXPECT_STREQ(LatencyStageName(LatencyStage::kTotal), "total");
+}
+
+TEST(LatencyOriginFromMicros, ReadsTheSteadyClock) {
+  EXPECT_EQ(LatencyOriginFromMicros(0), TimePoint());
+  EXPECT_EQ(LatencyOriginFromMicros(-1), TimePoint());
+  EXPECT_EQ(LatencyOriginFromMicros(1500) - TimePoint(), microseconds(1500));
+
+  // A timestamp taken the way Dart's Timeline.now takes it is in the past.
+  auto now = std::chrono::steady_clock::now();
+  int64_t micros =
+      std::chrono::duration_cast<microseconds>(now.time_since_epoch()).count();
+  EXPECT_LE(LatencyOriginFromMicros(micros), now);
+  EXPECT_GT(LatencyOriginFromMicros(micros), now - milliseconds(1));
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "keypress_simulator_core/monitor_layout.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+// A 4K panel at 150% with a 1080p panel on its left and another stacked
+// above that one, both at 100%.
+const Monitor kMain = {0, 0, 3840, 2160, 1.5};
+const Monitor kLeft = {-1920, 0, 0, 1080, 1.0};
+const Monitor kLeftTop = {-1920, -1080, 0, 0, 1.0};
+
+}  // namespace
+
+TEST(MonitorLayout, FindsContainingMonitor) {
+  MonitorLayout layout({kMain, kLeftTop, kLeft});
+  ASSERT_EQ(layout.size(), 3u);
+
+  EXPECT_EQ(layout.Find(100, 100)->scale, 1.5);
+  EXPECT_EQ(layout.Find(3839, 2159)->left, 0);
+  EXPECT_EQ(layout.Find(-1, 500)->top, 0);
+  EXPECT_EQ(layout.Find(-1920, -1)->top, -1080);
+  EXPECT_EQ(layout.Find(0, 0)->left, 0);
+}
+
+TEST(MonitorLayout, FallsBackToNearestMonitor) {
+  MonitorLayout layout({kMain, kLeft, kLeftTop});
+
+  // Right of the main monitor.
+  EXPECT_EQ(layout.Find(5000, 100)->left, 0);
+  // In the gap below the left column.
+  EXPECT_EQ(layout.Find(-1000, 1500)->top, 0);
+  EXPECT_EQ(layout.Find(-1000, 1500)->left, -1920);
+  // Above everything on the left.
+  EXPECT_EQ(layout.Find(-1000, -5000)->top, -1080);
+}
+
+TEST(MonitorLayout, EmptyLayoutFindsNothing) {
+  MonitorLayout layout;
+  EXPECT_TRUE(layout.empty());
+  EXPECT_EQ(layout.Find(0, 0), nullptr);
+
+  double x = 0;
+  double y = 0;
+  layout.MapPoint(10.5, 20.25, &x, &y);
+  EXPECT_EQ(x, 10.5);
+  EXPECT_EQ(y, 20.25);
+}
+
+TEST(MonitorLayout, MapsPointsWithTheirMonitorScale) {
+  MonitorLayout layout({kMain, kLeft});
+  double x = 0;
+  double y = 0;
+  layout.MapPoint(100, 200, &x, &y);
+  EXPECT_EQ(x, 150);
+  EXPECT_EQ(y, 300);
+
+  layout.MapPoint(-100, 200, &x, &y);
+  EXPECT_EQ(x, -100);
+  EXPECT_EQ(y, 200);
+}
+
+TEST(MonitorLayout, HandlesManyMonitorsInARow) {
+  std::vector<Monitor> monitors;
+  for (int i = 0; i < 64; i++) {
+    monitors.push_back({i * 1000, 0, (i + 1) * 1000, 1000, 1.0 + i});
+  }
+  MonitorLayout layout(std::move(monitors));
+  for (int i = 0; i < 64; i++) {
+    ASSERT_EQ(layout.Find(i * 1000 + 500, 500)->scale, 1.0 + i);
+  }
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/process_tracker.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+using Change = ProcessTracker::Change;
+
+const std::vector<std::string> kCompatibleApps = {
+    "MyWhooshHD.exe", "MyWhoosh.exe", "indieVelo.exe", "Rouvy.exe"};
+
+}  // namespace
+
+TEST(ProcessTracker, ReportsLaunchAndExit) {
+  ProcessTracker tracker(kCompatibleApps);
+  std::vector<Change> changes;
+
+  tracker.OnProcessNamed(10, "bash", &changes);
+  tracker.OnProcessNamed(11, "rouvy.exe", &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"Rouvy.exe", 11, true}}));
+  EXPECT_TRUE(tracker.IsTracked(11));
+  EXPECT_FALSE(tracker.IsTracked(10));
+
+  changes.clear();
+  tracker.OnProcessExited(10, &changes);
+  tracker.OnProcessExited(11, &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"Rouvy.exe", 11, false}}));
+  EXPECT_TRUE(tracker.RunningApps().empty());
+}
+
+TEST(ProcessTracker, ReportsAnAppOnceForAllItsProcesses) {
+  ProcessTracker tracker(kCompatibleApps);
+  std::vector<Change> changes;
+
+  tracker.OnProcessNamed(20, "MyWhoosh.exe", &changes);
+  tracker.OnProcessNamed(21, "MyWhoosh.exe", &changes);
+  tracker.OnProcessNamed(20, "MyWhoosh.exe", &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"MyWhoosh.exe", 20, true}}));
+
+  changes.clear();
+  tracker.OnProcessExited(20, &changes);
+  EXPECT_TRUE(changes.empty());
+  tracker.OnProcessExited(21, &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"MyWhoosh.exe", 21, false}}));
+}
+
+TEST(ProcessTracker, FollowsRenames) {
+  ProcessTracker tracker(kCompatibleApps);
+  std::vector<Change> changes;
+
+  // Wine starts as its preloader and renames itself after the .exe.
+  tracker.OnProcessNamed(30, "wine64-preloade", &changes);
+  tracker.OnProcessNamed(30, "indieVelo.exe", &changes);
+  tracker.OnProcessNamed(30, "Rouvy.exe", &changes);
+  tracker.OnProcessNamed(30, "sh", &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"indieVelo.exe", 30, true},
+                                          {"indieVelo.exe", 30, false},
+                                          {"Rouvy.exe", 30, true},
+                                          {"Rouvy.exe", 30, false}}));
+}
+
+TEST(ProcessTracker, MatchesNamesTruncatedByTheKernel) {
+  ProcessTracker tracker({"VeryLongTrainerName.exe"});
+  std::vector<Change> changes;
+
+  tracker.OnProcessNamed(40, "VeryLongTrainer", &changes);
+  tracker.OnProcessNamed(41, "VeryLongTrain", &changes);
+  EXPECT_EQ(changes,
+            (std::vector<Change>{{"VeryLongTrainerName.exe", 40, true}}));
+}
+
+TEST(ProcessTracker, ReconcilesWithScans) {
+  ProcessTracker tracker(kCompatibleApps);
+  std::vector<Change> changes;
+
+  tracker.OnScan({{1, "systemd"}, {50, "Rouvy.exe"}, {51, "MyWhoosh.exe"}},
+                 &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"Rouvy.exe", 50, true},
+                                          {"MyWhoosh.exe", 51, true}}));
+
+  // An exit notification was lost, and MyWhooshHD started meanwhile.
+  changes.clear();
+  tracker.OnScan(
+      {{1, "systemd"}, {51, "MyWhoosh.exe"}, {52, "MyWhooshHD.exe"}},
+      &changes);
+  EXPECT_EQ(changes, (std::vector<Change>{{"MyWhooshHD.exe", 52, true},
+                                          {"Rouvy.exe", 50, false}}));
+}
+
+TEST(ProcessTracker, ListsRunningAppsInPriorityOrder) {
+  ProcessTracker tracker(kCompatibleApps);
+  std::vector<Change> changes;
+  tracker.OnScan(
+      {{70, "Rouvy.exe"}, {62, "MyWhoosh.exe"}, {61, "MyWhoosh.exe"}},
+      &changes);
+
+  EXPECT_EQ(tracker.RunningApps(),
+            (std::vector<Change>{{"MyWhoosh.exe", 61, true},
+                                 {"Rouvy.exe", 70, true}}));
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "keypress_simulator_core/process_watcher.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+using Change = ProcessTracker::Change;
+
+constexpr std::chrono::milliseconds kPollInterval(20);
+constexpr std::chrono::seconds kTimeout(5);
+
+// A name unlikely to be running on the test machine for real, and unique to
+// this test process: ctest runs every test in a process of its own, in
+// parallel with -j, and the tests must not see each other's children.
+// Process names are cut to 15 characters, which the prefix and pid fit in.
+std::string AppName(const char* prefix = "ks-app-") {
+  return prefix + std::to_string(getpid());
+}
+
+// A child process that names itself |name| and sleeps until killed.
+class ChildProcess {
+ public:
+  explicit ChildProcess(const std::string& name) {
+    pid_ = fork();
+    if (pid_ == 0) {
+      prctl(PR_SET_NAME, name.c_str());
+      while (true) {
+        pause();
+      }
+    }
+  }
+
+  ~ChildProcess() { Kill(); }
+
+  void Kill() {
+    if (pid_ > 0) {
+      kill(pid_, SIGKILL);
+      waitpid(pid_, nullptr, 0);
+      pid_ = -1;
+    }
+  }
+
+  pid_t pid() const { return pid_; }
+
+ private:
+  pid_t pid_;
+};
+
+// Collects the changes reported on the watcher thread.
+class ChangeRecorder {
+ public:
+  ProcessWatcher::Callback callback() {
+    return [this](const Change& change) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      changes_.push_back(change);
+      condition_.notify_all();
+    };
+  }
+
+  // Waits until |change| has been reported.
+  bool WaitFor(const Change& change) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, kTimeout, [&] {
+      for (const Change& reported : changes_) {
+        if (reported == change) {
+          return true;
+        }
+      }
+      return false;
+    });
+  }
+
+  std::vector<Change> changes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return changes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<Change> changes_;
+};
+
+// Runs every test with the process events connector, which needs
+// CAP_NET_ADMIN and silently turns into polling without it, and with
+// polling only.
+class ProcessWatcherTest : public testing::TestWithParam<bool> {};
+
+}  // namespace
+
+TEST(ListProcesses, FindsThisProcess) {
+  bool found = false;
+  for (const ProcessInfo& process : ListProcesses()) {
+    if (process.pid == getpid()) {
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST(ListProcesses, LeavesOutZombies) {
+  ChildProcess child(AppName());
+  kill(child.pid(), SIGKILL);
+  // Wait for the exit without reaping the child.
+  siginfo_t info;
+  waitid(P_PID, child.pid(), &info, WEXITED | WNOWAIT);
+
+  for (const ProcessInfo& process : ListProcesses()) {
+    EXPECT_NE(process.pid, child.pid());
+  }
+}
+
+TEST_P(ProcessWatcherTest, ReportsAppsRunningAtStartAsState) {
+  const std::string app = AppName();
+  ChildProcess child(app);
+  // Give the child time to rename itself.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  ChangeRecorder recorder;
+  ProcessWatcher watcher({app}, recorder.callback());
+  ASSERT_TRUE(watcher.Start(GetParam(), kPollInterval));
+  EXPECT_EQ(watcher.RunningApps(),
+            (std::vector<Change>{{app, child.pid(), true}}));
+
+  // Only the exit is news.
+  pid_t pid = child.pid();
+  child.Kill();
+  ASSERT_TRUE(recorder.WaitFor({app, pid, false}));
+  EXPECT_EQ(recorder.changes(),
+            (std::vector<Change>{{app, pid, false}}));
+}
+
+TEST_P(ProcessWatcherTest, ReportsLaunchAndExit) {
+  const std::string app = AppName();
+  ChangeRecorder recorder;
+  ProcessWatcher watcher({app}, recorder.callback());
+  ASSERT_TRUE(watcher.Start(GetParam(), kPollInterval));
+  EXPECT_TRUE(watcher.RunningApps().empty());
+
+  ChildProcess child(app);
+  pid_t pid = child.pid();
+  ASSERT_TRUE(recorder.WaitFor({app, pid, true}));
+  EXPECT_EQ(watcher.RunningApps(),
+            (std::vector<Change>{{app, pid, true}}));
+
+  child.Kill();
+  ASSERT_TRUE(recorder.WaitFor({app, pid, false}));
+  EXPECT_TRUE(watcher.RunningApps().empty());
+  EXPECT_EQ(recorder.changes().size(), 2u);
+}
+
+TEST_P(ProcessWatcherTest, IgnoresOtherProcesses) {
+  const std::string app = AppName();
+  ChangeRecorder recorder;
+  ProcessWatcher watcher({app}, recorder.callback());
+  ASSERT_TRUE(watcher.Start(GetParam(), kPollInterval));
+
+  ChildProcess other(AppName("ks-oth-"));
+  std::this_thread::sleep_for(kPollInterval * 5);
+  other.Kill();
+  std::this_thread::sleep_for(kPollInterval * 5);
+  watcher.Stop();
+  EXPECT_TRUE(recorder.changes().empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(ProcConnectorAndPolling,
+                         ProcessWatcherTest,
+                         testing::Bool());
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "keypress_simulator_core/repeat_scheduler.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// Hands out time points relative to an arbitrary epoch, so every test is
+// deterministic.
+class FakeClock {
+ public:
+  RepeatScheduler::TimePoint At(int ms) const {
+    return epoch_ + milliseconds(ms);
+  }
+
+ private:
+  RepeatScheduler::TimePoint epoch_ = RepeatScheduler::TimePoint() +
+                                      std::chrono::hours(1);
+};
+
+}  // namespace
+
+TEST(RepeatScheduler, TicksAfterInitialDelayThenEveryInterval) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  int ticks = 0;
+  ASSERT_TRUE(repeats.Start(1, clock.At(0), milliseconds(300),
+                            milliseconds(100), [&] { ticks++; }));
+
+  EXPECT_EQ(repeats.next_deadline(), clock.At(300));
+  EXPECT_EQ(repeats.RunDue(clock.At(299)), 0u);
+  EXPECT_EQ(repeats.RunDue(clock.At(300)), 1u);
+  EXPECT_EQ(repeats.next_deadline(), clock.At(400));
+  EXPECT_EQ(repeats.RunDue(clock.At(400)), 1u);
+  EXPECT_EQ(ticks, 2);
+}
+
+TEST(RepeatScheduler, LateTicksDoNotDrift) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  ASSERT_TRUE(repeats.Start(1, clock.At(0), milliseconds(100),
+                            milliseconds(100), [] {}));
+
+  // Every wake-up is 7 ms late, yet the grid stays at multiples of 100 ms.
+  for (int i = 1; i <= 10; i++) {
+    ASSERT_EQ(repeats.RunDue(clock.At(i * 100 + 7)), 1u);
+    EXPECT_EQ(repeats.next_deadline(), clock.At((i + 1) * 100));
+  }
+}
+
+TEST(RepeatScheduler, SkipsTicksMissedDuringAStall) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  int ticks = 0;
+  ASSERT_TRUE(repeats.Start(1, clock.At(0), milliseconds(100),
+                            milliseconds(100), [&] { ticks++; }));
+
+  // Woken up 350 ms late: one tick, then back on the grid.
+  EXPECT_EQ(repeats.RunDue(clock.At(450)), 1u);
+  EXPECT_EQ(ticks, 1);
+  EXPECT_EQ(repeats.next_deadline(), clock.At(500));
+}
+
+TEST(RepeatScheduler, RunsEachRepeatOnItsOwnGrid) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  std::vector<ActionId> ticks;
+  ASSERT_TRUE(repeats.Start(1, clock.At(0), milliseconds(100),
+                            milliseconds(100), [&] { ticks.push_back(1); }));
+  ASSERT_TRUE(repeats.Start(2, clock.At(30), milliseconds(40),
+                            milliseconds(50), [&] { ticks.push_back(2); }));
+
+  EXPECT_EQ(repeats.next_deadline(), clock.At(70));
+  repeats.RunDue(clock.At(70));
+  EXPECT_EQ(repeats.next_deadline(), clock.At(100));
+  repeats.RunDue(clock.At(100));
+  repeats.RunDue(clock.At(120));
+  EXPECT_EQ(ticks, (std::vector<ActionId>{2, 1, 2}));
+}
+
+TEST(RepeatScheduler, StopAndRestart) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  int first = 0;
+  int second = 0;
+  ASSERT_TRUE(repeats.Start(1, clock.At(0), milliseconds(100),
+                            milliseconds(100), [&] { first++; }));
+  // Restarting the same action replaces its timing and tick.
+  ASSERT_TRUE(repeats.Start(1, clock.At(50), milliseconds(20),
+                            milliseconds(100), [&] { second++; }));
+  EXPECT_EQ(repeats.RunDue(clock.At(70)), 1u);
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 1);
+
+  EXPECT_TRUE(repeats.Stop(1));
+  EXPECT_FALSE(repeats.Stop(1));
+  EXPECT_TRUE(repeats.empty());
+  EXPECT_EQ(repeats.RunDue(clock.At(1000)), 0u);
+}
+
+TEST(RepeatScheduler, RejectsInvalidTimingAndTooManyRepeats) {
+  FakeClock clock;
+  RepeatScheduler repeats;
+  EXPECT_FALSE(repeats.Start(1, clock.At(0), milliseconds(0),
+                             milliseconds(1), [] {}));
+  EXPECT_FALSE(repeats.Start(1, clock.At(0), milliseconds(-1),
+                             milliseconds(100), [] {}));
+  EXPECT_FALSE(repeats.Start(1, clock.At(0), kMaxRepeatDelay + milliseconds(1),
+                             milliseconds(100), [] {}));
+
+  for (ActionId id = 0; id < RepeatScheduler::kMaxRepeats; id++) {
+    ASSERT_TRUE(repeats.Start(id, clock.At(0), milliseconds(0),
+                              kMinRepeatInterval, [] {}));
+  }
+  EXPECT_FALSE(repeats.Start(RepeatScheduler::kMaxRepeats, clock.At(0),
+                             milliseconds(0), kMinRepeatInterval, [] {}));
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
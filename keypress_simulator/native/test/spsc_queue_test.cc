@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "keypress_simulator_core/spsc_queue.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+TEST(SpscQueue, PopsInPushOrder) {
+  SpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 3; i++) {
+    int value = i;
+    ASSERT_TRUE(queue.TryPush(std::move(value)));
+  }
+  EXPECT_FALSE(queue.empty());
+
+  int value = -1;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.TryPop(&value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, RejectsPushWhenFull) {
+  SpscQueue<int, 2> queue;
+  int a = 1;
+  int b = 2;
+  int c = 3;
+  ASSERT_TRUE(queue.TryPush(std::move(a)));
+  ASSERT_TRUE(queue.TryPush(std::move(b)));
+  EXPECT_FALSE(queue.TryPush(std::move(c)));
+
+  int value = 0;
+  ASSERT_TRUE(queue.TryPop(&value));
+  EXPECT_TRUE(queue.TryPush(std::move(c)));
+  ASSERT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ(value, 2);
+  ASSERT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ(value, 3);
+}
+
+TEST(SpscQueue, MovesOnlyValues) {
+  SpscQueue<std::unique_ptr<int>, 2> queue;
+  ASSERT_TRUE(queue.TryPush(std::make_unique<int>(7)));
+  std::unique_ptr<int> value;
+  ASSERT_TRUE(queue.TryPop(&value));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 7);
+}
+
+TEST(SpscQueue, KeepsOrderAcrossThreads) {
+  constexpr int kCount = 1000000;
+  SpscQueue<int, 64> queue;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < kCount; i++) {
+      int value = i;
+      while (!queue.TryPush(std::move(value))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  int value = 0;
+  while (expected < kCount) {
+    if (!queue.TryPop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(value, expected);
+    expected++;
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
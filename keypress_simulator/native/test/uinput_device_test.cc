@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include <linux/uinput.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/uinput_device.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+struct IoctlCall {
+  unsigned long request;
+  uintptr_t arg;
+};
+
+struct Recording {
+  std::vector<IoctlCall> ioctls;
+  std::vector<input_event> events;
+  std::vector<size_t> write_sizes;
+  uinput_setup setup = {};
+  std::vector<uinput_abs_setup> abs_setups;
+  int open_calls = 0;
+  int close_calls = 0;
+  bool fail_open = false;
+};
+
+// Records everything UinputDevice asks of the kernel.
+class FakeUinputBackend : public UinputBackend {
+ public:
+  explicit FakeUinputBackend(Recording* recording) : recording_(recording) {}
+
+  int Open(const char* path, int flags) override {
+    recording_->open_calls++;
+    EXPECT_STREQ(path, "/dev/uinput");
+    return recording_->fail_open ? -1 : kFakeFd;
+  }
+
+  int Ioctl(int fd, unsigned long request, uintptr_t arg) override {
+    EXPECT_EQ(fd, kFakeFd);
+    recording_->ioctls.push_back({request, arg});
+    if (request == UI_DEV_SETUP) {
+      memcpy(&recording_->setup, reinterpret_cast<const void*>(arg),
+             sizeof(uinput_setup));
+    } else if (request == UI_ABS_SETUP) {
+      uinput_abs_setup abs_setup;
+      memcpy(&abs_setup, reinterpret_cast<const void*>(arg),
+             sizeof(abs_setup));
+      recording_->abs_setups.push_back(abs_setup);
+    }
+    return 0;
+  }
+
+  ssize_t Write(int fd, const void* data, size_t size) override {
+    EXPECT_EQ(fd, kFakeFd);
+    EXPECT_EQ(size % sizeof(input_event), 0u);
+    const input_event* events = static_cast<const input_event*>(data);
+    recording_->events.insert(recording_->events.end(), events,
+                              events + size / sizeof(input_event));
+    recording_->write_sizes.push_back(size);
+    return static_cast<ssize_t>(size);
+  }
+
+  int Close(int fd) override {
+    recording_->close_calls++;
+    return 0;
+  }
+
+ private:
+  static constexpr int kFakeFd = 42;
+  Recording* recording_;
+};
+
+struct Event {
+  uint16_t type;
+  uint16_t code;
+  int32_t value;
+
+  bool operator==(const Event& other) const {
+    return type == other.type && code == other.code && value == other.value;
+  }
+};
+
+std::vector<Event> Events(const Recording& recording) {
+  std::vector<Event> result;
+  for (const input_event& event : recording.events) {
+    result.push_back({event.type, event.code, event.value});
+  }
+  return result;
+}
+
+int CountIoctls(const Recording& recording, unsigned long request) {
+  int count = 0;
+  for (const IoctlCall& call : recording.ioctls) {
+    if (call.request == request) {
+      count++;
+    }
+  }
+  return count;
+}
+
+std::unique_ptr<UinputDevice> CreateDevice(Recording* recording) {
+  auto device = std::make_unique<UinputDevice>(
+      std::make_unique<FakeUinputBackend>(recording));
+  EXPECT_TRUE(device->Create(1920, 1080));
+  return device;
+}
+
+}  // namespace
+
+TEST(UinputDevice, RegistersKeyboardAndPointerOnce) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  EXPECT_TRUE(device->is_open());
+  EXPECT_EQ(recording.open_calls, 1);
+  EXPECT_EQ(CountIoctls(recording, UI_DEV_CREATE), 1);
+  EXPECT_STREQ(recording.setup.name, UinputDevice::kDeviceName);
+  EXPECT_EQ(recording.setup.id.bustype, BUS_VIRTUAL);
+
+  ASSERT_EQ(recording.abs_setups.size(), 2u);
+  EXPECT_EQ(recording.abs_setups[0].code, ABS_X);
+  EXPECT_EQ(recording.abs_setups[0].absinfo.maximum, 1919);
+  EXPECT_EQ(recording.abs_setups[1].code, ABS_Y);
+  EXPECT_EQ(recording.abs_setups[1].absinfo.maximum, 1079);
+
+  // Reusing the device for many events must not touch the setup again.
+  for (int i = 0; i < 10; i++) {
+    device->SendKey(KEY_A, true);
+    device->SendKey(KEY_A, false);
+  }
+  EXPECT_TRUE(device->Create(1920, 1080));
+  EXPECT_EQ(recording.open_calls, 1);
+  EXPECT_EQ(CountIoctls(recording, UI_DEV_CREATE), 1);
+}
+
+TEST(UinputDevice, WritesKeyEventFollowedBySyn) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  EXPECT_TRUE(device->SendKey(KEY_RIGHT, true));
+  EXPECT_TRUE(device->SendKey(KEY_RIGHT, false));
+
+  std::vector<Event> expected = {
+      {EV_KEY, KEY_RIGHT, 1},
+      {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, KEY_RIGHT, 0},
+      {EV_SYN, SYN_REPORT, 0},
+  };
+  EXPECT_EQ(Events(recording), expected);
+  EXPECT_EQ(recording.write_sizes.size(), 2u);
+}
+
+TEST(UinputDevice, SendsChordInOneWrite) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  KeyTransition chord[] = {
+      {KEY_LEFTCTRL, true}, {KEY_LEFTSHIFT, true}, {KEY_R, true}};
+  EXPECT_TRUE(device->SendKeys(chord, 3));
+
+  std::vector<Event> expected = {
+      {EV_KEY, KEY_LEFTCTRL, 1},  {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, KEY_LEFTSHIFT, 1}, {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, KEY_R, 1},         {EV_SYN, SYN_REPORT, 0},
+  };
+  EXPECT_EQ(Events(recording), expected);
+  ASSERT_EQ(recording.write_sizes.size(), 1u);
+  EXPECT_EQ(recording.write_sizes[0], 6 * sizeof(input_event));
+}
+
+TEST(UinputDevice, SplitsLongSequencesIntoBatches) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  std::vector<KeyTransition> sequence;
+  for (size_t i = 0; i < UinputDevice::kMaxBatchTransitions + 1; i++) {
+    sequence.push_back({KEY_A, i % 2 == 0});
+  }
+  EXPECT_TRUE(device->SendKeys(sequence.data(), sequence.size()));
+  EXPECT_EQ(recording.events.size(), sequence.size() * 2);
+  EXPECT_EQ(recording.write_sizes.size(), 2u);
+}
+
+TEST(UinputDevice, TapsMediaKey) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  EXPECT_TRUE(device->TapKey(KEY_PLAYPAUSE));
+
+  std::vector<Event> expected = {
+      {EV_KEY, KEY_PLAYPAUSE, 1},
+      {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, KEY_PLAYPAUSE, 0},
+      {EV_SYN, SYN_REPORT, 0},
+  };
+  EXPECT_EQ(Events(recording), expected);
+}
+
+TEST(UinputDevice, MovesPointerBeforeClicking) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  EXPECT_TRUE(device->SendClick(100, 200, true));
+  EXPECT_TRUE(device->SendClick(5000, -3, false));
+
+  std::vector<Event> expected = {
+      {EV_ABS, ABS_X, 100},    {EV_ABS, ABS_Y, 200},
+      {EV_SYN, SYN_REPORT, 0}, {EV_KEY, BTN_LEFT, 1},
+      {EV_SYN, SYN_REPORT, 0}, {EV_ABS, ABS_X, 1919},
+      {EV_ABS, ABS_Y, 0},      {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, BTN_LEFT, 0},   {EV_SYN, SYN_REPORT, 0},
+  };
+  EXPECT_EQ(Events(recording), expected);
+}
+
+TEST(UinputDevice, MovesPointerWithoutButtons) {
+  Recording recording;
+  auto device = CreateDevice(&recording);
+
+  EXPECT_TRUE(device->MovePointer(640, 360));
+  EXPECT_TRUE(device->MovePointer(-20, 4000));
+
+  std::vector<Event> expected = {
+      {EV_ABS, ABS_X, 640},    {EV_ABS, ABS_Y, 360},
+      {EV_SYN, SYN_REPORT, 0}, {EV_ABS, ABS_X, 0},
+      {EV_ABS, ABS_Y, 1079},   {EV_SYN, SYN_REPORT, 0},
+  };
+  EXPECT_EQ(Events(recording), expected);
+}
+
+TEST(UinputDevice, ReportsFailureWithoutAccess) {
+  Recording recording;
+  recording.fail_open = true;
+  UinputDevice device(std::make_unique<FakeUinputBackend>(&recording));
+
+  EXPECT_FALSE(device.Create(1920, 1080));
+  EXPECT_FALSE(device.is_open());
+  EXPECT_FALSE(device.SendKey(KEY_A, true));
+  EXPECT_TRUE(recording.events.empty());
+}
+
+TEST(UinputDevice, DestroysDeviceOnDestruction) {
+  Recording recording;
+  {
+    auto device = CreateDevice(&recording);
+  }
+  EXPECT_EQ(CountIoctls(recording, UI_DEV_DESTROY), 1);
+  EXPECT_EQ(recording.close_calls, 1);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
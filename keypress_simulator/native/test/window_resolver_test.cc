@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "fake_window_enumerator.h"
+#include "keypress_simulator_core/window_resolver.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+const std::vector<std::string> kCompatibleApps = {
+    "MyWhooshHD.exe", "MyWhoosh.exe", "indieVelo.exe", "biketerra.exe",
+    "Rouvy.exe"};
+
+}  // namespace
+
+TEST(TargetWindowResolver, FindsHighestPriorityApp) {
+  FakeWindowEnumerator windows;
+  windows.Add(1, "explorer.exe");
+  windows.Add(2, "ROUVY.EXE");
+  windows.Add(3, "MyWhoosh.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+
+  std::string process_name;
+  EXPECT_EQ(resolver.Resolve(&process_name), 3u);
+  EXPECT_EQ(process_name, "mywhoosh.exe");
+}
+
+TEST(TargetWindowResolver, ReturnsZeroWhenNoAppIsRunning) {
+  FakeWindowEnumerator windows;
+  windows.Add(1, "explorer.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+
+  std::string process_name = "stale";
+  EXPECT_EQ(resolver.Resolve(&process_name), 0u);
+  EXPECT_EQ(process_name, "");
+}
+
+TEST(TargetWindowResolver, ServesRepeatedLookupsFromCache) {
+  FakeWindowEnumerator windows;
+  windows.Add(1, "explorer.exe");
+  windows.Add(2, "Rouvy.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(resolver.Resolve(), 2u);
+  }
+  EXPECT_EQ(windows.enumerations(), 1);
+  EXPECT_EQ(resolver.stats().misses, 1u);
+  EXPECT_EQ(resolver.stats().hits, 99u);
+  EXPECT_EQ(resolver.stats().process_queries, 2u);
+}
+
+TEST(TargetWindowResolver, CachesAbsenceUntilAWindowAppears) {
+  FakeWindowEnumerator windows;
+  windows.Add(1, "explorer.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+
+  EXPECT_EQ(resolver.Resolve(), 0u);
+  EXPECT_EQ(resolver.Resolve(), 0u);
+  EXPECT_EQ(windows.enumerations(), 1);
+
+  windows.Add(7, "indieVelo.exe");
+  resolver.OnWindowShown(7);
+  EXPECT_EQ(resolver.Resolve(), 7u);
+  EXPECT_EQ(windows.enumerations(), 2);
+  // The explorer window was not queried again.
+  EXPECT_EQ(resolver.stats().process_queries, 2u);
+}
+
+TEST(TargetWindowResolver, KnownWindowsDoNotTriggerRescan) {
+  FakeWindowEnumerator windows;
+  windows.Add(1, "explorer.exe");
+  windows.Add(2, "MyWhoosh.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+
+  // Unrelated or lower priority windows being shown again changes nothing.
+  resolver.OnWindowShown(1);
+  resolver.OnWindowShown(2);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+  EXPECT_EQ(windows.enumerations(), 1);
+}
+
+TEST(TargetWindowResolver, DestroyedTargetIsReplaced) {
+  FakeWindowEnumerator windows;
+  windows.Add(2, "MyWhoosh.exe");
+  windows.Add(3, "Rouvy.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+
+  windows.Remove(2);
+  resolver.OnWindowDestroyed(2);
+  EXPECT_EQ(resolver.Resolve(), 3u);
+}
+
+TEST(TargetWindowResolver, RecycledHandleIsQueriedAgain) {
+  FakeWindowEnumerator windows;
+  windows.Add(5, "notepad.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 0u);
+
+  windows.Remove(5);
+  resolver.OnWindowDestroyed(5);
+  windows.Add(5, "Rouvy.exe");
+  resolver.OnWindowShown(5);
+  EXPECT_EQ(resolver.Resolve(), 5u);
+}
+
+TEST(TargetWindowResolver, RescanForgetsWindowsThatAreGone) {
+  FakeWindowEnumerator windows;
+  windows.Add(5, "notepad.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 0u);
+
+  // The destroy notification for 5 is lost, but the next rescan drops it.
+  windows.Remove(5);
+  windows.Add(6, "explorer.exe");
+  resolver.OnWindowShown(6);
+  EXPECT_EQ(resolver.Resolve(), 0u);
+
+  windows.Add(5, "Rouvy.exe");
+  resolver.OnWindowShown(5);
+  EXPECT_EQ(resolver.Resolve(), 5u);
+}
+
+TEST(TargetWindowResolver, MinimizedTargetIsSkipped) {
+  FakeWindowEnumerator windows;
+  windows.Add(2, "MyWhoosh.exe");
+  windows.Add(3, "Rouvy.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+
+  windows.SetUsable(2, false);
+  resolver.OnWindowHidden(2);
+  EXPECT_EQ(resolver.Resolve(), 3u);
+
+  windows.SetUsable(2, true);
+  resolver.OnWindowShown(2);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+}
+
+TEST(TargetWindowResolver, RevalidatesTargetWithoutNotification) {
+  FakeWindowEnumerator windows;
+  windows.Add(2, "MyWhoosh.exe");
+  windows.Add(3, "Rouvy.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+
+  // A missed notification must not leave us posting to a dead window.
+  windows.Remove(2);
+  EXPECT_EQ(resolver.Resolve(), 3u);
+}
+
+TEST(TargetWindowResolver, InvalidateForgetsEverything) {
+  FakeWindowEnumerator windows;
+  windows.Add(2, "Rouvy.exe");
+  TargetWindowResolver resolver(&windows, kCompatibleApps);
+  EXPECT_EQ(resolver.Resolve(), 2u);
+
+  resolver.Invalidate();
+  EXPECT_EQ(resolver.Resolve(), 2u);
+  EXPECT_EQ(resolver.stats().process_queries, 2u);
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <linux/input-event-codes.h>
+
+#include <string>
+#include <vector>
+
+#include "keypress_simulator_core/x11_key_target.h"
+
+namespace keypress_simulator_core {
+namespace test {
+
+namespace {
+
+const std::vector<std::string> kCompatibleApps = {"MyWhoosh.exe",
+                                                  "Rouvy.exe"};
+
+// Runs against the X server in $DISPLAY, e.g. `xvfb-run ctest`, and skips
+// without one.
+class X11KeyTargetTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    display_ = XOpenDisplay(nullptr);
+    if (display_ == nullptr) {
+      GTEST_SKIP() << "No X server; run the tests under Xvfb";
+    }
+    ASSERT_TRUE(target_.Open());
+  }
+
+  void TearDown() override {
+    target_.Close();
+    if (display_ != nullptr) {
+      XCloseDisplay(display_);
+    }
+  }
+
+  // Creates and maps a top-level window with |wm_class| as its WM_CLASS
+  // instance name, and waits until it is viewable.
+  Window CreateWindow(const char* wm_class) {
+    Window window = XCreateSimpleWindow(display_, DefaultRootWindow(display_),
+                                        0, 0, 100, 100, 0, 0, 0);
+    std::string name = wm_class;
+    XClassHint class_hint = {&name[0], &name[0]};
+    XSetClassHint(display_, window, &class_hint);
+    XSelectInput(display_, window,
+                 KeyPressMask | KeyReleaseMask | StructureNotifyMask);
+    XMapWindow(display_, window);
+    XEvent event;
+    do {
+      XWindowEvent(display_, window, StructureNotifyMask, &event);
+    } while (event.type != MapNotify);
+    return window;
+  }
+
+  XKeyEvent NextKeyEvent(Window window) {
+    XEvent event;
+    XWindowEvent(display_, window, KeyPressMask | KeyReleaseMask, &event);
+    return event.xkey;
+  }
+
+  Display* display_ = nullptr;
+  X11KeyTarget target_{kCompatibleApps};
+};
+
+}  // namespace
+
+TEST(X11ModifierMask, MapsBothHandsOfEveryModifier) {
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_LEFTSHIFT),
+            static_cast<unsigned int>(ShiftMask));
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_RIGHTSHIFT),
+            static_cast<unsigned int>(ShiftMask));
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_LEFTCTRL),
+            static_cast<unsigned int>(ControlMask));
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_RIGHTALT),
+            static_cast<unsigned int>(Mod1Mask));
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_LEFTMETA),
+            static_cast<unsigned int>(Mod4Mask));
+  EXPECT_EQ(X11ModifierMaskForEvdevKey(KEY_A), 0u);
+}
+
+TEST(X11KeyTarget, DoesNothingWhenClosed) {
+  X11KeyTarget target(kCompatibleApps);
+  KeyTransition key = {KEY_A, true};
+  EXPECT_FALSE(target.is_open());
+  EXPECT_EQ(target.ResolveTarget(), 0u);
+  EXPECT_FALSE(target.SendKeys(&key, 1));
+}
+
+TEST_F(X11KeyTargetTest, FindsTheAppByWmClass) {
+  CreateWindow("firefox");
+  Window app = CreateWindow("rouvy.exe");
+  EXPECT_EQ(target_.ResolveTarget(), app);
+}
+
+TEST_F(X11KeyTargetTest, LeavesKeysAloneWithoutTarget) {
+  CreateWindow("firefox");
+  KeyTransition key = {KEY_A, true};
+  EXPECT_EQ(target_.ResolveTarget(), 0u);
+  EXPECT_FALSE(target_.SendKeys(&key, 1));
+}
+
+TEST_F(X11KeyTargetTest, NoticesAppsStartedLater) {
+  EXPECT_EQ(target_.ResolveTarget(), 0u);
+  EXPECT_EQ(target_.ResolveTarget(), 0u);
+  EXPECT_EQ(target_.resolver_stats().misses, 1u);
+
+  Window app = CreateWindow("mywhoosh.exe");
+  XSync(display_, False);
+  EXPECT_EQ(target_.ResolveTarget(), app);
+}
+
+TEST_F(X11KeyTargetTest, NoticesAppsInsideWindowManagerFrames) {
+  // What a reparenting window manager does: the app's window is a child of
+  // a frame, and the root window only hears about the frame.
+  Window frame = CreateWindow("frame");
+  EXPECT_EQ(target_.ResolveTarget(), 0u);
+
+  Window app = XCreateSimpleWindow(display_, frame, 0, 0, 100, 100, 0, 0, 0);
+  std::string name = "rouvy.exe";
+  XClassHint class_hint = {&name[0], &name[0]};
+  XSetClassHint(display_, app, &class_hint);
+  XMapWindow(display_, app);
+  Atom client_list = XInternAtom(display_, "_NET_CLIENT_LIST", False);
+  XChangeProperty(display_, DefaultRootWindow(display_), client_list,
+                  XA_WINDOW, 32, PropModeReplace,
+                  reinterpret_cast<unsigned char*>(&app), 1);
+  XSync(display_, False);
+  EXPECT_EQ(target_.ResolveTarget(), app);
+
+  XDeleteProperty(display_, DefaultRootWindow(display_), client_list);
+  XSync(display_, False);
+}
+
+TEST_F(X11KeyTargetTest, DropsDestroyedTarget) {
+  Window app = CreateWindow("mywhoosh.exe");
+  EXPECT_EQ(target_.ResolveTarget(), app);
+
+  XDestroyWindow(display_, app);
+  XSync(display_, False);
+  EXPECT_EQ(target_.ResolveTarget(), 0u);
+}
+
+TEST_F(X11KeyTargetTest, SendsChordToUnfocusedWindow) {
+  Window app = CreateWindow("mywhoosh.exe");
+  Window other = CreateWindow("firefox");
+  XSetInputFocus(display_, other, RevertToParent, CurrentTime);
+  XSync(display_, False);
+
+  const KeyTransition chord[] = {
+      {KEY_LEFTSHIFT, true},
+      {KEY_A, true},
+      {KEY_A, false},
+      {KEY_LEFTSHIFT, false},
+  };
+  ASSERT_TRUE(target_.SendKeys(chord, 4));
+
+  KeyCode shift = XKeysymToKeycode(display_, XK_Shift_L);
+  KeyCode a = XKeysymToKeycode(display_, XK_a);
+  struct Expected {
+    int type;
+    KeyCode keycode;
+    unsigned int state;
+  };
+  const Expected kExpected[] = {
+      {KeyPress, shift, 0},
+      {KeyPress, a, ShiftMask},
+      {KeyRelease, a, ShiftMask},
+      {KeyRelease, shift, ShiftMask},
+  };
+  for (const Expected& expected : kExpected) {
+    XKeyEvent event = NextKeyEvent(app);
+    EXPECT_TRUE(event.send_event);
+    EXPECT_EQ(event.type, expected.type);
+    EXPECT_EQ(event.keycode, expected.keycode);
+    EXPECT_EQ(event.state, expected.state);
+  }
+}
+
+TEST_F(X11KeyTargetTest, LeavesFocusedTargetToTheRegularPath) {
+  Window app = CreateWindow("mywhoosh.exe");
+  XSetInputFocus(display_, app, RevertToParent, CurrentTime);
+  XSync(display_, False);
+
+  KeyTransition key = {KEY_A, true};
+  EXPECT_FALSE(target_.SendKeys(&key, 1));
+}
+
+}  // namespace test
+}  // namespace keypress_simulator_core
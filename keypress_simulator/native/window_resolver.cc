@@ -0,0 +1,126 @@
+#include "keypress_simulator_core/window_resolver.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace keypress_simulator_core {
+
+namespace {
+
+std::string ToLower(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) {
+                   return static_cast<char>(std::tolower(c));
+                 });
+  return value;
+}
+
+}  // namespace
+
+TargetWindowResolver::TargetWindowResolver(
+    WindowEnumerator* enumerator,
+    std::vector<std::string> process_names)
+    : enumerator_(enumerator), process_names_(std::move(process_names)) {
+  for (std::string& name : process_names_) {
+    name = ToLower(name);
+  }
+}
+
+WindowHandle TargetWindowResolver::Resolve(std::string* process_name) {
+  if (stale_ || (target_ != 0 && !enumerator_->IsUsable(target_))) {
+    stats_.misses++;
+    Rescan();
+  } else {
+    stats_.hits++;
+  }
+
+  if (process_name != nullptr) {
+    *process_name = target_index_ >= 0 ? process_names_[target_index_] : "";
+  }
+  return target_;
+}
+
+void TargetWindowResolver::OnWindowShown(WindowHandle window) {
+  // A window we already know can only become the target if it is a better
+  // match than the current one; anything unknown needs a look.
+  auto it = window_matches_.find(window);
+  if (it == window_matches_.end() ||
+      (it->second >= 0 &&
+       (target_index_ < 0 || it->second < target_index_))) {
+    stale_ = true;
+  }
+}
+
+void TargetWindowResolver::OnWindowHidden(WindowHandle window) {
+  if (window == target_) {
+    stale_ = true;
+  }
+}
+
+void TargetWindowResolver::OnWindowDestroyed(WindowHandle window) {
+  // Handles are recycled, so the process mapping must go too.
+  window_matches_.erase(window);
+  if (window == target_) {
+    target_ = 0;
+    target_index_ = -1;
+    stale_ = true;
+  }
+}
+
+void TargetWindowResolver::Invalidate() {
+  window_matches_.clear();
+  target_ = 0;
+  target_index_ = -1;
+  stale_ = true;
+}
+
+int TargetWindowResolver::MatchWindow(WindowHandle window) {
+  auto it = window_matches_.find(window);
+  if (it != window_matches_.end()) {
+    return it->second;
+  }
+
+  stats_.process_queries++;
+  const std::string name = ToLower(enumerator_->GetProcessName(window));
+  int match = -1;
+  for (size_t i = 0; i < process_names_.size(); i++) {
+    if (process_names_[i] == name) {
+      match = static_cast<int>(i);
+      break;
+    }
+  }
+  window_matches_.emplace(window, match);
+  return match;
+}
+
+void TargetWindowResolver::Rescan() {
+  WindowHandle best = 0;
+  int best_index = -1;
+  std::unordered_set<WindowHandle> seen;
+  enumerator_->EnumerateWindows([&](WindowHandle window) {
+    seen.insert(window);
+    int match = MatchWindow(window);
+    if (match >= 0 && (best_index < 0 || match < best_index)) {
+      best = window;
+      best_index = match;
+    }
+    return true;
+  });
+
+  // A destroy notification can be missed, and a recycled handle would then
+  // inherit the old window's match. Windows that come back are queried again.
+  for (auto it = window_matches_.begin(); it != window_matches_.end();) {
+    if (seen.count(it->first) != 0) {
+      ++it;
+    } else {
+      it = window_matches_.erase(it);
+    }
+  }
+
+  target_ = best;
+  target_index_ = best_index;
+  stale_ = false;
+}
+
+}  // namespace keypress_simulator_core
@@ -1 +1,3 @@
+export 'package:keypress_simulator_platform_interface/keypress_simulator_platform_interface.dart'
+    show DragEasing, KeySequenceStep, TrainerAppEvent;
 export 'src/keypress_simulator.dart';
@@ -2,6 +2,8 @@ import 'dart:async';
 import 'dart:io';
 
 import 'package:flutter/services.dart';
+import 'package:keypress_simulator/src/keypress_simulator_ffi_stub.dart'
+    if (dart.library.ffi) 'package:keypress_simulator/src/keypress_simulator_ffi.dart';
 import 'package:keypress_simulator_platform_interface/keypress_simulator_platform_interface.dart';
 
 class KeyPressSimulator {
@@ -12,6 +14,9 @@ class KeyPressSimulator {
 
   KeyPressSimulatorPlatform get _platform => KeyPressSimulatorPlatform.instance;
 
+  /// Direct calls into the plugin, where it exports them.
+  late final KeyPressSimulatorFfi? _ffi = KeyPressSimulatorFfi.open();
+
   Future<bool> isAccessAllowed() {
     return _platform.isAccessAllowed();
   }
@@ -38,11 +43,132 @@ class KeyPressSimulator {
     return _platform.simulateKeyPress(key: key, modifiers: modifiers, keyDown: false);
   }
 
+  /// Drag the pointer along [path] with the primary button held.
+  ///
+  /// The pointer is interpolated natively at a steady rate; the call returns
+  /// once the drag has been queued.
+  Future<void> simulateDrag(
+    List<Offset> path, {
+    Duration duration = const Duration(milliseconds: 300),
+    DragEasing easing = DragEasing.easeInOut,
+  }) {
+    return _platform.simulateDrag(path, duration: duration, easing: easing);
+  }
+
+  /// Map click positions to the screen coordinates they would land on.
+  ///
+  /// All [points] are mapped in one platform call against the cached monitor
+  /// layout, so this is cheap enough to call while dragging.
+  Future<List<Offset>> mapPoints(List<Offset> points) {
+    return _platform.mapPoints(points);
+  }
+
+  /// Simulate a chord or macro in one platform call.
+  ///
+  /// Modifiers and keys of all [steps] are injected back to back, so no other
+  /// input can end up between them. [originMicros] is the `Timeline.now`
+  /// timestamp of the input behind the keys, for [getLatencyStats].
+  Future<void> simulateKeySequence(List<KeySequenceStep> steps, {int? originMicros}) {
+    return _platform.simulateKeySequence(steps, originMicros: originMicros);
+  }
+
+  /// Upload the chords of a keymap once, keyed by action ID.
+  ///
+  /// Afterwards [simulateAction] only sends the ID to the platform, which
+  /// looks up the pre-resolved keys instead of decoding them on every press.
+  Future<void> registerKeymap(Map<int, KeySequenceStep> actions) {
+    return _platform.registerKeymap(actions);
+  }
+
+  /// Simulate an action registered with [registerKeymap].
+  ///
+  /// `true` only presses the chord, `false` only releases it and `null`
+  /// presses and releases it. [originMicros] is as for
+  /// [simulateKeySequence].
+  Future<void> simulateAction(int actionId, {bool? keyDown, int? originMicros}) {
+    return _platform.simulateAction(actionId, keyDown: keyDown, originMicros: originMicros);
+  }
+
+  /// Simulate an action registered with [registerKeymap] with a direct,
+  /// synchronous call into the plugin through `dart:ffi`.
+  ///
+  /// Skips the platform channel, so the keys are queued by the time this
+  /// returns. Returns false if the platform has no direct calls, in which
+  /// case use [simulateAction]. Throws a [PlatformException] with the same
+  /// codes as [simulateAction] otherwise.
+  bool trySimulateActionDirect(int actionId, {bool? keyDown, int? originMicros}) {
+    final ffi = _ffi;
+    if (ffi == null) return false;
+    final phase = keyDown == null
+        ? KeyPressSimulatorFfi.keyTap
+        : (keyDown ? KeyPressSimulatorFfi.keyDown : KeyPressSimulatorFfi.keyUp);
+    return _checkDirectResult(ffi.key(actionId, phase, originMicros ?? 0));
+  }
+
+  /// Press or release the primary button at [position] with a direct,
+  /// synchronous call, like [trySimulateActionDirect].
+  bool trySimulateMouseClickDirect(Offset position, {required bool keyDown}) {
+    final ffi = _ffi;
+    if (ffi == null) return false;
+    return _checkDirectResult(ffi.click(position.dx, position.dy, keyDown));
+  }
+
+  bool _checkDirectResult(int result) {
+    switch (result) {
+      case KeyPressSimulatorFfi.ok:
+        return true;
+      case KeyPressSimulatorFfi.errorUnavailable:
+        return false;
+      case KeyPressSimulatorFfi.errorUnknownAction:
+        throw PlatformException(code: 'UNKNOWN_ACTION', message: 'The action was not registered');
+      case KeyPressSimulatorFfi.errorQueueFull:
+        throw PlatformException(code: 'QUEUE_FULL', message: 'Too many pending input events');
+      default:
+        throw PlatformException(code: 'INVALID_ARGUMENT', message: 'Rejected by the plugin ($result)');
+    }
+  }
+
+  /// Tap an action registered with [registerKeymap] after [initialDelay] and
+  /// then every [interval], e.g. while a shift button is held.
+  ///
+  /// The repeats are timed natively against a fixed schedule, so they stay
+  /// evenly spaced even when the UI isolate is busy.
+  Future<void> startRepeat(
+    int actionId, {
+    required Duration initialDelay,
+    required Duration interval,
+  }) {
+    return _platform.startRepeat(actionId, initialDelay: initialDelay, interval: interval);
+  }
+
+  /// Stop the repeats started with [startRepeat].
+  Future<void> stopRepeat(int actionId) {
+    return _platform.stopRepeat(actionId);
+  }
+
   /// Simulate media key press.
   Future<void> simulateMediaKey(PhysicalKeyboardKey mediaKey) {
     return _platform.simulateMediaKey(mediaKey);
   }
 
+  /// Latency of injected input by stage, measured natively.
+  ///
+  /// `dispatch` runs from the `originMicros` passed to [simulateAction] or
+  /// [simulateKeySequence] to the platform queueing the keys, `queue` is the
+  /// wait for the injection thread, `inject` the OS call and `total` all of
+  /// it. With [reset] the statistics start over afterwards. Empty on
+  /// platforms that do not measure latency.
+  Future<Map<String, LatencyStats>> getLatencyStats({bool reset = false}) {
+    return _platform.getLatencyStats(reset: reset);
+  }
+
+  /// Trainer apps starting and exiting, watched natively.
+  ///
+  /// A new listener first gets a `running` event for every compatible app
+  /// that is already running. Events may repeat, so keep the running apps in
+  /// a set. Empty on platforms that do not watch processes.
+  Stream<TrainerAppEvent> get trainerAppEvents => _platform.trainerAppEvents;
+
   @Deprecated('Please use simulateKeyDown & simulateKeyUp methods.')
   Future<void> simulateCtrlCKeyPress() async {
     const key = PhysicalKeyboardKey.keyC;
@@ -0,0 +1,54 @@
+import 'dart:ffi';
+import 'dart:io';
+
+/// Bindings for the C ABI exported by the native plugins (see
+/// `native/include/keypress_simulator_core/keypress_simulator_ffi.h`).
+///
+/// The calls are synchronous and skip the platform channel entirely: no
+/// codec, no hop to the platform thread and no reply message.
+class KeyPressSimulatorFfi {
+  KeyPressSimulatorFfi._(this._key, this._click);
+
+  /// The ABI version this file was written against.
+  static const int abiVersion = 1;
+
+  // Results, as in keypress_simulator_ffi.h.
+  static const int ok = 0;
+  static const int errorUnavailable = -1;
+  static const int errorInvalidArgument = -2;
+  static const int errorUnknownAction = -3;
+  static const int errorQueueFull = -4;
+
+  // The down argument of ks_key.
+  static const int keyUp = 0;
+  static const int keyDown = 1;
+  static const int keyTap = 2;
+
+  final int Function(int, int, int) _key;
+  final int Function(double, double, int) _click;
+
+  /// Binds the functions of the platform's plugin. Returns null where the
+  /// plugin does not export them or exports another ABI version.
+  static KeyPressSimulatorFfi? open() {
+    if (!Platform.isLinux) return null;
+    try {
+      final library = DynamicLibrary.open('libkeypress_simulator_linux_plugin.so');
+      final version = library.lookupFunction<Int32 Function(), int Function()>('ks_abi_version');
+      if (version() != abiVersion) return null;
+      return KeyPressSimulatorFfi._(
+        library.lookupFunction<Int32 Function(Int32, Int32, Int64), int Function(int, int, int)>('ks_key_traced'),
+        library.lookupFunction<Int32 Function(Double, Double, Int32), int Function(double, double, int)>('ks_click'),
+      );
+    } on ArgumentError {
+      // The library or one of the symbols is missing.
+      return null;
+    }
+  }
+
+  /// Queues the chord registered as [actionId]; see [keyDown], [keyUp] and
+  /// [keyTap]. [originMicros] is a `Timeline.now` timestamp or 0.
+  int key(int actionId, int phase, int originMicros) => _key(actionId, phase, originMicros);
+
+  /// Queues a left button press or release at ([x], [y]).
+  int click(double x, double y, bool down) => _click(x, y, down ? 1 : 0);
+}
@@ -0,0 +1,19 @@
+/// Stands in for the `dart:ffi` bindings on platforms without `dart:ffi`
+/// (the web), where direct calls are never available.
+class KeyPressSimulatorFfi {
+  static const int ok = 0;
+  static const int errorUnavailable = -1;
+  static const int errorInvalidArgument = -2;
+  static const int errorUnknownAction = -3;
+  static const int errorQueueFull = -4;
+
+  static const int keyUp = 0;
+  static const int keyDown = 1;
+  static const int keyTap = 2;
+
+  static KeyPressSimulatorFfi? open() => null;
+
+  int key(int actionId, int phase, int originMicros) => errorUnavailable;
+
+  int click(double x, double y, bool down) => errorUnavailable;
+}
@@ -0,0 +1,863 @@
+#include "include/keypress_simulator_linux/keypress_simulator_linux_plugin.h"
+
+#include <flutter_linux/flutter_linux.h>
+#include <gtk/gtk.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "keypress_simulator_core/action_table.h"
+#include "keypress_simulator_core/drag_gesture.h"
+#include "keypress_simulator_core/ffi_bridge.h"
+#include "keypress_simulator_core/injection_worker.h"
+#include "keypress_simulator_core/key_codes.h"
+#include "keypress_simulator_core/latency_stats.h"
+#include "keypress_simulator_core/process_watcher.h"
+#include "keypress_simulator_core/repeat_scheduler.h"
+#include "keypress_simulator_core/uinput_device.h"
+#include "keypress_simulator_core/x11_key_target.h"
+
+using keypress_simulator_core::ActionId;
+using keypress_simulator_core::ActionTable;
+using keypress_simulator_core::ChordPhase;
+using keypress_simulator_core::DragGesture;
+using keypress_simulator_core::FfiBackend;
+using keypress_simulator_core::InjectionWorker;
+using keypress_simulator_core::KeyBatchBuilder;
+using keypress_simulator_core::KeyTransition;
+using keypress_simulator_core::LatencyStage;
+using keypress_simulator_core::LatencySummary;
+using keypress_simulator_core::ModifierKeyCodes;
+using keypress_simulator_core::PointerSink;
+using keypress_simulator_core::PointF;
+using keypress_simulator_core::ProcessWatcher;
+using keypress_simulator_core::SteadyDragClock;
+using keypress_simulator_core::UinputDevice;
+using keypress_simulator_core::X11KeyTarget;
+
+const char kChannelName[] = "dev.leanflutter.plugins/keypress_simulator";
+const char kGetLatencyStats[] = "getLatencyStats";
+const char kRegisterKeymap[] = "registerKeymap";
+const char kSimulateAction[] = "simulateAction";
+const char kSimulateKeyPress[] = "simulateKeyPress";
+const char kSimulateKeySequence[] = "simulateKeySequence";
+const char kSimulateMouseClick[] = "simulateMouseClick";
+const char kSimulateDrag[] = "simulateDrag";
+const char kSimulateMediaKey[] = "simulateMediaKey";
+const char kStartRepeat[] = "startRepeat";
+const char kStopRepeat[] = "stopRepeat";
+
+const char kTrainerAppChannelName[] =
+    "dev.leanflutter.plugins/keypress_simulator/trainer_apps";
+
+// Trainer apps that take keys while in the background. They run under Wine or
+// Proton, which names their X11 windows after the Windows executable.
+const std::vector<std::string> kCompatibleApps = {
+    "MyWhooshHD.exe", "MyWhoosh.exe", "indieVelo.exe", "biketerra.exe",
+    "Rouvy.exe"};
+
+// evdev codes for keypress_simulator_core::kModifierOrder.
+const ModifierKeyCodes kModifierEvdevKeys = {
+    keypress_simulator_core::EvdevKeyForModifier(
+        keypress_simulator_core::kModifierShift),
+    keypress_simulator_core::EvdevKeyForModifier(
+        keypress_simulator_core::kModifierControl),
+    keypress_simulator_core::EvdevKeyForModifier(
+        keypress_simulator_core::kModifierAlt),
+    keypress_simulator_core::EvdevKeyForModifier(
+        keypress_simulator_core::kModifierMeta),
+};
+
+struct _FlKeypressSimulatorLinuxPlugin {
+  GObject parent_instance;
+
+  FlPluginRegistrar* registrar;
+
+  // Connection to Flutter engine.
+  FlMethodChannel* channel;
+
+  // Virtual input device created once at registration and reused for every
+  // event.
+  UinputDevice* device;
+
+  // Chords uploaded with registerKeymap, in evdev codes.
+  ActionTable<KeyTransition>* actions;
+
+  // Delivers keys to an unfocused compatible app over X11. Not connected
+  // outside X11 sessions.
+  X11KeyTarget* x11_target;
+
+  // Writes to |device| and |x11_target| off the platform thread. It is their
+  // only user once they have been set up.
+  InjectionWorker* worker;
+
+  // Serves the exported ks_* functions.
+  FfiBackend* ffi_backend;
+
+  // Publishes trainer app launches and exits.
+  FlEventChannel* trainer_app_channel;
+
+  // Runs while |trainer_app_channel| has a listener.
+  ProcessWatcher* process_watcher;
+};
+
+G_DEFINE_TYPE(FlKeypressSimulatorLinuxPlugin,
+              fl_keypress_simulator_linux_plugin,
+              g_object_get_type())
+
+// Returns the size of the rectangle spanning all monitors, in logical pixels.
+static void get_desktop_size(int* width, int* height) {
+  *width = 0;
+  *height = 0;
+  GdkDisplay* display = gdk_display_get_default();
+  if (display == nullptr) {
+    return;
+  }
+  for (int i = 0; i < gdk_display_get_n_monitors(display); i++) {
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(gdk_display_get_monitor(display, i), &geometry);
+    *width = std::max(*width, geometry.x + geometry.width);
+    *height = std::max(*height, geometry.y + geometry.height);
+  }
+}
+
+static FlMethodResponse* device_unavailable_response() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "UINPUT_UNAVAILABLE",
+      "Could not open /dev/uinput. Make sure the user has write access to it.",
+      nullptr));
+}
+
+static FlMethodResponse* invalid_argument_response(const gchar* message) {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new("INVALID_ARGUMENT", message, nullptr));
+}
+
+static FlMethodResponse* queue_full_response() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "QUEUE_FULL", "Too many pending input events", nullptr));
+}
+
+// Injection runs on the worker after the method call has already returned,
+// so failures can only be logged.
+static void report_injection_result(bool succeeded) {
+  if (!succeeded) {
+    g_warning("keypress_simulator: failed to write input events");
+  }
+}
+
+// Queues |task| on the injection worker and answers the method call right
+// away.
+static FlMethodResponse* post_injection(FlKeypressSimulatorLinuxPlugin* self,
+                                        InjectionWorker::Task task) {
+  if (!self->worker->Post(std::move(task), report_injection_result)) {
+    return queue_full_response();
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+// Parses a simulateKeyPress-style argument map ({physicalKey, modifiers,
+// keyDown}). Without keyDown the key is pressed and released. Returns false if
+// the key is missing or unsupported.
+static bool parse_chord(FlValue* args,
+                        uint8_t* modifiers_out,
+                        uint16_t* code_out,
+                        ChordPhase* phase_out) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return false;
+  }
+  FlValue* physical_key_value = fl_value_lookup_string(args, "physicalKey");
+  if (physical_key_value == nullptr ||
+      fl_value_get_type(physical_key_value) != FL_VALUE_TYPE_INT) {
+    return false;
+  }
+  uint16_t code = keypress_simulator_core::EvdevKeyForPhysicalKey(
+      static_cast<uint32_t>(fl_value_get_int(physical_key_value)));
+  if (code == 0) {
+    return false;
+  }
+
+  uint8_t modifiers = keypress_simulator_core::kModifierNone;
+  FlValue* modifiers_value = fl_value_lookup_string(args, "modifiers");
+  if (modifiers_value != nullptr &&
+      fl_value_get_type(modifiers_value) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(modifiers_value); i++) {
+      FlValue* name = fl_value_get_list_value(modifiers_value, i);
+      if (fl_value_get_type(name) == FL_VALUE_TYPE_STRING) {
+        modifiers = static_cast<uint8_t>(
+            modifiers | keypress_simulator_core::ModifierFromName(
+                            fl_value_get_string(name)));
+      }
+    }
+  }
+
+  ChordPhase phase = ChordPhase::kTap;
+  FlValue* key_down_value = fl_value_lookup_string(args, "keyDown");
+  if (key_down_value != nullptr &&
+      fl_value_get_type(key_down_value) == FL_VALUE_TYPE_BOOL) {
+    phase = fl_value_get_bool(key_down_value) ? ChordPhase::kDown
+                                              : ChordPhase::kUp;
+  }
+
+  *modifiers_out = modifiers;
+  *code_out = code;
+  *phase_out = phase;
+  return true;
+}
+
+// Appends the chord described by a simulateKeyPress-style argument map.
+static bool add_chord_from_args(FlValue* args, KeyBatchBuilder* batch) {
+  uint8_t modifiers = keypress_simulator_core::kModifierNone;
+  uint16_t code = 0;
+  ChordPhase phase = ChordPhase::kTap;
+  if (!parse_chord(args, &modifiers, &code, &phase)) {
+    return false;
+  }
+  batch->AddChord(modifiers, code, phase);
+  return true;
+}
+
+static KeyTransition identity_transition(const KeyTransition& transition) {
+  return transition;
+}
+
+// Runs on the worker. Like the Windows plugin, keys go straight to a
+// compatible app in the background and through the virtual keyboard, i.e. to
+// the focused window, otherwise.
+static bool inject_keys(UinputDevice* device,
+                        X11KeyTarget* x11_target,
+                        const std::vector<KeyTransition>& batch) {
+  if (x11_target->SendKeys(batch.data(), batch.size())) {
+    return true;
+  }
+  return device->SendKeys(batch.data(), batch.size());
+}
+
+// Queues |count| transitions. Returns false if the queue is full.
+static bool post_keys(FlKeypressSimulatorLinuxPlugin* self,
+                      const KeyTransition* transitions,
+                      size_t count,
+                      InjectionWorker::TimePoint origin) {
+  // |transitions| may point into the action table, which registerKeymap can
+  // replace while the task is still queued.
+  UinputDevice* device = self->device;
+  X11KeyTarget* x11_target = self->x11_target;
+  std::vector<KeyTransition> batch(transitions, transitions + count);
+  return self->worker->Post(
+      [device, x11_target, batch = std::move(batch)] {
+        return inject_keys(device, x11_target, batch);
+      },
+      report_injection_result, origin);
+}
+
+// Queues a left button press or release. Returns false if the queue is full.
+static bool post_click(FlKeypressSimulatorLinuxPlugin* self,
+                       double x,
+                       double y,
+                       bool down) {
+  UinputDevice* device = self->device;
+  int px = static_cast<int>(x);
+  int py = static_cast<int>(y);
+  return self->worker->Post(
+      [device, px, py, down] { return device->SendClick(px, py, down); },
+      report_injection_result);
+}
+
+static FlMethodResponse* send_keys(
+    FlKeypressSimulatorLinuxPlugin* self,
+    const KeyTransition* transitions,
+    size_t count,
+    InjectionWorker::TimePoint origin = InjectionWorker::TimePoint()) {
+  if (!post_keys(self, transitions, count, origin)) {
+    return queue_full_response();
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+// Reads the optional originMicros argument: a Dart `Timeline.now` timestamp.
+static InjectionWorker::TimePoint read_origin(FlValue* args) {
+  FlValue* origin = fl_value_lookup_string(args, "originMicros");
+  if (origin == nullptr || fl_value_get_type(origin) != FL_VALUE_TYPE_INT) {
+    return InjectionWorker::TimePoint();
+  }
+  return keypress_simulator_core::LatencyOriginFromMicros(
+      fl_value_get_int(origin));
+}
+
+static FlMethodResponse* simulate_key_press(
+    FlKeypressSimulatorLinuxPlugin* self,
+    FlValue* args) {
+  KeyBatchBuilder batch(kModifierEvdevKeys);
+  if (!add_chord_from_args(args, &batch)) {
+    return invalid_argument_response("Missing or unsupported physicalKey");
+  }
+  return send_keys(self, batch.transitions().data(), batch.size());
+}
+
+static FlMethodResponse* simulate_key_sequence(
+    FlKeypressSimulatorLinuxPlugin* self,
+    FlValue* args) {
+  FlValue* steps = fl_value_lookup_string(args, "steps");
+  if (steps == nullptr || fl_value_get_type(steps) != FL_VALUE_TYPE_LIST) {
+    return invalid_argument_response("steps is required");
+  }
+
+  // Validate the whole sequence before injecting any of it, so a bad step
+  // cannot leave keys held down.
+  KeyBatchBuilder batch(kModifierEvdevKeys);
+  for (size_t i = 0; i < fl_value_get_length(steps); i++) {
+    if (!add_chord_from_args(fl_value_get_list_value(steps, i), &batch)) {
+      return invalid_argument_response("Missing or unsupported physicalKey");
+    }
+  }
+  return send_keys(self, batch.transitions().data(), batch.size(),
+                   read_origin(args));
+}
+
+// Replaces the registered actions with {actions: [{id, physicalKey,
+// modifiers}]}. The old table stays in place if any entry is invalid.
+static FlMethodResponse* register_keymap(FlKeypressSimulatorLinuxPlugin* self,
+                                         FlValue* args) {
+  FlValue* actions = fl_value_lookup_string(args, "actions");
+  if (actions == nullptr || fl_value_get_type(actions) != FL_VALUE_TYPE_LIST) {
+    return invalid_argument_response("actions is required");
+  }
+
+  ActionTable<KeyTransition> table;
+  for (size_t i = 0; i < fl_value_get_length(actions); i++) {
+    FlValue* action = fl_value_get_list_value(actions, i);
+    uint8_t modifiers = keypress_simulator_core::kModifierNone;
+    uint16_t code = 0;
+    ChordPhase phase = ChordPhase::kTap;
+    if (!parse_chord(action, &modifiers, &code, &phase)) {
+      return invalid_argument_response("Missing or unsupported physicalKey");
+    }
+    FlValue* id_value = fl_value_lookup_string(action, "id");
+    if (id_value == nullptr ||
+        fl_value_get_type(id_value) != FL_VALUE_TYPE_INT ||
+        fl_value_get_int(id_value) < 0 ||
+        !table.SetChord(static_cast<ActionId>(fl_value_get_int(id_value)),
+                        modifiers, code, kModifierEvdevKeys,
+                        identity_transition)) {
+      return invalid_argument_response("Every action needs a valid id");
+    }
+  }
+  *self->actions = std::move(table);
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+// Injects a registered action. |args| is the integer built by
+// keypress_simulator_core::EncodeActionCall(), or an Int64List of that
+// integer and the `Timeline.now` timestamp the action originated at.
+static FlMethodResponse* simulate_action(FlKeypressSimulatorLinuxPlugin* self,
+                                         FlValue* args) {
+  int64_t call = -1;
+  InjectionWorker::TimePoint origin;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_INT) {
+    call = fl_value_get_int(args);
+  } else if (args != nullptr &&
+             fl_value_get_type(args) == FL_VALUE_TYPE_INT64_LIST &&
+             fl_value_get_length(args) == 2) {
+    const int64_t* values = fl_value_get_int64_list(args);
+    call = values[0];
+    origin = keypress_simulator_core::LatencyOriginFromMicros(values[1]);
+  }
+  ActionId id = 0;
+  ChordPhase phase = ChordPhase::kTap;
+  if (!keypress_simulator_core::DecodeActionCall(call, &id, &phase)) {
+    return invalid_argument_response("Expected an encoded action");
+  }
+  if (!self->actions->Contains(id)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNKNOWN_ACTION", "The action was not registered", nullptr));
+  }
+  auto range = self->actions->Get(id, phase);
+  return send_keys(self, range.data, range.size, origin);
+}
+
+// Serves ks_key() and ks_click() from the same action table and worker as
+// the method channel. Called with FfiBridgeMutex() held.
+class LinuxFfiBackend : public FfiBackend {
+ public:
+  explicit LinuxFfiBackend(FlKeypressSimulatorLinuxPlugin* plugin)
+      : plugin_(plugin) {}
+
+  int32_t Key(ActionId id, ChordPhase phase, TimePoint origin) override {
+    if (!plugin_->device->is_open()) {
+      return KS_ERROR_UNAVAILABLE;
+    }
+    if (!plugin_->actions->Contains(id)) {
+      return KS_ERROR_UNKNOWN_ACTION;
+    }
+    auto range = plugin_->actions->Get(id, phase);
+    return post_keys(plugin_, range.data, range.size, origin)
+               ? KS_OK
+               : KS_ERROR_QUEUE_FULL;
+  }
+
+  int32_t Click(double x, double y, bool down) override {
+    if (!plugin_->device->is_open()) {
+      return KS_ERROR_UNAVAILABLE;
+    }
+    return post_click(plugin_, x, y, down) ? KS_OK : KS_ERROR_QUEUE_FULL;
+  }
+
+ private:
+  FlKeypressSimulatorLinuxPlugin* plugin_;
+};
+
+// Reads the action ID argument of startRepeat and stopRepeat.
+static bool read_action_id(FlValue* args, ActionId* id) {
+  FlValue* id_value = fl_value_lookup_string(args, "actionId");
+  if (id_value == nullptr ||
+      fl_value_get_type(id_value) != FL_VALUE_TYPE_INT ||
+      fl_value_get_int(id_value) < 0 ||
+      fl_value_get_int(id_value) >= keypress_simulator_core::kMaxActionId) {
+    return false;
+  }
+  *id = static_cast<ActionId>(fl_value_get_int(id_value));
+  return true;
+}
+
+static FlMethodResponse* start_repeat(FlKeypressSimulatorLinuxPlugin* self,
+                                      FlValue* args) {
+  ActionId id = 0;
+  if (!read_action_id(args, &id)) {
+    return invalid_argument_response("actionId is required");
+  }
+  if (!self->actions->Contains(id)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNKNOWN_ACTION", "The action was not registered", nullptr));
+  }
+  FlValue* delay_value = fl_value_lookup_string(args, "initialDelayMs");
+  FlValue* interval_value = fl_value_lookup_string(args, "intervalMs");
+  if (delay_value == nullptr ||
+      fl_value_get_type(delay_value) != FL_VALUE_TYPE_INT ||
+      interval_value == nullptr ||
+      fl_value_get_type(interval_value) != FL_VALUE_TYPE_INT) {
+    return invalid_argument_response(
+        "initialDelayMs and intervalMs are required");
+  }
+  std::chrono::milliseconds initial_delay(fl_value_get_int(delay_value));
+  std::chrono::milliseconds interval(fl_value_get_int(interval_value));
+  if (!keypress_simulator_core::IsValidRepeatTiming(initial_delay, interval)) {
+    return invalid_argument_response("Repeat timing is out of range");
+  }
+
+  // Copied for the same reason as in send_keys().
+  auto range = self->actions->Get(id, ChordPhase::kTap);
+  UinputDevice* device = self->device;
+  X11KeyTarget* x11_target = self->x11_target;
+  std::vector<KeyTransition> batch(range.data, range.data + range.size);
+  bool posted = self->worker->StartRepeat(
+      id, initial_delay, interval,
+      [device, x11_target, batch = std::move(batch)] {
+        return inject_keys(device, x11_target, batch);
+      },
+      report_injection_result);
+  if (!posted) {
+    return queue_full_response();
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+static FlMethodResponse* stop_repeat(FlKeypressSimulatorLinuxPlugin* self,
+                                     FlValue* args) {
+  // Not checked against the action table: the repeat keeps running with the
+  // keys it was started with even if the keymap was replaced since.
+  ActionId id = 0;
+  if (!read_action_id(args, &id)) {
+    return invalid_argument_response("actionId is required");
+  }
+  if (!self->worker->StopRepeat(id)) {
+    return queue_full_response();
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+static FlMethodResponse* simulate_mouse_click(
+    FlKeypressSimulatorLinuxPlugin* self,
+    FlValue* args) {
+  FlValue* key_down_value = fl_value_lookup_string(args, "keyDown");
+  if (key_down_value == nullptr ||
+      fl_value_get_type(key_down_value) != FL_VALUE_TYPE_BOOL) {
+    return invalid_argument_response("keyDown is required");
+  }
+  // A missing coordinate is 0, one of another type a mistake.
+  double x = 0;
+  double y = 0;
+  FlValue* x_value = fl_value_lookup_string(args, "x");
+  FlValue* y_value = fl_value_lookup_string(args, "y");
+  if ((x_value != nullptr &&
+       fl_value_get_type(x_value) != FL_VALUE_TYPE_FLOAT) ||
+      (y_value != nullptr &&
+       fl_value_get_type(y_value) != FL_VALUE_TYPE_FLOAT)) {
+    return invalid_argument_response("x and y must be doubles");
+  }
+  if (x_value != nullptr) {
+    x = fl_value_get_float(x_value);
+  }
+  if (y_value != nullptr) {
+    y = fl_value_get_float(y_value);
+  }
+
+  if (!post_click(self, x, y, fl_value_get_bool(key_down_value))) {
+    return queue_full_response();
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_bool(true)));
+}
+
+// Feeds the samples of a drag to the virtual pointer.
+class UinputPointerSink : public PointerSink {
+ public:
+  explicit UinputPointerSink(UinputDevice* device) : device_(device) {}
+
+  bool Move(const PointF& point) override {
+    return device_->MovePointer(static_cast<int>(point.x),
+                                static_cast<int>(point.y));
+  }
+
+  bool Button(const PointF& point, bool down) override {
+    return device_->SendClick(static_cast<int>(point.x),
+                              static_cast<int>(point.y), down);
+  }
+
+ private:
+  UinputDevice* device_;
+};
+
+static FlMethodResponse* simulate_drag(FlKeypressSimulatorLinuxPlugin* self,
+                                       FlValue* args) {
+  FlValue* path_value = fl_value_lookup_string(args, "path");
+  FlValue* duration_value = fl_value_lookup_string(args, "durationMs");
+  FlValue* easing_value = fl_value_lookup_string(args, "easing");
+  if (path_value == nullptr ||
+      fl_value_get_type(path_value) != FL_VALUE_TYPE_FLOAT_LIST ||
+      duration_value == nullptr ||
+      fl_value_get_type(duration_value) != FL_VALUE_TYPE_INT ||
+      easing_value == nullptr ||
+      fl_value_get_type(easing_value) != FL_VALUE_TYPE_STRING) {
+    return invalid_argument_response(
+        "path, durationMs and easing are required");
+  }
+
+  DragGesture gesture;
+  const char* error = keypress_simulator_core::BuildDragGesture(
+      fl_value_get_float_list(path_value), fl_value_get_length(path_value),
+      fl_value_get_int(duration_value), fl_value_get_string(easing_value),
+      &gesture);
+  if (error != nullptr) {
+    return invalid_argument_response(error);
+  }
+
+  // The worker sleeps between samples, so later injections queue up behind
+  // the drag instead of interleaving with it.
+  UinputDevice* device = self->device;
+  return post_injection(self, [device, gesture = std::move(gesture)] {
+    UinputPointerSink sink(device);
+    SteadyDragClock clock;
+    return keypress_simulator_core::PerformDrag(gesture, &sink, &clock);
+  });
+}
+
+static FlMethodResponse* simulate_media_key(
+    FlKeypressSimulatorLinuxPlugin* self,
+    FlValue* args) {
+  FlValue* key_value = fl_value_lookup_string(args, "key");
+  if (key_value == nullptr ||
+      fl_value_get_type(key_value) != FL_VALUE_TYPE_STRING) {
+    return invalid_argument_response("key is required");
+  }
+  uint16_t code = keypress_simulator_core::EvdevKeyForMediaKey(
+      fl_value_get_string(key_value));
+  if (code == 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNSUPPORTED_KEY", "Unsupported media key identifier", nullptr));
+  }
+
+  UinputDevice* device = self->device;
+  return post_injection(self, [device, code] { return device->TapKey(code); });
+}
+
+// Returns {stage: {count, p50Us, p99Us, maxUs}} for every latency stage of
+// the injection worker. With {reset: true} the histograms start over
+// afterwards.
+static FlMethodResponse* get_latency_stats(FlKeypressSimulatorLinuxPlugin* self,
+                                           FlValue* args) {
+  keypress_simulator_core::LatencyRecorder& latency = self->worker->latency();
+  g_autoptr(FlValue) stats = fl_value_new_map();
+  for (size_t i = 0; i < keypress_simulator_core::kLatencyStageCount; i++) {
+    LatencyStage stage = static_cast<LatencyStage>(i);
+    LatencySummary summary = latency.Summarize(stage);
+    FlValue* value = fl_value_new_map();
+    fl_value_set_string_take(value, "count", fl_value_new_int(summary.count));
+    fl_value_set_string_take(value, "p50Us", fl_value_new_int(summary.p50));
+    fl_value_set_string_take(value, "p99Us", fl_value_new_int(summary.p99));
+    fl_value_set_string_take(value, "maxUs", fl_value_new_int(summary.max));
+    fl_value_set_string_take(
+        stats, keypress_simulator_core::LatencyStageName(stage), value);
+  }
+
+  FlValue* reset = args != nullptr &&
+                           fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                       ? fl_value_lookup_string(args, "reset")
+                       : nullptr;
+  if (reset != nullptr && fl_value_get_type(reset) == FL_VALUE_TYPE_BOOL &&
+      fl_value_get_bool(reset)) {
+    latency.Reset();
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+}
+
+// Sends {app, pid, running} to the trainer app listener.
+static void send_trainer_app_event(FlKeypressSimulatorLinuxPlugin* self,
+                                   const ProcessWatcher::Change& change) {
+  if (self->trainer_app_channel == nullptr) {
+    return;
+  }
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "app",
+                           fl_value_new_string(change.app.c_str()));
+  fl_value_set_string_take(event, "pid", fl_value_new_int(change.pid));
+  fl_value_set_string_take(event, "running",
+                           fl_value_new_bool(change.running));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(self->trainer_app_channel, event, nullptr,
+                             &error)) {
+    g_warning("Failed to send trainer app event: %s", error->message);
+  }
+}
+
+// A change on its way from the watcher thread to the main loop.
+struct TrainerAppDelivery {
+  // Holds a reference.
+  FlKeypressSimulatorLinuxPlugin* plugin;
+  ProcessWatcher::Change change;
+};
+
+static gboolean deliver_trainer_app_event(gpointer user_data) {
+  auto* delivery = static_cast<TrainerAppDelivery*>(user_data);
+  send_trainer_app_event(delivery->plugin, delivery->change);
+  return G_SOURCE_REMOVE;
+}
+
+static void free_trainer_app_delivery(gpointer user_data) {
+  auto* delivery = static_cast<TrainerAppDelivery*>(user_data);
+  g_object_unref(delivery->plugin);
+  delete delivery;
+}
+
+// Called on the watcher thread.
+static void post_trainer_app_event(FlKeypressSimulatorLinuxPlugin* self,
+                                   const ProcessWatcher::Change& change) {
+  auto* delivery = new TrainerAppDelivery{
+      FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(g_object_ref(self)), change};
+  g_idle_add_full(G_PRIORITY_DEFAULT, deliver_trainer_app_event, delivery,
+                  free_trainer_app_delivery);
+}
+
+// Starts watching when Dart subscribes, and brings the new listener up to
+// date with the apps that are already running.
+static FlMethodErrorResponse* trainer_app_listen_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  FlKeypressSimulatorLinuxPlugin* self =
+      FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(user_data);
+  if (!self->process_watcher->Start()) {
+    return fl_method_error_response_new(
+        "WATCH_UNAVAILABLE", "Could not watch for trainer apps", nullptr);
+  }
+  for (const ProcessWatcher::Change& change :
+       self->process_watcher->RunningApps()) {
+    send_trainer_app_event(self, change);
+  }
+  return nullptr;
+}
+
+static FlMethodErrorResponse* trainer_app_cancel_cb(FlEventChannel* channel,
+                                                    FlValue* args,
+                                                    gpointer user_data) {
+  FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(user_data)->process_watcher->Stop();
+  return nullptr;
+}
+
+// Answers |method|. Called with FfiBridgeMutex() held.
+static FlMethodResponse* handle_method_call(
+    FlKeypressSimulatorLinuxPlugin* self,
+    const gchar* method,
+    FlValue* args) {
+  bool is_injection = strcmp(method, kSimulateKeyPress) == 0 ||
+                      strcmp(method, kSimulateKeySequence) == 0 ||
+                      strcmp(method, kSimulateMouseClick) == 0 ||
+                      strcmp(method, kSimulateDrag) == 0 ||
+                      strcmp(method, kSimulateMediaKey) == 0 ||
+                      strcmp(method, kStartRepeat) == 0 ||
+                      strcmp(method, kStopRepeat) == 0;
+  bool has_map_args =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+  if (strcmp(method, kSimulateAction) == 0) {
+    // The hot path: its argument is a bare integer rather than a map.
+    return self->device->is_open() ? simulate_action(self, args)
+                                   : device_unavailable_response();
+  }
+  if (is_injection && !self->device->is_open()) {
+    return device_unavailable_response();
+  }
+  if ((is_injection || strcmp(method, kRegisterKeymap) == 0) &&
+      !has_map_args) {
+    return invalid_argument_response("Expected a map of arguments");
+  }
+  if (strcmp(method, kRegisterKeymap) == 0) {
+    return register_keymap(self, args);
+  }
+  if (strcmp(method, kSimulateKeyPress) == 0) {
+    return simulate_key_press(self, args);
+  }
+  if (strcmp(method, kSimulateKeySequence) == 0) {
+    return simulate_key_sequence(self, args);
+  }
+  if (strcmp(method, kSimulateMouseClick) == 0) {
+    return simulate_mouse_click(self, args);
+  }
+  if (strcmp(method, kSimulateDrag) == 0) {
+    return simulate_drag(self, args);
+  }
+  if (strcmp(method, kSimulateMediaKey) == 0) {
+    return simulate_media_key(self, args);
+  }
+  if (strcmp(method, kStartRepeat) == 0) {
+    return start_repeat(self, args);
+  }
+  if (strcmp(method, kStopRepeat) == 0) {
+    return stop_repeat(self, args);
+  }
+  if (strcmp(method, kGetLatencyStats) == 0) {
+    return get_latency_stats(self, args);
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+// Called when a method call is received from Flutter.
+static void method_call_cb(FlMethodChannel* channel,
+                           FlMethodCall* method_call,
+                           gpointer user_data) {
+  FlKeypressSimulatorLinuxPlugin* self =
+      FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  {
+    // The ks_* functions use the action table and the worker from the Dart
+    // UI thread.
+    std::lock_guard<std::mutex> lock(
+        keypress_simulator_core::FfiBridgeMutex());
+    response = handle_method_call(self, method, args);
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to send method call response: %s", error->message);
+  }
+}
+
+static void fl_keypress_simulator_linux_plugin_dispose(GObject* object) {
+  FlKeypressSimulatorLinuxPlugin* self =
+      FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(object);
+
+  // Joins the watcher thread; events it already queued find no channel.
+  delete self->process_watcher;
+  self->process_watcher = nullptr;
+  g_clear_object(&self->trainer_app_channel);
+  // No new input may arrive through FFI once the worker is gone.
+  keypress_simulator_core::UninstallFfiBackend(self->ffi_backend);
+  delete self->ffi_backend;
+  self->ffi_backend = nullptr;
+  // Stop the worker first: queued tasks still write to the device.
+  delete self->worker;
+  self->worker = nullptr;
+  delete self->x11_target;
+  self->x11_target = nullptr;
+  delete self->device;
+  self->device = nullptr;
+  delete self->actions;
+  self->actions = nullptr;
+  g_clear_object(&self->channel);
+  g_clear_object(&self->registrar);
+
+  G_OBJECT_CLASS(fl_keypress_simulator_linux_plugin_parent_class)
+      ->dispose(object);
+}
+
+static void fl_keypress_simulator_linux_plugin_class_init(
+    FlKeypressSimulatorLinuxPluginClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = fl_keypress_simulator_linux_plugin_dispose;
+}
+
+FlKeypressSimulatorLinuxPlugin* fl_keypress_simulator_linux_plugin_new(
+    FlPluginRegistrar* registrar) {
+  FlKeypressSimulatorLinuxPlugin* self = FL_KEYPRESS_SIMULATOR_LINUX_PLUGIN(
+      g_object_new(fl_keypress_simulator_linux_plugin_get_type(), nullptr));
+
+  self->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+
+  int width = 0;
+  int height = 0;
+  get_desktop_size(&width, &height);
+  if (!self->device->Create(width, height)) {
+    g_warning("keypress_simulator: failed to create %s device",
+              UinputDevice::kDevicePath);
+  }
+  // Without an X server (a pure Wayland session) every key goes through
+  // uinput to the focused window.
+  if (!self->x11_target->Open()) {
+    g_debug("keypress_simulator: no X display, background input disabled");
+  }
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb,
+                                            g_object_ref(self), g_object_unref);
+  self->trainer_app_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar), kTrainerAppChannelName,
+      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(
+      self->trainer_app_channel, trainer_app_listen_cb, trainer_app_cancel_cb,
+      g_object_ref(self), g_object_unref);
+  keypress_simulator_core::InstallFfiBackend(self->ffi_backend);
+
+  return self;
+}
+
+static void fl_keypress_simulator_linux_plugin_init(
+    FlKeypressSimulatorLinuxPlugin* self) {
+  self->device = new UinputDevice();
+  self->x11_target = new X11KeyTarget(kCompatibleApps);
+  self->actions = new ActionTable<KeyTransition>();
+  self->worker = new InjectionWorker();
+  self->ffi_backend = new LinuxFfiBackend(self);
+  self->process_watcher = new ProcessWatcher(
+      kCompatibleApps, [self](const ProcessWatcher::Change& change) {
+        post_trainer_app_event(self, change);
+      });
+}
+
+void keypress_simulator_linux_plugin_register_with_registrar(
+    FlPluginRegistrar* registrar) {
+  FlKeypressSimulatorLinuxPlugin* plugin =
+      fl_keypress_simulator_linux_plugin_new(registrar);
+  g_object_unref(plugin);
+}
@@ -1,4 +1,8 @@
 library keypress_simulator_platform_interface;
 
+export 'src/drag_easing.dart';
+export 'src/key_sequence_step.dart';
 export 'src/keypress_simulator_method_channel.dart';
 export 'src/keypress_simulator_platform_interface.dart';
+export 'src/latency_stats.dart';
+export 'src/trainer_app_event.dart';
@@ -0,0 +1,10 @@
+/// Speed profile of a drag sent with
+/// [KeyPressSimulatorPlatform.simulateDrag].
+///
+/// The names are sent to the platform as they are.
+enum DragEasing {
+  linear,
+  easeIn,
+  easeOut,
+  easeInOut,
+}
@@ -0,0 +1,21 @@
+import 'package:flutter/services.dart';
+
+/// One chord of a key sequence sent with
+/// [KeyPressSimulatorPlatform.simulateKeySequence].
+class KeySequenceStep {
+  const KeySequenceStep(
+    this.key, {
+    this.modifiers = const [],
+    this.keyDown,
+  });
+
+  final KeyboardKey key;
+
+  /// Modifiers held around [key]. They are pressed before the key and
+  /// released after it.
+  final List<ModifierKey> modifiers;
+
+  /// `true` only presses the chord, `false` only releases it and `null`
+  /// presses and releases it.
+  final bool? keyDown;
+}
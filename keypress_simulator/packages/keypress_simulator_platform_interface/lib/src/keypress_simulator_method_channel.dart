@@ -1,6 +1,12 @@
+import 'dart:async';
+
 import 'package:flutter/services.dart';
 import 'package:flutter/widgets.dart';
+import 'package:keypress_simulator_platform_interface/src/drag_easing.dart';
+import 'package:keypress_simulator_platform_interface/src/key_sequence_step.dart';
 import 'package:keypress_simulator_platform_interface/src/keypress_simulator_platform_interface.dart';
+import 'package:keypress_simulator_platform_interface/src/latency_stats.dart';
+import 'package:keypress_simulator_platform_interface/src/trainer_app_event.dart';
 import 'package:uni_platform/uni_platform.dart';
 
 /// An implementation of [KeyPressSimulatorPlatform] that uses method channels.
@@ -11,6 +17,22 @@ class MethodChannelKeyPressSimulator extends KeyPressSimulatorPlatform {
     'dev.leanflutter.plugins/keypress_simulator',
   );
 
+  /// The event channel trainer app launches and exits arrive on.
+  @visibleForTesting
+  final trainerAppChannel = const EventChannel(
+    'dev.leanflutter.plugins/keypress_simulator/trainer_apps',
+  );
+
+  /// Actions passed to the last [registerKeymap] call.
+  Map<int, KeySequenceStep> _actions = const {};
+
+  /// Whether the platform compiled [_actions] into a native table. If not,
+  /// [simulateAction] falls back to [simulateKeySequence].
+  bool _hasNativeKeymap = false;
+
+  /// Repeats timed in Dart when there is no native keymap, by action ID.
+  final Map<int, Timer> _repeatTimers = {};
+
   @override
   Future<bool> isAccessAllowed() async {
     if (UniPlatform.isMacOS) {
@@ -37,6 +59,106 @@ class MethodChannelKeyPressSimulator extends KeyPressSimulatorPlatform {
     List<ModifierKey> modifiers = const [],
     bool keyDown = true,
   }) async {
+    final Map<Object?, Object?> arguments = _keyArguments(
+      key,
+      modifiers: modifiers,
+      keyDown: keyDown,
+    );
+    await methodChannel.invokeMethod('simulateKeyPress', arguments);
+  }
+
+  @override
+  Future<void> simulateKeySequence(List<KeySequenceStep> steps, {int? originMicros}) async {
+    final Map<String, Object?> arguments = {
+      'steps': steps
+          .map(
+            (step) => _keyArguments(
+              step.key,
+              modifiers: step.modifiers,
+              keyDown: step.keyDown,
+            ),
+          )
+          .toList(),
+      if (originMicros != null) 'originMicros': originMicros,
+    };
+    try {
+      await methodChannel.invokeMethod('simulateKeySequence', arguments);
+    } on MissingPluginException {
+      // Platforms without native sequence support get one call per
+      // transition.
+      for (final step in steps) {
+        if (step.keyDown != false) {
+          await simulateKeyPress(
+            key: step.key,
+            modifiers: step.modifiers,
+            keyDown: true,
+          );
+        }
+        if (step.keyDown != true) {
+          await simulateKeyPress(
+            key: step.key,
+            modifiers: step.modifiers,
+            keyDown: false,
+          );
+        }
+      }
+    }
+  }
+
+  @override
+  Future<void> registerKeymap(Map<int, KeySequenceStep> actions) async {
+    _actions = Map.unmodifiable(actions);
+    _hasNativeKeymap = false;
+    final Map<String, Object?> arguments = {
+      'actions': actions.entries
+          .map(
+            (entry) => {
+              'id': entry.key,
+              ..._keyArguments(
+                entry.value.key,
+                modifiers: entry.value.modifiers,
+                keyDown: null,
+              ),
+            },
+          )
+          .toList(),
+    };
+    try {
+      await methodChannel.invokeMethod('registerKeymap', arguments);
+      _hasNativeKeymap = true;
+    } on MissingPluginException {
+      // Served from [_actions] by simulateAction.
+    }
+  }
+
+  @override
+  Future<void> simulateAction(int actionId, {bool? keyDown, int? originMicros}) async {
+    if (_hasNativeKeymap) {
+      // A single integer: the action ID with the phase (0 down, 1 up, 2 tap)
+      // in the two low bits. Must match EncodeActionCall() in the native
+      // core. With an origin, an Int64List of that integer and the origin.
+      final phase = keyDown == null ? 2 : (keyDown ? 0 : 1);
+      final encoded = actionId << 2 | phase;
+      await methodChannel.invokeMethod(
+        'simulateAction',
+        originMicros == null ? encoded : Int64List.fromList([encoded, originMicros]),
+      );
+      return;
+    }
+    final action = _actions[actionId];
+    if (action == null) {
+      throw ArgumentError.value(actionId, 'actionId', 'Not registered');
+    }
+    await simulateKeySequence([
+      KeySequenceStep(action.key, modifiers: action.modifiers, keyDown: keyDown),
+    ], originMicros: originMicros);
+  }
+
+  Map<Object?, Object?> _keyArguments(
+    KeyboardKey? key, {
+    required List<ModifierKey> modifiers,
+    required bool? keyDown,
+  }) {
     PhysicalKeyboardKey? physicalKey = key is PhysicalKeyboardKey ? key : null;
     if (key is LogicalKeyboardKey) {
       physicalKey = key.physicalKey;
@@ -44,12 +166,44 @@ class MethodChannelKeyPressSimulator extends KeyPressSimulatorPlatform {
     if (key != null && physicalKey == null) {
       throw UnsupportedError('Unsupported key: $key.');
     }
-    final Map<Object?, Object?> arguments = {
+    return {
       'keyCode': physicalKey?.keyCode,
+      'physicalKey': physicalKey?.usbHidUsage,
       'modifiers': modifiers.map((e) => e.name).toList(),
       'keyDown': keyDown,
     }..removeWhere((key, value) => value == null);
-    await methodChannel.invokeMethod('simulateKeyPress', arguments);
+  }
+
+  @override
+  Future<void> startRepeat(
+    int actionId, {
+    required Duration initialDelay,
+    required Duration interval,
+  }) async {
+    if (_hasNativeKeymap) {
+      await methodChannel.invokeMethod('startRepeat', {
+        'actionId': actionId,
+        'initialDelayMs': initialDelay.inMilliseconds,
+        'intervalMs': interval.inMilliseconds,
+      });
+      return;
+    }
+    if (!_actions.containsKey(actionId)) {
+      throw ArgumentError.value(actionId, 'actionId', 'Not registered');
+    }
+    _repeatTimers.remove(actionId)?.cancel();
+    _repeatTimers[actionId] = Timer(initialDelay, () {
+      simulateAction(actionId);
+      _repeatTimers[actionId] = Timer.periodic(interval, (_) => simulateAction(actionId));
+    });
+  }
+
+  @override
+  Future<void> stopRepeat(int actionId) async {
+    _repeatTimers.remove(actionId)?.cancel();
+    if (_hasNativeKeymap) {
+      await methodChannel.invokeMethod('stopRepeat', {'actionId': actionId});
+    }
   }
 
   @override
@@ -62,6 +216,55 @@ class MethodChannelKeyPressSimulator extends KeyPressSimulatorPlatform {
     await methodChannel.invokeMethod('simulateMouseClick', arguments);
   }
 
+  @override
+  Future<void> simulateDrag(
+    List<Offset> path, {
+    required Duration duration,
+    required DragEasing easing,
+  }) async {
+    if (path.isEmpty) {
+      throw ArgumentError.value(path, 'path', 'must not be empty');
+    }
+    final coordinates = Float64List(path.length * 2);
+    for (var i = 0; i < path.length; i++) {
+      coordinates[i * 2] = path[i].dx;
+      coordinates[i * 2 + 1] = path[i].dy;
+    }
+    try {
+      await methodChannel.invokeMethod('simulateDrag', {
+        'path': coordinates,
+        'durationMs': duration.inMilliseconds,
+        'easing': easing.name,
+      });
+    } on MissingPluginException {
+      // Platforms without native drags get a press and a release at the ends.
+      await simulateMouseClick(path.first, keyDown: true);
+      await Future<void>.delayed(duration);
+      await simulateMouseClick(path.last, keyDown: false);
+    }
+  }
+
+  @override
+  Future<List<Offset>> mapPoints(List<Offset> points) async {
+    final coordinates = Float64List(points.length * 2);
+    for (var i = 0; i < points.length; i++) {
+      coordinates[i * 2] = points[i].dx;
+      coordinates[i * 2 + 1] = points[i].dy;
+    }
+    try {
+      final Float64List? mapped = await methodChannel.invokeMethod<Float64List>('mapPoints', {
+        'points': coordinates,
+      });
+      if (mapped == null) return points;
+      return [
+        for (var i = 0; i + 1 < mapped.length; i += 2) Offset(mapped[i], mapped[i + 1]),
+      ];
+    } on MissingPluginException {
+      // Platforms that click at the position as given.
+      return points;
+    }
+  }
+
   @override
   Future<void> simulateMediaKey(PhysicalKeyboardKey mediaKey) async {
     // Map PhysicalKeyboardKey to string identifier since keyCode is null for media keys
@@ -84,4 +287,31 @@ class MethodChannelKeyPressSimulator extends KeyPressSimulatorPlatform {
     };
     await methodChannel.invokeMethod('simulateMediaKey', arguments);
   }
+
+  @override
+  Future<Map<String, LatencyStats>> getLatencyStats({bool reset = false}) async {
+    try {
+      final Map<Object?, Object?>? stats = await methodChannel.invokeMapMethod<Object?, Object?>(
+        'getLatencyStats',
+        {'reset': reset},
+      );
+      return {
+        for (final entry in (stats ?? const {}).entries)
+          entry.key as String: LatencyStats.fromMap(entry.value as Map<Object?, Object?>),
+      };
+    } on MissingPluginException {
+      // Platforms that do not measure injection latency.
+      return const {};
+    }
+  }
+
+  @override
+  Stream<TrainerAppEvent> get trainerAppEvents {
+    if (!UniPlatform.isLinux) {
+      return const Stream.empty();
+    }
+    return trainerAppChannel
+        .receiveBroadcastStream()
+        .map((event) => TrainerAppEvent.fromMap(event as Map<Object?, Object?>));
+  }
 }
@@ -1,5 +1,9 @@
 import 'package:flutter/services.dart';
+import 'package:keypress_simulator_platform_interface/src/drag_easing.dart';
+import 'package:keypress_simulator_platform_interface/src/key_sequence_step.dart';
 import 'package:keypress_simulator_platform_interface/src/keypress_simulator_method_channel.dart';
+import 'package:keypress_simulator_platform_interface/src/latency_stats.dart';
+import 'package:keypress_simulator_platform_interface/src/trainer_app_event.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 abstract class KeyPressSimulatorPlatform extends PlatformInterface {
@@ -41,11 +45,82 @@ abstract class KeyPressSimulatorPlatform extends PlatformInterface {
     throw UnimplementedError('simulateKeyPress() has not been implemented.');
   }
 
+  /// Simulates all [steps] in order with a single platform call, so no other
+  /// input can interleave between them.
+  ///
+  /// [originMicros] is the `Timeline.now` timestamp of the input that caused
+  /// the keys, e.g. a BLE notification. It is only used by [getLatencyStats].
+  Future<void> simulateKeySequence(List<KeySequenceStep> steps, {int? originMicros}) {
+    throw UnimplementedError('simulateKeySequence() has not been implemented.');
+  }
+
+  /// Uploads the chords of the active keymap once, keyed by action ID, so
+  /// that [simulateAction] only has to send the ID. Replaces any previously
+  /// registered actions.
+  Future<void> registerKeymap(Map<int, KeySequenceStep> actions) {
+    throw UnimplementedError('registerKeymap() has not been implemented.');
+  }
+
+  /// Simulates an action registered with [registerKeymap]. `true` only
+  /// presses the chord, `false` only releases it and `null` does both.
+  /// [originMicros] is as for [simulateKeySequence].
+  Future<void> simulateAction(int actionId, {bool? keyDown, int? originMicros}) {
+    throw UnimplementedError('simulateAction() has not been implemented.');
+  }
+
+  /// Taps the action registered as [actionId] after [initialDelay] and then
+  /// every [interval] until [stopRepeat] is called. The repeats are timed
+  /// natively, so they stay evenly spaced while the UI is busy.
+  Future<void> startRepeat(
+    int actionId, {
+    required Duration initialDelay,
+    required Duration interval,
+  }) {
+    throw UnimplementedError('startRepeat() has not been implemented.');
+  }
+
+  Future<void> stopRepeat(int actionId) {
+    throw UnimplementedError('stopRepeat() has not been implemented.');
+  }
+
   Future<void> simulateMouseClick(Offset position, {required bool keyDown}) {
     throw UnimplementedError('simulateMouseClick() has not been implemented.');
   }
 
+  /// Presses at the first point of [path], moves along it over [duration]
+  /// and releases at its last point. The pointer is interpolated natively at
+  /// a steady rate, so the drag does not depend on the Dart event loop.
+  Future<void> simulateDrag(
+    List<Offset> path, {
+    required Duration duration,
+    required DragEasing easing,
+  }) {
+    throw UnimplementedError('simulateDrag() has not been implemented.');
+  }
+
+  /// Maps positions as passed to [simulateMouseClick] to the screen
+  /// coordinates the clicks would land on, in one platform call.
+  Future<List<Offset>> mapPoints(List<Offset> points) {
+    throw UnimplementedError('mapPoints() has not been implemented.');
+  }
+
   Future<void> simulateMediaKey(PhysicalKeyboardKey mediaKey) {
     throw UnimplementedError('simulateMediaKey() has not been implemented.');
   }
+
+  /// Returns the latency of injected input by stage: `dispatch` (origin to
+  /// the platform queueing it), `queue`, `inject` and `total`. The origin
+  /// stages only count calls that passed `originMicros`. With [reset] the
+  /// statistics start over afterwards.
+  Future<Map<String, LatencyStats>> getLatencyStats({bool reset = false}) {
+    throw UnimplementedError('getLatencyStats() has not been implemented.');
+  }
+
+  /// Reports trainer apps starting and exiting. A new listener first gets a
+  /// `running` event for every app that is already running. Events may
+  /// repeat, so keep the running apps in a set. Empty on platforms that do
+  /// not watch processes.
+  Stream<TrainerAppEvent> get trainerAppEvents {
+    throw UnimplementedError('trainerAppEvents has not been implemented.');
+  }
 }
@@ -0,0 +1,41 @@
+/// Latency of one stage of input injection, as measured natively and
+/// returned by [KeyPressSimulatorPlatform.getLatencyStats].
+///
+/// Percentiles come from a log-linear histogram and are accurate to about
+/// 6%.
+class LatencyStats {
+  const LatencyStats({
+    required this.count,
+    required this.p50,
+    required this.p99,
+    required this.max,
+  });
+
+  /// Reads the `{count, p50Us, p99Us, maxUs}` map sent by the platform.
+  factory LatencyStats.fromMap(Map<Object?, Object?> map) {
+    Duration micros(String key) => Duration(microseconds: (map[key] as int?) ?? 0);
+    return LatencyStats(
+      count: (map['count'] as int?) ?? 0,
+      p50: micros('p50Us'),
+      p99: micros('p99Us'),
+      max: micros('maxUs'),
+    );
+  }
+
+  /// Number of events recorded.
+  final int count;
+  final Duration p50;
+  final Duration p99;
+  final Duration max;
+
+  @override
+  bool operator ==(Object other) =>
+      other is LatencyStats && other.count == count && other.p50 == p50 && other.p99 == p99 && other.max == max;
+
+  @override
+  int get hashCode => Object.hash(count, p50, p99, max);
+
+  @override
+  String toString() =>
+      'LatencyStats(count: $count, p50: ${p50.inMicroseconds}us, p99: ${p99.inMicroseconds}us, max: ${max.inMicroseconds}us)';
+}
@@ -0,0 +1,36 @@
+/// A trainer app started or stopped running, as reported by
+/// [KeyPressSimulatorPlatform.trainerAppEvents].
+class TrainerAppEvent {
+  const TrainerAppEvent({
+    required this.app,
+    required this.pid,
+    required this.running,
+  });
+
+  /// Reads the `{app, pid, running}` map sent by the platform.
+  factory TrainerAppEvent.fromMap(Map<Object?, Object?> map) {
+    return TrainerAppEvent(
+      app: map['app'] as String,
+      pid: (map['pid'] as int?) ?? 0,
+      running: (map['running'] as bool?) ?? false,
+    );
+  }
+
+  /// Executable name of the app, e.g. `MyWhoosh.exe`.
+  final String app;
+
+  /// The process that started the app or was the last one to exit.
+  final int pid;
+
+  final bool running;
+
+  @override
+  bool operator ==(Object other) =>
+      other is TrainerAppEvent && other.app == app && other.pid == pid && other.running == running;
+
+  @override
+  int get hashCode => Object.hash(app, pid, running);
+
+  @override
+  String toString() => 'TrainerAppEvent(app: $app, pid: $pid, running: $running)';
+}
@@ -1,6 +1,11 @@
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
+import 'package:keypress_simulator_platform_interface/src/drag_easing.dart';
+import 'package:keypress_simulator_platform_interface/src/key_sequence_step.dart';
 import 'package:keypress_simulator_platform_interface/src/keypress_simulator_method_channel.dart';
+import 'package:keypress_simulator_platform_interface/src/latency_stats.dart';
+import 'package:keypress_simulator_platform_interface/src/trainer_app_event.dart';
+import 'package:uni_platform/uni_platform.dart';
 
 void main() {
   TestWidgetsFlutterBinding.ensureInitialized();
@@ -10,12 +15,43 @@ void main() {
     'dev.leanflutter.plugins/keypress_simulator',
   );
 
+  final List<MethodCall> log = <MethodCall>[];
+  bool supportsSequence = true;
+  bool supportsKeymap = true;
+  bool supportsDrag = true;
+  bool supportsLatencyStats = true;
+
   setUp(() {
+    log.clear();
+    supportsSequence = true;
+    supportsKeymap = true;
+    supportsDrag = true;
+    supportsLatencyStats = true;
     TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
         .setMockMethodCallHandler(
       channel,
       (MethodCall methodCall) async {
+        log.add(methodCall);
         if (methodCall.method == 'isAccessAllowed') return true;
+        if (methodCall.method == 'mapPoints') {
+          final points = (methodCall.arguments as Map<Object?, Object?>)['points'] as Float64List;
+          return Float64List.fromList(points.map((value) => value * 2).toList());
+        }
+        if (methodCall.method == 'simulateKeySequence' && !supportsSequence) {
+          throw MissingPluginException();
+        }
+        if (methodCall.method == 'registerKeymap' && !supportsKeymap) {
+          throw MissingPluginException();
+        }
+        if (methodCall.method == 'simulateDrag' && !supportsDrag) {
+          throw MissingPluginException();
+        }
+        if (methodCall.method == 'getLatencyStats') {
+          if (!supportsLatencyStats) throw MissingPluginException();
+          return {
+            'total': {'count': 3, 'p50Us': 1200, 'p99Us': 4000, 'maxUs': 4100},
+          };
+        }
         return '42';
       },
     );
@@ -29,4 +65,216 @@ void main() {
   test('isAccessAllowed', () async {
     expect(await platform.isAccessAllowed(), true);
   });
+
+  test('simulateKeyPress sends the physical key id', () async {
+    await platform.simulateKeyPress(
+      key: PhysicalKeyboardKey.keyA,
+      modifiers: [ModifierKey.shiftModifier],
+    );
+    expect(log, hasLength(1));
+    final arguments = log.single.arguments as Map<Object?, Object?>;
+    expect(arguments['physicalKey'], PhysicalKeyboardKey.keyA.usbHidUsage);
+    expect(arguments['modifiers'], ['shiftModifier']);
+    expect(arguments['keyDown'], true);
+  });
+
+  test('simulateKeySequence sends all steps in one call', () async {
+    await platform.simulateKeySequence(const [
+      KeySequenceStep(
+        PhysicalKeyboardKey.keyR,
+        modifiers: [ModifierKey.controlModifier],
+      ),
+      KeySequenceStep(PhysicalKeyboardKey.keyS, keyDown: true),
+    ]);
+    expect(log.map((call) => call.method), ['simulateKeySequence']);
+    final arguments = log.single.arguments as Map<Object?, Object?>;
+    final steps = arguments['steps'] as List<Object?>;
+    expect(steps, hasLength(2));
+    final first = steps[0] as Map<Object?, Object?>;
+    expect(first['physicalKey'], PhysicalKeyboardKey.keyR.usbHidUsage);
+    expect(first['modifiers'], ['controlModifier']);
+    expect(first.containsKey('keyDown'), false);
+    expect((steps[1] as Map<Object?, Object?>)['keyDown'], true);
+  });
+
+  test('simulateKeySequence falls back to single key presses', () async {
+    supportsSequence = false;
+    await platform.simulateKeySequence(const [
+      KeySequenceStep(PhysicalKeyboardKey.keyR),
+    ]);
+    expect(log.map((call) => call.method), [
+      'simulateKeySequence',
+      'simulateKeyPress',
+      'simulateKeyPress',
+    ]);
+    expect((log[1].arguments as Map<Object?, Object?>)['keyDown'], true);
+    expect((log[2].arguments as Map<Object?, Object?>)['keyDown'], false);
+  });
+
+  test('simulateAction sends only the encoded action id', () async {
+    await platform.registerKeymap({
+      3: const KeySequenceStep(
+        PhysicalKeyboardKey.keyR,
+        modifiers: [ModifierKey.shiftModifier],
+      ),
+    });
+    final actions = (log.single.arguments as Map<Object?, Object?>)['actions'] as List<Object?>;
+    final action = actions.single as Map<Object?, Object?>;
+    expect(action['id'], 3);
+    expect(action['physicalKey'], PhysicalKeyboardKey.keyR.usbHidUsage);
+    expect(action['modifiers'], ['shiftModifier']);
+    expect(action.containsKey('keyDown'), false);
+
+    log.clear();
+    await platform.simulateAction(3, keyDown: true);
+    await platform.simulateAction(3, keyDown: false);
+    await platform.simulateAction(3);
+    expect(log.map((call) => call.method), everyElement('simulateAction'));
+    expect(log.map((call) => call.arguments), [3 << 2, 3 << 2 | 1, 3 << 2 | 2]);
+  });
+
+  test('simulateAction sends the origin alongside the action', () async {
+    await platform.registerKeymap({
+      3: const KeySequenceStep(PhysicalKeyboardKey.keyR),
+    });
+    log.clear();
+    await platform.simulateAction(3, keyDown: true, originMicros: 123456789);
+    expect(log.single.arguments, isA<Int64List>());
+    expect(log.single.arguments, [3 << 2, 123456789]);
+  });
+
+  test('simulateAction falls back to a key sequence', () async {
+    supportsKeymap = false;
+    await platform.registerKeymap({
+      0: const KeySequenceStep(PhysicalKeyboardKey.keyS),
+    });
+    log.clear();
+    await platform.simulateAction(0, keyDown: true);
+    expect(log.map((call) => call.method), ['simulateKeySequence']);
+    final steps = (log.single.arguments as Map<Object?, Object?>)['steps'] as List<Object?>;
+    final step = steps.single as Map<Object?, Object?>;
+    expect(step['physicalKey'], PhysicalKeyboardKey.keyS.usbHidUsage);
+    expect(step['keyDown'], true);
+    expect((log.single.arguments as Map<Object?, Object?>).containsKey('originMicros'), false);
+
+    log.clear();
+    await platform.simulateAction(0, originMicros: 42);
+    expect((log.single.arguments as Map<Object?, Object?>)['originMicros'], 42);
+
+    expect(() => platform.simulateAction(1), throwsArgumentError);
+  });
+
+  test('startRepeat and stopRepeat are timed natively', () async {
+    await platform.registerKeymap({
+      5: const KeySequenceStep(PhysicalKeyboardKey.keyK),
+    });
+    log.clear();
+    await platform.startRepeat(
+      5,
+      initialDelay: const Duration(milliseconds: 350),
+      interval: const Duration(milliseconds: 120),
+    );
+    await platform.stopRepeat(5);
+    expect(log.map((call) => call.method), ['startRepeat', 'stopRepeat']);
+    expect(log[0].arguments, {'actionId': 5, 'initialDelayMs': 350, 'intervalMs': 120});
+    expect(log[1].arguments, {'actionId': 5});
+  });
+
+  test('startRepeat falls back to Dart timers', () async {
+    supportsKeymap = false;
+    await platform.registerKeymap({
+      0: const KeySequenceStep(PhysicalKeyboardKey.keyS),
+    });
+    log.clear();
+    await platform.startRepeat(
+      0,
+      initialDelay: Duration.zero,
+      interval: const Duration(milliseconds: 10),
+    );
+    await Future<void>.delayed(const Duration(milliseconds: 45));
+    await platform.stopRepeat(0);
+    final repeats = log.length;
+    expect(repeats, greaterThanOrEqualTo(2));
+    expect(log.map((call) => call.method), everyElement('simulateKeySequence'));
+
+    await Future<void>.delayed(const Duration(milliseconds: 30));
+    expect(log, hasLength(repeats));
+    expect(
+      () => platform.startRepeat(1, initialDelay: Duration.zero, interval: const Duration(seconds: 1)),
+      throwsArgumentError,
+    );
+  });
+
+  test('mapPoints sends all points in one call', () async {
+    final mapped = await platform.mapPoints(const [Offset(1, 2), Offset(3.5, 4)]);
+    expect(log, hasLength(1));
+    final arguments = log.single.arguments as Map<Object?, Object?>;
+    expect(arguments['points'], [1, 2, 3.5, 4]);
+    expect(mapped, const [Offset(2, 4), Offset(7, 8)]);
+  });
+
+  test('simulateDrag sends the path in one call', () async {
+    await platform.simulateDrag(
+      const [Offset(10, 20), Offset(30, 40), Offset(50, 60)],
+      duration: const Duration(milliseconds: 300),
+      easing: DragEasing.easeOut,
+    );
+    expect(log, hasLength(1));
+    expect(log.single.method, 'simulateDrag');
+    final arguments = log.single.arguments as Map<Object?, Object?>;
+    expect(arguments['path'], [10, 20, 30, 40, 50, 60]);
+    expect(arguments['durationMs'], 300);
+    expect(arguments['easing'], 'easeOut');
+  });
+
+  test('simulateDrag falls back to press and release', () async {
+    supportsDrag = false;
+    await platform.simulateDrag(
+      const [Offset(10, 20), Offset(50, 60)],
+      duration: Duration.zero,
+      easing: DragEasing.linear,
+    );
+    expect(log.map((call) => call.method), ['simulateDrag', 'simulateMouseClick', 'simulateMouseClick']);
+    expect(log[1].arguments, {'x': 10.0, 'y': 20.0, 'keyDown': true});
+    expect(log[2].arguments, {'x': 50.0, 'y': 60.0, 'keyDown': false});
+  });
+
+  test('getLatencyStats decodes every stage', () async {
+    final stats = await platform.getLatencyStats(reset: true);
+    expect(log.single.arguments, {'reset': true});
+    expect(stats, {
+      'total': const LatencyStats(
+        count: 3,
+        p50: Duration(microseconds: 1200),
+        p99: Duration(microseconds: 4000),
+        max: Duration(microseconds: 4100),
+      ),
+    });
+  });
+
+  test('getLatencyStats is empty without native support', () async {
+    supportsLatencyStats = false;
+    expect(await platform.getLatencyStats(), isEmpty);
+  });
+
+  test('trainerAppEvents decodes launches and exits', () async {
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+      platform.trainerAppChannel,
+      MockStreamHandler.inline(
+        onListen: (arguments, events) {
+          events.success({'app': 'MyWhoosh.exe', 'pid': 4242, 'running': true});
+          events.success({'app': 'MyWhoosh.exe', 'pid': 4242, 'running': false});
+          events.endOfStream();
+        },
+      ),
+    );
+    addTearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockStreamHandler(platform.trainerAppChannel, null);
+    });
+    expect(await platform.trainerAppEvents.toList(), [
+      const TrainerAppEvent(app: 'MyWhoosh.exe', pid: 4242, running: true),
+      const TrainerAppEvent(app: 'MyWhoosh.exe', pid: 4242, running: false),
+    ]);
+  }, skip: !UniPlatform.isLinux);
 }
@@ -11,27 +11,306 @@
 #include <flutter/standard_method_codec.h>
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <sstream>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 
+#include "keypress_simulator_core/key_table.h"
+#include "keypress_simulator_core/latency_stats.h"
+
 using flutter::EncodableList;
 using flutter::EncodableMap;
 using flutter::EncodableValue;
+using keypress_simulator_core::ActionId;
+using keypress_simulator_core::ActionTable;
+using keypress_simulator_core::ChordPhase;
+using keypress_simulator_core::DragClock;
+using keypress_simulator_core::DragGesture;
+using keypress_simulator_core::InjectionWorker;
+using keypress_simulator_core::KeyBatchBuilder;
+using keypress_simulator_core::KeyCodes;
+using keypress_simulator_core::KeyTransition;
+using keypress_simulator_core::LatencyStage;
+using keypress_simulator_core::LatencySummary;
+using keypress_simulator_core::ModifierKeyCodes;
+using keypress_simulator_core::Monitor;
+using keypress_simulator_core::MonitorLayout;
+using keypress_simulator_core::PointerSink;
+using keypress_simulator_core::PointF;
 
 namespace keypress_simulator_windows {
 
-// Forward declarations
-struct FindWindowData {
-  std::string targetProcessName;
-  std::string targetWindowTitle;
-  HWND foundWindow;
+namespace {
+
+// List of compatible training apps to look for
+const std::vector<std::string> kCompatibleApps = {
+    "MyWhooshHD.exe", "MyWhoosh.exe", "indieVelo.exe", "biketerra.exe",
+    "Rouvy.exe"};
+
+// Virtual-key codes for keypress_simulator_core::kModifierOrder.
+const ModifierKeyCodes kModifierVirtualKeys = {VK_SHIFT, VK_CONTROL, VK_MENU,
+                                               VK_LWIN};
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// Sleeps on a high-resolution waitable timer. Sleep() rounds up to the
+// 15.6 ms system tick, which would halve the rate of a drag; the timer keeps
+// the 8 ms interval on Windows 10 1803 and later. Older systems fall back to
+// std::this_thread::sleep_until().
+class WaitableTimerDragClock : public DragClock {
+ public:
+  WaitableTimerDragClock()
+      : timer_(CreateWaitableTimerExW(nullptr, nullptr,
+                                      CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                      TIMER_ALL_ACCESS)) {}
+
+  ~WaitableTimerDragClock() override {
+    if (timer_ != nullptr) {
+      CloseHandle(timer_);
+    }
+  }
+
+  TimePoint Now() override { return std::chrono::steady_clock::now(); }
+
+  void SleepUntil(TimePoint deadline) override {
+    auto remaining = deadline - Now();
+    if (remaining <= TimePoint::duration::zero()) {
+      return;
+    }
+    if (timer_ == nullptr) {
+      std::this_thread::sleep_until(deadline);
+      return;
+    }
+    // Negative due times are relative, in 100 ns units.
+    LARGE_INTEGER due_time;
+    due_time.QuadPart = -std::max<LONGLONG>(
+        1, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                   .count() /
+               100);
+    if (SetWaitableTimer(timer_, &due_time, 0, nullptr, nullptr, FALSE)) {
+      WaitForSingleObject(timer_, INFINITE);
+    } else {
+      std::this_thread::sleep_until(deadline);
+    }
+  }
+
+ private:
+  HANDLE timer_;
+};
+
+// Moves the cursor along a drag whose points are already in physical pixels.
+class CursorPointerSink : public PointerSink {
+ public:
+  bool Move(const PointF& point) override {
+    return SetCursorPos(static_cast<int>(point.x),
+                        static_cast<int>(point.y)) != 0;
+  }
+
+  bool Button(const PointF& point, bool down) override {
+    if (!Move(point)) {
+      return false;
+    }
+    INPUT input = {0};
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+    return SendInput(1, &input, sizeof(INPUT)) == 1;
+  }
 };
 
-BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam);
-HWND FindTargetWindow(const std::string& processName,
-                      const std::string& windowTitle);
+// Reads the action ID argument of startRepeat and stopRepeat.
+bool ReadActionId(const EncodableMap& args, ActionId* id) {
+  auto it = args.find(EncodableValue("actionId"));
+  if (it == args.end()) {
+    return false;
+  }
+  const int* value = std::get_if<int>(&it->second);
+  if (value == nullptr || *value < 0 ||
+      static_cast<ActionId>(*value) >= keypress_simulator_core::kMaxActionId) {
+    return false;
+  }
+  *id = static_cast<ActionId>(*value);
+  return true;
+}
+
+// Reads the optional originMicros argument: a Dart `Timeline.now` timestamp.
+InjectionWorker::TimePoint ReadOrigin(const EncodableMap& args) {
+  auto it = args.find(EncodableValue("originMicros"));
+  if (it == args.end()) {
+    return InjectionWorker::TimePoint();
+  }
+  // The codec sends integers that fit in 32 bits as int.
+  if (const int64_t* micros = std::get_if<int64_t>(&it->second)) {
+    return keypress_simulator_core::LatencyOriginFromMicros(*micros);
+  }
+  if (const int* micros = std::get_if<int>(&it->second)) {
+    return keypress_simulator_core::LatencyOriginFromMicros(*micros);
+  }
+  return InjectionWorker::TimePoint();
+}
+
+PreparedKey PrepareKey(const KeyTransition& transition) {
+  PreparedKey key;
+  key.virtual_key = transition.code;
+  const KeyCodes* codes =
+      keypress_simulator_core::KeyCodesForVirtualKey(transition.code);
+  if (codes != nullptr) {
+    key.scan_code = codes->windows_scan;
+    key.extended = codes->windows_extended;
+  } else {
+    // Keys outside the shared table (OEM and IME keys) keep asking the
+    // active layout.
+    key.scan_code =
+        static_cast<WORD>(MapVirtualKey(transition.code, MAPVK_VK_TO_VSC));
+    key.extended = false;
+  }
+  key.down = transition.down;
+  return key;
+}
+
+std::vector<PreparedKey> PrepareKeys(
+    const std::vector<KeyTransition>& transitions) {
+  std::vector<PreparedKey> keys;
+  keys.reserve(transitions.size());
+  for (const KeyTransition& transition : transitions) {
+    keys.push_back(PrepareKey(transition));
+  }
+  return keys;
+}
+
+void PostKeyMessage(HWND hwnd, const PreparedKey& key) {
+  // Build lParam with repeat count 1 and scan code; set transition states for
+  // key up
+  LPARAM lParam = 1 | (static_cast<LPARAM>(key.scan_code) << 16);
+  if (key.extended) {
+    lParam |= (1 << 24);  // extended key
+  }
+  if (!key.down) {
+    lParam |= (1 << 30);  // previous key state
+    lParam |= (1 << 31);  // transition state
+  }
+  PostMessage(hwnd, key.down ? WM_KEYDOWN : WM_KEYUP, key.virtual_key, lParam);
+}
+
+INPUT MakeKeyboardInput(const PreparedKey& key) {
+  INPUT in = {0};
+  in.type = INPUT_KEYBOARD;
+  in.ki.wVk = 0;  // when using SCANCODE, set VK=0
+  in.ki.wScan = key.scan_code;
+  in.ki.dwFlags = KEYEVENTF_SCANCODE | (key.down ? 0 : KEYEVENTF_KEYUP);
+  if (key.extended) {
+    in.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+  }
+  return in;
+}
+
+// Parses a simulateKeyPress-style argument map ({keyCode, modifiers,
+// keyDown}). Without keyDown the key is pressed and released. Returns false
+// if keyCode is missing.
+bool ParseChord(const EncodableMap& args,
+                uint8_t* modifiers_out,
+                uint16_t* code_out,
+                ChordPhase* phase_out) {
+  auto key_code_it = args.find(EncodableValue("keyCode"));
+  if (key_code_it == args.end() ||
+      !std::holds_alternative<int>(key_code_it->second)) {
+    return false;
+  }
+
+  uint8_t modifiers = keypress_simulator_core::kModifierNone;
+  auto modifiers_it = args.find(EncodableValue("modifiers"));
+  if (modifiers_it != args.end()) {
+    if (const auto* list = std::get_if<EncodableList>(&modifiers_it->second)) {
+      for (const EncodableValue& value : *list) {
+        if (const auto* name = std::get_if<std::string>(&value)) {
+          modifiers = static_cast<uint8_t>(
+              modifiers | keypress_simulator_core::ModifierFromName(*name));
+        }
+      }
+    }
+  }
+
+  ChordPhase phase = ChordPhase::kTap;
+  auto key_down_it = args.find(EncodableValue("keyDown"));
+  if (key_down_it != args.end()) {
+    if (const bool* key_down = std::get_if<bool>(&key_down_it->second)) {
+      phase = *key_down ? ChordPhase::kDown : ChordPhase::kUp;
+    }
+  }
+
+  *modifiers_out = modifiers;
+  *code_out = static_cast<uint16_t>(std::get<int>(key_code_it->second));
+  *phase_out = phase;
+  return true;
+}
+
+// Appends the chord described by a simulateKeyPress-style argument map.
+bool AddChordFromArguments(const EncodableMap& args, KeyBatchBuilder* batch) {
+  uint8_t modifiers = keypress_simulator_core::kModifierNone;
+  uint16_t code = 0;
+  ChordPhase phase = ChordPhase::kTap;
+  if (!ParseChord(args, &modifiers, &code, &phase)) {
+    return false;
+  }
+  batch->AddChord(modifiers, code, phase);
+  return true;
+}
+
+// Injection runs on the worker after the method call has already returned,
+// so failures can only be logged.
+void ReportInjectionResult(bool succeeded) {
+  if (!succeeded) {
+    OutputDebugStringA("keypress_simulator: failed to inject input\n");
+  }
+}
+
+// The plugin whose resolver receives WinEvent notifications. WinEvent hooks
+// have no user data, and there is only one plugin instance per engine.
+keypress_simulator_core::TargetWindowResolver* g_hooked_resolver = nullptr;
+
+void CALLBACK WindowEventProc(HWINEVENTHOOK hook,
+                              DWORD event,
+                              HWND hwnd,
+                              LONG idObject,
+                              LONG idChild,
+                              DWORD idEventThread,
+                              DWORD dwmsEventTime) {
+  if (g_hooked_resolver == nullptr || hwnd == NULL ||
+      idObject != OBJID_WINDOW || idChild != CHILDID_SELF) {
+    return;
+  }
+  auto window = reinterpret_cast<keypress_simulator_core::WindowHandle>(hwnd);
+  switch (event) {
+    case EVENT_OBJECT_DESTROY:
+      g_hooked_resolver->OnWindowDestroyed(window);
+      break;
+    case EVENT_OBJECT_HIDE:
+    case EVENT_SYSTEM_MINIMIZESTART:
+      g_hooked_resolver->OnWindowHidden(window);
+      break;
+    case EVENT_OBJECT_CREATE:
+    case EVENT_OBJECT_SHOW:
+    case EVENT_SYSTEM_MINIMIZEEND:
+      // Only top-level windows can be a target.
+      if (GetAncestor(hwnd, GA_ROOT) == hwnd) {
+        g_hooked_resolver->OnWindowShown(window);
+      }
+      break;
+  }
+}
+
+BOOL CALLBACK AddMonitor(HMONITOR monitor, HDC hdc, LPRECT rect, LPARAM data) {
+  auto* monitors = reinterpret_cast<std::vector<Monitor>*>(data);
+  UINT dpi = FlutterDesktopGetDpiForMonitor(monitor);
+  monitors->push_back(
+      {rect->left, rect->top, rect->right, rect->bottom, dpi / 96.0});
+  return TRUE;
+}
+
+}  // namespace
 
 // static
 void KeypressSimulatorWindowsPlugin::RegisterWithRegistrar(
@@ -41,7 +320,7 @@ void KeypressSimulatorWindowsPlugin::RegisterWithRegistrar(
           registrar->messenger(), "dev.leanflutter.plugins/keypress_simulator",
           &flutter::StandardMethodCodec::GetInstance());
 
-  auto plugin = std::make_unique<KeypressSimulatorWindowsPlugin>();
+  auto plugin = std::make_unique<KeypressSimulatorWindowsPlugin>(registrar);
 
   channel->SetMethodCallHandler(
       [plugin_pointer = plugin.get()](const auto& call, auto result) {
@@ -51,171 +330,337 @@ void KeypressSimulatorWindowsPlugin::RegisterWithRegistrar(
   registrar->AddPlugin(std::move(plugin));
 }
 
-KeypressSimulatorWindowsPlugin::KeypressSimulatorWindowsPlugin() {}
+KeypressSimulatorWindowsPlugin::KeypressSimulatorWindowsPlugin(
+    flutter::PluginRegistrarWindows* registrar)
+    : registrar_(registrar),
+      window_resolver_(&window_enumerator_, kCompatibleApps) {
+  InstallWindowHooks();
+  if (registrar_ != nullptr) {
+    window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+        [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+          return HandleWindowProc(hwnd, message, wparam, lparam);
+        });
+  }
+}
 
-KeypressSimulatorWindowsPlugin::~KeypressSimulatorWindowsPlugin() {}
+KeypressSimulatorWindowsPlugin::~KeypressSimulatorWindowsPlugin() {
+  if (registrar_ != nullptr) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+  }
+  UninstallWindowHooks();
+}
 
-void KeypressSimulatorWindowsPlugin::SimulateKeyPress(
+std::optional<LRESULT> KeypressSimulatorWindowsPlugin::HandleWindowProc(
+    HWND hwnd,
+    UINT message,
+    WPARAM wparam,
+    LPARAM lparam) {
+  switch (message) {
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+    case WM_SETTINGCHANGE:
+      monitor_layout_stale_ = true;
+      break;
+  }
+  return std::nullopt;
+}
+
+const MonitorLayout& KeypressSimulatorWindowsPlugin::GetMonitorLayout() {
+  if (monitor_layout_stale_ || registrar_ == nullptr) {
+    std::vector<Monitor> monitors;
+    EnumDisplayMonitors(NULL, NULL, AddMonitor,
+                        reinterpret_cast<LPARAM>(&monitors));
+    monitor_layout_ = MonitorLayout(std::move(monitors));
+    monitor_layout_stale_ = false;
+  }
+  return monitor_layout_;
+}
+
+void KeypressSimulatorWindowsPlugin::InstallWindowHooks() {
+  if (g_hooked_resolver != nullptr) {
+    return;
+  }
+  // EVENT_OBJECT_CREATE..EVENT_OBJECT_HIDE covers create, destroy, show and
+  // hide. Out-of-context hooks are delivered through this thread's message
+  // loop, so the resolver is only ever touched from the platform thread.
+  object_event_hook_ = SetWinEventHook(
+      EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE, NULL, WindowEventProc, 0, 0,
+      WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  minimize_event_hook_ = SetWinEventHook(
+      EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND, NULL,
+      WindowEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  if (object_event_hook_ != nullptr && minimize_event_hook_ != nullptr) {
+    g_hooked_resolver = &window_resolver_;
+  } else {
+    // Without notifications the cache could go stale; fall back to rescanning
+    // on every lookup.
+    UninstallWindowHooks();
+  }
+}
+
+void KeypressSimulatorWindowsPlugin::UninstallWindowHooks() {
+  if (object_event_hook_ != nullptr) {
+    UnhookWinEvent(object_event_hook_);
+    object_event_hook_ = nullptr;
+  }
+  if (minimize_event_hook_ != nullptr) {
+    UnhookWinEvent(minimize_event_hook_);
+    minimize_event_hook_ = nullptr;
+  }
+  if (g_hooked_resolver == &window_resolver_) {
+    g_hooked_resolver = nullptr;
+  }
+}
+
+void KeypressSimulatorWindowsPlugin::RegisterKeymap(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
 
-  UINT keyCode = std::get<int>(args.at(EncodableValue("keyCode")));
-  std::vector<std::string> modifiers;
-  bool keyDown = std::get<bool>(args.at(EncodableValue("keyDown")));
+  const EncodableList* actions = nullptr;
+  auto actions_it = args.find(EncodableValue("actions"));
+  if (actions_it != args.end()) {
+    actions = std::get_if<EncodableList>(&actions_it->second);
+  }
+  if (actions == nullptr) {
+    result->Error("INVALID_ARGUMENT", "actions argument is required");
+    return;
+  }
 
-  EncodableList key_modifier_list =
-      std::get<EncodableList>(args.at(EncodableValue("modifiers")));
-  for (flutter::EncodableValue key_modifier_value : key_modifier_list) {
-    std::string key_modifier = std::get<std::string>(key_modifier_value);
-    modifiers.push_back(key_modifier);
+  // Scan codes and extended-key flags are looked up here, once per keymap,
+  // instead of on every press. The old table stays in place if any entry is
+  // invalid.
+  ActionTable<PreparedKey> table;
+  for (const EncodableValue& action : *actions) {
+    const EncodableMap* action_args = std::get_if<EncodableMap>(&action);
+    uint8_t modifiers = keypress_simulator_core::kModifierNone;
+    uint16_t code = 0;
+    ChordPhase phase = ChordPhase::kTap;
+    if (action_args == nullptr ||
+        !ParseChord(*action_args, &modifiers, &code, &phase)) {
+      result->Error("INVALID_ARGUMENT", "Every action needs a keyCode");
+      return;
+    }
+    auto id_it = action_args->find(EncodableValue("id"));
+    const int* id = id_it == action_args->end()
+                        ? nullptr
+                        : std::get_if<int>(&id_it->second);
+    if (id == nullptr || *id < 0 ||
+        !table.SetChord(static_cast<ActionId>(*id), modifiers, code,
+                        kModifierVirtualKeys, PrepareKey)) {
+      result->Error("INVALID_ARGUMENT", "Every action needs a valid id");
+      return;
+    }
   }
+  actions_ = std::move(table);
 
-  // List of compatible training apps to look for
-  std::vector<std::string> compatibleApps = {"MyWhooshHD.exe", "MyWhoosh.exe",
-                                             "indieVelo.exe", "biketerra.exe",
-                                             "Rouvy.exe"};
+  result->Success(flutter::EncodableValue(true));
+}
 
-  // Try to find and focus (or directly target) a compatible app
-  std::string foundProcessName;
-  bool supportsBackgroundInput = true;
-  HWND targetWindow = NULL;
-  for (const std::string& processName : compatibleApps) {
-    targetWindow = FindTargetWindow(processName, "");
-    if (targetWindow != NULL) {
-      foundProcessName = processName;
-      if (!supportsBackgroundInput && GetForegroundWindow() != targetWindow) {
-        SetForegroundWindow(targetWindow);
-        Sleep(50);  // Brief delay to ensure window is focused
-      }
-      break;
+void KeypressSimulatorWindowsPlugin::SimulateAction(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // The argument is the integer built by
+  // keypress_simulator_core::EncodeActionCall(), or an Int64List of that
+  // integer and the `Timeline.now` timestamp the action originated at.
+  int64_t encoded = -1;
+  InjectionWorker::TimePoint origin;
+  if (const int* value = std::get_if<int>(method_call.arguments())) {
+    encoded = *value;
+  } else if (const auto* values = std::get_if<std::vector<int64_t>>(
+                 method_call.arguments())) {
+    if (values->size() == 2) {
+      encoded = (*values)[0];
+      origin = keypress_simulator_core::LatencyOriginFromMicros((*values)[1]);
     }
   }
+  ActionId id = 0;
+  ChordPhase phase = ChordPhase::kTap;
+  if (!keypress_simulator_core::DecodeActionCall(encoded, &id, &phase)) {
+    result->Error("INVALID_ARGUMENT", "Expected an encoded action");
+    return;
+  }
+  if (!actions_.Contains(id)) {
+    result->Error("UNKNOWN_ACTION", "The action was not registered");
+    return;
+  }
+  auto keys = actions_.Get(id, phase);
+  if (!InjectKeys(keys.data, keys.size, origin)) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
 
-  // If we found a target window that supports background input and it's not
-  // focused, send messages directly
-  auto postKeyMessage = [](HWND hwnd, UINT vkCode, bool down) {
-    const WORD scanCode =
-        static_cast<WORD>(MapVirtualKey(vkCode, MAPVK_VK_TO_VSC));
-    // Build lParam with repeat count 1 and scan code; set transition states for
-    // key up
-    LPARAM lParam = 1 | (static_cast<LPARAM>(scanCode) << 16);
-    if (vkCode == VK_LEFT || vkCode == VK_RIGHT || vkCode == VK_UP ||
-        vkCode == VK_DOWN || vkCode == VK_INSERT || vkCode == VK_DELETE ||
-        vkCode == VK_HOME || vkCode == VK_END || vkCode == VK_PRIOR ||
-        vkCode == VK_NEXT) {
-      lParam |= (1 << 24);  // extended key
-    }
-    if (!down) {
-      lParam |= (1 << 30);  // previous key state
-      lParam |= (1 << 31);  // transition state
-    }
-    PostMessage(hwnd, down ? WM_KEYDOWN : WM_KEYUP, vkCode, lParam);
-  };
+  result->Success(flutter::EncodableValue(true));
+}
 
-  auto sendKeyToWindow = [&postKeyMessage](HWND hwnd,
-                                           const std::vector<std::string>& mods,
-                                           UINT keyCode, bool down) {
-    auto handleModifier = [&postKeyMessage, hwnd](UINT vk, bool press) {
-      postKeyMessage(hwnd, vk, press);
-    };
-
-    if (down) {
-      for (const std::string& modifier : mods) {
-        if (modifier == "shiftModifier") {
-          handleModifier(VK_SHIFT, true);
-        } else if (modifier == "controlModifier") {
-          handleModifier(VK_CONTROL, true);
-        } else if (modifier == "altModifier") {
-          handleModifier(VK_MENU, true);
-        } else if (modifier == "metaModifier") {
-          handleModifier(VK_LWIN, true);
-        }
-      }
-      postKeyMessage(hwnd, keyCode, true);
-    } else {
-      postKeyMessage(hwnd, keyCode, false);
-      // release modifiers
-      for (const std::string& modifier : mods) {
-        if (modifier == "shiftModifier") {
-          handleModifier(VK_SHIFT, false);
-        } else if (modifier == "controlModifier") {
-          handleModifier(VK_CONTROL, false);
-        } else if (modifier == "altModifier") {
-          handleModifier(VK_MENU, false);
-        } else if (modifier == "metaModifier") {
-          handleModifier(VK_LWIN, false);
-        }
-      }
-    }
-  };
+void KeypressSimulatorWindowsPlugin::StartRepeat(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
 
-  if (targetWindow != NULL && !foundProcessName.empty() &&
-      supportsBackgroundInput && GetForegroundWindow() != targetWindow) {
-    sendKeyToWindow(targetWindow, modifiers, keyCode, keyDown);
-    result->Success(flutter::EncodableValue(true));
+  ActionId id = 0;
+  const int* initial_delay_ms = nullptr;
+  const int* interval_ms = nullptr;
+  auto delay_it = args.find(EncodableValue("initialDelayMs"));
+  if (delay_it != args.end()) {
+    initial_delay_ms = std::get_if<int>(&delay_it->second);
+  }
+  auto interval_it = args.find(EncodableValue("intervalMs"));
+  if (interval_it != args.end()) {
+    interval_ms = std::get_if<int>(&interval_it->second);
+  }
+  if (!ReadActionId(args, &id) || initial_delay_ms == nullptr ||
+      interval_ms == nullptr) {
+    result->Error("INVALID_ARGUMENT",
+                  "actionId, initialDelayMs and intervalMs are required");
+    return;
+  }
+  std::chrono::milliseconds initial_delay(*initial_delay_ms);
+  std::chrono::milliseconds interval(*interval_ms);
+  if (!keypress_simulator_core::IsValidRepeatTiming(initial_delay, interval)) {
+    result->Error("INVALID_ARGUMENT", "Repeat timing is out of range");
+    return;
+  }
+  if (!actions_.Contains(id)) {
+    result->Error("UNKNOWN_ACTION", "The action was not registered");
     return;
   }
 
-  // Helper function to send modifier key events
-  auto sendModifierKey = [](UINT vkCode, bool down) {
-    WORD sc = (WORD)MapVirtualKey(vkCode, MAPVK_VK_TO_VSC);
-    INPUT in = {0};
-    in.type = INPUT_KEYBOARD;
-    in.ki.wVk = 0;
-    in.ki.wScan = sc;
-    in.ki.dwFlags = KEYEVENTF_SCANCODE | (down ? 0 : KEYEVENTF_KEYUP);
-    SendInput(1, &in, sizeof(INPUT));
-  };
+  // The target window is resolved once for the whole hold.
+  auto keys = actions_.Get(id, ChordPhase::kTap);
+  if (!worker_.StartRepeat(id, initial_delay, interval,
+                           MakeInjectionTask(keys.data, keys.size),
+                           ReportInjectionResult)) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
 
-  // Helper function to process modifiers
-  auto processModifiers = [&sendModifierKey](
-                              const std::vector<std::string>& mods, bool down) {
-    for (const std::string& modifier : mods) {
-      if (modifier == "shiftModifier") {
-        sendModifierKey(VK_SHIFT, down);
-      } else if (modifier == "controlModifier") {
-        sendModifierKey(VK_CONTROL, down);
-      } else if (modifier == "altModifier") {
-        sendModifierKey(VK_MENU, down);
-      } else if (modifier == "metaModifier") {
-        sendModifierKey(VK_LWIN, down);
-      }
-    }
-  };
+  result->Success(flutter::EncodableValue(true));
+}
+
+void KeypressSimulatorWindowsPlugin::StopRepeat(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
 
-  // Press modifier keys first (if keyDown)
-  if (keyDown) {
-    processModifiers(modifiers, true);
+  // Not checked against |actions_|: the repeat keeps running with the keys
+  // it was started with even if the keymap was replaced since.
+  ActionId id = 0;
+  if (!ReadActionId(args, &id)) {
+    result->Error("INVALID_ARGUMENT", "actionId is required");
+    return;
+  }
+  if (!worker_.StopRepeat(id)) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
   }
 
-  // Send the main key
-  WORD sc = (WORD)MapVirtualKey(keyCode, MAPVK_VK_TO_VSC);
+  result->Success(flutter::EncodableValue(true));
+}
 
-  INPUT in = {0};
-  in.type = INPUT_KEYBOARD;
-  in.ki.wVk = 0;  // when using SCANCODE, set VK=0
-  in.ki.wScan = sc;
-  in.ki.dwFlags = KEYEVENTF_SCANCODE | (keyDown ? 0 : KEYEVENTF_KEYUP);
-  if (keyCode == VK_LEFT || keyCode == VK_RIGHT || keyCode == VK_UP ||
-      keyCode == VK_DOWN || keyCode == VK_INSERT || keyCode == VK_DELETE ||
-      keyCode == VK_HOME || keyCode == VK_END || keyCode == VK_PRIOR ||
-      keyCode == VK_NEXT) {
-    in.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+void KeypressSimulatorWindowsPlugin::SimulateKeyPress(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
+
+  KeyBatchBuilder batch(kModifierVirtualKeys);
+  if (!AddChordFromArguments(args, &batch)) {
+    result->Error("INVALID_ARGUMENT", "keyCode argument is required");
+    return;
   }
-  SendInput(1, &in, sizeof(INPUT));
+  std::vector<PreparedKey> keys = PrepareKeys(batch.transitions());
+  if (!InjectKeys(keys.data(), keys.size())) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
+
+  result->Success(flutter::EncodableValue(true));
+}
 
-  // Release modifier keys (if keyUp)
-  if (!keyDown) {
-    processModifiers(modifiers, false);
+void KeypressSimulatorWindowsPlugin::SimulateKeySequence(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
+
+  const EncodableList* steps = nullptr;
+  auto steps_it = args.find(EncodableValue("steps"));
+  if (steps_it != args.end()) {
+    steps = std::get_if<EncodableList>(&steps_it->second);
+  }
+  if (steps == nullptr) {
+    result->Error("INVALID_ARGUMENT", "steps argument is required");
+    return;
   }
 
-  /*BYTE byteValue = static_cast<BYTE>(keyCode);
-  keybd_event(byteValue, 0x45, keyDown ? 0 : KEYEVENTF_KEYUP, 0);*/
+  // Validate the whole sequence before injecting any of it, so a bad step
+  // cannot leave keys held down.
+  KeyBatchBuilder batch(kModifierVirtualKeys);
+  for (const EncodableValue& step : *steps) {
+    const EncodableMap* step_args = std::get_if<EncodableMap>(&step);
+    if (step_args == nullptr || !AddChordFromArguments(*step_args, &batch)) {
+      result->Error("INVALID_ARGUMENT", "Every step needs a keyCode");
+      return;
+    }
+  }
+  std::vector<PreparedKey> keys = PrepareKeys(batch.transitions());
+  if (!InjectKeys(keys.data(), keys.size(), ReadOrigin(args))) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
 
   result->Success(flutter::EncodableValue(true));
 }
 
+bool KeypressSimulatorWindowsPlugin::InjectKeys(
+    const PreparedKey* keys,
+    size_t count,
+    InjectionWorker::TimePoint origin) {
+  if (count == 0) {
+    return true;
+  }
+  return worker_.Post(MakeInjectionTask(keys, count), ReportInjectionResult,
+                      origin);
+}
+
+InjectionWorker::Task KeypressSimulatorWindowsPlugin::MakeInjectionTask(
+    const PreparedKey* keys,
+    size_t count) {
+  // Find a compatible app here rather than on the worker: the resolver is
+  // also updated by WinEvent hooks, which run on the platform thread.
+  if (g_hooked_resolver != &window_resolver_) {
+    window_resolver_.Invalidate();
+  }
+  std::string foundProcessName;
+  HWND targetWindow =
+      reinterpret_cast<HWND>(window_resolver_.Resolve(&foundProcessName));
+  bool foundApp = targetWindow != NULL && !foundProcessName.empty();
+
+  // The keys may come from |actions_|, which a registerKeymap call can
+  // replace while they are still queued.
+  std::vector<PreparedKey> batch(keys, keys + count);
+  return [targetWindow, foundApp, batch = std::move(batch)] {
+    // If we found a target window and it's not focused, send messages
+    // directly; every supported trainer app takes background input.
+    if (foundApp && GetForegroundWindow() != targetWindow) {
+      for (const PreparedKey& key : batch) {
+        PostKeyMessage(targetWindow, key);
+      }
+      return true;
+    }
+
+    // Submit modifiers and keys in one call, so no other input can end
+    // up between them.
+    std::vector<INPUT> inputs;
+    inputs.reserve(batch.size());
+    for (const PreparedKey& key : batch) {
+      inputs.push_back(MakeKeyboardInput(key));
+    }
+    UINT sent = SendInput(static_cast<UINT>(inputs.size()), inputs.data(),
+                          sizeof(INPUT));
+    return sent == inputs.size();
+  };
+}
+
 void KeypressSimulatorWindowsPlugin::SimulateMouseClick(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -234,95 +679,117 @@ void KeypressSimulatorWindowsPlugin::SimulateMouseClick(
     y = std::get<double>(it_y->second);
   }
 
-  // Get the monitor containing the target point and its DPI
-  const POINT target_point = {static_cast<LONG>(x), static_cast<LONG>(y)};
-  HMONITOR monitor = MonitorFromPoint(target_point, MONITOR_DEFAULTTONEAREST);
-  UINT dpi = FlutterDesktopGetDpiForMonitor(monitor);
-  double scale_factor = dpi / 96.0;
+  // Scale the coordinates by the DPI of the monitor containing the point
+  double mapped_x = 0;
+  double mapped_y = 0;
+  GetMonitorLayout().MapPoint(x, y, &mapped_x, &mapped_y);
+  int scaled_x = static_cast<int>(mapped_x);
+  int scaled_y = static_cast<int>(mapped_y);
+
+  bool posted = worker_.Post(
+      [scaled_x, scaled_y, keyDown] {
+        // Move the mouse to the specified coordinates
+        SetCursorPos(scaled_x, scaled_y);
+
+        // Prepare input for mouse down and up
+        INPUT input = {0};
+        input.type = INPUT_MOUSE;
+        // Mouse left button down or up
+        input.mi.dwFlags = keyDown ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+        return SendInput(1, &input, sizeof(INPUT)) == 1;
+      },
+      ReportInjectionResult);
+  if (!posted) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
+
+  result->Success(flutter::EncodableValue(true));
+}
 
-  // Scale the coordinates according to the DPI scaling
-  int scaled_x = static_cast<int>(x * scale_factor);
-  int scaled_y = static_cast<int>(y * scale_factor);
+void KeypressSimulatorWindowsPlugin::SimulateDrag(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
 
-  // Move the mouse to the specified coordinates
-  SetCursorPos(scaled_x, scaled_y);
+  // Interleaved x and y coordinates, as a Float64List.
+  const std::vector<double>* path = nullptr;
+  const int* duration_ms = nullptr;
+  const std::string* easing = nullptr;
+  auto path_it = args.find(EncodableValue("path"));
+  if (path_it != args.end()) {
+    path = std::get_if<std::vector<double>>(&path_it->second);
+  }
+  auto duration_it = args.find(EncodableValue("durationMs"));
+  if (duration_it != args.end()) {
+    duration_ms = std::get_if<int>(&duration_it->second);
+  }
+  auto easing_it = args.find(EncodableValue("easing"));
+  if (easing_it != args.end()) {
+    easing = std::get_if<std::string>(&easing_it->second);
+  }
+  if (path == nullptr || duration_ms == nullptr || easing == nullptr) {
+    result->Error("INVALID_ARGUMENT",
+                  "path, durationMs and easing are required");
+    return;
+  }
 
-  // Prepare input for mouse down and up
-  INPUT input = {0};
-  input.type = INPUT_MOUSE;
+  DragGesture gesture;
+  const char* error = keypress_simulator_core::BuildDragGesture(
+      path->data(), path->size(), *duration_ms, *easing, &gesture);
+  if (error != nullptr) {
+    result->Error("INVALID_ARGUMENT", error);
+    return;
+  }
 
-  if (keyDown) {
-    // Mouse left button down
-    input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &input, sizeof(INPUT));
+  // Map to physical pixels here, on the platform thread that owns the
+  // monitor layout; the drag is interpolated between the mapped points.
+  const MonitorLayout& layout = GetMonitorLayout();
+  for (PointF& point : gesture.path) {
+    layout.MapPoint(point.x, point.y, &point.x, &point.y);
+  }
 
-  } else {
-    // Mouse left button up
-    input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &input, sizeof(INPUT));
+  // The worker sleeps between samples, so later injections queue up behind
+  // the drag instead of interleaving with it.
+  bool posted = worker_.Post(
+      [gesture = std::move(gesture)] {
+        CursorPointerSink sink;
+        WaitableTimerDragClock clock;
+        return keypress_simulator_core::PerformDrag(gesture, &sink, &clock);
+      },
+      ReportInjectionResult);
+  if (!posted) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
   }
 
   result->Success(flutter::EncodableValue(true));
 }
 
-BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam) {
-  FindWindowData* data = reinterpret_cast<FindWindowData*>(lParam);
-
-  // Check if window is visible and not minimized
-  if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) {
-    return TRUE;  // Continue enumeration
-  }
-
-  // Get window title
-  char windowTitle[256];
-  GetWindowTextA(hwnd, windowTitle, sizeof(windowTitle));
-
-  // Get process name
-  DWORD processId;
-  GetWindowThreadProcessId(hwnd, &processId);
-  HANDLE hProcess =
-      OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
-  char processName[MAX_PATH];
-  if (hProcess) {
-    DWORD size = sizeof(processName);
-    if (QueryFullProcessImageNameA(hProcess, 0, processName, &size)) {
-      // Extract just the filename from the full path
-      char* filename = strrchr(processName, '\\');
-      if (filename) {
-        filename++;  // Skip the backslash
-      } else {
-        filename = processName;
-      }
+void KeypressSimulatorWindowsPlugin::MapPoints(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const EncodableMap& args = std::get<EncodableMap>(*method_call.arguments());
 
-      // Check if this matches our target
-      if (!data->targetProcessName.empty() &&
-          _stricmp(filename, data->targetProcessName.c_str()) == 0) {
-        data->foundWindow = hwnd;
-        return FALSE;  // Stop enumeration
-      }
-    }
-    CloseHandle(hProcess);
+  // Interleaved x and y coordinates, as a Float64List.
+  const std::vector<double>* points = nullptr;
+  auto points_it = args.find(EncodableValue("points"));
+  if (points_it != args.end()) {
+    points = std::get_if<std::vector<double>>(&points_it->second);
   }
-
-  // Check window title if process name didn't match
-  if (!data->targetWindowTitle.empty() &&
-      _stricmp(windowTitle, data->targetWindowTitle.c_str()) == 0) {
-    data->foundWindow = hwnd;
-    return FALSE;  // Stop enumeration
+  if (points == nullptr || points->size() % 2 != 0) {
+    result->Error("INVALID_ARGUMENT", "points must hold x/y pairs");
+    return;
   }
 
-  return TRUE;  // Continue enumeration
-}
-
-HWND FindTargetWindow(const std::string& processName,
-                      const std::string& windowTitle) {
-  FindWindowData data;
-  data.targetProcessName = processName;
-  data.targetWindowTitle = windowTitle;
-  data.foundWindow = NULL;
+  const MonitorLayout& layout = GetMonitorLayout();
+  std::vector<double> mapped(points->size());
+  for (size_t i = 0; i < points->size(); i += 2) {
+    layout.MapPoint((*points)[i], (*points)[i + 1], &mapped[i],
+                    &mapped[i + 1]);
+  }
 
-  EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&data));
-  return data.foundWindow;
+  result->Success(flutter::EncodableValue(std::move(mapped)));
 }
 
 void KeypressSimulatorWindowsPlugin::SimulateMediaKey(
@@ -332,48 +799,98 @@ void KeypressSimulatorWindowsPlugin::SimulateMediaKey(
   std::string keyIdentifier =
       std::get<std::string>(args.at(EncodableValue("key")));
 
-  // Map string identifier to Windows virtual key codes
-  static const std::unordered_map<std::string, UINT> keyMap = {
-      {"playPause", VK_MEDIA_PLAY_PAUSE}, {"stop", VK_MEDIA_STOP},
-      {"next", VK_MEDIA_NEXT_TRACK},      {"previous", VK_MEDIA_PREV_TRACK},
-      {"volumeUp", VK_VOLUME_UP},         {"volumeDown", VK_VOLUME_DOWN}};
-
-  auto it = keyMap.find(keyIdentifier);
-  if (it == keyMap.end()) {
+  const KeyCodes* codes =
+      keypress_simulator_core::KeyCodesForMediaKey(keyIdentifier);
+  if (codes == nullptr) {
     result->Error("UNSUPPORTED_KEY", "Unsupported media key identifier");
     return;
   }
-  UINT vkCode = it->second;
+  UINT vkCode = codes->windows_vk;
+
+  bool posted = worker_.Post(
+      [vkCode] {
+        // Send key down event
+        INPUT inputs[2] = {};
+        inputs[0].type = INPUT_KEYBOARD;
+        inputs[0].ki.wVk = static_cast<WORD>(vkCode);
+        inputs[0].ki.dwFlags = 0;  // Key down
+
+        // Send key up event
+        inputs[1].type = INPUT_KEYBOARD;
+        inputs[1].ki.wVk = static_cast<WORD>(vkCode);
+        inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+
+        return SendInput(2, inputs, sizeof(INPUT)) == 2;
+      },
+      ReportInjectionResult);
+  if (!posted) {
+    result->Error("QUEUE_FULL", "Too many pending input events");
+    return;
+  }
 
-  // Send key down event
-  INPUT inputs[2] = {};
-  inputs[0].type = INPUT_KEYBOARD;
-  inputs[0].ki.wVk = static_cast<WORD>(vkCode);
-  inputs[0].ki.dwFlags = 0;  // Key down
+  result->Success(flutter::EncodableValue(true));
+}
 
-  // Send key up event
-  inputs[1].type = INPUT_KEYBOARD;
-  inputs[1].ki.wVk = static_cast<WORD>(vkCode);
-  inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+void KeypressSimulatorWindowsPlugin::GetLatencyStats(
+    const flutter::MethodCall<flutter::EncodableValue>& method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  keypress_simulator_core::LatencyRecorder& latency = worker_.latency();
+  EncodableMap stats;
+  for (size_t i = 0; i < keypress_simulator_core::kLatencyStageCount; i++) {
+    LatencyStage stage = static_cast<LatencyStage>(i);
+    LatencySummary summary = latency.Summarize(stage);
+    stats[EncodableValue(keypress_simulator_core::LatencyStageName(stage))] =
+        EncodableValue(EncodableMap{
+            {EncodableValue("count"),
+             EncodableValue(static_cast<int64_t>(summary.count))},
+            {EncodableValue("p50Us"),
+             EncodableValue(static_cast<int64_t>(summary.p50))},
+            {EncodableValue("p99Us"),
+             EncodableValue(static_cast<int64_t>(summary.p99))},
+            {EncodableValue("maxUs"),
+             EncodableValue(static_cast<int64_t>(summary.max))},
+        });
+  }
 
-  UINT eventsSent = SendInput(2, inputs, sizeof(INPUT));
-  if (eventsSent != 2) {
-    result->Error("SEND_INPUT_FAILED", "Failed to send media key input events");
-    return;
+  // With {reset: true} the histograms start over once they are read.
+  if (const auto* args = std::get_if<EncodableMap>(method_call.arguments())) {
+    auto reset_it = args->find(EncodableValue("reset"));
+    if (reset_it != args->end()) {
+      const bool* reset = std::get_if<bool>(&reset_it->second);
+      if (reset != nullptr && *reset) {
+        latency.Reset();
+      }
+    }
   }
 
-  result->Success(flutter::EncodableValue(true));
+  result->Success(EncodableValue(std::move(stats)));
 }
 
 void KeypressSimulatorWindowsPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  if (method_call.method_name().compare("simulateKeyPress") == 0) {
+  if (method_call.method_name().compare("simulateAction") == 0) {
+    SimulateAction(method_call, std::move(result));
+  } else if (method_call.method_name().compare("registerKeymap") == 0) {
+    RegisterKeymap(method_call, std::move(result));
+  } else if (method_call.method_name().compare("startRepeat") == 0) {
+    StartRepeat(method_call, std::move(result));
+  } else if (method_call.method_name().compare("stopRepeat") == 0) {
+    StopRepeat(method_call, std::move(result));
+  } else if (method_call.method_name().compare("simulateKeyPress") == 0) {
     SimulateKeyPress(method_call, std::move(result));
+  } else if (method_call.method_name().compare("simulateKeySequence") == 0) {
+    SimulateKeySequence(method_call, std::move(result));
   } else if (method_call.method_name().compare("simulateMouseClick") == 0) {
     SimulateMouseClick(method_call, std::move(result));
+  } else if (method_call.method_name().compare("simulateDrag") == 0) {
+    SimulateDrag(method_call, std::move(result));
+  } else if (method_call.method_name().compare("mapPoints") == 0) {
+    MapPoints(method_call, std::move(result));
   } else if (method_call.method_name().compare("simulateMediaKey") == 0) {
     SimulateMediaKey(method_call, std::move(result));
+  } else if (method_call.method_name().compare("getLatencyStats") == 0) {
+    GetLatencyStats(method_call, std::move(result));
   } else {
     result->NotImplemented();
   }
@@ -5,14 +5,36 @@
 #include <flutter/plugin_registrar_windows.h>
 
 #include <memory>
+#include <optional>
+#include <vector>
+
+#include "keypress_simulator_core/action_table.h"
+#include "keypress_simulator_core/drag_gesture.h"
+#include "keypress_simulator_core/injection_worker.h"
+#include "keypress_simulator_core/input_batch.h"
+#include "keypress_simulator_core/monitor_layout.h"
+#include "keypress_simulator_core/window_resolver.h"
+#include "win32_window_enumerator.h"
 
 namespace keypress_simulator_windows {
 
+// A key transition with the scan code and extended-key flag SendInput and
+// PostMessage need already looked up.
+struct PreparedKey {
+  WORD virtual_key;
+  WORD scan_code;
+  bool extended;
+  bool down;
+};
+
 class KeypressSimulatorWindowsPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar);
 
-  KeypressSimulatorWindowsPlugin();
+  // Without a |registrar| there are no display-change notifications, so the
+  // monitor layout is rebuilt for every click.
+  explicit KeypressSimulatorWindowsPlugin(
+      flutter::PluginRegistrarWindows* registrar = nullptr);
 
   virtual ~KeypressSimulatorWindowsPlugin();
 
@@ -22,22 +44,101 @@ class KeypressSimulatorWindowsPlugin : public flutter::Plugin {
   KeypressSimulatorWindowsPlugin& operator=(
       const KeypressSimulatorWindowsPlugin&) = delete;
 
+  void KeypressSimulatorWindowsPlugin::RegisterKeymap(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void KeypressSimulatorWindowsPlugin::SimulateAction(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void KeypressSimulatorWindowsPlugin::StartRepeat(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void KeypressSimulatorWindowsPlugin::StopRepeat(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
   void KeypressSimulatorWindowsPlugin::SimulateKeyPress(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  void KeypressSimulatorWindowsPlugin::SimulateKeySequence(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
   void KeypressSimulatorWindowsPlugin::SimulateMouseClick(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  void KeypressSimulatorWindowsPlugin::SimulateDrag(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void KeypressSimulatorWindowsPlugin::MapPoints(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
   void KeypressSimulatorWindowsPlugin::SimulateMediaKey(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  void KeypressSimulatorWindowsPlugin::GetLatencyStats(
+      const flutter::MethodCall<flutter::EncodableValue>& method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
   // Called when a method is called on this plugin's channel from Dart.
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+ private:
+  // Queues |count| keys for the trainer app: posted to its window when it
+  // accepts background input, otherwise with a single SendInput call.
+  // Returns false if the injection queue is full. |origin| is when the input
+  // behind the keys happened, if known.
+  bool InjectKeys(const PreparedKey* keys,
+                  size_t count,
+                  keypress_simulator_core::InjectionWorker::TimePoint origin =
+                      keypress_simulator_core::InjectionWorker::TimePoint());
+
+  // The worker task behind InjectKeys(), also used for repeats. Resolves the
+  // target window now, on the platform thread.
+  keypress_simulator_core::InjectionWorker::Task MakeInjectionTask(
+      const PreparedKey* keys,
+      size_t count);
+
+  // Keeps the window resolver up to date from WinEvent notifications.
+  void InstallWindowHooks();
+  void UninstallWindowHooks();
+
+  // Marks the monitor layout stale on display and DPI changes.
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd,
+                                          UINT message,
+                                          WPARAM wparam,
+                                          LPARAM lparam);
+
+  // Returns the monitor layout, enumerating the monitors first if it is
+  // stale.
+  const keypress_simulator_core::MonitorLayout& GetMonitorLayout();
+
+  flutter::PluginRegistrarWindows* registrar_;
+  int window_proc_id_ = -1;
+  keypress_simulator_core::MonitorLayout monitor_layout_;
+  bool monitor_layout_stale_ = true;
+
+  Win32WindowEnumerator window_enumerator_;
+  keypress_simulator_core::TargetWindowResolver window_resolver_;
+  HWINEVENTHOOK object_event_hook_ = nullptr;
+  HWINEVENTHOOK minimize_event_hook_ = nullptr;
+
+  // Chords uploaded with registerKeymap.
+  keypress_simulator_core::ActionTable<PreparedKey> actions_;
+
+  // Runs SendInput and PostMessage off the platform thread.
+  // Declared last so it is stopped before the rest of the plugin goes away.
+  keypress_simulator_core::InjectionWorker worker_;
 };
 
 }  // namespace keypress_simulator_windows
@@ -0,0 +1,58 @@
+#include "win32_window_enumerator.h"
+
+#include <string.h>
+#include <windows.h>
+
+using keypress_simulator_core::WindowHandle;
+
+namespace keypress_simulator_windows {
+
+namespace {
+
+using WindowCallback = std::function<bool(WindowHandle)>;
+
+BOOL CALLBACK EnumWindowsCallback(HWND hwnd, LPARAM lParam) {
+  const WindowCallback* callback =
+      reinterpret_cast<const WindowCallback*>(lParam);
+
+  // Check if window is visible and not minimized
+  if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) {
+    return TRUE;  // Continue enumeration
+  }
+
+  return (*callback)(reinterpret_cast<WindowHandle>(hwnd)) ? TRUE : FALSE;
+}
+
+}  // namespace
+
+void Win32WindowEnumerator::EnumerateWindows(const WindowCallback& callback) {
+  EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&callback));
+}
+
+bool Win32WindowEnumerator::IsUsable(WindowHandle window) {
+  HWND hwnd = reinterpret_cast<HWND>(window);
+  return IsWindow(hwnd) && IsWindowVisible(hwnd) && !IsIconic(hwnd);
+}
+
+std::string Win32WindowEnumerator::GetProcessName(WindowHandle window) {
+  DWORD processId = 0;
+  GetWindowThreadProcessId(reinterpret_cast<HWND>(window), &processId);
+  HANDLE hProcess =
+      OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+  if (!hProcess) {
+    return std::string();
+  }
+
+  std::string result;
+  char processName[MAX_PATH];
+  DWORD size = sizeof(processName);
+  if (QueryFullProcessImageNameA(hProcess, 0, processName, &size)) {
+    // Extract just the filename from the full path
+    const char* filename = strrchr(processName, '\\');
+    result = filename ? filename + 1 : processName;
+  }
+  CloseHandle(hProcess);
+  return result;
+}
+
+}  // namespace keypress_simulator_windows
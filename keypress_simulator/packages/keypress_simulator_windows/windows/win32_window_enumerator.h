@@ -0,0 +1,26 @@
+#ifndef FLUTTER_PLUGIN_WIN32_WINDOW_ENUMERATOR_H_
+#define FLUTTER_PLUGIN_WIN32_WINDOW_ENUMERATOR_H_
+
+#include <functional>
+#include <string>
+
+#include "keypress_simulator_core/window_resolver.h"
+
+namespace keypress_simulator_windows {
+
+// WindowEnumerator backed by EnumWindows and QueryFullProcessImageName.
+class Win32WindowEnumerator : public keypress_simulator_core::WindowEnumerator {
+ public:
+  void EnumerateWindows(
+      const std::function<bool(keypress_simulator_core::WindowHandle)>&
+          callback) override;
+
+  bool IsUsable(keypress_simulator_core::WindowHandle window) override;
+
+  std::string GetProcessName(
+      keypress_simulator_core::WindowHandle window) override;
+};
+
+}  // namespace keypress_simulator_windows
+
+#endif  // FLUTTER_PLUGIN_WIN32_WINDOW_ENUMERATOR_H_
@@ -12,11 +12,14 @@ import 'package:bike_control/gen/l10n.dart';
 import 'package:bike_control/main.dart';
 import 'package:bike_control/utils/core.dart';
 import 'package:bike_control/utils/iap/iap_manager.dart';
+import 'package:bike_control/utils/input_latency.dart';
 import 'package:bike_control/utils/requirements/android.dart';
 import 'package:dartx/dartx.dart';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
 import 'package:flutter_local_notifications/flutter_local_notifications.dart';
 import 'package:gamepads/gamepads.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 import 'package:universal_ble/universal_ble.dart';
 
 import 'devices/base_device.dart';
@@ -58,6 +61,8 @@ class Connection {
   final ValueNotifier<bool> isScanning = ValueNotifier(false);
 
   Timer? _gamePadSearchTimer;
+  // Where the platform reads gamepads natively, it announces them instead.
+  StreamSubscription<GamepadConnectionEvent>? _nativeGamepadSubscription;
 
   void initialize() {
     actionStream.listen((log) {
@@ -136,7 +141,7 @@ class Connection {
           );
         }
         try {
-          await device.processCharacteristic(characteristicUuid, value);
+          await traceInputOrigin(() => device.processCharacteristic(characteristicUuid, value));
         } catch (e, backtrace) {
           _actionStreams.add(
             LogNotification(
@@ -200,21 +205,16 @@ class Connection {
       platformConfig: PlatformConfig(web: WebOptions(optionalServices: BluetoothDevice.servicesToScan)),
     );
 
-    if (!kIsWeb) {
+    if (mediaKeyDetector.supportsGamepads) {
+      await _startNativeGamepads();
+    } else if (!kIsWeb) {
       _gamePadSearchTimer = Timer.periodic(Duration(seconds: 3), (_) {
         Gamepads.list().then((list) {
           final pads = list.map((pad) => GamepadDevice(pad.name.isEmpty ? 'Gamepad' : pad.name, id: pad.id)).toList();
           addDevices(pads);
 
           final removedDevices = gamepadDevices.where((device) => list.none((pad) => pad.id == device.id)).toList();
-          for (var device in removedDevices) {
-            devices.remove(device);
-            _streamSubscriptions[device]?.cancel();
-            _streamSubscriptions.remove(device);
-            _connectionSubscriptions[device]?.cancel();
-            _connectionSubscriptions.remove(device);
-            signalChange(device);
-          }
+          removedDevices.forEach(_removeGamepad);
         });
       });
     } else {
@@ -222,6 +222,51 @@ class Connection {
     }
   }
 
+  /// Reads gamepads through the native engine, which reports them as they
+  /// connect and disconnect rather than being polled for.
+  Future<void> _startNativeGamepads() async {
+    if (_nativeGamepadSubscription != null) return;
+    _nativeGamepadSubscription = mediaKeyDetector.gamepadConnections.listen((event) {
+      final gamepad = event.gamepad;
+      final id = 'event${gamepad.device}';
+      if (event.connected) {
+        final name = gamepad.name.isEmpty ? 'Gamepad' : gamepad.name;
+        addDevices([
+          GamepadDevice(
+            name,
+            id: id,
+            nativeDevice: gamepad.device,
+            nativeEvents: mediaKeyDetector.gamepadButtonEvents,
+          ),
+        ]);
+      } else {
+        gamepadDevices.where((device) => device.id == id).toList().forEach(_removeGamepad);
+      }
+    });
+    try {
+      await mediaKeyDetector.setUseGamepads(useGamepads: true);
+    } on PlatformException catch (e) {
+      _actionStreams.add(LogNotification('Gamepads are unavailable: ${e.message}'));
+    }
+  }
+
+  Future<void> _stopNativeGamepads() async {
+    await _nativeGamepadSubscription?.cancel();
+    _nativeGamepadSubscription = null;
+    await mediaKeyDetector.setUseGamepads(useGamepads: false);
+    gamepadDevices.where((device) => device.nativeDevice != null).toList().forEach(_removeGamepad);
+  }
+
+  void _removeGamepad(GamepadDevice device) {
+    devices.remove(device);
+    device.disconnect();
+    _streamSubscriptions[device]?.cancel();
+    _streamSubscriptions.remove(device);
+    _connectionSubscriptions[device]?.cancel();
+    _connectionSubscriptions.remove(device);
+    signalChange(device);
+  }
+
   Future<void> startMyWhooshServer() {
     return core.whooshLink.startServer().catchError((e) {
       core.settings.setMyWhooshLinkEnabled(false);
@@ -416,6 +461,9 @@ class Connection {
       devices.remove(device);
     }
     _gamePadSearchTimer?.cancel();
+    if (mediaKeyDetector.supportsGamepads) {
+      await _stopNativeGamepads();
+    }
     _lastScanResult.clear();
     hasDevices.value = false;
   }
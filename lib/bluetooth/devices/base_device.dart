@@ -32,6 +32,10 @@ abstract class BaseDevice {
   bool isConnected = false;
 
   Timer? _longPressTimer;
+  ControllerButton? _nativeRepeatButton;
+  // Bumped by every stop, so a start that is still awaiting the platform can
+  // tell it was cancelled in the meantime.
+  int _repeatGeneration = 0;
   Set<ControllerButton> _previouslyPressedButtons = <ControllerButton>{};
 
   @override
@@ -59,7 +63,7 @@ abstract class BaseDevice {
       final keyPair = core.actionHandler.supportedApp?.keymap.getKeyPair(clickedButtons.single);
       if (keyPair != null && (keyPair.isLongPress || keyPair.inGameAction?.isLongPress == true)) {
         // simulate release after click
-        _longPressTimer?.cancel();
+        await _stopRepeat();
         await Future.delayed(const Duration(milliseconds: 800));
         await handleButtonsClicked([], longPress: true);
       } else {
@@ -85,7 +89,7 @@ abstract class BaseDevice {
       // ignore, no changes
     } else if (buttonsClicked.isEmpty) {
       actionStreamInternal.add(LogNotification('Buttons released'));
-      _longPressTimer?.cancel();
+      await _stopRepeat();
 
       // Handle release events for long press keys
       final buttonsReleased = _previouslyPressedButtons.toList();
@@ -119,10 +123,8 @@ abstract class BaseDevice {
           !(buttonsClicked.singleOrNull == ZwiftButtons.onOffLeft ||
               buttonsClicked.singleOrNull == ZwiftButtons.onOffRight)) {
         // we don't want to trigger the long press timer for the on/off buttons, also not when it's a long press key
-        _longPressTimer?.cancel();
-        _longPressTimer = Timer.periodic(const Duration(milliseconds: 350), (timer) async {
-          performClick(buttonsClicked);
-        });
+        await _stopRepeat();
+        unawaited(_startRepeat(buttonsClicked));
       }
       // Update currently pressed buttons
       _previouslyPressedButtons = buttonsClicked.toSet();
@@ -135,6 +137,45 @@ abstract class BaseDevice {
     }
   }
 
+  /// Repeats [buttonsClicked] while they are held. Keyboard actions are
+  /// repeated by the keypress simulator, which keeps the interval steady when
+  /// the UI is busy; everything else, and every repeat that has to count
+  /// against the daily command limit, is timed here.
+  Future<void> _startRepeat(List<ControllerButton> buttonsClicked) async {
+    const interval = Duration(milliseconds: 350);
+    final generation = _repeatGeneration;
+    final actionHandler = core.actionHandler;
+    if (buttonsClicked.length == 1 &&
+        actionHandler is DesktopActions &&
+        IAPManager.instance.commandsRemainingToday < 0 &&
+        await actionHandler.startRepeat(buttonsClicked.single, interval)) {
+      if (generation != _repeatGeneration) {
+        // released while the repeat was being started
+        await actionHandler.stopRepeat(buttonsClicked.single);
+      } else {
+        _nativeRepeatButton = buttonsClicked.single;
+      }
+      return;
+    }
+    if (generation != _repeatGeneration) {
+      return;
+    }
+    _longPressTimer = Timer.periodic(interval, (timer) async {
+      performClick(buttonsClicked);
+    });
+  }
+
+  Future<void> _stopRepeat() async {
+    _repeatGeneration++;
+    _longPressTimer?.cancel();
+    final button = _nativeRepeatButton;
+    _nativeRepeatButton = null;
+    final actionHandler = core.actionHandler;
+    if (button != null && actionHandler is DesktopActions) {
+      await actionHandler.stopRepeat(button);
+    }
+  }
+
   String _getCommandLimitMessage() {
     return AppLocalizations.current.dailyCommandLimitReachedNotification;
   }
@@ -194,7 +235,7 @@ abstract class BaseDevice {
   }
 
   Future<void> disconnect() async {
-    _longPressTimer?.cancel();
+    await _stopRepeat();
     // Release any held keys in long press mode
     if (core.actionHandler is DesktopActions) {
       await (core.actionHandler as DesktopActions).releaseAllHeldKeys(_previouslyPressedButtons.toList());
@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:io';
 
 import 'package:bike_control/bluetooth/devices/base_device.dart';
@@ -8,16 +9,35 @@ import 'package:bike_control/widgets/ui/beta_pill.dart';
 import 'package:dartx/dartx.dart';
 import 'package:flutter/material.dart';
 import 'package:gamepads/gamepads.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 
 class GamepadDevice extends BaseDevice {
   final String id;
 
-  GamepadDevice(super.name, {required this.id}) : super(availableButtons: []);
+  /// The ID of the gamepad where media_key_detector reads gamepads natively,
+  /// e.g. its event node number on Linux. Null for gamepads read through the
+  /// gamepads plugin.
+  final int? nativeDevice;
+
+  /// The native engine's events of all gamepads, set with [nativeDevice].
+  final Stream<List<GamepadButtonEvent>>? nativeEvents;
+
+  GamepadDevice(super.name, {required this.id, this.nativeDevice, this.nativeEvents})
+    : super(availableButtons: []);
 
   List<ControllerButton> _lastButtonsClicked = [];
 
+  // Native engine state: buttons by their integer ID, and those held.
+  final Map<int, ControllerButton> _nativeButtons = {};
+  final Set<int> _nativeHeld = {};
+  StreamSubscription<List<GamepadButtonEvent>>? _nativeSubscription;
+
   @override
   Future<void> connect() async {
+    if (nativeEvents != null) {
+      _nativeSubscription ??= nativeEvents!.listen(_onNativeButtonEvents);
+      return;
+    }
     Gamepads.eventsByGamepad(id).listen((event) async {
       actionStreamInternal.add(LogNotification('Gamepad event: ${event.key} value ${event.value} type ${event.type}'));
 
@@ -57,6 +77,44 @@ class GamepadDevice extends BaseDevice {
     });
   }
 
+  @override
+  Future<void> disconnect() async {
+    await _nativeSubscription?.cancel();
+    _nativeSubscription = null;
+    _nativeHeld.clear();
+    await super.disconnect();
+  }
+
+  /// The engine only reports changes, so each batch updates the held set and
+  /// the buttons are handed on as a whole once.
+  void _onNativeButtonEvents(List<GamepadButtonEvent> events) {
+    var changed = false;
+    for (final event in events) {
+      if (event.device != nativeDevice) continue;
+      changed = (event.pressed ? _nativeHeld.add(event.button) : _nativeHeld.remove(event.button)) || changed;
+    }
+    if (!changed) return;
+    handleButtonsClicked([for (final button in _nativeHeld) _nativeButton(button)]);
+  }
+
+  ControllerButton _nativeButton(int id) {
+    return _nativeButtons[id] ??= getOrAddButton(
+      nativeButtonName(id),
+      () => ControllerButton(nativeButtonName(id), identifier: id),
+    );
+  }
+
+  /// Keymap name of a button of the native engine, e.g. `button_0x130` or
+  /// `axis_0_+` for the left stick pushed right.
+  @visibleForTesting
+  static String nativeButtonName(int id) {
+    if (id < GamepadButtonEvent.axisButtonBase) {
+      return 'button_0x${id.toRadixString(16)}';
+    }
+    final axis = (id - GamepadButtonEvent.axisButtonBase) ~/ 2;
+    return 'axis_${axis}_${id.isOdd ? '+' : '-'}';
+  }
+
   @override
   Widget showInformation(BuildContext context) {
     return Padding(
@@ -12,11 +12,15 @@ import 'package:bike_control/utils/keymap/buttons.dart';
 import 'package:bike_control/utils/keymap/keymap.dart';
 import 'package:dartx/dartx.dart';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
 import 'package:nsd/nsd.dart';
+import 'package:trainer_network/trainer_network.dart';
 
 class OpenBikeControlMdnsEmulator extends TrainerConnection {
   ServerSocket? _server;
   Registration? _mdnsRegistration;
+  // On Linux, the plugin advertises the service natively instead.
+  MdnsResponder? _mdnsResponder;
 
   static const String connectionTitle = 'OpenBikeControl mDNS Emulator';
 
@@ -54,6 +58,21 @@ class OpenBikeControlMdnsEmulator extends TrainerConnection {
 
     await _createTcpServer();
 
+    const name = 'BikeControl';
+    const type = '_openbikecontrol._tcp';
+    final txt = {
+      'version': Uint8List.fromList([0x01]),
+      'id': Uint8List.fromList('1337'.codeUnits),
+      'name': Uint8List.fromList('BikeControl'.codeUnits),
+      'service-uuids': Uint8List.fromList(OpenBikeControlConstants.SERVICE_UUID.codeUnits),
+      'manufacturer': Uint8List.fromList('OpenBikeControl'.codeUnits),
+      'model': Uint8List.fromList('BikeControl app'.codeUnits),
+    };
+    if (await _startNativeMdns(name, type, txt)) {
+      print('Server started - advertising service!');
+      return;
+    }
+
     if (kDebugMode) {
       enableLogging(LogTopic.calls);
       enableLogging(LogTopic.errors);
@@ -64,19 +83,12 @@ class OpenBikeControlMdnsEmulator extends TrainerConnection {
       // Create service
       _mdnsRegistration = await register(
         Service(
-          name: 'BikeControl',
-          type: '_openbikecontrol._tcp',
+          name: name,
+          type: type,
           port: 36867,
           //hostName: 'KICKR BIKE SHIFT B84D.local',
           addresses: [localIP],
-          txt: {
-            'version': Uint8List.fromList([0x01]),
-            'id': Uint8List.fromList('1337'.codeUnits),
-            'name': Uint8List.fromList('BikeControl'.codeUnits),
-            'service-uuids': Uint8List.fromList(OpenBikeControlConstants.SERVICE_UUID.codeUnits),
-            'manufacturer': Uint8List.fromList('OpenBikeControl'.codeUnits),
-            'model': Uint8List.fromList('BikeControl app'.codeUnits),
-          },
+          txt: txt,
         ),
       );
       print('Service: ${_mdnsRegistration!.id} at ${localIP.address}:$_mdnsRegistration');
@@ -95,6 +107,8 @@ class OpenBikeControlMdnsEmulator extends TrainerConnection {
       unregister(_mdnsRegistration!);
       _mdnsRegistration = null;
     }
+    await _mdnsResponder?.stop();
+    _mdnsResponder = null;
     isStarted.value = false;
     isConnected.value = false;
     connectedApp.value = null;
@@ -102,6 +116,27 @@ class OpenBikeControlMdnsEmulator extends TrainerConnection {
     _socket = null;
   }
 
+  /// Advertises the service through the Linux plugin, which probes for its
+  /// name and answers queries natively, without Avahi. Returns false where
+  /// it cannot, so nsd takes over.
+  Future<bool> _startNativeMdns(String name, String type, Map<String, Uint8List> txt) async {
+    if (!MdnsResponder.isSupported) return false;
+    const responder = MdnsResponder();
+    try {
+      final advertised = await responder.start(name: name, type: type, port: 36867, txt: txt);
+      if (kDebugMode) {
+        print('Advertising $advertised natively');
+      }
+      _mdnsResponder = responder;
+      return true;
+    } on PlatformException catch (e) {
+      print('Native mDNS unavailable: ${e.message}');
+      return false;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
   Future<void> _createTcpServer() async {
     try {
       _server = await ServerSocket.bind(
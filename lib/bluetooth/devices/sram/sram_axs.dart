@@ -4,6 +4,7 @@ import 'package:bike_control/bluetooth/devices/zwift/ftms_mdns_emulator.dart';
 import 'package:bike_control/utils/core.dart';
 import 'package:bike_control/utils/keymap/buttons.dart';
 import 'package:flutter/foundation.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 import 'package:shadcn_flutter/shadcn_flutter.dart';
 import 'package:universal_ble/universal_ble.dart';
 
@@ -15,11 +16,27 @@ class SramAxs extends BluetoothDevice {
   Timer? _singleClickTimer;
   int _tapCount = 0;
 
+  /// Counts the taps natively where the platform can, timestamped on arrival
+  /// and resolved on a thread of its own rather than by a Dart [Timer].
+  static final TapClassifier? _tapClassifier = TapClassifier.open();
+  static int _nextTapDevice = 0;
+
+  /// Identifies this device to [_tapClassifier].
+  late final int _tapDevice = _nextTapDevice++;
+  bool _nativeTaps = false;
+  StreamSubscription<List<TapGesture>>? _tapSubscription;
+
   @override
   Future<void> disconnect() async {
     _singleClickTimer?.cancel();
     _singleClickTimer = null;
     _tapCount = 0;
+    await _tapSubscription?.cancel();
+    _tapSubscription = null;
+    if (_nativeTaps) {
+      _tapClassifier?.removeDevice(_tapDevice);
+      _nativeTaps = false;
+    }
     await super.disconnect();
   }
 
@@ -39,6 +56,24 @@ class SramAxs extends BluetoothDevice {
     // add both buttons
     _singleClickButton();
     _doubleClickButton();
+
+    _applyTapOptions();
+    if (_nativeTaps) {
+      _tapSubscription ??= _tapClassifier!.timedGestures.listen((gestures) {
+        for (final gesture in gestures) {
+          if (gesture.device == _tapDevice) {
+            _emitTaps(gesture.taps);
+          }
+        }
+      });
+    }
+  }
+
+  /// Hands the double-click window to [_tapClassifier]. Falls back to
+  /// [_registerTap] where the native classifier is not running.
+  void _applyTapOptions() {
+    final windowMs = core.settings.getSramAxsDoubleClickWindowMs();
+    _nativeTaps = _tapClassifier?.setOptions(_tapDevice, window: Duration(milliseconds: windowMs)) ?? false;
   }
 
   ControllerButton _singleClickButton() => getOrAddButton(
@@ -56,6 +91,10 @@ class SramAxs extends BluetoothDevice {
     handleButtonsClickedWithoutLongPressSupport([button]);
   }
 
+  void _emitTaps(int taps) {
+    _emitClick(taps == 1 ? _singleClickButton() : _doubleClickButton());
+  }
+
   void _registerTap() {
     final windowMs = core.settings.getSramAxsDoubleClickWindowMs();
 
@@ -98,7 +137,14 @@ class SramAxs extends BluetoothDevice {
     if (characteristic.toLowerCase() == SramAxsConstants.TRIGGER_UUID.toLowerCase()) {
       // At the moment we can only detect "some button pressed". We therefore interpret each
       // notification as a tap and provide two logical buttons (single & double click).
-      _registerTap();
+      final gestures = _nativeTaps ? _tapClassifier!.tap(_tapDevice) : null;
+      if (gestures == null) {
+        _registerTap();
+      } else {
+        for (final gesture in gestures) {
+          _emitTaps(gesture.taps);
+        }
+      }
     }
 
     return Future.value();
@@ -146,6 +192,7 @@ class SramAxs extends BluetoothDevice {
                             child: Text('${v}ms'),
                             onPressed: (c) async {
                               await core.settings.setSramAxsDoubleClickWindowMs(v);
+                              _applyTapOptions();
                               // Force rebuild to show new value.
                               (context as Element).markNeedsBuild();
                             },
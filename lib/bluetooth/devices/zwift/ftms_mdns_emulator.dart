@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:io';
 
 import 'package:bike_control/bluetooth/devices/trainer_connection.dart';
@@ -13,17 +14,27 @@ import 'package:bike_control/utils/keymap/buttons.dart';
 import 'package:bike_control/utils/keymap/keymap.dart';
 import 'package:dartx/dartx.dart';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
 import 'package:nsd/nsd.dart';
+import 'package:trainer_network/trainer_network.dart';
 
 class FtmsMdnsEmulator extends TrainerConnection {
   ServerSocket? _tcpServer;
   Registration? _mdnsRegistration;
+  // On Linux, the plugin advertises the service natively instead.
+  MdnsResponder? _mdnsResponder;
 
   static const String connectionTitle = 'Zwift Network Emulator';
 
   Socket? _socket;
   var lastMessageId = 0;
 
+  // On Linux, the plugin serves DirCon natively and only hands writes to us.
+  DirConServer? _dirCon;
+  StreamSubscription<DirConConnectionEvent>? _dirConConnections;
+  StreamSubscription<DirConWrite>? _dirConWrites;
+  var _dirConClients = 0;
+
   FtmsMdnsEmulator()
     : super(
         title: connectionTitle,
@@ -63,7 +74,22 @@ class FtmsMdnsEmulator extends TrainerConnection {
       throw 'Could not find network interface';
     }
 
-    await _createTcpServer();
+    if (!await _startNativeServer()) {
+      await _createTcpServer();
+    }
+
+    const name = 'KICKR BIKE PRO 1337';
+    const type = '_wahoo-fitness-tnp._tcp';
+    final txt = {
+      'ble-service-uuids': Uint8List.fromList('FC82'.codeUnits),
+      'mac-address': Uint8List.fromList('50-50-25-6C-66-9C'.codeUnits),
+      'serial-number': Uint8List.fromList('244700181'.codeUnits),
+      'manufacturer-data': Uint8List.fromList('094A0BAAAA'.codeUnits),
+    };
+    if (await _startNativeMdns(name, type, txt)) {
+      print('Server started - advertising service!');
+      return;
+    }
 
     if (kDebugMode) {
       enableLogging(LogTopic.calls);
@@ -73,16 +99,11 @@ class FtmsMdnsEmulator extends TrainerConnection {
 
     _mdnsRegistration = await register(
       Service(
-        name: 'KICKR BIKE PRO 1337',
+        name: name,
         addresses: [localIP],
         port: 36867,
-        type: '_wahoo-fitness-tnp._tcp',
-        txt: {
-          'ble-service-uuids': Uint8List.fromList('FC82'.codeUnits),
-          'mac-address': Uint8List.fromList('50-50-25-6C-66-9C'.codeUnits),
-          'serial-number': Uint8List.fromList('244700181'.codeUnits),
-          'manufacturer-data': Uint8List.fromList('094A0BAAAA'.codeUnits),
-        },
+        type: type,
+        txt: txt,
       ),
     );
     print('Server started - advertising service!');
@@ -92,15 +113,121 @@ class FtmsMdnsEmulator extends TrainerConnection {
     isStarted.value = false;
     isConnected.value = false;
     _tcpServer?.close();
+    _dirConConnections?.cancel();
+    _dirConWrites?.cancel();
+    _dirCon?.stop();
     if (_mdnsRegistration != null) {
       unregister(_mdnsRegistration!);
     }
+    _mdnsResponder?.stop();
     _tcpServer = null;
     _mdnsRegistration = null;
+    _mdnsResponder = null;
     _socket = null;
+    _dirCon = null;
+    _dirConConnections = null;
+    _dirConWrites = null;
+    _dirConClients = 0;
     print('Stopped FtmsMdnsEmulator');
   }
 
+  /// Advertises the service through the Linux plugin, which probes for its
+  /// name and answers queries natively, without Avahi. Returns false where
+  /// it cannot, so nsd takes over.
+  Future<bool> _startNativeMdns(String name, String type, Map<String, Uint8List> txt) async {
+    if (!MdnsResponder.isSupported) return false;
+    const responder = MdnsResponder();
+    try {
+      final advertised = await responder.start(name: name, type: type, port: 36867, txt: txt);
+      if (kDebugMode) {
+        print('Advertising $advertised natively');
+      }
+      _mdnsResponder = responder;
+      return true;
+    } on PlatformException catch (e) {
+      print('Native mDNS unavailable: ${e.message}');
+      return false;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  bool get _hasClient => _socket != null || _dirConClients > 0;
+
+  /// Serves the Zwift Ride service from the native DirCon server of the Linux
+  /// plugin, which answers discovery on its own thread. Returns false where
+  /// there is none, so the Dart server takes over.
+  Future<bool> _startNativeServer() async {
+    final server = DirConServer.open();
+    if (server == null) return false;
+
+    Uint8List uuid(String value) => Uint8List.fromList(hexToBytes(value.toLowerCase().toNonDash()));
+    _dirConConnections = server.connections.listen((event) {
+      if (kDebugMode) {
+        print('Client ${event.connected ? 'connected' : 'disconnected'}: ${event.address}');
+      }
+      _dirConClients += event.connected ? 1 : -1;
+      isConnected.value = _dirConClients > 0;
+      core.connection.signalNotification(
+        AlertNotification(
+          LogLevel.LOGLEVEL_INFO,
+          event.connected ? AppLocalizations.current.connected : AppLocalizations.current.disconnected,
+        ),
+      );
+    });
+    _dirConWrites = server.writes.listen((write) {
+      final response = core.zwiftEmulator.handleWriteRequest(bytesToHex(write.characteristic).toUUID(), write.data);
+      if (response != null) {
+        _notify(ZwiftConstants.ZWIFT_SYNC_TX_CHARACTERISTIC_UUID, response);
+        if (response.contentEquals(ZwiftConstants.RIDE_ON)) {
+          _sendKeepAlive();
+        }
+      }
+    });
+
+    try {
+      await server.start([
+        DirConService(
+          uuid: uuid(ZwiftConstants.ZWIFT_RIDE_CUSTOM_SERVICE_UUID),
+          characteristics: [
+            DirConCharacteristic(
+              uuid: uuid(ZwiftConstants.ZWIFT_SYNC_RX_CHARACTERISTIC_UUID),
+              properties: DirConCharacteristic.write,
+            ),
+            DirConCharacteristic(
+              uuid: uuid(ZwiftConstants.ZWIFT_ASYNC_CHARACTERISTIC_UUID),
+              properties: DirConCharacteristic.notify,
+            ),
+            DirConCharacteristic(
+              uuid: uuid(ZwiftConstants.ZWIFT_SYNC_TX_CHARACTERISTIC_UUID),
+              properties: DirConCharacteristic.notify,
+            ),
+          ],
+        ),
+      ]);
+    } on PlatformException catch (e) {
+      if (kDebugMode) {
+        print('Native DirCon server unavailable: $e');
+      }
+      _dirConConnections?.cancel();
+      _dirConWrites?.cancel();
+      _dirConConnections = null;
+      _dirConWrites = null;
+      return false;
+    }
+    _dirCon = server;
+    return true;
+  }
+
+  // Sends a notification of the characteristic [uuid] to the client.
+  void _notify(String uuid, List<int> data) {
+    if (_dirCon != null) {
+      _dirCon!.notify(Uint8List.fromList(hexToBytes(uuid.toLowerCase().toNonDash())), Uint8List.fromList(data));
+    } else if (_socket != null) {
+      _write(_socket!, _buildNotify(uuid, data));
+    }
+  }
+
   Future<void> _createTcpServer() async {
     try {
       _tcpServer = await ServerSocket.bind(
@@ -361,24 +488,20 @@ class FtmsMdnsEmulator extends TrainerConnection {
 
       final bytes = status.writeToBuffer();
 
-      final commandProto = _buildNotify(
+      _notify(
         ZwiftConstants.ZWIFT_ASYNC_CHARACTERISTIC_UUID,
         Uint8List.fromList([
           Opcode.CONTROLLER_NOTIFICATION.value,
           ...bytes,
         ]),
       );
-
-      _write(_socket!, commandProto);
     }
 
     if (isKeyUp) {
-      final zero = _buildNotify(
+      _notify(
         ZwiftConstants.ZWIFT_ASYNC_CHARACTERISTIC_UUID,
         Uint8List.fromList([Opcode.CONTROLLER_NOTIFICATION.value, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F]),
       );
-
-      _write(_socket!, zero);
     }
     if (kDebugMode) {
       print('Sent action $isKeyUp vs $isKeyDown ${keyPair.inGameAction!.title} to Zwift Emulator');
@@ -412,13 +535,10 @@ class FtmsMdnsEmulator extends TrainerConnection {
 
   Future<void> _sendKeepAlive() async {
     await Future.delayed(const Duration(seconds: 5));
-    if (_socket != null) {
-      _write(
-        _socket!,
-        _buildNotify(
-          ZwiftConstants.ZWIFT_SYNC_TX_CHARACTERISTIC_UUID,
-          hexToBytes('B70100002041201C00180004001B4F00B701000020798EC5BDEFCBE4563418269E4926FBE1'),
-        ),
+    if (_hasClient) {
+      _notify(
+        ZwiftConstants.ZWIFT_SYNC_TX_CHARACTERISTIC_UUID,
+        hexToBytes('B70100002041201C00180004001B4F00B701000020798EC5BDEFCBE4563418269E4926FBE1'),
       );
       _sendKeepAlive();
     }
@@ -1,4 +1,5 @@
 import 'package:flutter/foundation.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 import 'package:bike_control/bluetooth/devices/zwift/protocol/zwift.pb.dart';
 import 'package:bike_control/bluetooth/devices/zwift/zwift_device.dart';
 import 'package:bike_control/utils/keymap/buttons.dart';
@@ -8,6 +9,9 @@ import 'constants.dart';
 class ZwiftClick extends ZwiftDevice {
   ZwiftClick(super.scanResult) : super(availableButtons: [ZwiftButtons.shiftUpRight, ZwiftButtons.shiftUpLeft]);
 
+  @override
+  int? get keypadKind => ZwiftKeypadDecoder.click;
+
   @override
   List<ControllerButton> processClickNotification(Uint8List message) {
     final status = ClickKeyPadStatus.fromBuffer(message);
@@ -10,6 +10,7 @@ import 'package:bike_control/utils/keymap/buttons.dart';
 import 'package:bike_control/utils/single_line_exception.dart';
 import 'package:dartx/dartx.dart';
 import 'package:flutter/foundation.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 import 'package:shadcn_flutter/shadcn_flutter.dart';
 import 'package:universal_ble/universal_ble.dart';
 
@@ -128,7 +129,8 @@ abstract class ZwiftDevice extends BluetoothDevice {
 
   Future<void> processData(Uint8List bytes) async {
     int type = bytes[0];
-    Uint8List message = bytes.sublist(1);
+    // Only copied for the messages decoded in Dart.
+    late final message = bytes.sublist(1);
 
     switch (type) {
       case ZwiftConstants.EMPTY_MESSAGE_TYPE:
@@ -144,8 +146,10 @@ abstract class ZwiftDevice extends BluetoothDevice {
       case ZwiftConstants.PLAY_NOTIFICATION_MESSAGE_TYPE:
       case ZwiftConstants.RIDE_NOTIFICATION_MESSAGE_TYPE:
         try {
-          final buttonsClicked = processClickNotification(message);
-          handleButtonsClicked(buttonsClicked);
+          final buttonsClicked = decodeClickNotification(bytes);
+          if (buttonsClicked != null) {
+            handleButtonsClicked(buttonsClicked);
+          }
         } catch (e) {
           actionStreamInternal.add(LogNotification(e.toString()));
         }
@@ -164,6 +168,72 @@ abstract class ZwiftDevice extends BluetoothDevice {
 
   List<ControllerButton> processClickNotification(Uint8List message);
 
+  /// The native decoder, where the platform has one.
+  static final ZwiftKeypadDecoder? _keypadDecoder = ZwiftKeypadDecoder.open();
+
+  /// Which keypad message the notifications carry, for [ZwiftKeypadDecoder].
+  /// Null to always decode them with [processClickNotification].
+  int? get keypadKind => null;
+
+  static const _keypadButtons = [
+    (ZwiftKeypadDecoder.navigationLeft, ZwiftButtons.navigationLeft),
+    (ZwiftKeypadDecoder.navigationRight, ZwiftButtons.navigationRight),
+    (ZwiftKeypadDecoder.navigationUp, ZwiftButtons.navigationUp),
+    (ZwiftKeypadDecoder.navigationDown, ZwiftButtons.navigationDown),
+    (ZwiftKeypadDecoder.a, ZwiftButtons.a),
+    (ZwiftKeypadDecoder.b, ZwiftButtons.b),
+    (ZwiftKeypadDecoder.y, ZwiftButtons.y),
+    (ZwiftKeypadDecoder.z, ZwiftButtons.z),
+    (ZwiftKeypadDecoder.shiftUpLeft, ZwiftButtons.shiftUpLeft),
+    (ZwiftKeypadDecoder.shiftDownLeft, ZwiftButtons.shiftDownLeft),
+    (ZwiftKeypadDecoder.shiftUpRight, ZwiftButtons.shiftUpRight),
+    (ZwiftKeypadDecoder.shiftDownRight, ZwiftButtons.shiftDownRight),
+    (ZwiftKeypadDecoder.powerUpLeft, ZwiftButtons.powerUpLeft),
+    (ZwiftKeypadDecoder.powerUpRight, ZwiftButtons.powerUpRight),
+    (ZwiftKeypadDecoder.onOffLeft, ZwiftButtons.onOffLeft),
+    (ZwiftKeypadDecoder.onOffRight, ZwiftButtons.onOffRight),
+    (ZwiftKeypadDecoder.sideLeft, ZwiftButtons.sideButtonLeft),
+    (ZwiftKeypadDecoder.sideRight, ZwiftButtons.sideButtonRight),
+    (ZwiftKeypadDecoder.paddleLeft, ZwiftButtons.paddleLeft),
+    (ZwiftKeypadDecoder.paddleRight, ZwiftButtons.paddleRight),
+  ];
+
+  /// Finds the presses and releases in the button masks natively, so the
+  /// notifications that change nothing stop there. Long presses stay with
+  /// [handleButtonsClicked], so the engine reports none.
+  static final ButtonEdgeEngine? _edgeEngine = ButtonEdgeEngine.open()
+    ?..setOptions(longPress: Duration.zero);
+  static int _nextEdgeDevice = 0;
+
+  /// Identifies this device to [_edgeEngine].
+  late final int _edgeDevice = _nextEdgeDevice++;
+
+  /// The buttons held according to a keypad notification, [bytes] being the
+  /// whole notification including its type, or null if they are the same as
+  /// in the last one. Decoded natively where possible, which reads it in
+  /// place; otherwise by [processClickNotification].
+  List<ControllerButton>? decodeClickNotification(Uint8List bytes) {
+    final decoder = _keypadDecoder;
+    final kind = keypadKind;
+    if (decoder == null || kind == null) {
+      return processClickNotification(bytes.sublist(1));
+    }
+    final held = decoder.decode(kind, bytes);
+    if (held == null) {
+      throw FormatException('Malformed keypad notification', bytes);
+    }
+    // Null while the plugin is not running; handleButtonsClicked compares
+    // the lists then.
+    final edges = _edgeEngine?.update(_edgeDevice, held);
+    if (edges != null && edges.isEmpty) {
+      return null;
+    }
+    return [
+      for (final (bit, button) in _keypadButtons)
+        if (held & bit != 0) button,
+    ];
+  }
+
   @override
   Future<void> performDown(List<ControllerButton> buttonsClicked) async {
     if (buttonsClicked.any(((e) => e.action == InGameAction.shiftDown || e.action == InGameAction.shiftUp)) &&
@@ -183,6 +253,12 @@ abstract class ZwiftDevice extends BluetoothDevice {
     return super.performClick(buttonsClicked);
   }
 
+  @override
+  Future<void> disconnect() async {
+    _edgeEngine?.removeDevice(_edgeDevice);
+    await super.disconnect();
+  }
+
   Future<void> _vibrate() async {
     final vibrateCommand = Uint8List.fromList([...ZwiftConstants.VIBRATE_PATTERN, 0x20]);
     await UniversalBle.write(
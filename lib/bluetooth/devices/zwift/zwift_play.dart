@@ -3,6 +3,7 @@ import 'package:bike_control/bluetooth/devices/zwift/protocol/zwift.pb.dart';
 import 'package:bike_control/bluetooth/devices/zwift/zwift_device.dart';
 import 'package:bike_control/utils/keymap/buttons.dart';
 import 'package:flutter/foundation.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 
 class ZwiftPlay extends ZwiftDevice {
   ZwiftPlay(super.scanResult)
@@ -31,6 +32,9 @@ class ZwiftPlay extends ZwiftDevice {
   @override
   bool get canVibrate => true;
 
+  @override
+  int? get keypadKind => ZwiftKeypadDecoder.play;
+
   @override
   List<ControllerButton> processClickNotification(Uint8List message) {
     final status = PlayKeyPadStatus.fromBuffer(message);
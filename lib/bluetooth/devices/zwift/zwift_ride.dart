@@ -1,5 +1,6 @@
 import 'package:dartx/dartx.dart';
 import 'package:flutter/foundation.dart';
+import 'package:media_key_detector/media_key_detector.dart';
 import 'package:protobuf/protobuf.dart' as $pb;
 import 'package:bike_control/bluetooth/devices/zwift/constants.dart';
 import 'package:bike_control/bluetooth/devices/zwift/protocol/zp.pb.dart';
@@ -52,7 +53,8 @@ class ZwiftRide extends ZwiftDevice {
   @override
   Future<void> processData(Uint8List bytes) async {
     Opcode? opcode = Opcode.valueOf(bytes[0]);
-    Uint8List message = bytes.sublist(1);
+    // Only copied for the messages decoded in Dart.
+    late final message = bytes.sublist(1);
 
     if (kDebugMode) {
       print(
@@ -151,8 +153,10 @@ class ZwiftRide extends ZwiftDevice {
         break;
       case Opcode.CONTROLLER_NOTIFICATION:
         try {
-          final buttonsClicked = processClickNotification(message);
-          handleButtonsClicked(buttonsClicked);
+          final buttonsClicked = decodeClickNotification(bytes);
+          if (buttonsClicked != null) {
+            handleButtonsClicked(buttonsClicked);
+          }
         } catch (e) {
           actionStreamInternal.add(LogNotification(e.toString()));
         }
@@ -168,6 +172,9 @@ class ZwiftRide extends ZwiftDevice {
     }
   }
 
+  @override
+  int? get keypadKind => ZwiftKeypadDecoder.ride;
+
   @override
   List<ControllerButton> processClickNotification(Uint8List message) {
     final status = RideKeyPadStatus.fromBuffer(message);
@@ -3,6 +3,7 @@ import 'dart:io';
 import 'dart:math';
 
 import 'package:bike_control/main.dart';
+import 'package:bike_control/utils/actions/desktop.dart';
 import 'package:bike_control/utils/core.dart';
 import 'package:bike_control/utils/i18n_extension.dart';
 import 'package:bike_control/widgets/keymap_explanation.dart';
@@ -12,6 +13,7 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/scheduler.dart';
 import 'package:flutter/services.dart';
 import 'package:image_picker/image_picker.dart';
+import 'package:keypress_simulator/keypress_simulator.dart';
 import 'package:path_provider/path_provider.dart';
 import 'package:shadcn_flutter/shadcn_flutter.dart';
 import 'package:window_manager/window_manager.dart';
@@ -36,6 +38,27 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
 
   bool _showFaded = true;
 
+  // Screen pixel each touch area clicks on, shown in debug builds.
+  Map<KeyPair, Offset> _screenPositions = {};
+
+  Future<void> _updateScreenPositions() async {
+    if (!kDebugMode || !(Platform.isWindows || Platform.isLinux || Platform.isMacOS)) return;
+    final keyPairs =
+        core.actionHandler.supportedApp?.keymap.keyPairs
+            .where((kp) => kp.touchPosition != Offset.zero && !kp.isSpecialKey)
+            .toList() ??
+        [];
+    final positions = [
+      for (final keyPair in keyPairs) await core.actionHandler.resolveTouchPosition(keyPair: keyPair, windowInfo: null),
+    ];
+    // one platform call for all areas, mapped with the same monitor layout the clicks use
+    final mapped = await keyPressSimulator.mapPoints(positions);
+    if (!mounted) return;
+    setState(() {
+      _screenPositions = Map.fromIterables(keyPairs, mapped);
+    });
+  }
+
   Future<void> _pickScreenshot() async {
     final picker = ImagePicker();
     final result = await picker.pickImage(source: ImageSource.gallery);
@@ -111,6 +134,7 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
     if (Platform.isWindows || Platform.isLinux || Platform.isMacOS) {
       windowManager.setFullScreen(true);
     }
+    _updateScreenPositions();
     getTemporaryDirectory().then((tempDir) async {
       final tempImage = File('${tempDir.path}/${core.actionHandler.supportedApp?.name ?? 'temp'}_screenshot.png');
       if (tempImage.existsSync()) {
@@ -130,10 +154,12 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
     required void Function(Offset newPosition) onPositionChanged,
     required Color color,
     required KeyPair keyPair,
+    bool isDragTarget = false,
   }) {
     // map the percentage position to the image rect
-    final relativeX = min(100.0, keyPair.touchPosition.dx) / 100.0;
-    final relativeY = min(100.0, keyPair.touchPosition.dy) / 100.0;
+    final percent = isDragTarget ? keyPair.dragTo! : keyPair.touchPosition;
+    final relativeX = min(100.0, percent.dx) / 100.0;
+    final relativeY = min(100.0, percent.dy) / 100.0;
     //print('Relative position: $relativeX, $relativeY');
     final flutterView = WidgetsBinding.instance.platformDispatcher.views.first;
 
@@ -176,7 +202,7 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
               width: iconSize,
               height: iconSize,
               child: Icon(
-                keyPair.icon,
+                isDragTarget ? Icons.call_made : keyPair.icon,
                 size: iconSize - 12,
                 shadows: [
                   Shadow(color: Colors.white, offset: Offset(1, 1)),
@@ -187,7 +213,15 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
                 ],
               ),
             ),
-          KeypairExplanation(withKey: true, keyPair: keyPair),
+          if (isDragTarget)
+            Text(context.i18n.dragTarget).small
+          else
+            KeypairExplanation(withKey: true, keyPair: keyPair),
+          if (_screenPositions[keyPair] case final screenPosition? when !isDragTarget)
+            Text(
+              '→ ${screenPosition.dx.toInt()}, ${screenPosition.dy.toInt()}',
+              style: TextStyle(fontSize: 10, fontFamily: 'monospace'),
+            ),
         ],
       ),
     );
@@ -196,7 +230,7 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
       left: position.dx,
       top: position.dy,
       child: Tooltip(
-        tooltip: (c) => Text(context.i18n.dragToReposition),
+        tooltip: (c) => Text(isDragTarget ? context.i18n.dragTargetDescription : context.i18n.dragToReposition),
         child: AnimatedOpacity(
           opacity: _showFaded && widget.keyPair != keyPair ? 0.2 : 1.0,
           duration: Duration(milliseconds: 300),
@@ -297,10 +331,26 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
                       final relativeY = ((newPos.dy - _imageRect.top) / _imageRect.height).clamp(0.0, 1.0);
                       keyPair.touchPosition = Offset(relativeX * 100.0, relativeY * 100.0);
                       setState(() {});
+                      _updateScreenPositions();
                     },
                     color: Colors.red,
                   ),
 
+                // where the drag of the key pair being edited ends
+                if (widget.keyPair.dragTo != null)
+                  _buildDraggableArea(
+                    enableTouch: true,
+                    keyPair: widget.keyPair,
+                    isDragTarget: true,
+                    onPositionChanged: (newPos) {
+                      final relativeX = ((newPos.dx - _imageRect.left) / _imageRect.width).clamp(0.0, 1.0);
+                      final relativeY = ((newPos.dy - _imageRect.top) / _imageRect.height).clamp(0.0, 1.0);
+                      widget.keyPair.dragTo = Offset(relativeX * 100.0, relativeY * 100.0);
+                      setState(() {});
+                    },
+                    color: Colors.blue,
+                  ),
+
                 Positioned.fill(child: Testbed()),
 
                 if (_backgroundImage == null)
@@ -354,6 +404,22 @@ class _TouchAreaSetupPageState extends State<TouchAreaSetupPage> {
                                           _pickScreenshot();
                                         },
                                       ),
+                                    // only the desktop can drag the mouse
+                                    if (core.actionHandler is DesktopActions)
+                                      MenuButton(
+                                        child: Text(
+                                          widget.keyPair.dragTo == null
+                                              ? context.i18n.addDragTarget
+                                              : context.i18n.removeDragTarget,
+                                        ),
+                                        onPressed: (c) {
+                                          final start = widget.keyPair.touchPosition;
+                                          widget.keyPair.dragTo = widget.keyPair.dragTo == null
+                                              ? Offset(min(100.0, start.dx + 10), start.dy)
+                                              : null;
+                                          setState(() {});
+                                        },
+                                      ),
                                     MenuButton(
                                       child: Text(context.i18n.reset),
                                       onPressed: (c) {
@@ -59,8 +59,15 @@ abstract class BaseActions {
     }
   }
 
-  Future<Offset> resolveTouchPosition({required KeyPair keyPair, required WindowEvent? windowInfo}) async {
-    if (keyPair.touchPosition != Offset.zero) {
+  /// Converts [position] (defaults to [KeyPair.touchPosition]), given in
+  /// percent of the screen, to a click position.
+  Future<Offset> resolveTouchPosition({
+    required KeyPair keyPair,
+    required WindowEvent? windowInfo,
+    Offset? position,
+  }) async {
+    final relativePosition = position ?? keyPair.touchPosition;
+    if (relativePosition != Offset.zero) {
       // convert relative position to absolute position based on window info
 
       // TODO support multiple screens
@@ -94,8 +101,8 @@ abstract class BaseActions {
         physicalSize = displaySize;
       }
 
-      final x = (keyPair.touchPosition.dx / 100.0) * physicalSize.width;
-      final y = (keyPair.touchPosition.dy / 100.0) * physicalSize.height;
+      final x = (relativePosition.dx / 100.0) * physicalSize.width;
+      final y = (relativePosition.dy / 100.0) * physicalSize.height;
 
       if (kDebugMode) {
         print("Screen size: $physicalSize vs $displaySize => Touch at: $x, $y");
@@ -2,8 +2,12 @@ import 'package:bike_control/main.dart';
 import 'package:bike_control/utils/actions/base_actions.dart';
 import 'package:bike_control/utils/core.dart';
 import 'package:bike_control/utils/iap/iap_manager.dart';
+import 'package:bike_control/utils/input_latency.dart';
 import 'package:bike_control/utils/keymap/buttons.dart';
+import 'package:bike_control/utils/keymap/keymap.dart';
 import 'package:bike_control/widgets/ui/toast.dart';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
 import 'package:keypress_simulator/keypress_simulator.dart';
 import 'package:shadcn_flutter/shadcn_flutter.dart';
 
@@ -12,6 +16,16 @@ class DesktopActions extends BaseActions {
 
   // Track keys that are currently held down in long press mode
 
+  // Keymap whose keyboard chords were last uploaded with registerKeymap, and
+  // the chords as uploaded, by action ID (the key pair's index).
+  Keymap? _registeredKeymap;
+  Map<int, KeySequenceStep> _registeredActions = const {};
+  bool _keymapRegistered = false;
+
+  // Action IDs repeated natively, by the button holding them. Kept so the
+  // repeat can be stopped even if the keymap changes in the meantime.
+  final Map<ControllerButton, int> _repeatingActions = {};
+
   @override
   Future<ActionResult> performAction(ControllerButton button, {required bool isKeyDown, required bool isKeyUp}) async {
     final superResult = await super.performAction(button, isKeyDown: isKeyDown, isKeyUp: isKeyUp);
@@ -52,9 +66,27 @@ class DesktopActions extends BaseActions {
           );
         }
 
-        if (isKeyDown && isKeyUp) {
-          await keyPressSimulator.simulateKeyDown(keyPair.physicalKey, keyPair.modifiers);
-          await keyPressSimulator.simulateKeyUp(keyPair.physicalKey, keyPair.modifiers);
+        final actionId = await _registeredActionId(supportedApp!.keymap, keyPair);
+        if (actionId != null) {
+          // only the action id crosses to native code, the chord is already known there. A direct
+          // FFI call skips the platform channel where the plugin supports it.
+          final keyDown = isKeyDown && isKeyUp ? null : isKeyDown;
+          final origin = currentInputOrigin;
+          if (!keyPressSimulator.trySimulateActionDirect(actionId, keyDown: keyDown, originMicros: origin)) {
+            await keyPressSimulator.simulateAction(actionId, keyDown: keyDown, originMicros: origin);
+          }
+          return Success(
+            '${isKeyDown && isKeyUp
+                ? "Key clicked"
+                : isKeyDown
+                ? "Key pressed"
+                : "Key released"}: $keyPair',
+          );
+        } else if (isKeyDown && isKeyUp) {
+          // press and release in a single platform call so nothing can interleave
+          await keyPressSimulator.simulateKeySequence([
+            KeySequenceStep(keyPair.physicalKey!, modifiers: keyPair.modifiers),
+          ], originMicros: currentInputOrigin);
 
           return Success('Key clicked: $keyPair');
         } else if (isKeyDown) {
@@ -64,21 +96,28 @@ class DesktopActions extends BaseActions {
           await keyPressSimulator.simulateKeyUp(keyPair.physicalKey, keyPair.modifiers);
           return Success('Key released: $keyPair');
         }
+      } else if (keyPair.dragTo != null && keyPair.touchPosition != Offset.zero) {
+        final result = await performDrag(keyPair, isKeyDown: isKeyDown);
+        if (result is Success) {
+          // Increment command count after successful execution
+          await IAPManager.instance.incrementCommandCount();
+        }
+        return result;
       } else {
         final point = await resolveTouchPosition(keyPair: keyPair, windowInfo: null);
         if (point != Offset.zero) {
           // Increment command count after successful execution
           await IAPManager.instance.incrementCommandCount();
           if (isKeyDown && isKeyUp) {
-            await keyPressSimulator.simulateMouseClickDown(point);
+            await _click(point, keyDown: true);
             // slight move to register clicks on some apps, see issue #116
-            await keyPressSimulator.simulateMouseClickUp(point);
+            await _click(point, keyDown: false);
             return Success('Mouse clicked at: ${point.dx.toInt()} ${point.dy.toInt()}');
           } else if (isKeyDown) {
-            await keyPressSimulator.simulateMouseClickDown(point);
+            await _click(point, keyDown: true);
             return Success('Mouse down at: ${point.dx.toInt()} ${point.dy.toInt()}');
           } else {
-            await keyPressSimulator.simulateMouseClickUp(point);
+            await _click(point, keyDown: false);
             return Success('Mouse up at: ${point.dx.toInt()} ${point.dy.toInt()}');
           }
         }
@@ -87,6 +126,98 @@ class DesktopActions extends BaseActions {
     return NotHandled('Action not handled for button: $button');
   }
 
+  /// Drags from the touch position of [keyPair] to its [KeyPair.dragTo].
+  ///
+  /// The whole drag, press, move and release, runs on key down, so a button
+  /// held for longer does not hold the drag. Key up has nothing left to do.
+  @visibleForTesting
+  Future<ActionResult> performDrag(KeyPair keyPair, {required bool isKeyDown}) async {
+    if (!isKeyDown) {
+      return Ignored('Drag already performed on key down: $keyPair');
+    }
+    final from = await resolveTouchPosition(keyPair: keyPair, windowInfo: null);
+    final to = await resolveTouchPosition(keyPair: keyPair, windowInfo: null, position: keyPair.dragTo);
+    await keyPressSimulator.simulateDrag([from, to]);
+    return Success('Mouse dragged from ${from.dx.toInt()} ${from.dy.toInt()} to ${to.dx.toInt()} ${to.dy.toInt()}');
+  }
+
+  /// Presses or releases the mouse button at [point], directly through FFI where the plugin supports it.
+  Future<void> _click(Offset point, {required bool keyDown}) async {
+    if (keyPressSimulator.trySimulateMouseClickDirect(point, keyDown: keyDown)) {
+      return;
+    }
+    if (keyDown) {
+      await keyPressSimulator.simulateMouseClickDown(point);
+    } else {
+      await keyPressSimulator.simulateMouseClickUp(point);
+    }
+  }
+
+  /// Returns the action ID of [keyPair], uploading [keymap] first if it
+  /// changed since the last registration. Returns null if the platform
+  /// rejected the keymap, in which case keys are sent one by one.
+  Future<int?> _registeredActionId(Keymap keymap, KeyPair keyPair) async {
+    final actionId = keymap.keyPairs.indexOf(keyPair);
+    if (actionId < 0) {
+      return null;
+    }
+    final registered = _registeredActions[actionId];
+    final isCurrent =
+        identical(_registeredKeymap, keymap) &&
+        registered?.key == keyPair.physicalKey &&
+        listEquals(registered?.modifiers, keyPair.modifiers);
+    if (!isCurrent) {
+      _registeredKeymap = keymap;
+      _registeredActions = {
+        for (final (index, pair) in keymap.keyPairs.indexed)
+          if (pair.physicalKey != null && !pair.isSpecialKey)
+            index: KeySequenceStep(pair.physicalKey!, modifiers: List.of(pair.modifiers)),
+      };
+      try {
+        await keyPressSimulator.registerKeymap(_registeredActions);
+        _keymapRegistered = true;
+      } on PlatformException {
+        _keymapRegistered = false;
+      }
+    }
+    return _keymapRegistered ? actionId : null;
+  }
+
+  /// Lets the keypress simulator repeat the keyboard action of [button] every
+  /// [interval] while it is held. Returns false if the action cannot be
+  /// repeated natively, in which case the caller times the repeats itself.
+  Future<bool> startRepeat(ControllerButton button, Duration interval) async {
+    final keymap = supportedApp?.keymap;
+    final keyPair = keymap?.getKeyPair(button);
+    if (keymap == null ||
+        keyPair == null ||
+        !core.settings.getLocalEnabled() ||
+        keyPair.inGameAction != null ||
+        keyPair.physicalKey == null ||
+        keyPair.isSpecialKey) {
+      return false;
+    }
+    final actionId = await _registeredActionId(keymap, keyPair);
+    if (actionId == null) {
+      return false;
+    }
+    try {
+      await keyPressSimulator.startRepeat(actionId, initialDelay: interval, interval: interval);
+      _repeatingActions[button] = actionId;
+      return true;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Stops the repeats started with [startRepeat] for [button].
+  Future<void> stopRepeat(ControllerButton button) async {
+    final actionId = _repeatingActions.remove(button);
+    if (actionId != null) {
+      await keyPressSimulator.stopRepeat(actionId);
+    }
+  }
+
   // Release all held keys (useful for cleanup)
   Future<void> releaseAllHeldKeys(List<ControllerButton> list) async {
     for (final action in list) {
@@ -0,0 +1,19 @@
+import 'dart:async';
+import 'dart:developer';
+
+/// Zone key under which [traceInputOrigin] stores the origin timestamp.
+const Symbol _inputOriginKey = #bikeControlInputOrigin;
+
+/// Runs [body] with the current `Timeline.now` as the origin of any input it
+/// injects, e.g. while processing a BLE notification.
+///
+/// The timestamp follows [body] through its awaits, so the action handlers
+/// can read it with [currentInputOrigin] without it being passed along every
+/// call. The keypress simulator uses it to measure the latency from the
+/// notification to the injected key.
+Future<T> traceInputOrigin<T>(Future<T> Function() body) {
+  return runZoned(body, zoneValues: {_inputOriginKey: Timeline.now});
+}
+
+/// The origin set by the enclosing [traceInputOrigin], if any.
+int? get currentInputOrigin => Zone.current[_inputOriginKey] as int?;
@@ -65,6 +65,7 @@ class Keymap {
       keyPair.physicalKey = null;
       keyPair.logicalKey = null;
       keyPair.touchPosition = Offset.zero;
+      keyPair.dragTo = null;
       keyPair.isLongPress = false;
       keyPair.inGameAction = null;
       keyPair.inGameActionValue = null;
@@ -128,6 +129,11 @@ class KeyPair {
   LogicalKeyboardKey? logicalKey;
   List<ModifierKey> modifiers;
   Offset touchPosition;
+
+  /// Where a drag starting at [touchPosition] ends, in percent of the screen.
+  /// The whole drag runs when the button goes down. `null` clicks at
+  /// [touchPosition] instead.
+  Offset? dragTo;
   bool isLongPress;
   InGameAction? inGameAction;
   int? inGameActionValue;
@@ -139,6 +145,7 @@ class KeyPair {
     required this.logicalKey,
     this.modifiers = const [],
     this.touchPosition = Offset.zero,
+    this.dragTo,
     this.isLongPress = false,
     this.inGameAction,
     this.inGameActionValue,
@@ -294,6 +301,7 @@ class KeyPair {
       if (physicalKey != null) 'physicalKey': physicalKey?.usbHidUsage.toString() ?? '0',
       if (modifiers.isNotEmpty) 'modifiers': modifiers.map((e) => e.name).toList(),
       if (touchPosition != Offset.zero) 'touchPosition': {'x': touchPosition.dx, 'y': touchPosition.dy},
+      if (dragTo != null) 'dragTo': {'x': dragTo!.dx, 'y': dragTo!.dy},
       'isLongPress': isLongPress,
       'inGameAction': inGameAction?.name,
       'inGameActionValue': inGameActionValue,
@@ -312,6 +320,12 @@ class KeyPair {
             (decoded['touchPosition']['y'] as num).toDouble(),
           )
         : Offset.zero;
+    final Offset? dragTo = decoded.containsKey('dragTo')
+        ? Offset(
+            (decoded['dragTo']['x'] as num).toDouble(),
+            (decoded['dragTo']['y'] as num).toDouble(),
+          )
+        : null;
 
     ControllerButton? decodeButton(dynamic raw) {
       String? name;
@@ -363,6 +377,7 @@ class KeyPair {
           : null,
       modifiers: modifiers,
       touchPosition: touchPosition,
+      dragTo: dragTo,
       isLongPress: decoded['isLongPress'] ?? false,
       inGameAction: decoded.containsKey('inGameAction')
           ? InGameAction.values.firstOrNullWhere((element) => element.name == decoded['inGameAction'])
@@ -383,6 +398,7 @@ class KeyPair {
           logicalKey == other.logicalKey &&
           modifiers == other.modifiers &&
           touchPosition == other.touchPosition &&
+          dragTo == other.dragTo &&
           isLongPress == other.isLongPress &&
           inGameAction == other.inGameAction &&
           inGameActionValue == other.inGameActionValue &&
@@ -394,6 +410,7 @@ class KeyPair {
     logicalKey,
     modifiers,
     touchPosition,
+    dragTo,
     isLongPress,
     inGameAction,
     inGameActionValue,
@@ -11,8 +11,10 @@
 #include <flutter_secure_storage_linux/flutter_secure_storage_linux_plugin.h>
 #include <gamepads_linux/gamepads_linux_plugin.h>
 #include <gtk/gtk_plugin.h>
+#include <keypress_simulator_linux/keypress_simulator_linux_plugin.h>
 #include <media_key_detector_linux/media_key_detector_plugin.h>
 #include <screen_retriever_linux/screen_retriever_linux_plugin.h>
+#include <trainer_network/trainer_network_plugin.h>
 #include <url_launcher_linux/url_launcher_plugin.h>
 #include <window_manager/window_manager_plugin.h>
 #include <yaru_window_linux/yaru_window_linux_plugin.h>
@@ -33,12 +35,18 @@ void fl_register_plugins(FlPluginRegistry* registry) {
   g_autoptr(FlPluginRegistrar) gtk_registrar =
       fl_plugin_registry_get_registrar_for_plugin(registry, "GtkPlugin");
   gtk_plugin_register_with_registrar(gtk_registrar);
+  g_autoptr(FlPluginRegistrar) keypress_simulator_linux_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "KeypressSimulatorLinuxPlugin");
+  keypress_simulator_linux_plugin_register_with_registrar(keypress_simulator_linux_registrar);
   g_autoptr(FlPluginRegistrar) media_key_detector_linux_registrar =
       fl_plugin_registry_get_registrar_for_plugin(registry, "MediaKeyDetectorPlugin");
   media_key_detector_plugin_register_with_registrar(media_key_detector_linux_registrar);
   g_autoptr(FlPluginRegistrar) screen_retriever_linux_registrar =
       fl_plugin_registry_get_registrar_for_plugin(registry, "ScreenRetrieverLinuxPlugin");
   screen_retriever_linux_plugin_register_with_registrar(screen_retriever_linux_registrar);
+  g_autoptr(FlPluginRegistrar) trainer_network_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "TrainerNetworkPlugin");
+  trainer_network_plugin_register_with_registrar(trainer_network_registrar);
   g_autoptr(FlPluginRegistrar) url_launcher_linux_registrar =
       fl_plugin_registry_get_registrar_for_plugin(registry, "UrlLauncherPlugin");
   url_launcher_plugin_register_with_registrar(url_launcher_linux_registrar);
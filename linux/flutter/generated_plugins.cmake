@@ -8,8 +8,10 @@ list(APPEND FLUTTER_PLUGIN_LIST
   flutter_secure_storage_linux
   gamepads_linux
   gtk
+  keypress_simulator_linux
   media_key_detector_linux
   screen_retriever_linux
+  trainer_network
   url_launcher_linux
   window_manager
   yaru_window_linux
@@ -0,0 +1,75 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// What happened to a button, as in `ButtonEdgeAction` in
+/// `button_edge_engine.h`.
+enum ButtonEdgeAction {
+  /// The button went down.
+  press,
+
+  /// The button went up.
+  release,
+
+  /// The button has been held for the long press time.
+  longPress,
+
+  /// The button is still held, every repeat interval after the long press.
+  repeat,
+}
+
+/// A transition of a button in the mask of a device.
+@immutable
+class ButtonEdge {
+  /// Creates an edge.
+  const ButtonEdge({
+    required this.device,
+    required this.button,
+    required this.action,
+    required this.timestamp,
+  });
+
+  /// The ID the device's masks were passed with.
+  final int device;
+
+  /// Bit of the button in the mask.
+  final int button;
+
+  /// What happened to it.
+  final ButtonEdgeAction action;
+
+  /// When it happened, on the clock of `Timeline.now`. For long presses and
+  /// repeats this is when they were due.
+  final Duration timestamp;
+
+  /// Decodes the first [count] (device, button, action, timestamp)
+  /// quadruples of [values], all of them by default.
+  static List<ButtonEdge> decodeBatch(Int64List values, [int? count]) {
+    if (values.length % 4 != 0) {
+      throw FormatException('Button edges come in quadruples, got ${values.length} values');
+    }
+    return [
+      for (var i = 0; i < (count ?? values.length ~/ 4) * 4; i += 4)
+        ButtonEdge(
+          device: values[i],
+          button: values[i + 1],
+          action: ButtonEdgeAction.values[values[i + 2]],
+          timestamp: Duration(microseconds: values[i + 3]),
+        ),
+    ];
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is ButtonEdge &&
+      other.device == device &&
+      other.button == button &&
+      other.action == action &&
+      other.timestamp == timestamp;
+
+  @override
+  int get hashCode => Object.hash(device, button, action, timestamp);
+
+  @override
+  String toString() => 'ButtonEdge($device, bit $button, ${action.name}, $timestamp)';
+}
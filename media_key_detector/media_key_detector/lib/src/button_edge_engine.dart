@@ -0,0 +1,104 @@
+import 'dart:developer';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+import 'package:media_key_detector/src/button_edge.dart';
+
+/// Turns the button masks that controllers report into the transitions of
+/// their buttons natively, through the C ABI the Linux plugin library
+/// exports (see
+/// `native/include/media_key_detector_core/media_key_detector_ffi.h`).
+///
+/// [update] returns the presses and releases a mask causes at once, and
+/// nothing for the many masks that change nothing. Long presses and repeats
+/// come due later and arrive on [timedEdges], timed on a native thread.
+class ButtonEdgeEngine {
+  ButtonEdgeEngine._(this._state, this._removeDevice, this._options);
+
+  /// The ABI version this file was written against.
+  static const int abiVersion = 2;
+
+  static const int _ok = 0;
+
+  // Edges a call returns at most; the rest arrive on timedEdges. A mask of 64
+  // bits causes no more than 64 presses and releases, plus what came due.
+  static const int _capacity = 64;
+
+  static ButtonEdgeEngine? _instance;
+
+  final int Function(int, int, int, Int64List, int) _state;
+  final int Function(int, int, Int64List, int) _removeDevice;
+  final int Function(int, int, int) _options;
+
+  final Int64List _edges = Int64List(_capacity * 4);
+  final _edgeChannel = const EventChannel('media_key_detector_linux_button_edges');
+  Stream<List<ButtonEdge>>? _timedEdges;
+
+  /// Binds the engine of the plugin library. Returns null where the library
+  /// does not export it or exports another ABI version. The engine is shared
+  /// by the whole app.
+  static ButtonEdgeEngine? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isLinux) return null;
+    try {
+      final library = DynamicLibrary.open('libmedia_key_detector_linux_plugin.so');
+      final version = library.lookupFunction<Int32 Function(), int Function()>('mkd_abi_version');
+      if (version() != abiVersion) return null;
+      return _instance = ButtonEdgeEngine._(
+        library.lookupFunction<
+          Int32 Function(Uint32, Uint64, Int64, Pointer<Int64>, Int32),
+          int Function(int, int, int, Int64List, int)
+        >('mkd_button_state', isLeaf: true),
+        library.lookupFunction<
+          Int32 Function(Uint32, Int64, Pointer<Int64>, Int32),
+          int Function(int, int, Int64List, int)
+        >('mkd_button_remove_device', isLeaf: true),
+        library.lookupFunction<Int32 Function(Int64, Int64, Int64), int Function(int, int, int)>(
+          'mkd_button_options',
+          isLeaf: true,
+        ),
+      );
+    } on ArgumentError {
+      // The library or one of the symbols is missing.
+      return null;
+    }
+  }
+
+  /// Feeds the [buttons] mask [device] reports now. Returns the edges it
+  /// causes, oldest first, or null if the plugin is not running.
+  List<ButtonEdge>? update(int device, int buttons) {
+    final count = _state(device, buttons, Timeline.now, _edges, _capacity);
+    if (count < 0) return null;
+    return count == 0 ? const [] : ButtonEdge.decodeBatch(_edges, count);
+  }
+
+  /// Releases the buttons of [device] and forgets it, e.g. when it
+  /// disconnects. Returns the releases, or null if the plugin is not
+  /// running.
+  List<ButtonEdge>? removeDevice(int device) {
+    final count = _removeDevice(device, Timeline.now, _edges, _capacity);
+    if (count < 0) return null;
+    return count == 0 ? const [] : ButtonEdge.decodeBatch(_edges, count);
+  }
+
+  /// Sets how long releases are held back to absorb contact bounce, how long
+  /// a button is held for a long press, and how often it repeats after it;
+  /// zero turns each off. Forgets every device.
+  bool setOptions({
+    Duration debounce = Duration.zero,
+    Duration longPress = const Duration(milliseconds: 500),
+    Duration repeatInterval = Duration.zero,
+  }) {
+    return _options(debounce.inMicroseconds, longPress.inMicroseconds, repeatInterval.inMicroseconds) == _ok;
+  }
+
+  /// Long presses and repeats as they come due, and edges [update] had no
+  /// room for.
+  Stream<List<ButtonEdge>> get timedEdges {
+    return _timedEdges ??= _edgeChannel
+        .receiveBroadcastStream()
+        .map((batch) => ButtonEdge.decodeBatch(batch as Int64List));
+  }
+}
@@ -0,0 +1,19 @@
+import 'package:media_key_detector/src/button_edge.dart';
+
+/// Stands in for the `dart:ffi` engine on platforms without `dart:ffi`
+/// (the web), where button masks are always compared in Dart.
+class ButtonEdgeEngine {
+  static ButtonEdgeEngine? open() => null;
+
+  List<ButtonEdge>? update(int device, int buttons) => null;
+
+  List<ButtonEdge>? removeDevice(int device) => null;
+
+  bool setOptions({
+    Duration debounce = Duration.zero,
+    Duration longPress = const Duration(milliseconds: 500),
+    Duration repeatInterval = Duration.zero,
+  }) => false;
+
+  Stream<List<ButtonEdge>> get timedEdges => const Stream.empty();
+}
@@ -1,4 +1,16 @@
 export 'package:media_key_detector_platform_interface/media_key_detector_platform_interface.dart'
-    show MediaKey;
+    show
+        GamepadButtonEvent,
+        GamepadConnectionEvent,
+        MediaKey,
+        MediaKeyAction,
+        MediaKeyEvent,
+        MediaKeySource,
+        NativeGamepad;
+export './button_edge.dart';
+export './button_edge_engine_stub.dart' if (dart.library.ffi) './button_edge_engine.dart';
 export './main.dart' show getPlatformName;
 export './media_key_detector.dart' show MediaKeyDetector, mediaKeyDetector;
+export './tap_classifier_stub.dart' if (dart.library.ffi) './tap_classifier.dart';
+export './tap_gesture.dart';
+export './zwift_keypad_decoder_stub.dart' if (dart.library.ffi) './zwift_keypad_decoder.dart';
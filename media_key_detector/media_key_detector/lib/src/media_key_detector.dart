@@ -27,6 +27,13 @@ class MediaKeyDetector {
     _platform.removeListener(listener);
   }
 
+  /// Media key events with their timing, in batches as the platform sent
+  /// them. Only sent on platforms that watch the keys natively.
+  Stream<List<MediaKeyEvent>> get events {
+    _lazilyInitialize();
+    return _platform.events;
+  }
+
   void _lazilyInitialize() {
     if (!_initialized) {
       _platform.initialize();
@@ -34,6 +41,24 @@ class MediaKeyDetector {
     }
   }
 
+  /// Whether the platform reads gamepads natively, see [setUseGamepads].
+  bool get supportsGamepads => _platform.supportsGamepads;
+
+  /// Reads gamepads natively, including ones that connect later, whether or
+  /// not the app is playing. Only implemented where [supportsGamepads].
+  Future<void> setUseGamepads({required bool useGamepads}) =>
+      _platform.setUseGamepads(useGamepads: useGamepads);
+
+  /// Gamepad button presses and releases, in batches as they were read,
+  /// while [setUseGamepads] is on.
+  Stream<List<GamepadButtonEvent>> get gamepadButtonEvents =>
+      _platform.gamepadButtonEvents;
+
+  /// Gamepads that connect or disconnect while [setUseGamepads] is on,
+  /// including the ones found when it is turned on.
+  Stream<GamepadConnectionEvent> get gamepadConnections =>
+      _platform.gamepadConnections;
+
   /// Get whether the active audio player is currently playing.
   Future<bool> getIsPlaying() => _platform.getIsPlaying();
 
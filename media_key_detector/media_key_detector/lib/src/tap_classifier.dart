@@ -0,0 +1,98 @@
+import 'dart:developer';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+import 'package:media_key_detector/src/tap_gesture.dart';
+
+/// Counts the taps of devices that only report "something was tapped" into
+/// single, double and triple taps natively, through the C ABI the Linux
+/// plugin library exports (see
+/// `native/include/media_key_detector_core/media_key_detector_ffi.h`).
+///
+/// [tap] stamps each tap with the time it arrived, and a native thread
+/// resolves the gestures when their window runs out, so neither depends on
+/// when the UI isolate gets around to a timer. Gestures resolved at once are
+/// returned by [tap]; the others arrive on [timedGestures].
+class TapClassifier {
+  TapClassifier._(this._tap, this._options, this._removeDevice);
+
+  /// The ABI version this file was written against.
+  static const int abiVersion = 2;
+
+  static const int _ok = 0;
+
+  // Gestures a call returns at most; the rest arrive on timedGestures.
+  static const int _capacity = 16;
+
+  static TapClassifier? _instance;
+
+  final int Function(int, int, Int64List, int) _tap;
+  final int Function(int, int, int, int) _options;
+  final int Function(int) _removeDevice;
+
+  final Int64List _gestures = Int64List(_capacity * 3);
+  final _tapChannel = const EventChannel('media_key_detector_linux_taps');
+  Stream<List<TapGesture>>? _timedGestures;
+
+  /// Binds the classifier of the plugin library. Returns null where the
+  /// library does not export it or exports another ABI version. The
+  /// classifier is shared by the whole app.
+  static TapClassifier? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isLinux) return null;
+    try {
+      final library = DynamicLibrary.open('libmedia_key_detector_linux_plugin.so');
+      final version = library.lookupFunction<Int32 Function(), int Function()>('mkd_abi_version');
+      if (version() != abiVersion) return null;
+      return _instance = TapClassifier._(
+        library.lookupFunction<
+          Int32 Function(Uint32, Int64, Pointer<Int64>, Int32),
+          int Function(int, int, Int64List, int)
+        >('mkd_tap', isLeaf: true),
+        library.lookupFunction<Int32 Function(Uint32, Int64, Int32, Int32), int Function(int, int, int, int)>(
+          'mkd_tap_options',
+          isLeaf: true,
+        ),
+        library.lookupFunction<Int32 Function(Uint32), int Function(int)>('mkd_tap_remove_device', isLeaf: true),
+      );
+    } on ArgumentError {
+      // The library or one of the symbols is missing.
+      return null;
+    }
+  }
+
+  /// Feeds a tap of [device] that arrived just now. Returns the gestures it
+  /// resolves at once, or null if the plugin is not running.
+  List<TapGesture>? tap(int device) {
+    final count = _tap(device, Timeline.now, _gestures, _capacity);
+    if (count < 0) return null;
+    return count == 0 ? const [] : TapGesture.decodeBatch(_gestures, count);
+  }
+
+  /// Sets how the taps of [device] are counted: taps closer together than
+  /// [window] make up one gesture, which resolves at once when it reaches
+  /// [maxTaps]. With [optimistic], the first tap is reported at once rather
+  /// than after the window, and a gesture of more taps in addition. Drops the
+  /// taps of [device] still pending.
+  bool setOptions(
+    int device, {
+    Duration window = const Duration(milliseconds: 300),
+    int maxTaps = 2,
+    bool optimistic = false,
+  }) {
+    return _options(device, window.inMicroseconds, maxTaps, optimistic ? 1 : 0) == _ok;
+  }
+
+  /// Forgets [device], its pending taps and its options, e.g. when it
+  /// disconnects.
+  void removeDevice(int device) => _removeDevice(device);
+
+  /// Gestures as their window runs out, and those [tap] had no room for.
+  Stream<List<TapGesture>> get timedGestures {
+    return _timedGestures ??= _tapChannel
+        .receiveBroadcastStream()
+        .map((batch) => TapGesture.decodeBatch(batch as Int64List));
+  }
+}
@@ -0,0 +1,20 @@
+import 'package:media_key_detector/src/tap_gesture.dart';
+
+/// Stands in for the `dart:ffi` classifier on platforms without `dart:ffi`
+/// (the web), where taps are always counted with a Dart timer.
+class TapClassifier {
+  static TapClassifier? open() => null;
+
+  List<TapGesture>? tap(int device) => null;
+
+  bool setOptions(
+    int device, {
+    Duration window = const Duration(milliseconds: 300),
+    int maxTaps = 2,
+    bool optimistic = false,
+  }) => false;
+
+  void removeDevice(int device) {}
+
+  Stream<List<TapGesture>> get timedGestures => const Stream.empty();
+}
@@ -0,0 +1,41 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// Taps of a device counted into one gesture.
+@immutable
+class TapGesture {
+  /// Creates a gesture.
+  const TapGesture({required this.device, required this.taps, required this.timestamp});
+
+  /// The ID the taps were passed with.
+  final int device;
+
+  /// 1 for a single tap, 2 for a double tap, and so on.
+  final int taps;
+
+  /// When its last tap arrived, on the clock of `Timeline.now`.
+  final Duration timestamp;
+
+  /// Decodes the first [count] (device, taps, timestamp) triples of
+  /// [values], all of them by default.
+  static List<TapGesture> decodeBatch(Int64List values, [int? count]) {
+    if (values.length % 3 != 0) {
+      throw FormatException('Tap gestures come in triples, got ${values.length} values');
+    }
+    return [
+      for (var i = 0; i < (count ?? values.length ~/ 3) * 3; i += 3)
+        TapGesture(device: values[i], taps: values[i + 1], timestamp: Duration(microseconds: values[i + 2])),
+    ];
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is TapGesture && other.device == device && other.taps == taps && other.timestamp == timestamp;
+
+  @override
+  int get hashCode => Object.hash(device, taps, timestamp);
+
+  @override
+  String toString() => 'TapGesture($device, $taps taps, $timestamp)';
+}
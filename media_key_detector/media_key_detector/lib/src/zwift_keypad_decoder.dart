@@ -0,0 +1,83 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+/// Decodes the keypad notifications of Zwift controllers natively, through
+/// the C ABI the Linux plugin library exports (see
+/// `native/include/media_key_detector_core/media_key_detector_ffi.h`).
+///
+/// The notification is read in place by a leaf call, so decoding neither
+/// copies it nor builds protobuf message objects.
+class ZwiftKeypadDecoder {
+  ZwiftKeypadDecoder._(this._decode);
+
+  /// The ABI version this file was written against.
+  static const int abiVersion = 2;
+
+  // The kind argument of decode, as in media_key_detector_ffi.h.
+  static const int click = 0;
+  static const int play = 1;
+  static const int ride = 2;
+
+  // Bits of the buttons held, as in ZwiftButton in zwift_keypad.h.
+  static const int navigationLeft = 1 << 0;
+  static const int navigationUp = 1 << 1;
+  static const int navigationRight = 1 << 2;
+  static const int navigationDown = 1 << 3;
+  static const int a = 1 << 4;
+  static const int b = 1 << 5;
+  static const int y = 1 << 6;
+  static const int z = 1 << 7;
+  static const int shiftUpLeft = 1 << 8;
+  static const int shiftDownLeft = 1 << 9;
+  static const int powerUpLeft = 1 << 10;
+  static const int onOffLeft = 1 << 11;
+  static const int shiftUpRight = 1 << 12;
+  static const int shiftDownRight = 1 << 13;
+  static const int powerUpRight = 1 << 14;
+  static const int onOffRight = 1 << 15;
+  static const int sideLeft = 1 << 16;
+  static const int sideRight = 1 << 17;
+  static const int paddleLeft = 1 << 18;
+  static const int paddleRight = 1 << 19;
+
+  static const int _ok = 0;
+
+  final int Function(int, Uint8List, int, Int32List) _decode;
+
+  // MkdZwiftKeypad: the buttons, then the analog values by location.
+  final Int32List _result = Int32List(5);
+
+  /// Binds the decoder of the plugin library. Returns null where the library
+  /// does not export it or exports another ABI version.
+  static ZwiftKeypadDecoder? open() {
+    if (!Platform.isLinux) return null;
+    try {
+      final library = DynamicLibrary.open('libmedia_key_detector_linux_plugin.so');
+      final version = library.lookupFunction<Int32 Function(), int Function()>('mkd_abi_version');
+      if (version() != abiVersion) return null;
+      return ZwiftKeypadDecoder._(
+        library.lookupFunction<
+          Int32 Function(Int32, Pointer<Uint8>, Int64, Pointer<Int32>),
+          int Function(int, Uint8List, int, Int32List)
+        >('mkd_decode_zwift_keypad', isLeaf: true),
+      );
+    } on ArgumentError {
+      // The library or one of the symbols is missing.
+      return null;
+    }
+  }
+
+  /// Decodes a [notification] of [kind] ([click], [play] or [ride]) as
+  /// received, with its message type byte. Returns the bits of the buttons
+  /// held, or null if the notification is malformed.
+  int? decode(int kind, Uint8List notification) {
+    if (notification.isEmpty) return null;
+    if (_decode(kind, notification, notification.length, _result) != _ok) return null;
+    return _result[0];
+  }
+
+  /// The value from -100 to 100 of the analog paddle at [location], as in
+  /// `RideAnalogLocation`, in the last notification decoded.
+  int analog(int location) => _result[1 + location];
+}
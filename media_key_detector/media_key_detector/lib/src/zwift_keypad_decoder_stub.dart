@@ -0,0 +1,36 @@
+import 'dart:typed_data';
+
+/// Stands in for the `dart:ffi` decoder on platforms without `dart:ffi`
+/// (the web), where notifications are always decoded in Dart.
+class ZwiftKeypadDecoder {
+  static const int click = 0;
+  static const int play = 1;
+  static const int ride = 2;
+
+  static const int navigationLeft = 1 << 0;
+  static const int navigationUp = 1 << 1;
+  static const int navigationRight = 1 << 2;
+  static const int navigationDown = 1 << 3;
+  static const int a = 1 << 4;
+  static const int b = 1 << 5;
+  static const int y = 1 << 6;
+  static const int z = 1 << 7;
+  static const int shiftUpLeft = 1 << 8;
+  static const int shiftDownLeft = 1 << 9;
+  static const int powerUpLeft = 1 << 10;
+  static const int onOffLeft = 1 << 11;
+  static const int shiftUpRight = 1 << 12;
+  static const int shiftDownRight = 1 << 13;
+  static const int powerUpRight = 1 << 14;
+  static const int onOffRight = 1 << 15;
+  static const int sideLeft = 1 << 16;
+  static const int sideRight = 1 << 17;
+  static const int paddleLeft = 1 << 18;
+  static const int paddleRight = 1 << 19;
+
+  static ZwiftKeypadDecoder? open() => null;
+
+  int? decode(int kind, Uint8List notification) => null;
+
+  int analog(int location) => 0;
+}
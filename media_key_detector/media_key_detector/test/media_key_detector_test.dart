@@ -40,5 +40,43 @@ void main() {
         expect(getPlatformName, throwsException);
       });
     });
+
+    test('events come from the platform', () {
+      const events = [
+        MediaKeyEvent(
+          key: MediaKey.rewind,
+          action: MediaKeyAction.press,
+          timestamp: Duration(seconds: 1),
+        ),
+      ];
+      when(() => mediaKeyDetectorPlatform.events).thenAnswer((_) => Stream.value(events));
+
+      expect(mediaKeyDetector.events, emits(events));
+    });
+
+    test('gamepads come from the platform', () async {
+      const connection = GamepadConnectionEvent(
+        gamepad: NativeGamepad(
+          device: 5,
+          name: 'Pad',
+          vendorId: 0x045e,
+          productId: 0x028e,
+        ),
+        connected: true,
+      );
+      when(() => mediaKeyDetectorPlatform.supportsGamepads).thenReturn(true);
+      when(() => mediaKeyDetectorPlatform.gamepadConnections)
+          .thenAnswer((_) => Stream.value(connection));
+      when(
+        () => mediaKeyDetectorPlatform.setUseGamepads(useGamepads: true),
+      ).thenAnswer((_) async {});
+
+      expect(mediaKeyDetector.supportsGamepads, isTrue);
+      expect(mediaKeyDetector.gamepadConnections, emits(connection));
+      await mediaKeyDetector.setUseGamepads(useGamepads: true);
+      verify(
+        () => mediaKeyDetectorPlatform.setUseGamepads(useGamepads: true),
+      ).called(1);
+    });
   });
 }
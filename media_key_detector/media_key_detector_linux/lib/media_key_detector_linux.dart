@@ -1 +1,2 @@
+export 'src/hid_button_event.dart';
 export 'src/media_key_detector_linux.dart';
@@ -0,0 +1,116 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// A button of an HID device, read from `/dev/hidrawN`, that was pressed or
+/// released.
+@immutable
+class HidButtonEvent {
+  /// Creates an event.
+  const HidButtonEvent({
+    required this.device,
+    required this.usage,
+    required this.pressed,
+    required this.timestamp,
+  });
+
+  /// N of the `/dev/hidrawN` node the button belongs to.
+  final int device;
+
+  /// Usage page in the upper and usage ID in the lower 16 bits, e.g.
+  /// `0x000C00CD` for Consumer / Play/Pause.
+  final int usage;
+
+  /// Whether the button went down rather than up.
+  final bool pressed;
+
+  /// When the report was read, on the clock of `Timeline.now`.
+  final Duration timestamp;
+
+  /// The usage page, e.g. 0x09 for buttons and 0x0C for consumer controls.
+  int get usagePage => usage >> 16;
+
+  /// The usage ID within [usagePage], e.g. the button number.
+  int get usageId => usage & 0xFFFF;
+
+  /// Decodes the (device, usage, pressed, timestamp) quadruples sent by the
+  /// plugin.
+  static List<HidButtonEvent> decodeBatch(Int64List values) {
+    if (values.length % 4 != 0) {
+      throw FormatException('HID button events come in quadruples, got ${values.length} values');
+    }
+    return [
+      for (var i = 0; i < values.length; i += 4)
+        HidButtonEvent(
+          device: values[i],
+          usage: values[i + 1],
+          pressed: values[i + 2] != 0,
+          timestamp: Duration(microseconds: values[i + 3]),
+        ),
+    ];
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is HidButtonEvent &&
+      other.device == device &&
+      other.usage == usage &&
+      other.pressed == pressed &&
+      other.timestamp == timestamp;
+
+  @override
+  int get hashCode => Object.hash(device, usage, pressed, timestamp);
+
+  @override
+  String toString() =>
+      'HidButtonEvent(hidraw$device, 0x${usage.toRadixString(16).padLeft(8, '0')}, '
+      '${pressed ? 'pressed' : 'released'}, $timestamp)';
+}
+
+/// An HID device whose buttons are read.
+@immutable
+class HidrawDevice {
+  /// Creates a device description.
+  const HidrawDevice({
+    required this.device,
+    required this.name,
+    required this.vendorId,
+    required this.productId,
+  });
+
+  /// Reads the map sent by the plugin.
+  factory HidrawDevice.fromMap(Map<Object?, Object?> map) {
+    return HidrawDevice(
+      device: map['device']! as int,
+      name: map['name']! as String,
+      vendorId: map['vendorId']! as int,
+      productId: map['productId']! as int,
+    );
+  }
+
+  /// N of its `/dev/hidrawN` node, as in [HidButtonEvent.device].
+  final int device;
+
+  /// The name the device reports.
+  final String name;
+
+  /// USB or Bluetooth vendor ID.
+  final int vendorId;
+
+  /// USB or Bluetooth product ID.
+  final int productId;
+
+  @override
+  bool operator ==(Object other) =>
+      other is HidrawDevice &&
+      other.device == device &&
+      other.name == name &&
+      other.vendorId == vendorId &&
+      other.productId == productId;
+
+  @override
+  int get hashCode => Object.hash(device, name, vendorId, productId);
+
+  @override
+  String toString() => 'HidrawDevice(hidraw$device, $name, $vendorId:$productId)';
+}
@@ -1,10 +1,30 @@
+import 'dart:typed_data';
+
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
+import 'package:media_key_detector_linux/src/hid_button_event.dart';
 import 'package:media_key_detector_platform_interface/media_key_detector_platform_interface.dart';
 
 /// The Linux implementation of [MediaKeyDetectorPlatform].
+///
+/// While playing, the plugin receives media keys over D-Bus, as an MPRIS
+/// player and from the GNOME settings daemon, so they arrive while the app is
+/// in the background. With [setUseEvdev] it reads the input devices
+/// directly instead, which also reports releases. Either way the keys arrive
+/// in batches with their timing, see [events].
+///
+/// Separately, [setUseHidraw] reads the buttons of HID clickers and remotes
+/// whose buttons have no key code, see [hidButtonEvents], and
+/// [setUseGamepads] reads gamepads, see [gamepadButtonEvents].
 class MediaKeyDetectorLinux extends MediaKeyDetectorPlatform {
   bool _isPlaying = false;
+  final _eventChannel = const EventChannel('media_key_detector_linux_events');
+  final _hidEventChannel = const EventChannel('media_key_detector_linux_hid_events');
+  Stream<List<HidButtonEvent>>? _hidButtonEvents;
+  final _gamepadEventChannel = const EventChannel('media_key_detector_linux_gamepad_events');
+  final _gamepadChannel = const EventChannel('media_key_detector_linux_gamepads');
+  Stream<List<GamepadButtonEvent>>? _gamepadButtonEvents;
+  Stream<GamepadConnectionEvent>? _gamepadConnections;
 
   /// The method channel used to interact with the native platform.
   @visibleForTesting
@@ -17,7 +37,104 @@ class MediaKeyDetectorLinux extends MediaKeyDetectorPlatform {
 
   @override
   void initialize() {
-    ServicesBinding.instance.keyboard.addHandler(defaultHandler);
+    _eventChannel.receiveBroadcastStream().listen((batch) => handleEventBatch(batch as Uint8List));
+    // The desktop keeps the volume keys for itself, so they only arrive as
+    // key events while the app is focused.
+    ServicesBinding.instance.keyboard.addHandler(_volumeKeyHandler);
+  }
+
+  /// Reads media keys straight from `/dev/input` while playing, instead of
+  /// receiving them through the desktop. Faster, and works without a
+  /// desktop, but needs read access to the input devices, usually through
+  /// membership of the `input` group.
+  Future<void> setUseEvdev({required bool useEvdev}) async {
+    await methodChannel.invokeMethod<void>('setUseEvdev', <String, dynamic>{'useEvdev': useEvdev});
+  }
+
+  /// Collects the media keys of [window] into one batch before sending them,
+  /// to save platform messages on bursts. Zero, the default, sends them as
+  /// soon as the platform thread gets to it.
+  Future<void> setBatchWindow(Duration window) async {
+    await methodChannel.invokeMethod<void>('setBatchWindow', <String, dynamic>{'milliseconds': window.inMilliseconds});
+  }
+
+  /// Reads the buttons of the HID devices in `/dev/hidraw*`, including ones
+  /// plugged in later, whether or not the app is playing. Keyboards and mice
+  /// are left alone. Needs read access to the hidraw nodes, usually granted
+  /// by a udev rule. Throws a [PlatformException] if `/dev` cannot be watched.
+  Future<void> setUseHidraw({required bool useHidraw}) async {
+    await methodChannel.invokeMethod<void>('setUseHidraw', <String, dynamic>{'useHidraw': useHidraw});
+  }
+
+  /// The HID devices whose buttons are read.
+  Future<List<HidrawDevice>> getHidDevices() async {
+    final devices = await methodChannel.invokeListMethod<Map<Object?, Object?>>('getHidDevices');
+    return [for (final device in devices ?? const <Map<Object?, Object?>>[]) HidrawDevice.fromMap(device)];
+  }
+
+  /// Button presses and releases of HID devices, in batches as they were
+  /// read, while [setUseHidraw] is on.
+  Stream<List<HidButtonEvent>> get hidButtonEvents {
+    return _hidButtonEvents ??= _hidEventChannel
+        .receiveBroadcastStream()
+        .map((batch) => HidButtonEvent.decodeBatch(batch as Int64List));
+  }
+
+  @override
+  bool get supportsGamepads => true;
+
+  /// Reads the gamepads in `/dev/input`, including ones that connect later,
+  /// whether or not the app is playing. Needs read access to their event
+  /// nodes. Throws a [PlatformException] if `/dev/input` cannot be watched.
+  @override
+  Future<void> setUseGamepads({required bool useGamepads}) async {
+    await methodChannel.invokeMethod<void>('setUseGamepads', <String, dynamic>{'useGamepads': useGamepads});
+  }
+
+  /// Sets how far sticks and triggers have to move, as a fraction of their
+  /// travel. Movement within [deadzone] is ignored and the rest is rescaled
+  /// to the full range. A direction is pressed from [pressThreshold] of that
+  /// range on and released below [releaseThreshold]. Open gamepads are
+  /// reopened with the new values.
+  Future<void> setGamepadOptions({double? deadzone, double? pressThreshold, double? releaseThreshold}) async {
+    await methodChannel.invokeMethod<void>('setGamepadOptions', <String, dynamic>{
+      if (deadzone != null) 'deadzone': deadzone,
+      if (pressThreshold != null) 'pressThreshold': pressThreshold,
+      if (releaseThreshold != null) 'releaseThreshold': releaseThreshold,
+    });
+  }
+
+  /// The gamepads being read.
+  Future<List<NativeGamepad>> getGamepads() async {
+    final gamepads = await methodChannel.invokeListMethod<Map<Object?, Object?>>('getGamepads');
+    return [for (final gamepad in gamepads ?? const <Map<Object?, Object?>>[]) NativeGamepad.fromMap(gamepad)];
+  }
+
+  /// Gamepad button presses and releases, in batches as they were read,
+  /// while [setUseGamepads] is on. Sticks only report when they enter or
+  /// leave a direction.
+  @override
+  Stream<List<GamepadButtonEvent>> get gamepadButtonEvents {
+    return _gamepadButtonEvents ??= _gamepadEventChannel
+        .receiveBroadcastStream()
+        .map((batch) => GamepadButtonEvent.decodeBatch(batch as Int64List));
+  }
+
+  /// Gamepads that connect or disconnect while [setUseGamepads] is on,
+  /// including the ones found when it is turned on.
+  @override
+  Stream<GamepadConnectionEvent> get gamepadConnections {
+    return _gamepadConnections ??= _gamepadChannel
+        .receiveBroadcastStream()
+        .map((event) => GamepadConnectionEvent.fromMap(event as Map<Object?, Object?>));
+  }
+
+  bool _volumeKeyHandler(KeyEvent event) {
+    if (event.logicalKey == LogicalKeyboardKey.audioVolumeUp ||
+        event.logicalKey == LogicalKeyboardKey.audioVolumeDown) {
+      return defaultHandler(event);
+    }
+    return false;
   }
 
   @override
@@ -27,11 +144,13 @@ class MediaKeyDetectorLinux extends MediaKeyDetectorPlatform {
 
   @override
   Future<bool> getIsPlaying() async {
-    return _isPlaying;
+    final isPlaying = await methodChannel.invokeMethod<bool>('getIsPlaying');
+    return isPlaying ?? _isPlaying;
   }
 
   @override
   Future<void> setIsPlaying({required bool isPlaying}) async {
     _isPlaying = isPlaying;
+    await methodChannel.invokeMethod<void>('setIsPlaying', <String, dynamic>{'isPlaying': isPlaying});
   }
 }
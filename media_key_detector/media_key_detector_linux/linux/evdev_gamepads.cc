@@ -0,0 +1,389 @@
+#include "evdev_gamepads.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace media_key_detector_linux {
+
+using media_key_detector_core::GamepadAxisRange;
+using media_key_detector_core::GamepadEdge;
+using media_key_detector_core::GamepadState;
+using media_key_detector_core::kGamepadAxisCount;
+using media_key_detector_core::kGamepadButtonCount;
+
+namespace {
+
+constexpr int kMaxReadyEvents = 16;
+constexpr size_t kKeyBitsSize = KEY_CNT / 8;
+constexpr size_t kAbsBitsSize = ABS_CNT / 8;
+static_assert(KEY_CNT <= kGamepadButtonCount, "key codes must fit the button IDs");
+static_assert(ABS_CNT <= kGamepadAxisCount, "axis codes must fit the axis IDs");
+
+bool TestBit(const uint8_t* bits, size_t size, uint16_t code) {
+  return code / 8u < size && (bits[code / 8] & (1u << (code % 8))) != 0;
+}
+
+int64_t TimestampUs(const input_event& event) {
+  return static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec;
+}
+
+int64_t MonotonicNowUs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+bool AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// Reads the buttons |fd| holds and the values of |axes|. Returns false if it
+// is no evdev node.
+bool ReadState(int fd, const std::vector<uint16_t>& axes, std::vector<uint16_t>* buttons,
+               std::vector<std::pair<uint16_t, int32_t>>* values) {
+  uint8_t bits[kKeyBitsSize] = {};
+  if (ioctl(fd, EVIOCGKEY(sizeof(bits)), bits) < 0) {
+    return false;
+  }
+  for (uint16_t code = 0; code < KEY_CNT; code++) {
+    if (TestBit(bits, sizeof(bits), code)) {
+      buttons->push_back(code);
+    }
+  }
+  for (uint16_t axis : axes) {
+    input_absinfo info = {};
+    if (ioctl(fd, EVIOCGABS(axis), &info) < 0) {
+      return false;
+    }
+    values->emplace_back(axis, info.value);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool HasGamepadButtons(const uint8_t* key_bits, size_t size) {
+  // BTN_JOYSTICK up to BTN_THUMBR covers joysticks, wheels and gamepads.
+  for (uint16_t code = BTN_JOYSTICK; code <= BTN_THUMBR; code++) {
+    if (TestBit(key_bits, size, code)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+EvdevGamepadDecoder::EvdevGamepadDecoder(uint16_t device,
+                                         const GamepadDescription& description,
+                                         GamepadState::Options options)
+    : device_(device), state_(options) {
+  for (const auto& axis : description.axes) {
+    state_.SetAxisRange(axis.first, axis.second);
+    axes_.push_back(axis.first);
+  }
+}
+
+bool EvdevGamepadDecoder::Decode(const input_event& event, std::vector<GamepadEvent>* events) {
+  if (event.type == EV_SYN) {
+    if (event.code == SYN_DROPPED) {
+      dropping_ = true;
+    } else if (event.code == SYN_REPORT && dropping_) {
+      dropping_ = false;
+      return true;
+    }
+    return false;
+  }
+  if (dropping_) {
+    return false;
+  }
+  edges_.clear();
+  if (event.type == EV_KEY) {
+    state_.OnButton(event.code, event.value, TimestampUs(event), &edges_);
+  } else if (event.type == EV_ABS) {
+    state_.OnAxis(event.code, event.value, TimestampUs(event), &edges_);
+  }
+  Append(events);
+  return false;
+}
+
+void EvdevGamepadDecoder::Resync(const std::vector<uint16_t>* buttons,
+                                 const std::vector<std::pair<uint16_t, int32_t>>* axes,
+                                 int64_t timestamp_us, std::vector<GamepadEvent>* events) {
+  edges_.clear();
+  if (buttons == nullptr || axes == nullptr) {
+    state_.Reset(timestamp_us, &edges_);
+    Append(events);
+    return;
+  }
+  for (uint16_t code = 0; code < KEY_CNT; code++) {
+    bool held = std::find(buttons->begin(), buttons->end(), code) != buttons->end();
+    if (held != state_.button_held(code)) {
+      state_.OnButton(code, held ? 1 : 0, timestamp_us, &edges_);
+    }
+  }
+  for (const auto& axis : *axes) {
+    state_.OnAxis(axis.first, axis.second, timestamp_us, &edges_);
+  }
+  Append(events);
+}
+
+void EvdevGamepadDecoder::Reset(int64_t timestamp_us, std::vector<GamepadEvent>* events) {
+  edges_.clear();
+  state_.Reset(timestamp_us, &edges_);
+  Append(events);
+}
+
+void EvdevGamepadDecoder::Append(std::vector<GamepadEvent>* events) {
+  for (const GamepadEdge& edge : edges_) {
+    events->push_back({device_, edge.button, edge.pressed, edge.timestamp_us});
+  }
+}
+
+EvdevGamepadReader::EvdevGamepadReader(Callback callback, HotplugCallback hotplug_callback,
+                                       GamepadState::Options options, std::string directory,
+                                       DeviceProbe probe)
+    : callback_(std::move(callback)),
+      hotplug_callback_(std::move(hotplug_callback)),
+      options_(options),
+      directory_(std::move(directory)),
+      probe_(std::move(probe)) {}
+
+EvdevGamepadReader::~EvdevGamepadReader() {
+  Stop();
+}
+
+bool EvdevGamepadReader::ProbeGamepad(int fd, GamepadDescription* description) {
+  uint8_t key_bits[kKeyBitsSize] = {};
+  int size = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+  if (size <= 0 || !HasGamepadButtons(key_bits, size)) {
+    return false;
+  }
+
+  char name[256] = {};
+  if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) > 0) {
+    description->name = name;
+  }
+  input_id id = {};
+  if (ioctl(fd, EVIOCGID, &id) == 0) {
+    description->vendor_id = id.vendor;
+    description->product_id = id.product;
+  }
+  uint8_t abs_bits[kAbsBitsSize] = {};
+  size = ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+  for (uint16_t axis = 0; size > 0 && axis < ABS_CNT; axis++) {
+    input_absinfo info = {};
+    if (TestBit(abs_bits, size, axis) && ioctl(fd, EVIOCGABS(axis), &info) == 0) {
+      description->axes.emplace_back(
+          axis, GamepadAxisRange{info.minimum, info.maximum, info.flat, info.value});
+    }
+  }
+  return true;
+}
+
+bool EvdevGamepadReader::Start() {
+  if (thread_.joinable()) {
+    return true;
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  // New nodes are created by root and made readable by udev afterwards.
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || inotify_fd_ < 0 ||
+      inotify_add_watch(inotify_fd_, directory_.c_str(), IN_CREATE | IN_ATTRIB) < 0 ||
+      !AddToEpoll(epoll_fd_, stop_fd_) || !AddToEpoll(epoll_fd_, inotify_fd_)) {
+    Stop();
+    return false;
+  }
+
+  // Watch before listing, so no device that appears meanwhile is missed.
+  DIR* dir = opendir(directory_.c_str());
+  if (dir != nullptr) {
+    while (dirent* entry = readdir(dir)) {
+      AddDevice(entry->d_name);
+    }
+    closedir(dir);
+  }
+
+  thread_ = std::thread(&EvdevGamepadReader::Run, this);
+  return true;
+}
+
+void EvdevGamepadReader::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  for (auto& entry : devices_) {
+    close(entry.first);
+  }
+  devices_.clear();
+  {
+    std::lock_guard<std::mutex> lock(infos_mutex_);
+    infos_.clear();
+  }
+  CloseFd(&inotify_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+}
+
+std::vector<GamepadInfo> EvdevGamepadReader::Devices() const {
+  std::lock_guard<std::mutex> lock(infos_mutex_);
+  return infos_;
+}
+
+void EvdevGamepadReader::Run() {
+  epoll_event ready[kMaxReadyEvents];
+  std::vector<GamepadEvent> events;
+  while (true) {
+    int count = epoll_wait(epoll_fd_, ready, kMaxReadyEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      int fd = ready[i].data.fd;
+      if (fd == stop_fd_) {
+        return;
+      }
+      if (fd == inotify_fd_) {
+        ReadInotify();
+        continue;
+      }
+      auto device = devices_.find(fd);
+      if (device != devices_.end() && !ReadDevice(&device->second, &events)) {
+        RemoveDevice(fd, &events);
+      }
+    }
+    // Everything read in one wakeup goes out together.
+    if (!events.empty()) {
+      callback_(events);
+      events.clear();
+    }
+  }
+}
+
+void EvdevGamepadReader::AddDevice(const char* name) {
+  if (strncmp(name, "event", 5) != 0) {
+    return;
+  }
+  for (const auto& entry : devices_) {
+    if (entry.second.name == name) {
+      return;
+    }
+  }
+
+  std::string path = directory_ + "/" + name;
+  int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  // Without access yet, IN_ATTRIB brings us back once udev granted it.
+  if (fd < 0) {
+    return;
+  }
+  GamepadDescription description;
+  if (!probe_(fd, &description) || !AddToEpoll(epoll_fd_, fd)) {
+    close(fd);
+    return;
+  }
+  // Timestamps on the clock of Dart's Timeline, for latency measurements.
+  int clock = CLOCK_MONOTONIC;
+  ioctl(fd, EVIOCSCLOCKID, &clock);
+  auto number = static_cast<uint16_t>(strtoul(name + 5, nullptr, 10));
+  GamepadInfo info = {number, description.name, description.vendor_id, description.product_id};
+  devices_.emplace(fd, Device{fd, name, info, EvdevGamepadDecoder(number, description, options_)});
+  {
+    std::lock_guard<std::mutex> lock(infos_mutex_);
+    infos_.push_back(info);
+  }
+  hotplug_callback_(info, true);
+}
+
+void EvdevGamepadReader::RemoveDevice(int fd, std::vector<GamepadEvent>* events) {
+  auto device = devices_.find(fd);
+  device->second.decoder.Reset(MonotonicNowUs(), events);
+  GamepadInfo info = device->second.info;
+  {
+    std::lock_guard<std::mutex> lock(infos_mutex_);
+    auto removed = [&](const GamepadInfo& entry) { return entry.device == info.device; };
+    infos_.erase(std::remove_if(infos_.begin(), infos_.end(), removed), infos_.end());
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  devices_.erase(device);
+  // The releases go out before the disconnection.
+  if (!events->empty()) {
+    callback_(*events);
+    events->clear();
+  }
+  hotplug_callback_(info, false);
+}
+
+void EvdevGamepadReader::ReadInotify() {
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t size = read(inotify_fd_, buffer, sizeof(buffer));
+    if (size <= 0) {
+      return;
+    }
+    for (char* position = buffer; position < buffer + size;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(position);
+      if (event->len > 0) {
+        AddDevice(event->name);
+      }
+      position += sizeof(inotify_event) + event->len;
+    }
+  }
+}
+
+bool EvdevGamepadReader::ReadDevice(Device* device, std::vector<GamepadEvent>* events) {
+  input_event buffer[64];
+  while (true) {
+    ssize_t size = read(device->fd, buffer, sizeof(buffer));
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // ENODEV once the device was unplugged.
+      return errno == EAGAIN;
+    }
+    // End of file: only seen with the pipes used in tests.
+    if (size == 0) {
+      return false;
+    }
+    size_t count = static_cast<size_t>(size) / sizeof(input_event);
+    for (size_t i = 0; i < count; i++) {
+      if (device->decoder.Decode(buffer[i], events)) {
+        std::vector<uint16_t> buttons;
+        std::vector<std::pair<uint16_t, int32_t>> axes;
+        bool known = ReadState(device->fd, device->decoder.axes(), &buttons, &axes);
+        device->decoder.Resync(known ? &buttons : nullptr, known ? &axes : nullptr,
+                               TimestampUs(buffer[i]), events);
+      }
+    }
+  }
+}
+
+}  // namespace media_key_detector_linux
@@ -0,0 +1,184 @@
+#ifndef MEDIA_KEY_DETECTOR_LINUX_EVDEV_GAMEPADS_H_
+#define MEDIA_KEY_DETECTOR_LINUX_EVDEV_GAMEPADS_H_
+
+#include <linux/input.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "media_key_detector_core/gamepad_state.h"
+
+namespace media_key_detector_linux {
+
+// A gamepad button, or axis direction, that was pressed or released. See
+// gamepad_state.h for the button IDs.
+struct GamepadEvent {
+  // N of the /dev/input/eventN node the event was read from.
+  uint16_t device;
+  uint32_t button;
+  bool pressed;
+  // When the kernel saw the event, on CLOCK_MONOTONIC like Dart's
+  // Timeline.now.
+  int64_t timestamp_us;
+
+  bool operator==(const GamepadEvent& other) const {
+    return device == other.device && button == other.button && pressed == other.pressed &&
+           timestamp_us == other.timestamp_us;
+  }
+};
+
+// What a gamepad node tells about itself when it is opened.
+struct GamepadDescription {
+  std::string name;
+  uint16_t vendor_id = 0;
+  uint16_t product_id = 0;
+  // The axes it has, by evdev code, with their current value as resting
+  // position.
+  std::vector<std::pair<uint16_t, media_key_detector_core::GamepadAxisRange>> axes;
+};
+
+struct GamepadInfo {
+  uint16_t device;
+  std::string name;
+  uint16_t vendor_id;
+  uint16_t product_id;
+};
+
+// Whether a device with the EV_KEY capability bits |key_bits| (as returned by
+// EVIOCGBIT(EV_KEY)) has the buttons of a gamepad or joystick.
+bool HasGamepadButtons(const uint8_t* key_bits, size_t size);
+
+// Turns the input_events of one gamepad into button edges.
+class EvdevGamepadDecoder {
+ public:
+  EvdevGamepadDecoder(uint16_t device,
+                      const GamepadDescription& description,
+                      media_key_detector_core::GamepadState::Options options);
+
+  // Appends the edges caused by |event| to |events|. Returns true for the
+  // SYN_REPORT that ends a gap of events dropped by the kernel, after which
+  // the device state has to be read back with Resync().
+  bool Decode(const input_event& event, std::vector<GamepadEvent>* events);
+
+  // Reports what changed while events were dropped, given the |buttons| held
+  // and the values of the |axes| now. Without them, everything counts as
+  // released.
+  void Resync(const std::vector<uint16_t>* buttons,
+              const std::vector<std::pair<uint16_t, int32_t>>* axes,
+              int64_t timestamp_us,
+              std::vector<GamepadEvent>* events);
+
+  // Releases everything held.
+  void Reset(int64_t timestamp_us, std::vector<GamepadEvent>* events);
+
+  // Codes of the declared axes.
+  const std::vector<uint16_t>& axes() const { return axes_; }
+
+ private:
+  void Append(std::vector<GamepadEvent>* events);
+
+  uint16_t device_;
+  media_key_detector_core::GamepadState state_;
+  std::vector<uint16_t> axes_;
+  // Scratch space for the core's edges.
+  std::vector<media_key_detector_core::GamepadEdge> edges_;
+  bool dropping_ = false;
+};
+
+// Reads gamepads straight from /dev/input/event* on a thread of its own,
+// which sleeps in epoll_wait() between events. Only button and axis
+// direction changes are reported; axis motion within a direction is not.
+// Gamepads that are plugged in or connect later are picked up through
+// inotify, so nobody has to poll for them.
+//
+// Reading evdev nodes needs read access to them, usually through membership
+// of the "input" group, or the uaccess tag udev gives to joysticks.
+class EvdevGamepadReader {
+ public:
+  // Called on the reader thread with the events of one wakeup, in order.
+  using Callback = std::function<void(const std::vector<GamepadEvent>& events)>;
+  // Called on the reader thread when a gamepad connects or disconnects.
+  using HotplugCallback = std::function<void(const GamepadInfo& info, bool connected)>;
+  // Fills in |description| if the opened node |fd| is a gamepad.
+  using DeviceProbe = std::function<bool(int fd, GamepadDescription* description)>;
+
+  static constexpr const char* kInputDirectory = "/dev/input";
+
+  // By default reads the gamepads in kInputDirectory.
+  EvdevGamepadReader(Callback callback,
+                     HotplugCallback hotplug_callback,
+                     media_key_detector_core::GamepadState::Options options = {},
+                     std::string directory = kInputDirectory,
+                     DeviceProbe probe = ProbeGamepad);
+  ~EvdevGamepadReader();
+
+  // Disallow copy and assign.
+  EvdevGamepadReader(const EvdevGamepadReader&) = delete;
+  EvdevGamepadReader& operator=(const EvdevGamepadReader&) = delete;
+
+  // Opens the gamepads and starts the thread. Returns false if |directory|
+  // cannot be watched. Gamepads found meanwhile are reported as connected
+  // before this returns.
+  bool Start();
+
+  // Stops the thread and closes the devices. Called automatically on
+  // destruction. No callback runs once this returns, not even for the
+  // gamepads that are closed.
+  void Stop();
+
+  // Takes effect from the next Start().
+  void set_options(media_key_detector_core::GamepadState::Options options) { options_ = options; }
+
+  // The gamepads being read. Can be called from any thread.
+  std::vector<GamepadInfo> Devices() const;
+
+  static bool ProbeGamepad(int fd, GamepadDescription* description);
+
+ private:
+  struct Device {
+    int fd;
+    // File name in directory_.
+    std::string name;
+    GamepadInfo info;
+    EvdevGamepadDecoder decoder;
+  };
+
+  void Run();
+
+  // Opens |name| in directory_ if it is a gamepad that is not open yet.
+  void AddDevice(const char* name);
+  // Releases what |fd| still held into |events| and closes it.
+  void RemoveDevice(int fd, std::vector<GamepadEvent>* events);
+
+  void ReadInotify();
+
+  // Drains |device| into |events|. Returns false once the device is gone.
+  bool ReadDevice(Device* device, std::vector<GamepadEvent>* events);
+
+  Callback callback_;
+  HotplugCallback hotplug_callback_;
+  media_key_detector_core::GamepadState::Options options_;
+  std::string directory_;
+  DeviceProbe probe_;
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int inotify_fd_ = -1;
+  // Open devices by fd. Only used on the reader thread once started.
+  std::unordered_map<int, Device> devices_;
+
+  mutable std::mutex infos_mutex_;
+  std::vector<GamepadInfo> infos_;
+
+  std::thread thread_;
+};
+
+}  // namespace media_key_detector_linux
+
+#endif  // MEDIA_KEY_DETECTOR_LINUX_EVDEV_GAMEPADS_H_
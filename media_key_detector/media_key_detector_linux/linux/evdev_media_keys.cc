@@ -0,0 +1,298 @@
+#include "evdev_media_keys.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace media_key_detector_linux {
+
+namespace {
+
+struct CodeMapping {
+  uint16_t code;
+  MediaKeyIndex key;
+};
+
+// Play, pause and stop are toggles like on Windows: we do not know the
+// trainer app's state.
+constexpr CodeMapping kCodeMappings[] = {
+    {KEY_PLAYPAUSE, MEDIA_KEY_PLAY_PAUSE},    {KEY_PLAYCD, MEDIA_KEY_PLAY_PAUSE},
+    {KEY_PAUSECD, MEDIA_KEY_PLAY_PAUSE},      {KEY_PLAY, MEDIA_KEY_PLAY_PAUSE},
+    {KEY_STOPCD, MEDIA_KEY_PLAY_PAUSE},       {KEY_PREVIOUSSONG, MEDIA_KEY_REWIND},
+    {KEY_REWIND, MEDIA_KEY_REWIND},           {KEY_NEXTSONG, MEDIA_KEY_FAST_FORWARD},
+    {KEY_FASTFORWARD, MEDIA_KEY_FAST_FORWARD}, {KEY_VOLUMEUP, MEDIA_KEY_VOLUME_UP},
+    {KEY_VOLUMEDOWN, MEDIA_KEY_VOLUME_DOWN},
+};
+
+constexpr int kMaxReadyEvents = 16;
+constexpr size_t kKeyBitsSize = KEY_CNT / 8;
+
+bool TestBit(const uint8_t* bits, size_t size, uint16_t code) {
+  return code / 8u < size && (bits[code / 8] & (1u << (code % 8))) != 0;
+}
+
+int64_t TimestampUs(const input_event& event) {
+  return static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec;
+}
+
+bool AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// Reads the keys |fd| holds down. Returns false if it is no evdev node.
+bool ReadHeldKeys(int fd, EvdevKeyDecoder::KeyBits* held) {
+  uint8_t bits[kKeyBitsSize] = {};
+  if (ioctl(fd, EVIOCGKEY(sizeof(bits)), bits) < 0) {
+    return false;
+  }
+  for (uint16_t code = 0; code < KEY_CNT; code++) {
+    (*held)[code] = TestBit(bits, sizeof(bits), code);
+  }
+  return true;
+}
+
+}  // namespace
+
+int MediaKeyForEvdevCode(uint16_t code) {
+  for (const CodeMapping& mapping : kCodeMappings) {
+    if (mapping.code == code) {
+      return mapping.key;
+    }
+  }
+  return -1;
+}
+
+bool HasMediaKeys(const uint8_t* key_bits, size_t size) {
+  for (const CodeMapping& mapping : kCodeMappings) {
+    if (TestBit(key_bits, size, mapping.code)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool EvdevKeyDecoder::Decode(const input_event& event, std::vector<MediaKeyEvent>* events) {
+  if (event.type == EV_SYN) {
+    if (event.code == SYN_DROPPED) {
+      dropping_ = true;
+    } else if (event.code == SYN_REPORT && dropping_) {
+      dropping_ = false;
+      return true;
+    }
+    return false;
+  }
+  // A value of 2 is an autorepeat.
+  if (!dropping_ && event.type == EV_KEY && event.value != 2) {
+    SetHeld(event.code, event.value != 0, TimestampUs(event), events);
+  }
+  return false;
+}
+
+void EvdevKeyDecoder::Resync(const KeyBits* held, int64_t timestamp_us,
+                             std::vector<MediaKeyEvent>* events) {
+  for (const CodeMapping& mapping : kCodeMappings) {
+    SetHeld(mapping.code, held != nullptr && (*held)[mapping.code], timestamp_us, events);
+  }
+}
+
+void EvdevKeyDecoder::SetHeld(uint16_t code, bool pressed, int64_t timestamp_us,
+                              std::vector<MediaKeyEvent>* events) {
+  int key = MediaKeyForEvdevCode(code);
+  // Also drops releases of keys that were held before the device was opened.
+  if (key < 0 || held_[code] == pressed) {
+    return;
+  }
+  held_[code] = pressed;
+  events->push_back({static_cast<MediaKeyIndex>(key), pressed, timestamp_us, device_});
+}
+
+EvdevMediaKeyReader::EvdevMediaKeyReader(Callback callback, std::string directory,
+                                         DeviceFilter filter)
+    : callback_(std::move(callback)),
+      directory_(std::move(directory)),
+      filter_(std::move(filter)) {}
+
+EvdevMediaKeyReader::~EvdevMediaKeyReader() {
+  Stop();
+}
+
+bool EvdevMediaKeyReader::Start() {
+  if (thread_.joinable()) {
+    return true;
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  // New nodes are created by root and made readable by udev afterwards.
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || inotify_fd_ < 0 ||
+      inotify_add_watch(inotify_fd_, directory_.c_str(), IN_CREATE | IN_ATTRIB) < 0 ||
+      !AddToEpoll(epoll_fd_, stop_fd_) || !AddToEpoll(epoll_fd_, inotify_fd_)) {
+    Stop();
+    return false;
+  }
+
+  // Watch before listing, so no device that appears meanwhile is missed.
+  DIR* dir = opendir(directory_.c_str());
+  if (dir != nullptr) {
+    while (dirent* entry = readdir(dir)) {
+      AddDevice(entry->d_name);
+    }
+    closedir(dir);
+  }
+
+  thread_ = std::thread(&EvdevMediaKeyReader::Run, this);
+  return true;
+}
+
+void EvdevMediaKeyReader::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  for (auto& entry : devices_) {
+    close(entry.first);
+  }
+  devices_.clear();
+  CloseFd(&inotify_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+}
+
+bool EvdevMediaKeyReader::IsMediaKeyDevice(int fd) {
+  uint8_t bits[kKeyBitsSize] = {};
+  int size = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(bits)), bits);
+  return size > 0 && HasMediaKeys(bits, size);
+}
+
+void EvdevMediaKeyReader::Run() {
+  epoll_event ready[kMaxReadyEvents];
+  std::vector<MediaKeyEvent> events;
+  while (true) {
+    int count = epoll_wait(epoll_fd_, ready, kMaxReadyEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      int fd = ready[i].data.fd;
+      if (fd == stop_fd_) {
+        return;
+      }
+      if (fd == inotify_fd_) {
+        ReadInotify();
+        continue;
+      }
+      auto device = devices_.find(fd);
+      if (device != devices_.end() && !ReadDevice(&device->second, &events)) {
+        RemoveDevice(fd);
+      }
+    }
+    // Everything read in one wakeup goes out together.
+    if (!events.empty()) {
+      callback_(events);
+      events.clear();
+    }
+  }
+}
+
+void EvdevMediaKeyReader::AddDevice(const char* name) {
+  if (strncmp(name, "event", 5) != 0) {
+    return;
+  }
+  for (const auto& entry : devices_) {
+    if (entry.second.name == name) {
+      return;
+    }
+  }
+
+  std::string path = directory_ + "/" + name;
+  int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  // Without access yet, IN_ATTRIB brings us back once udev granted it.
+  if (fd < 0) {
+    return;
+  }
+  if (!filter_(fd) || !AddToEpoll(epoll_fd_, fd)) {
+    close(fd);
+    return;
+  }
+  // Timestamps on the clock of Dart's Timeline, for latency measurements.
+  int clock = CLOCK_MONOTONIC;
+  ioctl(fd, EVIOCSCLOCKID, &clock);
+  auto device = static_cast<uint16_t>(strtoul(name + 5, nullptr, 10));
+  devices_.emplace(fd, Device{fd, name, EvdevKeyDecoder(device)});
+}
+
+void EvdevMediaKeyReader::RemoveDevice(int fd) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  devices_.erase(fd);
+}
+
+void EvdevMediaKeyReader::ReadInotify() {
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t size = read(inotify_fd_, buffer, sizeof(buffer));
+    if (size <= 0) {
+      return;
+    }
+    for (char* position = buffer; position < buffer + size;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(position);
+      if (event->len > 0) {
+        AddDevice(event->name);
+      }
+      position += sizeof(inotify_event) + event->len;
+    }
+  }
+}
+
+bool EvdevMediaKeyReader::ReadDevice(Device* device, std::vector<MediaKeyEvent>* events) {
+  input_event buffer[64];
+  while (true) {
+    ssize_t size = read(device->fd, buffer, sizeof(buffer));
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // ENODEV once the device was unplugged.
+      return errno == EAGAIN;
+    }
+    // End of file: only seen with the pipes used in tests.
+    if (size == 0) {
+      return false;
+    }
+    size_t count = static_cast<size_t>(size) / sizeof(input_event);
+    for (size_t i = 0; i < count; i++) {
+      if (device->decoder.Decode(buffer[i], events)) {
+        EvdevKeyDecoder::KeyBits held;
+        bool known = ReadHeldKeys(device->fd, &held);
+        device->decoder.Resync(known ? &held : nullptr, TimestampUs(buffer[i]), events);
+      }
+    }
+  }
+}
+
+}  // namespace media_key_detector_linux
@@ -0,0 +1,141 @@
+#ifndef MEDIA_KEY_DETECTOR_LINUX_EVDEV_MEDIA_KEYS_H_
+#define MEDIA_KEY_DETECTOR_LINUX_EVDEV_MEDIA_KEYS_H_
+
+#include <linux/input.h>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "media_key_index.h"
+
+namespace media_key_detector_linux {
+
+// A media key press or release read from an input device.
+struct MediaKeyEvent {
+  MediaKeyIndex key;
+  bool pressed;
+  // When the kernel saw the event, on CLOCK_MONOTONIC like Dart's
+  // Timeline.now.
+  int64_t timestamp_us;
+  // N of the /dev/input/eventN node the event was read from.
+  uint16_t device = 0;
+
+  bool operator==(const MediaKeyEvent& other) const {
+    return key == other.key && pressed == other.pressed && timestamp_us == other.timestamp_us &&
+           device == other.device;
+  }
+};
+
+// The media key an evdev key code stands for, or -1.
+int MediaKeyForEvdevCode(uint16_t code);
+
+// Whether a device with the EV_KEY capability bits |key_bits| (as returned by
+// EVIOCGBIT(EV_KEY)) has any media key.
+bool HasMediaKeys(const uint8_t* key_bits, size_t size);
+
+// Turns the input_events of one device into media key events. Key repeats
+// are dropped: the app repeats held buttons itself.
+class EvdevKeyDecoder {
+ public:
+  using KeyBits = std::bitset<KEY_CNT>;
+
+  // |device| is stored in the events.
+  explicit EvdevKeyDecoder(uint16_t device = 0) : device_(device) {}
+
+  // Appends the media key change in |event|, if any, to |events|. Returns
+  // true for the SYN_REPORT that ends a gap of events dropped by the kernel,
+  // after which the device state has to be read back with Resync().
+  bool Decode(const input_event& event, std::vector<MediaKeyEvent>* events);
+
+  // Reports the keys that were pressed or released while events were
+  // dropped, given the keys |held| now. With no |held| state every key
+  // counts as released.
+  void Resync(const KeyBits* held, int64_t timestamp_us, std::vector<MediaKeyEvent>* events);
+
+ private:
+  void SetHeld(uint16_t code, bool pressed, int64_t timestamp_us,
+               std::vector<MediaKeyEvent>* events);
+
+  uint16_t device_;
+  KeyBits held_;
+  bool dropping_ = false;
+};
+
+// Reads media keys straight from /dev/input/event* on a thread of its own,
+// which sleeps in epoll_wait() between events. Devices that appear later,
+// e.g. a Bluetooth remote that reconnects, are picked up through inotify.
+//
+// Reading evdev nodes needs read access to them, usually through membership
+// of the "input" group. This bypasses the desktop, so it also works without
+// one and saves the round trip through it.
+class EvdevMediaKeyReader {
+ public:
+  // Called on the reader thread with the events of one wakeup, in order.
+  using Callback = std::function<void(const std::vector<MediaKeyEvent>& events)>;
+  // Decides whether the opened node |fd| is read.
+  using DeviceFilter = std::function<bool(int fd)>;
+
+  static constexpr const char* kInputDirectory = "/dev/input";
+
+  // By default reads the nodes in kInputDirectory that have media keys.
+  explicit EvdevMediaKeyReader(Callback callback,
+                               std::string directory = kInputDirectory,
+                               DeviceFilter filter = IsMediaKeyDevice);
+  ~EvdevMediaKeyReader();
+
+  // Disallow copy and assign.
+  EvdevMediaKeyReader(const EvdevMediaKeyReader&) = delete;
+  EvdevMediaKeyReader& operator=(const EvdevMediaKeyReader&) = delete;
+
+  // Opens the matching devices and starts the thread. Returns false if
+  // |directory| cannot be watched.
+  bool Start();
+
+  // Stops the thread and closes the devices. Called automatically on
+  // destruction. No callback runs once this returns.
+  void Stop();
+
+  // Whether |fd| is an evdev node with media keys.
+  static bool IsMediaKeyDevice(int fd);
+
+ private:
+  struct Device {
+    int fd;
+    // File name in directory_.
+    std::string name;
+    EvdevKeyDecoder decoder;
+  };
+
+  void Run();
+
+  // Opens |name| in directory_ if it is an event node that passes the
+  // filter and is not open yet.
+  void AddDevice(const char* name);
+  void RemoveDevice(int fd);
+
+  void ReadInotify();
+
+  // Drains |device| into |events|. Returns false once the device is gone.
+  bool ReadDevice(Device* device, std::vector<MediaKeyEvent>* events);
+
+  Callback callback_;
+  std::string directory_;
+  DeviceFilter filter_;
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int inotify_fd_ = -1;
+  // Open devices by fd. Only used on the reader thread once started.
+  std::unordered_map<int, Device> devices_;
+
+  std::thread thread_;
+};
+
+}  // namespace media_key_detector_linux
+
+#endif  // MEDIA_KEY_DETECTOR_LINUX_EVDEV_MEDIA_KEYS_H_
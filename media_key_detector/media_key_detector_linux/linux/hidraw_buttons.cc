@@ -0,0 +1,280 @@
+#include "hidraw_buttons.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/hidraw.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace media_key_detector_linux {
+
+using media_key_detector_core::HidButtonDecoder;
+using media_key_detector_core::HidButtonEdge;
+using media_key_detector_core::HidReportLayout;
+
+namespace {
+
+constexpr int kMaxReadyEvents = 16;
+// The largest report the kernel passes on, see HID_MAX_BUFFER_SIZE.
+constexpr size_t kMaxReportSize = 16384;
+// No more edges than this are expected from one report.
+constexpr size_t kEdgeCapacity = 64;
+
+int64_t MonotonicNowUs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+bool AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// Fills in what the kernel knows about |fd|; stays empty for other nodes.
+void ReadDeviceInfo(int fd, HidrawDeviceInfo* info) {
+  hidraw_devinfo devinfo = {};
+  if (ioctl(fd, HIDIOCGRAWINFO, &devinfo) == 0) {
+    info->vendor_id = static_cast<uint16_t>(devinfo.vendor);
+    info->product_id = static_cast<uint16_t>(devinfo.product);
+  }
+  char name[256] = {};
+  if (ioctl(fd, HIDIOCGRAWNAME(sizeof(name) - 1), name) > 0) {
+    info->name = name;
+  }
+}
+
+}  // namespace
+
+HidrawButtonReader::HidrawButtonReader(Callback callback, std::string directory,
+                                       DescriptorReader descriptor_reader)
+    : callback_(std::move(callback)),
+      directory_(std::move(directory)),
+      descriptor_reader_(std::move(descriptor_reader)) {}
+
+HidrawButtonReader::~HidrawButtonReader() {
+  Stop();
+}
+
+bool HidrawButtonReader::ReadReportDescriptor(int fd, std::vector<uint8_t>* descriptor) {
+  int size = 0;
+  if (ioctl(fd, HIDIOCGRDESCSIZE, &size) < 0 || size <= 0 || size > HID_MAX_DESCRIPTOR_SIZE) {
+    return false;
+  }
+  hidraw_report_descriptor report_descriptor = {};
+  report_descriptor.size = static_cast<uint32_t>(size);
+  if (ioctl(fd, HIDIOCGRDESC, &report_descriptor) < 0) {
+    return false;
+  }
+  descriptor->assign(report_descriptor.value, report_descriptor.value + size);
+  return true;
+}
+
+bool HidrawButtonReader::Start() {
+  if (thread_.joinable()) {
+    return true;
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  // New nodes are created by root and made readable by udev afterwards.
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || inotify_fd_ < 0 ||
+      inotify_add_watch(inotify_fd_, directory_.c_str(), IN_CREATE | IN_ATTRIB) < 0 ||
+      !AddToEpoll(epoll_fd_, stop_fd_) || !AddToEpoll(epoll_fd_, inotify_fd_)) {
+    Stop();
+    return false;
+  }
+  report_.resize(kMaxReportSize);
+  edges_.reserve(kEdgeCapacity);
+
+  // Watch before listing, so no device that appears meanwhile is missed.
+  DIR* dir = opendir(directory_.c_str());
+  if (dir != nullptr) {
+    while (dirent* entry = readdir(dir)) {
+      AddDevice(entry->d_name);
+    }
+    closedir(dir);
+  }
+
+  thread_ = std::thread(&HidrawButtonReader::Run, this);
+  return true;
+}
+
+void HidrawButtonReader::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  for (auto& entry : devices_) {
+    close(entry.first);
+  }
+  devices_.clear();
+  {
+    std::lock_guard<std::mutex> lock(infos_mutex_);
+    infos_.clear();
+  }
+  CloseFd(&inotify_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+}
+
+std::vector<HidrawDeviceInfo> HidrawButtonReader::Devices() const {
+  std::lock_guard<std::mutex> lock(infos_mutex_);
+  return infos_;
+}
+
+void HidrawButtonReader::Run() {
+  epoll_event ready[kMaxReadyEvents];
+  std::vector<HidButtonEvent> events;
+  while (true) {
+    int count = epoll_wait(epoll_fd_, ready, kMaxReadyEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      int fd = ready[i].data.fd;
+      if (fd == stop_fd_) {
+        return;
+      }
+      if (fd == inotify_fd_) {
+        ReadInotify();
+        continue;
+      }
+      auto device = devices_.find(fd);
+      if (device != devices_.end() && !ReadDevice(&device->second, &events)) {
+        RemoveDevice(fd, &events);
+      }
+    }
+    // Everything read in one wakeup goes out together.
+    if (!events.empty()) {
+      callback_(events);
+      events.clear();
+    }
+  }
+}
+
+void HidrawButtonReader::AddDevice(const char* name) {
+  if (strncmp(name, "hidraw", 6) != 0) {
+    return;
+  }
+  for (const auto& entry : devices_) {
+    if (entry.second.name == name) {
+      return;
+    }
+  }
+
+  std::string path = directory_ + "/" + name;
+  int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  // Without access yet, IN_ATTRIB brings us back once udev granted it.
+  if (fd < 0) {
+    return;
+  }
+  std::vector<uint8_t> descriptor;
+  HidReportLayout layout;
+  std::string error;
+  if (!descriptor_reader_(fd, &descriptor) ||
+      !ParseHidReportDescriptor(descriptor.data(), descriptor.size(), &layout, &error)) {
+    close(fd);
+    return;
+  }
+  // Keyboards, mice and devices without buttons are left alone.
+  HidButtonDecoder decoder(layout);
+  if (!decoder.has_buttons() || !AddToEpoll(epoll_fd_, fd)) {
+    close(fd);
+    return;
+  }
+
+  auto number = static_cast<uint16_t>(strtoul(name + 6, nullptr, 10));
+  HidrawDeviceInfo info = {number, "", 0, 0};
+  ReadDeviceInfo(fd, &info);
+  devices_.emplace(fd, Device{fd, name, number, std::move(decoder)});
+  std::lock_guard<std::mutex> lock(infos_mutex_);
+  infos_.push_back(std::move(info));
+}
+
+void HidrawButtonReader::RemoveDevice(int fd, std::vector<HidButtonEvent>* events) {
+  auto device = devices_.find(fd);
+  edges_.clear();
+  device->second.decoder.Reset(&edges_);
+  AppendEdges(device->second, MonotonicNowUs(), events);
+  uint16_t number = device->second.number;
+  {
+    std::lock_guard<std::mutex> lock(infos_mutex_);
+    auto removed = [&](const HidrawDeviceInfo& info) { return info.device == number; };
+    infos_.erase(std::remove_if(infos_.begin(), infos_.end(), removed), infos_.end());
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  devices_.erase(device);
+}
+
+void HidrawButtonReader::ReadInotify() {
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t size = read(inotify_fd_, buffer, sizeof(buffer));
+    if (size <= 0) {
+      return;
+    }
+    for (char* position = buffer; position < buffer + size;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(position);
+      if (event->len > 0) {
+        AddDevice(event->name);
+      }
+      position += sizeof(inotify_event) + event->len;
+    }
+  }
+}
+
+bool HidrawButtonReader::ReadDevice(Device* device, std::vector<HidButtonEvent>* events) {
+  // Every read returns exactly one report.
+  while (true) {
+    ssize_t size = read(device->fd, report_.data(), report_.size());
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // ENODEV once the device was unplugged.
+      return errno == EAGAIN;
+    }
+    // End of file: only seen with the pipes used in tests.
+    if (size == 0) {
+      return false;
+    }
+    edges_.clear();
+    device->decoder.Decode(report_.data(), static_cast<size_t>(size), &edges_);
+    AppendEdges(*device, MonotonicNowUs(), events);
+  }
+}
+
+void HidrawButtonReader::AppendEdges(const Device& device, int64_t timestamp_us,
+                                     std::vector<HidButtonEvent>* events) {
+  for (const HidButtonEdge& edge : edges_) {
+    events->push_back({device.number, edge.usage, edge.pressed, timestamp_us});
+  }
+}
+
+}  // namespace media_key_detector_linux
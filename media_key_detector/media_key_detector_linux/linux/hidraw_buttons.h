@@ -0,0 +1,127 @@
+#ifndef MEDIA_KEY_DETECTOR_LINUX_HIDRAW_BUTTONS_H_
+#define MEDIA_KEY_DETECTOR_LINUX_HIDRAW_BUTTONS_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "media_key_detector_core/hid_button_decoder.h"
+
+namespace media_key_detector_linux {
+
+// A button of an HID device that was pressed or released.
+struct HidButtonEvent {
+  // N of the /dev/hidrawN node the report was read from.
+  uint16_t device;
+  // Usage page in the upper and usage ID in the lower 16 bits.
+  uint32_t usage;
+  bool pressed;
+  // When the report was read, on CLOCK_MONOTONIC like Dart's Timeline.now.
+  int64_t timestamp_us;
+
+  bool operator==(const HidButtonEvent& other) const {
+    return device == other.device && usage == other.usage && pressed == other.pressed &&
+           timestamp_us == other.timestamp_us;
+  }
+};
+
+// An open hidraw node that has buttons.
+struct HidrawDeviceInfo {
+  uint16_t device;
+  std::string name;
+  uint16_t vendor_id;
+  uint16_t product_id;
+};
+
+// Reads the buttons of HID devices straight from /dev/hidraw* on a thread of
+// its own, which sleeps in epoll_wait() between reports. This covers clickers
+// and remotes whose buttons have no key code, so they never reach evdev.
+//
+// Each device's report descriptor is parsed once when it is opened; reports
+// are then decoded at precomputed offsets without allocating. Devices that
+// appear later are picked up through inotify. Reading hidraw nodes needs read
+// access to them, usually granted by a udev rule.
+class HidrawButtonReader {
+ public:
+  // Called on the reader thread with the events of one wakeup, in order.
+  using Callback = std::function<void(const std::vector<HidButtonEvent>& events)>;
+  // Reads the report descriptor of the opened node |fd|.
+  using DescriptorReader = std::function<bool(int fd, std::vector<uint8_t>* descriptor)>;
+
+  static constexpr const char* kDeviceDirectory = "/dev";
+
+  // By default reads the descriptors of the nodes in kDeviceDirectory with
+  // HIDIOCGRDESC.
+  explicit HidrawButtonReader(Callback callback,
+                              std::string directory = kDeviceDirectory,
+                              DescriptorReader descriptor_reader = ReadReportDescriptor);
+  ~HidrawButtonReader();
+
+  // Disallow copy and assign.
+  HidrawButtonReader(const HidrawButtonReader&) = delete;
+  HidrawButtonReader& operator=(const HidrawButtonReader&) = delete;
+
+  // Opens the devices with buttons and starts the thread. Returns false if
+  // |directory| cannot be watched.
+  bool Start();
+
+  // Stops the thread and closes the devices. Called automatically on
+  // destruction. No callback runs once this returns.
+  void Stop();
+
+  // The devices being read. Can be called from any thread.
+  std::vector<HidrawDeviceInfo> Devices() const;
+
+  static bool ReadReportDescriptor(int fd, std::vector<uint8_t>* descriptor);
+
+ private:
+  struct Device {
+    int fd;
+    // File name in directory_.
+    std::string name;
+    uint16_t number;
+    media_key_detector_core::HidButtonDecoder decoder;
+  };
+
+  void Run();
+
+  // Opens |name| in directory_ if it is a hidraw node with buttons that is
+  // not open yet.
+  void AddDevice(const char* name);
+  // Releases the buttons |fd| still held into |events| and closes it.
+  void RemoveDevice(int fd, std::vector<HidButtonEvent>* events);
+
+  void ReadInotify();
+
+  // Decodes the pending report of |device| into |events|. Returns false once
+  // the device is gone.
+  bool ReadDevice(Device* device, std::vector<HidButtonEvent>* events);
+
+  void AppendEdges(const Device& device, int64_t timestamp_us, std::vector<HidButtonEvent>* events);
+
+  Callback callback_;
+  std::string directory_;
+  DescriptorReader descriptor_reader_;
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int inotify_fd_ = -1;
+  // Open devices by fd. Only used on the reader thread once started.
+  std::unordered_map<int, Device> devices_;
+  // Scratch space, reused for every report.
+  std::vector<uint8_t> report_;
+  std::vector<media_key_detector_core::HidButtonEdge> edges_;
+
+  mutable std::mutex infos_mutex_;
+  std::vector<HidrawDeviceInfo> infos_;
+
+  std::thread thread_;
+};
+
+}  // namespace media_key_detector_linux
+
+#endif  // MEDIA_KEY_DETECTOR_LINUX_HIDRAW_BUTTONS_H_
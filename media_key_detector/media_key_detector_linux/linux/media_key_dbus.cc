@@ -0,0 +1,280 @@
+#include "media_key_dbus.h"
+
+#include <cstring>
+
+const char kMprisBusNamePrefix[] = "org.mpris.MediaPlayer2.";
+const char kMprisPath[] = "/org/mpris/MediaPlayer2";
+const char kMprisPlayerInterface[] = "org.mpris.MediaPlayer2.Player";
+
+const char kGsdBusName[] = "org.gnome.SettingsDaemon.MediaKeys";
+const char kGsdPath[] = "/org/gnome/SettingsDaemon/MediaKeys";
+const char kGsdInterface[] = "org.gnome.SettingsDaemon.MediaKeys";
+
+// The parts of the MPRIS interfaces that a player without tracks needs.
+const char kMprisIntrospection[] = R"(<node>
+  <interface name="org.mpris.MediaPlayer2">
+    <method name="Raise"/>
+    <method name="Quit"/>
+    <property name="CanQuit" type="b" access="read"/>
+    <property name="CanRaise" type="b" access="read"/>
+    <property name="HasTrackList" type="b" access="read"/>
+    <property name="Identity" type="s" access="read"/>
+    <property name="SupportedUriSchemes" type="as" access="read"/>
+    <property name="SupportedMimeTypes" type="as" access="read"/>
+  </interface>
+  <interface name="org.mpris.MediaPlayer2.Player">
+    <method name="Next"/>
+    <method name="Previous"/>
+    <method name="Pause"/>
+    <method name="PlayPause"/>
+    <method name="Stop"/>
+    <method name="Play"/>
+    <method name="Seek">
+      <arg name="Offset" type="x" direction="in"/>
+    </method>
+    <method name="SetPosition">
+      <arg name="TrackId" type="o" direction="in"/>
+      <arg name="Position" type="x" direction="in"/>
+    </method>
+    <method name="OpenUri">
+      <arg name="Uri" type="s" direction="in"/>
+    </method>
+    <signal name="Seeked">
+      <arg name="Position" type="x"/>
+    </signal>
+    <property name="PlaybackStatus" type="s" access="read"/>
+    <property name="Rate" type="d" access="read"/>
+    <property name="Metadata" type="a{sv}" access="read"/>
+    <property name="Volume" type="d" access="read"/>
+    <property name="Position" type="x" access="read"/>
+    <property name="MinimumRate" type="d" access="read"/>
+    <property name="MaximumRate" type="d" access="read"/>
+    <property name="CanGoNext" type="b" access="read"/>
+    <property name="CanGoPrevious" type="b" access="read"/>
+    <property name="CanPlay" type="b" access="read"/>
+    <property name="CanPause" type="b" access="read"/>
+    <property name="CanSeek" type="b" access="read"/>
+    <property name="CanControl" type="b" access="read"/>
+  </interface>
+</node>)";
+
+struct KeyName {
+  const char* name;
+  MediaKeyIndex key;
+};
+
+// MPRIS player methods and the key names of the GNOME settings daemon. Play
+// and Pause are toggles like on Windows: we do not know the trainer app's
+// state.
+const KeyName kKeyNames[] = {
+    {"PlayPause", MEDIA_KEY_PLAY_PAUSE}, {"Play", MEDIA_KEY_PLAY_PAUSE},
+    {"Pause", MEDIA_KEY_PLAY_PAUSE},     {"Stop", MEDIA_KEY_PLAY_PAUSE},
+    {"Previous", MEDIA_KEY_REWIND},      {"Rewind", MEDIA_KEY_REWIND},
+    {"Next", MEDIA_KEY_FAST_FORWARD},    {"FastForward", MEDIA_KEY_FAST_FORWARD},
+};
+
+struct BoolProperty {
+  const char* name;
+  gboolean value;
+};
+
+const BoolProperty kBoolProperties[] = {
+    {"CanQuit", FALSE},  {"CanRaise", FALSE},     {"HasTrackList", FALSE},
+    {"CanGoNext", TRUE}, {"CanGoPrevious", TRUE}, {"CanPlay", TRUE},
+    {"CanPause", TRUE},  {"CanSeek", FALSE},      {"CanControl", TRUE},
+};
+
+struct _MediaKeyDBus {
+  GDBusConnection* connection;
+  gchar* app_name;
+  MediaKeyCallback callback;
+  gpointer user_data;
+
+  gboolean active;
+  GDBusNodeInfo* node_info;
+
+  // Only set while active.
+  guint root_registration_id;
+  guint player_registration_id;
+  guint mpris_owner_id;
+  guint gsd_watcher_id;
+  guint gsd_signal_id;
+  // Whether the GNOME settings daemon is on the bus.
+  gboolean gsd_present;
+  // Cancels a pending grab on deactivation.
+  GCancellable* cancellable;
+};
+
+static gboolean key_for_name(const gchar* name, MediaKeyIndex* key) {
+  for (const KeyName& key_name : kKeyNames) {
+    if (strcmp(name, key_name.name) == 0) {
+      *key = key_name.key;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static void mpris_method_call_cb(GDBusConnection* connection, const gchar* sender,
+                                 const gchar* object_path, const gchar* interface_name,
+                                 const gchar* method_name, GVariant* parameters,
+                                 GDBusMethodInvocation* invocation, gpointer user_data) {
+  MediaKeyDBus* self = static_cast<MediaKeyDBus*>(user_data);
+  // Reply first: the callback may deactivate us.
+  g_dbus_method_invocation_return_value(invocation, nullptr);
+
+  MediaKeyIndex key;
+  if (strcmp(interface_name, kMprisPlayerInterface) == 0 && key_for_name(method_name, &key))
+    self->callback(key, self->user_data);
+}
+
+static GVariant* mpris_get_property_cb(GDBusConnection* connection, const gchar* sender,
+                                       const gchar* object_path, const gchar* interface_name,
+                                       const gchar* property_name, GError** error,
+                                       gpointer user_data) {
+  MediaKeyDBus* self = static_cast<MediaKeyDBus*>(user_data);
+  for (const BoolProperty& property : kBoolProperties) {
+    if (strcmp(property_name, property.name) == 0)
+      return g_variant_new_boolean(property.value);
+  }
+  if (strcmp(property_name, "Identity") == 0)
+    return g_variant_new_string(self->app_name);
+  if (strcmp(property_name, "SupportedUriSchemes") == 0 ||
+      strcmp(property_name, "SupportedMimeTypes") == 0)
+    return g_variant_new_strv(nullptr, 0);
+  // Only owned while the app wants media keys, which is while it "plays".
+  if (strcmp(property_name, "PlaybackStatus") == 0)
+    return g_variant_new_string("Playing");
+  if (strcmp(property_name, "Rate") == 0 || strcmp(property_name, "Volume") == 0 ||
+      strcmp(property_name, "MinimumRate") == 0 || strcmp(property_name, "MaximumRate") == 0)
+    return g_variant_new_double(1.0);
+  if (strcmp(property_name, "Metadata") == 0)
+    return g_variant_new_array(G_VARIANT_TYPE("{sv}"), nullptr, 0);
+  if (strcmp(property_name, "Position") == 0)
+    return g_variant_new_int64(0);
+
+  g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY, "Unknown property %s",
+              property_name);
+  return nullptr;
+}
+
+const GDBusInterfaceVTable kMprisVTable = {mpris_method_call_cb, mpris_get_property_cb, nullptr};
+
+static void gsd_key_pressed_cb(GDBusConnection* connection, const gchar* sender_name,
+                               const gchar* object_path, const gchar* interface_name,
+                               const gchar* signal_name, GVariant* parameters,
+                               gpointer user_data) {
+  MediaKeyDBus* self = static_cast<MediaKeyDBus*>(user_data);
+  if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(ss)")))
+    return;
+
+  const gchar* application = nullptr;
+  const gchar* key_name = nullptr;
+  g_variant_get(parameters, "(&s&s)", &application, &key_name);
+  // The signal goes to every client that grabbed keys.
+  MediaKeyIndex key;
+  if (strcmp(application, self->app_name) == 0 && key_for_name(key_name, &key))
+    self->callback(key, self->user_data);
+}
+
+static void gsd_grab_cb(GObject* object, GAsyncResult* result, gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GVariant) reply =
+      g_dbus_connection_call_finish(G_DBUS_CONNECTION(object), result, &error);
+  if (reply == nullptr && !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    g_warning("Failed to grab media keys: %s", error->message);
+}
+
+// The settings daemon forgets grabs when it restarts, so grab again every time
+// it appears.
+static void gsd_appeared_cb(GDBusConnection* connection, const gchar* name,
+                            const gchar* name_owner, gpointer user_data) {
+  MediaKeyDBus* self = static_cast<MediaKeyDBus*>(user_data);
+  self->gsd_present = TRUE;
+  // A time of 0 makes this the most recent grab.
+  g_dbus_connection_call(connection, kGsdBusName, kGsdPath, kGsdInterface, "GrabMediaPlayerKeys",
+                         g_variant_new("(su)", self->app_name, 0u), nullptr,
+                         G_DBUS_CALL_FLAGS_NONE, -1, self->cancellable, gsd_grab_cb, nullptr);
+}
+
+static void gsd_vanished_cb(GDBusConnection* connection, const gchar* name, gpointer user_data) {
+  static_cast<MediaKeyDBus*>(user_data)->gsd_present = FALSE;
+}
+
+static void activate(MediaKeyDBus* self) {
+  self->root_registration_id = g_dbus_connection_register_object(
+      self->connection, kMprisPath, self->node_info->interfaces[0], &kMprisVTable, self, nullptr,
+      nullptr);
+  self->player_registration_id = g_dbus_connection_register_object(
+      self->connection, kMprisPath, self->node_info->interfaces[1], &kMprisVTable, self, nullptr,
+      nullptr);
+  g_autofree gchar* bus_name = g_strconcat(kMprisBusNamePrefix, self->app_name, nullptr);
+  // Queues behind another instance of the app rather than failing.
+  self->mpris_owner_id =
+      g_bus_own_name_on_connection(self->connection, bus_name, G_BUS_NAME_OWNER_FLAGS_NONE,
+                                   nullptr, nullptr, nullptr, nullptr);
+
+  self->cancellable = g_cancellable_new();
+  self->gsd_signal_id = g_dbus_connection_signal_subscribe(
+      self->connection, kGsdBusName, kGsdInterface, "MediaPlayerKeyPressed", kGsdPath, nullptr,
+      G_DBUS_SIGNAL_FLAGS_NONE, gsd_key_pressed_cb, self, nullptr);
+  self->gsd_watcher_id = g_bus_watch_name_on_connection(
+      self->connection, kGsdBusName, G_BUS_NAME_WATCHER_FLAGS_NONE, gsd_appeared_cb,
+      gsd_vanished_cb, self, nullptr);
+}
+
+static void deactivate(MediaKeyDBus* self) {
+  g_bus_unwatch_name(self->gsd_watcher_id);
+  g_dbus_connection_signal_unsubscribe(self->connection, self->gsd_signal_id);
+  g_cancellable_cancel(self->cancellable);
+  g_clear_object(&self->cancellable);
+  if (self->gsd_present) {
+    g_dbus_connection_call(self->connection, kGsdBusName, kGsdPath, kGsdInterface,
+                           "ReleaseMediaPlayerKeys", g_variant_new("(s)", self->app_name),
+                           nullptr, G_DBUS_CALL_FLAGS_NO_AUTO_START, -1, nullptr, nullptr,
+                           nullptr);
+  }
+  self->gsd_present = FALSE;
+
+  g_bus_unown_name(self->mpris_owner_id);
+  g_dbus_connection_unregister_object(self->connection, self->player_registration_id);
+  g_dbus_connection_unregister_object(self->connection, self->root_registration_id);
+  self->gsd_watcher_id = 0;
+  self->gsd_signal_id = 0;
+  self->mpris_owner_id = 0;
+  self->player_registration_id = 0;
+  self->root_registration_id = 0;
+}
+
+MediaKeyDBus* media_key_dbus_new(GDBusConnection* connection, const gchar* app_name,
+                                 MediaKeyCallback callback, gpointer user_data) {
+  MediaKeyDBus* self = g_new0(MediaKeyDBus, 1);
+  self->connection = G_DBUS_CONNECTION(g_object_ref(connection));
+  self->app_name = g_strdup(app_name);
+  self->callback = callback;
+  self->user_data = user_data;
+  self->node_info = g_dbus_node_info_new_for_xml(kMprisIntrospection, nullptr);
+  return self;
+}
+
+void media_key_dbus_set_active(MediaKeyDBus* self, gboolean active) {
+  if (self->active == active)
+    return;
+  self->active = active;
+  if (active)
+    activate(self);
+  else
+    deactivate(self);
+}
+
+gboolean media_key_dbus_get_active(MediaKeyDBus* self) {
+  return self->active;
+}
+
+void media_key_dbus_free(MediaKeyDBus* self) {
+  media_key_dbus_set_active(self, FALSE);
+  g_dbus_node_info_unref(self->node_info);
+  g_free(self->app_name);
+  g_object_unref(self->connection);
+  g_free(self);
+}
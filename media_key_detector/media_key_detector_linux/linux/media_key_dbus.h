@@ -0,0 +1,44 @@
+#ifndef MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_DBUS_H_
+#define MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_DBUS_H_
+
+#include <gio/gio.h>
+
+#include "media_key_index.h"
+
+G_BEGIN_DECLS
+
+// Called on the main context the listener was created on.
+typedef void (*MediaKeyCallback)(MediaKeyIndex key, gpointer user_data);
+
+// Receives media keys over the session bus while active, in two ways:
+//
+// - As an MPRIS player named org.mpris.MediaPlayer2.<app_name>. Desktops and
+//   BlueZ (for Bluetooth remotes, through mpris-proxy) send the keys to MPRIS
+//   players.
+// - By grabbing the keys from org.gnome.SettingsDaemon.MediaKeys. GNOME then
+//   sends them only to us, as a signal, rather than to any MPRIS player. The
+//   grab is repeated whenever the settings daemon (re)appears on the bus.
+//
+// Volume keys are left to the desktop: neither path reports them.
+typedef struct _MediaKeyDBus MediaKeyDBus;
+
+// |app_name| must be a valid D-Bus name element, e.g. "bike_control".
+MediaKeyDBus* media_key_dbus_new(GDBusConnection* connection,
+                                 const gchar* app_name,
+                                 MediaKeyCallback callback,
+                                 gpointer user_data);
+
+// Starts or stops receiving media keys. Inactive listeners leave the keys to
+// other players.
+void media_key_dbus_set_active(MediaKeyDBus* self, gboolean active);
+
+gboolean media_key_dbus_get_active(MediaKeyDBus* self);
+
+// Deactivates and frees |self|. No callback runs once this returns.
+void media_key_dbus_free(MediaKeyDBus* self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(MediaKeyDBus, media_key_dbus_free)
+
+G_END_DECLS
+
+#endif  // MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_DBUS_H_
@@ -5,9 +5,58 @@
 #include <sys/utsname.h>
 
 #include <cstring>
+#include <vector>
+
+#include "evdev_gamepads.h"
+#include "evdev_media_keys.h"
+#include "hidraw_buttons.h"
+#include "media_key_dbus.h"
+#include "media_key_detector_core/ffi_bridge.h"
+#include "media_key_detector_core/media_key_event_codec.h"
+
+using media_key_detector_core::ButtonEdge;
+using media_key_detector_core::ButtonEdgeWorker;
+using media_key_detector_core::MediaKeyAction;
+using media_key_detector_core::MediaKeyBatcher;
+using media_key_detector_core::MediaKeyRecord;
+using media_key_detector_core::MediaKeySource;
+using media_key_detector_core::TapClassifierWorker;
+using media_key_detector_core::TapGesture;
+using media_key_detector_core::GamepadState;
+using media_key_detector_linux::EvdevGamepadReader;
+using media_key_detector_linux::EvdevMediaKeyReader;
+using media_key_detector_linux::GamepadEvent;
+using media_key_detector_linux::GamepadInfo;
+using media_key_detector_linux::HidButtonEvent;
+using media_key_detector_linux::HidrawButtonReader;
+using media_key_detector_linux::HidrawDeviceInfo;
+using media_key_detector_linux::MediaKeyEvent;
 
 const char kChannelName[] = "media_key_detector_linux";
+const char kEventChannelName[] = "media_key_detector_linux_events";
+const char kHidEventChannelName[] = "media_key_detector_linux_hid_events";
+const char kGamepadEventChannelName[] = "media_key_detector_linux_gamepad_events";
+const char kGamepadChannelName[] = "media_key_detector_linux_gamepads";
+const char kButtonEdgeChannelName[] = "media_key_detector_linux_button_edges";
+const char kTapChannelName[] = "media_key_detector_linux_taps";
 const char kGetPlatformName[] = "getPlatformName";
+const char kGetIsPlaying[] = "getIsPlaying";
+const char kSetIsPlaying[] = "setIsPlaying";
+const char kIsPlayingKey[] = "isPlaying";
+const char kSetUseEvdev[] = "setUseEvdev";
+const char kUseEvdevKey[] = "useEvdev";
+const char kSetBatchWindow[] = "setBatchWindow";
+const char kMillisecondsKey[] = "milliseconds";
+const char kSetUseHidraw[] = "setUseHidraw";
+const char kUseHidrawKey[] = "useHidraw";
+const char kGetHidDevices[] = "getHidDevices";
+const char kSetUseGamepads[] = "setUseGamepads";
+const char kUseGamepadsKey[] = "useGamepads";
+const char kGetGamepads[] = "getGamepads";
+const char kSetGamepadOptions[] = "setGamepadOptions";
+const char kDeadzoneKey[] = "deadzone";
+const char kPressThresholdKey[] = "pressThreshold";
+const char kReleaseThresholdKey[] = "releaseThreshold";
 
 struct _FlMediaKeyDetectorPlugin {
   GObject parent_instance;
@@ -16,20 +65,357 @@ struct _FlMediaKeyDetectorPlugin {
 
   // Connection to Flutter engine.
   FlMethodChannel* channel;
+
+  // Sends the media keys of every source in batches, see
+  // media_key_event_codec.h.
+  FlEventChannel* event_channel;
+
+  // Collects the media keys of the next batch. Fed on the main loop and the
+  // evdev thread.
+  MediaKeyBatcher* batcher;
+
+  // Active while the app is playing, unless |evdev_reader| runs. Null
+  // without a session bus.
+  MediaKeyDBus* media_keys;
+
+  // Runs while the app is playing and |use_evdev| is set.
+  EvdevMediaKeyReader* evdev_reader;
+
+  // Sends the button edges of HID devices as (device, usage, pressed,
+  // timestamp in microseconds) quadruples in an Int64List.
+  FlEventChannel* hid_event_channel;
+
+  // Runs while |use_hidraw| is set, whether or not the app is playing.
+  HidrawButtonReader* hidraw_reader;
+
+  // Sends gamepad button edges like |hid_event_channel|, and gamepads that
+  // connect or disconnect as maps.
+  FlEventChannel* gamepad_event_channel;
+  FlEventChannel* gamepad_channel;
+
+  // Runs while |use_gamepads| is set, whether or not the app is playing.
+  EvdevGamepadReader* gamepad_reader;
+
+  // Sends the edges |button_edge_worker| emits by time, and those the
+  // mkd_button_* calls from Dart had no room for, as (device, button, action,
+  // timestamp in microseconds) quadruples in an Int64List.
+  FlEventChannel* button_edge_channel;
+
+  // Serves the mkd_button_* calls through the FFI bridge while installed.
+  ButtonEdgeWorker* button_edge_worker;
+
+  // Sends the tap gestures |tap_worker| resolves by time as (device, taps,
+  // timestamp in microseconds) triples in an Int64List.
+  FlEventChannel* tap_channel;
+
+  // Serves the mkd_tap* calls through the FFI bridge while installed.
+  TapClassifierWorker* tap_worker;
+
+  gboolean is_playing;
+  gboolean use_evdev;
+  gboolean use_hidraw;
+  gboolean use_gamepads;
 };
 
+// Button events on their way from a reader thread to the main loop, as the
+// tuples |channel| sends, e.g. (device, button, pressed, timestamp).
+typedef struct {
+  FlMediaKeyDetectorPlugin* plugin;
+  // Points into |plugin|, which clears it on dispose.
+  FlEventChannel** channel;
+  std::vector<int64_t> values;
+} ButtonEvents;
+
+// A gamepad that connected or disconnected, on its way to the main loop.
+typedef struct {
+  FlMediaKeyDetectorPlugin* plugin;
+  GamepadInfo info;
+  bool connected;
+} GamepadHotplug;
+
 G_DEFINE_TYPE(FlMediaKeyDetectorPlugin, fl_media_key_detector_plugin, g_object_get_type())
 
+// Sends the pending batch.
+static gboolean send_batch_cb(gpointer user_data) {
+  FlMediaKeyDetectorPlugin* self = FL_MEDIA_KEY_DETECTOR_PLUGIN(user_data);
+  std::vector<uint8_t> batch;
+  if (self->event_channel == nullptr || !self->batcher->Take(&batch))
+    return G_SOURCE_REMOVE;
+
+  g_autoptr(FlValue) value = fl_value_new_uint8_list(batch.data(), batch.size());
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(self->event_channel, value, nullptr, &error))
+    g_warning("Failed to send media key events: %s", error->message);
+  return G_SOURCE_REMOVE;
+}
+
+// Queues |record| for the main loop. The first record of a batch schedules
+// sending it once the batch window is over. Thread-safe.
+static void queue_media_key(FlMediaKeyDetectorPlugin* self, const MediaKeyRecord& record) {
+  if (!self->batcher->Add(record))
+    return;
+  guint window_ms = self->batcher->window_ms();
+  if (window_ms == 0) {
+    g_idle_add_full(G_PRIORITY_DEFAULT, send_batch_cb, g_object_ref(self), g_object_unref);
+  } else {
+    g_timeout_add_full(G_PRIORITY_DEFAULT, window_ms, send_batch_cb, g_object_ref(self),
+                       g_object_unref);
+  }
+}
+
+static gboolean send_button_events_cb(gpointer user_data) {
+  ButtonEvents* events = static_cast<ButtonEvents*>(user_data);
+  if (*events->channel == nullptr)
+    return G_SOURCE_REMOVE;
+
+  g_autoptr(FlValue) value = fl_value_new_int64_list(events->values.data(), events->values.size());
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(*events->channel, value, nullptr, &error))
+    g_warning("Failed to send button events: %s", error->message);
+  return G_SOURCE_REMOVE;
+}
+
+static void button_events_free(gpointer user_data) {
+  ButtonEvents* events = static_cast<ButtonEvents*>(user_data);
+  g_object_unref(events->plugin);
+  delete events;
+}
+
+// Queues the tuples in |values| for |channel| of |self|. Thread-safe.
+static void queue_button_events(FlMediaKeyDetectorPlugin* self, FlEventChannel** channel,
+                                std::vector<int64_t> values) {
+  ButtonEvents* events = new ButtonEvents{FL_MEDIA_KEY_DETECTOR_PLUGIN(g_object_ref(self)),
+                                          channel, std::move(values)};
+  g_idle_add_full(G_PRIORITY_DEFAULT, send_button_events_cb, events, button_events_free);
+}
+
+static FlValue* gamepad_info_to_map(const GamepadInfo& info) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "device", fl_value_new_int(info.device));
+  fl_value_set_string_take(map, "name", fl_value_new_string(info.name.c_str()));
+  fl_value_set_string_take(map, "vendorId", fl_value_new_int(info.vendor_id));
+  fl_value_set_string_take(map, "productId", fl_value_new_int(info.product_id));
+  return map;
+}
+
+static gboolean send_gamepad_hotplug_cb(gpointer user_data) {
+  GamepadHotplug* hotplug = static_cast<GamepadHotplug*>(user_data);
+  FlMediaKeyDetectorPlugin* self = hotplug->plugin;
+  if (self->gamepad_channel == nullptr)
+    return G_SOURCE_REMOVE;
+
+  g_autoptr(FlValue) value = gamepad_info_to_map(hotplug->info);
+  fl_value_set_string_take(value, "connected", fl_value_new_bool(hotplug->connected));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(self->gamepad_channel, value, nullptr, &error))
+    g_warning("Failed to send gamepad connection: %s", error->message);
+  return G_SOURCE_REMOVE;
+}
+
+static void gamepad_hotplug_free(gpointer user_data) {
+  GamepadHotplug* hotplug = static_cast<GamepadHotplug*>(user_data);
+  g_object_unref(hotplug->plugin);
+  delete hotplug;
+}
+
+// Called on the main loop for every media key received over D-Bus.
+static void media_key_cb(MediaKeyIndex key, gpointer user_data) {
+  FlMediaKeyDetectorPlugin* self = FL_MEDIA_KEY_DETECTOR_PLUGIN(user_data);
+  // D-Bus has the press only, at the time it arrives. GLib's monotonic time
+  // is CLOCK_MONOTONIC, like Dart's Timeline.now.
+  queue_media_key(self, {static_cast<media_key_detector_core::MediaKeyIndex>(key),
+                         MediaKeyAction::kPress, MediaKeySource::kDBus, 0,
+                         g_get_monotonic_time()});
+}
+
+// Media keys come from evdev when asked for and /dev/input can be watched,
+// and over D-Bus otherwise. Never from both, or the keys of a remote would
+// arrive twice.
+static void update_key_sources(FlMediaKeyDetectorPlugin* self) {
+  gboolean evdev = self->is_playing && self->use_evdev && self->evdev_reader->Start();
+  if (!evdev)
+    self->evdev_reader->Stop();
+  if (self->media_keys != nullptr)
+    media_key_dbus_set_active(self->media_keys, self->is_playing && !evdev);
+}
+
+// Reads the bool |key| of the map |args| into |value|.
+static gboolean get_bool_arg(FlValue* args, const char* key, gboolean* value) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP)
+    return FALSE;
+  FlValue* arg = fl_value_lookup_string(args, key);
+  if (arg == nullptr || fl_value_get_type(arg) != FL_VALUE_TYPE_BOOL)
+    return FALSE;
+  *value = fl_value_get_bool(arg);
+  return TRUE;
+}
+
+// The D-Bus name of the app is org.mpris.MediaPlayer2.<name>, where <name>
+// may only contain [A-Za-z0-9_] and must not start with a digit.
+static gchar* get_dbus_app_name() {
+  const gchar* program_name = g_get_prgname();
+  gchar* name = g_strdup(program_name != nullptr ? program_name : "flutter_app");
+  for (gchar* c = name; *c != '\0'; c++) {
+    if (!g_ascii_isalnum(*c))
+      *c = '_';
+  }
+  if (g_ascii_isdigit(name[0])) {
+    gchar* prefixed = g_strconcat("_", name, nullptr);
+    g_free(name);
+    name = prefixed;
+  }
+  return name;
+}
+
+static FlMethodResponse* set_use_hidraw(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  if (!get_bool_arg(args, kUseHidrawKey, &self->use_hidraw)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "useHidraw argument is required", nullptr));
+  }
+
+  if (!self->use_hidraw) {
+    self->hidraw_reader->Stop();
+  } else if (!self->hidraw_reader->Start()) {
+    self->use_hidraw = FALSE;
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("UNAVAILABLE", "/dev cannot be watched", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* set_use_gamepads(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  if (!get_bool_arg(args, kUseGamepadsKey, &self->use_gamepads)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "useGamepads argument is required", nullptr));
+  }
+
+  if (!self->use_gamepads) {
+    self->gamepad_reader->Stop();
+  } else if (!self->gamepad_reader->Start()) {
+    self->use_gamepads = FALSE;
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("UNAVAILABLE", "/dev/input cannot be watched", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Reads the double |key| of the map |args| into |value|, if it is there.
+static gboolean get_optional_double_arg(FlValue* args, const char* key, float* value) {
+  FlValue* arg = fl_value_lookup_string(args, key);
+  if (arg == nullptr)
+    return TRUE;
+  if (fl_value_get_type(arg) != FL_VALUE_TYPE_FLOAT)
+    return FALSE;
+  *value = static_cast<float>(fl_value_get_float(arg));
+  return *value >= 0 && *value < 1;
+}
+
+static FlMethodResponse* set_gamepad_options(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  GamepadState::Options options;
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP ||
+      !get_optional_double_arg(args, kDeadzoneKey, &options.deadzone) ||
+      !get_optional_double_arg(args, kPressThresholdKey, &options.press_threshold) ||
+      !get_optional_double_arg(args, kReleaseThresholdKey, &options.release_threshold) ||
+      options.release_threshold > options.press_threshold) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "thresholds must be in [0, 1) with release <= press", nullptr));
+  }
+
+  // The gamepads are reopened with the new options.
+  self->gamepad_reader->set_options(options);
+  if (self->use_gamepads) {
+    self->gamepad_reader->Stop();
+    self->gamepad_reader->Start();
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* get_gamepads(FlMediaKeyDetectorPlugin* self) {
+  g_autoptr(FlValue) gamepads = fl_value_new_list();
+  for (const GamepadInfo& info : self->gamepad_reader->Devices())
+    fl_value_append_take(gamepads, gamepad_info_to_map(info));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(gamepads));
+}
+
+// Lists the HID devices whose buttons are read.
+static FlMethodResponse* get_hid_devices(FlMediaKeyDetectorPlugin* self) {
+  g_autoptr(FlValue) devices = fl_value_new_list();
+  for (const HidrawDeviceInfo& info : self->hidraw_reader->Devices()) {
+    FlValue* device = fl_value_new_map();
+    fl_value_set_string_take(device, "device", fl_value_new_int(info.device));
+    fl_value_set_string_take(device, "name", fl_value_new_string(info.name.c_str()));
+    fl_value_set_string_take(device, "vendorId", fl_value_new_int(info.vendor_id));
+    fl_value_set_string_take(device, "productId", fl_value_new_int(info.product_id));
+    fl_value_append_take(devices, device);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(devices));
+}
+
+static FlMethodResponse* set_batch_window(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  FlValue* milliseconds = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                              ? fl_value_lookup_string(args, kMillisecondsKey)
+                              : nullptr;
+  if (milliseconds == nullptr || fl_value_get_type(milliseconds) != FL_VALUE_TYPE_INT ||
+      fl_value_get_int(milliseconds) < 0 || fl_value_get_int(milliseconds) > G_MAXUINT32) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "milliseconds argument is required", nullptr));
+  }
+
+  self->batcher->set_window_ms(static_cast<uint32_t>(fl_value_get_int(milliseconds)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* set_is_playing(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  if (!get_bool_arg(args, kIsPlayingKey, &self->is_playing)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "isPlaying argument is required", nullptr));
+  }
+
+  update_key_sources(self);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* set_use_evdev(FlMediaKeyDetectorPlugin* self, FlValue* args) {
+  if (!get_bool_arg(args, kUseEvdevKey, &self->use_evdev)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "useEvdev argument is required", nullptr));
+  }
+
+  update_key_sources(self);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
 // Called when a method call is received from Flutter.
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
+  FlMediaKeyDetectorPlugin* self = FL_MEDIA_KEY_DETECTOR_PLUGIN(user_data);
   const gchar* method = fl_method_call_get_name(method_call);
 
   g_autoptr(FlMethodResponse) response = nullptr;
-  if (strcmp(method, kGetPlatformName) == 0)
+  if (strcmp(method, kGetPlatformName) == 0) {
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_string("Linux")));
-  else
+  } else if (strcmp(method, kGetIsPlaying) == 0) {
+    response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_bool(self->is_playing)));
+  } else if (strcmp(method, kSetIsPlaying) == 0) {
+    response = set_is_playing(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kSetUseEvdev) == 0) {
+    response = set_use_evdev(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kSetBatchWindow) == 0) {
+    response = set_batch_window(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kSetUseHidraw) == 0) {
+    response = set_use_hidraw(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kGetHidDevices) == 0) {
+    response = get_hid_devices(self);
+  } else if (strcmp(method, kSetUseGamepads) == 0) {
+    response = set_use_gamepads(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kSetGamepadOptions) == 0) {
+    response = set_gamepad_options(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kGetGamepads) == 0) {
+    response = get_gamepads(self);
+  } else {
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
 
   g_autoptr(GError) error = nullptr;
   if (!fl_method_call_respond(method_call, response, &error))
@@ -37,11 +423,46 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
 }
 
 static void fl_media_key_detector_plugin_dispose(GObject* object) {
+  FlMediaKeyDetectorPlugin* self = FL_MEDIA_KEY_DETECTOR_PLUGIN(object);
+  g_clear_pointer(&self->media_keys, media_key_dbus_free);
+  // Joins the reader thread. Sends it already scheduled hold a reference, so
+  // this runs after them.
+  delete self->evdev_reader;
+  self->evdev_reader = nullptr;
+  delete self->hidraw_reader;
+  self->hidraw_reader = nullptr;
+  delete self->gamepad_reader;
+  self->gamepad_reader = nullptr;
+  if (self->button_edge_worker != nullptr) {
+    media_key_detector_core::UninstallButtonEdgeWorker(self->button_edge_worker);
+    delete self->button_edge_worker;
+    self->button_edge_worker = nullptr;
+  }
+  if (self->tap_worker != nullptr) {
+    media_key_detector_core::UninstallTapClassifierWorker(self->tap_worker);
+    delete self->tap_worker;
+    self->tap_worker = nullptr;
+  }
+  g_clear_object(&self->event_channel);
+  g_clear_object(&self->hid_event_channel);
+  g_clear_object(&self->gamepad_event_channel);
+  g_clear_object(&self->gamepad_channel);
+  g_clear_object(&self->button_edge_channel);
+  g_clear_object(&self->tap_channel);
+
   G_OBJECT_CLASS(fl_media_key_detector_plugin_parent_class)->dispose(object);
 }
 
+static void fl_media_key_detector_plugin_finalize(GObject* object) {
+  FlMediaKeyDetectorPlugin* self = FL_MEDIA_KEY_DETECTOR_PLUGIN(object);
+  delete self->batcher;
+
+  G_OBJECT_CLASS(fl_media_key_detector_plugin_parent_class)->finalize(object);
+}
+
 static void fl_media_key_detector_plugin_class_init(FlMediaKeyDetectorPluginClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = fl_media_key_detector_plugin_dispose;
+  G_OBJECT_CLASS(klass)->finalize = fl_media_key_detector_plugin_finalize;
 }
 
 FlMediaKeyDetectorPlugin* fl_media_key_detector_plugin_new(FlPluginRegistrar* registrar) {
@@ -56,11 +477,86 @@ FlMediaKeyDetectorPlugin* fl_media_key_detector_plugin_new(FlPluginRegistrar* re
                             kChannelName, FL_METHOD_CODEC(codec));
   fl_method_channel_set_method_call_handler(self->channel, method_call_cb,
                                             g_object_ref(self), g_object_unref);
+  self->event_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                             kEventChannelName, FL_METHOD_CODEC(codec));
+  // Called on the reader thread.
+  self->evdev_reader = new EvdevMediaKeyReader([self](const std::vector<MediaKeyEvent>& events) {
+    for (const MediaKeyEvent& event : events) {
+      queue_media_key(self, {static_cast<media_key_detector_core::MediaKeyIndex>(event.key),
+                             event.pressed ? MediaKeyAction::kDown : MediaKeyAction::kUp,
+                             MediaKeySource::kEvdev, event.device, event.timestamp_us});
+    }
+  });
+  self->hid_event_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                                 kHidEventChannelName, FL_METHOD_CODEC(codec));
+  // Called on the reader thread.
+  self->hidraw_reader = new HidrawButtonReader([self](const std::vector<HidButtonEvent>& events) {
+    std::vector<int64_t> values;
+    values.reserve(events.size() * 4);
+    for (const HidButtonEvent& event : events)
+      values.insert(values.end(), {event.device, event.usage, event.pressed, event.timestamp_us});
+    queue_button_events(self, &self->hid_event_channel, std::move(values));
+  });
+  self->gamepad_event_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           kGamepadEventChannelName, FL_METHOD_CODEC(codec));
+  self->gamepad_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                               kGamepadChannelName, FL_METHOD_CODEC(codec));
+  // Both called on the reader thread.
+  self->gamepad_reader = new EvdevGamepadReader(
+      [self](const std::vector<GamepadEvent>& events) {
+        std::vector<int64_t> values;
+        values.reserve(events.size() * 4);
+        for (const GamepadEvent& event : events)
+          values.insert(values.end(),
+                        {event.device, event.button, event.pressed, event.timestamp_us});
+        queue_button_events(self, &self->gamepad_event_channel, std::move(values));
+      },
+      [self](const GamepadInfo& info, bool connected) {
+        GamepadHotplug* hotplug = new GamepadHotplug{
+            FL_MEDIA_KEY_DETECTOR_PLUGIN(g_object_ref(self)), info, connected};
+        g_idle_add_full(G_PRIORITY_DEFAULT, send_gamepad_hotplug_cb, hotplug,
+                        gamepad_hotplug_free);
+      });
+  self->button_edge_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                                   kButtonEdgeChannelName, FL_METHOD_CODEC(codec));
+  // Called on the worker thread, or on the thread of an mkd_button_* call.
+  self->button_edge_worker = new ButtonEdgeWorker([self](const std::vector<ButtonEdge>& edges) {
+    std::vector<int64_t> values;
+    values.reserve(edges.size() * 4);
+    for (const ButtonEdge& edge : edges)
+      values.insert(values.end(), {edge.device, edge.button, static_cast<int64_t>(edge.action),
+                                   edge.time_us});
+    queue_button_events(self, &self->button_edge_channel, std::move(values));
+  });
+  media_key_detector_core::InstallButtonEdgeWorker(self->button_edge_worker);
+  self->tap_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                           kTapChannelName, FL_METHOD_CODEC(codec));
+  // Called on the worker thread, or on the thread of an mkd_tap call.
+  self->tap_worker = new TapClassifierWorker([self](const std::vector<TapGesture>& gestures) {
+    std::vector<int64_t> values;
+    values.reserve(gestures.size() * 3);
+    for (const TapGesture& gesture : gestures)
+      values.insert(values.end(), {gesture.device, gesture.taps, gesture.time_us});
+    queue_button_events(self, &self->tap_channel, std::move(values));
+  });
+  media_key_detector_core::InstallTapClassifierWorker(self->tap_worker);
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GDBusConnection) bus = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &error);
+  if (bus == nullptr) {
+    g_warning("Media keys are unavailable without a session bus: %s", error->message);
+  } else {
+    g_autofree gchar* app_name = get_dbus_app_name();
+    self->media_keys = media_key_dbus_new(bus, app_name, media_key_cb, self);
+  }
 
   return self;
 }
 
-static void fl_media_key_detector_plugin_init(FlMediaKeyDetectorPlugin* self) {}
+static void fl_media_key_detector_plugin_init(FlMediaKeyDetectorPlugin* self) {
+  self->batcher = new MediaKeyBatcher();
+}
 
 void media_key_detector_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   FlMediaKeyDetectorPlugin* plugin = fl_media_key_detector_plugin_new(registrar);
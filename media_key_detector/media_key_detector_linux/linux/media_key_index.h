@@ -0,0 +1,14 @@
+#ifndef MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_INDEX_H_
+#define MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_INDEX_H_
+
+// Indices into MediaKey of media_key_detector_platform_interface. The Windows
+// plugin sends the same values.
+typedef enum {
+  MEDIA_KEY_PLAY_PAUSE = 0,
+  MEDIA_KEY_REWIND = 1,
+  MEDIA_KEY_FAST_FORWARD = 2,
+  MEDIA_KEY_VOLUME_UP = 3,
+  MEDIA_KEY_VOLUME_DOWN = 4,
+} MediaKeyIndex;
+
+#endif  // MEDIA_KEY_DETECTOR_LINUX_MEDIA_KEY_INDEX_H_
@@ -0,0 +1,242 @@
+#include "evdev_gamepads.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace media_key_detector_linux {
+namespace test {
+
+namespace {
+
+using media_key_detector_core::GamepadAxisButton;
+using media_key_detector_core::GamepadAxisRange;
+using media_key_detector_core::GamepadState;
+
+constexpr std::chrono::seconds kTimeout(5);
+
+input_event MakeEvent(uint16_t type, uint16_t code, int32_t value, int64_t timestamp_us = 0) {
+  input_event event = {};
+  event.input_event_sec = timestamp_us / 1000000;
+  event.input_event_usec = timestamp_us % 1000000;
+  event.type = type;
+  event.code = code;
+  event.value = value;
+  return event;
+}
+
+// An Xbox pad with its left stick and the D-pad hat.
+GamepadDescription XboxPad() {
+  GamepadDescription description;
+  description.name = "Xbox Wireless Controller";
+  description.vendor_id = 0x045e;
+  description.product_id = 0x0b13;
+  description.axes = {{ABS_X, GamepadAxisRange{-32768, 32767, 128, 0}},
+                      {ABS_HAT0X, GamepadAxisRange{-1, 1, 0, 0}}};
+  return description;
+}
+
+// Pressing A while pushing the stick right, as read from the event node.
+const input_event kPressAndPush[] = {
+    MakeEvent(EV_MSC, MSC_SCAN, 0x90001, 1000000), MakeEvent(EV_KEY, BTN_SOUTH, 1, 1000000),
+    MakeEvent(EV_ABS, ABS_X, 12000, 1000000),      MakeEvent(EV_SYN, SYN_REPORT, 0, 1000000),
+    MakeEvent(EV_ABS, ABS_X, 30000, 1008000),      MakeEvent(EV_SYN, SYN_REPORT, 0, 1008000),
+    MakeEvent(EV_ABS, ABS_X, 31000, 1016000),      MakeEvent(EV_SYN, SYN_REPORT, 0, 1016000),
+};
+
+std::vector<GamepadEvent> DecodeAll(EvdevGamepadDecoder* decoder,
+                                    const std::vector<input_event>& input) {
+  std::vector<GamepadEvent> events;
+  for (const input_event& event : input) {
+    EXPECT_FALSE(decoder->Decode(event, &events));
+  }
+  return events;
+}
+
+// Collects what the reader thread reports.
+class Recorder {
+ public:
+  EvdevGamepadReader::Callback callback() {
+    return [this](const std::vector<GamepadEvent>& events) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.insert(events_.end(), events.begin(), events.end());
+      condition_.notify_all();
+    };
+  }
+
+  EvdevGamepadReader::HotplugCallback hotplug_callback() {
+    return [this](const GamepadInfo& info, bool connected) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      hotplugs_.emplace_back(info.device, connected);
+      condition_.notify_all();
+    };
+  }
+
+  bool WaitFor(size_t events, size_t hotplugs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, kTimeout, [&] {
+      return events_.size() >= events && hotplugs_.size() >= hotplugs;
+    });
+  }
+
+  std::vector<GamepadEvent> events() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+  std::vector<std::pair<uint16_t, bool>> hotplugs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hotplugs_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<GamepadEvent> events_;
+  std::vector<std::pair<uint16_t, bool>> hotplugs_;
+};
+
+// Every node is an Xbox pad.
+bool ProbeXboxPad(int fd, GamepadDescription* description) {
+  *description = XboxPad();
+  return true;
+}
+
+// Stands in for /dev/input with named pipes, which replay recorded events
+// like an evdev node would deliver them.
+class EvdevGamepadReaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    char directory[] = "/tmp/evdev_gamepads_test_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    directory_ = directory;
+  }
+
+  void TearDown() override {
+    for (const std::string& name : nodes_) {
+      unlink(Path(name).c_str());
+    }
+    rmdir(directory_.c_str());
+  }
+
+  std::string Path(const std::string& name) const { return directory_ + "/" + name; }
+
+  void CreateNode(const std::string& name) {
+    ASSERT_EQ(mkfifo(Path(name).c_str(), 0600), 0);
+    nodes_.push_back(name);
+  }
+
+  std::string directory_;
+  std::vector<std::string> nodes_;
+};
+
+}  // namespace
+
+TEST(HasGamepadButtons, MatchesGamepadsAndJoysticksButNotKeyboards) {
+  uint8_t pad[KEY_CNT / 8] = {};
+  pad[BTN_SOUTH / 8] |= 1u << (BTN_SOUTH % 8);
+  EXPECT_TRUE(HasGamepadButtons(pad, sizeof(pad)));
+
+  uint8_t joystick[KEY_CNT / 8] = {};
+  joystick[BTN_TRIGGER / 8] |= 1u << (BTN_TRIGGER % 8);
+  EXPECT_TRUE(HasGamepadButtons(joystick, sizeof(joystick)));
+
+  uint8_t keyboard[KEY_CNT / 8] = {};
+  keyboard[KEY_A / 8] |= 1u << (KEY_A % 8);
+  keyboard[BTN_LEFT / 8] |= 1u << (BTN_LEFT % 8);
+  EXPECT_FALSE(HasGamepadButtons(keyboard, sizeof(keyboard)));
+}
+
+TEST(EvdevGamepadDecoder, ReportsOnlyStateChangesWithKernelTimestamps) {
+  EvdevGamepadDecoder decoder(4, XboxPad(), GamepadState::Options());
+  EXPECT_EQ(DecodeAll(&decoder, {std::begin(kPressAndPush), std::end(kPressAndPush)}),
+            (std::vector<GamepadEvent>{{4, BTN_SOUTH, true, 1000000},
+                                       {4, GamepadAxisButton(ABS_X, true), true, 1008000}}));
+}
+
+TEST(EvdevGamepadDecoder, ResyncsAfterDroppedEvents) {
+  EvdevGamepadDecoder decoder(0, XboxPad(), GamepadState::Options());
+  std::vector<GamepadEvent> events;
+  decoder.Decode(MakeEvent(EV_KEY, BTN_SOUTH, 1, 10), &events);
+  EXPECT_FALSE(decoder.Decode(MakeEvent(EV_SYN, SYN_DROPPED, 0, 20), &events));
+  EXPECT_FALSE(decoder.Decode(MakeEvent(EV_KEY, BTN_EAST, 1, 30), &events));
+  EXPECT_TRUE(decoder.Decode(MakeEvent(EV_SYN, SYN_REPORT, 0, 40), &events));
+  EXPECT_EQ(events.size(), 1u);
+
+  // A was released, B pressed and the hat pushed left meanwhile.
+  std::vector<uint16_t> buttons = {BTN_EAST};
+  std::vector<std::pair<uint16_t, int32_t>> axes = {{ABS_X, 0}, {ABS_HAT0X, -1}};
+  events.clear();
+  decoder.Resync(&buttons, &axes, 40, &events);
+  const uint32_t hat_left = GamepadAxisButton(ABS_HAT0X, false);
+  EXPECT_EQ(events, (std::vector<GamepadEvent>{{0, BTN_SOUTH, false, 40},
+                                               {0, BTN_EAST, true, 40},
+                                               {0, hat_left, true, 40}}));
+
+  // Without the device state everything counts as released.
+  events.clear();
+  decoder.Resync(nullptr, nullptr, 50, &events);
+  EXPECT_EQ(events, (std::vector<GamepadEvent>{{0, BTN_EAST, false, 50},
+                                               {0, hat_left, false, 50}}));
+}
+
+TEST_F(EvdevGamepadReaderTest, FailsWithoutTheDirectory) {
+  Recorder recorder;
+  EvdevGamepadReader reader(recorder.callback(), recorder.hotplug_callback(), {},
+                            directory_ + "/missing", ProbeXboxPad);
+  EXPECT_FALSE(reader.Start());
+}
+
+TEST_F(EvdevGamepadReaderTest, ReportsGamepadsPresentAtStart) {
+  CreateNode("event3");
+  CreateNode("js0");
+  Recorder recorder;
+  EvdevGamepadReader reader(recorder.callback(), recorder.hotplug_callback(), {}, directory_,
+                            ProbeXboxPad);
+  ASSERT_TRUE(reader.Start());
+
+  EXPECT_EQ(recorder.hotplugs(), (std::vector<std::pair<uint16_t, bool>>{{3, true}}));
+  std::vector<GamepadInfo> devices = reader.Devices();
+  ASSERT_EQ(devices.size(), 1u);
+  EXPECT_EQ(devices[0].name, "Xbox Wireless Controller");
+  EXPECT_EQ(devices[0].vendor_id, 0x045e);
+}
+
+TEST_F(EvdevGamepadReaderTest, HotplugsAndReleasesOnDisconnect) {
+  Recorder recorder;
+  EvdevGamepadReader reader(recorder.callback(), recorder.hotplug_callback(), {}, directory_,
+                            ProbeXboxPad);
+  ASSERT_TRUE(reader.Start());
+
+  CreateNode("event9");
+  int node = open(Path("event9").c_str(), O_WRONLY | O_CLOEXEC);
+  ASSERT_GE(node, 0);
+  ASSERT_TRUE(recorder.WaitFor(0, 1));
+  ASSERT_EQ(write(node, kPressAndPush, sizeof(kPressAndPush)),
+            static_cast<ssize_t>(sizeof(kPressAndPush)));
+  ASSERT_TRUE(recorder.WaitFor(2, 1));
+
+  // Pulling the plug releases what was held, then reports the disconnect.
+  close(node);
+  ASSERT_TRUE(recorder.WaitFor(4, 2));
+  std::vector<GamepadEvent> events = recorder.events();
+  EXPECT_EQ(events[0], (GamepadEvent{9, BTN_SOUTH, true, 1000000}));
+  EXPECT_EQ(events[1], (GamepadEvent{9, GamepadAxisButton(ABS_X, true), true, 1008000}));
+  EXPECT_FALSE(events[2].pressed);
+  EXPECT_FALSE(events[3].pressed);
+  EXPECT_EQ(recorder.hotplugs(),
+            (std::vector<std::pair<uint16_t, bool>>{{9, true}, {9, false}}));
+  EXPECT_TRUE(reader.Devices().empty());
+}
+
+}  // namespace test
+}  // namespace media_key_detector_linux
@@ -0,0 +1,276 @@
+#include "evdev_media_keys.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace media_key_detector_linux {
+namespace test {
+
+namespace {
+
+constexpr std::chrono::seconds kTimeout(5);
+
+input_event MakeEvent(uint16_t type, uint16_t code, int32_t value, int64_t timestamp_us = 0) {
+  input_event event = {};
+  event.input_event_sec = timestamp_us / 1000000;
+  event.input_event_usec = timestamp_us % 1000000;
+  event.type = type;
+  event.code = code;
+  event.value = value;
+  return event;
+}
+
+// A press and release of the "next" button of a BLE media remote, as read
+// from its event node.
+const input_event kNextTap[] = {
+    MakeEvent(EV_MSC, MSC_SCAN, 0xc00b5, 1000000), MakeEvent(EV_KEY, KEY_NEXTSONG, 1, 1000000),
+    MakeEvent(EV_SYN, SYN_REPORT, 0, 1000000),     MakeEvent(EV_MSC, MSC_SCAN, 0xc00b5, 1080500),
+    MakeEvent(EV_KEY, KEY_NEXTSONG, 0, 1080500),   MakeEvent(EV_SYN, SYN_REPORT, 0, 1080500),
+};
+
+void SetBit(uint8_t* bits, uint16_t code) {
+  bits[code / 8] |= 1u << (code % 8);
+}
+
+std::vector<MediaKeyEvent> DecodeAll(EvdevKeyDecoder* decoder,
+                                     const std::vector<input_event>& input) {
+  std::vector<MediaKeyEvent> events;
+  for (const input_event& event : input) {
+    EXPECT_FALSE(decoder->Decode(event, &events));
+  }
+  return events;
+}
+
+// Collects the batches reported on the reader thread.
+class BatchRecorder {
+ public:
+  EvdevMediaKeyReader::Callback callback() {
+    return [this](const std::vector<MediaKeyEvent>& events) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batches_.push_back(events);
+      condition_.notify_all();
+    };
+  }
+
+  // Waits until |count| batches have been reported.
+  bool WaitForBatches(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, kTimeout, [&] { return batches_.size() >= count; });
+  }
+
+  std::vector<std::vector<MediaKeyEvent>> batches() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batches_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<std::vector<MediaKeyEvent>> batches_;
+};
+
+// Stands in for /dev/input with named pipes, which replay recorded events
+// like an evdev node would deliver them.
+class EvdevMediaKeyReaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    char directory[] = "/tmp/evdev_media_keys_test_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    directory_ = directory;
+  }
+
+  void TearDown() override {
+    for (int fd : writers_) {
+      close(fd);
+    }
+    for (const std::string& name : nodes_) {
+      unlink(Path(name).c_str());
+    }
+    rmdir(directory_.c_str());
+  }
+
+  std::string Path(const std::string& name) const { return directory_ + "/" + name; }
+
+  void CreateNode(const std::string& name) {
+    ASSERT_EQ(mkfifo(Path(name).c_str(), 0600), 0);
+    nodes_.push_back(name);
+  }
+
+  // Connects to the node once the reader opened it. Blocks until then.
+  int ConnectNode(const std::string& name) {
+    int fd = open(Path(name).c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd >= 0) {
+      writers_.push_back(fd);
+    }
+    return fd;
+  }
+
+  void Unplug(int fd) {
+    close(fd);
+    writers_.erase(std::find(writers_.begin(), writers_.end(), fd));
+  }
+
+  std::string directory_;
+  std::vector<std::string> nodes_;
+  std::vector<int> writers_;
+};
+
+bool AcceptAll(int fd) {
+  return true;
+}
+
+}  // namespace
+
+TEST(MediaKeyForEvdevCode, MapsLikeTheWindowsPlugin) {
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_PLAYPAUSE), MEDIA_KEY_PLAY_PAUSE);
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_PREVIOUSSONG), MEDIA_KEY_REWIND);
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_NEXTSONG), MEDIA_KEY_FAST_FORWARD);
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_VOLUMEUP), MEDIA_KEY_VOLUME_UP);
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_VOLUMEDOWN), MEDIA_KEY_VOLUME_DOWN);
+  EXPECT_EQ(MediaKeyForEvdevCode(KEY_A), -1);
+}
+
+TEST(HasMediaKeys, MatchesRemotesButNotMice) {
+  uint8_t remote[KEY_CNT / 8] = {};
+  SetBit(remote, KEY_PLAYPAUSE);
+  SetBit(remote, KEY_NEXTSONG);
+  EXPECT_TRUE(HasMediaKeys(remote, sizeof(remote)));
+
+  uint8_t mouse[KEY_CNT / 8] = {};
+  SetBit(mouse, BTN_LEFT);
+  SetBit(mouse, BTN_RIGHT);
+  EXPECT_FALSE(HasMediaKeys(mouse, sizeof(mouse)));
+
+  // The kernel returns fewer bytes than asked for when the highest code is
+  // low.
+  EXPECT_FALSE(HasMediaKeys(remote, KEY_PLAYPAUSE / 8));
+}
+
+TEST(EvdevKeyDecoder, ReportsPressAndReleaseWithKernelTimestamps) {
+  EvdevKeyDecoder decoder;
+  EXPECT_EQ(DecodeAll(&decoder, {std::begin(kNextTap), std::end(kNextTap)}),
+            (std::vector<MediaKeyEvent>{{MEDIA_KEY_FAST_FORWARD, true, 1000000},
+                                        {MEDIA_KEY_FAST_FORWARD, false, 1080500}}));
+}
+
+TEST(EvdevKeyDecoder, DropsRepeatsAndOtherKeys) {
+  EvdevKeyDecoder decoder;
+  EXPECT_EQ(DecodeAll(&decoder,
+                      {
+                          MakeEvent(EV_KEY, KEY_VOLUMEUP, 1, 10),
+                          MakeEvent(EV_KEY, KEY_VOLUMEUP, 2, 20),
+                          MakeEvent(EV_KEY, KEY_VOLUMEUP, 2, 30),
+                          MakeEvent(EV_KEY, KEY_A, 1, 40),
+                          MakeEvent(EV_KEY, KEY_VOLUMEUP, 0, 50),
+                          // Held before the device was opened.
+                          MakeEvent(EV_KEY, KEY_PLAYPAUSE, 0, 60),
+                      }),
+            (std::vector<MediaKeyEvent>{{MEDIA_KEY_VOLUME_UP, true, 10},
+                                        {MEDIA_KEY_VOLUME_UP, false, 50}}));
+}
+
+TEST(EvdevKeyDecoder, ResyncsAfterDroppedEvents) {
+  EvdevKeyDecoder decoder;
+  std::vector<MediaKeyEvent> events;
+  decoder.Decode(MakeEvent(EV_KEY, KEY_PLAYPAUSE, 1, 10), &events);
+  EXPECT_FALSE(decoder.Decode(MakeEvent(EV_SYN, SYN_DROPPED, 0, 20), &events));
+  // Partial state up to the next report is to be ignored.
+  EXPECT_FALSE(decoder.Decode(MakeEvent(EV_KEY, KEY_NEXTSONG, 1, 30), &events));
+  EXPECT_TRUE(decoder.Decode(MakeEvent(EV_SYN, SYN_REPORT, 0, 40), &events));
+  EXPECT_EQ(events.size(), 1u);
+
+  // Play/pause was released and volume down pressed in the meantime.
+  EvdevKeyDecoder::KeyBits held;
+  held[KEY_VOLUMEDOWN] = true;
+  events.clear();
+  decoder.Resync(&held, 40, &events);
+  EXPECT_EQ(events, (std::vector<MediaKeyEvent>{{MEDIA_KEY_PLAY_PAUSE, false, 40},
+                                                {MEDIA_KEY_VOLUME_DOWN, true, 40}}));
+
+  // Without the device state everything counts as released.
+  events.clear();
+  decoder.Resync(nullptr, 50, &events);
+  EXPECT_EQ(events, (std::vector<MediaKeyEvent>{{MEDIA_KEY_VOLUME_DOWN, false, 50}}));
+}
+
+TEST_F(EvdevMediaKeyReaderTest, FailsWithoutTheDirectory) {
+  BatchRecorder recorder;
+  EvdevMediaKeyReader reader(recorder.callback(), directory_ + "/missing", AcceptAll);
+  EXPECT_FALSE(reader.Start());
+}
+
+TEST_F(EvdevMediaKeyReaderTest, OpensOnlyEventNodesThatPassTheFilter) {
+  CreateNode("event3");
+  CreateNode("event4");
+  CreateNode("mouse0");
+  std::vector<int> filtered;
+  BatchRecorder recorder;
+  EvdevMediaKeyReader reader(recorder.callback(), directory_, [&](int fd) {
+    filtered.push_back(fd);
+    return filtered.size() == 1;
+  });
+  ASSERT_TRUE(reader.Start());
+  EXPECT_EQ(filtered.size(), 2u);
+}
+
+TEST_F(EvdevMediaKeyReaderTest, DeliversTheEventsOfOneWakeupAsABatch) {
+  CreateNode("event0");
+  BatchRecorder recorder;
+  EvdevMediaKeyReader reader(recorder.callback(), directory_, AcceptAll);
+  ASSERT_TRUE(reader.Start());
+
+  int node = ConnectNode("event0");
+  ASSERT_GE(node, 0);
+  ASSERT_EQ(write(node, kNextTap, sizeof(kNextTap)), static_cast<ssize_t>(sizeof(kNextTap)));
+  ASSERT_TRUE(recorder.WaitForBatches(1));
+  EXPECT_EQ(recorder.batches()[0],
+            (std::vector<MediaKeyEvent>{{MEDIA_KEY_FAST_FORWARD, true, 1000000},
+                                        {MEDIA_KEY_FAST_FORWARD, false, 1080500}}));
+}
+
+TEST_F(EvdevMediaKeyReaderTest, PicksUpDevicesPluggedInLater) {
+  BatchRecorder recorder;
+  EvdevMediaKeyReader reader(recorder.callback(), directory_, AcceptAll);
+  ASSERT_TRUE(reader.Start());
+
+  CreateNode("event7");
+  int node = ConnectNode("event7");
+  ASSERT_GE(node, 0);
+  const input_event press = MakeEvent(EV_KEY, KEY_PLAYPAUSE, 1, 5);
+  ASSERT_EQ(write(node, &press, sizeof(press)), static_cast<ssize_t>(sizeof(press)));
+  ASSERT_TRUE(recorder.WaitForBatches(1));
+
+  // The remote disconnects and comes back under the same name, so the events
+  // keep their device number.
+  Unplug(node);
+  unlink(Path("event7").c_str());
+  nodes_.pop_back();
+  CreateNode("event7");
+  node = ConnectNode("event7");
+  ASSERT_GE(node, 0);
+  // One write, so that both events arrive in the same wakeup.
+  const input_event tap[] = {press, MakeEvent(EV_KEY, KEY_PLAYPAUSE, 0, 9)};
+  ASSERT_EQ(write(node, tap, sizeof(tap)), static_cast<ssize_t>(sizeof(tap)));
+  ASSERT_TRUE(recorder.WaitForBatches(2));
+
+  std::vector<MediaKeyEvent> events;
+  for (const auto& batch : recorder.batches()) {
+    events.insert(events.end(), batch.begin(), batch.end());
+  }
+  EXPECT_EQ(events.front(), (MediaKeyEvent{MEDIA_KEY_PLAY_PAUSE, true, 5, 7}));
+  EXPECT_EQ(events.back(), (MediaKeyEvent{MEDIA_KEY_PLAY_PAUSE, false, 9, 7}));
+}
+
+}  // namespace test
+}  // namespace media_key_detector_linux
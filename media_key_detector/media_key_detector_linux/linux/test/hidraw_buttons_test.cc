@@ -0,0 +1,242 @@
+#include "hidraw_buttons.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hid_recording.h"
+
+namespace media_key_detector_linux {
+namespace test {
+
+namespace {
+
+using media_key_detector_core::HidUsage;
+using media_key_detector_core::kHidPageConsumer;
+using media_key_detector_core::test::HidRecording;
+using media_key_detector_core::test::LoadHidRecording;
+
+constexpr std::chrono::seconds kTimeout(5);
+constexpr uint32_t kPlayPause = HidUsage(kHidPageConsumer, 0xCD);
+constexpr uint32_t kVolumeUp = HidUsage(kHidPageConsumer, 0xE9);
+constexpr uint32_t kVolumeDown = HidUsage(kHidPageConsumer, 0xEA);
+
+// Collects the events reported on the reader thread.
+class EventRecorder {
+ public:
+  HidrawButtonReader::Callback callback() {
+    return [this](const std::vector<HidButtonEvent>& events) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.insert(events_.end(), events.begin(), events.end());
+      condition_.notify_all();
+    };
+  }
+
+  // Waits until |count| events have been reported.
+  bool WaitForEvents(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, kTimeout, [&] { return events_.size() >= count; });
+  }
+
+  std::vector<HidButtonEvent> events() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<HidButtonEvent> events_;
+};
+
+// Stands in for /dev with named pipes, which replay recorded reports like a
+// hidraw node would deliver them. The descriptors come from the recordings
+// rather than an ioctl.
+class HidrawButtonReaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    char directory[] = "/tmp/hidraw_buttons_test_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    directory_ = directory;
+  }
+
+  void TearDown() override {
+    for (int fd : writers_) {
+      close(fd);
+    }
+    for (const auto& node : nodes_) {
+      unlink(Path(node.first).c_str());
+    }
+    rmdir(directory_.c_str());
+  }
+
+  std::string Path(const std::string& name) const { return directory_ + "/" + name; }
+
+  // Creates the node |name| for the device recorded in |file|.
+  void CreateNode(const std::string& name, const std::string& file) {
+    HidRecording recording;
+    ASSERT_TRUE(LoadHidRecording(file, &recording)) << file;
+    ASSERT_EQ(mkfifo(Path(name).c_str(), 0600), 0);
+    nodes_.emplace_back(name, recording);
+  }
+
+  HidrawButtonReader::DescriptorReader descriptor_reader() {
+    return [this](int fd, std::vector<uint8_t>* descriptor) {
+      char link[64];
+      char path[4096];
+      snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+      ssize_t size = readlink(link, path, sizeof(path) - 1);
+      if (size < 0) {
+        return false;
+      }
+      path[size] = '\0';
+      for (const auto& node : nodes_) {
+        if (Path(node.first) == path) {
+          *descriptor = node.second.descriptor;
+          return true;
+        }
+      }
+      return false;
+    };
+  }
+
+  // Connects to the node once the reader opened it. Blocks until then.
+  int ConnectNode(const std::string& name) {
+    int fd = open(Path(name).c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd >= 0) {
+      writers_.push_back(fd);
+    }
+    return fd;
+  }
+
+  // Waits until the reader took everything written to |fd|.
+  static bool WaitUntilRead(int fd) {
+    auto deadline = std::chrono::steady_clock::now() + kTimeout;
+    int pending = 0;
+    while (ioctl(fd, FIONREAD, &pending) == 0 && pending > 0) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return pending == 0;
+  }
+
+  // Writes the recorded reports of |name| one at a time, waiting until each
+  // was read so that the pipe does not merge them.
+  void Replay(const std::string& name, int fd, EventRecorder* recorder,
+              const std::vector<size_t>& edges_per_report) {
+    const HidRecording* recording = nullptr;
+    for (const auto& node : nodes_) {
+      if (node.first == name) {
+        recording = &node.second;
+      }
+    }
+    ASSERT_NE(recording, nullptr);
+    ASSERT_EQ(recording->reports.size(), edges_per_report.size());
+    size_t expected = recorder->events().size();
+    for (size_t i = 0; i < recording->reports.size(); i++) {
+      const std::vector<uint8_t>& report = recording->reports[i].data;
+      ASSERT_EQ(write(fd, report.data(), report.size()), static_cast<ssize_t>(report.size()));
+      ASSERT_TRUE(WaitUntilRead(fd));
+      expected += edges_per_report[i];
+      ASSERT_TRUE(recorder->WaitForEvents(expected));
+    }
+  }
+
+  std::string directory_;
+  std::vector<std::pair<std::string, HidRecording>> nodes_;
+  std::vector<int> writers_;
+};
+
+std::vector<std::pair<uint32_t, bool>> Edges(const std::vector<HidButtonEvent>& events) {
+  std::vector<std::pair<uint32_t, bool>> edges;
+  for (const HidButtonEvent& event : events) {
+    edges.emplace_back(event.usage, event.pressed);
+  }
+  return edges;
+}
+
+}  // namespace
+
+TEST_F(HidrawButtonReaderTest, FailsWithoutTheDirectory) {
+  EventRecorder recorder;
+  HidrawButtonReader reader(recorder.callback(), directory_ + "/missing", descriptor_reader());
+  EXPECT_FALSE(reader.Start());
+}
+
+TEST_F(HidrawButtonReaderTest, OpensOnlyHidrawNodesWithButtons) {
+  CreateNode("hidraw2", "consumer_remote.hid");
+  CreateNode("hidraw3", "mouse.hid");
+  CreateNode("event2", "consumer_remote.hid");
+  EventRecorder recorder;
+  HidrawButtonReader reader(recorder.callback(), directory_, descriptor_reader());
+  ASSERT_TRUE(reader.Start());
+
+  std::vector<HidrawDeviceInfo> devices = reader.Devices();
+  ASSERT_EQ(devices.size(), 1u);
+  EXPECT_EQ(devices[0].device, 2);
+}
+
+TEST_F(HidrawButtonReaderTest, DecodesRecordedReports) {
+  CreateNode("hidraw0", "consumer_remote.hid");
+  EventRecorder recorder;
+  HidrawButtonReader reader(recorder.callback(), directory_, descriptor_reader());
+  ASSERT_TRUE(reader.Start());
+
+  int node = ConnectNode("hidraw0");
+  ASSERT_GE(node, 0);
+  Replay("hidraw0", node, &recorder, {0, 0, 1, 1, 1, 1, 2});
+
+  std::vector<HidButtonEvent> events = recorder.events();
+  EXPECT_EQ(Edges(events), (std::vector<std::pair<uint32_t, bool>>{{kPlayPause, true},
+                                                                   {kPlayPause, false},
+                                                                   {kVolumeUp, true},
+                                                                   {kVolumeDown, true},
+                                                                   {kVolumeUp, false},
+                                                                   {kVolumeDown, false}}));
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_EQ(events[i].device, 0);
+    EXPECT_GT(events[i].timestamp_us, 0);
+    if (i > 0) {
+      EXPECT_GE(events[i].timestamp_us, events[i - 1].timestamp_us);
+    }
+  }
+}
+
+TEST_F(HidrawButtonReaderTest, ReleasesHeldButtonsOfUnpluggedDevices) {
+  EventRecorder recorder;
+  HidrawButtonReader reader(recorder.callback(), directory_, descriptor_reader());
+  ASSERT_TRUE(reader.Start());
+
+  // Plugged in after the start.
+  CreateNode("hidraw5", "consumer_array.hid");
+  int node = ConnectNode("hidraw5");
+  ASSERT_GE(node, 0);
+  const uint8_t play_pause[] = {0xCD, 0x00};
+  ASSERT_EQ(write(node, play_pause, sizeof(play_pause)), 2);
+  ASSERT_TRUE(recorder.WaitForEvents(1));
+  EXPECT_EQ(reader.Devices().size(), 1u);
+
+  close(node);
+  writers_.clear();
+  ASSERT_TRUE(recorder.WaitForEvents(2));
+  std::vector<HidButtonEvent> events = recorder.events();
+  EXPECT_EQ(Edges(events),
+            (std::vector<std::pair<uint32_t, bool>>{{kPlayPause, true}, {kPlayPause, false}}));
+  EXPECT_EQ(events[1].device, 5);
+  EXPECT_TRUE(reader.Devices().empty());
+}
+
+}  // namespace test
+}  // namespace media_key_detector_linux
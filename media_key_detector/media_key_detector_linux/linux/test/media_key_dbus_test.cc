@@ -0,0 +1,289 @@
+#include "media_key_dbus.h"
+
+#include <gio/gio.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace media_key_detector_linux {
+namespace test {
+
+namespace {
+
+constexpr char kAppName[] = "bike_control_test";
+constexpr char kMprisName[] = "org.mpris.MediaPlayer2.bike_control_test";
+constexpr char kMprisPath[] = "/org/mpris/MediaPlayer2";
+constexpr char kMprisPlayerInterface[] = "org.mpris.MediaPlayer2.Player";
+
+constexpr char kGsdName[] = "org.gnome.SettingsDaemon.MediaKeys";
+constexpr char kGsdPath[] = "/org/gnome/SettingsDaemon/MediaKeys";
+
+constexpr char kGsdIntrospection[] = R"(<node>
+  <interface name="org.gnome.SettingsDaemon.MediaKeys">
+    <method name="GrabMediaPlayerKeys">
+      <arg name="application" type="s" direction="in"/>
+      <arg name="time" type="u" direction="in"/>
+    </method>
+    <method name="ReleaseMediaPlayerKeys">
+      <arg name="application" type="s" direction="in"/>
+    </method>
+    <signal name="MediaPlayerKeyPressed">
+      <arg name="application" type="s"/>
+      <arg name="key" type="s"/>
+    </signal>
+  </interface>
+</node>)";
+
+constexpr gint64 kTimeoutUs = 5 * G_USEC_PER_SEC;
+
+// Runs the default main context, which serves the listener and the fake
+// settings daemon, until |done| returns true. Returns false on timeout.
+bool RunUntil(const std::function<bool()>& done) {
+  // Wakes the loop up regularly to check |done| and the deadline.
+  guint tick = g_timeout_add(10, [](gpointer) { return gboolean(G_SOURCE_CONTINUE); }, nullptr);
+  gint64 deadline = g_get_monotonic_time() + kTimeoutUs;
+  bool result = true;
+  while (!done()) {
+    if (g_get_monotonic_time() > deadline) {
+      result = false;
+      break;
+    }
+    g_main_context_iteration(nullptr, TRUE);
+  }
+  g_source_remove(tick);
+  return result;
+}
+
+// Stands in for gnome-settings-daemon on the test bus.
+class FakeSettingsDaemon {
+ public:
+  explicit FakeSettingsDaemon(GDBusConnection* connection) : connection_(connection) {
+    static const GDBusInterfaceVTable vtable = {HandleMethodCall, nullptr, nullptr};
+    node_info_ = g_dbus_node_info_new_for_xml(kGsdIntrospection, nullptr);
+    registration_id_ = g_dbus_connection_register_object(
+        connection_, kGsdPath, node_info_->interfaces[0], &vtable, this, nullptr, nullptr);
+    owner_id_ = g_bus_own_name_on_connection(connection_, kGsdName, G_BUS_NAME_OWNER_FLAGS_NONE,
+                                             nullptr, nullptr, nullptr, nullptr);
+  }
+
+  ~FakeSettingsDaemon() {
+    g_bus_unown_name(owner_id_);
+    g_dbus_connection_unregister_object(connection_, registration_id_);
+    g_dbus_node_info_unref(node_info_);
+  }
+
+  void PressKey(const char* application, const char* key) {
+    g_dbus_connection_emit_signal(connection_, nullptr, kGsdPath, kGsdName,
+                                  "MediaPlayerKeyPressed",
+                                  g_variant_new("(ss)", application, key), nullptr);
+  }
+
+  // "<method> <application>" for every call received.
+  const std::vector<std::string>& calls() const { return calls_; }
+
+ private:
+  static void HandleMethodCall(GDBusConnection* connection, const gchar* sender,
+                               const gchar* object_path, const gchar* interface_name,
+                               const gchar* method_name, GVariant* parameters,
+                               GDBusMethodInvocation* invocation, gpointer user_data) {
+    auto* self = static_cast<FakeSettingsDaemon*>(user_data);
+    const gchar* application = nullptr;
+    g_variant_get_child(parameters, 0, "&s", &application);
+    self->calls_.push_back(std::string(method_name) + " " + application);
+    g_dbus_method_invocation_return_value(invocation, nullptr);
+  }
+
+  GDBusConnection* connection_;
+  GDBusNodeInfo* node_info_;
+  guint registration_id_;
+  guint owner_id_;
+  std::vector<std::string> calls_;
+};
+
+// Runs every test against a private dbus-daemon.
+class MediaKeyDBusTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    g_autofree gchar* daemon = g_find_program_in_path("dbus-daemon");
+    if (daemon == nullptr) {
+      GTEST_SKIP() << "dbus-daemon is not installed";
+    }
+    bus_ = g_test_dbus_new(G_TEST_DBUS_NONE);
+    g_test_dbus_up(bus_);
+    listener_connection_ = Connect();
+    client_ = Connect();
+    ASSERT_NE(listener_connection_, nullptr);
+    ASSERT_NE(client_, nullptr);
+    listener_ = media_key_dbus_new(listener_connection_, kAppName, OnKey, this);
+  }
+
+  void TearDown() override {
+    if (listener_ != nullptr) {
+      media_key_dbus_free(listener_);
+    }
+    g_clear_object(&client_);
+    g_clear_object(&listener_connection_);
+    if (bus_ != nullptr) {
+      g_test_dbus_down(bus_);
+      g_clear_object(&bus_);
+    }
+  }
+
+  GDBusConnection* Connect() {
+    g_autoptr(GError) error = nullptr;
+    GDBusConnection* connection = g_dbus_connection_new_for_address_sync(
+        g_test_dbus_get_bus_address(bus_),
+        static_cast<GDBusConnectionFlags>(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                          G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+        nullptr, nullptr, &error);
+    EXPECT_EQ(error, nullptr) << error->message;
+    return connection;
+  }
+
+  bool HasOwner(const char* name) {
+    g_autoptr(GVariant) reply = g_dbus_connection_call_sync(
+        client_, "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+        "NameHasOwner", g_variant_new("(s)", name), G_VARIANT_TYPE("(b)"),
+        G_DBUS_CALL_FLAGS_NONE, -1, nullptr, nullptr);
+    gboolean has_owner = FALSE;
+    if (reply != nullptr) {
+      g_variant_get(reply, "(b)", &has_owner);
+    }
+    return has_owner;
+  }
+
+  // Calls |method| on the MPRIS player from the client connection. The
+  // listener is served from this thread, so a blocking call would deadlock.
+  GVariant* CallPlayer(const char* interface_name, const char* method,
+                       GVariant* parameters = nullptr) {
+    struct PendingCall {
+      bool done = false;
+      GVariant* reply = nullptr;
+    };
+    // Leaked on timeout, when the reply may still arrive.
+    auto* call = new PendingCall();
+    g_dbus_connection_call(
+        client_, kMprisName, kMprisPath, interface_name, method, parameters, nullptr,
+        G_DBUS_CALL_FLAGS_NONE, -1, nullptr,
+        [](GObject* object, GAsyncResult* result, gpointer user_data) {
+          auto* call = static_cast<PendingCall*>(user_data);
+          call->reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(object), result, nullptr);
+          call->done = true;
+        },
+        call);
+    if (!RunUntil([call] { return call->done; })) {
+      ADD_FAILURE() << method << " timed out";
+      return nullptr;
+    }
+    GVariant* reply = call->reply;
+    delete call;
+    return reply;
+  }
+
+  // Reads an MPRIS property.
+  GVariant* GetProperty(const char* interface_name, const char* property) {
+    g_autoptr(GVariant) reply = CallPlayer("org.freedesktop.DBus.Properties", "Get",
+                                           g_variant_new("(ss)", interface_name, property));
+    if (reply == nullptr) {
+      return nullptr;
+    }
+    GVariant* value = nullptr;
+    g_variant_get(reply, "(v)", &value);
+    return value;
+  }
+
+  static void OnKey(MediaKeyIndex key, gpointer user_data) {
+    static_cast<MediaKeyDBusTest*>(user_data)->keys_.push_back(key);
+  }
+
+  GTestDBus* bus_ = nullptr;
+  GDBusConnection* listener_connection_ = nullptr;
+  GDBusConnection* client_ = nullptr;
+  MediaKeyDBus* listener_ = nullptr;
+  std::vector<MediaKeyIndex> keys_;
+};
+
+}  // namespace
+
+TEST_F(MediaKeyDBusTest, OwnsTheMprisNameOnlyWhileActive) {
+  EXPECT_FALSE(HasOwner(kMprisName));
+
+  media_key_dbus_set_active(listener_, TRUE);
+  EXPECT_TRUE(media_key_dbus_get_active(listener_));
+  EXPECT_TRUE(RunUntil([this] { return HasOwner(kMprisName); }));
+
+  media_key_dbus_set_active(listener_, FALSE);
+  EXPECT_TRUE(RunUntil([this] { return !HasOwner(kMprisName); }));
+  EXPECT_TRUE(keys_.empty());
+}
+
+TEST_F(MediaKeyDBusTest, ReportsMprisPlayerCommands) {
+  media_key_dbus_set_active(listener_, TRUE);
+  ASSERT_TRUE(RunUntil([this] { return HasOwner(kMprisName); }));
+
+  for (const char* method : {"PlayPause", "Next", "Previous", "Pause"}) {
+    g_autoptr(GVariant) reply = CallPlayer(kMprisPlayerInterface, method);
+    EXPECT_NE(reply, nullptr) << method;
+  }
+  // Seeking has no media key.
+  g_autoptr(GVariant) reply =
+      CallPlayer(kMprisPlayerInterface, "Seek", g_variant_new("(x)", G_GINT64_CONSTANT(10)));
+  EXPECT_NE(reply, nullptr);
+
+  EXPECT_EQ(keys_, (std::vector<MediaKeyIndex>{MEDIA_KEY_PLAY_PAUSE, MEDIA_KEY_FAST_FORWARD,
+                                               MEDIA_KEY_REWIND, MEDIA_KEY_PLAY_PAUSE}));
+}
+
+TEST_F(MediaKeyDBusTest, DescribesAControllablePlayer) {
+  media_key_dbus_set_active(listener_, TRUE);
+  ASSERT_TRUE(RunUntil([this] { return HasOwner(kMprisName); }));
+
+  g_autoptr(GVariant) can_control = GetProperty(kMprisPlayerInterface, "CanControl");
+  ASSERT_NE(can_control, nullptr);
+  EXPECT_TRUE(g_variant_get_boolean(can_control));
+
+  g_autoptr(GVariant) status = GetProperty(kMprisPlayerInterface, "PlaybackStatus");
+  ASSERT_NE(status, nullptr);
+  EXPECT_STREQ(g_variant_get_string(status, nullptr), "Playing");
+
+  g_autoptr(GVariant) identity = GetProperty("org.mpris.MediaPlayer2", "Identity");
+  ASSERT_NE(identity, nullptr);
+  EXPECT_STREQ(g_variant_get_string(identity, nullptr), kAppName);
+}
+
+TEST_F(MediaKeyDBusTest, GrabsKeysFromTheSettingsDaemon) {
+  FakeSettingsDaemon settings_daemon(client_);
+  media_key_dbus_set_active(listener_, TRUE);
+  ASSERT_TRUE(RunUntil([&] { return !settings_daemon.calls().empty(); }));
+  EXPECT_EQ(settings_daemon.calls(),
+            (std::vector<std::string>{"GrabMediaPlayerKeys bike_control_test"}));
+
+  settings_daemon.PressKey(kAppName, "Next");
+  // Meant for another player that grabbed the keys as well.
+  settings_daemon.PressKey("some_player", "Play");
+  settings_daemon.PressKey(kAppName, "Play");
+  ASSERT_TRUE(RunUntil([this] { return keys_.size() == 2; }));
+  EXPECT_EQ(keys_,
+            (std::vector<MediaKeyIndex>{MEDIA_KEY_FAST_FORWARD, MEDIA_KEY_PLAY_PAUSE}));
+
+  media_key_dbus_set_active(listener_, FALSE);
+  ASSERT_TRUE(RunUntil([&] { return settings_daemon.calls().size() == 2; }));
+  EXPECT_EQ(settings_daemon.calls()[1], "ReleaseMediaPlayerKeys bike_control_test");
+}
+
+TEST_F(MediaKeyDBusTest, GrabsAgainWhenTheSettingsDaemonRestarts) {
+  media_key_dbus_set_active(listener_, TRUE);
+  {
+    FakeSettingsDaemon settings_daemon(client_);
+    EXPECT_TRUE(RunUntil([&] { return settings_daemon.calls().size() == 1; }));
+  }
+  EXPECT_TRUE(RunUntil([this] { return !HasOwner(kGsdName); }));
+
+  FakeSettingsDaemon restarted(client_);
+  EXPECT_TRUE(RunUntil([&] { return restarted.calls().size() == 1; }));
+}
+
+}  // namespace test
+}  // namespace media_key_detector_linux
@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:media_key_detector_linux/media_key_detector_linux.dart';
@@ -22,6 +24,16 @@ void main() {
         switch (methodCall.method) {
           case 'getPlatformName':
             return kPlatformName;
+          case 'getIsPlaying':
+            return true;
+          case 'getGamepads':
+            return [
+              {'device': 21, 'name': 'Xbox Wireless Controller', 'vendorId': 0x045e, 'productId': 0x0b13},
+            ];
+          case 'getHidDevices':
+            return [
+              {'device': 2, 'name': 'Page Turner', 'vendorId': 0x248a, 'productId': 0x8266},
+            ];
           default:
             return null;
         }
@@ -41,5 +53,179 @@ void main() {
       );
       expect(name, equals(kPlatformName));
     });
+
+    test('getIsPlaying asks the platform', () async {
+      expect(await mediaKeyDetector.getIsPlaying(), isTrue);
+      expect(log, <Matcher>[isMethodCall('getIsPlaying', arguments: null)]);
+    });
+
+    test('setUseEvdev passes the choice on', () async {
+      await mediaKeyDetector.setUseEvdev(useEvdev: true);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setUseEvdev', arguments: {'useEvdev': true}),
+        ],
+      );
+    });
+
+    test('setBatchWindow passes the window on', () async {
+      await mediaKeyDetector.setBatchWindow(const Duration(milliseconds: 5));
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setBatchWindow', arguments: {'milliseconds': 5}),
+        ],
+      );
+    });
+
+    test('setUseHidraw passes the choice on', () async {
+      await mediaKeyDetector.setUseHidraw(useHidraw: true);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setUseHidraw', arguments: {'useHidraw': true}),
+        ],
+      );
+    });
+
+    test('getHidDevices reads the device list', () async {
+      expect(await mediaKeyDetector.getHidDevices(), const [
+        HidrawDevice(device: 2, name: 'Page Turner', vendorId: 0x248a, productId: 0x8266),
+      ]);
+    });
+
+    test('HID button batches are decoded', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+        const EventChannel('media_key_detector_linux_hid_events'),
+        MockStreamHandler.inline(
+          onListen: (arguments, events) => events.success(
+            Int64List.fromList([2, 0x000C00CD, 1, 1000000, 2, 0x000C00CD, 0, 1080100]),
+          ),
+        ),
+      );
+
+      expect(await mediaKeyDetector.hidButtonEvents.first, const [
+        HidButtonEvent(device: 2, usage: 0x000C00CD, pressed: true, timestamp: Duration(microseconds: 1000000)),
+        HidButtonEvent(device: 2, usage: 0x000C00CD, pressed: false, timestamp: Duration(microseconds: 1080100)),
+      ]);
+    });
+
+    test('HID button batches must be quadruples', () {
+      expect(() => HidButtonEvent.decodeBatch(Int64List(3)), throwsFormatException);
+    });
+
+    test('setUseGamepads passes the choice on', () async {
+      expect(mediaKeyDetector.supportsGamepads, isTrue);
+      await mediaKeyDetector.setUseGamepads(useGamepads: true);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setUseGamepads', arguments: {'useGamepads': true}),
+        ],
+      );
+    });
+
+    test('setGamepadOptions passes only the given options on', () async {
+      await mediaKeyDetector.setGamepadOptions(deadzone: 0.2);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setGamepadOptions', arguments: {'deadzone': 0.2}),
+        ],
+      );
+    });
+
+    test('getGamepads reads the gamepad list', () async {
+      expect(await mediaKeyDetector.getGamepads(), const [
+        NativeGamepad(device: 21, name: 'Xbox Wireless Controller', vendorId: 0x045e, productId: 0x0b13),
+      ]);
+    });
+
+    test('gamepad button batches are decoded', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+        const EventChannel('media_key_detector_linux_gamepad_events'),
+        MockStreamHandler.inline(
+          onListen: (arguments, events) => events.success(
+            Int64List.fromList([21, 0x130, 1, 1000000, 21, 0x1001, 1, 1008000]),
+          ),
+        ),
+      );
+
+      final batch = await mediaKeyDetector.gamepadButtonEvents.first;
+      expect(batch, const [
+        GamepadButtonEvent(device: 21, button: 0x130, pressed: true, timestamp: Duration(microseconds: 1000000)),
+        GamepadButtonEvent(device: 21, button: 0x1001, pressed: true, timestamp: Duration(microseconds: 1008000)),
+      ]);
+      expect(batch[1].isAxis, isTrue);
+      expect(batch[1].button, GamepadButtonEvent.axisButton(0, positive: true));
+    });
+
+    test('gamepad connections are decoded', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+        const EventChannel('media_key_detector_linux_gamepads'),
+        MockStreamHandler.inline(
+          onListen: (arguments, events) => events.success(
+            {'device': 21, 'name': 'Pad', 'vendorId': 1, 'productId': 2, 'connected': false},
+          ),
+        ),
+      );
+
+      expect(
+        await mediaKeyDetector.gamepadConnections.first,
+        const GamepadConnectionEvent(
+          gamepad: NativeGamepad(device: 21, name: 'Pad', vendorId: 1, productId: 2),
+          connected: false,
+        ),
+      );
+    });
+
+    test('event batches reach the listeners and the stream', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+        const EventChannel('media_key_detector_linux_events'),
+        MockStreamHandler.inline(
+          onListen: (arguments, events) => events.success(
+            Uint8List.fromList([
+              1, 16, 2, 0, //
+              0x40, 0x42, 0x0F, 0, 0, 0, 0, 0, 3, 0, 2, 0, 4, 0, 0, 0,
+              0x24, 0x7B, 0x10, 0, 0, 0, 0, 0, 3, 0, 2, 1, 4, 0, 0, 0,
+            ]),
+          ),
+        ),
+      );
+      final pressed = <MediaKey>[];
+      mediaKeyDetector.addListener(pressed.add);
+      final batches = mediaKeyDetector.events.first;
+
+      mediaKeyDetector.initialize();
+
+      expect(await batches, const [
+        MediaKeyEvent(
+          key: MediaKey.fastForward,
+          action: MediaKeyAction.down,
+          timestamp: Duration(microseconds: 1000000),
+          source: MediaKeySource.evdev,
+          device: 3,
+        ),
+        MediaKeyEvent(
+          key: MediaKey.fastForward,
+          action: MediaKeyAction.up,
+          timestamp: Duration(microseconds: 1080100),
+          source: MediaKeySource.evdev,
+          device: 3,
+        ),
+      ]);
+      expect(pressed, [MediaKey.fastForward]);
+    });
+
+    test('setIsPlaying passes the state on', () async {
+      await mediaKeyDetector.setIsPlaying(isPlaying: true);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setIsPlaying', arguments: {'isPlaying': true}),
+        ],
+      );
+    });
   });
 }
@@ -1,8 +1,13 @@
 /// The base interface for media_key_detector
 library media_key_detector_platform_interface;
 
+import 'dart:async';
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
+import 'package:media_key_detector_platform_interface/src/gamepad_event.dart';
 import 'package:media_key_detector_platform_interface/src/media_key.dart';
+import 'package:media_key_detector_platform_interface/src/media_key_event.dart';
 import 'package:media_key_detector_platform_interface/src/method_channel_media_key_detector.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
@@ -70,6 +75,42 @@ abstract class MediaKeyDetectorPlatform extends PlatformInterface {
     }
   }
 
+  final _events = StreamController<List<MediaKeyEvent>>.broadcast();
+
+  /// Media key events with their timing, in batches as the platform sent
+  /// them. Only sent by platforms that watch the keys natively.
+  Stream<List<MediaKeyEvent>> get events => _events.stream;
+
+  /// Handles a batch of events sent by the platform, see
+  /// [MediaKeyEvent.decodeBatch]. Downs and presses also reach the
+  /// listeners.
+  void handleEventBatch(Uint8List batch) {
+    final events = MediaKeyEvent.decodeBatch(batch);
+    for (final event in events) {
+      if (event.action == MediaKeyAction.down || event.action == MediaKeyAction.press) {
+        triggerListeners(event.key);
+      }
+    }
+    _events.add(events);
+  }
+
+  /// Whether the platform reads gamepads natively, see [setUseGamepads].
+  bool get supportsGamepads => false;
+
+  /// Reads gamepads natively, including ones that connect later, whether or
+  /// not the app is playing. Only implemented where [supportsGamepads].
+  Future<void> setUseGamepads({required bool useGamepads}) {
+    throw UnimplementedError('setUseGamepads() has not been implemented.');
+  }
+
+  /// Gamepad button presses and releases, in batches as they were read,
+  /// while [setUseGamepads] is on.
+  Stream<List<GamepadButtonEvent>> get gamepadButtonEvents => const Stream.empty();
+
+  /// Gamepads that connect or disconnect while [setUseGamepads] is on,
+  /// including the ones found when it is turned on.
+  Stream<GamepadConnectionEvent> get gamepadConnections => const Stream.empty();
+
   final Map<LogicalKeyboardKey, MediaKey> _keyMap = {
     LogicalKeyboardKey.mediaPlay: MediaKey.playPause,
     LogicalKeyboardKey.mediaRewind: MediaKey.rewind,
@@ -1,3 +1,5 @@
+export './gamepad_event.dart' show GamepadButtonEvent, GamepadConnectionEvent, NativeGamepad;
 export './media_key.dart' show MediaKey;
+export './media_key_event.dart' show MediaKeyAction, MediaKeyEvent, MediaKeySource;
 export './method_channel_media_key_detector.dart'
     show MethodChannelMediaKeyDetector;
@@ -0,0 +1,152 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// A gamepad button, or stick, trigger or D-pad direction, that was pressed
+/// or released, as read natively by the platform, e.g. from
+/// `/dev/input/eventN` on Linux.
+///
+/// Buttons are identified by their Linux key code, e.g. 0x130 for the south
+/// face button. Each axis also acts as two buttons, one per direction, with
+/// the IDs from [axisButton].
+@immutable
+class GamepadButtonEvent {
+  /// Creates an event.
+  const GamepadButtonEvent({
+    required this.device,
+    required this.button,
+    required this.pressed,
+    required this.timestamp,
+  });
+
+  /// The first ID of the axis directions.
+  static const axisButtonBase = 0x1000;
+
+  /// The button ID of the [positive] or negative direction of [axis], e.g.
+  /// 0 for the X axis of the left stick.
+  static int axisButton(int axis, {required bool positive}) => axisButtonBase + axis * 2 + (positive ? 1 : 0);
+
+  /// The gamepad, e.g. N of its `/dev/input/eventN` node on Linux.
+  final int device;
+
+  /// Key code or axis direction, see [axisButton].
+  final int button;
+
+  /// Whether the button went down rather than up.
+  final bool pressed;
+
+  /// When the kernel saw the event, on the clock of `Timeline.now`.
+  final Duration timestamp;
+
+  /// Whether [button] is an axis direction.
+  bool get isAxis => button >= axisButtonBase;
+
+  /// Decodes the (device, button, pressed, timestamp) quadruples sent by the
+  /// plugin.
+  static List<GamepadButtonEvent> decodeBatch(Int64List values) {
+    if (values.length % 4 != 0) {
+      throw FormatException('Gamepad events come in quadruples, got ${values.length} values');
+    }
+    return [
+      for (var i = 0; i < values.length; i += 4)
+        GamepadButtonEvent(
+          device: values[i],
+          button: values[i + 1],
+          pressed: values[i + 2] != 0,
+          timestamp: Duration(microseconds: values[i + 3]),
+        ),
+    ];
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is GamepadButtonEvent &&
+      other.device == device &&
+      other.button == button &&
+      other.pressed == pressed &&
+      other.timestamp == timestamp;
+
+  @override
+  int get hashCode => Object.hash(device, button, pressed, timestamp);
+
+  @override
+  String toString() =>
+      'GamepadButtonEvent(event$device, 0x${button.toRadixString(16)}, '
+      '${pressed ? 'pressed' : 'released'}, $timestamp)';
+}
+
+/// A gamepad being read.
+@immutable
+class NativeGamepad {
+  /// Creates a gamepad description.
+  const NativeGamepad({
+    required this.device,
+    required this.name,
+    required this.vendorId,
+    required this.productId,
+  });
+
+  /// Reads the map sent by the plugin.
+  factory NativeGamepad.fromMap(Map<Object?, Object?> map) {
+    return NativeGamepad(
+      device: map['device']! as int,
+      name: map['name']! as String,
+      vendorId: map['vendorId']! as int,
+      productId: map['productId']! as int,
+    );
+  }
+
+  /// The ID its events carry, see [GamepadButtonEvent.device].
+  final int device;
+
+  /// The name the gamepad reports.
+  final String name;
+
+  /// USB or Bluetooth vendor ID.
+  final int vendorId;
+
+  /// USB or Bluetooth product ID.
+  final int productId;
+
+  @override
+  bool operator ==(Object other) =>
+      other is NativeGamepad &&
+      other.device == device &&
+      other.name == name &&
+      other.vendorId == vendorId &&
+      other.productId == productId;
+
+  @override
+  int get hashCode => Object.hash(device, name, vendorId, productId);
+
+  @override
+  String toString() => 'NativeGamepad(event$device, $name, $vendorId:$productId)';
+}
+
+/// A gamepad that connected or disconnected.
+@immutable
+class GamepadConnectionEvent {
+  /// Creates an event.
+  const GamepadConnectionEvent({required this.gamepad, required this.connected});
+
+  /// Reads the map sent by the plugin.
+  factory GamepadConnectionEvent.fromMap(Map<Object?, Object?> map) {
+    return GamepadConnectionEvent(gamepad: NativeGamepad.fromMap(map), connected: map['connected']! as bool);
+  }
+
+  /// The gamepad.
+  final NativeGamepad gamepad;
+
+  /// Whether it connected rather than disconnected.
+  final bool connected;
+
+  @override
+  bool operator ==(Object other) =>
+      other is GamepadConnectionEvent && other.gamepad == gamepad && other.connected == connected;
+
+  @override
+  int get hashCode => Object.hash(gamepad, connected);
+
+  @override
+  String toString() => 'GamepadConnectionEvent($gamepad, ${connected ? 'connected' : 'disconnected'})';
+}
@@ -0,0 +1,123 @@
+import 'dart:typed_data';
+
+import 'package:media_key_detector_platform_interface/src/media_key.dart';
+
+/// What happened to the key of a [MediaKeyEvent].
+enum MediaKeyAction {
+  /// The key went down.
+  down,
+
+  /// The key went up.
+  up,
+
+  /// The key has been held for the long press time. Comes between [down]
+  /// and [up].
+  longPress,
+
+  /// A whole press, from sources that do not report [down] and [up]
+  /// separately.
+  press,
+}
+
+/// Where a [MediaKeyEvent] came from.
+enum MediaKeySource {
+  /// Not known.
+  unknown,
+
+  /// A global hotkey on Windows.
+  hotkey,
+
+  /// The low-level keyboard hook on Windows.
+  keyboardHook,
+
+  /// MPRIS or the GNOME settings daemon on Linux.
+  dbus,
+
+  /// An input device read directly on Linux.
+  evdev,
+}
+
+/// A media key event, as sent by the platform in batches.
+class MediaKeyEvent {
+  /// Creates an event.
+  const MediaKeyEvent({
+    required this.key,
+    required this.action,
+    required this.timestamp,
+    this.source = MediaKeySource.unknown,
+    this.device = 0,
+  });
+
+  /// The key the event is about.
+  final MediaKey key;
+
+  /// What happened to [key].
+  final MediaKeyAction action;
+
+  /// When the platform saw the key, on the clock of `Timeline.now`.
+  final Duration timestamp;
+
+  /// Where the event came from.
+  final MediaKeySource source;
+
+  /// The input device within [source], e.g. N of `/dev/input/eventN`, or 0
+  /// if the source does not tell devices apart.
+  final int device;
+
+  /// The version of the batch format [decodeBatch] reads.
+  static const batchVersion = 1;
+
+  static const _headerSize = 4;
+  static const _recordSize = 16;
+
+  /// Decodes a batch sent by the platform. All numbers are little-endian:
+  ///
+  /// - header: u8 version, u8 record size, u16 record count
+  /// - record: i64 timestamp in microseconds, u16 device, u8 key index,
+  ///   u8 action index, u8 source index, padding
+  ///
+  /// Fields that records may gain later are skipped, and records of unknown
+  /// keys are left out. Throws a [FormatException] if [bytes] is no complete
+  /// batch of a known version.
+  static List<MediaKeyEvent> decodeBatch(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.length < _headerSize || data.getUint8(0) != batchVersion || data.getUint8(1) < _recordSize) {
+      throw const FormatException('Not a media key event batch');
+    }
+    final recordSize = data.getUint8(1);
+    final count = data.getUint16(2, Endian.little);
+    if (bytes.length < _headerSize + count * recordSize) {
+      throw const FormatException('Truncated media key event batch');
+    }
+    return [
+      for (var offset = _headerSize; offset < _headerSize + count * recordSize; offset += recordSize)
+        if (data.getUint8(offset + 10) < MediaKey.values.length)
+          MediaKeyEvent(
+            key: MediaKey.values[data.getUint8(offset + 10)],
+            action: _valueAt(MediaKeyAction.values, data.getUint8(offset + 11), MediaKeyAction.press),
+            timestamp: Duration(microseconds: data.getInt64(offset, Endian.little)),
+            source: _valueAt(MediaKeySource.values, data.getUint8(offset + 12), MediaKeySource.unknown),
+            device: data.getUint16(offset + 8, Endian.little),
+          ),
+    ];
+  }
+
+  static T _valueAt<T>(List<T> values, int index, T fallback) => index < values.length ? values[index] : fallback;
+
+  @override
+  bool operator ==(Object other) =>
+      other is MediaKeyEvent &&
+      other.key == key &&
+      other.action == action &&
+      other.timestamp == timestamp &&
+      other.source == source &&
+      other.device == device;
+
+  @override
+  int get hashCode => Object.hash(key, action, timestamp, source, device);
+
+  @override
+  String toString() =>
+      'MediaKeyEvent(key: $key, action: $action, timestamp: ${timestamp.inMicroseconds}us, '
+      'source: $source, device: $device)';
+}
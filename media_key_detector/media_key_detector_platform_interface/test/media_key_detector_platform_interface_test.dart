@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter_test/flutter_test.dart';
 import 'package:media_key_detector_platform_interface/media_key_detector_platform_interface.dart';
 
@@ -8,9 +10,14 @@ class MediaKeyDetectorMock extends MediaKeyDetectorPlatform {
   @override
   Future<String?> getPlatformName() async => mockPlatformName;
 
+  final triggered = <MediaKey>[];
+
   @override
   void addListener(void Function(MediaKey mediaKey) listener) {}
 
+  @override
+  void triggerListeners(MediaKey mediaKey) => triggered.add(mediaKey);
+
   @override
   Future<bool> getIsPlaying() async {
     return isPlaying;
@@ -43,5 +50,83 @@ void main() {
         );
       });
     });
+
+    group('MediaKeyEvent.decodeBatch', () {
+      test('decodes the records', () {
+        final batch = Uint8List.fromList([
+          1, 16, 2, 0, //
+          0x40, 0x42, 0x0F, 0, 0, 0, 0, 0, 7, 0, 2, 0, 4, 0, 0, 0,
+          0x20, 0xA1, 0x07, 0, 0, 0, 0, 0, 0, 0, 0, 3, 1, 0, 0, 0,
+        ]);
+
+        expect(MediaKeyEvent.decodeBatch(batch), const [
+          MediaKeyEvent(
+            key: MediaKey.fastForward,
+            action: MediaKeyAction.down,
+            timestamp: Duration(microseconds: 1000000),
+            source: MediaKeySource.evdev,
+            device: 7,
+          ),
+          MediaKeyEvent(
+            key: MediaKey.playPause,
+            action: MediaKeyAction.press,
+            timestamp: Duration(microseconds: 500000),
+            source: MediaKeySource.hotkey,
+          ),
+        ]);
+      });
+
+      test('skips longer records and unknown keys', () {
+        final batch = Uint8List.fromList([
+          1, 20, 2, 0, //
+          1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 99, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF,
+          2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 1, 9, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF,
+        ]);
+
+        expect(MediaKeyEvent.decodeBatch(batch), const [
+          MediaKeyEvent(
+            key: MediaKey.volumeDown,
+            action: MediaKeyAction.up,
+            timestamp: Duration(microseconds: 2),
+          ),
+        ]);
+      });
+
+      test('rejects malformed batches', () {
+        expect(() => MediaKeyEvent.decodeBatch(Uint8List.fromList([1, 16])), throwsFormatException);
+        expect(() => MediaKeyEvent.decodeBatch(Uint8List.fromList([2, 16, 0, 0])), throwsFormatException);
+        expect(() => MediaKeyEvent.decodeBatch(Uint8List.fromList([1, 16, 1, 0, 0])), throwsFormatException);
+      });
+    });
+
+    test('gamepads are unsupported by default', () {
+      final platform = MediaKeyDetectorMock();
+
+      expect(platform.supportsGamepads, isFalse);
+      expect(platform.gamepadConnections, emitsDone);
+      expect(platform.gamepadButtonEvents, emitsDone);
+      expect(() => platform.setUseGamepads(useGamepads: true), throwsUnimplementedError);
+    });
+
+    test('handleEventBatch reaches the listeners and the stream', () async {
+      final platform = MediaKeyDetectorMock();
+      final batches = platform.events.first;
+
+      platform.handleEventBatch(
+        Uint8List.fromList([
+          1, 16, 3, 0, //
+          1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 0, 0, 0,
+          2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 2, 0, 0, 0,
+          3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 0, 0, 0,
+        ]),
+      );
+
+      expect((await batches).map((e) => e.action), [
+        MediaKeyAction.down,
+        MediaKeyAction.longPress,
+        MediaKeyAction.up,
+      ]);
+      expect(platform.triggered, [MediaKey.rewind]);
+    });
   });
 }
@@ -1,8 +1,16 @@
+import 'dart:typed_data';
+
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import 'package:media_key_detector_platform_interface/media_key_detector_platform_interface.dart';
 
 /// The Windows implementation of [MediaKeyDetectorPlatform].
+///
+/// While playing, the plugin registers the media keys as global hotkeys, so
+/// they arrive while the app is in the background. With [setUseLowLevelHook]
+/// it watches them with a low-level keyboard hook instead, which also sees
+/// releases and long presses. Either way the keys arrive in batches with
+/// their timing, see [events].
 class MediaKeyDetectorWindows extends MediaKeyDetectorPlatform {
   bool _isPlaying = false;
   final _eventChannel = const EventChannel('media_key_detector_windows_events');
@@ -18,16 +26,25 @@ class MediaKeyDetectorWindows extends MediaKeyDetectorPlatform {
 
   @override
   void initialize() {
-    _eventChannel.receiveBroadcastStream().listen((event) {
-      final keyIdx = event as int;
-      MediaKey? key;
-      if (keyIdx > -1 && keyIdx < MediaKey.values.length) {
-        key = MediaKey.values[keyIdx];
-      }
-      if (key != null) {
-        triggerListeners(key);
-      }
-    });
+    _eventChannel.receiveBroadcastStream().listen((batch) => handleEventBatch(batch as Uint8List));
+  }
+
+  /// Watches the media keys with a low-level keyboard hook on a thread of
+  /// its own while playing, instead of registering them as hotkeys. Reports
+  /// releases and long presses as well, with the times Windows saw the keys.
+  /// Falls back to the hotkeys if the hook cannot be installed.
+  Future<void> setUseLowLevelHook({required bool useLowLevelHook}) async {
+    await methodChannel.invokeMethod<void>(
+      'setUseLowLevelHook',
+      <String, dynamic>{'useLowLevelHook': useLowLevelHook},
+    );
+  }
+
+  /// Collects the media keys of [window] into one batch before sending them,
+  /// to save platform messages on bursts. Zero, the default, sends them as
+  /// soon as the platform thread gets to it.
+  Future<void> setBatchWindow(Duration window) async {
+    await methodChannel.invokeMethod<void>('setBatchWindow', <String, dynamic>{'milliseconds': window.inMilliseconds});
   }
 
   @override
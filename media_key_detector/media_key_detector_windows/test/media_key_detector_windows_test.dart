@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:media_key_detector_platform_interface/media_key_detector_platform_interface.dart';
@@ -41,5 +43,68 @@ void main() {
       );
       expect(name, equals(kPlatformName));
     });
+
+    test('setUseLowLevelHook passes the choice on', () async {
+      await mediaKeyDetector.setUseLowLevelHook(useLowLevelHook: true);
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setUseLowLevelHook', arguments: {'useLowLevelHook': true}),
+        ],
+      );
+    });
+
+    test('setBatchWindow passes the window on', () async {
+      await mediaKeyDetector.setBatchWindow(const Duration(milliseconds: 5));
+      expect(
+        log,
+        <Matcher>[
+          isMethodCall('setBatchWindow', arguments: {'milliseconds': 5}),
+        ],
+      );
+    });
+
+    test('event batches reach the listeners and the stream', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockStreamHandler(
+        const EventChannel('media_key_detector_windows_events'),
+        MockStreamHandler.inline(
+          onListen: (arguments, events) => events.success(
+            Uint8List.fromList([
+              1, 16, 3, 0, //
+              0x40, 0x42, 0x0F, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0,
+              0x60, 0xE3, 0x16, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0,
+              0x80, 0x1F, 0x1A, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0,
+            ]),
+          ),
+        ),
+      );
+      final pressed = <MediaKey>[];
+      mediaKeyDetector.addListener(pressed.add);
+      final batches = mediaKeyDetector.events.first;
+
+      mediaKeyDetector.initialize();
+
+      expect(await batches, const [
+        MediaKeyEvent(
+          key: MediaKey.playPause,
+          action: MediaKeyAction.down,
+          timestamp: Duration(microseconds: 1000000),
+          source: MediaKeySource.keyboardHook,
+        ),
+        MediaKeyEvent(
+          key: MediaKey.playPause,
+          action: MediaKeyAction.longPress,
+          timestamp: Duration(microseconds: 1500000),
+          source: MediaKeySource.keyboardHook,
+        ),
+        MediaKeyEvent(
+          key: MediaKey.playPause,
+          action: MediaKeyAction.up,
+          timestamp: Duration(microseconds: 1712000),
+          source: MediaKeySource.keyboardHook,
+        ),
+      ]);
+      expect(pressed, [MediaKey.playPause]);
+    });
   });
 }
@@ -0,0 +1,152 @@
+#include "low_level_key_hook.h"
+
+#include <optional>
+#include <utility>
+
+namespace media_key_detector_windows {
+
+namespace {
+
+using media_key_detector_core::MediaKeyClassifier;
+using media_key_detector_core::MediaKeyGesture;
+
+// Hook procedures get no context, so the hook thread keeps its instance here.
+thread_local LowLevelKeyHook* current_hook = nullptr;
+
+// The MediaKeyIndex of |virtual_key|, or -1. The same keys as the hotkeys.
+int MediaKeyForVirtualKey(DWORD virtual_key) {
+  switch (virtual_key) {
+    case VK_MEDIA_PLAY_PAUSE:
+      return media_key_detector_core::kMediaKeyPlayPause;
+    case VK_MEDIA_PREV_TRACK:
+      return media_key_detector_core::kMediaKeyRewind;
+    case VK_MEDIA_NEXT_TRACK:
+      return media_key_detector_core::kMediaKeyFastForward;
+    case VK_VOLUME_UP:
+      return media_key_detector_core::kMediaKeyVolumeUp;
+    case VK_VOLUME_DOWN:
+      return media_key_detector_core::kMediaKeyVolumeDown;
+  }
+  return -1;
+}
+
+}  // namespace
+
+int64_t TimelineNowUs() {
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return counter.QuadPart / frequency.QuadPart * 1000000 +
+         counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+}
+
+LowLevelKeyHook::LowLevelKeyHook(Callback callback,
+                                 MediaKeyClassifier::Options options)
+    : callback_(std::move(callback)), classifier_(options) {}
+
+LowLevelKeyHook::~LowLevelKeyHook() {
+  Stop();
+}
+
+bool LowLevelKeyHook::Start() {
+  if (thread_.joinable()) {
+    return true;
+  }
+  classifier_.Reset();
+  std::promise<bool> hooked;
+  std::future<bool> result = hooked.get_future();
+  thread_ = std::thread(&LowLevelKeyHook::Run, this, std::move(hooked));
+  if (!result.get()) {
+    thread_.join();
+    return false;
+  }
+  return true;
+}
+
+void LowLevelKeyHook::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  PostThreadMessage(thread_id_, WM_QUIT, 0, 0);
+  thread_.join();
+}
+
+// static
+LRESULT CALLBACK LowLevelKeyHook::HookProc(int code,
+                                           WPARAM wparam,
+                                           LPARAM lparam) {
+  if (code == HC_ACTION && current_hook != nullptr) {
+    const auto* info = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lparam);
+    int key = MediaKeyForVirtualKey(info->vkCode);
+    if (key >= 0) {
+      bool down = wparam == WM_KEYDOWN || wparam == WM_SYSKEYDOWN;
+      current_hook->classifier_.OnKey(key, down, info->time,
+                                      &current_hook->gestures_);
+      // Swallowed, as the hotkeys would be.
+      return 1;
+    }
+  }
+  return CallNextHookEx(nullptr, code, wparam, lparam);
+}
+
+void LowLevelKeyHook::Run(std::promise<bool> hooked) {
+  // Creates the message queue of this thread, so Stop() can post to it.
+  MSG message;
+  PeekMessage(&message, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+  thread_id_ = GetCurrentThreadId();
+
+  current_hook = this;
+  HHOOK hook = SetWindowsHookEx(WH_KEYBOARD_LL, &LowLevelKeyHook::HookProc,
+                                GetModuleHandle(nullptr), 0);
+  hooked.set_value(hook != nullptr);
+  if (hook == nullptr) {
+    current_hook = nullptr;
+    return;
+  }
+
+  bool quit = false;
+  while (!quit) {
+    // Sleeps until a key comes in or a long press or release is due.
+    std::optional<uint32_t> wait =
+        classifier_.TimeUntilNextDeadline(GetTickCount());
+    DWORD result = MsgWaitForMultipleObjectsEx(
+        0, nullptr, wait ? *wait : INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    if (result == WAIT_TIMEOUT) {
+      classifier_.Advance(GetTickCount(), &gestures_);
+    }
+    // The hook runs inside PeekMessage.
+    while (PeekMessage(&message, nullptr, 0, 0, PM_REMOVE)) {
+      if (message.message == WM_QUIT) {
+        quit = true;
+        break;
+      }
+      DispatchMessage(&message);
+    }
+    Flush();
+  }
+
+  UnhookWindowsHookEx(hook);
+  current_hook = nullptr;
+}
+
+void LowLevelKeyHook::Flush() {
+  if (gestures_.empty()) {
+    return;
+  }
+  // KBDLLHOOKSTRUCT times are on the GetTickCount() clock, so they are moved
+  // to QueryPerformanceCounter by their age. The tick clock advances in steps
+  // of the timer resolution, usually 15.6 ms.
+  int64_t now_us = TimelineNowUs();
+  DWORD now_ms = GetTickCount();
+  std::vector<HookMediaKeyEvent> events;
+  events.reserve(gestures_.size());
+  for (const MediaKeyGesture& gesture : gestures_) {
+    int64_t age_ms = static_cast<int32_t>(now_ms - gesture.time_ms);
+    events.push_back({gesture, now_us - age_ms * 1000});
+  }
+  gestures_.clear();
+  callback_(events);
+}
+
+}  // namespace media_key_detector_windows
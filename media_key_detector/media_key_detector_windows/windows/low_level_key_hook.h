@@ -0,0 +1,78 @@
+#ifndef FLUTTER_PLUGIN_LOW_LEVEL_KEY_HOOK_H_
+#define FLUTTER_PLUGIN_LOW_LEVEL_KEY_HOOK_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "media_key_detector_core/media_key_classifier.h"
+
+namespace media_key_detector_windows {
+
+// Microseconds on the clock of Dart's Timeline.now, QueryPerformanceCounter.
+int64_t TimelineNowUs();
+
+// A classified media key event with its time on the clock of Dart's
+// Timeline.now.
+struct HookMediaKeyEvent {
+  media_key_detector_core::MediaKeyGesture gesture;
+  int64_t timestamp_us;
+};
+
+// Watches the media keys with a WH_KEYBOARD_LL hook on a thread of its own,
+// with its own message loop, so the keys neither wait behind the UI's
+// messages nor run into the hook timeout while the UI thread is busy.
+//
+// Unlike RegisterHotKey this sees ups as well as downs, with the times from
+// KBDLLHOOKSTRUCT, and feeds them through a MediaKeyClassifier for
+// debouncing and long presses. Like the hotkeys, the media keys are taken
+// away from other apps while the hook is installed.
+class LowLevelKeyHook {
+ public:
+  // Called on the hook thread with the events of one wakeup, in order.
+  using Callback = std::function<void(const std::vector<HookMediaKeyEvent>&)>;
+
+  explicit LowLevelKeyHook(
+      Callback callback,
+      media_key_detector_core::MediaKeyClassifier::Options options = {});
+  ~LowLevelKeyHook();
+
+  // Disallow copy and assign.
+  LowLevelKeyHook(const LowLevelKeyHook&) = delete;
+  LowLevelKeyHook& operator=(const LowLevelKeyHook&) = delete;
+
+  // Starts the thread and installs the hook. Returns false if the hook
+  // cannot be installed.
+  bool Start();
+
+  // Removes the hook and stops the thread. Called automatically on
+  // destruction. No callback runs once this returns.
+  void Stop();
+
+  bool running() const { return thread_.joinable(); }
+
+ private:
+  static LRESULT CALLBACK HookProc(int code, WPARAM wparam, LPARAM lparam);
+
+  // |hooked| is set once the hook is installed or has failed to.
+  void Run(std::promise<bool> hooked);
+
+  // Hands the gestures collected so far to the callback.
+  void Flush();
+
+  Callback callback_;
+  // Only used on the hook thread once started.
+  media_key_detector_core::MediaKeyClassifier classifier_;
+  std::vector<media_key_detector_core::MediaKeyGesture> gestures_;
+
+  std::thread thread_;
+  DWORD thread_id_ = 0;
+};
+
+}  // namespace media_key_detector_windows
+
+#endif  // FLUTTER_PLUGIN_LOW_LEVEL_KEY_HOOK_H_
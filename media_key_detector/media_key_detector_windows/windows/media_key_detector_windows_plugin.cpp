@@ -12,10 +12,22 @@
 #include <map>
 #include <memory>
 #include <atomic>
+#include <optional>
+#include <vector>
+
+#include "low_level_key_hook.h"
+#include "media_key_detector_core/media_key_event_codec.h"
 
 namespace {
 
 using flutter::EncodableValue;
+using media_key_detector_core::MediaKeyAction;
+using media_key_detector_core::MediaKeyBatcher;
+using media_key_detector_core::MediaKeyIndex;
+using media_key_detector_core::MediaKeyRecord;
+using media_key_detector_core::MediaKeySource;
+using media_key_detector_windows::HookMediaKeyEvent;
+using media_key_detector_windows::LowLevelKeyHook;
 
 // Hotkey IDs for media keys
 constexpr int HOTKEY_PLAY_PAUSE = 1;
@@ -24,6 +36,9 @@ constexpr int HOTKEY_PREV_TRACK = 3;
 constexpr int HOTKEY_VOLUME_UP = 4;
 constexpr int HOTKEY_VOLUME_DOWN = 5;
 
+// Timer of the top-level window that ends a batch window.
+constexpr UINT_PTR BATCH_TIMER_ID = 0x4D4B;
+
 class MediaKeyDetectorWindows : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
@@ -43,6 +58,17 @@ class MediaKeyDetectorWindows : public flutter::Plugin {
   
   // Unregister global hotkeys
   void UnregisterHotkeys();
+
+  // Registers the hotkeys or starts the hook, depending on the mode, while
+  // playing, and stops both otherwise.
+  void UpdateKeySources();
+
+  // Queues |record| for the platform thread. The first record of a batch
+  // schedules sending it once the batch window is over. Thread-safe.
+  void QueueMediaKey(const MediaKeyRecord &record);
+
+  // Sends the pending batch, on the platform thread.
+  void SendBatch();
   
   // Handle Windows messages
   std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
@@ -52,6 +78,16 @@ class MediaKeyDetectorWindows : public flutter::Plugin {
   std::atomic<bool> is_playing_{false};
   int window_proc_id_ = -1;
   bool hotkeys_registered_ = false;
+
+  bool use_low_level_hook_ = false;
+  std::unique_ptr<LowLevelKeyHook> hook_;
+  // Collects the media keys of the next batch, see media_key_event_codec.h.
+  MediaKeyBatcher batcher_;
+  // Posted to the top-level window when a batch starts.
+  UINT batch_message_ = 0;
+  // The top-level window. Read by the hook thread, so only set while it is
+  // not running.
+  HWND batch_window_ = nullptr;
 };
 
 // static
@@ -96,6 +132,13 @@ void MediaKeyDetectorWindows::RegisterWithRegistrar(
 
 MediaKeyDetectorWindows::MediaKeyDetectorWindows(flutter::PluginRegistrarWindows *registrar) 
     : registrar_(registrar) {
+  batch_message_ = RegisterWindowMessage(L"MediaKeyDetectorWindowsBatch");
+  hook_ = std::make_unique<LowLevelKeyHook>([this](const std::vector<HookMediaKeyEvent> &events) {
+    for (const HookMediaKeyEvent &event : events) {
+      QueueMediaKey({event.gesture.key, event.gesture.action, MediaKeySource::kKeyboardHook, 0,
+                     event.timestamp_us});
+    }
+  });
   // Register a window procedure to handle hotkey messages
   window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
       [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
@@ -105,6 +148,7 @@ MediaKeyDetectorWindows::MediaKeyDetectorWindows(flutter::PluginRegistrarWindows
 
 MediaKeyDetectorWindows::~MediaKeyDetectorWindows() {
   UnregisterHotkeys();
+  hook_->Stop();
   if (window_proc_id_ != -1) {
     registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
   }
@@ -124,17 +168,42 @@ void MediaKeyDetectorWindows::HandleMethodCall(
       if (is_playing_it != arguments->end()) {
         if (auto* is_playing = std::get_if<bool>(&is_playing_it->second)) {
           is_playing_.store(*is_playing);
-          if (*is_playing) {
-            RegisterHotkeys();
-          } else {
-            UnregisterHotkeys();
-          }
+          UpdateKeySources();
           result->Success();
           return;
         }
       }
     }
     result->Error("INVALID_ARGUMENT", "isPlaying argument is required");
+  } else if (method_call.method_name().compare("setUseLowLevelHook") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (arguments) {
+      auto use_it = arguments->find(EncodableValue("useLowLevelHook"));
+      if (use_it != arguments->end()) {
+        if (auto* use_low_level_hook = std::get_if<bool>(&use_it->second)) {
+          use_low_level_hook_ = *use_low_level_hook;
+          UpdateKeySources();
+          result->Success();
+          return;
+        }
+      }
+    }
+    result->Error("INVALID_ARGUMENT", "useLowLevelHook argument is required");
+  } else if (method_call.method_name().compare("setBatchWindow") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (arguments) {
+      auto milliseconds_it = arguments->find(EncodableValue("milliseconds"));
+      if (milliseconds_it != arguments->end()) {
+        if (auto* milliseconds = std::get_if<int32_t>(&milliseconds_it->second)) {
+          if (*milliseconds >= 0) {
+            batcher_.set_window_ms(static_cast<uint32_t>(*milliseconds));
+            result->Success();
+            return;
+          }
+        }
+      }
+    }
+    result->Error("INVALID_ARGUMENT", "milliseconds argument is required");
   } else {
     result->NotImplemented();
   }
@@ -185,8 +254,54 @@ void MediaKeyDetectorWindows::UnregisterHotkeys() {
   hotkeys_registered_ = false;
 }
 
+void MediaKeyDetectorWindows::UpdateKeySources() {
+  if (is_playing_.load() && !hook_->running()) {
+    batch_window_ = GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+  }
+  bool hooked = false;
+  if (is_playing_.load() && use_low_level_hook_) {
+    hooked = hook_->Start();
+  } else {
+    hook_->Stop();
+  }
+  // The hotkeys are the fallback if the hook cannot be installed.
+  if (is_playing_.load() && !hooked) {
+    RegisterHotkeys();
+  } else {
+    UnregisterHotkeys();
+  }
+}
+
+void MediaKeyDetectorWindows::QueueMediaKey(const MediaKeyRecord &record) {
+  if (batcher_.Add(record)) {
+    PostMessage(batch_window_, batch_message_, 0, 0);
+  }
+}
+
+void MediaKeyDetectorWindows::SendBatch() {
+  std::vector<uint8_t> batch;
+  if (batcher_.Take(&batch) && event_sink_) {
+    event_sink_->Success(EncodableValue(std::move(batch)));
+  }
+}
+
 std::optional<LRESULT> MediaKeyDetectorWindows::HandleWindowProc(
     HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+  if (batch_message_ != 0 && message == batch_message_) {
+    UINT window_ms = batcher_.window_ms();
+    if (window_ms == 0) {
+      SendBatch();
+    } else {
+      SetTimer(batch_window_, BATCH_TIMER_ID, window_ms, nullptr);
+    }
+    return 0;
+  }
+  if (message == WM_TIMER && wparam == BATCH_TIMER_ID) {
+    KillTimer(batch_window_, BATCH_TIMER_ID);
+    SendBatch();
+    return 0;
+  }
+
   if (message == WM_HOTKEY && event_sink_) {
     int key_index = -1;
     
@@ -209,8 +324,10 @@ std::optional<LRESULT> MediaKeyDetectorWindows::HandleWindowProc(
         break;
     }
     
+    // Hotkeys have the press only, at the time it arrives.
     if (key_index >= 0) {
-      event_sink_->Success(EncodableValue(key_index));
+      QueueMediaKey({static_cast<MediaKeyIndex>(key_index), MediaKeyAction::kPress,
+                     MediaKeySource::kHotkey, 0, media_key_detector_windows::TimelineNowUs()});
     }
     
     return 0;
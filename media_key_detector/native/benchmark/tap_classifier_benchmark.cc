@@ -0,0 +1,57 @@
+// Measures how late TapClassifierWorker reports single taps: the time from
+// when a gesture came due, a window after its tap, to when the callback ran.
+// This is the delay that a Dart Timer over the same window adds on top, and
+// that grows with the load of the UI isolate.
+//
+// Run: ./tap_classifier_benchmark
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "media_key_detector_core/tap_classifier.h"
+
+using media_key_detector_core::TapClassifierWorker;
+using media_key_detector_core::TapGesture;
+
+namespace {
+
+constexpr int kTaps = 200;
+constexpr int64_t kWindowUs = 10000;
+
+}  // namespace
+
+int main() {
+  std::mutex mutex;
+  std::condition_variable resolved;
+  std::vector<int64_t> lateness_us;
+  TapClassifierWorker worker(
+      [&](const std::vector<TapGesture>& gestures) {
+        int64_t now = TapClassifierWorker::NowUs();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const TapGesture& gesture : gestures) {
+          lateness_us.push_back(now - (gesture.time_us + kWindowUs));
+        }
+        resolved.notify_one();
+      },
+      {kWindowUs, 2, false});
+
+  std::vector<TapGesture> gestures;
+  for (int i = 0; i < kTaps; i++) {
+    worker.OnTap(1, TapClassifierWorker::NowUs(), &gestures);
+    std::unique_lock<std::mutex> lock(mutex);
+    resolved.wait(lock, [&] { return lateness_us.size() > size_t(i); });
+  }
+
+  std::sort(lateness_us.begin(), lateness_us.end());
+  std::printf("%d single taps, %lld us window\n", kTaps,
+              static_cast<long long>(kWindowUs));
+  std::printf("lateness: median %lld us, p99 %lld us, max %lld us\n",
+              static_cast<long long>(lateness_us[kTaps / 2]),
+              static_cast<long long>(lateness_us[kTaps * 99 / 100]),
+              static_cast<long long>(lateness_us.back()));
+  return 0;
+}
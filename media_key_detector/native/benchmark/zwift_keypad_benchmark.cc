@@ -0,0 +1,86 @@
+// Measures decoding Zwift Ride keypad notifications with DecodeZwiftKeypad.
+// This is the native cost only, without the dart:ffi call around it. The
+// app's test/zwift_keypad_benchmark_test.dart compares that call with the
+// generated Dart decoder on the same corpus,
+// test/data/zwift_ride.notifications.
+//
+// Run: ./zwift_keypad_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "media_key_detector_core/zwift_keypad.h"
+
+using media_key_detector_core::DecodeZwiftKeypad;
+using media_key_detector_core::ZwiftKeypadKind;
+using media_key_detector_core::ZwiftKeypadState;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+constexpr int kRounds = 20000;
+
+// Keeps the compiler from optimising the work away.
+volatile size_t g_sink;
+
+// Reads test/data/zwift_ride.notifications: one notification per line in
+// hex, with # comments.
+std::vector<Bytes> LoadRideCorpus() {
+  std::vector<Bytes> corpus;
+  std::ifstream file(TEST_DATA_DIR "/zwift_ride.notifications");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream bytes(line);
+    Bytes notification;
+    unsigned int byte = 0;
+    while (bytes >> std::hex >> byte) {
+      notification.push_back(static_cast<uint8_t>(byte));
+    }
+    corpus.push_back(notification);
+  }
+  return corpus;
+}
+
+template <typename Fn>
+double MeasureNanos(const std::vector<Bytes>& corpus, Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; round++) {
+    for (const Bytes& notification : corpus) {
+      fn(notification);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (static_cast<double>(kRounds) * corpus.size());
+}
+
+}  // namespace
+
+int main() {
+  std::vector<Bytes> corpus = LoadRideCorpus();
+  if (corpus.empty()) {
+    std::fprintf(stderr, "no notifications in the corpus\n");
+    return 1;
+  }
+
+  double direct = MeasureNanos(corpus, [](const Bytes& notification) {
+    ZwiftKeypadState state;
+    DecodeZwiftKeypad(ZwiftKeypadKind::kRide, notification.data() + 1,
+                      notification.size() - 1, &state);
+    g_sink = state.buttons;
+  });
+
+  std::printf("%zu notifications of %zu bytes, %d rounds\n", corpus.size(),
+              corpus.front().size(), kRounds);
+  std::printf("DecodeZwiftKeypad: %7.1f ns/notification\n", direct);
+  return 0;
+}
@@ -0,0 +1,291 @@
+#include "media_key_detector_core/button_edge_engine.h"
+
+#include <chrono>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace media_key_detector_core {
+
+namespace {
+
+// Index of the lowest set bit of |bits|, which must not be 0.
+int LowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(bits);
+#endif
+}
+
+uint64_t Bit(int button) {
+  return uint64_t{1} << button;
+}
+
+}  // namespace
+
+ButtonEdgeEngine::ButtonEdgeEngine(Options options) : options_(options) {}
+
+void ButtonEdgeEngine::Update(uint32_t device,
+                              uint64_t buttons,
+                              int64_t time_us,
+                              std::vector<ButtonEdge>* edges) {
+  Advance(time_us, edges);
+
+  Device* state = Find(device);
+  if (state == nullptr) {
+    if (buttons == 0) {
+      return;
+    }
+    devices_.push_back(Device{device});
+    state = &devices_.back();
+  }
+  uint64_t changed = state->raw ^ buttons;
+  state->raw = buttons;
+
+  for (uint64_t pressed = changed & buttons; pressed != 0;
+       pressed &= pressed - 1) {
+    int button = LowestBit(pressed);
+    if ((state->releasing & Bit(button)) != 0) {
+      // Bounce: the press goes on.
+      state->releasing &= ~Bit(button);
+      continue;
+    }
+    state->held |= Bit(button);
+    state->long_pressed &= ~Bit(button);
+    state->down_us[button] = time_us;
+    edges->push_back({device, static_cast<uint8_t>(button),
+                      ButtonEdgeAction::kPress, time_us});
+  }
+
+  uint64_t released = changed & ~buttons & state->held;
+  for (; released != 0; released &= released - 1) {
+    int button = LowestBit(released);
+    if (options_.debounce_us <= 0) {
+      Release(state, button, time_us, edges);
+    } else {
+      state->releasing |= Bit(button);
+      state->up_us[button] = time_us;
+    }
+  }
+}
+
+void ButtonEdgeEngine::RemoveDevice(uint32_t device,
+                                    int64_t time_us,
+                                    std::vector<ButtonEdge>* edges) {
+  Advance(time_us, edges);
+  Device* state = Find(device);
+  if (state == nullptr) {
+    return;
+  }
+  // Releases that were held back happened first.
+  for (uint64_t bits = state->releasing; bits != 0; bits &= bits - 1) {
+    int button = LowestBit(bits);
+    Release(state, button, state->up_us[button], edges);
+  }
+  for (uint64_t bits = state->held; bits != 0; bits &= bits - 1) {
+    Release(state, LowestBit(bits), time_us, edges);
+  }
+  devices_.erase(devices_.begin() + (state - devices_.data()));
+}
+
+void ButtonEdgeEngine::Advance(int64_t now_us,
+                               std::vector<ButtonEdge>* edges) {
+  while (true) {
+    // The earliest due deadline, so that edges come out in time order.
+    Device* earliest = nullptr;
+    int earliest_button = 0;
+    int64_t earliest_deadline = 0;
+    for (Device& device : devices_) {
+      for (uint64_t bits = device.held; bits != 0; bits &= bits - 1) {
+        int button = LowestBit(bits);
+        std::optional<int64_t> deadline = Deadline(device, button);
+        if (deadline && *deadline <= now_us &&
+            (earliest == nullptr || *deadline < earliest_deadline)) {
+          earliest = &device;
+          earliest_button = button;
+          earliest_deadline = *deadline;
+        }
+      }
+    }
+    if (earliest == nullptr) {
+      return;
+    }
+
+    Device& device = *earliest;
+    uint64_t bit = Bit(earliest_button);
+    auto button = static_cast<uint8_t>(earliest_button);
+    if ((device.releasing & bit) != 0) {
+      Release(&device, earliest_button, device.up_us[earliest_button], edges);
+    } else if ((device.long_pressed & bit) == 0) {
+      device.long_pressed |= bit;
+      device.next_repeat_us[earliest_button] =
+          earliest_deadline + options_.repeat_interval_us;
+      edges->push_back({device.id, button, ButtonEdgeAction::kLongPress,
+                        earliest_deadline});
+    } else {
+      // Stay on the grid, skipping the ticks a stall has missed.
+      int64_t interval = options_.repeat_interval_us;
+      int64_t next = earliest_deadline + interval;
+      if (next <= now_us) {
+        next += ((now_us - next) / interval + 1) * interval;
+      }
+      device.next_repeat_us[earliest_button] = next;
+      edges->push_back(
+          {device.id, button, ButtonEdgeAction::kRepeat, earliest_deadline});
+    }
+  }
+}
+
+std::optional<int64_t> ButtonEdgeEngine::NextDeadline() const {
+  std::optional<int64_t> next;
+  for (const Device& device : devices_) {
+    for (uint64_t bits = device.held; bits != 0; bits &= bits - 1) {
+      std::optional<int64_t> deadline = Deadline(device, LowestBit(bits));
+      if (deadline && (!next || *deadline < *next)) {
+        next = deadline;
+      }
+    }
+  }
+  return next;
+}
+
+ButtonEdgeEngine::Device* ButtonEdgeEngine::Find(uint32_t device) {
+  for (Device& state : devices_) {
+    if (state.id == device) {
+      return &state;
+    }
+  }
+  return nullptr;
+}
+
+std::optional<int64_t> ButtonEdgeEngine::Deadline(const Device& device,
+                                                  int button) const {
+  uint64_t bit = Bit(button);
+  if ((device.releasing & bit) != 0) {
+    return device.up_us[button] + options_.debounce_us;
+  }
+  if (options_.long_press_us <= 0) {
+    return std::nullopt;
+  }
+  if ((device.long_pressed & bit) == 0) {
+    return device.down_us[button] + options_.long_press_us;
+  }
+  if (options_.repeat_interval_us > 0) {
+    return device.next_repeat_us[button];
+  }
+  return std::nullopt;
+}
+
+void ButtonEdgeEngine::Release(Device* device,
+                               int button,
+                               int64_t time_us,
+                               std::vector<ButtonEdge>* edges) {
+  uint64_t bit = Bit(button);
+  device->held &= ~bit;
+  device->releasing &= ~bit;
+  device->long_pressed &= ~bit;
+  edges->push_back({device->id, static_cast<uint8_t>(button),
+                    ButtonEdgeAction::kRelease, time_us});
+}
+
+ButtonEdgeWorker::ButtonEdgeWorker(Callback callback,
+                                   ButtonEdgeEngine::Options options)
+    : callback_(std::move(callback)),
+      engine_(options),
+      thread_(&ButtonEdgeWorker::Run, this) {}
+
+ButtonEdgeWorker::~ButtonEdgeWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void ButtonEdgeWorker::Update(uint32_t device,
+                              uint64_t buttons,
+                              int64_t time_us,
+                              std::vector<ButtonEdge>* edges,
+                              size_t limit) {
+  size_t start = edges->size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    engine_.Update(device, buttons, time_us, edges);
+  }
+  // The next deadline may have moved.
+  wake_.notify_one();
+  Spill(edges, start, limit);
+}
+
+void ButtonEdgeWorker::RemoveDevice(uint32_t device,
+                                    int64_t time_us,
+                                    std::vector<ButtonEdge>* edges,
+                                    size_t limit) {
+  size_t start = edges->size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    engine_.RemoveDevice(device, time_us, edges);
+  }
+  wake_.notify_one();
+  Spill(edges, start, limit);
+}
+
+void ButtonEdgeWorker::SetOptions(ButtonEdgeEngine::Options options) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    engine_ = ButtonEdgeEngine(options);
+  }
+  wake_.notify_one();
+}
+
+void ButtonEdgeWorker::Spill(std::vector<ButtonEdge>* edges,
+                             size_t start,
+                             size_t limit) {
+  if (edges->size() - start <= limit) {
+    return;
+  }
+  std::vector<ButtonEdge> spilled(edges->begin() + start + limit,
+                                  edges->end());
+  edges->resize(start + limit);
+  callback_(spilled);
+}
+
+int64_t ButtonEdgeWorker::NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void ButtonEdgeWorker::Run() {
+  std::vector<ButtonEdge> edges;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    std::optional<int64_t> deadline = engine_.NextDeadline();
+    if (!deadline) {
+      wake_.wait(lock);
+      continue;
+    }
+    if (*deadline > NowUs()) {
+      wake_.wait_until(lock, std::chrono::steady_clock::time_point(
+                                 std::chrono::microseconds(*deadline)));
+      continue;
+    }
+    engine_.Advance(NowUs(), &edges);
+    if (edges.empty()) {
+      continue;
+    }
+    // Unlocked, so the callback may feed the worker.
+    lock.unlock();
+    callback_(edges);
+    edges.clear();
+    lock.lock();
+  }
+}
+
+}  // namespace media_key_detector_core
@@ -0,0 +1,51 @@
+#include "media_key_detector_core/ffi_bridge.h"
+
+namespace media_key_detector_core {
+
+namespace {
+
+// Guarded by FfiBridgeMutex().
+ButtonEdgeWorker* g_button_edge_worker = nullptr;
+TapClassifierWorker* g_tap_classifier_worker = nullptr;
+
+}  // namespace
+
+std::mutex& FfiBridgeMutex() {
+  // Never destroyed: mkd_* may still be called while the process exits.
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+void InstallButtonEdgeWorker(ButtonEdgeWorker* worker) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  g_button_edge_worker = worker;
+}
+
+void UninstallButtonEdgeWorker(ButtonEdgeWorker* worker) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_button_edge_worker == worker) {
+    g_button_edge_worker = nullptr;
+  }
+}
+
+void InstallTapClassifierWorker(TapClassifierWorker* worker) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  g_tap_classifier_worker = worker;
+}
+
+void UninstallTapClassifierWorker(TapClassifierWorker* worker) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_tap_classifier_worker == worker) {
+    g_tap_classifier_worker = nullptr;
+  }
+}
+
+ButtonEdgeWorker* InstalledButtonEdgeWorker() {
+  return g_button_edge_worker;
+}
+
+TapClassifierWorker* InstalledTapClassifierWorker() {
+  return g_tap_classifier_worker;
+}
+
+}  // namespace media_key_detector_core
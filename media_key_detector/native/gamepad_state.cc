@@ -0,0 +1,149 @@
+#include "media_key_detector_core/gamepad_state.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace media_key_detector_core {
+
+namespace {
+
+bool IsOneWay(const GamepadAxisRange& range) {
+  return int64_t{range.resting} - range.minimum <= range.flat &&
+         range.maximum > range.minimum;
+}
+
+}  // namespace
+
+GamepadState::GamepadState(Options options) : options_(options) {}
+
+void GamepadState::SetAxisRange(uint16_t axis, const GamepadAxisRange& range) {
+  if (axis >= kGamepadAxisCount || range.maximum <= range.minimum) {
+    return;
+  }
+  axes_[axis].range = range;
+  axes_[axis].declared = true;
+  axes_[axis].value = Normalize(range, range.resting, options_.deadzone);
+}
+
+void GamepadState::OnButton(uint16_t button,
+                            int32_t value,
+                            int64_t timestamp_us,
+                            std::vector<GamepadEdge>* edges) {
+  if (button >= kGamepadButtonCount || value == 2) {
+    return;
+  }
+  SetHeld(button, value != 0, timestamp_us, edges);
+}
+
+void GamepadState::OnAxis(uint16_t axis,
+                          int32_t value,
+                          int64_t timestamp_us,
+                          std::vector<GamepadEdge>* edges) {
+  if (axis >= kGamepadAxisCount || !axes_[axis].declared) {
+    return;
+  }
+  Axis& state = axes_[axis];
+  state.value = Normalize(state.range, value, options_.deadzone);
+
+  float magnitude = std::fabs(state.value);
+  int8_t direction = state.direction;
+  int8_t sign = state.value < 0 ? -1 : 1;
+  if (direction != 0 && (direction != sign ||
+                         magnitude < options_.release_threshold)) {
+    direction = 0;
+  }
+  if (direction == 0 && magnitude >= options_.press_threshold) {
+    direction = sign;
+  }
+  if (direction == state.direction) {
+    return;
+  }
+  // A flick from one side to the other releases before it presses.
+  if (state.direction != 0) {
+    edges->push_back(
+        {GamepadAxisButton(axis, state.direction > 0), false, timestamp_us});
+  }
+  if (direction != 0) {
+    edges->push_back(
+        {GamepadAxisButton(axis, direction > 0), true, timestamp_us});
+  }
+  state.direction = direction;
+}
+
+float GamepadState::axis_value(uint16_t axis) const {
+  return axis < kGamepadAxisCount ? axes_[axis].value : 0;
+}
+
+bool GamepadState::button_held(uint32_t button) const {
+  if (button < kGamepadButtonCount) {
+    return held_[button];
+  }
+  uint32_t axis = (button - kGamepadAxisButtonBase) / 2;
+  if (button < kGamepadAxisButtonBase || axis >= kGamepadAxisCount) {
+    return false;
+  }
+  int8_t direction = (button & 1) != 0 ? 1 : -1;
+  return axes_[axis].direction == direction;
+}
+
+void GamepadState::Reset(int64_t timestamp_us,
+                         std::vector<GamepadEdge>* edges) {
+  for (uint32_t button = 0; button < kGamepadButtonCount; button++) {
+    SetHeld(button, false, timestamp_us, edges);
+  }
+  for (uint16_t axis = 0; axis < kGamepadAxisCount; axis++) {
+    Axis& state = axes_[axis];
+    if (state.direction != 0) {
+      edges->push_back({GamepadAxisButton(axis, state.direction > 0), false,
+                        timestamp_us});
+      state.direction = 0;
+    }
+    if (state.declared) {
+      state.value = Normalize(state.range, state.range.resting,
+                              options_.deadzone);
+    }
+  }
+}
+
+float GamepadState::Normalize(const GamepadAxisRange& range,
+                              int32_t value,
+                              float deadzone) {
+  if (range.maximum <= range.minimum) {
+    return 0;
+  }
+  value = std::clamp(value, range.minimum, range.maximum);
+  auto span = static_cast<float>(int64_t{range.maximum} - range.minimum);
+  float normalized;
+  float flat;
+  if (IsOneWay(range)) {
+    normalized = static_cast<float>(int64_t{value} - range.minimum) / span;
+    flat = range.flat / span;
+  } else {
+    // Twice the offset from the centre, so odd ranges like -128..127 stay
+    // symmetric.
+    int64_t doubled = 2 * int64_t{value} - range.minimum - range.maximum;
+    normalized = static_cast<float>(doubled) / span;
+    flat = 2.0f * range.flat / span;
+  }
+  // The device's own flat area widens the deadzone.
+  deadzone = std::clamp(std::max(deadzone, flat), 0.0f, 0.99f);
+  float magnitude = std::fabs(normalized);
+  if (magnitude <= deadzone) {
+    return 0;
+  }
+  magnitude = std::min((magnitude - deadzone) / (1 - deadzone), 1.0f);
+  return normalized < 0 ? -magnitude : magnitude;
+}
+
+void GamepadState::SetHeld(uint32_t button,
+                           bool pressed,
+                           int64_t timestamp_us,
+                           std::vector<GamepadEdge>* edges) {
+  if (held_[button] == pressed) {
+    return;
+  }
+  held_[button] = pressed;
+  edges->push_back({button, pressed, timestamp_us});
+}
+
+}  // namespace media_key_detector_core
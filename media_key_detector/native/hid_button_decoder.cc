@@ -0,0 +1,154 @@
+#include "media_key_detector_core/hid_button_decoder.h"
+
+#include <algorithm>
+
+namespace media_key_detector_core {
+
+namespace {
+
+constexpr uint32_t kMouse = HidUsage(kHidPageGenericDesktop, 0x02);
+constexpr uint32_t kKeyboard = HidUsage(kHidPageGenericDesktop, 0x06);
+constexpr uint32_t kKeypad = HidUsage(kHidPageGenericDesktop, 0x07);
+// Arrays with more values than this are not buttons but e.g. scancodes.
+constexpr int64_t kMaxArrayValues = 0x1000;
+
+uint16_t UsagePage(uint32_t usage) {
+  return static_cast<uint16_t>(usage >> 16);
+}
+
+bool IsButtonPage(uint16_t page) {
+  return page == kHidPageButton || page == kHidPageConsumer ||
+         page == kHidPageKeyboard;
+}
+
+}  // namespace
+
+bool IsHidButtonField(const HidField& field) {
+  if (field.application == kMouse || field.application == kKeyboard ||
+      field.application == kKeypad) {
+    return false;
+  }
+  if (field.variable()) {
+    // Anything wider than a bit is a level, e.g. a volume.
+    return field.bit_size == 1 && field.usage != 0 &&
+           IsButtonPage(UsagePage(field.usage));
+  }
+  if (field.logical_max < field.logical_min ||
+      static_cast<int64_t>(field.logical_max) - field.logical_min >=
+          kMaxArrayValues) {
+    return false;
+  }
+  return IsButtonPage(UsagePage(field.usage)) ||
+         IsButtonPage(UsagePage(field.usage_max));
+}
+
+HidButtonDecoder::HidButtonDecoder(const HidReportLayout& layout)
+    : report_sizes_(layout.report_sizes),
+      uses_report_ids_(layout.uses_report_ids) {
+  for (const HidField& field : layout.fields) {
+    if (!IsHidButtonField(field)) {
+      continue;
+    }
+    if (field.variable()) {
+      fields_.push_back({field, static_cast<uint32_t>(slots_.size()), 1});
+      slots_.push_back(field.usage);
+      continue;
+    }
+    // One slot per value between the logical minimum and maximum.
+    uint32_t values =
+        static_cast<uint32_t>(int64_t{field.logical_max} - field.logical_min) +
+        1;
+    fields_.push_back({field, static_cast<uint32_t>(slots_.size()), values});
+    for (uint32_t i = 0; i < values; i++) {
+      uint32_t usage = 0;
+      if (field.usage_list != HidField::kNoUsageList) {
+        if (i < field.usage_list_size) {
+          usage = layout.usages[field.usage_list + i];
+        }
+      } else if (field.usage + i <= field.usage_max) {
+        usage = field.usage + i;
+      }
+      // Usage ID 0 means "no button pressed".
+      slots_.push_back((usage & 0xFFFF) != 0 ? usage : 0);
+    }
+  }
+
+  std::stable_sort(fields_.begin(), fields_.end(),
+                   [](const Field& a, const Field& b) {
+                     return a.field.report_id < b.field.report_id;
+                   });
+  report_fields_.assign(report_sizes_.size(), {0, 0});
+  for (uint32_t i = 0; i < fields_.size(); i++) {
+    auto& range = report_fields_[fields_[i].field.report_id];
+    if (range.first == range.second) {
+      range.first = i;
+    }
+    range.second = i + 1;
+  }
+  held_.assign(slots_.size(), 0);
+  next_.assign(slots_.size(), 0);
+}
+
+void HidButtonDecoder::Decode(const uint8_t* report,
+                              size_t size,
+                              std::vector<HidButtonEdge>* edges) {
+  if (size == 0) {
+    return;
+  }
+  uint8_t id = uses_report_ids_ ? report[0] : 0;
+  if (id >= report_fields_.size() || size < report_sizes_[id]) {
+    return;
+  }
+  const auto& range = report_fields_[id];
+  if (range.first == range.second) {
+    return;
+  }
+
+  // Only the slots of this report change; the others keep their state.
+  for (uint32_t i = range.first; i < range.second; i++) {
+    std::fill_n(next_.begin() + fields_[i].first_slot, fields_[i].slot_count,
+                0);
+  }
+  for (uint32_t i = range.first; i < range.second; i++) {
+    const Field& entry = fields_[i];
+    const HidField& field = entry.field;
+    for (uint16_t index = 0; index < field.count; index++) {
+      int32_t value;
+      if (!ReadHidFieldValue(field, index, report, size, &value)) {
+        break;
+      }
+      if (field.variable()) {
+        next_[entry.first_slot] = value != 0;
+      } else if (value >= field.logical_min && value <= field.logical_max) {
+        next_[entry.first_slot + static_cast<uint32_t>(
+                                     int64_t{value} - field.logical_min)] = 1;
+      }
+    }
+  }
+
+  for (uint32_t i = range.first; i < range.second; i++) {
+    uint32_t end = fields_[i].first_slot + fields_[i].slot_count;
+    for (uint32_t slot = fields_[i].first_slot; slot < end; slot++) {
+      if (next_[slot] != held_[slot]) {
+        held_[slot] = next_[slot];
+        if (slots_[slot] != 0) {
+          edges->push_back({slots_[slot], held_[slot] != 0});
+        }
+      }
+    }
+  }
+}
+
+void HidButtonDecoder::Reset(std::vector<HidButtonEdge>* edges) {
+  for (uint32_t slot = 0; slot < slots_.size(); slot++) {
+    if (held_[slot] != 0) {
+      held_[slot] = 0;
+      if (slots_[slot] != 0) {
+        edges->push_back({slots_[slot], false});
+      }
+    }
+  }
+  std::fill(next_.begin(), next_.end(), 0);
+}
+
+}  // namespace media_key_detector_core
@@ -0,0 +1,418 @@
+#include "media_key_detector_core/hid_report_descriptor.h"
+
+#include <algorithm>
+
+namespace media_key_detector_core {
+
+namespace {
+
+enum ItemType : uint8_t { kMain = 0, kGlobal = 1, kLocal = 2 };
+
+// Main item tags.
+constexpr uint8_t kInput = 0x8;
+constexpr uint8_t kOutput = 0x9;
+constexpr uint8_t kFeature = 0xB;
+constexpr uint8_t kCollection = 0xA;
+constexpr uint8_t kEndCollection = 0xC;
+
+// Global item tags.
+constexpr uint8_t kUsagePage = 0x0;
+constexpr uint8_t kLogicalMinimum = 0x1;
+constexpr uint8_t kLogicalMaximum = 0x2;
+constexpr uint8_t kReportSize = 0x7;
+constexpr uint8_t kReportId = 0x8;
+constexpr uint8_t kReportCount = 0x9;
+constexpr uint8_t kPush = 0xA;
+constexpr uint8_t kPop = 0xB;
+
+// Local item tags.
+constexpr uint8_t kUsage = 0x0;
+constexpr uint8_t kUsageMinimum = 0x1;
+constexpr uint8_t kUsageMaximum = 0x2;
+
+constexpr uint8_t kLongItem = 0xFE;
+constexpr uint8_t kApplicationCollection = 0x01;
+// Reports are limited to 8 KiB, so bit offsets fit 16 bits.
+constexpr uint32_t kMaxReportBits = 0x10000;
+constexpr uint32_t kMaxReportCount = 4096;
+constexpr size_t kMaxStackDepth = 16;
+
+struct GlobalState {
+  uint16_t usage_page = 0;
+  int32_t logical_min = 0;
+  // Kept raw: whether it is signed depends on the logical minimum.
+  uint32_t logical_max_raw = 0;
+  uint8_t logical_max_size = 0;
+  uint32_t report_size = 0;
+  uint32_t report_count = 0;
+  uint8_t report_id = 0;
+};
+
+struct LocalState {
+  std::vector<uint32_t> usages;
+  uint32_t usage_min = 0;
+  uint32_t usage_max = 0;
+  bool has_usage_min = false;
+  bool has_usage_max = false;
+
+  void Clear() { *this = LocalState(); }
+};
+
+int32_t SignExtend(uint32_t value, uint8_t size) {
+  switch (size) {
+    case 1:
+      return static_cast<int8_t>(value);
+    case 2:
+      return static_cast<int16_t>(value);
+    default:
+      return static_cast<int32_t>(value);
+  }
+}
+
+// Short usages take the current usage page; 4-byte usages carry their own.
+uint32_t FullUsage(uint32_t value, uint8_t size, uint16_t usage_page) {
+  return size == 4 ? value : HidUsage(usage_page, static_cast<uint16_t>(value));
+}
+
+class Parser {
+ public:
+  explicit Parser(HidReportLayout* layout) : layout_(layout) {}
+
+  bool Parse(const uint8_t* data, size_t size, std::string* error);
+
+ private:
+  bool Main(uint8_t tag, uint32_t value, std::string* error);
+  bool Global(uint8_t tag, uint32_t value, uint8_t size, std::string* error);
+  void Local(uint8_t tag, uint32_t value, uint8_t size);
+  bool AddInput(uint32_t flags, std::string* error);
+
+  HidReportLayout* layout_;
+  GlobalState global_;
+  LocalState local_;
+  std::vector<GlobalState> global_stack_;
+  // Usage of each open collection, and whether it is an application.
+  std::vector<std::pair<uint32_t, bool>> collections_;
+  // Next free bit of the input report with each ID.
+  std::vector<uint32_t> report_bits_ = std::vector<uint32_t>(256, 0);
+};
+
+bool Parser::Parse(const uint8_t* data, size_t size, std::string* error) {
+  size_t position = 0;
+  while (position < size) {
+    uint8_t prefix = data[position++];
+    if (prefix == kLongItem) {
+      // Long items are reserved and carry no input fields.
+      if (position + 2 > size) {
+        *error = "truncated long item";
+        return false;
+      }
+      position += 2 + data[position];
+      continue;
+    }
+
+    uint8_t item_size = prefix & 0x3;
+    if (item_size == 3) {
+      item_size = 4;
+    }
+    if (position + item_size > size) {
+      *error = "truncated item";
+      return false;
+    }
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < item_size; i++) {
+      value |= static_cast<uint32_t>(data[position + i]) << (8 * i);
+    }
+    position += item_size;
+
+    uint8_t tag = prefix >> 4;
+    switch ((prefix >> 2) & 0x3) {
+      case kMain:
+        if (!Main(tag, value, error)) {
+          return false;
+        }
+        break;
+      case kGlobal:
+        if (!Global(tag, value, item_size, error)) {
+          return false;
+        }
+        break;
+      case kLocal:
+        Local(tag, value, item_size);
+        break;
+      default:
+        // Reserved item type.
+        break;
+    }
+  }
+  if (!collections_.empty()) {
+    *error = "unterminated collection";
+    return false;
+  }
+
+  uint16_t last_id = 0;
+  for (uint32_t id = 0; id < report_bits_.size(); id++) {
+    if (report_bits_[id] > 0) {
+      last_id = static_cast<uint16_t>(id);
+    }
+  }
+  layout_->report_sizes.assign(last_id + 1, 0);
+  for (uint32_t id = 0; id <= last_id; id++) {
+    layout_->report_sizes[id] =
+        static_cast<uint16_t>((report_bits_[id] + 7) / 8);
+  }
+  return true;
+}
+
+bool Parser::Main(uint8_t tag, uint32_t value, std::string* error) {
+  bool ok = true;
+  switch (tag) {
+    case kInput:
+      ok = AddInput(value, error);
+      break;
+    case kOutput:
+    case kFeature:
+      break;
+    case kCollection: {
+      if (collections_.size() == kMaxStackDepth) {
+        *error = "collections nested too deep";
+        return false;
+      }
+      uint32_t usage = local_.usages.empty() ? 0 : local_.usages.front();
+      bool application = (value & 0xFF) == kApplicationCollection;
+      collections_.emplace_back(usage, application);
+      if (application) {
+        layout_->applications.push_back(usage);
+      }
+      break;
+    }
+    case kEndCollection:
+      if (collections_.empty()) {
+        *error = "end of collection without collection";
+        return false;
+      }
+      collections_.pop_back();
+      break;
+    default:
+      break;
+  }
+  local_.Clear();
+  return ok;
+}
+
+bool Parser::Global(uint8_t tag,
+                    uint32_t value,
+                    uint8_t size,
+                    std::string* error) {
+  switch (tag) {
+    case kUsagePage:
+      global_.usage_page = static_cast<uint16_t>(value);
+      break;
+    case kLogicalMinimum:
+      global_.logical_min = SignExtend(value, size);
+      break;
+    case kLogicalMaximum:
+      global_.logical_max_raw = value;
+      global_.logical_max_size = size;
+      break;
+    case kReportSize:
+      if (value == 0 || value > 32) {
+        *error = "report size out of range";
+        return false;
+      }
+      global_.report_size = value;
+      break;
+    case kReportId:
+      if (value == 0 || value > 255) {
+        *error = "report ID out of range";
+        return false;
+      }
+      global_.report_id = static_cast<uint8_t>(value);
+      if (!layout_->uses_report_ids) {
+        layout_->uses_report_ids = true;
+        // Every report now starts with its ID.
+        if (report_bits_[0] > 0) {
+          *error = "report ID after reports without one";
+          return false;
+        }
+      }
+      break;
+    case kReportCount:
+      if (value > kMaxReportCount) {
+        *error = "report count out of range";
+        return false;
+      }
+      global_.report_count = value;
+      break;
+    case kPush:
+      if (global_stack_.size() == kMaxStackDepth) {
+        *error = "push without pop";
+        return false;
+      }
+      global_stack_.push_back(global_);
+      break;
+    case kPop:
+      if (global_stack_.empty()) {
+        *error = "pop without push";
+        return false;
+      }
+      global_ = global_stack_.back();
+      global_stack_.pop_back();
+      break;
+    default:
+      // Physical extents, units and exponents do not matter for buttons.
+      break;
+  }
+  return true;
+}
+
+void Parser::Local(uint8_t tag, uint32_t value, uint8_t size) {
+  switch (tag) {
+    case kUsage:
+      if (local_.usages.size() < kMaxReportCount) {
+        local_.usages.push_back(FullUsage(value, size, global_.usage_page));
+      }
+      break;
+    case kUsageMinimum:
+      local_.usage_min = FullUsage(value, size, global_.usage_page);
+      local_.has_usage_min = true;
+      break;
+    case kUsageMaximum:
+      local_.usage_max = FullUsage(value, size, global_.usage_page);
+      local_.has_usage_max = true;
+      break;
+    default:
+      // Designators and strings.
+      break;
+  }
+}
+
+bool Parser::AddInput(uint32_t flags, std::string* error) {
+  uint32_t& cursor = report_bits_[global_.report_id];
+  if (cursor == 0 && layout_->uses_report_ids) {
+    cursor = 8;
+  }
+  uint32_t bits = global_.report_size * global_.report_count;
+  if (cursor + bits > kMaxReportBits) {
+    *error = "report too long";
+    return false;
+  }
+  uint32_t offset = cursor;
+  cursor += bits;
+  // Constant fields are padding.
+  if ((flags & 0x1) != 0 || bits == 0) {
+    return true;
+  }
+
+  HidField field = {};
+  field.application = 0;
+  for (const auto& collection : collections_) {
+    if (collection.second) {
+      field.application = collection.first;
+      break;
+    }
+  }
+  field.logical_min = global_.logical_min;
+  field.logical_max =
+      global_.logical_min < 0
+          ? SignExtend(global_.logical_max_raw, global_.logical_max_size)
+          : static_cast<int32_t>(global_.logical_max_raw);
+  field.usage_list = HidField::kNoUsageList;
+  field.bit_size = static_cast<uint8_t>(global_.report_size);
+  field.report_id = global_.report_id;
+  field.flags = (flags & 0x2) != 0 ? kHidFieldVariable : 0;
+  if ((flags & 0x4) != 0) {
+    field.flags |= kHidFieldRelative;
+  }
+  if (field.logical_min < 0) {
+    field.flags |= kHidFieldSigned;
+  }
+
+  const std::vector<uint32_t>& usages = local_.usages;
+  bool has_range = local_.has_usage_min && local_.has_usage_max &&
+                   local_.usage_min <= local_.usage_max;
+  if (field.variable()) {
+    field.count = 1;
+    for (uint32_t i = 0; i < global_.report_count; i++) {
+      if (i < usages.size()) {
+        field.usage = usages[i];
+      } else if (has_range) {
+        field.usage = std::min(local_.usage_min + i, local_.usage_max);
+      } else if (!usages.empty()) {
+        field.usage = usages.back();
+      } else {
+        field.usage = 0;
+      }
+      field.usage_max = field.usage;
+      field.bit_offset =
+          static_cast<uint16_t>(offset + i * global_.report_size);
+      layout_->fields.push_back(field);
+    }
+    return true;
+  }
+
+  field.count = static_cast<uint16_t>(global_.report_count);
+  field.bit_offset = static_cast<uint16_t>(offset);
+  if (has_range) {
+    field.usage = local_.usage_min;
+    field.usage_max = local_.usage_max;
+  } else if (!usages.empty()) {
+    field.usage = usages.front();
+    field.usage_max = usages.back();
+    field.usage_list = static_cast<uint32_t>(layout_->usages.size());
+    field.usage_list_size = static_cast<uint16_t>(usages.size());
+    layout_->usages.insert(layout_->usages.end(), usages.begin(), usages.end());
+  } else {
+    // An array without usages reports nothing we could name.
+    return true;
+  }
+  layout_->fields.push_back(field);
+  return true;
+}
+
+}  // namespace
+
+bool ParseHidReportDescriptor(const uint8_t* data,
+                              size_t size,
+                              HidReportLayout* layout,
+                              std::string* error) {
+  *layout = HidReportLayout();
+  Parser parser(layout);
+  if (!parser.Parse(data, size, error)) {
+    *layout = HidReportLayout();
+    return false;
+  }
+  return true;
+}
+
+bool ReadHidFieldValue(const HidField& field,
+                       size_t index,
+                       const uint8_t* report,
+                       size_t size,
+                       int32_t* value) {
+  uint32_t first =
+      field.bit_offset + static_cast<uint32_t>(index) * field.bit_size;
+  uint32_t end = first + field.bit_size;
+  if ((end + 7) / 8 > size) {
+    return false;
+  }
+  // At most 5 bytes hold a 32-bit field at any bit position.
+  uint64_t bits = 0;
+  uint32_t first_byte = first / 8;
+  uint32_t last_byte = (end - 1) / 8;
+  for (uint32_t byte = last_byte + 1; byte-- > first_byte;) {
+    bits = bits << 8 | report[byte];
+  }
+  bits >>= first % 8;
+  uint32_t raw = static_cast<uint32_t>(bits);
+  if (field.bit_size < 32) {
+    raw &= (1u << field.bit_size) - 1;
+  }
+  if ((field.flags & kHidFieldSigned) != 0 && field.bit_size < 32 &&
+      (raw & (1u << (field.bit_size - 1))) != 0) {
+    raw |= ~0u << field.bit_size;
+  }
+  *value = static_cast<int32_t>(raw);
+  return true;
+}
+
+}  // namespace media_key_detector_core
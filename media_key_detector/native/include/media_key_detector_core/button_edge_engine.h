@@ -0,0 +1,181 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_BUTTON_EDGE_ENGINE_H_
+#define MEDIA_KEY_DETECTOR_CORE_BUTTON_EDGE_ENGINE_H_
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace media_key_detector_core {
+
+// Buttons are the bits of a device's 64-bit button mask.
+constexpr int kButtonEdgeMaxButtons = 64;
+
+enum class ButtonEdgeAction : int {
+  kPress = 0,
+  kRelease = 1,
+  // The button has been held for the long press time. Comes between the
+  // kPress and the kRelease of the press.
+  kLongPress = 2,
+  // The button is still held, every repeat interval after the long press.
+  kRepeat = 3,
+};
+
+struct ButtonEdge {
+  uint32_t device;
+  // Bit of the button in the device's mask.
+  uint8_t button;
+  ButtonEdgeAction action;
+  // Microseconds on the monotonic clock of the states passed in. For timed
+  // edges this is when they were due, not when they were emitted.
+  int64_t time_us;
+
+  bool operator==(const ButtonEdge& other) const {
+    return device == other.device && button == other.button &&
+           action == other.action && time_us == other.time_us;
+  }
+};
+
+// Turns the button masks that controllers report into the transitions of
+// their buttons: a press or release for each bit that changed since the last
+// mask of the same device, found by XOR, then long presses and repeats of
+// the buttons held. Masks that change nothing produce nothing, which is most
+// of them: controllers resend their state on every notification.
+//
+// Presses are reported at once. With a debounce time, releases are held back
+// for it like in MediaKeyClassifier: a press within it is contact bounce and
+// the button counts as held throughout. Repeats are on a fixed grid from the
+// long press, and missed ones are skipped rather than sent in a burst.
+//
+// Not thread-safe, and time is passed in, so tests drive it without a clock.
+class ButtonEdgeEngine {
+ public:
+  struct Options {
+    int64_t debounce_us = 0;
+    // 0 for no long presses, and so no repeats.
+    int64_t long_press_us = 500000;
+    // 0 for no repeats.
+    int64_t repeat_interval_us = 0;
+  };
+
+  ButtonEdgeEngine() : ButtonEdgeEngine(Options()) {}
+  explicit ButtonEdgeEngine(Options options);
+
+  // Feeds the |buttons| held on |device| at |time_us|, after emitting
+  // whatever was due before. Appends the resulting edges to |edges|, oldest
+  // first.
+  void Update(uint32_t device,
+              uint64_t buttons,
+              int64_t time_us,
+              std::vector<ButtonEdge>* edges);
+
+  // Releases the buttons of |device| and forgets it, e.g. on disconnection.
+  void RemoveDevice(uint32_t device,
+                    int64_t time_us,
+                    std::vector<ButtonEdge>* edges);
+
+  // Appends the edges due at |now_us|, oldest first.
+  void Advance(int64_t now_us, std::vector<ButtonEdge>* edges);
+
+  // When Advance() next has something to emit, or nullopt if nothing is
+  // pending.
+  std::optional<int64_t> NextDeadline() const;
+
+  // Forgets every device without emitting anything.
+  void Reset() { devices_.clear(); }
+
+  const Options& options() const { return options_; }
+
+ private:
+  struct Device {
+    uint32_t id;
+    // The mask last reported.
+    uint64_t raw = 0;
+    // Pressed and not released yet, including those releasing.
+    uint64_t held = 0;
+    // Released, but held back for the debounce time.
+    uint64_t releasing = 0;
+    uint64_t long_pressed = 0;
+    std::array<int64_t, kButtonEdgeMaxButtons> down_us{};
+    std::array<int64_t, kButtonEdgeMaxButtons> up_us{};
+    std::array<int64_t, kButtonEdgeMaxButtons> next_repeat_us{};
+  };
+
+  Device* Find(uint32_t device);
+
+  // The time Advance() has to act on |button| of |device|, if any.
+  std::optional<int64_t> Deadline(const Device& device, int button) const;
+
+  void Release(Device* device,
+               int button,
+               int64_t time_us,
+               std::vector<ButtonEdge>* edges);
+
+  Options options_;
+  // Few devices are connected at once, so a linear search beats a map.
+  std::vector<Device> devices_;
+};
+
+// Runs a ButtonEdgeEngine on a thread of its own, which sleeps until the
+// next long press, repeat or held back release is due. Thread-safe.
+class ButtonEdgeWorker {
+ public:
+  // Called on the worker thread with the edges that came due by time, and
+  // on the calling thread with those that Update() spills.
+  using Callback = std::function<void(const std::vector<ButtonEdge>& edges)>;
+
+  explicit ButtonEdgeWorker(Callback callback,
+                            ButtonEdgeEngine::Options options = {});
+  ~ButtonEdgeWorker();
+
+  // Disallow copy and assign.
+  ButtonEdgeWorker(const ButtonEdgeWorker&) = delete;
+  ButtonEdgeWorker& operator=(const ButtonEdgeWorker&) = delete;
+
+  // As ButtonEdgeEngine::Update(). The edges go to |edges| rather than the
+  // callback, so transitions reach the caller without a thread hop. Those
+  // beyond the first |limit| go to the callback instead, on this thread.
+  void Update(uint32_t device,
+              uint64_t buttons,
+              int64_t time_us,
+              std::vector<ButtonEdge>* edges,
+              size_t limit = SIZE_MAX);
+
+  // As ButtonEdgeEngine::RemoveDevice(), with |limit| as in Update().
+  void RemoveDevice(uint32_t device,
+                    int64_t time_us,
+                    std::vector<ButtonEdge>* edges,
+                    size_t limit = SIZE_MAX);
+
+  // Replaces the options and forgets every device.
+  void SetOptions(ButtonEdgeEngine::Options options);
+
+  // Microseconds on the clock the thread waits on, CLOCK_MONOTONIC on Linux
+  // like Dart's Timeline.now. Timestamps passed in must be on it.
+  static int64_t NowUs();
+
+ private:
+  void Run();
+
+  // Hands the edges past the first |limit| from |start| on in |edges| to the
+  // callback.
+  void Spill(std::vector<ButtonEdge>* edges, size_t start, size_t limit);
+
+  Callback callback_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  // Guarded by mutex_.
+  ButtonEdgeEngine engine_;
+  bool stopping_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_BUTTON_EDGE_ENGINE_H_
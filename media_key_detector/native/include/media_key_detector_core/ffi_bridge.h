@@ -0,0 +1,35 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_FFI_BRIDGE_H_
+#define MEDIA_KEY_DETECTOR_CORE_FFI_BRIDGE_H_
+
+#include <mutex>
+
+#include "media_key_detector_core/button_edge_engine.h"
+#include "media_key_detector_core/media_key_detector_ffi.h"
+#include "media_key_detector_core/tap_classifier.h"
+
+namespace media_key_detector_core {
+
+// Routes the mkd_button_* functions to |worker| until
+// UninstallButtonEdgeWorker(). The plugin owns the worker and forwards its
+// timed edges to Dart. Only one worker is installed at a time; a second
+// plugin instance replaces the first.
+void InstallButtonEdgeWorker(ButtonEdgeWorker* worker);
+
+// Does nothing if |worker| has been replaced since. Once this returns, no
+// mkd_* call uses |worker| any more, so it can be deleted.
+void UninstallButtonEdgeWorker(ButtonEdgeWorker* worker);
+
+// As the two above, for the mkd_tap* functions.
+void InstallTapClassifierWorker(TapClassifierWorker* worker);
+void UninstallTapClassifierWorker(TapClassifierWorker* worker);
+
+// Held by the mkd_* calls that use an installed worker.
+std::mutex& FfiBridgeMutex();
+
+// The installed workers, or null. FfiBridgeMutex() must be held.
+ButtonEdgeWorker* InstalledButtonEdgeWorker();
+TapClassifierWorker* InstalledTapClassifierWorker();
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_FFI_BRIDGE_H_
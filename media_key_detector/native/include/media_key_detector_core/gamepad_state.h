@@ -0,0 +1,116 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_GAMEPAD_STATE_H_
+#define MEDIA_KEY_DETECTOR_CORE_GAMEPAD_STATE_H_
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace media_key_detector_core {
+
+// Buttons are identified by their evdev key code (BTN_SOUTH is 0x130), below
+// kGamepadButtonCount. Each axis also acts as two buttons, one per
+// direction, identified by GamepadAxisButton().
+constexpr uint32_t kGamepadButtonCount = 0x300;
+constexpr uint32_t kGamepadAxisCount = 0x40;
+constexpr uint32_t kGamepadAxisButtonBase = 0x1000;
+
+constexpr uint32_t GamepadAxisButton(uint16_t axis, bool positive) {
+  return kGamepadAxisButtonBase + axis * 2u + (positive ? 1u : 0u);
+}
+
+// A button, or axis direction, that was pressed or released.
+struct GamepadEdge {
+  uint32_t button;
+  bool pressed;
+  int64_t timestamp_us;
+
+  bool operator==(const GamepadEdge& other) const {
+    return button == other.button && pressed == other.pressed &&
+           timestamp_us == other.timestamp_us;
+  }
+};
+
+// The raw range of an axis, as EVIOCGABS reports it.
+struct GamepadAxisRange {
+  int32_t minimum;
+  int32_t maximum;
+  // Raw values this close to the rest position count as resting.
+  int32_t flat;
+  // The value when the axis was first seen. Axes resting at their minimum,
+  // like triggers, only go one way; all others are centred.
+  int32_t resting;
+};
+
+// Turns the raw button and axis values of one gamepad into button edges.
+//
+// Axes are normalised to [-1, 1], or [0, 1] for one-way axes, with the
+// deadzone cut out and the rest rescaled, so that a small deadzone does not
+// swallow the start of the travel. A direction counts as pressed from
+// press_threshold on and as released below release_threshold; the gap keeps
+// a stick resting near the threshold from chattering. Repeated and
+// unchanged values produce nothing, so only state changes leave the engine.
+//
+// Not thread-safe; owned by the thread that reads the device.
+class GamepadState {
+ public:
+  struct Options {
+    float deadzone = 0.15f;
+    float press_threshold = 0.5f;
+    float release_threshold = 0.35f;
+  };
+
+  GamepadState() : GamepadState(Options()) {}
+  explicit GamepadState(Options options);
+
+  // Declares |axis|. Values of undeclared axes are ignored.
+  void SetAxisRange(uint16_t axis, const GamepadAxisRange& range);
+
+  // Feeds a new value of |button|: 0 for up, 1 for down and 2 for an
+  // autorepeat, which is dropped.
+  void OnButton(uint16_t button,
+                int32_t value,
+                int64_t timestamp_us,
+                std::vector<GamepadEdge>* edges);
+
+  // Feeds a new raw value of |axis|.
+  void OnAxis(uint16_t axis,
+              int32_t value,
+              int64_t timestamp_us,
+              std::vector<GamepadEdge>* edges);
+
+  // The last value of |axis|, normalised, or 0 if it is undeclared.
+  float axis_value(uint16_t axis) const;
+
+  bool button_held(uint32_t button) const;
+
+  // Releases everything held, e.g. when the device goes away.
+  void Reset(int64_t timestamp_us, std::vector<GamepadEdge>* edges);
+
+  // |value| of an axis with |range|, normalised, with |deadzone| cut out.
+  static float Normalize(const GamepadAxisRange& range,
+                         int32_t value,
+                         float deadzone);
+
+ private:
+  struct Axis {
+    GamepadAxisRange range;
+    bool declared = false;
+    float value = 0;
+    // Direction held: -1, 0 or 1.
+    int8_t direction = 0;
+  };
+
+  void SetHeld(uint32_t button,
+               bool pressed,
+               int64_t timestamp_us,
+               std::vector<GamepadEdge>* edges);
+
+  Options options_;
+  std::array<Axis, kGamepadAxisCount> axes_;
+  std::bitset<kGamepadButtonCount> held_;
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_GAMEPAD_STATE_H_
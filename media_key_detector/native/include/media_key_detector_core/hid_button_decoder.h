@@ -0,0 +1,74 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_HID_BUTTON_DECODER_H_
+#define MEDIA_KEY_DETECTOR_CORE_HID_BUTTON_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "media_key_detector_core/hid_report_descriptor.h"
+
+namespace media_key_detector_core {
+
+// A button of an HID device that was pressed or released.
+struct HidButtonEdge {
+  uint32_t usage;
+  bool pressed;
+
+  bool operator==(const HidButtonEdge& other) const {
+    return usage == other.usage && pressed == other.pressed;
+  }
+};
+
+// Whether |field| reports buttons: fields on the button, consumer and
+// keyboard pages, except those of keyboards, keypads and mice, which the
+// desktop already handles.
+bool IsHidButtonField(const HidField& field);
+
+// Turns the input reports of one device into button edges.
+//
+// Everything is laid out when the decoder is built: each button gets a slot,
+// and each array value maps straight to a slot. Decoding a report then only
+// reads the fields at their precomputed offsets and allocates nothing (as
+// long as |edges| has the capacity).
+class HidButtonDecoder {
+ public:
+  explicit HidButtonDecoder(const HidReportLayout& layout);
+
+  // Whether the device has any button at all.
+  bool has_buttons() const { return !slots_.empty(); }
+
+  // Appends the buttons pressed or released by |report|, as read from
+  // hidraw, to |edges|. Reports that are too short for their fields or
+  // have an unknown ID are ignored.
+  void Decode(const uint8_t* report,
+              size_t size,
+              std::vector<HidButtonEdge>* edges);
+
+  // Releases every held button, e.g. when the device goes away.
+  void Reset(std::vector<HidButtonEdge>* edges);
+
+ private:
+  struct Field {
+    HidField field;
+    // Variable fields: the slot of the button. Arrays: the slot of the
+    // logical minimum, followed by one slot per value.
+    uint32_t first_slot;
+    uint32_t slot_count;
+  };
+
+  // Fields, grouped by report ID with report_fields_ holding each group's
+  // range.
+  std::vector<Field> fields_;
+  std::vector<std::pair<uint32_t, uint32_t>> report_fields_;
+  std::vector<uint16_t> report_sizes_;
+  bool uses_report_ids_;
+  // Usage of each slot; 0 for array values without one.
+  std::vector<uint32_t> slots_;
+  // Slots pressed by the last report, and by the one being decoded.
+  std::vector<uint8_t> held_;
+  std::vector<uint8_t> next_;
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_HID_BUTTON_DECODER_H_
@@ -0,0 +1,92 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_HID_REPORT_DESCRIPTOR_H_
+#define MEDIA_KEY_DETECTOR_CORE_HID_REPORT_DESCRIPTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace media_key_detector_core {
+
+// Usages are the usage page in the upper and the usage ID in the lower 16
+// bits, e.g. 0x000C00CD for Consumer / Play/Pause.
+constexpr uint32_t HidUsage(uint16_t page, uint16_t id) {
+  return static_cast<uint32_t>(page) << 16 | id;
+}
+
+constexpr uint16_t kHidPageGenericDesktop = 0x01;
+constexpr uint16_t kHidPageKeyboard = 0x07;
+constexpr uint16_t kHidPageButton = 0x09;
+constexpr uint16_t kHidPageConsumer = 0x0C;
+
+enum HidFieldFlags : uint8_t {
+  // One value per usage, rather than an array of usage indices.
+  kHidFieldVariable = 1 << 0,
+  kHidFieldRelative = 1 << 1,
+  // The logical minimum is negative, so values are sign-extended.
+  kHidFieldSigned = 1 << 2,
+};
+
+// One input field of a report. Variable fields are split into one field per
+// usage, so every field has a single position in the report.
+struct HidField {
+  // Variable fields: the usage. Arrays: the usage of the smallest value,
+  // unless they have a usage list.
+  uint32_t usage;
+  // Arrays: the usage of the largest value.
+  uint32_t usage_max;
+  // Usage of the application collection the field is in, or 0.
+  uint32_t application;
+  int32_t logical_min;
+  int32_t logical_max;
+  // Arrays that list their usages: index of the first in
+  // HidReportLayout::usages. Otherwise kNoUsageList.
+  uint32_t usage_list;
+  uint16_t usage_list_size;
+  // From the start of the report as hidraw returns it, i.e. including the
+  // report ID byte if the device uses report IDs.
+  uint16_t bit_offset;
+  // Arrays: the number of values. Variable fields: 1.
+  uint16_t count;
+  uint8_t bit_size;
+  uint8_t report_id;
+  uint8_t flags;
+
+  static constexpr uint32_t kNoUsageList = 0xFFFFFFFF;
+
+  bool variable() const { return (flags & kHidFieldVariable) != 0; }
+};
+
+// The input reports of a device, as described by its report descriptor.
+struct HidReportLayout {
+  // Whether reports start with a report ID byte.
+  bool uses_report_ids = false;
+  std::vector<HidField> fields;
+  // Usage lists of array fields.
+  std::vector<uint32_t> usages;
+  // Length in bytes of the input report with each ID, including the ID byte.
+  // Indexed by report ID; 0 for IDs the device does not have.
+  std::vector<uint16_t> report_sizes;
+  // Usages of the application collections, in order.
+  std::vector<uint32_t> applications;
+};
+
+// Parses the report descriptor |data| into |layout|. Output and feature
+// reports are skipped. Returns false with a reason in |error| for
+// descriptors that are malformed or describe reports over 8 KiB.
+bool ParseHidReportDescriptor(const uint8_t* data,
+                              size_t size,
+                              HidReportLayout* layout,
+                              std::string* error);
+
+// Reads the value of |field| at |index| (0 for variable fields) from
+// |report|. Returns false if the report is too short for it.
+bool ReadHidFieldValue(const HidField& field,
+                       size_t index,
+                       const uint8_t* report,
+                       size_t size,
+                       int32_t* value);
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_HID_REPORT_DESCRIPTOR_H_
@@ -0,0 +1,105 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_CLASSIFIER_H_
+#define MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_CLASSIFIER_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace media_key_detector_core {
+
+// Indices of MediaKey in the platform interface.
+enum MediaKeyIndex : int {
+  kMediaKeyPlayPause = 0,
+  kMediaKeyRewind = 1,
+  kMediaKeyFastForward = 2,
+  kMediaKeyVolumeUp = 3,
+  kMediaKeyVolumeDown = 4,
+};
+
+constexpr int kMediaKeyCount = 5;
+
+enum class MediaKeyAction : int {
+  kDown = 0,
+  kUp = 1,
+  // The key has been held for the long press time. Comes between the kDown
+  // and the kUp of the press.
+  kLongPress = 2,
+  // A whole press, from sources that do not report downs and ups
+  // separately, like hotkeys and MPRIS.
+  kPress = 3,
+};
+
+struct MediaKeyGesture {
+  MediaKeyIndex key;
+  MediaKeyAction action;
+  // Milliseconds on the clock of the events passed in. For kLongPress this is
+  // the press time plus the long press time.
+  uint32_t time_ms;
+
+  bool operator==(const MediaKeyGesture& other) const {
+    return key == other.key && action == other.action &&
+           time_ms == other.time_ms;
+  }
+};
+
+// Turns the raw downs and ups of media keys into debounced presses and long
+// presses.
+//
+// Downs are reported at once, and autorepeated downs are dropped. Ups are
+// held back for the debounce time: a down within it is contact bounce of a
+// cheap remote, and the key counts as held throughout. Releases therefore
+// come debounce_ms late, but with the time of the original up.
+//
+// Times are milliseconds on a wrapping 32-bit clock such as GetTickCount(),
+// which KBDLLHOOKSTRUCT uses. Not thread-safe, and time is passed in, so
+// tests drive it without a clock.
+class MediaKeyClassifier {
+ public:
+  struct Options {
+    uint32_t debounce_ms = 30;
+    uint32_t long_press_ms = 500;
+  };
+
+  MediaKeyClassifier() : MediaKeyClassifier(Options()) {}
+  explicit MediaKeyClassifier(Options options);
+
+  // Feeds a down or up of |key| seen at |time_ms|, after emitting whatever
+  // was due before it. Appends the resulting gestures to |gestures|, oldest
+  // first. Keys out of range are ignored.
+  void OnKey(int key,
+             bool down,
+             uint32_t time_ms,
+             std::vector<MediaKeyGesture>* gestures);
+
+  // Appends the long presses and releases due at |now_ms|, oldest first.
+  void Advance(uint32_t now_ms, std::vector<MediaKeyGesture>* gestures);
+
+  // Milliseconds from |now_ms| until Advance() has something to emit, 0 if
+  // it is overdue, or nullopt if nothing is pending.
+  std::optional<uint32_t> TimeUntilNextDeadline(uint32_t now_ms) const;
+
+  // Forgets every key without emitting anything, e.g. when the source of the
+  // events is restarted.
+  void Reset();
+
+ private:
+  enum class State { kReleased, kHeld, kReleasing };
+
+  struct Key {
+    State state = State::kReleased;
+    uint32_t down_ms = 0;
+    uint32_t up_ms = 0;
+    bool long_pressed = false;
+  };
+
+  // The time Advance() has to act on |key|, if any.
+  std::optional<uint32_t> Deadline(const Key& key) const;
+
+  Options options_;
+  std::array<Key, kMediaKeyCount> keys_;
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_CLASSIFIER_H_
@@ -0,0 +1,122 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_DETECTOR_FFI_H_
+#define MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_DETECTOR_FFI_H_
+
+// C ABI exported by the Linux plugin for direct calls through dart:ffi, for
+// work that is too small to pay for a trip through a platform channel. Plain
+// C so the Dart bindings can be written from this header alone.
+//
+// The functions may be called from any thread and never call back into
+// Dart. They take Dart typed data directly, so they are meant to be bound as
+// leaf calls.
+//
+// Compatible changes only add functions; anything else bumps MKD_ABI_VERSION.
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define MKD_EXPORT __declspec(dllexport)
+#else
+#define MKD_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MKD_ABI_VERSION 2
+
+// Results of the mkd_* calls.
+enum {
+  MKD_OK = 0,
+  // No plugin is registered.
+  MKD_ERROR_UNAVAILABLE = -1,
+  MKD_ERROR_INVALID_ARGUMENT = -2,
+  // The input is not a valid message.
+  MKD_ERROR_MALFORMED = -5,
+};
+
+// The |kind| argument of mkd_decode_zwift_keypad.
+enum {
+  MKD_ZWIFT_CLICK = 0,
+  MKD_ZWIFT_PLAY = 1,
+  MKD_ZWIFT_RIDE = 2,
+};
+
+// ZwiftKeypadState: the bits of the buttons held, and the analog paddle
+// values by location. Twenty bytes, without padding, so Dart can pass an
+// Int32List of five elements.
+typedef struct {
+  uint32_t buttons;
+  int32_t analog[4];
+} MkdZwiftKeypad;
+
+// Actions of the button edges, as in ButtonEdgeAction.
+enum {
+  MKD_BUTTON_PRESS = 0,
+  MKD_BUTTON_RELEASE = 1,
+  MKD_BUTTON_LONG_PRESS = 2,
+  MKD_BUTTON_REPEAT = 3,
+};
+
+MKD_EXPORT int32_t mkd_abi_version(void);
+
+// Decodes a keypad notification of |kind| as received over Bluetooth, with
+// its leading message type byte, into |out|.
+MKD_EXPORT int32_t mkd_decode_zwift_keypad(int32_t kind,
+                                           const uint8_t* notification,
+                                           int64_t size,
+                                           MkdZwiftKeypad* out);
+
+// Feeds the |buttons| (one bit each) held on |device| at |timestamp_us| to
+// the plugin's ButtonEdgeWorker, on the clock of Dart's Timeline.now. The
+// edges it causes are written to |edges| as int64 quadruples of device,
+// button, action and timestamp, up to |capacity| edges. Returns their number
+// or an error. Edges that come due later, and those that did not fit, are
+// sent to the plugin's button edge event channel.
+MKD_EXPORT int32_t mkd_button_state(uint32_t device,
+                                    uint64_t buttons,
+                                    int64_t timestamp_us,
+                                    int64_t* edges,
+                                    int32_t capacity);
+
+// Releases the buttons of |device| and forgets it, with |edges| as in
+// mkd_button_state.
+MKD_EXPORT int32_t mkd_button_remove_device(uint32_t device,
+                                            int64_t timestamp_us,
+                                            int64_t* edges,
+                                            int32_t capacity);
+
+// Sets the timing of the button edges, in microseconds, and forgets every
+// device. A |long_press_us| or |repeat_interval_us| of 0 turns long presses
+// or repeats off.
+MKD_EXPORT int32_t mkd_button_options(int64_t debounce_us,
+                                      int64_t long_press_us,
+                                      int64_t repeat_interval_us);
+
+// Feeds a tap of |device| that arrived at |timestamp_us| to the plugin's
+// TapClassifierWorker, on the clock of Dart's Timeline.now. The gestures it
+// resolves at once are written to |gestures| as int64 triples of device,
+// number of taps and timestamp, up to |capacity| gestures. Returns their
+// number or an error. Gestures resolved later, and those that did not fit,
+// are sent to the plugin's tap event channel.
+MKD_EXPORT int32_t mkd_tap(uint32_t device,
+                           int64_t timestamp_us,
+                           int64_t* gestures,
+                           int32_t capacity);
+
+// Sets how |device|'s taps are counted: the longest gap between the taps of
+// one gesture in microseconds, the most taps of a gesture (at least 1), and
+// whether a first tap is reported at once. Drops its pending taps.
+MKD_EXPORT int32_t mkd_tap_options(uint32_t device,
+                                   int64_t window_us,
+                                   int32_t max_taps,
+                                   int32_t optimistic);
+
+// Forgets |device|, its pending taps and its options.
+MKD_EXPORT int32_t mkd_tap_remove_device(uint32_t device);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_DETECTOR_FFI_H_
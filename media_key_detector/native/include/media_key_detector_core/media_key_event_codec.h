@@ -0,0 +1,100 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_EVENT_CODEC_H_
+#define MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_EVENT_CODEC_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "media_key_detector_core/media_key_classifier.h"
+
+namespace media_key_detector_core {
+
+// Where a media key event came from.
+enum class MediaKeySource : uint8_t {
+  kUnknown = 0,
+  // RegisterHotKey on Windows.
+  kHotkey = 1,
+  // The low-level keyboard hook on Windows.
+  kKeyboardHook = 2,
+  // MPRIS or the GNOME settings daemon on Linux.
+  kDBus = 3,
+  // An input device read directly on Linux.
+  kEvdev = 4,
+};
+
+struct MediaKeyRecord {
+  MediaKeyIndex key;
+  MediaKeyAction action;
+  MediaKeySource source;
+  // The input device within |source|, e.g. N of /dev/input/eventN, or 0 if
+  // the source does not tell devices apart.
+  uint16_t device;
+  // When the key was seen, on the clock of Dart's Timeline.now.
+  int64_t timestamp_us;
+
+  bool operator==(const MediaKeyRecord& other) const {
+    return key == other.key && action == other.action &&
+           source == other.source && device == other.device &&
+           timestamp_us == other.timestamp_us;
+  }
+};
+
+// The media key event channels of the plugins send batches of records as
+// one Uint8List each. All numbers are little-endian:
+//
+//   header:  u8 version, u8 record size, u16 record count
+//   record:  i64 timestamp_us, u16 device, u8 key, u8 action, u8 source,
+//            3 bytes of zero padding
+//
+// Decoders skip any bytes past the fields they know in a record, so records
+// can grow without breaking older readers.
+constexpr uint8_t kMediaKeyBatchVersion = 1;
+constexpr size_t kMediaKeyBatchHeaderSize = 4;
+constexpr size_t kMediaKeyRecordSize = 16;
+// Limited by the u16 record count.
+constexpr size_t kMaxMediaKeyBatchRecords = 0xFFFF;
+
+// Replaces |out| with the batch of |records|. At most
+// kMaxMediaKeyBatchRecords records fit; returns false if there are more.
+bool EncodeMediaKeyBatch(const std::vector<MediaKeyRecord>& records,
+                         std::vector<uint8_t>* out);
+
+// Appends the records of the batch in |data| to |records|, leaving out
+// records of unknown keys. Returns false, appending nothing, if |data| is no
+// complete batch of a known version.
+bool DecodeMediaKeyBatch(const uint8_t* data,
+                         size_t size,
+                         std::vector<MediaKeyRecord>* records);
+
+// Collects the records of one platform message, so a burst from a remote
+// goes out as one message instead of one per key.
+//
+// Producers Add() on any thread. The first record of a batch asks them to
+// schedule a Take() on the platform thread window_ms() later; everything
+// added until then goes out with it.
+class MediaKeyBatcher {
+ public:
+  // Returns true if the batch was empty, so a Take() has to be scheduled.
+  // Records beyond kMaxMediaKeyBatchRecords in one batch are dropped.
+  bool Add(const MediaKeyRecord& record);
+
+  // Encodes the pending records into |out| and starts a new batch. Returns
+  // false if there were none.
+  bool Take(std::vector<uint8_t>* out);
+
+  // How long producers wait before sending a batch. 0, the default, sends
+  // it as soon as the platform thread gets to it.
+  uint32_t window_ms() const { return window_ms_.load(); }
+  void set_window_ms(uint32_t window_ms) { window_ms_.store(window_ms); }
+
+ private:
+  std::mutex mutex_;
+  std::vector<MediaKeyRecord> pending_;
+  std::atomic<uint32_t> window_ms_{0};
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_MEDIA_KEY_EVENT_CODEC_H_
@@ -0,0 +1,145 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_TAP_CLASSIFIER_H_
+#define MEDIA_KEY_DETECTOR_CORE_TAP_CLASSIFIER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace media_key_detector_core {
+
+struct TapGesture {
+  uint32_t device;
+  // 1 for a single tap, 2 for a double tap, and so on.
+  uint8_t taps;
+  // When the last tap of the gesture arrived, in microseconds on the clock
+  // of the taps passed in.
+  int64_t time_us;
+
+  bool operator==(const TapGesture& other) const {
+    return device == other.device && taps == other.taps &&
+           time_us == other.time_us;
+  }
+};
+
+// Counts the taps of devices that only report "something was tapped", like
+// the SRAM AXS trigger, into single, double and triple taps.
+//
+// Taps closer together than the window of their device make up one gesture.
+// It is resolved when its last tap is a window old, or at once when it
+// reaches the most taps the device has. In optimistic mode the first tap is
+// reported at once instead, so single taps are not delayed by the window;
+// a gesture of more taps is then reported in addition when it resolves.
+//
+// Not thread-safe, and time is passed in, so tests drive it without a clock.
+class TapClassifier {
+ public:
+  struct Options {
+    // Longest gap between the taps of one gesture, exclusive.
+    int64_t window_us = 300000;
+    // At least 1. A tap that reaches it resolves the gesture at once.
+    int max_taps = 2;
+    bool optimistic = false;
+  };
+
+  TapClassifier() : TapClassifier(Options()) {}
+  // |defaults| applies to devices without options of their own.
+  explicit TapClassifier(Options defaults);
+
+  // Sets the options of |device|, dropping its pending taps.
+  void SetDeviceOptions(uint32_t device, Options options);
+
+  // Feeds a tap of |device| that arrived at |time_us|, after emitting
+  // whatever was due before. Appends the resulting gestures to |gestures|,
+  // oldest first.
+  void OnTap(uint32_t device,
+             int64_t time_us,
+             std::vector<TapGesture>* gestures);
+
+  // Forgets |device|, its pending taps and its options, e.g. on
+  // disconnection.
+  void RemoveDevice(uint32_t device);
+
+  // Appends the gestures due at |now_us|, oldest first.
+  void Advance(int64_t now_us, std::vector<TapGesture>* gestures);
+
+  // When Advance() next has something to emit, or nullopt if nothing is
+  // pending.
+  std::optional<int64_t> NextDeadline() const;
+
+  // Forgets every device without emitting anything.
+  void Reset() { devices_.clear(); }
+
+ private:
+  struct Device {
+    uint32_t id;
+    Options options;
+    // Of the gesture in progress, 0 if none is.
+    int taps = 0;
+    int64_t last_tap_us = 0;
+  };
+
+  Device* Find(uint32_t device);
+  Device* FindOrAdd(uint32_t device);
+
+  // Appends the gesture in progress on |device| unless it was already
+  // reported, and ends it.
+  void Resolve(Device* device, std::vector<TapGesture>* gestures);
+
+  Options defaults_;
+  // Few devices are connected at once, so a linear search beats a map.
+  std::vector<Device> devices_;
+};
+
+// Runs a TapClassifier on a thread of its own, which sleeps until the next
+// gesture is due. Thread-safe.
+class TapClassifierWorker {
+ public:
+  // Called on the worker thread with the gestures that came due by time, and
+  // on the calling thread with those that OnTap() spills.
+  using Callback = std::function<void(const std::vector<TapGesture>& gestures)>;
+
+  explicit TapClassifierWorker(Callback callback,
+                               TapClassifier::Options defaults = {});
+  ~TapClassifierWorker();
+
+  // Disallow copy and assign.
+  TapClassifierWorker(const TapClassifierWorker&) = delete;
+  TapClassifierWorker& operator=(const TapClassifierWorker&) = delete;
+
+  // As TapClassifier::OnTap(). The gestures go to |gestures| rather than the
+  // callback, so those resolved at once reach the caller without a thread
+  // hop. Those beyond the first |limit| go to the callback instead, on this
+  // thread.
+  void OnTap(uint32_t device,
+             int64_t time_us,
+             std::vector<TapGesture>* gestures,
+             size_t limit = SIZE_MAX);
+
+  void SetDeviceOptions(uint32_t device, TapClassifier::Options options);
+  void RemoveDevice(uint32_t device);
+
+  // Microseconds on the clock the thread waits on, CLOCK_MONOTONIC on Linux
+  // like Dart's Timeline.now. Timestamps passed in must be on it.
+  static int64_t NowUs();
+
+ private:
+  void Run();
+
+  Callback callback_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  // Guarded by mutex_.
+  TapClassifier classifier_;
+  bool stopping_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_TAP_CLASSIFIER_H_
@@ -0,0 +1,82 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_ZWIFT_KEYPAD_H_
+#define MEDIA_KEY_DETECTOR_CORE_ZWIFT_KEYPAD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace media_key_detector_core {
+
+// The keypad status messages of zwift.proto, one per controller family.
+enum class ZwiftKeypadKind : int32_t {
+  // ClickKeyPadStatus of the Zwift Click.
+  kClick = 0,
+  // PlayKeyPadStatus of the Zwift Play controllers.
+  kPlay = 1,
+  // RideKeyPadStatus of the Zwift Ride and the Click v2.
+  kRide = 2,
+};
+
+// Bits of ZwiftKeypadState::buttons, set while the button is held. The low
+// 16 bits are those of RideKeyPadStatus.ButtonMap, which the Ride sends
+// inverted; the Click and Play buttons are mapped onto the same bits.
+enum ZwiftButton : uint32_t {
+  kZwiftNavigationLeft = 1u << 0,
+  kZwiftNavigationUp = 1u << 1,
+  kZwiftNavigationRight = 1u << 2,
+  kZwiftNavigationDown = 1u << 3,
+  kZwiftA = 1u << 4,
+  kZwiftB = 1u << 5,
+  kZwiftY = 1u << 6,
+  kZwiftZ = 1u << 7,
+  kZwiftShiftUpLeft = 1u << 8,
+  kZwiftShiftDownLeft = 1u << 9,
+  kZwiftPowerUpLeft = 1u << 10,
+  kZwiftOnOffLeft = 1u << 11,
+  kZwiftShiftUpRight = 1u << 12,
+  kZwiftShiftDownRight = 1u << 13,
+  kZwiftPowerUpRight = 1u << 14,
+  kZwiftOnOffRight = 1u << 15,
+  // Play only.
+  kZwiftSideLeft = 1u << 16,
+  kZwiftSideRight = 1u << 17,
+  // Analog paddles pulled far enough to count as a press.
+  kZwiftPaddleLeft = 1u << 18,
+  kZwiftPaddleRight = 1u << 19,
+};
+
+// Locations of ZwiftKeypadState::analog, as in RideAnalogLocation.
+constexpr int kZwiftAnalogLeft = 0;
+constexpr int kZwiftAnalogRight = 1;
+constexpr int kZwiftAnalogCount = 4;
+
+// Minimum absolute value of a Ride paddle that presses it. Lighter touches
+// and drift are ignored.
+constexpr int32_t kZwiftRidePaddleThreshold = 25;
+// A Play paddle only presses when pulled all the way.
+constexpr int32_t kZwiftPlayPaddleThreshold = 100;
+
+// What one keypad notification says. Plain data, so it can be handed out
+// through the C ABI as is.
+struct ZwiftKeypadState {
+  // ZwiftButton bits.
+  uint32_t buttons;
+  // Paddle values from -100 to 100 by location, 0 where none was sent. The
+  // Play reports the paddle of its side in analog[kZwiftAnalogLeft] or
+  // analog[kZwiftAnalogRight].
+  int32_t analog[kZwiftAnalogCount];
+};
+
+// Decodes a keypad status message of |kind|, without its leading message
+// type byte, into |state|. Reads the protobuf wire format in place and skips
+// fields it does not know, so it neither allocates nor copies. The result
+// matches the generated Dart decoder and the app's button mapping, including
+// proto3 defaults: a Click or Play button that is not sent counts as pressed.
+// Returns false if the message is malformed; |state| is unspecified then.
+bool DecodeZwiftKeypad(ZwiftKeypadKind kind,
+                       const uint8_t* data,
+                       size_t size,
+                       ZwiftKeypadState* state);
+
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_ZWIFT_KEYPAD_H_
@@ -0,0 +1,128 @@
+#include "media_key_detector_core/media_key_classifier.h"
+
+namespace media_key_detector_core {
+
+namespace {
+
+// Milliseconds from |from| to |to|, negative if |to| is earlier. Correct
+// across the wrap of the 32-bit clock as long as the two are within 24 days.
+int32_t Elapsed(uint32_t from, uint32_t to) {
+  return static_cast<int32_t>(to - from);
+}
+
+}  // namespace
+
+MediaKeyClassifier::MediaKeyClassifier(Options options) : options_(options) {}
+
+void MediaKeyClassifier::OnKey(int key,
+                               bool down,
+                               uint32_t time_ms,
+                               std::vector<MediaKeyGesture>* gestures) {
+  if (key < 0 || key >= kMediaKeyCount) {
+    return;
+  }
+  Advance(time_ms, gestures);
+
+  Key& state = keys_[key];
+  auto index = static_cast<MediaKeyIndex>(key);
+  if (down) {
+    switch (state.state) {
+      case State::kReleased:
+        state = {State::kHeld, time_ms, 0, false};
+        gestures->push_back({index, MediaKeyAction::kDown, time_ms});
+        break;
+      case State::kReleasing:
+        // Bounce: the press goes on.
+        state.state = State::kHeld;
+        break;
+      case State::kHeld:
+        // Autorepeat.
+        break;
+    }
+    return;
+  }
+
+  // Ups of keys that are not held were pressed before we started watching.
+  if (state.state != State::kHeld) {
+    return;
+  }
+  if (options_.debounce_ms == 0) {
+    state.state = State::kReleased;
+    gestures->push_back({index, MediaKeyAction::kUp, time_ms});
+    return;
+  }
+  state.state = State::kReleasing;
+  state.up_ms = time_ms;
+}
+
+void MediaKeyClassifier::Advance(uint32_t now_ms,
+                                 std::vector<MediaKeyGesture>* gestures) {
+  while (true) {
+    // The earliest due deadline, so that gestures come out in time order.
+    int earliest = -1;
+    int32_t earliest_overdue = 0;
+    for (int key = 0; key < kMediaKeyCount; key++) {
+      std::optional<uint32_t> deadline = Deadline(keys_[key]);
+      if (!deadline) {
+        continue;
+      }
+      int32_t overdue = Elapsed(*deadline, now_ms);
+      if (overdue >= 0 && (earliest < 0 || overdue > earliest_overdue)) {
+        earliest = key;
+        earliest_overdue = overdue;
+      }
+    }
+    if (earliest < 0) {
+      return;
+    }
+
+    Key& state = keys_[earliest];
+    auto index = static_cast<MediaKeyIndex>(earliest);
+    if (state.state == State::kHeld) {
+      state.long_pressed = true;
+      gestures->push_back({index, MediaKeyAction::kLongPress,
+                           state.down_ms + options_.long_press_ms});
+    } else {
+      state.state = State::kReleased;
+      gestures->push_back({index, MediaKeyAction::kUp, state.up_ms});
+    }
+  }
+}
+
+std::optional<uint32_t> MediaKeyClassifier::TimeUntilNextDeadline(
+    uint32_t now_ms) const {
+  std::optional<uint32_t> next;
+  for (const Key& key : keys_) {
+    std::optional<uint32_t> deadline = Deadline(key);
+    if (!deadline) {
+      continue;
+    }
+    int32_t remaining = Elapsed(now_ms, *deadline);
+    uint32_t wait = remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+    if (!next || wait < *next) {
+      next = wait;
+    }
+  }
+  return next;
+}
+
+void MediaKeyClassifier::Reset() {
+  keys_.fill(Key());
+}
+
+std::optional<uint32_t> MediaKeyClassifier::Deadline(const Key& key) const {
+  switch (key.state) {
+    case State::kHeld:
+      if (!key.long_pressed) {
+        return key.down_ms + options_.long_press_ms;
+      }
+      return std::nullopt;
+    case State::kReleasing:
+      return key.up_ms + options_.debounce_ms;
+    case State::kReleased:
+      return std::nullopt;
+  }
+  return std::nullopt;
+}
+
+}  // namespace media_key_detector_core
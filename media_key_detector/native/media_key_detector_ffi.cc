@@ -0,0 +1,191 @@
+#include "media_key_detector_core/media_key_detector_ffi.h"
+
+#include <type_traits>
+#include <vector>
+
+#include "media_key_detector_core/ffi_bridge.h"
+#include "media_key_detector_core/zwift_keypad.h"
+
+using media_key_detector_core::ButtonEdge;
+using media_key_detector_core::ButtonEdgeEngine;
+using media_key_detector_core::ButtonEdgeWorker;
+using media_key_detector_core::TapClassifier;
+using media_key_detector_core::TapClassifierWorker;
+using media_key_detector_core::TapGesture;
+using media_key_detector_core::ZwiftKeypadKind;
+using media_key_detector_core::ZwiftKeypadState;
+
+namespace {
+
+// Writes |edges| to |out| as quadruples. Returns their number.
+int32_t WriteEdges(const std::vector<ButtonEdge>& edges, int64_t* out) {
+  for (const ButtonEdge& edge : edges) {
+    *out++ = edge.device;
+    *out++ = edge.button;
+    *out++ = static_cast<int64_t>(edge.action);
+    *out++ = edge.time_us;
+  }
+  return static_cast<int32_t>(edges.size());
+}
+
+// Writes |gestures| to |out| as triples. Returns their number.
+int32_t WriteGestures(const std::vector<TapGesture>& gestures, int64_t* out) {
+  for (const TapGesture& gesture : gestures) {
+    *out++ = gesture.device;
+    *out++ = gesture.taps;
+    *out++ = gesture.time_us;
+  }
+  return static_cast<int32_t>(gestures.size());
+}
+
+}  // namespace
+
+// The C struct is the C++ one, under a name of its own.
+static_assert(sizeof(MkdZwiftKeypad) == sizeof(ZwiftKeypadState) &&
+                  sizeof(MkdZwiftKeypad) == 20 &&
+                  std::is_standard_layout<ZwiftKeypadState>::value,
+              "MkdZwiftKeypad must match ZwiftKeypadState");
+
+extern "C" {
+
+int32_t mkd_abi_version(void) {
+  return MKD_ABI_VERSION;
+}
+
+int32_t mkd_decode_zwift_keypad(int32_t kind,
+                                const uint8_t* notification,
+                                int64_t size,
+                                MkdZwiftKeypad* out) {
+  if (kind < MKD_ZWIFT_CLICK || kind > MKD_ZWIFT_RIDE ||
+      notification == nullptr || size < 1 || out == nullptr) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  ZwiftKeypadState state;
+  bool valid = media_key_detector_core::DecodeZwiftKeypad(
+      static_cast<ZwiftKeypadKind>(kind), notification + 1,
+      static_cast<size_t>(size - 1), &state);
+  if (!valid) {
+    return MKD_ERROR_MALFORMED;
+  }
+  out->buttons = state.buttons;
+  for (int i = 0; i < 4; i++) {
+    out->analog[i] = state.analog[i];
+  }
+  return MKD_OK;
+}
+
+int32_t mkd_button_state(uint32_t device,
+                         uint64_t buttons,
+                         int64_t timestamp_us,
+                         int64_t* edges,
+                         int32_t capacity) {
+  if (edges == nullptr || capacity < 0) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  ButtonEdgeWorker* worker =
+      media_key_detector_core::InstalledButtonEdgeWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  // Reused, so the usual call does not allocate.
+  static std::vector<ButtonEdge> result;
+  result.clear();
+  worker->Update(device, buttons, timestamp_us, &result,
+                 static_cast<size_t>(capacity));
+  return WriteEdges(result, edges);
+}
+
+int32_t mkd_button_remove_device(uint32_t device,
+                                 int64_t timestamp_us,
+                                 int64_t* edges,
+                                 int32_t capacity) {
+  if (edges == nullptr || capacity < 0) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  ButtonEdgeWorker* worker =
+      media_key_detector_core::InstalledButtonEdgeWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  std::vector<ButtonEdge> result;
+  worker->RemoveDevice(device, timestamp_us, &result,
+                       static_cast<size_t>(capacity));
+  return WriteEdges(result, edges);
+}
+
+int32_t mkd_button_options(int64_t debounce_us,
+                           int64_t long_press_us,
+                           int64_t repeat_interval_us) {
+  if (debounce_us < 0 || long_press_us < 0 || repeat_interval_us < 0) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  ButtonEdgeWorker* worker =
+      media_key_detector_core::InstalledButtonEdgeWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  worker->SetOptions(
+      ButtonEdgeEngine::Options{debounce_us, long_press_us,
+                                repeat_interval_us});
+  return MKD_OK;
+}
+
+int32_t mkd_tap(uint32_t device,
+                int64_t timestamp_us,
+                int64_t* gestures,
+                int32_t capacity) {
+  if (gestures == nullptr || capacity < 0) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  TapClassifierWorker* worker =
+      media_key_detector_core::InstalledTapClassifierWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  // Reused, so the usual call does not allocate.
+  static std::vector<TapGesture> result;
+  result.clear();
+  worker->OnTap(device, timestamp_us, &result, static_cast<size_t>(capacity));
+  return WriteGestures(result, gestures);
+}
+
+int32_t mkd_tap_options(uint32_t device,
+                        int64_t window_us,
+                        int32_t max_taps,
+                        int32_t optimistic) {
+  if (window_us < 0 || max_taps < 1 || max_taps > UINT8_MAX) {
+    return MKD_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  TapClassifierWorker* worker =
+      media_key_detector_core::InstalledTapClassifierWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  worker->SetDeviceOptions(
+      device, TapClassifier::Options{window_us, max_taps, optimistic != 0});
+  return MKD_OK;
+}
+
+int32_t mkd_tap_remove_device(uint32_t device) {
+  std::lock_guard<std::mutex> lock(
+      media_key_detector_core::FfiBridgeMutex());
+  TapClassifierWorker* worker =
+      media_key_detector_core::InstalledTapClassifierWorker();
+  if (worker == nullptr) {
+    return MKD_ERROR_UNAVAILABLE;
+  }
+  worker->RemoveDevice(device);
+  return MKD_OK;
+}
+
+}  // extern "C"
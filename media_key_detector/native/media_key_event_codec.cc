@@ -0,0 +1,103 @@
+#include "media_key_detector_core/media_key_event_codec.h"
+
+namespace media_key_detector_core {
+
+namespace {
+
+void PutU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutI64(uint8_t* out, int64_t value) {
+  auto bits = static_cast<uint64_t>(value);
+  for (int i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(bits >> (8 * i));
+  }
+}
+
+uint16_t GetU16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | in[1] << 8);
+}
+
+int64_t GetI64(const uint8_t* in) {
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; i++) {
+    bits |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  return static_cast<int64_t>(bits);
+}
+
+}  // namespace
+
+bool EncodeMediaKeyBatch(const std::vector<MediaKeyRecord>& records,
+                         std::vector<uint8_t>* out) {
+  if (records.size() > kMaxMediaKeyBatchRecords) {
+    return false;
+  }
+  // Zero-filled, which covers the padding.
+  out->assign(kMediaKeyBatchHeaderSize + records.size() * kMediaKeyRecordSize,
+              0);
+  uint8_t* position = out->data();
+  position[0] = kMediaKeyBatchVersion;
+  position[1] = kMediaKeyRecordSize;
+  PutU16(position + 2, static_cast<uint16_t>(records.size()));
+  position += kMediaKeyBatchHeaderSize;
+  for (const MediaKeyRecord& record : records) {
+    PutI64(position, record.timestamp_us);
+    PutU16(position + 8, record.device);
+    position[10] = static_cast<uint8_t>(record.key);
+    position[11] = static_cast<uint8_t>(record.action);
+    position[12] = static_cast<uint8_t>(record.source);
+    position += kMediaKeyRecordSize;
+  }
+  return true;
+}
+
+bool DecodeMediaKeyBatch(const uint8_t* data,
+                         size_t size,
+                         std::vector<MediaKeyRecord>* records) {
+  if (size < kMediaKeyBatchHeaderSize || data[0] != kMediaKeyBatchVersion ||
+      data[1] < kMediaKeyRecordSize) {
+    return false;
+  }
+  size_t record_size = data[1];
+  size_t count = GetU16(data + 2);
+  if (size < kMediaKeyBatchHeaderSize + count * record_size) {
+    return false;
+  }
+  const uint8_t* position = data + kMediaKeyBatchHeaderSize;
+  for (size_t i = 0; i < count; i++, position += record_size) {
+    if (position[10] >= kMediaKeyCount) {
+      continue;
+    }
+    records->push_back({static_cast<MediaKeyIndex>(position[10]),
+                        static_cast<MediaKeyAction>(position[11]),
+                        static_cast<MediaKeySource>(position[12]),
+                        GetU16(position + 8), GetI64(position)});
+  }
+  return true;
+}
+
+bool MediaKeyBatcher::Add(const MediaKeyRecord& record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.size() < kMaxMediaKeyBatchRecords) {
+    pending_.push_back(record);
+  }
+  return pending_.size() == 1;
+}
+
+bool MediaKeyBatcher::Take(std::vector<uint8_t>* out) {
+  // Encoding under the lock keeps the capacity of pending_ for the next
+  // batch.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.empty()) {
+    return false;
+  }
+  // Cannot fail: Add() keeps batches small enough.
+  EncodeMediaKeyBatch(pending_, out);
+  pending_.clear();
+  return true;
+}
+
+}  // namespace media_key_detector_core
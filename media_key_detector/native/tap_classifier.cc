@@ -0,0 +1,189 @@
+#include "media_key_detector_core/tap_classifier.h"
+
+#include <chrono>
+#include <utility>
+
+namespace media_key_detector_core {
+
+TapClassifier::TapClassifier(Options defaults) : defaults_(defaults) {}
+
+void TapClassifier::SetDeviceOptions(uint32_t device, Options options) {
+  Device* state = FindOrAdd(device);
+  state->options = options;
+  state->taps = 0;
+}
+
+void TapClassifier::OnTap(uint32_t device,
+                          int64_t time_us,
+                          std::vector<TapGesture>* gestures) {
+  Advance(time_us, gestures);
+
+  Device* state = FindOrAdd(device);
+  state->taps++;
+  state->last_tap_us = time_us;
+  if (state->taps == 1 && state->options.optimistic) {
+    gestures->push_back({device, 1, time_us});
+  }
+  if (state->taps >= state->options.max_taps) {
+    Resolve(state, gestures);
+  }
+}
+
+void TapClassifier::RemoveDevice(uint32_t device) {
+  Device* state = Find(device);
+  if (state != nullptr) {
+    devices_.erase(devices_.begin() + (state - devices_.data()));
+  }
+}
+
+void TapClassifier::Advance(int64_t now_us,
+                            std::vector<TapGesture>* gestures) {
+  while (true) {
+    // The earliest due deadline, so that gestures come out in time order.
+    Device* earliest = nullptr;
+    int64_t earliest_deadline = 0;
+    for (Device& device : devices_) {
+      if (device.taps == 0) {
+        continue;
+      }
+      int64_t deadline = device.last_tap_us + device.options.window_us;
+      if (deadline <= now_us &&
+          (earliest == nullptr || deadline < earliest_deadline)) {
+        earliest = &device;
+        earliest_deadline = deadline;
+      }
+    }
+    if (earliest == nullptr) {
+      return;
+    }
+    Resolve(earliest, gestures);
+  }
+}
+
+std::optional<int64_t> TapClassifier::NextDeadline() const {
+  std::optional<int64_t> next;
+  for (const Device& device : devices_) {
+    if (device.taps == 0) {
+      continue;
+    }
+    int64_t deadline = device.last_tap_us + device.options.window_us;
+    if (!next || deadline < *next) {
+      next = deadline;
+    }
+  }
+  return next;
+}
+
+TapClassifier::Device* TapClassifier::Find(uint32_t device) {
+  for (Device& state : devices_) {
+    if (state.id == device) {
+      return &state;
+    }
+  }
+  return nullptr;
+}
+
+TapClassifier::Device* TapClassifier::FindOrAdd(uint32_t device) {
+  Device* state = Find(device);
+  if (state == nullptr) {
+    devices_.push_back(Device{device, defaults_});
+    state = &devices_.back();
+  }
+  return state;
+}
+
+void TapClassifier::Resolve(Device* device,
+                            std::vector<TapGesture>* gestures) {
+  // An optimistic single tap went out with the tap itself.
+  if (device->taps > 1 || !device->options.optimistic) {
+    gestures->push_back({device->id, static_cast<uint8_t>(device->taps),
+                         device->last_tap_us});
+  }
+  device->taps = 0;
+}
+
+TapClassifierWorker::TapClassifierWorker(Callback callback,
+                                         TapClassifier::Options defaults)
+    : callback_(std::move(callback)),
+      classifier_(defaults),
+      thread_(&TapClassifierWorker::Run, this) {}
+
+TapClassifierWorker::~TapClassifierWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void TapClassifierWorker::OnTap(uint32_t device,
+                                int64_t time_us,
+                                std::vector<TapGesture>* gestures,
+                                size_t limit) {
+  size_t start = gestures->size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    classifier_.OnTap(device, time_us, gestures);
+  }
+  // The next deadline may have moved.
+  wake_.notify_one();
+  if (gestures->size() - start <= limit) {
+    return;
+  }
+  std::vector<TapGesture> spilled(gestures->begin() + start + limit,
+                                  gestures->end());
+  gestures->resize(start + limit);
+  callback_(spilled);
+}
+
+void TapClassifierWorker::SetDeviceOptions(uint32_t device,
+                                           TapClassifier::Options options) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    classifier_.SetDeviceOptions(device, options);
+  }
+  wake_.notify_one();
+}
+
+void TapClassifierWorker::RemoveDevice(uint32_t device) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    classifier_.RemoveDevice(device);
+  }
+  wake_.notify_one();
+}
+
+int64_t TapClassifierWorker::NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void TapClassifierWorker::Run() {
+  std::vector<TapGesture> gestures;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    std::optional<int64_t> deadline = classifier_.NextDeadline();
+    if (!deadline) {
+      wake_.wait(lock);
+      continue;
+    }
+    if (*deadline > NowUs()) {
+      wake_.wait_until(lock, std::chrono::steady_clock::time_point(
+                                 std::chrono::microseconds(*deadline)));
+      continue;
+    }
+    classifier_.Advance(NowUs(), &gestures);
+    if (gestures.empty()) {
+      continue;
+    }
+    // Unlocked, so the callback may feed the worker.
+    lock.unlock();
+    callback_(gestures);
+    gestures.clear();
+    lock.lock();
+  }
+}
+
+}  // namespace media_key_detector_core
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "media_key_detector_core/button_edge_engine.h"
+#include "media_key_detector_core/ffi_bridge.h"
+#include "media_key_detector_core/media_key_detector_ffi.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kRide = 1;
+constexpr uint32_t kPad = 2;
+
+ButtonEdge Press(uint32_t device, uint8_t button, int64_t time_us) {
+  return {device, button, ButtonEdgeAction::kPress, time_us};
+}
+
+ButtonEdge Release(uint32_t device, uint8_t button, int64_t time_us) {
+  return {device, button, ButtonEdgeAction::kRelease, time_us};
+}
+
+ButtonEdge LongPress(uint32_t device, uint8_t button, int64_t time_us) {
+  return {device, button, ButtonEdgeAction::kLongPress, time_us};
+}
+
+ButtonEdge Repeat(uint32_t device, uint8_t button, int64_t time_us) {
+  return {device, button, ButtonEdgeAction::kRepeat, time_us};
+}
+
+// Collects the edges a ButtonEdgeWorker emits on its thread.
+class EdgeSink {
+ public:
+  void Add(const std::vector<ButtonEdge>& edges) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    edges_.insert(edges_.end(), edges.begin(), edges.end());
+    added_.notify_all();
+  }
+
+  std::vector<ButtonEdge> WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    added_.wait_for(lock, std::chrono::seconds(5),
+                    [&] { return edges_.size() >= count; });
+    return edges_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable added_;
+  std::vector<ButtonEdge> edges_;
+};
+
+}  // namespace
+
+TEST(ButtonEdgeEngine, ReportsOnlyTransitions) {
+  ButtonEdgeEngine engine({0, 0, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0, 0, &edges);
+  engine.Update(kRide, 0b1001, 1000, &edges);
+  engine.Update(kRide, 0b1001, 2000, &edges);
+  engine.Update(kRide, 0b1001, 3000, &edges);
+  engine.Update(kRide, 0b1000, 4000, &edges);
+  engine.Update(kRide, uint64_t{1} << 63, 5000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{
+                       Press(kRide, 0, 1000), Press(kRide, 3, 1000),
+                       Release(kRide, 0, 4000), Press(kRide, 63, 5000),
+                       Release(kRide, 3, 5000)}));
+}
+
+TEST(ButtonEdgeEngine, KeepsDevicesApart) {
+  ButtonEdgeEngine engine({0, 0, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b1, 1000, &edges);
+  engine.Update(kPad, 0b1, 2000, &edges);
+  engine.Update(kRide, 0, 3000, &edges);
+  engine.Update(kPad, 0b1, 4000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 0, 1000),
+                                            Press(kPad, 0, 2000),
+                                            Release(kRide, 0, 3000)}));
+}
+
+TEST(ButtonEdgeEngine, LongPressesAndRepeatsOnAGrid) {
+  ButtonEdgeEngine engine({0, 500000, 100000});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b10, 0, &edges);
+  edges.clear();
+  EXPECT_EQ(engine.NextDeadline(), 500000);
+
+  engine.Advance(499999, &edges);
+  EXPECT_TRUE(edges.empty());
+  engine.Advance(650000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{LongPress(kRide, 1, 500000),
+                                            Repeat(kRide, 1, 600000)}));
+  EXPECT_EQ(engine.NextDeadline(), 700000);
+
+  // After a stall, the missed repeats are skipped.
+  edges.clear();
+  engine.Advance(1050000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Repeat(kRide, 1, 700000)}));
+  EXPECT_EQ(engine.NextDeadline(), 1100000);
+
+  edges.clear();
+  engine.Update(kRide, 0, 1060000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Release(kRide, 1, 1060000)}));
+  EXPECT_EQ(engine.NextDeadline(), std::nullopt);
+}
+
+TEST(ButtonEdgeEngine, ReleaseBeforeTheLongPressCancelsIt) {
+  ButtonEdgeEngine engine({0, 500000, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b1, 0, &edges);
+  engine.Update(kRide, 0, 400000, &edges);
+  engine.Advance(2000000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 0, 0),
+                                            Release(kRide, 0, 400000)}));
+}
+
+TEST(ButtonEdgeEngine, DebouncesReleases) {
+  ButtonEdgeEngine engine({30000, 0, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b1, 0, &edges);
+  // Bounce.
+  engine.Update(kRide, 0, 10000, &edges);
+  engine.Update(kRide, 0b1, 20000, &edges);
+  engine.Update(kRide, 0, 40000, &edges);
+  EXPECT_EQ(engine.NextDeadline(), 70000);
+  engine.Advance(69999, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 0, 0)}));
+
+  // The release keeps the time it happened at.
+  engine.Advance(70000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 0, 0),
+                                            Release(kRide, 0, 40000)}));
+
+  // A press after the debounce time is a new one, even if the release had
+  // not been emitted yet.
+  edges.clear();
+  engine.Update(kRide, 0b1, 100000, &edges);
+  engine.Update(kRide, 0, 110000, &edges);
+  engine.Update(kRide, 0b1, 150000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 0, 100000),
+                                            Release(kRide, 0, 110000),
+                                            Press(kRide, 0, 150000)}));
+}
+
+TEST(ButtonEdgeEngine, EmitsTimedEdgesOfAllDevicesInTimeOrder) {
+  ButtonEdgeEngine engine({0, 500000, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b100, 0, &edges);
+  engine.Update(kPad, 0b1, 100000, &edges);
+  engine.Update(kRide, 0b110, 50000, &edges);
+  edges.clear();
+  engine.Advance(1000000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{LongPress(kRide, 2, 500000),
+                                            LongPress(kRide, 1, 550000),
+                                            LongPress(kPad, 0, 600000)}));
+}
+
+TEST(ButtonEdgeEngine, RemovingADeviceReleasesItsButtons) {
+  ButtonEdgeEngine engine({30000, 500000, 0});
+  std::vector<ButtonEdge> edges;
+  engine.Update(kRide, 0b11, 0, &edges);
+  engine.Update(kRide, 0b10, 10000, &edges);
+  engine.RemoveDevice(kRide, 20000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{
+                       Press(kRide, 0, 0), Press(kRide, 1, 0),
+                       Release(kRide, 0, 10000), Release(kRide, 1, 20000)}));
+  EXPECT_EQ(engine.NextDeadline(), std::nullopt);
+
+  // Its next mask starts afresh.
+  edges.clear();
+  engine.Update(kRide, 0b10, 30000, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kRide, 1, 30000)}));
+}
+
+TEST(ButtonEdgeWorker, ReturnsTransitionsAndSendsTimedEdges) {
+  EdgeSink sink;
+  ButtonEdgeWorker worker(
+      [&](const std::vector<ButtonEdge>& edges) { sink.Add(edges); },
+      {0, 20000, 0});
+  int64_t start = ButtonEdgeWorker::NowUs();
+  std::vector<ButtonEdge> edges;
+  worker.Update(kPad, 0b1, start, &edges);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kPad, 0, start)}));
+
+  EXPECT_EQ(sink.WaitFor(1),
+            (std::vector<ButtonEdge>{LongPress(kPad, 0, start + 20000)}));
+  // Not before it was due.
+  EXPECT_GE(ButtonEdgeWorker::NowUs(), start + 20000);
+}
+
+TEST(ButtonEdgeWorker, SpillsEdgesBeyondTheLimitToTheCallback) {
+  EdgeSink sink;
+  ButtonEdgeWorker worker(
+      [&](const std::vector<ButtonEdge>& edges) { sink.Add(edges); },
+      {0, 0, 0});
+  std::vector<ButtonEdge> edges;
+  worker.Update(kPad, 0b111, 1000, &edges, 2);
+  EXPECT_EQ(edges, (std::vector<ButtonEdge>{Press(kPad, 0, 1000),
+                                            Press(kPad, 1, 1000)}));
+  EXPECT_EQ(sink.WaitFor(1),
+            (std::vector<ButtonEdge>{Press(kPad, 2, 1000)}));
+}
+
+TEST(ButtonEdgeWorker, IsReachableThroughTheCAbi) {
+  int64_t out[4 * 4] = {};
+  EXPECT_EQ(mkd_button_state(kRide, 1, 0, out, 4), MKD_ERROR_UNAVAILABLE);
+
+  EdgeSink sink;
+  ButtonEdgeWorker worker(
+      [&](const std::vector<ButtonEdge>& edges) { sink.Add(edges); });
+  InstallButtonEdgeWorker(&worker);
+  ASSERT_EQ(mkd_button_options(0, 0, 0), MKD_OK);
+  EXPECT_EQ(mkd_button_options(-1, 0, 0), MKD_ERROR_INVALID_ARGUMENT);
+
+  ASSERT_EQ(mkd_button_state(kRide, 0b100, 1000, out, 4), 1);
+  EXPECT_EQ(out[0], kRide);
+  EXPECT_EQ(out[1], 2);
+  EXPECT_EQ(out[2], MKD_BUTTON_PRESS);
+  EXPECT_EQ(out[3], 1000);
+  EXPECT_EQ(mkd_button_state(kRide, 0b100, 2000, out, 4), 0);
+
+  ASSERT_EQ(mkd_button_remove_device(kRide, 3000, out, 4), 1);
+  EXPECT_EQ(out[2], MKD_BUTTON_RELEASE);
+  EXPECT_EQ(out[3], 3000);
+
+  UninstallButtonEdgeWorker(&worker);
+  EXPECT_EQ(mkd_button_state(kRide, 1, 0, out, 4), MKD_ERROR_UNAVAILABLE);
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "media_key_detector_core/gamepad_state.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr uint16_t kButtonSouth = 0x130;
+constexpr uint16_t kAxisX = 0x00;
+constexpr uint16_t kAxisZ = 0x02;
+constexpr uint16_t kAxisHat0X = 0x10;
+
+// An Xbox pad's left stick and trigger, as EVIOCGABS reports them.
+constexpr GamepadAxisRange kStick = {-32768, 32767, 128, 0};
+constexpr GamepadAxisRange kTrigger = {0, 1023, 0, 0};
+constexpr GamepadAxisRange kHat = {-1, 1, 0, 0};
+
+// Raw stick value for the normalised |value|, with the default deadzone.
+int32_t Stick(float value) {
+  float raw = value * (1 - 0.15f) + (value < 0 ? -0.15f : 0.15f);
+  return static_cast<int32_t>(raw * 32767);
+}
+
+}  // namespace
+
+TEST(GamepadState, NormalizesCentredAndOneWayAxes) {
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kStick, 32767, 0), 1);
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kStick, -32768, 0), -1);
+  // The stick's flat area is a deadzone of its own.
+  EXPECT_NEAR(GamepadState::Normalize(kStick, 16384, 0), 0.498f, 0.001f);
+  EXPECT_NEAR(GamepadState::Normalize({-32768, 32767, 0, 0}, 16384, 0), 0.5f,
+              0.001f);
+  // Out of range values are clamped.
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kStick, 40000, 0), 1);
+
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kTrigger, 0, 0), 0);
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kTrigger, 1023, 0), 1);
+  EXPECT_NEAR(GamepadState::Normalize(kTrigger, 512, 0), 0.5f, 0.001f);
+
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kHat, -1, 0), -1);
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kHat, 0, 0), 0);
+}
+
+TEST(GamepadState, RescalesOutsideTheDeadzone) {
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kStick, 3000, 0.1f), 0);
+  EXPECT_NEAR(GamepadState::Normalize(kStick, Stick(0.5f), 0.15f), 0.5f,
+              0.001f);
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(kStick, -32768, 0.15f), -1);
+
+  // The device's flat area counts when it is larger.
+  GamepadAxisRange flat_stick = {0, 255, 64, 128};
+  EXPECT_FLOAT_EQ(GamepadState::Normalize(flat_stick, 180, 0.1f), 0);
+  EXPECT_GT(GamepadState::Normalize(flat_stick, 200, 0.1f), 0);
+}
+
+TEST(GamepadState, ReportsButtonEdgesOnly) {
+  GamepadState state;
+  std::vector<GamepadEdge> edges;
+  state.OnButton(kButtonSouth, 1, 10, &edges);
+  state.OnButton(kButtonSouth, 2, 20, &edges);
+  state.OnButton(kButtonSouth, 1, 30, &edges);
+  state.OnButton(kButtonSouth, 0, 40, &edges);
+  state.OnButton(kButtonSouth, 0, 50, &edges);
+
+  EXPECT_EQ(edges, (std::vector<GamepadEdge>{{kButtonSouth, true, 10},
+                                             {kButtonSouth, false, 40}}));
+  EXPECT_FALSE(state.button_held(kButtonSouth));
+}
+
+TEST(GamepadState, PressesAxisDirectionsWithHysteresis) {
+  GamepadState state;
+  state.SetAxisRange(kAxisX, kStick);
+  std::vector<GamepadEdge> edges;
+  const uint32_t right = GamepadAxisButton(kAxisX, true);
+
+  state.OnAxis(kAxisX, Stick(0.45f), 10, &edges);
+  EXPECT_TRUE(edges.empty());
+  state.OnAxis(kAxisX, Stick(0.55f), 20, &edges);
+  // Between the thresholds the direction stays held.
+  state.OnAxis(kAxisX, Stick(0.4f), 30, &edges);
+  state.OnAxis(kAxisX, Stick(0.52f), 40, &edges);
+  EXPECT_TRUE(state.button_held(right));
+  state.OnAxis(kAxisX, Stick(0.3f), 50, &edges);
+
+  EXPECT_EQ(edges, (std::vector<GamepadEdge>{{right, true, 20},
+                                             {right, false, 50}}));
+  EXPECT_NEAR(state.axis_value(kAxisX), 0.3f, 0.001f);
+}
+
+TEST(GamepadState, ReleasesBeforePressingTheOtherDirection) {
+  GamepadState state;
+  state.SetAxisRange(kAxisHat0X, kHat);
+  std::vector<GamepadEdge> edges;
+
+  state.OnAxis(kAxisHat0X, -1, 10, &edges);
+  state.OnAxis(kAxisHat0X, 1, 20, &edges);
+  state.OnAxis(kAxisHat0X, 0, 30, &edges);
+
+  const uint32_t left = GamepadAxisButton(kAxisHat0X, false);
+  const uint32_t right = GamepadAxisButton(kAxisHat0X, true);
+  EXPECT_EQ(edges, (std::vector<GamepadEdge>{{left, true, 10},
+                                             {left, false, 20},
+                                             {right, true, 20},
+                                             {right, false, 30}}));
+}
+
+TEST(GamepadState, TreatsTriggersAsOneButton) {
+  GamepadState state;
+  state.SetAxisRange(kAxisZ, kTrigger);
+  std::vector<GamepadEdge> edges;
+
+  // Resting at the minimum presses nothing.
+  state.OnAxis(kAxisZ, 0, 10, &edges);
+  state.OnAxis(kAxisZ, 1023, 20, &edges);
+  state.OnAxis(kAxisZ, 0, 30, &edges);
+
+  const uint32_t pulled = GamepadAxisButton(kAxisZ, true);
+  EXPECT_EQ(edges, (std::vector<GamepadEdge>{{pulled, true, 20},
+                                             {pulled, false, 30}}));
+}
+
+TEST(GamepadState, IgnoresUndeclaredAxesAndUnknownCodes) {
+  GamepadState state;
+  std::vector<GamepadEdge> edges;
+
+  state.OnAxis(kAxisX, 32767, 10, &edges);
+  state.OnAxis(kGamepadAxisCount, 32767, 10, &edges);
+  state.OnButton(kGamepadButtonCount, 1, 10, &edges);
+  state.SetAxisRange(kAxisZ, {5, 5, 0, 5});
+  state.OnAxis(kAxisZ, 5, 10, &edges);
+
+  EXPECT_TRUE(edges.empty());
+  EXPECT_EQ(state.axis_value(kAxisX), 0);
+}
+
+TEST(GamepadState, ResetReleasesEverything) {
+  GamepadState state;
+  state.SetAxisRange(kAxisX, kStick);
+  std::vector<GamepadEdge> edges;
+  state.OnButton(kButtonSouth, 1, 10, &edges);
+  state.OnAxis(kAxisX, -32768, 10, &edges);
+  edges.clear();
+
+  state.Reset(99, &edges);
+
+  EXPECT_EQ(edges, (std::vector<GamepadEdge>{
+                       {kButtonSouth, false, 99},
+                       {GamepadAxisButton(kAxisX, false), false, 99}}));
+  EXPECT_EQ(state.axis_value(kAxisX), 0);
+  edges.clear();
+  state.Reset(100, &edges);
+  EXPECT_TRUE(edges.empty());
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
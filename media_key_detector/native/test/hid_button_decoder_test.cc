@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hid_recording.h"
+#include "media_key_detector_core/hid_button_decoder.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kPlayPause = HidUsage(kHidPageConsumer, 0xCD);
+constexpr uint32_t kVolumeUp = HidUsage(kHidPageConsumer, 0xE9);
+constexpr uint32_t kVolumeDown = HidUsage(kHidPageConsumer, 0xEA);
+
+class HidButtonDecoderTest : public ::testing::Test {
+ protected:
+  void Load(const std::string& file) {
+    ASSERT_TRUE(LoadHidRecording(file, &recording_)) << file;
+    std::string error;
+    ASSERT_TRUE(ParseHidReportDescriptor(recording_.descriptor.data(),
+                                         recording_.descriptor.size(),
+                                         &layout_, &error))
+        << error;
+  }
+
+  // The edges of each recorded report.
+  std::vector<std::vector<HidButtonEdge>> Replay(HidButtonDecoder* decoder) {
+    std::vector<std::vector<HidButtonEdge>> edges;
+    for (const HidRecording::Report& report : recording_.reports) {
+      edges.emplace_back();
+      decoder->Decode(report.data.data(), report.data.size(), &edges.back());
+    }
+    return edges;
+  }
+
+  HidRecording recording_;
+  HidReportLayout layout_;
+};
+
+}  // namespace
+
+TEST_F(HidButtonDecoderTest, ReportsConsumerBitsAndIgnoresTheKeyboard) {
+  Load("consumer_remote.hid");
+  HidButtonDecoder decoder(layout_);
+
+  EXPECT_TRUE(decoder.has_buttons());
+  EXPECT_EQ(Replay(&decoder),
+            (std::vector<std::vector<HidButtonEdge>>{
+                {},
+                {},
+                {{kPlayPause, true}},
+                {{kPlayPause, false}},
+                {{kVolumeUp, true}},
+                {{kVolumeDown, true}},
+                {{kVolumeUp, false}, {kVolumeDown, false}},
+            }));
+}
+
+TEST_F(HidButtonDecoderTest, ReportsArrayValues) {
+  Load("consumer_array.hid");
+  HidButtonDecoder decoder(layout_);
+
+  // Switching from one value to another releases the first.
+  EXPECT_EQ(Replay(&decoder), (std::vector<std::vector<HidButtonEdge>>{
+                                  {{kPlayPause, true}},
+                                  {{kPlayPause, false}},
+                                  {{kVolumeUp, true}},
+                                  {{kVolumeUp, false}, {kVolumeDown, true}},
+                                  {{kVolumeDown, false}},
+                              }));
+}
+
+TEST_F(HidButtonDecoderTest, ReportsGamepadButtonsButNotAxes) {
+  Load("gamepad.hid");
+  HidButtonDecoder decoder(layout_);
+
+  EXPECT_EQ(Replay(&decoder),
+            (std::vector<std::vector<HidButtonEdge>>{
+                {{HidUsage(kHidPageButton, 1), true}},
+                {},
+                {{HidUsage(kHidPageButton, 2), true},
+                 {HidUsage(kHidPageButton, 13), true}},
+                {{HidUsage(kHidPageButton, 1), false},
+                 {HidUsage(kHidPageButton, 2), false},
+                 {HidUsage(kHidPageButton, 13), false}},
+            }));
+}
+
+TEST_F(HidButtonDecoderTest, LeavesMouseButtonsToTheDesktop) {
+  Load("mouse.hid");
+  HidButtonDecoder decoder(layout_);
+
+  EXPECT_FALSE(decoder.has_buttons());
+  for (const auto& edges : Replay(&decoder)) {
+    EXPECT_TRUE(edges.empty());
+  }
+}
+
+TEST_F(HidButtonDecoderTest, IgnoresShortAndUnknownReports) {
+  Load("consumer_remote.hid");
+  HidButtonDecoder decoder(layout_);
+  std::vector<HidButtonEdge> edges;
+
+  const uint8_t short_report[] = {0x02};
+  decoder.Decode(short_report, sizeof(short_report), &edges);
+  const uint8_t unknown_report[] = {0x07, 0xFF};
+  decoder.Decode(unknown_report, sizeof(unknown_report), &edges);
+  decoder.Decode(nullptr, 0, &edges);
+
+  EXPECT_TRUE(edges.empty());
+}
+
+TEST_F(HidButtonDecoderTest, ResetReleasesHeldButtons) {
+  Load("consumer_remote.hid");
+  HidButtonDecoder decoder(layout_);
+  std::vector<HidButtonEdge> edges;
+  const uint8_t report[] = {0x02, 0x09};
+  decoder.Decode(report, sizeof(report), &edges);
+  edges.clear();
+
+  decoder.Reset(&edges);
+
+  EXPECT_EQ(edges, (std::vector<HidButtonEdge>{{kPlayPause, false},
+                                               {kVolumeUp, false}}));
+  // The next report presses them again.
+  edges.clear();
+  decoder.Decode(report, sizeof(report), &edges);
+  EXPECT_EQ(edges.size(), 2u);
+}
+
+TEST_F(HidButtonDecoderTest, DoesNotAllocatePerReport) {
+  Load("consumer_array.hid");
+  HidButtonDecoder decoder(layout_);
+  std::vector<HidButtonEdge> edges;
+  edges.reserve(8);
+  const HidButtonEdge* storage = edges.data();
+
+  for (int i = 0; i < 100; i++) {
+    edges.clear();
+    for (const HidRecording::Report& report : recording_.reports) {
+      decoder.Decode(report.data.data(), report.data.size(), &edges);
+    }
+  }
+
+  EXPECT_EQ(edges.data(), storage);
+  EXPECT_EQ(edges.size(), 6u);
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
@@ -0,0 +1,110 @@
+#ifndef MEDIA_KEY_DETECTOR_CORE_TEST_HID_RECORDING_H_
+#define MEDIA_KEY_DETECTOR_CORE_TEST_HID_RECORDING_H_
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace media_key_detector_core {
+namespace test {
+
+// A device recorded in the text format of hid-tools' hid-recorder:
+//
+//   N: <name>
+//   I: <bus> <vendor> <product>
+//   R: <length> <descriptor bytes in hex>
+//   E: <seconds>.<microseconds> <length> <report bytes in hex>
+//
+// Lines starting with '#' are comments.
+struct HidRecording {
+  struct Report {
+    int64_t timestamp_us;
+    std::vector<uint8_t> data;
+  };
+
+  std::string name;
+  uint16_t vendor_id = 0;
+  uint16_t product_id = 0;
+  std::vector<uint8_t> descriptor;
+  std::vector<Report> reports;
+};
+
+namespace internal {
+
+inline bool ReadHexBytes(std::istringstream* line, std::vector<uint8_t>* out) {
+  size_t length;
+  if (!(*line >> std::dec >> length)) {
+    return false;
+  }
+  out->clear();
+  unsigned int byte;
+  while (*line >> std::hex >> byte) {
+    out->push_back(static_cast<uint8_t>(byte));
+  }
+  return out->size() == length;
+}
+
+}  // namespace internal
+
+// Loads |file| from the test data directory. Returns false if it cannot be
+// read or is malformed.
+inline bool LoadHidRecording(const std::string& file,
+                             HidRecording* recording) {
+  std::ifstream input(std::string(TEST_DATA_DIR) + "/" + file);
+  if (!input) {
+    return false;
+  }
+  *recording = HidRecording();
+  std::string text;
+  while (std::getline(input, text)) {
+    if (text.size() < 3 || text[0] == '#') {
+      continue;
+    }
+    std::istringstream line(text.substr(3));
+    switch (text[0]) {
+      case 'N':
+        recording->name = text.substr(3);
+        break;
+      case 'I': {
+        unsigned int bus, vendor, product;
+        if (!(line >> std::hex >> bus >> vendor >> product)) {
+          return false;
+        }
+        recording->vendor_id = static_cast<uint16_t>(vendor);
+        recording->product_id = static_cast<uint16_t>(product);
+        break;
+      }
+      case 'R':
+        if (!internal::ReadHexBytes(&line, &recording->descriptor)) {
+          return false;
+        }
+        break;
+      case 'E': {
+        int64_t seconds;
+        char dot;
+        std::string microseconds;
+        if (!(line >> seconds >> dot) || dot != '.' ||
+            !std::getline(line, microseconds, ' ')) {
+          return false;
+        }
+        HidRecording::Report report;
+        report.timestamp_us = seconds * 1000000 + std::stoll(microseconds);
+        if (!internal::ReadHexBytes(&line, &report.data)) {
+          return false;
+        }
+        recording->reports.push_back(std::move(report));
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return !recording->descriptor.empty();
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
+
+#endif  // MEDIA_KEY_DETECTOR_CORE_TEST_HID_RECORDING_H_
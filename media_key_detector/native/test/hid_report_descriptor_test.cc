@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hid_recording.h"
+#include "media_key_detector_core/hid_report_descriptor.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kPlayPause = HidUsage(kHidPageConsumer, 0xCD);
+
+HidReportLayout ParseRecording(const std::string& file) {
+  HidRecording recording;
+  EXPECT_TRUE(LoadHidRecording(file, &recording)) << file;
+  HidReportLayout layout;
+  std::string error;
+  EXPECT_TRUE(ParseHidReportDescriptor(recording.descriptor.data(),
+                                       recording.descriptor.size(), &layout,
+                                       &error))
+      << error;
+  return layout;
+}
+
+bool Parse(const std::vector<uint8_t>& descriptor, std::string* error) {
+  HidReportLayout layout;
+  return ParseHidReportDescriptor(descriptor.data(), descriptor.size(),
+                                  &layout, error);
+}
+
+const HidField* FindField(const HidReportLayout& layout, uint32_t usage) {
+  for (const HidField& field : layout.fields) {
+    if (field.usage == usage) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(HidReportDescriptor, LaysOutReportsWithIds) {
+  HidReportLayout layout = ParseRecording("consumer_remote.hid");
+
+  EXPECT_TRUE(layout.uses_report_ids);
+  EXPECT_EQ(layout.report_sizes, (std::vector<uint16_t>{0, 9, 2}));
+  EXPECT_EQ(layout.applications,
+            (std::vector<uint32_t>{HidUsage(kHidPageGenericDesktop, 0x06),
+                                   HidUsage(kHidPageConsumer, 0x01)}));
+
+  // The consumer keys follow the report ID byte, one bit each.
+  const HidField* play_pause = FindField(layout, kPlayPause);
+  ASSERT_NE(play_pause, nullptr);
+  EXPECT_TRUE(play_pause->variable());
+  EXPECT_EQ(play_pause->report_id, 2);
+  EXPECT_EQ(play_pause->bit_offset, 8);
+  EXPECT_EQ(play_pause->bit_size, 1);
+  EXPECT_EQ(play_pause->application, HidUsage(kHidPageConsumer, 0x01));
+  const HidField* volume_down =
+      FindField(layout, HidUsage(kHidPageConsumer, 0xEA));
+  ASSERT_NE(volume_down, nullptr);
+  EXPECT_EQ(volume_down->bit_offset, 12);
+}
+
+TEST(HidReportDescriptor, KeepsArraysAsOneField) {
+  HidReportLayout layout = ParseRecording("consumer_array.hid");
+
+  EXPECT_FALSE(layout.uses_report_ids);
+  EXPECT_EQ(layout.report_sizes, (std::vector<uint16_t>{2}));
+  ASSERT_EQ(layout.fields.size(), 1u);
+  const HidField& field = layout.fields[0];
+  EXPECT_FALSE(field.variable());
+  EXPECT_EQ(field.usage, HidUsage(kHidPageConsumer, 0));
+  EXPECT_EQ(field.usage_max, HidUsage(kHidPageConsumer, 0x3FF));
+  EXPECT_EQ(field.usage_list, HidField::kNoUsageList);
+  EXPECT_EQ(field.logical_max, 0x3FF);
+  EXPECT_EQ(field.bit_size, 16);
+  EXPECT_EQ(field.count, 1);
+}
+
+TEST(HidReportDescriptor, SkipsPaddingAndAssignsUsageRanges) {
+  HidReportLayout layout = ParseRecording("gamepad.hid");
+
+  EXPECT_EQ(layout.report_sizes, (std::vector<uint16_t>{7}));
+  // 13 buttons, the hat switch and 4 axes.
+  EXPECT_EQ(layout.fields.size(), 18u);
+  const HidField* button_13 = FindField(layout, HidUsage(kHidPageButton, 13));
+  ASSERT_NE(button_13, nullptr);
+  EXPECT_EQ(button_13->bit_offset, 12);
+  const HidField* hat =
+      FindField(layout, HidUsage(kHidPageGenericDesktop, 0x39));
+  ASSERT_NE(hat, nullptr);
+  EXPECT_EQ(hat->bit_offset, 16);
+  EXPECT_EQ(hat->bit_size, 4);
+  EXPECT_EQ(hat->logical_max, 7);
+  const HidField* rz =
+      FindField(layout, HidUsage(kHidPageGenericDesktop, 0x35));
+  ASSERT_NE(rz, nullptr);
+  EXPECT_EQ(rz->bit_offset, 48);
+  EXPECT_EQ(rz->logical_max, 255);
+}
+
+TEST(HidReportDescriptor, ReadsSignedValues) {
+  HidRecording recording;
+  ASSERT_TRUE(LoadHidRecording("mouse.hid", &recording));
+  HidReportLayout layout = ParseRecording("mouse.hid");
+
+  const HidField* x = FindField(layout, HidUsage(kHidPageGenericDesktop, 0x30));
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->logical_min, -127);
+  EXPECT_EQ(x->logical_max, 127);
+  const std::vector<uint8_t>& report = recording.reports[0].data;
+  int32_t value;
+  ASSERT_TRUE(ReadHidFieldValue(*x, 0, report.data(), report.size(), &value));
+  EXPECT_EQ(value, -1);
+  const HidField* y = FindField(layout, HidUsage(kHidPageGenericDesktop, 0x31));
+  ASSERT_TRUE(ReadHidFieldValue(*y, 0, report.data(), report.size(), &value));
+  EXPECT_EQ(value, 2);
+}
+
+TEST(HidReportDescriptor, ReadsValuesAcrossByteBoundaries) {
+  HidField field = {};
+  field.bit_offset = 4;
+  field.bit_size = 12;
+  field.count = 2;
+  const uint8_t report[] = {0xBA, 0xDC, 0x1E, 0x32};
+
+  int32_t value;
+  ASSERT_TRUE(ReadHidFieldValue(field, 0, report, sizeof(report), &value));
+  EXPECT_EQ(value, 0xDCB);
+  ASSERT_TRUE(ReadHidFieldValue(field, 1, report, sizeof(report), &value));
+  EXPECT_EQ(value, 0x21E);
+  EXPECT_FALSE(ReadHidFieldValue(field, 1, report, 3, &value));
+}
+
+TEST(HidReportDescriptor, RestoresGlobalsOnPop) {
+  // Push, switch to the button page for one field, pop back to consumer.
+  std::vector<uint8_t> descriptor = {
+      0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x15, 0x00, 0x25, 0x01,
+      0x75, 0x01, 0x95, 0x01, 0xA4, 0x05, 0x09, 0x09, 0x01, 0x81,
+      0x02, 0xB4, 0x09, 0xCD, 0x81, 0x02, 0xC0};
+  HidReportLayout layout;
+  std::string error;
+  ASSERT_TRUE(ParseHidReportDescriptor(descriptor.data(), descriptor.size(),
+                                       &layout, &error))
+      << error;
+
+  ASSERT_EQ(layout.fields.size(), 2u);
+  EXPECT_EQ(layout.fields[0].usage, HidUsage(kHidPageButton, 1));
+  EXPECT_EQ(layout.fields[1].usage, kPlayPause);
+  EXPECT_EQ(layout.fields[1].bit_offset, 1);
+}
+
+TEST(HidReportDescriptor, SkipsOutputReportsAndLongItems) {
+  std::vector<uint8_t> descriptor = {
+      0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x15, 0x00, 0x25, 0x01, 0x75,
+      0x01, 0x95, 0x08, 0x91, 0x02,  // Output report.
+      0xFE, 0x02, 0x10, 0xAA, 0xBB,  // Long item.
+      0x09, 0xCD, 0x95, 0x01, 0x81, 0x02, 0xC0};
+  HidReportLayout layout;
+  std::string error;
+  ASSERT_TRUE(ParseHidReportDescriptor(descriptor.data(), descriptor.size(),
+                                       &layout, &error))
+      << error;
+
+  ASSERT_EQ(layout.fields.size(), 1u);
+  EXPECT_EQ(layout.fields[0].usage, kPlayPause);
+  EXPECT_EQ(layout.fields[0].bit_offset, 0);
+}
+
+TEST(HidReportDescriptor, RejectsMalformedDescriptors) {
+  std::string error;
+  // Truncated item.
+  EXPECT_FALSE(Parse({0x05, 0x0C, 0x26, 0xFF}, &error));
+  EXPECT_EQ(error, "truncated item");
+  // Collection that is never closed.
+  EXPECT_FALSE(Parse({0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01}, &error));
+  EXPECT_EQ(error, "unterminated collection");
+  EXPECT_FALSE(Parse({0xC0}, &error));
+  EXPECT_FALSE(Parse({0xB4}, &error));
+  EXPECT_EQ(error, "pop without push");
+  // 4096 values of 32 bits are more than 8 KiB.
+  EXPECT_FALSE(Parse({0x75, 0x20, 0x96, 0x00, 0x10, 0x81, 0x02}, &error));
+  EXPECT_EQ(error, "report too long");
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
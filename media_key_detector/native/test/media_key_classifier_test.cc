@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "media_key_detector_core/media_key_classifier.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr MediaKeyAction kDown = MediaKeyAction::kDown;
+constexpr MediaKeyAction kUp = MediaKeyAction::kUp;
+constexpr MediaKeyAction kLongPress = MediaKeyAction::kLongPress;
+
+MediaKeyClassifier::Options TestOptions() {
+  MediaKeyClassifier::Options options;
+  options.debounce_ms = 30;
+  options.long_press_ms = 500;
+  return options;
+}
+
+}  // namespace
+
+TEST(MediaKeyClassifier, ShortPressReportsDownAtOnceAndUpAfterDebounce) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyPlayPause, true, 1000, &gestures);
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, 1000}}));
+
+  gestures.clear();
+  classifier.OnKey(kMediaKeyPlayPause, false, 1100, &gestures);
+  EXPECT_TRUE(gestures.empty());
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(1100), 30u);
+
+  classifier.Advance(1129, &gestures);
+  EXPECT_TRUE(gestures.empty());
+  classifier.Advance(1130, &gestures);
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kUp, 1100}}));
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(1130), std::nullopt);
+}
+
+TEST(MediaKeyClassifier, DropsAutorepeatedDowns) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyVolumeUp, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyVolumeUp, true, 250, &gestures);
+  classifier.OnKey(kMediaKeyVolumeUp, true, 283, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyVolumeUp, kDown, 0}}));
+}
+
+TEST(MediaKeyClassifier, BounceWithinDebounceContinuesThePress) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyFastForward, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyFastForward, false, 5, &gestures);
+  classifier.OnKey(kMediaKeyFastForward, true, 12, &gestures);
+  classifier.OnKey(kMediaKeyFastForward, false, 100, &gestures);
+  classifier.Advance(200, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyFastForward, kDown, 0},
+                          {kMediaKeyFastForward, kUp, 100}}));
+}
+
+TEST(MediaKeyClassifier, PressAfterDebounceIsASecondPress) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyRewind, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyRewind, false, 50, &gestures);
+  // The release is emitted before the new press, without an Advance().
+  classifier.OnKey(kMediaKeyRewind, true, 80, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyRewind, kDown, 0},
+                          {kMediaKeyRewind, kUp, 50},
+                          {kMediaKeyRewind, kDown, 80}}));
+}
+
+TEST(MediaKeyClassifier, LongPressFiresWhileHeld) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyPlayPause, true, 1000, &gestures);
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(1200), 300u);
+  classifier.Advance(1499, &gestures);
+  EXPECT_EQ(gestures.size(), 1u);
+
+  classifier.Advance(1510, &gestures);
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(1510), std::nullopt);
+  classifier.OnKey(kMediaKeyPlayPause, false, 2000, &gestures);
+  classifier.Advance(2030, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, 1000},
+                          {kMediaKeyPlayPause, kLongPress, 1500},
+                          {kMediaKeyPlayPause, kUp, 2000}}));
+}
+
+TEST(MediaKeyClassifier, OverdueLongPressComesBeforeTheRelease) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  // Without any Advance() in between, e.g. when the thread was late.
+  classifier.OnKey(kMediaKeyPlayPause, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyPlayPause, false, 700, &gestures);
+  classifier.Advance(730, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, 0},
+                          {kMediaKeyPlayPause, kLongPress, 500},
+                          {kMediaKeyPlayPause, kUp, 700}}));
+}
+
+TEST(MediaKeyClassifier, EmitsDueGesturesOfSeveralKeysInTimeOrder) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyPlayPause, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyVolumeDown, true, 100, &gestures);
+  classifier.OnKey(kMediaKeyVolumeDown, false, 150, &gestures);
+  gestures.clear();
+  classifier.Advance(1000, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyVolumeDown, kUp, 150},
+                          {kMediaKeyPlayPause, kLongPress, 500}}));
+}
+
+TEST(MediaKeyClassifier, NextDeadlineIsTheEarliestOfAllKeys) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyRewind, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyFastForward, true, 100, &gestures);
+  classifier.OnKey(kMediaKeyFastForward, false, 150, &gestures);
+
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(160), 20u);
+  // Overdue deadlines are due now.
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(190), 0u);
+}
+
+TEST(MediaKeyClassifier, IgnoresUpsOfKeysThatAreNotHeld) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyVolumeUp, false, 0, &gestures);
+  classifier.Advance(100, &gestures);
+
+  EXPECT_TRUE(gestures.empty());
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(100), std::nullopt);
+}
+
+TEST(MediaKeyClassifier, IgnoresKeysOutOfRange) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(-1, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyCount, true, 0, &gestures);
+
+  EXPECT_TRUE(gestures.empty());
+}
+
+TEST(MediaKeyClassifier, WithoutDebounceReleasesAtOnce) {
+  MediaKeyClassifier::Options options = TestOptions();
+  options.debounce_ms = 0;
+  MediaKeyClassifier classifier(options);
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyPlayPause, true, 0, &gestures);
+  classifier.OnKey(kMediaKeyPlayPause, false, 40, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, 0},
+                          {kMediaKeyPlayPause, kUp, 40}}));
+}
+
+TEST(MediaKeyClassifier, HandlesTheWrapOfTheClock) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  const uint32_t start = UINT32_MAX - 200;
+  classifier.OnKey(kMediaKeyPlayPause, true, start, &gestures);
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(start + 100), 400u);
+  classifier.Advance(start + 500, &gestures);
+  classifier.OnKey(kMediaKeyPlayPause, false, start + 600, &gestures);
+  classifier.Advance(start + 630, &gestures);
+
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, start},
+                          {kMediaKeyPlayPause, kLongPress, start + 500},
+                          {kMediaKeyPlayPause, kUp, start + 600}}));
+}
+
+TEST(MediaKeyClassifier, ResetForgetsHeldKeys) {
+  MediaKeyClassifier classifier(TestOptions());
+  std::vector<MediaKeyGesture> gestures;
+
+  classifier.OnKey(kMediaKeyPlayPause, true, 0, &gestures);
+  classifier.Reset();
+  EXPECT_EQ(classifier.TimeUntilNextDeadline(0), std::nullopt);
+
+  gestures.clear();
+  classifier.OnKey(kMediaKeyPlayPause, true, 10, &gestures);
+  EXPECT_EQ(gestures, (std::vector<MediaKeyGesture>{
+                          {kMediaKeyPlayPause, kDown, 10}}));
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
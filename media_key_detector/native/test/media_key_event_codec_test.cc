@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "media_key_detector_core/media_key_event_codec.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+MediaKeyRecord Record(MediaKeyIndex key,
+                      MediaKeyAction action,
+                      int64_t timestamp_us) {
+  return {key, action, MediaKeySource::kEvdev, 3, timestamp_us};
+}
+
+}  // namespace
+
+TEST(MediaKeyEventCodec, EncodesTheDocumentedLayout) {
+  std::vector<uint8_t> batch;
+  ASSERT_TRUE(EncodeMediaKeyBatch(
+      {{kMediaKeyFastForward, MediaKeyAction::kUp, MediaKeySource::kEvdev,
+        0x0102, 0x0A0B0C0D0E0F1011}},
+      &batch));
+
+  EXPECT_EQ(batch, (std::vector<uint8_t>{
+                       // Header.
+                       1, 16, 1, 0,
+                       // Timestamp.
+                       0x11, 0x10, 0x0F, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A,
+                       // Device, key, action, source and padding.
+                       0x02, 0x01, 2, 1, 4, 0, 0, 0}));
+}
+
+TEST(MediaKeyEventCodec, RoundTripsRecords) {
+  std::vector<MediaKeyRecord> records = {
+      Record(kMediaKeyPlayPause, MediaKeyAction::kDown, 1000000),
+      Record(kMediaKeyPlayPause, MediaKeyAction::kLongPress, 1500000),
+      {kMediaKeyVolumeDown, MediaKeyAction::kPress, MediaKeySource::kHotkey, 0,
+       -5},
+  };
+  std::vector<uint8_t> batch;
+  ASSERT_TRUE(EncodeMediaKeyBatch(records, &batch));
+  EXPECT_EQ(batch.size(),
+            kMediaKeyBatchHeaderSize + records.size() * kMediaKeyRecordSize);
+
+  std::vector<MediaKeyRecord> decoded;
+  ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+  EXPECT_EQ(decoded, records);
+}
+
+TEST(MediaKeyEventCodec, EncodesEmptyBatches) {
+  std::vector<uint8_t> batch = {42};
+  ASSERT_TRUE(EncodeMediaKeyBatch({}, &batch));
+  EXPECT_EQ(batch, (std::vector<uint8_t>{1, 16, 0, 0}));
+}
+
+TEST(MediaKeyEventCodec, RejectsTooManyRecords) {
+  std::vector<MediaKeyRecord> records(
+      kMaxMediaKeyBatchRecords + 1,
+      Record(kMediaKeyRewind, MediaKeyAction::kDown, 0));
+  std::vector<uint8_t> batch;
+  EXPECT_FALSE(EncodeMediaKeyBatch(records, &batch));
+}
+
+TEST(MediaKeyEventCodec, RejectsMalformedBatches) {
+  std::vector<uint8_t> batch;
+  ASSERT_TRUE(EncodeMediaKeyBatch(
+      {Record(kMediaKeyRewind, MediaKeyAction::kDown, 7)}, &batch));
+  std::vector<MediaKeyRecord> decoded;
+
+  EXPECT_FALSE(DecodeMediaKeyBatch(batch.data(), 3, &decoded));
+  EXPECT_FALSE(DecodeMediaKeyBatch(batch.data(), batch.size() - 1, &decoded));
+  std::vector<uint8_t> future_version = batch;
+  future_version[0] = 2;
+  EXPECT_FALSE(DecodeMediaKeyBatch(future_version.data(),
+                                   future_version.size(), &decoded));
+  std::vector<uint8_t> short_records = batch;
+  short_records[1] = 8;
+  EXPECT_FALSE(DecodeMediaKeyBatch(short_records.data(), short_records.size(),
+                                   &decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(MediaKeyEventCodec, SkipsFieldsOfLongerRecordsAndUnknownKeys) {
+  // Records of 20 bytes, as a later version could send.
+  std::vector<uint8_t> batch = {1, 20, 2, 0};
+  std::vector<uint8_t> first = {5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 0, 4,
+                                0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF};
+  std::vector<uint8_t> second = {6, 0, 0, 0, 0, 0, 0, 0, 1, 0, 3, 1, 4,
+                                 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF};
+  batch.insert(batch.end(), first.begin(), first.end());
+  batch.insert(batch.end(), second.begin(), second.end());
+
+  std::vector<MediaKeyRecord> decoded;
+  ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+  EXPECT_EQ(decoded, (std::vector<MediaKeyRecord>{
+                         {kMediaKeyVolumeUp, MediaKeyAction::kUp,
+                          MediaKeySource::kEvdev, 1, 6}}));
+}
+
+TEST(MediaKeyBatcher, OnlyTheFirstRecordOfABatchSchedulesATake) {
+  MediaKeyBatcher batcher;
+  EXPECT_TRUE(
+      batcher.Add(Record(kMediaKeyPlayPause, MediaKeyAction::kDown, 1)));
+  EXPECT_FALSE(
+      batcher.Add(Record(kMediaKeyPlayPause, MediaKeyAction::kUp, 2)));
+
+  std::vector<uint8_t> batch;
+  ASSERT_TRUE(batcher.Take(&batch));
+  std::vector<MediaKeyRecord> decoded;
+  ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+  EXPECT_EQ(decoded, (std::vector<MediaKeyRecord>{
+                         Record(kMediaKeyPlayPause, MediaKeyAction::kDown, 1),
+                         Record(kMediaKeyPlayPause, MediaKeyAction::kUp, 2)}));
+
+  EXPECT_FALSE(batcher.Take(&batch));
+  EXPECT_TRUE(
+      batcher.Add(Record(kMediaKeyPlayPause, MediaKeyAction::kDown, 3)));
+}
+
+TEST(MediaKeyBatcher, DropsRecordsBeyondTheBatchLimit) {
+  MediaKeyBatcher batcher;
+  for (size_t i = 0; i < kMaxMediaKeyBatchRecords + 10; i++) {
+    batcher.Add(Record(kMediaKeyRewind, MediaKeyAction::kPress, i));
+  }
+
+  std::vector<uint8_t> batch;
+  ASSERT_TRUE(batcher.Take(&batch));
+  std::vector<MediaKeyRecord> decoded;
+  ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+  EXPECT_EQ(decoded.size(), kMaxMediaKeyBatchRecords);
+}
+
+TEST(MediaKeyBatcher, CollectsFromSeveralThreads) {
+  MediaKeyBatcher batcher;
+  constexpr int kPerThread = 1000;
+  std::vector<uint8_t> batch;
+  std::vector<MediaKeyRecord> decoded;
+
+  std::thread producer([&] {
+    for (int i = 0; i < kPerThread; i++) {
+      batcher.Add(Record(kMediaKeyVolumeUp, MediaKeyAction::kPress, i));
+    }
+  });
+  for (int i = 0; i < kPerThread; i++) {
+    batcher.Add(Record(kMediaKeyVolumeDown, MediaKeyAction::kPress, i));
+    if (i % 100 == 0 && batcher.Take(&batch)) {
+      ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+    }
+  }
+  producer.join();
+  if (batcher.Take(&batch)) {
+    ASSERT_TRUE(DecodeMediaKeyBatch(batch.data(), batch.size(), &decoded));
+  }
+
+  // Every record arrives once, in the order of its thread.
+  ASSERT_EQ(decoded.size(), 2u * kPerThread);
+  int64_t next[kMediaKeyCount] = {};
+  for (const MediaKeyRecord& record : decoded) {
+    EXPECT_EQ(record.timestamp_us, next[record.key]++);
+  }
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "media_key_detector_core/ffi_bridge.h"
+#include "media_key_detector_core/media_key_detector_ffi.h"
+#include "media_key_detector_core/tap_classifier.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kAxs = 1;
+constexpr uint32_t kOtherAxs = 2;
+
+// The default double tap window of the app.
+constexpr int64_t kWindowUs = 300000;
+
+// Loads the tap arrival times of |file| in the test data directory, in the
+// format described in sram_axs_taps.trace.
+std::vector<int64_t> LoadTrace(const std::string& file) {
+  std::ifstream input(std::string(TEST_DATA_DIR) + "/" + file);
+  std::vector<int64_t> taps;
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.rfind("T: ", 0) != 0) {
+      continue;
+    }
+    size_t dot = line.find('.');
+    taps.push_back(std::stoll(line.substr(3, dot - 3)) * 1000000 +
+                   std::stoll(line.substr(dot + 1)));
+  }
+  return taps;
+}
+
+// Replays |taps| on |device|, then runs the clock out.
+std::vector<TapGesture> Replay(TapClassifier* classifier,
+                               uint32_t device,
+                               const std::vector<int64_t>& taps) {
+  std::vector<TapGesture> gestures;
+  for (int64_t tap : taps) {
+    classifier->OnTap(device, tap, &gestures);
+  }
+  classifier->Advance(INT64_MAX, &gestures);
+  return gestures;
+}
+
+TapClassifier::Options Window(int max_taps, bool optimistic = false) {
+  return {kWindowUs, max_taps, optimistic};
+}
+
+// Collects the gestures a TapClassifierWorker emits on its thread.
+class GestureSink {
+ public:
+  void Add(const std::vector<TapGesture>& gestures) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gestures_.insert(gestures_.end(), gestures.begin(), gestures.end());
+    added_.notify_all();
+  }
+
+  std::vector<TapGesture> WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    added_.wait_for(lock, std::chrono::seconds(5),
+                    [&] { return gestures_.size() >= count; });
+    return gestures_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable added_;
+  std::vector<TapGesture> gestures_;
+};
+
+}  // namespace
+
+TEST(TapClassifier, ClassifiesTheTraceIntoSingleAndDoubleTaps) {
+  TapClassifier classifier(Window(2));
+  EXPECT_EQ(Replay(&classifier, kAxs, LoadTrace("sram_axs_taps.trace")),
+            (std::vector<TapGesture>{{kAxs, 1, 1000000},
+                                     {kAxs, 2, 2092413},
+                                     {kAxs, 2, 3281544},
+                                     {kAxs, 1, 4000000},
+                                     {kAxs, 1, 4450120},
+                                     // A third tap starts over.
+                                     {kAxs, 2, 6101337},
+                                     {kAxs, 1, 6211902}}));
+}
+
+TEST(TapClassifier, ClassifiesTheTraceIntoTripleTaps) {
+  TapClassifier classifier(Window(3));
+  EXPECT_EQ(Replay(&classifier, kAxs, LoadTrace("sram_axs_taps.trace")),
+            (std::vector<TapGesture>{{kAxs, 1, 1000000},
+                                     {kAxs, 2, 2092413},
+                                     {kAxs, 2, 3281544},
+                                     {kAxs, 1, 4000000},
+                                     {kAxs, 1, 4450120},
+                                     {kAxs, 3, 6211902}}));
+}
+
+TEST(TapClassifier, OptimisticModeReportsTheFirstTapAtOnce) {
+  TapClassifier classifier(Window(2, true));
+  std::vector<TapGesture> gestures;
+  classifier.OnTap(kAxs, 1000000, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kAxs, 1, 1000000}}));
+  EXPECT_EQ(classifier.NextDeadline(), 1000000 + kWindowUs);
+  classifier.Reset();
+
+  EXPECT_EQ(Replay(&classifier, kAxs, LoadTrace("sram_axs_taps.trace")),
+            (std::vector<TapGesture>{{kAxs, 1, 1000000},
+                                     {kAxs, 1, 2000000},
+                                     {kAxs, 2, 2092413},
+                                     {kAxs, 1, 3000000},
+                                     {kAxs, 2, 3281544},
+                                     {kAxs, 1, 4000000},
+                                     {kAxs, 1, 4450120},
+                                     {kAxs, 1, 6000000},
+                                     {kAxs, 2, 6101337},
+                                     {kAxs, 1, 6211902}}));
+}
+
+TEST(TapClassifier, ResolvesWhenTheLastTapIsAWindowOld) {
+  TapClassifier classifier(Window(2));
+  std::vector<TapGesture> gestures;
+  classifier.OnTap(kAxs, 0, &gestures);
+  EXPECT_EQ(classifier.NextDeadline(), kWindowUs);
+  classifier.Advance(kWindowUs - 1, &gestures);
+  EXPECT_TRUE(gestures.empty());
+  classifier.Advance(kWindowUs, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kAxs, 1, 0}}));
+  EXPECT_EQ(classifier.NextDeadline(), std::nullopt);
+
+  // A tap exactly a window after the last one starts a new gesture.
+  gestures.clear();
+  classifier.OnTap(kAxs, 1000000, &gestures);
+  classifier.OnTap(kAxs, 1000000 + kWindowUs, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kAxs, 1, 1000000}}));
+}
+
+TEST(TapClassifier, DelayedProcessingKeepsTheArrivalTimes) {
+  // Both taps are handed over after the window has passed, but arrived
+  // within it.
+  TapClassifier classifier(Window(2));
+  std::vector<TapGesture> gestures;
+  classifier.OnTap(kAxs, 2000000, &gestures);
+  classifier.OnTap(kAxs, 2092413, &gestures);
+  classifier.Advance(5000000, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kAxs, 2, 2092413}}));
+}
+
+TEST(TapClassifier, KeepsDevicesAndTheirWindowsApart) {
+  TapClassifier classifier(Window(2));
+  classifier.SetDeviceOptions(kOtherAxs, {150000, 2, false});
+  std::vector<TapGesture> gestures;
+  classifier.OnTap(kAxs, 0, &gestures);
+  classifier.OnTap(kOtherAxs, 10000, &gestures);
+  classifier.OnTap(kOtherAxs, 200000, &gestures);
+  classifier.OnTap(kAxs, 250000, &gestures);
+  classifier.Advance(1000000, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kOtherAxs, 1, 10000},
+                                               {kAxs, 2, 250000},
+                                               {kOtherAxs, 1, 200000}}));
+}
+
+TEST(TapClassifier, RemovingADeviceDropsItsPendingTaps) {
+  TapClassifier classifier(Window(2));
+  classifier.SetDeviceOptions(kAxs, {100000, 3, false});
+  std::vector<TapGesture> gestures;
+  classifier.OnTap(kAxs, 0, &gestures);
+  classifier.RemoveDevice(kAxs);
+  EXPECT_EQ(classifier.NextDeadline(), std::nullopt);
+
+  // And its options.
+  classifier.OnTap(kAxs, 1000000, &gestures);
+  classifier.OnTap(kAxs, 1200000, &gestures);
+  EXPECT_EQ(gestures, (std::vector<TapGesture>{{kAxs, 2, 1200000}}));
+}
+
+TEST(TapClassifierWorker, ResolvesSingleTapsOnItsThread) {
+  GestureSink sink;
+  TapClassifierWorker worker(
+      [&](const std::vector<TapGesture>& gestures) { sink.Add(gestures); },
+      {20000, 2, false});
+  int64_t start = TapClassifierWorker::NowUs();
+  std::vector<TapGesture> gestures;
+  worker.OnTap(kAxs, start, &gestures);
+  EXPECT_TRUE(gestures.empty());
+
+  EXPECT_EQ(sink.WaitFor(1), (std::vector<TapGesture>{{kAxs, 1, start}}));
+  // Not before it was due.
+  EXPECT_GE(TapClassifierWorker::NowUs(), start + 20000);
+}
+
+TEST(TapClassifierWorker, IsReachableThroughTheCAbi) {
+  int64_t out[4 * 3] = {};
+  EXPECT_EQ(mkd_tap(kAxs, 0, out, 4), MKD_ERROR_UNAVAILABLE);
+
+  GestureSink sink;
+  TapClassifierWorker worker(
+      [&](const std::vector<TapGesture>& gestures) { sink.Add(gestures); });
+  InstallTapClassifierWorker(&worker);
+  EXPECT_EQ(mkd_tap_options(kAxs, kWindowUs, 0, 0),
+            MKD_ERROR_INVALID_ARGUMENT);
+  ASSERT_EQ(mkd_tap_options(kAxs, kWindowUs, 2, 1), MKD_OK);
+
+  // On the worker's clock, so that the window does not run out on the
+  // worker thread before the second tap.
+  int64_t now = TapClassifierWorker::NowUs();
+  ASSERT_EQ(mkd_tap(kAxs, now, out, 4), 1);
+  EXPECT_EQ(out[0], kAxs);
+  EXPECT_EQ(out[1], 1);
+  EXPECT_EQ(out[2], now);
+  ASSERT_EQ(mkd_tap(kAxs, now + 1000, out, 4), 1);
+  EXPECT_EQ(out[1], 2);
+  EXPECT_EQ(out[2], now + 1000);
+  EXPECT_EQ(mkd_tap_remove_device(kAxs), MKD_OK);
+
+  UninstallTapClassifierWorker(&worker);
+  EXPECT_EQ(mkd_tap(kAxs, 0, out, 4), MKD_ERROR_UNAVAILABLE);
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "media_key_detector_core/media_key_detector_ffi.h"
+#include "media_key_detector_core/zwift_keypad.h"
+
+namespace media_key_detector_core {
+namespace test {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+void AppendVarint(Bytes* bytes, uint64_t value) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<uint8_t>(value));
+}
+
+void AppendVarintField(Bytes* bytes, uint32_t field, uint64_t value) {
+  AppendVarint(bytes, uint64_t{field} << 3);
+  AppendVarint(bytes, value);
+}
+
+void AppendBytesField(Bytes* bytes, uint32_t field, const Bytes& value) {
+  AppendVarint(bytes, (uint64_t{field} << 3) | 2);
+  AppendVarint(bytes, value.size());
+  bytes->insert(bytes->end(), value.begin(), value.end());
+}
+
+uint64_t ZigZag(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^
+         static_cast<uint32_t>(value >> 31);
+}
+
+// A RideKeyPadStatus with the |held| buttons, followed by the paddles.
+Bytes RideStatus(uint32_t held) {
+  Bytes bytes;
+  AppendVarintField(&bytes, 1, ~held);
+  return bytes;
+}
+
+void AppendRidePaddle(Bytes* bytes, int32_t location, int32_t value) {
+  Bytes paddle;
+  AppendVarintField(&paddle, 1, static_cast<uint64_t>(location));
+  AppendVarintField(&paddle, 2, ZigZag(value));
+  AppendBytesField(bytes, 3, paddle);
+}
+
+// A PlayKeyPadStatus of the pad on the right or left with all buttons
+// released but those |on|, given by field number.
+Bytes PlayStatus(bool right, std::vector<uint32_t> on, int32_t analog_lr) {
+  Bytes bytes;
+  AppendVarintField(&bytes, 1, right ? 0 : 1);
+  for (uint32_t field = 2; field <= 7; field++) {
+    bool pressed = false;
+    for (uint32_t on_field : on) {
+      pressed |= on_field == field;
+    }
+    AppendVarintField(&bytes, field, pressed ? 0 : 1);
+  }
+  AppendVarintField(&bytes, 8, ZigZag(analog_lr));
+  return bytes;
+}
+
+ZwiftKeypadState Decode(ZwiftKeypadKind kind, const Bytes& bytes) {
+  ZwiftKeypadState state;
+  EXPECT_TRUE(DecodeZwiftKeypad(kind, bytes.data(), bytes.size(), &state));
+  return state;
+}
+
+}  // namespace
+
+TEST(ZwiftKeypad, DecodesRideButtons) {
+  Bytes idle = {0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kRide, idle).buttons, 0u);
+
+  ZwiftKeypadState state = Decode(ZwiftKeypadKind::kRide,
+                                  RideStatus(kZwiftA | kZwiftShiftUpRight));
+  EXPECT_EQ(state.buttons, kZwiftA | kZwiftShiftUpRight);
+
+  uint32_t all = 0xFFFF;
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kRide, RideStatus(all)).buttons, all);
+}
+
+TEST(ZwiftKeypad, DecodesRidePaddlesAgainstTheThreshold) {
+  Bytes bytes = RideStatus(0);
+  AppendRidePaddle(&bytes, kZwiftAnalogLeft, -100);
+  AppendRidePaddle(&bytes, kZwiftAnalogRight, kZwiftRidePaddleThreshold - 1);
+  AppendRidePaddle(&bytes, 2, 100);
+  ZwiftKeypadState state = Decode(ZwiftKeypadKind::kRide, bytes);
+  EXPECT_EQ(state.buttons, kZwiftPaddleLeft);
+  EXPECT_EQ(state.analog[kZwiftAnalogLeft], -100);
+  EXPECT_EQ(state.analog[kZwiftAnalogRight], kZwiftRidePaddleThreshold - 1);
+  EXPECT_EQ(state.analog[2], 100);
+  EXPECT_EQ(state.analog[3], 0);
+
+  bytes = RideStatus(0);
+  AppendRidePaddle(&bytes, kZwiftAnalogRight, kZwiftRidePaddleThreshold);
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kRide, bytes).buttons, kZwiftPaddleRight);
+}
+
+TEST(ZwiftKeypad, IgnoresRidePaddlesWithoutLocationOrValue) {
+  Bytes bytes = RideStatus(0);
+  Bytes paddle;
+  AppendVarintField(&paddle, 2, ZigZag(100));
+  AppendBytesField(&bytes, 3, paddle);
+  paddle.clear();
+  AppendVarintField(&paddle, 1, kZwiftAnalogRight);
+  AppendBytesField(&bytes, 3, paddle);
+  // Out of range.
+  AppendRidePaddle(&bytes, 7, 100);
+  ZwiftKeypadState state = Decode(ZwiftKeypadKind::kRide, bytes);
+  EXPECT_EQ(state.buttons, 0u);
+  for (int32_t value : state.analog) {
+    EXPECT_EQ(value, 0);
+  }
+}
+
+TEST(ZwiftKeypad, SkipsUnknownFields) {
+  Bytes bytes;
+  AppendVarintField(&bytes, 2, 300);
+  bytes.insert(bytes.end(), {0x25, 1, 2, 3, 4});              // 4: fixed32
+  bytes.insert(bytes.end(), {0x29, 1, 2, 3, 4, 5, 6, 7, 8});  // 5: fixed64
+  AppendBytesField(&bytes, 6, {0x08, 0x00});
+  Bytes status = RideStatus(kZwiftB);
+  bytes.insert(bytes.end(), status.begin(), status.end());
+  AppendRidePaddle(&bytes, kZwiftAnalogLeft, 50);
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kRide, bytes).buttons,
+            kZwiftB | kZwiftPaddleLeft);
+}
+
+TEST(ZwiftKeypad, DecodesClickWithProto3Defaults) {
+  // Button_Plus ON, Button_Minus OFF.
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kClick, {0x08, 0x00, 0x10, 0x01}).buttons,
+            kZwiftShiftUpRight);
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kClick, {0x08, 0x01, 0x10, 0x01}).buttons,
+            0u);
+  // Fields that are not sent have the default value, ON.
+  EXPECT_EQ(Decode(ZwiftKeypadKind::kClick, {0x08, 0x01}).buttons,
+            kZwiftShiftUpLeft);
+}
+
+TEST(ZwiftKeypad, MapsPlayButtonsByPad) {
+  ZwiftKeypadState state =
+      Decode(ZwiftKeypadKind::kPlay, PlayStatus(true, {2, 6}, 100));
+  EXPECT_EQ(state.buttons, kZwiftY | kZwiftSideRight | kZwiftPaddleRight);
+  EXPECT_EQ(state.analog[kZwiftAnalogRight], 100);
+
+  state = Decode(ZwiftKeypadKind::kPlay, PlayStatus(false, {3, 7}, -99));
+  EXPECT_EQ(state.buttons, kZwiftNavigationLeft | kZwiftOnOffLeft);
+  EXPECT_EQ(state.analog[kZwiftAnalogLeft], -99);
+
+  state = Decode(ZwiftKeypadKind::kPlay, PlayStatus(false, {4, 5}, -100));
+  EXPECT_EQ(state.buttons,
+            kZwiftNavigationRight | kZwiftNavigationDown | kZwiftPaddleLeft);
+}
+
+TEST(ZwiftKeypad, RejectsMalformedMessages) {
+  const Bytes malformed[] = {
+      {0x08},                    // Value missing.
+      {0x08, 0xFF},              // Varint cut off.
+      {0x1A, 0x05, 0x08, 0x00},  // Longer than the message.
+      {0x1B},                    // Groups are not used.
+      {0x00, 0x00},              // Field number 0.
+      {0x25, 0x01},              // fixed32 cut off.
+      {0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01},
+  };
+  for (const Bytes& bytes : malformed) {
+    ZwiftKeypadState state;
+    EXPECT_FALSE(DecodeZwiftKeypad(ZwiftKeypadKind::kRide, bytes.data(),
+                                   bytes.size(), &state))
+        << testing::PrintToString(bytes);
+  }
+  Bytes paddle = RideStatus(0);
+  AppendBytesField(&paddle, 3, {0x10});
+  ZwiftKeypadState state;
+  EXPECT_FALSE(DecodeZwiftKeypad(ZwiftKeypadKind::kRide, paddle.data(),
+                                 paddle.size(), &state));
+}
+
+TEST(ZwiftKeypad, DecodesNotificationsThroughTheCAbi) {
+  EXPECT_EQ(mkd_abi_version(), MKD_ABI_VERSION);
+
+  // CONTROLLER_NOTIFICATION, then the status.
+  Bytes notification = {0x23};
+  Bytes status = RideStatus(kZwiftZ);
+  AppendRidePaddle(&status, kZwiftAnalogRight, 60);
+  notification.insert(notification.end(), status.begin(), status.end());
+  MkdZwiftKeypad out = {};
+  ASSERT_EQ(mkd_decode_zwift_keypad(MKD_ZWIFT_RIDE, notification.data(),
+                                    notification.size(), &out),
+            MKD_OK);
+  EXPECT_EQ(out.buttons, kZwiftZ | kZwiftPaddleRight);
+  EXPECT_EQ(out.analog[kZwiftAnalogRight], 60);
+
+  EXPECT_EQ(mkd_decode_zwift_keypad(3, notification.data(),
+                                    notification.size(), &out),
+            MKD_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(mkd_decode_zwift_keypad(MKD_ZWIFT_RIDE, notification.data(), 0,
+                                    &out),
+            MKD_ERROR_INVALID_ARGUMENT);
+  Bytes truncated = {0x23, 0x08};
+  EXPECT_EQ(mkd_decode_zwift_keypad(MKD_ZWIFT_RIDE, truncated.data(),
+                                    truncated.size(), &out),
+            MKD_ERROR_MALFORMED);
+}
+
+}  // namespace test
+}  // namespace media_key_detector_core
@@ -0,0 +1,283 @@
+#include "media_key_detector_core/zwift_keypad.h"
+
+#include <cstdlib>
+
+namespace media_key_detector_core {
+
+namespace {
+
+// Wire types of the protobuf encoding. Groups are not used by zwift.proto.
+constexpr uint32_t kWireVarint = 0;
+constexpr uint32_t kWireFixed64 = 1;
+constexpr uint32_t kWireLengthDelimited = 2;
+constexpr uint32_t kWireFixed32 = 5;
+
+// PlayButtonStatus.ON, which is also the proto3 default.
+constexpr int32_t kButtonOn = 0;
+constexpr int32_t kButtonOff = 1;
+
+// Reads the protobuf wire format straight from a byte span.
+class WireReader {
+ public:
+  WireReader(const uint8_t* data, size_t size)
+      : position_(data), end_(data + size) {}
+
+  bool done() const { return position_ == end_; }
+
+  bool ReadVarint(uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (position_ == end_) {
+        return false;
+      }
+      uint8_t byte = *position_++;
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadKey(uint32_t* field, uint32_t* wire_type) {
+    uint64_t key;
+    if (!ReadVarint(&key) || (key >> 3) == 0 || (key >> 3) > 0x1FFFFFFF) {
+      return false;
+    }
+    *field = static_cast<uint32_t>(key >> 3);
+    *wire_type = static_cast<uint32_t>(key & 7);
+    return true;
+  }
+
+  // Reads the payload of a length-delimited field.
+  bool ReadBytes(const uint8_t** data, size_t* size) {
+    uint64_t length;
+    if (!ReadVarint(&length) ||
+        length > static_cast<uint64_t>(end_ - position_)) {
+      return false;
+    }
+    *data = position_;
+    *size = static_cast<size_t>(length);
+    position_ += length;
+    return true;
+  }
+
+  // Skips the value of a field that is not read.
+  bool Skip(uint32_t wire_type) {
+    uint64_t varint;
+    const uint8_t* data;
+    size_t size;
+    switch (wire_type) {
+      case kWireVarint:
+        return ReadVarint(&varint);
+      case kWireFixed64:
+        return Advance(8);
+      case kWireLengthDelimited:
+        return ReadBytes(&data, &size);
+      case kWireFixed32:
+        return Advance(4);
+      default:
+        return false;
+    }
+  }
+
+ private:
+  bool Advance(size_t count) {
+    if (count > static_cast<size_t>(end_ - position_)) {
+      return false;
+    }
+    position_ += count;
+    return true;
+  }
+
+  const uint8_t* position_;
+  const uint8_t* end_;
+};
+
+// int32 and enum fields are sign-extended to 64 bits on the wire.
+int32_t ToInt32(uint64_t value) {
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+int32_t ZigZagToInt32(uint64_t value) {
+  auto bits = static_cast<uint32_t>(value);
+  return static_cast<int32_t>((bits >> 1) ^ (~(bits & 1) + 1));
+}
+
+// Calls |on_varint(field, value)| for every varint field of the message and
+// |on_bytes(field, data, size)| for every length-delimited one. Fields of
+// other wire types are skipped.
+template <typename OnVarint, typename OnBytes>
+bool ReadFields(const uint8_t* data,
+                size_t size,
+                OnVarint&& on_varint,
+                OnBytes&& on_bytes) {
+  WireReader reader(data, size);
+  while (!reader.done()) {
+    uint32_t field;
+    uint32_t wire_type;
+    if (!reader.ReadKey(&field, &wire_type)) {
+      return false;
+    }
+    if (wire_type == kWireVarint) {
+      uint64_t value;
+      if (!reader.ReadVarint(&value)) {
+        return false;
+      }
+      on_varint(field, value);
+    } else if (wire_type == kWireLengthDelimited) {
+      const uint8_t* bytes;
+      size_t length;
+      if (!reader.ReadBytes(&bytes, &length) ||
+          !on_bytes(field, bytes, length)) {
+        return false;
+      }
+    } else if (!reader.Skip(wire_type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NoBytes(uint32_t, const uint8_t*, size_t) {
+  return true;
+}
+
+bool DecodeClick(const uint8_t* data, size_t size, ZwiftKeypadState* state) {
+  int32_t plus = kButtonOn;
+  int32_t minus = kButtonOn;
+  bool valid = ReadFields(
+      data, size,
+      [&](uint32_t field, uint64_t value) {
+        if (field == 1) {
+          plus = ToInt32(value);
+        } else if (field == 2) {
+          minus = ToInt32(value);
+        }
+      },
+      NoBytes);
+  if (plus == kButtonOn) {
+    state->buttons |= kZwiftShiftUpRight;
+  }
+  if (minus == kButtonOn) {
+    state->buttons |= kZwiftShiftUpLeft;
+  }
+  return valid;
+}
+
+bool DecodePlay(const uint8_t* data, size_t size, ZwiftKeypadState* state) {
+  // Fields 1 to 7: RightPad, then the Y/Up, Z/Left, A/Right, B/Down, Shift
+  // and On buttons.
+  int32_t status[8] = {};
+  int32_t analog_lr = 0;
+  bool valid = ReadFields(
+      data, size,
+      [&](uint32_t field, uint64_t value) {
+        if (field >= 1 && field <= 7) {
+          status[field] = ToInt32(value);
+        } else if (field == 8) {
+          analog_lr = ZigZagToInt32(value);
+        }
+      },
+      NoBytes);
+
+  bool right = status[1] == kButtonOn;
+  if (!right && status[1] != kButtonOff) {
+    return valid;
+  }
+  // The same buttons sit on both pads; on the left one they navigate.
+  const uint32_t mapping[] = {
+      right ? kZwiftY : kZwiftNavigationUp,
+      right ? kZwiftZ : kZwiftNavigationLeft,
+      right ? kZwiftA : kZwiftNavigationRight,
+      right ? kZwiftB : kZwiftNavigationDown,
+      right ? kZwiftSideRight : kZwiftSideLeft,
+      right ? kZwiftOnOffRight : kZwiftOnOffLeft,
+  };
+  for (int i = 0; i < 6; i++) {
+    if (status[i + 2] == kButtonOn) {
+      state->buttons |= mapping[i];
+    }
+  }
+  state->analog[right ? kZwiftAnalogRight : kZwiftAnalogLeft] = analog_lr;
+  if (std::abs(analog_lr) == kZwiftPlayPaddleThreshold) {
+    state->buttons |= right ? kZwiftPaddleRight : kZwiftPaddleLeft;
+  }
+  return valid;
+}
+
+// One RideAnalogKeyPress. Only paddles with both fields present count.
+bool DecodeRidePaddle(const uint8_t* data,
+                      size_t size,
+                      ZwiftKeypadState* state) {
+  int32_t location = 0;
+  int32_t value = 0;
+  bool has_location = false;
+  bool has_value = false;
+  bool valid = ReadFields(
+      data, size,
+      [&](uint32_t field, uint64_t raw) {
+        if (field == 1) {
+          location = ToInt32(raw);
+          has_location = true;
+        } else if (field == 2) {
+          value = ZigZagToInt32(raw);
+          has_value = true;
+        }
+      },
+      NoBytes);
+  if (!valid || !has_location || !has_value || location < 0 ||
+      location >= kZwiftAnalogCount) {
+    return valid;
+  }
+  state->analog[location] = value;
+  if (std::abs(value) >= kZwiftRidePaddleThreshold) {
+    if (location == kZwiftAnalogLeft) {
+      state->buttons |= kZwiftPaddleLeft;
+    } else if (location == kZwiftAnalogRight) {
+      state->buttons |= kZwiftPaddleRight;
+    }
+  }
+  return true;
+}
+
+bool DecodeRide(const uint8_t* data, size_t size, ZwiftKeypadState* state) {
+  uint32_t button_map = 0;
+  bool valid = ReadFields(
+      data, size,
+      [&](uint32_t field, uint64_t value) {
+        if (field == 1) {
+          button_map = static_cast<uint32_t>(value);
+        }
+      },
+      [&](uint32_t field, const uint8_t* bytes, size_t length) {
+        return field != 3 || DecodeRidePaddle(bytes, length, state);
+      });
+  // A cleared bit is a held button.
+  state->buttons |= ~button_map & 0xFFFF;
+  return valid;
+}
+
+}  // namespace
+
+bool DecodeZwiftKeypad(ZwiftKeypadKind kind,
+                       const uint8_t* data,
+                       size_t size,
+                       ZwiftKeypadState* state) {
+  *state = {};
+  if (data == nullptr && size > 0) {
+    return false;
+  }
+  switch (kind) {
+    case ZwiftKeypadKind::kClick:
+      return DecodeClick(data, size, state);
+    case ZwiftKeypadKind::kPlay:
+      return DecodePlay(data, size, state);
+    case ZwiftKeypadKind::kRide:
+      return DecodeRide(data, size, state);
+  }
+  return false;
+}
+
+}  // namespace media_key_detector_core
@@ -0,0 +1,64 @@
+import 'package:bike_control/bluetooth/devices/zwift/constants.dart';
+import 'package:bike_control/utils/actions/base_actions.dart';
+import 'package:bike_control/utils/actions/desktop.dart';
+import 'package:bike_control/utils/keymap/keymap.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keypress_simulator_platform_interface/keypress_simulator_platform_interface.dart';
+
+class RecordingKeyPressSimulator extends KeyPressSimulatorPlatform {
+  final drags = <List<Offset>>[];
+
+  @override
+  Future<void> simulateDrag(List<Offset> path, {required Duration duration, required DragEasing easing}) async {
+    drags.add(path);
+  }
+}
+
+void main() {
+  group('Desktop drag', () {
+    late RecordingKeyPressSimulator simulator;
+    late KeyPair keyPair;
+
+    setUp(() {
+      simulator = RecordingKeyPressSimulator();
+      KeyPressSimulatorPlatform.instance = simulator;
+      keyPair = KeyPair(
+        buttons: [ZwiftButtons.a],
+        physicalKey: null,
+        logicalKey: null,
+        touchPosition: Offset(10, 20),
+        dragTo: Offset(50, 80),
+      );
+    });
+
+    testWidgets('drags from the touch position to the target on key down', (tester) async {
+      // 1000 x 500 logical pixels.
+      tester.view.display.size = Size(2000, 1000);
+      tester.view.display.devicePixelRatio = 2;
+      addTearDown(tester.view.display.reset);
+
+      final result = await DesktopActions().performDrag(keyPair, isKeyDown: true);
+
+      expect(result, isA<Success>());
+      expect(simulator.drags, [
+        [Offset(100, 100), Offset(500, 400)],
+      ]);
+    });
+
+    testWidgets('does nothing on key up', (tester) async {
+      final result = await DesktopActions().performDrag(keyPair, isKeyDown: false);
+
+      expect(result, isA<Ignored>());
+      expect(simulator.drags, isEmpty);
+    });
+
+    test('KeyPair should encode and decode dragTo', () {
+      final decoded = KeyPair.decode(keyPair.encode());
+
+      expect(decoded, isNotNull);
+      expect(decoded!.touchPosition, Offset(10, 20));
+      expect(decoded.dragTo, Offset(50, 80));
+    });
+  });
+}
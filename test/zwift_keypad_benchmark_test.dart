@@ -0,0 +1,71 @@
+// Compares decoding Zwift Ride keypad notifications in Dart, with the generated protobuf classes, against the native
+// decoder behind ZwiftKeypadDecoder. The native side needs the Linux plugin library, e.g.
+//
+//   flutter build linux
+//   LD_LIBRARY_PATH=build/linux/x64/release/bundle/lib flutter test test/zwift_keypad_benchmark_test.dart
+//
+// and is skipped without it.
+
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:bike_control/bluetooth/devices/zwift/zwift_ride.dart';
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:media_key_detector/media_key_detector.dart';
+import 'package:universal_ble/universal_ble.dart';
+
+const _corpusPath = 'media_key_detector/native/test/data/zwift_ride.notifications';
+const _rounds = 2000;
+
+/// One notification per line in hex, with # comments; shared with the native zwift_keypad_benchmark.
+List<Uint8List> _loadCorpus() {
+  return File(_corpusPath)
+      .readAsLinesSync()
+      .where((line) => line.isNotEmpty && !line.startsWith('#'))
+      .map((line) => Uint8List.fromList(line.split(' ').map((byte) => int.parse(byte, radix: 16)).toList()))
+      .toList();
+}
+
+ZwiftRide _ride() => ZwiftRide(BleDevice(deviceId: 'deviceId', name: 'Zwift Ride'));
+
+double _measureNanos(List<Uint8List> corpus, void Function(Uint8List notification) decode) {
+  final stopwatch = Stopwatch()..start();
+  for (var round = 0; round < _rounds; round++) {
+    for (final notification in corpus) {
+      decode(notification);
+    }
+  }
+  return stopwatch.elapsedMicroseconds * 1000 / (_rounds * corpus.length);
+}
+
+void main() {
+  final corpus = _loadCorpus();
+  final nativeSkip = ZwiftKeypadDecoder.open() == null ? 'The media_key_detector plugin library is not loaded' : false;
+
+  group('Zwift Ride keypad decoding', () {
+    test('corpus holds notifications', () {
+      expect(corpus, hasLength(64));
+      expect(corpus.every((notification) => notification.first == 0x23), isTrue);
+    });
+
+    test('native decoder agrees with the protobuf decoder', () {
+      for (final notification in corpus) {
+        // A new device each time, so no change is held back as a repeat of the last notification.
+        final native = _ride().decodeClickNotification(notification) ?? const [];
+        final dart = _ride().processClickNotification(notification.sublist(1));
+        expect(native.toSet(), dart.toSet(), reason: notification.toString());
+      }
+    }, skip: nativeSkip);
+
+    test('benchmark', () {
+      final ride = _ride();
+      final dart = _measureNanos(corpus, (notification) => ride.processClickNotification(notification.sublist(1)));
+      final native = _measureNanos(corpus, ride.decodeClickNotification);
+
+      debugPrint('${corpus.length} notifications, $_rounds rounds');
+      debugPrint('RideKeyPadStatus.fromBuffer: ${dart.toStringAsFixed(1)} ns/notification');
+      debugPrint('decodeClickNotification (ffi): ${native.toStringAsFixed(1)} ns/notification');
+    }, skip: nativeSkip);
+  });
+}
@@ -0,0 +1,103 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+
+/// A characteristic served over DirCon.
+@immutable
+class DirConCharacteristic {
+  /// Creates a characteristic.
+  const DirConCharacteristic({required this.uuid, required this.properties});
+
+  /// Clients may read it.
+  static const read = 0x01;
+
+  /// Clients may write to it.
+  static const write = 0x02;
+
+  /// It sends notifications.
+  static const notify = 0x04;
+
+  /// The 16 bytes of its UUID, in the order they are written.
+  final Uint8List uuid;
+
+  /// [read], [write] and [notify] combined.
+  final int properties;
+
+  /// The map the plugin reads.
+  Map<String, Object> toMap() => {'uuid': uuid, 'properties': properties};
+}
+
+/// A service served over DirCon.
+@immutable
+class DirConService {
+  /// Creates a service.
+  const DirConService({required this.uuid, required this.characteristics});
+
+  /// The 16 bytes of its UUID.
+  final Uint8List uuid;
+
+  /// Its characteristics, in the order they are discovered.
+  final List<DirConCharacteristic> characteristics;
+
+  /// The map the plugin reads.
+  Map<String, Object> toMap() => {
+    'uuid': uuid,
+    'characteristics': [for (final characteristic in characteristics) characteristic.toMap()],
+  };
+}
+
+/// A client that connected or disconnected.
+@immutable
+class DirConConnectionEvent {
+  /// Creates an event.
+  const DirConConnectionEvent({required this.connection, required this.address, required this.connected});
+
+  /// Reads the map sent by the plugin.
+  factory DirConConnectionEvent.fromMap(Map<Object?, Object?> map) {
+    return DirConConnectionEvent(
+      connection: map['connection']! as int,
+      address: map['address']! as String,
+      connected: map['connected']! as bool,
+    );
+  }
+
+  /// Identifies the connection for as long as the server runs.
+  final int connection;
+
+  /// The IP address of the client.
+  final String address;
+
+  /// Whether it connected rather than disconnected.
+  final bool connected;
+
+  @override
+  String toString() => 'DirConConnectionEvent($connection, $address, ${connected ? 'connected' : 'disconnected'})';
+}
+
+/// What a client wrote to a characteristic, which has been acknowledged.
+@immutable
+class DirConWrite {
+  /// Creates a write.
+  const DirConWrite({required this.connection, required this.characteristic, required this.data});
+
+  /// Reads the map sent by the plugin.
+  factory DirConWrite.fromMap(Map<Object?, Object?> map) {
+    return DirConWrite(
+      connection: map['connection']! as int,
+      characteristic: map['characteristic']! as Uint8List,
+      data: map['data']! as Uint8List,
+    );
+  }
+
+  /// The connection, as in [DirConConnectionEvent.connection].
+  final int connection;
+
+  /// The 16 bytes of its UUID.
+  final Uint8List characteristic;
+
+  /// The value written.
+  final Uint8List data;
+
+  @override
+  String toString() => 'DirConWrite($connection, $characteristic, $data)';
+}
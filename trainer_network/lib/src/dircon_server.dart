@@ -0,0 +1,94 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+import 'package:trainer_network/src/dircon.dart';
+
+/// Serves GATT services over DirCon, Wahoo's protocol for Bluetooth
+/// services over TCP, from a native thread of the plugin.
+///
+/// Discovery, reads and notification requests are answered natively as they
+/// arrive; only [connections] and [writes] reach Dart. [notify] goes out
+/// through the C ABI the plugin library exports (see
+/// `native/include/trainer_network_core/trainer_network_ffi.h`), without a
+/// platform channel round trip.
+class DirConServer {
+  DirConServer._(this._notify);
+
+  /// The ABI version this file was written against.
+  static const int abiVersion = 1;
+
+  /// The port DirCon clients look for.
+  static const int defaultPort = 36867;
+
+  static DirConServer? _instance;
+
+  final int Function(Uint8List, Uint8List, int) _notify;
+
+  final _methodChannel = const MethodChannel('trainer_network');
+  final _connectionChannel = const EventChannel('trainer_network_dircon_connections');
+  final _writeChannel = const EventChannel('trainer_network_dircon_writes');
+  Stream<DirConConnectionEvent>? _connections;
+  Stream<DirConWrite>? _writes;
+
+  /// Binds the server of the plugin library. Returns null where the library
+  /// does not export it or exports another ABI version. The server is shared
+  /// by the whole app.
+  static DirConServer? open() {
+    if (_instance != null) return _instance;
+    if (!Platform.isLinux) return null;
+    try {
+      final library = DynamicLibrary.open('libtrainer_network_plugin.so');
+      final version = library.lookupFunction<Int32 Function(), int Function()>('tn_abi_version');
+      if (version() != abiVersion) return null;
+      return _instance = DirConServer._(
+        library.lookupFunction<
+          Int32 Function(Pointer<Uint8>, Pointer<Uint8>, Int64),
+          int Function(Uint8List, Uint8List, int)
+        >('tn_dircon_notify', isLeaf: true),
+      );
+    } on ArgumentError {
+      // The library or one of the symbols is missing.
+      return null;
+    }
+  }
+
+  /// Serves [services] on [port] of every address, or on a free port with 0,
+  /// and returns the port. Throws a [PlatformException] if it cannot be
+  /// listened on. A running server is restarted.
+  Future<int> start(List<DirConService> services, {int port = defaultPort}) async {
+    final bound = await _methodChannel.invokeMethod<int>('startDirCon', <String, dynamic>{
+      'port': port,
+      'services': [for (final service in services) service.toMap()],
+    });
+    return bound!;
+  }
+
+  /// Disconnects the clients and stops serving.
+  Future<void> stop() => _methodChannel.invokeMethod<void>('stopDirCon');
+
+  /// Sends [data] as a notification of [characteristic] to every client.
+  /// Returns how many it went to, or a negative error if the server does not
+  /// run in this process or [data] does not fit a message.
+  int notify(Uint8List characteristic, Uint8List data) {
+    if (characteristic.length != 16) {
+      throw ArgumentError.value(characteristic, 'characteristic', 'must be a 16-byte UUID');
+    }
+    return _notify(characteristic, data, data.length);
+  }
+
+  /// Clients as they connect and disconnect.
+  Stream<DirConConnectionEvent> get connections {
+    return _connections ??= _connectionChannel
+        .receiveBroadcastStream()
+        .map((event) => DirConConnectionEvent.fromMap(event as Map<Object?, Object?>));
+  }
+
+  /// What clients write to characteristics.
+  Stream<DirConWrite> get writes {
+    return _writes ??= _writeChannel
+        .receiveBroadcastStream()
+        .map((event) => DirConWrite.fromMap(event as Map<Object?, Object?>));
+  }
+}
@@ -0,0 +1,23 @@
+import 'dart:typed_data';
+
+import 'package:trainer_network/src/dircon.dart';
+
+/// Stands in for the `dart:ffi` server on platforms without `dart:ffi`
+/// (the web), where DirCon is never served natively.
+class DirConServer {
+  static const int defaultPort = 36867;
+
+  static DirConServer? open() => null;
+
+  Future<int> start(List<DirConService> services, {int port = defaultPort}) {
+    throw UnsupportedError('DirCon is not served on this platform');
+  }
+
+  Future<void> stop() async {}
+
+  int notify(Uint8List characteristic, Uint8List data) => -1;
+
+  Stream<DirConConnectionEvent> get connections => const Stream.empty();
+
+  Stream<DirConWrite> get writes => const Stream.empty();
+}
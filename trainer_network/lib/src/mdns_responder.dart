@@ -0,0 +1,46 @@
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Advertises a DNS-SD service over multicast DNS from a native thread of
+/// the plugin, so that apps such as Zwift find the emulated trainer.
+///
+/// The service is probed for and announced on every multicast capable IPv4
+/// interface as soon as [start] is called, and queries are answered natively
+/// from records built once. It runs next to Avahi, without depending on it.
+class MdnsResponder {
+  /// Creates a responder. Only one service is advertised at a time.
+  const MdnsResponder();
+
+  /// Whether the plugin can advertise on this platform.
+  static bool get isSupported => !kIsWeb && defaultTargetPlatform == TargetPlatform.linux;
+
+  static const _methodChannel = MethodChannel('trainer_network');
+
+  /// Advertises the service [name] of [type], e.g. `_wahoo-fitness-tnp._tcp`,
+  /// on [port], with the [txt] entries, on [host] or the host name of the
+  /// machine. Returns the name advertised, which gets a number appended later
+  /// if another host has it. Throws a [PlatformException] if no interface
+  /// takes multicast. A running service is replaced.
+  Future<String> start({
+    required String name,
+    required String type,
+    required int port,
+    String? host,
+    Map<String, Uint8List> txt = const {},
+  }) async {
+    final advertised = await _methodChannel.invokeMethod<String>('startMdns', <String, dynamic>{
+      'name': name,
+      'type': type,
+      'port': port,
+      if (host != null) 'host': host,
+      'txt': txt,
+    });
+    return advertised!;
+  }
+
+  /// Says goodbye, so that browsers drop the service at once, and stops
+  /// answering.
+  Future<void> stop() => _methodChannel.invokeMethod<void>('stopMdns');
+}
@@ -0,0 +1,3 @@
+export 'src/dircon.dart';
+export 'src/dircon_server_stub.dart' if (dart.library.ffi) 'src/dircon_server.dart';
+export 'src/mdns_responder.dart';
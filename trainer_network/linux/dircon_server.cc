@@ -0,0 +1,382 @@
+#include "dircon_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+namespace trainer_network {
+
+using trainer_network_core::DirConGattTable;
+using trainer_network_core::DirConService;
+using trainer_network_core::DirConSession;
+using trainer_network_core::DirConSpan;
+using trainer_network_core::DirConUuid;
+using trainer_network_core::kDirConUuidSize;
+
+namespace {
+
+constexpr int kMaxReadyEvents = 16;
+constexpr int kListenBacklog = 8;
+// A session sends no message of more pieces.
+constexpr size_t kMaxSpans = 4;
+
+bool AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void WatchOutput(int epoll_fd, int fd, bool output) {
+  epoll_event event = {};
+  event.events = output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  event.data.fd = fd;
+  epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// Listens on |port| of every address, over IPv6 with IPv4-mapped addresses
+// where the kernel has IPv6, and over IPv4 otherwise. Returns the socket and
+// stores the port it got in |bound_port|, or returns -1.
+int Listen(uint16_t port, uint16_t* bound_port) {
+  int fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int off = 0;
+  int on = 1;
+  if (fd >= 0) {
+    sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons(port);
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+      CloseFd(&fd);
+    }
+  }
+  if (fd < 0 && errno == EAFNOSUPPORT) {
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+      CloseFd(&fd);
+    }
+  }
+  if (fd < 0 || listen(fd, kListenBacklog) < 0) {
+    CloseFd(&fd);
+    return -1;
+  }
+
+  sockaddr_storage bound = {};
+  socklen_t size = sizeof(bound);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &size);
+  *bound_port = ntohs(bound.ss_family == AF_INET6
+                          ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                          : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+  return fd;
+}
+
+// The address of a client as text, IPv4-mapped ones as plain IPv4.
+std::string FormatAddress(const sockaddr_storage& address) {
+  char text[INET6_ADDRSTRLEN] = {};
+  if (address.ss_family == AF_INET) {
+    inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in&>(address).sin_addr, text,
+              sizeof(text));
+    return text;
+  }
+  const in6_addr& ip = reinterpret_cast<const sockaddr_in6&>(address).sin6_addr;
+  if (IN6_IS_ADDR_V4MAPPED(&ip)) {
+    inet_ntop(AF_INET, ip.s6_addr + 12, text, sizeof(text));
+  } else {
+    inet_ntop(AF_INET6, &ip, text, sizeof(text));
+  }
+  return text;
+}
+
+}  // namespace
+
+// A client, and what is queued for it while its socket does not take more.
+class DirConServer::Connection : public DirConSession::Delegate {
+ public:
+  struct Write {
+    DirConUuid characteristic;
+    std::vector<uint8_t> data;
+  };
+
+  Connection(uint32_t id, int fd, int epoll_fd, std::string address, const DirConGattTable* table)
+      : id(id), fd(fd), address(std::move(address)), session(table, this), epoll_fd_(epoll_fd) {}
+
+  void Send(const DirConSpan* spans, size_t count) override {
+    if (failed || count > kMaxSpans) {
+      return;
+    }
+    // Whatever is queued goes first.
+    size_t skip = 0;
+    if (pending_.empty()) {
+      iovec vector[kMaxSpans];
+      size_t total = 0;
+      for (size_t i = 0; i < count; i++) {
+        vector[i] = {const_cast<uint8_t*>(spans[i].data), spans[i].size};
+        total += spans[i].size;
+      }
+      msghdr message = {};
+      message.msg_iov = vector;
+      message.msg_iovlen = count;
+      ssize_t sent;
+      do {
+        sent = sendmsg(fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+      } while (sent < 0 && errno == EINTR);
+      if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        Fail();
+        return;
+      }
+      if (sent == static_cast<ssize_t>(total)) {
+        return;
+      }
+      skip = sent < 0 ? 0 : static_cast<size_t>(sent);
+      WatchOutput(epoll_fd_, fd, true);
+    }
+    for (size_t i = 0; i < count; i++) {
+      size_t skipped = std::min(skip, spans[i].size);
+      pending_.insert(pending_.end(), spans[i].data + skipped, spans[i].data + spans[i].size);
+      skip -= skipped;
+    }
+    if (pending_.size() > kMaxPendingBytes) {
+      Fail();
+    }
+  }
+
+  void OnWrite(const uint8_t* characteristic, const uint8_t* data, size_t size) override {
+    Write write;
+    std::copy(characteristic, characteristic + kDirConUuidSize, write.characteristic.begin());
+    write.data.assign(data, data + size);
+    writes.push_back(std::move(write));
+  }
+
+  // Writes out what is queued, as far as the socket takes it.
+  void Flush() {
+    while (!failed && !pending_.empty()) {
+      ssize_t sent = send(fd, pending_.data(), pending_.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          Fail();
+        }
+        return;
+      }
+      pending_.erase(pending_.begin(), pending_.begin() + sent);
+    }
+    if (!failed) {
+      WatchOutput(epoll_fd_, fd, false);
+    }
+  }
+
+  const uint32_t id;
+  const int fd;
+  const std::string address;
+  DirConSession session;
+  // Set once the socket failed or the client stopped reading. The server
+  // thread closes it on the hangup that follows.
+  bool failed = false;
+  // Writes of the client not passed on yet.
+  std::vector<Write> writes;
+
+ private:
+  void Fail() {
+    failed = true;
+    pending_.clear();
+    shutdown(fd, SHUT_RDWR);
+  }
+
+  int epoll_fd_;
+  std::vector<uint8_t> pending_;
+};
+
+DirConServer::DirConServer(ConnectionCallback connection_callback, WriteCallback write_callback)
+    : connection_callback_(std::move(connection_callback)),
+      write_callback_(std::move(write_callback)) {}
+
+DirConServer::~DirConServer() {
+  Stop();
+}
+
+bool DirConServer::Start(uint16_t port, std::vector<DirConService> services) {
+  Stop();
+  table_ = DirConGattTable(std::move(services));
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  listen_fd_ = Listen(port, &port_);
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || listen_fd_ < 0 || !AddToEpoll(epoll_fd_, stop_fd_) ||
+      !AddToEpoll(epoll_fd_, listen_fd_)) {
+    Stop();
+    return false;
+  }
+  thread_ = std::thread(&DirConServer::Run, this);
+  return true;
+}
+
+void DirConServer::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : connections_) {
+      close(entry.first);
+    }
+    connections_.clear();
+  }
+  CloseFd(&listen_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+  port_ = 0;
+}
+
+int DirConServer::Notify(const uint8_t* characteristic, const uint8_t* data, size_t size) {
+  if (size > UINT16_MAX - kDirConUuidSize) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  int clients = 0;
+  for (auto& entry : connections_) {
+    Connection* connection = entry.second.get();
+    if (!connection->failed) {
+      connection->session.Notify(characteristic, data, size);
+      clients++;
+    }
+  }
+  return clients;
+}
+
+void DirConServer::Run() {
+  epoll_event ready[kMaxReadyEvents];
+  while (true) {
+    int count = epoll_wait(epoll_fd_, ready, kMaxReadyEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      int fd = ready[i].data.fd;
+      if (fd == stop_fd_) {
+        return;
+      }
+      if (fd == listen_fd_) {
+        Accept();
+      } else if (!Serve(fd, ready[i].events)) {
+        Close(fd);
+      }
+    }
+  }
+}
+
+void DirConServer::Accept() {
+  while (true) {
+    sockaddr_storage address = {};
+    socklen_t size = sizeof(address);
+    int fd = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&address), &size,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      return;
+    }
+    // Responses are single small messages; Nagle would hold each back.
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (!AddToEpoll(epoll_fd_, fd)) {
+      close(fd);
+      continue;
+    }
+    uint32_t id = next_connection_++;
+    std::string text = FormatAddress(address);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      connections_.emplace(fd, std::make_unique<Connection>(id, fd, epoll_fd_, text, &table_));
+    }
+    connection_callback_(id, text, true);
+  }
+}
+
+bool DirConServer::Serve(int fd, uint32_t events) {
+  uint32_t id;
+  bool open = true;
+  std::vector<Connection::Write> writes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = connections_.find(fd);
+    if (entry == connections_.end()) {
+      return true;
+    }
+    Connection* connection = entry->second.get();
+    if ((events & EPOLLOUT) != 0) {
+      connection->Flush();
+    }
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) {
+      uint8_t buffer[4096];
+      while (open && !connection->failed) {
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size > 0) {
+          connection->session.OnData(buffer, static_cast<size_t>(size));
+        } else if (size < 0 && errno == EINTR) {
+          continue;
+        } else {
+          // End of stream, or an error other than running dry.
+          open = size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+          break;
+        }
+      }
+    }
+    id = connection->id;
+    open = open && !connection->failed;
+    writes.swap(connection->writes);
+  }
+  // Unlocked, so the callback may notify.
+  for (Connection::Write& write : writes) {
+    write_callback_(id, write.characteristic, std::move(write.data));
+  }
+  return open;
+}
+
+void DirConServer::Close(int fd) {
+  std::unique_ptr<Connection> connection;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = connections_.find(fd);
+    if (entry == connections_.end()) {
+      return;
+    }
+    connection = std::move(entry->second);
+    connections_.erase(entry);
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  connection_callback_(connection->id, connection->address, false);
+}
+
+}  // namespace trainer_network
@@ -0,0 +1,93 @@
+#ifndef TRAINER_NETWORK_DIRCON_SERVER_H_
+#define TRAINER_NETWORK_DIRCON_SERVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "trainer_network_core/dircon_session.h"
+#include "trainer_network_core/ffi_bridge.h"
+
+namespace trainer_network {
+
+// Serves GATT services over DirCon (see dircon_session.h) to the apps that
+// connect, e.g. Zwift, on a thread of its own that sleeps in epoll_wait()
+// between messages. Requests are answered on that thread, with one vectored
+// write each, without waiting for the UI isolate. Only characteristic writes
+// and connections are passed on.
+class DirConServer : public trainer_network_core::DirConNotifier {
+ public:
+  // Called on the server thread when a client connects or disconnects.
+  using ConnectionCallback =
+      std::function<void(uint32_t connection, const std::string& address, bool connected)>;
+  // Called on the server thread with what a client wrote to |characteristic|,
+  // after the write was acknowledged.
+  using WriteCallback = std::function<void(uint32_t connection,
+                                           const trainer_network_core::DirConUuid& characteristic,
+                                           std::vector<uint8_t> data)>;
+
+  // Bytes queued for a client that does not read before it is dropped.
+  static constexpr size_t kMaxPendingBytes = 1 << 20;
+
+  DirConServer(ConnectionCallback connection_callback, WriteCallback write_callback);
+  ~DirConServer() override;
+
+  // Disallow copy and assign.
+  DirConServer(const DirConServer&) = delete;
+  DirConServer& operator=(const DirConServer&) = delete;
+
+  // Serves |services| on |port| of every IPv4 and IPv6 address, or on a free
+  // port with 0. Returns false if the port cannot be listened on. A running
+  // server is restarted.
+  bool Start(uint16_t port, std::vector<trainer_network_core::DirConService> services);
+
+  // Disconnects the clients and stops the thread. Called automatically on
+  // destruction. No callback runs once this returns.
+  void Stop();
+
+  // The port listened on, or 0 when stopped.
+  uint16_t port() const { return port_; }
+
+  // Sends a notification to every client. Can be called from any thread.
+  int Notify(const uint8_t* characteristic, const uint8_t* data, size_t size) override;
+
+ private:
+  class Connection;
+
+  void Run();
+
+  void Accept();
+
+  // Handles what epoll reported for the client |fd|. Returns false once it
+  // is to be closed.
+  bool Serve(int fd, uint32_t events);
+
+  void Close(int fd);
+
+  ConnectionCallback connection_callback_;
+  WriteCallback write_callback_;
+
+  trainer_network_core::DirConGattTable table_;
+  uint16_t port_ = 0;
+  uint32_t next_connection_ = 1;
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int listen_fd_ = -1;
+
+  // Guards the connections, which Notify() writes to from other threads.
+  std::mutex mutex_;
+  std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+
+  std::thread thread_;
+};
+
+}  // namespace trainer_network
+
+#endif  // TRAINER_NETWORK_DIRCON_SERVER_H_
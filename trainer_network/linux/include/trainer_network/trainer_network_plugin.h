@@ -0,0 +1,25 @@
+#ifndef FLUTTER_PLUGIN_TRAINER_NETWORK_PLUGIN_H_
+#define FLUTTER_PLUGIN_TRAINER_NETWORK_PLUGIN_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_BEGIN_DECLS
+
+#ifdef FLUTTER_PLUGIN_IMPL
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define FLUTTER_PLUGIN_EXPORT
+#endif
+
+G_DECLARE_FINAL_TYPE(FlTrainerNetworkPlugin, fl_trainer_network_plugin, FL, TRAINER_NETWORK_PLUGIN,
+                     GObject)
+
+FLUTTER_PLUGIN_EXPORT FlTrainerNetworkPlugin* fl_trainer_network_plugin_new(
+    FlPluginRegistrar* registrar);
+
+FLUTTER_PLUGIN_EXPORT void trainer_network_plugin_register_with_registrar(
+    FlPluginRegistrar* registrar);
+
+G_END_DECLS
+
+#endif  // FLUTTER_PLUGIN_TRAINER_NETWORK_PLUGIN_H_
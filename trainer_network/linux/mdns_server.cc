@@ -0,0 +1,288 @@
+#include "mdns_server.h"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace trainer_network {
+
+using trainer_network_core::kMdnsGroup;
+using trainer_network_core::MdnsInterface;
+using trainer_network_core::MdnsPacket;
+using trainer_network_core::MdnsResponder;
+using trainer_network_core::MdnsServiceInfo;
+
+namespace {
+
+constexpr int kMaxReadyEvents = 4;
+// Larger than any message on an Ethernet link.
+constexpr size_t kMaxMessageSize = 9000;
+
+bool AddToEpoll(int epoll_fd, int fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void CloseFd(int* fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+int64_t NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+in_addr GroupAddress() {
+  in_addr group;
+  std::memcpy(&group.s_addr, kMdnsGroup.data(), kMdnsGroup.size());
+  return group;
+}
+
+// Binds |port| of every address, next to other responders, with the
+// incoming interface reported, and joins the group on |interfaces|. Drops
+// the interfaces that could not join it. Returns the socket, or -1.
+int Bind(uint16_t port, std::vector<MdnsInterface>* interfaces) {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int on = 1;
+  // RFC 6762 11: replies to other queriers carry a TTL of 255.
+  int ttl = 255;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  setsockopt(fd, IPPROTO_IP, IP_PKTINFO, &on, sizeof(on));
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  setsockopt(fd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  auto failed = std::remove_if(interfaces->begin(), interfaces->end(),
+                               [fd](const MdnsInterface& interface) {
+                                 ip_mreqn request = {};
+                                 request.imr_multiaddr = GroupAddress();
+                                 request.imr_ifindex = static_cast<int>(interface.index);
+                                 return setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request,
+                                                   sizeof(request)) < 0 &&
+                                        errno != EADDRINUSE;
+                               });
+  interfaces->erase(failed, interfaces->end());
+  if (interfaces->empty()) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace
+
+MdnsServer::~MdnsServer() {
+  Stop();
+}
+
+std::vector<MdnsInterface> MdnsServer::ListInterfaces() {
+  std::vector<MdnsInterface> interfaces;
+  ifaddrs* addresses = nullptr;
+  if (getifaddrs(&addresses) < 0) {
+    return interfaces;
+  }
+  for (ifaddrs* entry = addresses; entry != nullptr; entry = entry->ifa_next) {
+    if (entry->ifa_addr == nullptr || entry->ifa_addr->sa_family != AF_INET ||
+        (entry->ifa_flags & IFF_UP) == 0 || (entry->ifa_flags & IFF_MULTICAST) == 0 ||
+        (entry->ifa_flags & IFF_LOOPBACK) != 0) {
+      continue;
+    }
+    uint32_t index = if_nametoindex(entry->ifa_name);
+    if (index == 0 ||
+        std::any_of(interfaces.begin(), interfaces.end(),
+                    [index](const MdnsInterface& known) { return known.index == index; })) {
+      continue;
+    }
+    MdnsInterface interface = {index, {}};
+    const in_addr& address = reinterpret_cast<sockaddr_in*>(entry->ifa_addr)->sin_addr;
+    std::memcpy(interface.address.data(), &address.s_addr, interface.address.size());
+    interfaces.push_back(interface);
+  }
+  freeifaddrs(addresses);
+  return interfaces;
+}
+
+bool MdnsServer::Start(MdnsServiceInfo service, std::vector<MdnsInterface> interfaces,
+                       uint16_t port) {
+  Stop();
+  if (interfaces.empty()) {
+    interfaces = ListInterfaces();
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  socket_fd_ = Bind(port, &interfaces);
+  if (epoll_fd_ < 0 || stop_fd_ < 0 || socket_fd_ < 0 || !AddToEpoll(epoll_fd_, stop_fd_) ||
+      !AddToEpoll(epoll_fd_, socket_fd_)) {
+    Stop();
+    return false;
+  }
+  port_ = port;
+  responder_ = std::make_unique<MdnsResponder>(std::move(service), std::move(interfaces), port);
+  std::vector<MdnsPacket> packets;
+  responder_->Start(NowUs(), &packets);
+  Send(packets, nullptr);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    instance_ = responder_->instance();
+  }
+  thread_ = std::thread(&MdnsServer::Run, this);
+  return true;
+}
+
+void MdnsServer::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    // Cannot fail: the eventfd counter is nowhere near overflowing.
+    [[maybe_unused]] ssize_t written = write(stop_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  if (responder_ != nullptr) {
+    std::vector<MdnsPacket> packets;
+    responder_->Stop(&packets);
+    Send(packets, nullptr);
+    responder_.reset();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    instance_.clear();
+  }
+  CloseFd(&socket_fd_);
+  CloseFd(&stop_fd_);
+  CloseFd(&epoll_fd_);
+  port_ = 0;
+}
+
+std::string MdnsServer::instance() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return instance_;
+}
+
+void MdnsServer::Run() {
+  epoll_event ready[kMaxReadyEvents];
+  while (true) {
+    int timeout_ms = -1;
+    if (auto deadline = responder_->NextDeadline()) {
+      // Rounded up, so that the deadline has passed on waking.
+      timeout_ms = static_cast<int>(std::max<int64_t>(0, (*deadline - NowUs() + 999) / 1000));
+    }
+    int count = epoll_wait(epoll_fd_, ready, kMaxReadyEvents, timeout_ms);
+    if (count < 0 && errno != EINTR) {
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      if (ready[i].data.fd == stop_fd_) {
+        return;
+      }
+      Receive();
+    }
+    std::vector<MdnsPacket> packets;
+    responder_->Advance(NowUs(), &packets);
+    Send(packets, nullptr);
+  }
+}
+
+void MdnsServer::Receive() {
+  uint8_t buffer[kMaxMessageSize];
+  alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(in_pktinfo))];
+  while (true) {
+    sockaddr_in source = {};
+    iovec vector = {buffer, sizeof(buffer)};
+    msghdr message = {};
+    message.msg_name = &source;
+    message.msg_namelen = sizeof(source);
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t size = recvmsg(socket_fd_, &message, 0);
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    uint32_t interface = 0;
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr;
+         header = CMSG_NXTHDR(&message, header)) {
+      if (header->cmsg_level == IPPROTO_IP && header->cmsg_type == IP_PKTINFO) {
+        in_pktinfo info;
+        std::memcpy(&info, CMSG_DATA(header), sizeof(info));
+        interface = static_cast<uint32_t>(info.ipi_ifindex);
+      }
+    }
+    // Truncated messages are dropped rather than half answered.
+    if (interface == 0 || (message.msg_flags & MSG_TRUNC) != 0) {
+      continue;
+    }
+    std::vector<MdnsPacket> packets;
+    responder_->OnPacket(buffer, static_cast<size_t>(size), interface, ntohs(source.sin_port),
+                         NowUs(), &packets);
+    Send(packets, &source);
+    std::lock_guard<std::mutex> lock(mutex_);
+    instance_ = responder_->instance();
+  }
+}
+
+void MdnsServer::Send(const std::vector<MdnsPacket>& packets, const sockaddr_in* source) {
+  for (const MdnsPacket& packet : packets) {
+    sockaddr_in destination = {};
+    if (packet.multicast) {
+      destination.sin_family = AF_INET;
+      destination.sin_addr = GroupAddress();
+      destination.sin_port = htons(port_);
+    } else if (source != nullptr) {
+      destination = *source;
+    } else {
+      continue;
+    }
+    // Out of the interface the packet is meant for.
+    alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(in_pktinfo))] = {};
+    iovec vector = {const_cast<uint8_t*>(packet.data.data()), packet.data.size()};
+    msghdr message = {};
+    message.msg_name = &destination;
+    message.msg_namelen = sizeof(destination);
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = IPPROTO_IP;
+    header->cmsg_type = IP_PKTINFO;
+    header->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
+    in_pktinfo info = {};
+    info.ipi_ifindex = static_cast<int>(packet.interface);
+    std::memcpy(CMSG_DATA(header), &info, sizeof(info));
+    // Lost like any datagram if the socket does not take it; the next
+    // announcement or query makes up for it.
+    while (sendmsg(socket_fd_, &message, MSG_DONTWAIT) < 0 && errno == EINTR) {
+    }
+  }
+}
+
+}  // namespace trainer_network
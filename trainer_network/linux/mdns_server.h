@@ -0,0 +1,75 @@
+#ifndef TRAINER_NETWORK_MDNS_SERVER_H_
+#define TRAINER_NETWORK_MDNS_SERVER_H_
+
+#include <netinet/in.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trainer_network_core/mdns_responder.h"
+
+namespace trainer_network {
+
+// Advertises a DNS-SD service over multicast DNS (see mdns_responder.h) on
+// a thread of its own that sleeps in epoll_wait() until a query arrives or
+// the next probe or announcement is due. Works next to Avahi, which binds
+// the same port.
+class MdnsServer {
+ public:
+  MdnsServer() = default;
+  ~MdnsServer();
+
+  // Disallow copy and assign.
+  MdnsServer(const MdnsServer&) = delete;
+  MdnsServer& operator=(const MdnsServer&) = delete;
+
+  // The IPv4 interfaces that are up and multicast capable, except loopback,
+  // with their first address.
+  static std::vector<trainer_network_core::MdnsInterface> ListInterfaces();
+
+  // Probes for and then announces |service| on |interfaces|, or on those of
+  // ListInterfaces() if empty, listening on |port|. Returns false if the
+  // port cannot be bound or no interface joined the group. A running server
+  // is restarted.
+  bool Start(trainer_network_core::MdnsServiceInfo service,
+             std::vector<trainer_network_core::MdnsInterface> interfaces = {},
+             uint16_t port = trainer_network_core::kMdnsPort);
+
+  // Says goodbye, if the service was announced, and stops the thread.
+  // Called automatically on destruction.
+  void Stop();
+
+  // The instance name, which changes if another host had it. Empty when
+  // stopped. Can be called from any thread.
+  std::string instance();
+
+ private:
+  void Run();
+
+  // Reads what arrived, and answers it.
+  void Receive();
+
+  void Send(const std::vector<trainer_network_core::MdnsPacket>& packets,
+            const sockaddr_in* source);
+
+  uint16_t port_ = 0;
+  std::unique_ptr<trainer_network_core::MdnsResponder> responder_;
+
+  int epoll_fd_ = -1;
+  int stop_fd_ = -1;
+  int socket_fd_ = -1;
+
+  // Guards instance_, which the server thread updates on renames.
+  std::mutex mutex_;
+  std::string instance_;
+
+  std::thread thread_;
+};
+
+}  // namespace trainer_network
+
+#endif  // TRAINER_NETWORK_MDNS_SERVER_H_
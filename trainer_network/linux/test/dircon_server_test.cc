@@ -0,0 +1,260 @@
+#include "dircon_server.h"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace trainer_network {
+namespace test {
+
+namespace {
+
+using trainer_network_core::DirConService;
+using trainer_network_core::DirConUuid;
+using trainer_network_core::kDirConPropertyNotify;
+using trainer_network_core::kDirConPropertyWrite;
+
+using Bytes = std::vector<uint8_t>;
+
+constexpr std::chrono::seconds kTimeout(5);
+
+Bytes FromHex(const std::string& hex) {
+  Bytes bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+  }
+  return bytes;
+}
+
+DirConUuid Uuid(const std::string& hex) {
+  DirConUuid uuid{};
+  Bytes bytes = FromHex(hex);
+  std::copy(bytes.begin(), bytes.end(), uuid.begin());
+  return uuid;
+}
+
+const std::string kRideService = "0000fc8200001000800000805f9b34fb";
+const std::string kAsync = "0000000219ca465186e5fa29dcdd09d1";
+const std::string kSyncRx = "0000000319ca465186e5fa29dcdd09d1";
+const std::string kSyncTx = "0000000419ca465186e5fa29dcdd09d1";
+
+std::vector<DirConService> RideServices() {
+  return {{Uuid(kRideService),
+           {{Uuid(kSyncRx), kDirConPropertyWrite},
+            {Uuid(kAsync), kDirConPropertyNotify},
+            {Uuid(kSyncTx), kDirConPropertyNotify}}}};
+}
+
+// What Zwift sends after connecting, and what it gets back.
+const std::string kHandshake = "010100000000" "010201000010" + kRideService + "010502000011" +
+                               kAsync + "01" "010403000016" + kSyncRx + "526964654f6e";
+const std::string kHandshakeAnswers =
+    "010100000010" + kRideService + "010201000043" + kRideService + kSyncRx + "02" + kAsync +
+    "04" + kSyncTx + "04" "010502000010" + kAsync + "010403000010" + kSyncRx;
+
+// Collects what the server thread reports.
+class Recorder {
+ public:
+  DirConServer::ConnectionCallback connection_callback() {
+    return [this](uint32_t connection, const std::string& address, bool connected) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      connections_.emplace_back(connection, address, connected);
+      condition_.notify_all();
+    };
+  }
+
+  // Answers RideOn like the app does, with a notification from the server
+  // thread.
+  DirConServer::WriteCallback write_callback(DirConServer** server) {
+    return [this, server](uint32_t connection, const DirConUuid& characteristic, Bytes data) {
+      if (data == FromHex("526964654f6e")) {
+        Bytes answer = FromHex("526964654f6e0203");
+        (*server)->Notify(Uuid(kSyncTx).data(), answer.data(), answer.size());
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      writes_.emplace_back(characteristic, std::move(data));
+      condition_.notify_all();
+    };
+  }
+
+  bool WaitFor(size_t connections, size_t writes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, kTimeout, [&] {
+      return connections_.size() >= connections && writes_.size() >= writes;
+    });
+  }
+
+  std::vector<std::tuple<uint32_t, std::string, bool>> connections() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connections_;
+  }
+
+  std::vector<std::pair<DirConUuid, Bytes>> writes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<std::tuple<uint32_t, std::string, bool>> connections_;
+  std::vector<std::pair<DirConUuid, Bytes>> writes_;
+};
+
+// A client on the loopback interface.
+class Client {
+ public:
+  explicit Client(uint16_t port) {
+    fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    connected_ = connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    // So that every byte written goes out in a segment of its own.
+    int on = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  }
+
+  ~Client() { Close(); }
+
+  bool connected() const { return connected_; }
+
+  void Write(const Bytes& bytes) {
+    ASSERT_EQ(write(fd_, bytes.data(), bytes.size()), static_cast<ssize_t>(bytes.size()));
+  }
+
+  // Reads |size| bytes, or what arrived before the timeout.
+  Bytes Read(size_t size) {
+    Bytes bytes(size);
+    size_t received = 0;
+    while (received < size) {
+      pollfd ready = {fd_, POLLIN, 0};
+      if (poll(&ready, 1, std::chrono::milliseconds(kTimeout).count()) <= 0) {
+        break;
+      }
+      ssize_t count = read(fd_, bytes.data() + received, size - received);
+      if (count <= 0) {
+        break;
+      }
+      received += count;
+    }
+    bytes.resize(received);
+    return bytes;
+  }
+
+  void Close() {
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+ private:
+  int fd_ = -1;
+  bool connected_ = false;
+};
+
+}  // namespace
+
+class DirConServerTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(server_.Start(0, RideServices())); }
+
+  Recorder recorder_;
+  DirConServer* self_ = &server_;
+  DirConServer server_{recorder_.connection_callback(), recorder_.write_callback(&self_)};
+};
+
+TEST_F(DirConServerTest, AnswersMessagesWrittenByteByByte) {
+  Client client(server_.port());
+  ASSERT_TRUE(client.connected());
+  for (uint8_t byte : FromHex(kHandshake)) {
+    client.Write({byte});
+  }
+  Bytes expected = FromHex(kHandshakeAnswers);
+  EXPECT_EQ(client.Read(expected.size()), expected);
+  // The RideOn answer, sent from the write callback.
+  Bytes notification = FromHex("010600000018" + kSyncTx + "526964654f6e0203");
+  EXPECT_EQ(client.Read(notification.size()), notification);
+
+  ASSERT_TRUE(recorder_.WaitFor(1, 1));
+  auto connections = recorder_.connections();
+  EXPECT_EQ(std::get<1>(connections[0]), "127.0.0.1");
+  EXPECT_TRUE(std::get<2>(connections[0]));
+  auto writes = recorder_.writes();
+  EXPECT_EQ(writes[0].first, Uuid(kSyncRx));
+  EXPECT_EQ(writes[0].second, FromHex("526964654f6e"));
+}
+
+TEST_F(DirConServerTest, AnswersMessagesWrittenAtOnce) {
+  Client client(server_.port());
+  ASSERT_TRUE(client.connected());
+  client.Write(FromHex(kHandshake));
+  Bytes expected = FromHex(kHandshakeAnswers);
+  EXPECT_EQ(client.Read(expected.size()), expected);
+  ASSERT_TRUE(recorder_.WaitFor(1, 1));
+}
+
+TEST_F(DirConServerTest, NotifiesEveryClient) {
+  Client first(server_.port());
+  Client second(server_.port());
+  ASSERT_TRUE(recorder_.WaitFor(2, 0));
+
+  Bytes data = FromHex("2308");
+  EXPECT_EQ(server_.Notify(Uuid(kAsync).data(), data.data(), data.size()), 2);
+  Bytes notification = FromHex("010600000012" + kAsync + "2308");
+  EXPECT_EQ(first.Read(notification.size()), notification);
+  EXPECT_EQ(second.Read(notification.size()), notification);
+
+  first.Close();
+  ASSERT_TRUE(recorder_.WaitFor(3, 0));
+  auto connections = recorder_.connections();
+  EXPECT_EQ(std::get<0>(connections[2]), std::get<0>(connections[0]));
+  EXPECT_FALSE(std::get<2>(connections[2]));
+  EXPECT_EQ(server_.Notify(Uuid(kAsync).data(), data.data(), data.size()), 1);
+  EXPECT_EQ(second.Read(notification.size()), FromHex("010601000012" + kAsync + "2308"));
+
+  Bytes too_long(UINT16_MAX, 0);
+  EXPECT_EQ(server_.Notify(Uuid(kAsync).data(), too_long.data(), too_long.size()), -1);
+}
+
+TEST_F(DirConServerTest, DropsClientsThatDoNotRead) {
+  Client client(server_.port());
+  ASSERT_TRUE(recorder_.WaitFor(1, 0));
+  // Far more than the socket buffers and the queue take together.
+  Bytes data(UINT16_MAX - 16, 0x55);
+  for (int i = 0; i < 1000 && recorder_.connections().size() < 2; i++) {
+    server_.Notify(Uuid(kAsync).data(), data.data(), data.size());
+  }
+  ASSERT_TRUE(recorder_.WaitFor(2, 0));
+  EXPECT_FALSE(std::get<2>(recorder_.connections()[1]));
+  EXPECT_EQ(server_.Notify(Uuid(kAsync).data(), data.data(), data.size()), 0);
+}
+
+TEST_F(DirConServerTest, ReportsNothingOnceStopped) {
+  Client client(server_.port());
+  ASSERT_TRUE(recorder_.WaitFor(1, 0));
+  server_.Stop();
+  EXPECT_EQ(server_.port(), 0);
+  // Disconnected, without a callback.
+  EXPECT_EQ(client.Read(1), Bytes());
+  EXPECT_EQ(recorder_.connections().size(), 1u);
+  EXPECT_TRUE(recorder_.writes().empty());
+}
+
+}  // namespace test
+}  // namespace trainer_network
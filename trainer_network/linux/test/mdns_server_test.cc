@@ -0,0 +1,196 @@
+#include "mdns_server.h"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace trainer_network {
+namespace test {
+
+namespace {
+
+using trainer_network_core::EncodeMdnsName;
+using trainer_network_core::kMdnsGroup;
+using trainer_network_core::kMdnsTypeSrv;
+using trainer_network_core::MdnsInterface;
+using trainer_network_core::MdnsMessage;
+using trainer_network_core::MdnsName;
+using trainer_network_core::MdnsServiceInfo;
+using trainer_network_core::ParseMdnsMessage;
+
+using Bytes = std::vector<uint8_t>;
+
+constexpr std::chrono::seconds kTimeout(5);
+constexpr int kRetryMs = 250;
+
+MdnsServiceInfo Kickr() {
+  MdnsServiceInfo service;
+  service.instance = "KICKR BIKE PRO 1337";
+  service.type = "_wahoo-fitness-tnp._tcp";
+  service.host = "bikecontrol";
+  service.port = 36867;
+  service.txt = {{"ble-service-uuids", {'F', 'C', '8', '2'}}};
+  return service;
+}
+
+MdnsName InstanceName() {
+  return EncodeMdnsName({"KICKR BIKE PRO 1337", "_wahoo-fitness-tnp", "_tcp", "local"});
+}
+
+uint32_t Loopback() {
+  return if_nametoindex("lo");
+}
+
+// The responder answers on loopback only, and on a port of its own, so that
+// it neither reaches the network nor clashes with Avahi.
+std::vector<MdnsInterface> LoopbackOnly() {
+  return {{Loopback(), {127, 0, 0, 1}}};
+}
+
+uint16_t FreePort() {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  socklen_t size = sizeof(address);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&address), &size);
+  close(fd);
+  return ntohs(address.sin_port);
+}
+
+sockaddr_in Group(uint16_t port) {
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  std::memcpy(&address.sin_addr.s_addr, kMdnsGroup.data(), kMdnsGroup.size());
+  address.sin_port = htons(port);
+  return address;
+}
+
+// A UDP socket on loopback, bound to |port| next to the server, or to a
+// port of its own with 0.
+class Socket {
+ public:
+  explicit Socket(uint16_t port) {
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    int on = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ip_mreqn request = {};
+    request.imr_ifindex = static_cast<int>(Loopback());
+    setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &request, sizeof(request));
+  }
+
+  ~Socket() { close(fd_); }
+
+  bool JoinGroup() {
+    ip_mreqn request = {};
+    request.imr_multiaddr = Group(0).sin_addr;
+    request.imr_ifindex = static_cast<int>(Loopback());
+    return setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0;
+  }
+
+  void SendToGroup(uint16_t port, const Bytes& data) {
+    sockaddr_in group = Group(port);
+    ASSERT_EQ(sendto(fd_, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&group),
+                     sizeof(group)),
+              static_cast<ssize_t>(data.size()));
+  }
+
+  // The next message that arrives within |timeout_ms|, parsed.
+  bool Receive(MdnsMessage* message, int timeout_ms) {
+    pollfd ready = {fd_, POLLIN, 0};
+    if (poll(&ready, 1, timeout_ms) <= 0) {
+      return false;
+    }
+    uint8_t buffer[9000];
+    ssize_t size = recv(fd_, buffer, sizeof(buffer), 0);
+    return size > 0 && ParseMdnsMessage(buffer, static_cast<size_t>(size), message);
+  }
+
+ private:
+  int fd_;
+};
+
+// A one-shot query for the SRV record of the instance, as dig sends it.
+Bytes SrvQuery() {
+  Bytes query = {0x12, 0x34, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0};
+  MdnsName name = InstanceName();
+  query.insert(query.end(), name.begin(), name.end());
+  query.insert(query.end(), {0, kMdnsTypeSrv, 0, 1});
+  return query;
+}
+
+}  // namespace
+
+TEST(MdnsServer, AnswersOneShotQueries) {
+  uint16_t port = FreePort();
+  MdnsServer server;
+  ASSERT_TRUE(server.Start(Kickr(), LoopbackOnly(), port));
+  EXPECT_EQ(server.instance(), "KICKR BIKE PRO 1337");
+
+  // Nothing is answered until the service is announced, so ask again until
+  // it is.
+  Socket client(0);
+  MdnsMessage answer;
+  bool answered = false;
+  auto give_up = std::chrono::steady_clock::now() + kTimeout;
+  while (!answered && std::chrono::steady_clock::now() < give_up) {
+    client.SendToGroup(port, SrvQuery());
+    answered = client.Receive(&answer, kRetryMs);
+  }
+  ASSERT_TRUE(answered);
+  EXPECT_EQ(answer.id, 0x1234);
+  ASSERT_EQ(answer.answers.size(), 1u);
+  EXPECT_EQ(answer.answers[0].name, InstanceName());
+  EXPECT_EQ(answer.answers[0].rdata[4] << 8 | answer.answers[0].rdata[5], 36867);
+  ASSERT_EQ(answer.additionals.size(), 1u);
+  EXPECT_EQ(answer.additionals[0].rdata, (Bytes{127, 0, 0, 1}));
+}
+
+TEST(MdnsServer, ProbesAnnouncesAndSaysGoodbye) {
+  uint16_t port = FreePort();
+  Socket listener(port);
+  if (!listener.JoinGroup()) {
+    GTEST_SKIP() << "Loopback does not take multicast here";
+  }
+  MdnsServer server;
+  ASSERT_TRUE(server.Start(Kickr(), LoopbackOnly(), port));
+
+  std::vector<bool> responses;
+  MdnsMessage message;
+  int timeout_ms = std::chrono::milliseconds(kTimeout).count();
+  while (responses.size() < 5 && listener.Receive(&message, timeout_ms)) {
+    responses.push_back(message.is_response());
+    if (message.is_response()) {
+      EXPECT_EQ(message.answers.size(), 5u);
+    } else {
+      EXPECT_EQ(message.questions[0].name, InstanceName());
+    }
+  }
+  EXPECT_EQ(responses, (std::vector<bool>{false, false, false, true, true}));
+
+  server.Stop();
+  EXPECT_EQ(server.instance(), "");
+  ASSERT_TRUE(listener.Receive(&message, timeout_ms));
+  ASSERT_TRUE(message.is_response());
+  for (const auto& record : message.answers) {
+    EXPECT_EQ(record.ttl, 0u);
+  }
+}
+
+}  // namespace test
+}  // namespace trainer_network
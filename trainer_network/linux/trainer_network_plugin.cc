@@ -0,0 +1,309 @@
+#include "include/trainer_network/trainer_network_plugin.h"
+
+#include <flutter_linux/flutter_linux.h>
+#include <gtk/gtk.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dircon_server.h"
+#include "mdns_server.h"
+#include "trainer_network_core/ffi_bridge.h"
+
+using trainer_network::DirConServer;
+using trainer_network::MdnsServer;
+using trainer_network_core::DirConCharacteristic;
+using trainer_network_core::DirConService;
+using trainer_network_core::DirConUuid;
+using trainer_network_core::kDirConUuidSize;
+using trainer_network_core::MdnsServiceInfo;
+
+const char kChannelName[] = "trainer_network";
+const char kDirConConnectionChannelName[] = "trainer_network_dircon_connections";
+const char kDirConWriteChannelName[] = "trainer_network_dircon_writes";
+const char kStartDirCon[] = "startDirCon";
+const char kStopDirCon[] = "stopDirCon";
+const char kPortKey[] = "port";
+const char kServicesKey[] = "services";
+const char kUuidKey[] = "uuid";
+const char kCharacteristicsKey[] = "characteristics";
+const char kPropertiesKey[] = "properties";
+const char kStartMdns[] = "startMdns";
+const char kStopMdns[] = "stopMdns";
+const char kNameKey[] = "name";
+const char kTypeKey[] = "type";
+const char kHostKey[] = "host";
+const char kTxtKey[] = "txt";
+
+struct _FlTrainerNetworkPlugin {
+  GObject parent_instance;
+
+  FlPluginRegistrar* registrar;
+
+  // Connection to Flutter engine.
+  FlMethodChannel* channel;
+
+  // Send the clients of |dircon_server| that connect or disconnect, and what
+  // they write to characteristics, as maps.
+  FlEventChannel* dircon_connection_channel;
+  FlEventChannel* dircon_write_channel;
+
+  // Runs between startDirCon and stopDirCon. Serves tn_dircon_notify through
+  // the FFI bridge while installed.
+  DirConServer* dircon_server;
+
+  // Advertises a service between startMdns and stopMdns.
+  MdnsServer* mdns_server;
+};
+
+// A message for |channel| on its way from a thread to the main loop.
+typedef struct {
+  FlTrainerNetworkPlugin* plugin;
+  // Points into |plugin|, which clears it on dispose.
+  FlEventChannel** channel;
+  FlValue* value;
+} ChannelMessage;
+
+G_DEFINE_TYPE(FlTrainerNetworkPlugin, fl_trainer_network_plugin, g_object_get_type())
+
+static gboolean send_channel_message_cb(gpointer user_data) {
+  ChannelMessage* message = static_cast<ChannelMessage*>(user_data);
+  if (*message->channel == nullptr)
+    return G_SOURCE_REMOVE;
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(*message->channel, message->value, nullptr, &error))
+    g_warning("Failed to send channel message: %s", error->message);
+  return G_SOURCE_REMOVE;
+}
+
+static void channel_message_free(gpointer user_data) {
+  ChannelMessage* message = static_cast<ChannelMessage*>(user_data);
+  fl_value_unref(message->value);
+  g_object_unref(message->plugin);
+  delete message;
+}
+
+// Queues |value| for |channel| of |self|, taking ownership of it.
+// Thread-safe.
+static void queue_channel_message(FlTrainerNetworkPlugin* self, FlEventChannel** channel,
+                                  FlValue* value) {
+  ChannelMessage* message =
+      new ChannelMessage{FL_TRAINER_NETWORK_PLUGIN(g_object_ref(self)), channel, value};
+  g_idle_add_full(G_PRIORITY_DEFAULT, send_channel_message_cb, message, channel_message_free);
+}
+
+// Reads the 16-byte UUID |key| of the map |args| into |uuid|.
+static gboolean get_uuid_arg(FlValue* args, const char* key, DirConUuid* uuid) {
+  FlValue* arg = fl_value_get_type(args) == FL_VALUE_TYPE_MAP ? fl_value_lookup_string(args, key)
+                                                               : nullptr;
+  if (arg == nullptr || fl_value_get_type(arg) != FL_VALUE_TYPE_UINT8_LIST ||
+      fl_value_get_length(arg) != kDirConUuidSize)
+    return FALSE;
+  memcpy(uuid->data(), fl_value_get_uint8_list(arg), kDirConUuidSize);
+  return TRUE;
+}
+
+// Reads the services of startDirCon: maps of a UUID and a list of
+// characteristics, which are maps of a UUID and properties.
+static gboolean get_dircon_services(FlValue* args, std::vector<DirConService>* services) {
+  FlValue* list = fl_value_lookup_string(args, kServicesKey);
+  if (list == nullptr || fl_value_get_type(list) != FL_VALUE_TYPE_LIST)
+    return FALSE;
+  for (size_t i = 0; i < fl_value_get_length(list); i++) {
+    FlValue* entry = fl_value_get_list_value(list, i);
+    DirConService service;
+    FlValue* characteristics = fl_value_get_type(entry) == FL_VALUE_TYPE_MAP
+                                   ? fl_value_lookup_string(entry, kCharacteristicsKey)
+                                   : nullptr;
+    if (!get_uuid_arg(entry, kUuidKey, &service.uuid) || characteristics == nullptr ||
+        fl_value_get_type(characteristics) != FL_VALUE_TYPE_LIST)
+      return FALSE;
+    for (size_t j = 0; j < fl_value_get_length(characteristics); j++) {
+      FlValue* value = fl_value_get_list_value(characteristics, j);
+      DirConCharacteristic characteristic;
+      if (!get_uuid_arg(value, kUuidKey, &characteristic.uuid))
+        return FALSE;
+      FlValue* properties = fl_value_lookup_string(value, kPropertiesKey);
+      if (properties == nullptr || fl_value_get_type(properties) != FL_VALUE_TYPE_INT ||
+          fl_value_get_int(properties) < 0 || fl_value_get_int(properties) > G_MAXUINT8)
+        return FALSE;
+      characteristic.properties = static_cast<uint8_t>(fl_value_get_int(properties));
+      service.characteristics.push_back(characteristic);
+    }
+    services->push_back(std::move(service));
+  }
+  return TRUE;
+}
+
+// Serves the services of |args| on its port, 0 for a free one, and returns
+// the port.
+static FlMethodResponse* start_dircon(FlTrainerNetworkPlugin* self, FlValue* args) {
+  FlValue* port = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                      ? fl_value_lookup_string(args, kPortKey)
+                      : nullptr;
+  std::vector<DirConService> services;
+  if (port == nullptr || fl_value_get_type(port) != FL_VALUE_TYPE_INT ||
+      fl_value_get_int(port) < 0 || fl_value_get_int(port) > G_MAXUINT16 ||
+      !get_dircon_services(args, &services)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "port and services arguments are required", nullptr));
+  }
+
+  if (!self->dircon_server->Start(static_cast<uint16_t>(fl_value_get_int(port)),
+                                  std::move(services))) {
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("UNAVAILABLE", "the port cannot be listened on", nullptr));
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_int(self->dircon_server->port())));
+}
+
+// Reads the string |key| of the map |args| into |value|.
+static gboolean get_string_arg(FlValue* args, const char* key, std::string* value) {
+  FlValue* arg = fl_value_lookup_string(args, key);
+  if (arg == nullptr || fl_value_get_type(arg) != FL_VALUE_TYPE_STRING)
+    return FALSE;
+  *value = fl_value_get_string(arg);
+  return TRUE;
+}
+
+// Advertises the service of |args| over multicast DNS: its name, type, port,
+// optionally the host name of the target, and TXT entries mapping keys to
+// bytes. Returns the name, which is changed later if another host has it.
+static FlMethodResponse* start_mdns(FlTrainerNetworkPlugin* self, FlValue* args) {
+  MdnsServiceInfo service;
+  FlValue* port = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                      ? fl_value_lookup_string(args, kPortKey)
+                      : nullptr;
+  FlValue* txt = port != nullptr ? fl_value_lookup_string(args, kTxtKey) : nullptr;
+  gboolean valid = port != nullptr && fl_value_get_type(port) == FL_VALUE_TYPE_INT &&
+                   fl_value_get_int(port) > 0 && fl_value_get_int(port) <= G_MAXUINT16 &&
+                   get_string_arg(args, kNameKey, &service.instance) &&
+                   get_string_arg(args, kTypeKey, &service.type) && !service.instance.empty() &&
+                   (txt == nullptr || fl_value_get_type(txt) == FL_VALUE_TYPE_MAP);
+  for (size_t i = 0; valid && txt != nullptr && i < fl_value_get_length(txt); i++) {
+    FlValue* key = fl_value_get_map_key(txt, i);
+    FlValue* value = fl_value_get_map_value(txt, i);
+    if (fl_value_get_type(key) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(value) != FL_VALUE_TYPE_UINT8_LIST) {
+      valid = FALSE;
+      break;
+    }
+    const uint8_t* bytes = fl_value_get_uint8_list(value);
+    service.txt.emplace_back(fl_value_get_string(key),
+                             std::vector<uint8_t>(bytes, bytes + fl_value_get_length(value)));
+  }
+  if (!valid) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGUMENT", "name, type and port arguments are required", nullptr));
+  }
+  if (!get_string_arg(args, kHostKey, &service.host) || service.host.empty()) {
+    // The first label of the host name, as .local is appended.
+    service.host = g_get_host_name();
+    service.host = service.host.substr(0, service.host.find('.'));
+  }
+  service.port = static_cast<uint16_t>(fl_value_get_int(port));
+
+  if (!self->mdns_server->Start(std::move(service))) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "UNAVAILABLE", "no interface takes multicast DNS", nullptr));
+  }
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_string(self->mdns_server->instance().c_str())));
+}
+
+// Called when a method call is received from Flutter.
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  FlTrainerNetworkPlugin* self = FL_TRAINER_NETWORK_PLUGIN(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (strcmp(method, kStartDirCon) == 0) {
+    response = start_dircon(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kStopDirCon) == 0) {
+    self->dircon_server->Stop();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, kStartMdns) == 0) {
+    response = start_mdns(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, kStopMdns) == 0) {
+    self->mdns_server->Stop();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error))
+    g_warning("Failed to send method call response: %s", error->message);
+}
+
+static void fl_trainer_network_plugin_dispose(GObject* object) {
+  FlTrainerNetworkPlugin* self = FL_TRAINER_NETWORK_PLUGIN(object);
+  if (self->dircon_server != nullptr) {
+    trainer_network_core::UninstallDirConNotifier(self->dircon_server);
+    // Joins the server thread. Messages already scheduled hold a reference,
+    // so this runs after them.
+    delete self->dircon_server;
+    self->dircon_server = nullptr;
+  }
+  // Says goodbye if the service was announced.
+  delete self->mdns_server;
+  self->mdns_server = nullptr;
+  g_clear_object(&self->dircon_connection_channel);
+  g_clear_object(&self->dircon_write_channel);
+
+  G_OBJECT_CLASS(fl_trainer_network_plugin_parent_class)->dispose(object);
+}
+
+static void fl_trainer_network_plugin_class_init(FlTrainerNetworkPluginClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = fl_trainer_network_plugin_dispose;
+}
+
+FlTrainerNetworkPlugin* fl_trainer_network_plugin_new(FlPluginRegistrar* registrar) {
+  FlTrainerNetworkPlugin* self =
+      FL_TRAINER_NETWORK_PLUGIN(g_object_new(fl_trainer_network_plugin_get_type(), nullptr));
+
+  self->registrar = FL_PLUGIN_REGISTRAR(g_object_ref(registrar));
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel = fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar), kChannelName,
+                                        FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->channel, method_call_cb, g_object_ref(self),
+                                            g_object_unref);
+  self->dircon_connection_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           kDirConConnectionChannelName, FL_METHOD_CODEC(codec));
+  self->dircon_write_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                                    kDirConWriteChannelName, FL_METHOD_CODEC(codec));
+  // Both called on the server thread.
+  self->dircon_server = new DirConServer(
+      [self](uint32_t connection, const std::string& address, bool connected) {
+        FlValue* value = fl_value_new_map();
+        fl_value_set_string_take(value, "connection", fl_value_new_int(connection));
+        fl_value_set_string_take(value, "address", fl_value_new_string(address.c_str()));
+        fl_value_set_string_take(value, "connected", fl_value_new_bool(connected));
+        queue_channel_message(self, &self->dircon_connection_channel, value);
+      },
+      [self](uint32_t connection, const DirConUuid& characteristic, std::vector<uint8_t> data) {
+        FlValue* value = fl_value_new_map();
+        fl_value_set_string_take(value, "connection", fl_value_new_int(connection));
+        fl_value_set_string_take(value, "characteristic",
+                                 fl_value_new_uint8_list(characteristic.data(), kDirConUuidSize));
+        fl_value_set_string_take(value, "data", fl_value_new_uint8_list(data.data(), data.size()));
+        queue_channel_message(self, &self->dircon_write_channel, value);
+      });
+  trainer_network_core::InstallDirConNotifier(self->dircon_server);
+  self->mdns_server = new MdnsServer();
+
+  return self;
+}
+
+static void fl_trainer_network_plugin_init(FlTrainerNetworkPlugin* self) {}
+
+void trainer_network_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  FlTrainerNetworkPlugin* plugin = fl_trainer_network_plugin_new(registrar);
+  g_object_unref(plugin);
+}
@@ -0,0 +1,175 @@
+#include "trainer_network_core/dircon_session.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace trainer_network_core {
+
+namespace {
+
+bool SameUuid(const DirConUuid& uuid, const uint8_t* other) {
+  return std::memcmp(uuid.data(), other, kDirConUuidSize) == 0;
+}
+
+}  // namespace
+
+DirConHeader ReadDirConHeader(const uint8_t* data) {
+  return {data[0], data[1], data[2], data[3],
+          static_cast<uint16_t>(data[4] << 8 | data[5])};
+}
+
+void WriteDirConHeader(const DirConHeader& header, uint8_t* out) {
+  out[0] = header.version;
+  out[1] = header.message;
+  out[2] = header.sequence;
+  out[3] = header.response_code;
+  out[4] = static_cast<uint8_t>(header.length >> 8);
+  out[5] = static_cast<uint8_t>(header.length);
+}
+
+bool DirConFrameDecoder::TopUp(size_t wanted,
+                               const uint8_t** data,
+                               size_t* size) {
+  if (buffer_.size() >= wanted) {
+    return true;
+  }
+  size_t taken = std::min(wanted - buffer_.size(), *size);
+  buffer_.insert(buffer_.end(), *data, *data + taken);
+  *data += taken;
+  *size -= taken;
+  return buffer_.size() == wanted;
+}
+
+DirConGattTable::DirConGattTable(std::vector<DirConService> services)
+    : services_(std::move(services)) {
+  for (const DirConService& service : services_) {
+    services_body_.insert(services_body_.end(), service.uuid.begin(),
+                          service.uuid.end());
+    std::vector<uint8_t> body(service.uuid.begin(), service.uuid.end());
+    for (const DirConCharacteristic& characteristic :
+         service.characteristics) {
+      body.insert(body.end(), characteristic.uuid.begin(),
+                  characteristic.uuid.end());
+      body.push_back(characteristic.properties);
+    }
+    characteristics_bodies_.push_back(std::move(body));
+  }
+}
+
+const std::vector<uint8_t>* DirConGattTable::FindCharacteristicsBody(
+    const uint8_t* uuid) const {
+  for (size_t i = 0; i < services_.size(); i++) {
+    if (SameUuid(services_[i].uuid, uuid)) {
+      return &characteristics_bodies_[i];
+    }
+  }
+  return nullptr;
+}
+
+bool DirConGattTable::HasCharacteristic(const uint8_t* uuid) const {
+  for (const DirConService& service : services_) {
+    for (const DirConCharacteristic& characteristic :
+         service.characteristics) {
+      if (SameUuid(characteristic.uuid, uuid)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+DirConSession::DirConSession(const DirConGattTable* table, Delegate* delegate)
+    : table_(table), delegate_(delegate) {}
+
+void DirConSession::OnData(const uint8_t* data, size_t size) {
+  decoder_.Feed(data, size,
+                [this](const DirConHeader& header, const uint8_t* body) {
+                  HandleFrame(header, body);
+                });
+}
+
+bool DirConSession::Notify(const uint8_t* characteristic,
+                           const uint8_t* data,
+                           size_t size) {
+  if (size > UINT16_MAX - kDirConUuidSize) {
+    return false;
+  }
+  WriteDirConHeader(
+      {kDirConVersion, kDirConNotification, notification_sequence_++,
+       kDirConSuccess, static_cast<uint16_t>(kDirConUuidSize + size)},
+      header_);
+  DirConSpan spans[] = {{header_, kDirConHeaderSize},
+                        {characteristic, kDirConUuidSize},
+                        {data, size}};
+  delegate_->Send(spans, size == 0 ? 2 : 3);
+  return true;
+}
+
+void DirConSession::HandleFrame(const DirConHeader& header,
+                                const uint8_t* body) {
+  if (header.version != kDirConVersion) {
+    Respond(header, kDirConUnknownProtocolVersion, {nullptr, 0});
+    return;
+  }
+  if (header.message == kDirConDiscoverServices) {
+    const std::vector<uint8_t>& services = table_->services_body();
+    Respond(header, kDirConSuccess, {services.data(), services.size()});
+    return;
+  }
+  if (header.message == kDirConNotification) {
+    // Clients have nothing to notify a server of.
+    return;
+  }
+  if (header.message < kDirConDiscoverCharacteristics ||
+      header.message > kDirConEnableNotifications) {
+    Respond(header, kDirConUnknownMessageType, {nullptr, 0});
+    return;
+  }
+
+  // The rest are about one service or characteristic, whose UUID comes
+  // first and is echoed in the response.
+  size_t wanted = header.message == kDirConEnableNotifications
+                      ? kDirConUuidSize + 1
+                      : kDirConUuidSize;
+  if (header.length < wanted) {
+    Respond(header, kDirConInvalidSize, {nullptr, 0});
+    return;
+  }
+  DirConSpan uuid = {body, kDirConUuidSize};
+
+  if (header.message == kDirConDiscoverCharacteristics) {
+    const std::vector<uint8_t>* characteristics =
+        table_->FindCharacteristicsBody(body);
+    if (characteristics == nullptr) {
+      Respond(header, kDirConServiceNotFound, uuid);
+    } else {
+      Respond(header, kDirConSuccess,
+              {characteristics->data(), characteristics->size()});
+    }
+    return;
+  }
+
+  if (!table_->HasCharacteristic(body)) {
+    Respond(header, kDirConCharacteristicNotFound, uuid);
+    return;
+  }
+  // Reads are answered without a value: what is served has none to read.
+  Respond(header, kDirConSuccess, uuid);
+  if (header.message == kDirConWriteCharacteristic) {
+    delegate_->OnWrite(body, body + kDirConUuidSize,
+                       header.length - kDirConUuidSize);
+  }
+}
+
+void DirConSession::Respond(const DirConHeader& request,
+                            uint8_t response_code,
+                            DirConSpan body) {
+  WriteDirConHeader({request.version, request.message, request.sequence,
+                     response_code, static_cast<uint16_t>(body.size)},
+                    header_);
+  DirConSpan spans[] = {{header_, kDirConHeaderSize}, body};
+  delegate_->Send(spans, body.size == 0 ? 1 : 2);
+}
+
+}  // namespace trainer_network_core
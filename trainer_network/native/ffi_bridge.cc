@@ -0,0 +1,34 @@
+#include "trainer_network_core/ffi_bridge.h"
+
+namespace trainer_network_core {
+
+namespace {
+
+// Guarded by FfiBridgeMutex().
+DirConNotifier* g_dircon_notifier = nullptr;
+
+}  // namespace
+
+std::mutex& FfiBridgeMutex() {
+  // Never destroyed: tn_* may still be called while the process exits.
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+void InstallDirConNotifier(DirConNotifier* notifier) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  g_dircon_notifier = notifier;
+}
+
+void UninstallDirConNotifier(DirConNotifier* notifier) {
+  std::lock_guard<std::mutex> lock(FfiBridgeMutex());
+  if (g_dircon_notifier == notifier) {
+    g_dircon_notifier = nullptr;
+  }
+}
+
+DirConNotifier* InstalledDirConNotifier() {
+  return g_dircon_notifier;
+}
+
+}  // namespace trainer_network_core
@@ -0,0 +1,202 @@
+#ifndef TRAINER_NETWORK_CORE_DIRCON_SESSION_H_
+#define TRAINER_NETWORK_CORE_DIRCON_SESSION_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trainer_network_core {
+
+// DirCon is Wahoo's "direct connect" protocol: GATT services carried over TCP
+// instead of Bluetooth, found through mDNS as _wahoo-fitness-tnp._tcp. Every
+// message is a 6-byte header followed by a body of the length it gives:
+//
+//   version, message type, sequence number, response code, length (BE16)
+constexpr uint16_t kDirConPort = 36867;
+constexpr uint8_t kDirConVersion = 1;
+constexpr size_t kDirConHeaderSize = 6;
+constexpr size_t kDirConUuidSize = 16;
+
+enum DirConMessage : uint8_t {
+  kDirConDiscoverServices = 0x01,
+  kDirConDiscoverCharacteristics = 0x02,
+  kDirConReadCharacteristic = 0x03,
+  kDirConWriteCharacteristic = 0x04,
+  kDirConEnableNotifications = 0x05,
+  kDirConNotification = 0x06,
+};
+
+enum DirConResponseCode : uint8_t {
+  kDirConSuccess = 0,
+  kDirConUnknownMessageType = 1,
+  kDirConUnexpectedError = 2,
+  kDirConServiceNotFound = 3,
+  kDirConCharacteristicNotFound = 4,
+  kDirConOperationNotSupported = 5,
+  kDirConInvalidSize = 6,
+  kDirConUnknownProtocolVersion = 7,
+};
+
+// Properties of a characteristic, as DirCon reports them.
+enum DirConProperty : uint8_t {
+  kDirConPropertyRead = 0x01,
+  kDirConPropertyWrite = 0x02,
+  kDirConPropertyNotify = 0x04,
+};
+
+using DirConUuid = std::array<uint8_t, kDirConUuidSize>;
+
+struct DirConHeader {
+  uint8_t version;
+  uint8_t message;
+  uint8_t sequence;
+  uint8_t response_code;
+  uint16_t length;
+};
+
+DirConHeader ReadDirConHeader(const uint8_t* data);
+void WriteDirConHeader(const DirConHeader& header, uint8_t* out);
+
+// Splits a TCP stream into DirCon messages, however the reads cut it: a read
+// may end within a header or a body, or hold several messages. Messages that
+// arrive whole are handed out in place; only the bytes of one that is cut
+// off are copied, to be completed by the next reads.
+class DirConFrameDecoder {
+ public:
+  // Calls |on_frame(header, body)| for each message completed by the |size|
+  // bytes of |data|, in order. |body| is only valid during the call.
+  template <typename OnFrame>
+  void Feed(const uint8_t* data, size_t size, OnFrame&& on_frame);
+
+  // Bytes held of a message that is not complete yet.
+  size_t buffered() const { return buffer_.size(); }
+
+  void Reset() { buffer_.clear(); }
+
+ private:
+  // Moves up to |wanted| bytes in total from |data| to buffer_. Returns
+  // whether it holds them all.
+  bool TopUp(size_t wanted, const uint8_t** data, size_t* size);
+
+  std::vector<uint8_t> buffer_;
+};
+
+struct DirConCharacteristic {
+  DirConUuid uuid;
+  // DirConProperty bits.
+  uint8_t properties;
+};
+
+struct DirConService {
+  DirConUuid uuid;
+  std::vector<DirConCharacteristic> characteristics;
+};
+
+// The services a DirCon server offers. The bodies of the discovery
+// responses are built once, here, rather than for every request.
+class DirConGattTable {
+ public:
+  DirConGattTable() = default;
+  explicit DirConGattTable(std::vector<DirConService> services);
+
+  // The service UUIDs, one after the other.
+  const std::vector<uint8_t>& services_body() const { return services_body_; }
+
+  // The service UUID followed by the UUID and properties of each of its
+  // characteristics, or null if there is no service |uuid|.
+  const std::vector<uint8_t>* FindCharacteristicsBody(const uint8_t* uuid) const;
+
+  // Whether a service has a characteristic |uuid|.
+  bool HasCharacteristic(const uint8_t* uuid) const;
+
+ private:
+  std::vector<DirConService> services_;
+  std::vector<uint8_t> services_body_;
+  std::vector<std::vector<uint8_t>> characteristics_bodies_;
+};
+
+// A piece of an outgoing message. Messages are sent as a few pieces, so a
+// server can write them with one vectored write and without copying.
+struct DirConSpan {
+  const uint8_t* data;
+  size_t size;
+};
+
+// The server side of one DirCon connection, without the socket: answers
+// discovery, reads and notification requests from |table|, and hands
+// characteristic writes to the delegate. Not thread-safe.
+class DirConSession {
+ public:
+  class Delegate {
+   public:
+    virtual ~Delegate() = default;
+
+    // Sends the message made of the |count| |spans|, which are only valid
+    // during the call.
+    virtual void Send(const DirConSpan* spans, size_t count) = 0;
+
+    // The client wrote |size| bytes of |data| to |characteristic|, which has
+    // been acknowledged.
+    virtual void OnWrite(const uint8_t* characteristic,
+                         const uint8_t* data,
+                         size_t size) = 0;
+  };
+
+  // |table| and |delegate| must outlive the session.
+  DirConSession(const DirConGattTable* table, Delegate* delegate);
+
+  // Handles the bytes of the stream as they arrive, in whatever pieces.
+  void OnData(const uint8_t* data, size_t size);
+
+  // Sends a notification of |size| bytes of |data| from |characteristic|.
+  // Returns false if they do not fit a message.
+  bool Notify(const uint8_t* characteristic, const uint8_t* data, size_t size);
+
+ private:
+  void HandleFrame(const DirConHeader& header, const uint8_t* body);
+
+  // Answers |request| with |response_code| and |body|.
+  void Respond(const DirConHeader& request,
+               uint8_t response_code,
+               DirConSpan body);
+
+  const DirConGattTable* table_;
+  Delegate* delegate_;
+  DirConFrameDecoder decoder_;
+  // Reused for every message sent.
+  uint8_t header_[kDirConHeaderSize];
+  uint8_t notification_sequence_ = 0;
+};
+
+template <typename OnFrame>
+void DirConFrameDecoder::Feed(const uint8_t* data,
+                              size_t size,
+                              OnFrame&& on_frame) {
+  if (!buffer_.empty()) {
+    if (!TopUp(kDirConHeaderSize, &data, &size)) {
+      return;
+    }
+    DirConHeader header = ReadDirConHeader(buffer_.data());
+    if (!TopUp(kDirConHeaderSize + header.length, &data, &size)) {
+      return;
+    }
+    on_frame(header, buffer_.data() + kDirConHeaderSize);
+    buffer_.clear();
+  }
+  while (size >= kDirConHeaderSize) {
+    DirConHeader header = ReadDirConHeader(data);
+    size_t frame_size = kDirConHeaderSize + header.length;
+    if (size < frame_size) {
+      break;
+    }
+    on_frame(header, data + kDirConHeaderSize);
+    data += frame_size;
+    size -= frame_size;
+  }
+  buffer_.assign(data, data + size);
+}
+
+}  // namespace trainer_network_core
+
+#endif  // TRAINER_NETWORK_CORE_DIRCON_SESSION_H_
@@ -0,0 +1,43 @@
+#ifndef TRAINER_NETWORK_CORE_FFI_BRIDGE_H_
+#define TRAINER_NETWORK_CORE_FFI_BRIDGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "trainer_network_core/trainer_network_ffi.h"
+
+namespace trainer_network_core {
+
+// Sends notifications to the clients of the platform's DirCon server, see
+// dircon_session.h.
+class DirConNotifier {
+ public:
+  virtual ~DirConNotifier() = default;
+
+  // Sends |size| bytes of |data| as a notification of |characteristic|, a
+  // 16-byte UUID, to every client. Returns how many it went to, or -1 if it
+  // does not fit a message. Thread-safe.
+  virtual int Notify(const uint8_t* characteristic,
+                     const uint8_t* data,
+                     size_t size) = 0;
+};
+
+// Routes tn_dircon_notify to |notifier| until UninstallDirConNotifier(). The
+// plugin owns the notifier. Only one notifier is installed at a time; a
+// second plugin instance replaces the first.
+void InstallDirConNotifier(DirConNotifier* notifier);
+
+// Does nothing if |notifier| has been replaced since. Once this returns, no
+// tn_* call uses |notifier| any more, so it can be deleted.
+void UninstallDirConNotifier(DirConNotifier* notifier);
+
+// Held by the tn_* calls that use an installed notifier.
+std::mutex& FfiBridgeMutex();
+
+// The installed notifier, or null. FfiBridgeMutex() must be held.
+DirConNotifier* InstalledDirConNotifier();
+
+}  // namespace trainer_network_core
+
+#endif  // TRAINER_NETWORK_CORE_FFI_BRIDGE_H_
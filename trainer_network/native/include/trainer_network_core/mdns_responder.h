@@ -0,0 +1,238 @@
+#ifndef TRAINER_NETWORK_CORE_MDNS_RESPONDER_H_
+#define TRAINER_NETWORK_CORE_MDNS_RESPONDER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trainer_network_core {
+
+// Multicast DNS (RFC 6762) carries DNS messages over UDP to 224.0.0.251 on
+// port 5353, so that hosts on a link can find each other's services (DNS-SD,
+// RFC 6763) without a DNS server.
+constexpr uint16_t kMdnsPort = 5353;
+constexpr std::array<uint8_t, 4> kMdnsGroup = {224, 0, 0, 251};
+
+enum MdnsType : uint16_t {
+  kMdnsTypeA = 1,
+  kMdnsTypePtr = 12,
+  kMdnsTypeTxt = 16,
+  kMdnsTypeAaaa = 28,
+  kMdnsTypeSrv = 33,
+  kMdnsTypeAny = 255,
+};
+
+constexpr uint16_t kMdnsClassIn = 1;
+// In a question, asks for a unicast response. In a record, tells caches to
+// drop what else they hold for its name and type.
+constexpr uint16_t kMdnsClassTopBit = 0x8000;
+
+// Names are kept in wire form, uncompressed: each label prefixed with its
+// length, ending with an empty one.
+using MdnsName = std::vector<uint8_t>;
+
+// Encodes |labels|, e.g. {"_wahoo-fitness-tnp", "_tcp", "local"}. A label
+// may contain dots and spaces, as service instance names do.
+MdnsName EncodeMdnsName(const std::vector<std::string>& labels);
+
+// Compares names the way DNS does, ignoring ASCII case.
+bool SameMdnsName(const MdnsName& a, const MdnsName& b);
+
+struct MdnsQuestion {
+  MdnsName name;
+  uint16_t type;
+  // The top bit of the class, see kMdnsClassTopBit.
+  bool unicast_response;
+};
+
+struct MdnsRecord {
+  MdnsName name;
+  uint16_t type;
+  bool cache_flush;
+  uint32_t ttl;
+  // With the names in PTR and SRV data decompressed, so that records can be
+  // compared by their bytes.
+  std::vector<uint8_t> rdata;
+};
+
+struct MdnsMessage {
+  uint16_t id;
+  uint16_t flags;
+  std::vector<MdnsQuestion> questions;
+  std::vector<MdnsRecord> answers;
+  std::vector<MdnsRecord> authorities;
+  std::vector<MdnsRecord> additionals;
+
+  bool is_response() const { return (flags & 0x8000) != 0; }
+};
+
+// Parses the |size| bytes of |data|, following compression pointers.
+// Returns false if it is no well-formed DNS message.
+bool ParseMdnsMessage(const uint8_t* data, size_t size, MdnsMessage* message);
+
+// A DNS-SD service to advertise.
+struct MdnsServiceInfo {
+  // The instance name users see, e.g. "KICKR BIKE PRO 1337".
+  std::string instance;
+  // e.g. "_wahoo-fitness-tnp._tcp".
+  std::string type;
+  // The host name of the SRV target, without ".local".
+  std::string host;
+  uint16_t port = 0;
+  // TXT entries, written as key=value.
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> txt;
+};
+
+// An interface to answer on, with the IPv4 address it answers with.
+struct MdnsInterface {
+  uint32_t index;
+  std::array<uint8_t, 4> address;
+};
+
+// A message to send, to the group on |interface|, or back to the sender of
+// the query it answers.
+struct MdnsPacket {
+  uint32_t interface;
+  bool multicast;
+  std::vector<uint8_t> data;
+};
+
+// The responder of one service, without the sockets: probes for its names,
+// announces them, answers queries for them and says goodbye. Its records,
+// and the probes and announcements made of them, are built once rather than
+// for every query. Times are in microseconds on any monotonic clock. Not
+// thread-safe.
+//
+// Probing starts at once rather than after a random delay, so the service
+// is announced 750 ms after Start(). When another host answers for its
+// names, it renames itself "instance (2)" etc. and probes again.
+class MdnsResponder {
+ public:
+  // Probes are sent this far apart, and announcements one second apart.
+  static constexpr int64_t kProbeIntervalUs = 250000;
+  static constexpr int64_t kAnnounceIntervalUs = 1000000;
+  static constexpr int kProbeCount = 3;
+  static constexpr int kAnnounceCount = 2;
+  // RFC 6762 10: for records with a host name, and for the others.
+  static constexpr uint32_t kHostTtl = 120;
+  static constexpr uint32_t kServiceTtl = 4500;
+  // Unicast responses to queries not from |port| must not be cached longer.
+  static constexpr uint32_t kLegacyUnicastTtl = 10;
+
+  // Answers on |interfaces|. Queries from another port than |port| are
+  // one-shot queries, e.g. of dig, and answered like unicast DNS.
+  MdnsResponder(MdnsServiceInfo service,
+                std::vector<MdnsInterface> interfaces,
+                uint16_t port = kMdnsPort);
+
+  // Starts probing, and appends the first probes to |packets|.
+  void Start(int64_t now_us, std::vector<MdnsPacket>* packets);
+
+  // Handles the |size| bytes of |data| received on |interface| from
+  // |source_port|, and appends the answers to |packets|.
+  void OnPacket(const uint8_t* data,
+                size_t size,
+                uint32_t interface,
+                uint16_t source_port,
+                int64_t now_us,
+                std::vector<MdnsPacket>* packets);
+
+  // Appends the probes and announcements due by |now_us| to |packets|.
+  void Advance(int64_t now_us, std::vector<MdnsPacket>* packets);
+
+  // When the next probe or announcement is due, if any.
+  std::optional<int64_t> NextDeadline() const { return next_us_; }
+
+  // Appends the goodbyes, records with a TTL of 0, if anything was announced,
+  // and stops answering.
+  void Stop(std::vector<MdnsPacket>* packets);
+
+  // Whether probing is over and queries are answered.
+  bool announced() const {
+    return state_ == State::kAnnouncing || state_ == State::kAnnounced;
+  }
+
+  // The instance name, as renamed.
+  const std::string& instance() const { return instance_; }
+
+ private:
+  enum class State { kStopped, kProbing, kAnnouncing, kAnnounced };
+
+  // Bits of a set of records.
+  enum RecordBit : uint8_t {
+    kServicesPtr = 1 << 0,
+    kTypePtr = 1 << 1,
+    kSrv = 1 << 2,
+    kTxt = 1 << 3,
+    kAddress = 1 << 4,
+  };
+
+  struct CachedRecord {
+    MdnsName name;
+    uint16_t type;
+    // Whether only this host has records of its name and type.
+    bool unique;
+    uint32_t ttl;
+    std::vector<uint8_t> rdata;
+    // Name, type, class, TTL, length and data, as sent.
+    std::vector<uint8_t> wire;
+  };
+
+  // (Re)builds the records and packets from instance_ and host_.
+  void Build();
+
+  const CachedRecord& Record(RecordBit bit, size_t interface) const;
+
+  // Appends the records of |set| to |out|, as announced on |interface| but
+  // with their TTL capped at |max_ttl|, and without the cache-flush bit
+  // unless |cache_flush|.
+  void AppendRecords(uint8_t set,
+                     size_t interface,
+                     uint32_t max_ttl,
+                     bool cache_flush,
+                     std::vector<uint8_t>* out) const;
+
+  void Answer(const MdnsMessage& query,
+              size_t interface,
+              bool legacy,
+              std::vector<MdnsPacket>* packets);
+
+  // Whether |response| has records of another host for our unique names.
+  bool Conflicts(const MdnsMessage& response) const;
+
+  void Rename();
+
+  void Multicast(const std::vector<std::vector<uint8_t>>& per_interface,
+                 std::vector<MdnsPacket>* packets) const;
+
+  MdnsServiceInfo service_;
+  std::vector<MdnsInterface> interfaces_;
+  uint16_t port_;
+
+  std::string instance_;
+  std::string host_;
+  int renames_ = 0;
+
+  State state_ = State::kStopped;
+  int step_ = 0;
+  std::optional<int64_t> next_us_;
+
+  MdnsName services_name_;
+  MdnsName type_name_;
+  MdnsName instance_name_;
+  MdnsName host_name_;
+  // kServicesPtr, kTypePtr, kSrv, kTxt, then one address per interface.
+  std::vector<CachedRecord> records_;
+  // Per interface.
+  std::vector<std::vector<uint8_t>> probes_;
+  std::vector<std::vector<uint8_t>> announcements_;
+  std::vector<std::vector<uint8_t>> goodbyes_;
+};
+
+}  // namespace trainer_network_core
+
+#endif  // TRAINER_NETWORK_CORE_MDNS_RESPONDER_H_
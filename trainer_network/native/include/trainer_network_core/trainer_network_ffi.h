@@ -0,0 +1,49 @@
+#ifndef TRAINER_NETWORK_CORE_TRAINER_NETWORK_FFI_H_
+#define TRAINER_NETWORK_CORE_TRAINER_NETWORK_FFI_H_
+
+// C ABI exported by the Linux plugin for direct calls through dart:ffi, for
+// work that is too small to pay for a trip through a platform channel. Plain
+// C so the Dart bindings can be written from this header alone.
+//
+// The functions may be called from any thread and never call back into
+// Dart. They take Dart typed data directly, so they are meant to be bound as
+// leaf calls.
+//
+// Compatible changes only add functions; anything else bumps TN_ABI_VERSION.
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define TN_EXPORT __declspec(dllexport)
+#else
+#define TN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TN_ABI_VERSION 1
+
+// Results of the tn_* calls.
+enum {
+  TN_OK = 0,
+  // No plugin is registered.
+  TN_ERROR_UNAVAILABLE = -1,
+  TN_ERROR_INVALID_ARGUMENT = -2,
+};
+
+TN_EXPORT int32_t tn_abi_version(void);
+
+// Sends |size| bytes of |data| as a notification of |characteristic|, a
+// 16-byte UUID, to every client of the plugin's DirCon server. Returns how
+// many clients it went to, or an error.
+TN_EXPORT int32_t tn_dircon_notify(const uint8_t* characteristic,
+                                   const uint8_t* data,
+                                   int64_t size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TRAINER_NETWORK_CORE_TRAINER_NETWORK_FFI_H_
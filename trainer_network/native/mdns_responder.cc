@@ -0,0 +1,543 @@
+#include "trainer_network_core/mdns_responder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace trainer_network_core {
+
+namespace {
+
+constexpr size_t kHeaderSize = 12;
+constexpr size_t kMaxLabelSize = 63;
+constexpr size_t kMaxNameSize = 255;
+// Compression pointers followed for one name, so loops end.
+constexpr int kMaxPointers = 16;
+// QR and AA: an authoritative answer.
+constexpr uint16_t kResponseFlags = 0x8400;
+constexpr uint16_t kOpcodeMask = 0x7800;
+
+uint8_t LowerAscii(uint8_t c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+}
+
+void AppendU16(uint16_t value, std::vector<uint8_t>* out) {
+  out->push_back(static_cast<uint8_t>(value >> 8));
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+void AppendU32(uint32_t value, std::vector<uint8_t>* out) {
+  AppendU16(static_cast<uint16_t>(value >> 16), out);
+  AppendU16(static_cast<uint16_t>(value), out);
+}
+
+void AppendHeader(uint16_t id,
+                  uint16_t flags,
+                  uint16_t questions,
+                  uint16_t answers,
+                  uint16_t authorities,
+                  uint16_t additionals,
+                  std::vector<uint8_t>* out) {
+  for (uint16_t value :
+       {id, flags, questions, answers, authorities, additionals}) {
+    AppendU16(value, out);
+  }
+}
+
+int CountBits(uint8_t set) {
+  int count = 0;
+  for (; set != 0; set &= set - 1) {
+    count++;
+  }
+  return count;
+}
+
+std::vector<std::string> SplitLabels(const std::string& name) {
+  std::vector<std::string> labels;
+  size_t start = 0;
+  while (start <= name.size()) {
+    size_t end = name.find('.', start);
+    if (end == std::string::npos) {
+      end = name.size();
+    }
+    if (end > start) {
+      labels.push_back(name.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return labels;
+}
+
+// Reads the name at |*offset| of the message into |name|, and moves
+// |*offset| past it.
+bool ReadName(const uint8_t* data, size_t size, size_t* offset,
+              MdnsName* name) {
+  name->clear();
+  size_t position = *offset;
+  bool jumped = false;
+  int pointers = 0;
+  while (position < size) {
+    uint8_t length = data[position];
+    if ((length & 0xc0) == 0xc0) {
+      if (position + 1 >= size || ++pointers > kMaxPointers) {
+        return false;
+      }
+      if (!jumped) {
+        *offset = position + 2;
+        jumped = true;
+      }
+      position = static_cast<size_t>(length & 0x3f) << 8 | data[position + 1];
+      continue;
+    }
+    if (length > kMaxLabelSize || position + 1 + length > size) {
+      return false;
+    }
+    name->insert(name->end(), data + position, data + position + 1 + length);
+    if (name->size() > kMaxNameSize) {
+      return false;
+    }
+    position += 1 + length;
+    if (length == 0) {
+      if (!jumped) {
+        *offset = position;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadU16(const uint8_t* data, size_t size, size_t* offset,
+             uint16_t* value) {
+  if (*offset + 2 > size) {
+    return false;
+  }
+  *value = static_cast<uint16_t>(data[*offset] << 8 | data[*offset + 1]);
+  *offset += 2;
+  return true;
+}
+
+bool ReadRecord(const uint8_t* data, size_t size, size_t* offset,
+                MdnsRecord* record) {
+  uint16_t record_class;
+  uint16_t ttl_high;
+  uint16_t ttl_low;
+  uint16_t length;
+  if (!ReadName(data, size, offset, &record->name) ||
+      !ReadU16(data, size, offset, &record->type) ||
+      !ReadU16(data, size, offset, &record_class) ||
+      !ReadU16(data, size, offset, &ttl_high) ||
+      !ReadU16(data, size, offset, &ttl_low) ||
+      !ReadU16(data, size, offset, &length) || *offset + length > size) {
+    return false;
+  }
+  record->cache_flush = (record_class & kMdnsClassTopBit) != 0;
+  record->ttl = static_cast<uint32_t>(ttl_high) << 16 | ttl_low;
+
+  size_t rdata = *offset;
+  *offset += length;
+  size_t prefix = record->type == kMdnsTypeSrv ? 6 : 0;
+  if ((record->type != kMdnsTypePtr && record->type != kMdnsTypeSrv) ||
+      length < prefix) {
+    record->rdata.assign(data + rdata, data + rdata + length);
+    return true;
+  }
+  // The name may point anywhere in the message.
+  MdnsName target;
+  size_t name_offset = rdata + prefix;
+  if (!ReadName(data, size, &name_offset, &target) ||
+      name_offset > rdata + length) {
+    return false;
+  }
+  record->rdata.assign(data + rdata, data + rdata + prefix);
+  record->rdata.insert(record->rdata.end(), target.begin(), target.end());
+  return true;
+}
+
+bool ReadRecords(const uint8_t* data, size_t size, size_t* offset,
+                 uint16_t count, std::vector<MdnsRecord>* records) {
+  records->resize(count);
+  for (MdnsRecord& record : *records) {
+    if (!ReadRecord(data, size, offset, &record)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+MdnsName EncodeMdnsName(const std::vector<std::string>& labels) {
+  MdnsName name;
+  for (const std::string& label : labels) {
+    size_t length = std::min(label.size(), kMaxLabelSize);
+    name.push_back(static_cast<uint8_t>(length));
+    name.insert(name.end(), label.begin(), label.begin() + length);
+  }
+  name.push_back(0);
+  return name;
+}
+
+bool SameMdnsName(const MdnsName& a, const MdnsName& b) {
+  // Length bytes are at most 63, below any letter.
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](uint8_t x, uint8_t y) {
+           return LowerAscii(x) == LowerAscii(y);
+         });
+}
+
+bool ParseMdnsMessage(const uint8_t* data, size_t size, MdnsMessage* message) {
+  if (size < kHeaderSize) {
+    return false;
+  }
+  size_t offset = 0;
+  uint16_t counts[4];
+  ReadU16(data, size, &offset, &message->id);
+  ReadU16(data, size, &offset, &message->flags);
+  for (uint16_t& count : counts) {
+    ReadU16(data, size, &offset, &count);
+  }
+  // Questions take at least 5 bytes and records 11, so counts that do not
+  // fit are rejected before anything is allocated for them.
+  if (counts[0] * size_t{5} + (counts[1] + counts[2] + counts[3]) * size_t{11} >
+      size - kHeaderSize) {
+    return false;
+  }
+
+  message->questions.resize(counts[0]);
+  for (MdnsQuestion& question : message->questions) {
+    uint16_t question_class;
+    if (!ReadName(data, size, &offset, &question.name) ||
+        !ReadU16(data, size, &offset, &question.type) ||
+        !ReadU16(data, size, &offset, &question_class)) {
+      return false;
+    }
+    question.unicast_response = (question_class & kMdnsClassTopBit) != 0;
+  }
+  return ReadRecords(data, size, &offset, counts[1], &message->answers) &&
+         ReadRecords(data, size, &offset, counts[2], &message->authorities) &&
+         ReadRecords(data, size, &offset, counts[3], &message->additionals);
+}
+
+MdnsResponder::MdnsResponder(MdnsServiceInfo service,
+                             std::vector<MdnsInterface> interfaces,
+                             uint16_t port)
+    : service_(std::move(service)),
+      interfaces_(std::move(interfaces)),
+      port_(port),
+      instance_(service_.instance),
+      host_(service_.host) {
+  Build();
+}
+
+void MdnsResponder::Start(int64_t now_us, std::vector<MdnsPacket>* packets) {
+  state_ = State::kProbing;
+  step_ = 0;
+  next_us_ = now_us;
+  Advance(now_us, packets);
+}
+
+void MdnsResponder::OnPacket(const uint8_t* data,
+                             size_t size,
+                             uint32_t interface,
+                             uint16_t source_port,
+                             int64_t now_us,
+                             std::vector<MdnsPacket>* packets) {
+  if (state_ == State::kStopped) {
+    return;
+  }
+  size_t position = 0;
+  while (position < interfaces_.size() &&
+         interfaces_[position].index != interface) {
+    position++;
+  }
+  MdnsMessage message;
+  if (position == interfaces_.size() ||
+      !ParseMdnsMessage(data, size, &message) ||
+      (message.flags & kOpcodeMask) != 0) {
+    return;
+  }
+
+  if (message.is_response()) {
+    // Responses from elsewhere than the mDNS port are not to be trusted.
+    if (source_port == port_ && Conflicts(message)) {
+      Rename();
+      Start(now_us, packets);
+    }
+    return;
+  }
+  if (announced()) {
+    Answer(message, position, source_port != port_, packets);
+  }
+}
+
+void MdnsResponder::Advance(int64_t now_us, std::vector<MdnsPacket>* packets) {
+  while (next_us_ && *next_us_ <= now_us) {
+    if (state_ == State::kProbing && step_ < kProbeCount) {
+      Multicast(probes_, packets);
+      step_++;
+      next_us_ = now_us + kProbeIntervalUs;
+      continue;
+    }
+    if (state_ == State::kProbing) {
+      // Nobody objected to the names.
+      state_ = State::kAnnouncing;
+      step_ = 0;
+    }
+    Multicast(announcements_, packets);
+    step_++;
+    if (step_ < kAnnounceCount) {
+      next_us_ = now_us + kAnnounceIntervalUs;
+    } else {
+      state_ = State::kAnnounced;
+      next_us_.reset();
+    }
+  }
+}
+
+void MdnsResponder::Stop(std::vector<MdnsPacket>* packets) {
+  if (announced()) {
+    Multicast(goodbyes_, packets);
+  }
+  state_ = State::kStopped;
+  next_us_.reset();
+}
+
+void MdnsResponder::Build() {
+  std::vector<std::string> type_labels = SplitLabels(service_.type);
+  type_labels.push_back("local");
+  std::vector<std::string> instance_labels = {instance_};
+  instance_labels.insert(instance_labels.end(), type_labels.begin(),
+                         type_labels.end());
+  services_name_ = EncodeMdnsName({"_services", "_dns-sd", "_udp", "local"});
+  type_name_ = EncodeMdnsName(type_labels);
+  instance_name_ = EncodeMdnsName(instance_labels);
+  host_name_ = EncodeMdnsName({host_, "local"});
+
+  std::vector<uint8_t> srv;
+  AppendU16(0, &srv);  // Priority.
+  AppendU16(0, &srv);  // Weight.
+  AppendU16(service_.port, &srv);
+  srv.insert(srv.end(), host_name_.begin(), host_name_.end());
+  std::vector<uint8_t> txt;
+  for (const auto& entry : service_.txt) {
+    std::string key = entry.first + "=";
+    if (key.size() > UINT8_MAX) {
+      continue;
+    }
+    // Values that do not fit a string are cut off.
+    size_t value_size = std::min(entry.second.size(), UINT8_MAX - key.size());
+    txt.push_back(static_cast<uint8_t>(key.size() + value_size));
+    txt.insert(txt.end(), key.begin(), key.end());
+    txt.insert(txt.end(), entry.second.begin(),
+               entry.second.begin() + value_size);
+  }
+  // RFC 6763 6.1: a TXT record is never empty.
+  if (txt.empty()) {
+    txt.push_back(0);
+  }
+
+  records_ = {{services_name_, kMdnsTypePtr, false, kServiceTtl, type_name_},
+              {type_name_, kMdnsTypePtr, false, kServiceTtl, instance_name_},
+              {instance_name_, kMdnsTypeSrv, true, kHostTtl, srv},
+              {instance_name_, kMdnsTypeTxt, true, kServiceTtl, txt}};
+  for (const MdnsInterface& interface : interfaces_) {
+    records_.push_back({host_name_, kMdnsTypeA, true, kHostTtl,
+                        std::vector<uint8_t>(interface.address.begin(),
+                                             interface.address.end())});
+  }
+  for (CachedRecord& record : records_) {
+    record.wire = record.name;
+    AppendU16(record.type, &record.wire);
+    AppendU16(kMdnsClassIn, &record.wire);
+    AppendU32(record.ttl, &record.wire);
+    AppendU16(static_cast<uint16_t>(record.rdata.size()), &record.wire);
+    record.wire.insert(record.wire.end(), record.rdata.begin(),
+                       record.rdata.end());
+  }
+
+  constexpr uint8_t kAll = kServicesPtr | kTypePtr | kSrv | kTxt | kAddress;
+  probes_.assign(interfaces_.size(), {});
+  announcements_.assign(interfaces_.size(), {});
+  goodbyes_.assign(interfaces_.size(), {});
+  for (size_t i = 0; i < interfaces_.size(); i++) {
+    // Asks whether anybody has the names, and tells what this host would
+    // put there, to break ties.
+    std::vector<uint8_t>& probe = probes_[i];
+    AppendHeader(0, 0, 2, 0, 3, 0, &probe);
+    for (const MdnsName* name : {&instance_name_, &host_name_}) {
+      probe.insert(probe.end(), name->begin(), name->end());
+      AppendU16(kMdnsTypeAny, &probe);
+      AppendU16(kMdnsClassIn | kMdnsClassTopBit, &probe);
+    }
+    AppendRecords(kSrv | kTxt | kAddress, i, UINT32_MAX, false, &probe);
+
+    AppendHeader(0, kResponseFlags, 0, CountBits(kAll), 0, 0,
+                 &announcements_[i]);
+    AppendRecords(kAll, i, UINT32_MAX, true, &announcements_[i]);
+    AppendHeader(0, kResponseFlags, 0, CountBits(kAll), 0, 0, &goodbyes_[i]);
+    AppendRecords(kAll, i, 0, true, &goodbyes_[i]);
+  }
+}
+
+const MdnsResponder::CachedRecord& MdnsResponder::Record(
+    RecordBit bit,
+    size_t interface) const {
+  switch (bit) {
+    case kServicesPtr:
+      return records_[0];
+    case kTypePtr:
+      return records_[1];
+    case kSrv:
+      return records_[2];
+    case kTxt:
+      return records_[3];
+    case kAddress:
+      break;
+  }
+  return records_[4 + interface];
+}
+
+void MdnsResponder::AppendRecords(uint8_t set,
+                                  size_t interface,
+                                  uint32_t max_ttl,
+                                  bool cache_flush,
+                                  std::vector<uint8_t>* out) const {
+  for (RecordBit bit : {kServicesPtr, kTypePtr, kSrv, kTxt, kAddress}) {
+    if ((set & bit) == 0) {
+      continue;
+    }
+    const CachedRecord& record = Record(bit, interface);
+    size_t start = out->size() + record.name.size();
+    out->insert(out->end(), record.wire.begin(), record.wire.end());
+    // Patches the class and TTL that follow the name and type.
+    uint8_t* fields = out->data() + start + 2;
+    if (cache_flush && record.unique) {
+      fields[0] |= kMdnsClassTopBit >> 8;
+    }
+    uint32_t ttl = std::min(record.ttl, max_ttl);
+    for (int i = 0; i < 4; i++) {
+      fields[2 + i] = static_cast<uint8_t>(ttl >> (24 - 8 * i));
+    }
+  }
+}
+
+void MdnsResponder::Answer(const MdnsMessage& query,
+                           size_t interface,
+                           bool legacy,
+                           std::vector<MdnsPacket>* packets) {
+  uint8_t answers = 0;
+  uint8_t additionals = 0;
+  bool unicast = legacy;
+  for (const MdnsQuestion& question : query.questions) {
+    uint16_t type = question.type;
+    bool any = type == kMdnsTypeAny;
+    if (SameMdnsName(question.name, services_name_) &&
+        (any || type == kMdnsTypePtr)) {
+      answers |= kServicesPtr;
+    } else if (SameMdnsName(question.name, type_name_) &&
+               (any || type == kMdnsTypePtr)) {
+      answers |= kTypePtr;
+      additionals |= kSrv | kTxt | kAddress;
+    } else if (SameMdnsName(question.name, instance_name_)) {
+      if (any || type == kMdnsTypeSrv) {
+        answers |= kSrv;
+        additionals |= kAddress;
+      }
+      if (any || type == kMdnsTypeTxt) {
+        answers |= kTxt;
+      }
+    } else if (SameMdnsName(question.name, host_name_) &&
+               (any || type == kMdnsTypeA)) {
+      answers |= kAddress;
+    } else {
+      continue;
+    }
+    unicast = unicast || question.unicast_response;
+  }
+
+  // RFC 6762 7.1: leaves out what the querier knows for at least half the
+  // TTL.
+  for (const MdnsRecord& known : query.answers) {
+    for (RecordBit bit : {kServicesPtr, kTypePtr, kSrv, kTxt, kAddress}) {
+      const CachedRecord& record = Record(bit, interface);
+      if ((answers & bit) != 0 && known.type == record.type &&
+          known.ttl >= record.ttl / 2 && known.rdata == record.rdata &&
+          SameMdnsName(known.name, record.name)) {
+        answers &= ~bit;
+      }
+    }
+  }
+  if (answers == 0) {
+    return;
+  }
+  additionals &= ~answers;
+
+  MdnsPacket packet = {interfaces_[interface].index, !unicast, {}};
+  std::vector<uint8_t>& out = packet.data;
+  if (legacy) {
+    // Like a unicast DNS server: with the ID and questions of the query, and
+    // without mDNS's cache-flush bit.
+    AppendHeader(query.id, kResponseFlags,
+                 static_cast<uint16_t>(query.questions.size()),
+                 CountBits(answers), 0, CountBits(additionals), &out);
+    for (const MdnsQuestion& question : query.questions) {
+      out.insert(out.end(), question.name.begin(), question.name.end());
+      AppendU16(question.type, &out);
+      AppendU16(kMdnsClassIn, &out);
+    }
+    AppendRecords(answers, interface, kLegacyUnicastTtl, false, &out);
+    AppendRecords(additionals, interface, kLegacyUnicastTtl, false, &out);
+  } else {
+    AppendHeader(0, kResponseFlags, 0, CountBits(answers), 0,
+                 CountBits(additionals), &out);
+    AppendRecords(answers, interface, UINT32_MAX, true, &out);
+    AppendRecords(additionals, interface, UINT32_MAX, true, &out);
+  }
+  packets->push_back(std::move(packet));
+}
+
+bool MdnsResponder::Conflicts(const MdnsMessage& response) const {
+  for (const std::vector<MdnsRecord>* section :
+       {&response.answers, &response.authorities, &response.additionals}) {
+    for (const MdnsRecord& record : *section) {
+      // Goodbyes do not claim anything.
+      if (record.ttl == 0) {
+        continue;
+      }
+      if (SameMdnsName(record.name, instance_name_) &&
+          ((record.type == kMdnsTypeSrv &&
+            record.rdata != Record(kSrv, 0).rdata) ||
+           (record.type == kMdnsTypeTxt &&
+            record.rdata != Record(kTxt, 0).rdata))) {
+        return true;
+      }
+      if (SameMdnsName(record.name, host_name_) &&
+          record.type == kMdnsTypeA &&
+          std::none_of(records_.begin() + 4, records_.end(),
+                       [&](const CachedRecord& address) {
+                         return address.rdata == record.rdata;
+                       })) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void MdnsResponder::Rename() {
+  renames_++;
+  std::string suffix = std::to_string(renames_ + 1);
+  instance_ = service_.instance + " (" + suffix + ")";
+  host_ = service_.host + "-" + suffix;
+  Build();
+}
+
+void MdnsResponder::Multicast(
+    const std::vector<std::vector<uint8_t>>& per_interface,
+    std::vector<MdnsPacket>* packets) const {
+  for (size_t i = 0; i < interfaces_.size(); i++) {
+    packets->push_back({interfaces_[i].index, true, per_interface[i]});
+  }
+}
+
+}  // namespace trainer_network_core
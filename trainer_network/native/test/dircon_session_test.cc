@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trainer_network_core/dircon_session.h"
+#include "trainer_network_core/ffi_bridge.h"
+#include "trainer_network_core/trainer_network_ffi.h"
+
+namespace trainer_network_core {
+namespace test {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes FromHex(const std::string& hex) {
+  Bytes bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr,
+                                                   16)));
+  }
+  return bytes;
+}
+
+DirConUuid Uuid(const std::string& hex) {
+  DirConUuid uuid{};
+  Bytes bytes = FromHex(hex);
+  std::copy(bytes.begin(), bytes.end(), uuid.begin());
+  return uuid;
+}
+
+const std::string kRideService = "0000fc8200001000800000805f9b34fb";
+const std::string kAsync = "0000000219ca465186e5fa29dcdd09d1";
+const std::string kSyncRx = "0000000319ca465186e5fa29dcdd09d1";
+const std::string kSyncTx = "0000000419ca465186e5fa29dcdd09d1";
+
+// The table the app serves: the custom service of a Zwift Ride.
+DirConGattTable RideTable() {
+  return DirConGattTable(
+      {{Uuid(kRideService),
+        {{Uuid(kSyncRx), kDirConPropertyWrite},
+         {Uuid(kAsync), kDirConPropertyNotify},
+         {Uuid(kSyncTx), kDirConPropertyNotify}}}});
+}
+
+// Records what a session sends and hands on, one message per Send().
+class Recorder : public DirConSession::Delegate {
+ public:
+  void Send(const DirConSpan* spans, size_t count) override {
+    Bytes message;
+    for (size_t i = 0; i < count; i++) {
+      message.insert(message.end(), spans[i].data,
+                     spans[i].data + spans[i].size);
+    }
+    sent.push_back(std::move(message));
+  }
+
+  void OnWrite(const uint8_t* characteristic,
+               const uint8_t* data,
+               size_t size) override {
+    writes.emplace_back(Bytes(characteristic,
+                              characteristic + kDirConUuidSize),
+                        Bytes(data, data + size));
+  }
+
+  std::vector<Bytes> sent;
+  std::vector<std::pair<Bytes, Bytes>> writes;
+};
+
+// A server with one client, whose session records what it sends.
+class OneClientNotifier : public DirConNotifier {
+ public:
+  int Notify(const uint8_t* characteristic,
+             const uint8_t* data,
+             size_t size) override {
+    return session.Notify(characteristic, data, size) ? 1 : -1;
+  }
+
+  DirConGattTable table = RideTable();
+  Recorder recorder;
+  DirConSession session{&table, &recorder};
+};
+
+// What Zwift sends after connecting, as one stream.
+Bytes Handshake() {
+  Bytes stream;
+  for (const std::string& message : std::vector<std::string>{
+           "010100000000",
+           "010201000010" + kRideService,
+           "010502000011" + kAsync + "01",
+           "010403000016" + kSyncRx + "526964654f6e"}) {
+    Bytes bytes = FromHex(message);
+    stream.insert(stream.end(), bytes.begin(), bytes.end());
+  }
+  return stream;
+}
+
+// The answers to Handshake(), as the Dart server gave them.
+std::vector<Bytes> HandshakeAnswers() {
+  return {FromHex("010100000010" + kRideService),
+          FromHex("010201000043" + kRideService + kSyncRx + "02" + kAsync +
+                  "04" + kSyncTx + "04"),
+          FromHex("010502000010" + kAsync),
+          FromHex("010403000010" + kSyncRx)};
+}
+
+}  // namespace
+
+TEST(DirConFrameDecoder, HandsOutCoalescedMessagesInPlace) {
+  Bytes stream = Handshake();
+  DirConFrameDecoder decoder;
+  std::vector<std::pair<uint8_t, const uint8_t*>> frames;
+  decoder.Feed(stream.data(), stream.size(),
+               [&](const DirConHeader& header, const uint8_t* body) {
+                 frames.emplace_back(header.message, body);
+               });
+  ASSERT_EQ(frames.size(), 4u);
+  EXPECT_EQ(frames[0].first, kDirConDiscoverServices);
+  EXPECT_EQ(frames[1].first, kDirConDiscoverCharacteristics);
+  EXPECT_EQ(frames[1].second, stream.data() + 12);
+  EXPECT_EQ(frames[3].first, kDirConWriteCharacteristic);
+  EXPECT_EQ(decoder.buffered(), 0u);
+}
+
+TEST(DirConFrameDecoder, ReassemblesMessagesSplitAnywhere) {
+  Bytes stream = Handshake();
+  for (size_t split = 1; split < stream.size(); split++) {
+    DirConFrameDecoder decoder;
+    std::vector<Bytes> bodies;
+    auto on_frame = [&](const DirConHeader& header, const uint8_t* body) {
+      bodies.emplace_back(body, body + header.length);
+    };
+    decoder.Feed(stream.data(), split, on_frame);
+    decoder.Feed(stream.data() + split, stream.size() - split, on_frame);
+    ASSERT_EQ(bodies.size(), 4u) << "split at " << split;
+    EXPECT_EQ(bodies[3], FromHex(kSyncRx + "526964654f6e"))
+        << "split at " << split;
+  }
+}
+
+TEST(DirConFrameDecoder, ReassemblesMessagesReadByteByByte) {
+  Bytes stream = Handshake();
+  DirConFrameDecoder decoder;
+  std::vector<uint8_t> messages;
+  for (uint8_t byte : stream) {
+    decoder.Feed(&byte, 1, [&](const DirConHeader& header, const uint8_t*) {
+      messages.push_back(header.message);
+    });
+  }
+  EXPECT_EQ(messages, (std::vector<uint8_t>{1, 2, 5, 4}));
+  EXPECT_EQ(decoder.buffered(), 0u);
+}
+
+TEST(DirConSession, AnswersLikeTheDartServer) {
+  DirConGattTable table = RideTable();
+  Recorder recorder;
+  DirConSession session(&table, &recorder);
+  Bytes stream = Handshake();
+  session.OnData(stream.data(), stream.size());
+  EXPECT_EQ(recorder.sent, HandshakeAnswers());
+  ASSERT_EQ(recorder.writes.size(), 1u);
+  EXPECT_EQ(recorder.writes[0].first, FromHex(kSyncRx));
+  EXPECT_EQ(recorder.writes[0].second, FromHex("526964654f6e"));
+}
+
+TEST(DirConSession, ReportsWhatItDoesNotServe) {
+  DirConGattTable table = RideTable();
+  Recorder recorder;
+  DirConSession session(&table, &recorder);
+  const std::string other = "00001826" "00001000800000805f9b34fb";
+  Bytes stream = FromHex("010209000010" + other + "010309000010" + other +
+                         "01030a00000f" + kAsync.substr(2) + "01770b000000" +
+                         "020100000000");
+  session.OnData(stream.data(), stream.size());
+  EXPECT_EQ(recorder.sent,
+            (std::vector<Bytes>{FromHex("010209030010" + other),
+                                FromHex("010309040010" + other),
+                                FromHex("01030a060000"),
+                                FromHex("01770b010000"),
+                                FromHex("020100070000")}));
+  EXPECT_TRUE(recorder.writes.empty());
+}
+
+TEST(DirConSession, NumbersItsNotifications) {
+  DirConGattTable table = RideTable();
+  Recorder recorder;
+  DirConSession session(&table, &recorder);
+  Bytes uuid = FromHex(kSyncTx);
+  Bytes ride_on = FromHex("526964654f6e0203");
+  ASSERT_TRUE(session.Notify(uuid.data(), ride_on.data(), ride_on.size()));
+  ASSERT_TRUE(session.Notify(uuid.data(), nullptr, 0));
+  EXPECT_EQ(recorder.sent,
+            (std::vector<Bytes>{
+                FromHex("010600000018" + kSyncTx + "526964654f6e0203"),
+                FromHex("010601000010" + kSyncTx)}));
+
+  Bytes too_long(UINT16_MAX, 0);
+  EXPECT_FALSE(session.Notify(uuid.data(), too_long.data(), too_long.size()));
+}
+
+TEST(DirConSession, IsNotifiedThroughTheCAbi) {
+  Bytes uuid = FromHex(kSyncTx);
+  Bytes data = FromHex("0203");
+  EXPECT_EQ(tn_dircon_notify(uuid.data(), data.data(), 2),
+            TN_ERROR_UNAVAILABLE);
+
+  OneClientNotifier notifier;
+  InstallDirConNotifier(&notifier);
+  EXPECT_EQ(tn_dircon_notify(nullptr, data.data(), 2),
+            TN_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(tn_dircon_notify(uuid.data(), nullptr, 2),
+            TN_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(tn_dircon_notify(uuid.data(), data.data(), 2), 1);
+  Bytes too_long(UINT16_MAX, 0);
+  EXPECT_EQ(tn_dircon_notify(uuid.data(), too_long.data(), UINT16_MAX),
+            TN_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(notifier.recorder.sent,
+            std::vector<Bytes>{FromHex("010600000012" + kSyncTx + "0203")});
+
+  UninstallDirConNotifier(&notifier);
+  EXPECT_EQ(tn_dircon_notify(uuid.data(), data.data(), 2),
+            TN_ERROR_UNAVAILABLE);
+}
+
+}  // namespace test
+}  // namespace trainer_network_core
@@ -0,0 +1,347 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "trainer_network_core/mdns_responder.h"
+
+namespace trainer_network_core {
+namespace test {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+constexpr uint32_t kEthernet = 2;
+constexpr uint32_t kWifi = 3;
+constexpr uint16_t kOneShotPort = 40000;
+constexpr int64_t kAnnouncedUs = 750000;
+
+// The service FtmsMdnsEmulator advertises.
+MdnsServiceInfo Kickr() {
+  MdnsServiceInfo service;
+  service.instance = "KICKR BIKE PRO 1337";
+  service.type = "_wahoo-fitness-tnp._tcp";
+  service.host = "bikecontrol";
+  service.port = 36867;
+  service.txt = {{"ble-service-uuids", {'F', 'C', '8', '2'}},
+                 {"serial-number", {'2', '4', '4', '7'}}};
+  return service;
+}
+
+std::vector<MdnsInterface> TwoInterfaces() {
+  return {{kEthernet, {192, 168, 1, 20}}, {kWifi, {10, 0, 0, 7}}};
+}
+
+MdnsName TypeName() {
+  return EncodeMdnsName({"_wahoo-fitness-tnp", "_tcp", "local"});
+}
+
+MdnsName InstanceName(const std::string& instance = "KICKR BIKE PRO 1337") {
+  return EncodeMdnsName({instance, "_wahoo-fitness-tnp", "_tcp", "local"});
+}
+
+void AppendU16(uint16_t value, Bytes* out) {
+  out->push_back(static_cast<uint8_t>(value >> 8));
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+// A message of |questions| (name, type, unicast response) and |answers|.
+Bytes Message(uint16_t id,
+              uint16_t flags,
+              const std::vector<MdnsQuestion>& questions,
+              const std::vector<MdnsRecord>& answers = {}) {
+  Bytes out;
+  for (uint16_t value : {id, flags, static_cast<uint16_t>(questions.size()),
+                         static_cast<uint16_t>(answers.size()), uint16_t{0},
+                         uint16_t{0}}) {
+    AppendU16(value, &out);
+  }
+  for (const MdnsQuestion& question : questions) {
+    out.insert(out.end(), question.name.begin(), question.name.end());
+    AppendU16(question.type, &out);
+    AppendU16(question.unicast_response ? 0x8001 : 1, &out);
+  }
+  for (const MdnsRecord& record : answers) {
+    out.insert(out.end(), record.name.begin(), record.name.end());
+    AppendU16(record.type, &out);
+    AppendU16(record.cache_flush ? 0x8001 : 1, &out);
+    AppendU16(static_cast<uint16_t>(record.ttl >> 16), &out);
+    AppendU16(static_cast<uint16_t>(record.ttl), &out);
+    AppendU16(static_cast<uint16_t>(record.rdata.size()), &out);
+    out.insert(out.end(), record.rdata.begin(), record.rdata.end());
+  }
+  return out;
+}
+
+MdnsMessage Parse(const MdnsPacket& packet) {
+  MdnsMessage message;
+  EXPECT_TRUE(ParseMdnsMessage(packet.data.data(), packet.data.size(),
+                               &message));
+  return message;
+}
+
+// A responder that has announced its service.
+MdnsResponder Announced() {
+  MdnsResponder responder(Kickr(), TwoInterfaces());
+  std::vector<MdnsPacket> packets;
+  responder.Start(0, &packets);
+  while (!responder.announced()) {
+    responder.Advance(*responder.NextDeadline(), &packets);
+  }
+  return responder;
+}
+
+std::vector<MdnsPacket> Ask(MdnsResponder* responder,
+                            const Bytes& query,
+                            uint32_t interface = kEthernet,
+                            uint16_t port = kMdnsPort) {
+  std::vector<MdnsPacket> packets;
+  responder->OnPacket(query.data(), query.size(), interface, port,
+                      kAnnouncedUs + 1, &packets);
+  return packets;
+}
+
+}  // namespace
+
+TEST(MdnsMessage, ComparesNamesIgnoringCase) {
+  MdnsName name = EncodeMdnsName({"bikecontrol", "local"});
+  EXPECT_EQ(name, (Bytes{11, 'b', 'i', 'k', 'e', 'c', 'o', 'n', 't', 'r', 'o',
+                         'l', 5, 'l', 'o', 'c', 'a', 'l', 0}));
+  EXPECT_TRUE(SameMdnsName(name, EncodeMdnsName({"BikeControl", "LOCAL"})));
+  EXPECT_FALSE(SameMdnsName(name, EncodeMdnsName({"bikecontro", "local"})));
+}
+
+TEST(MdnsMessage, FollowsCompressionPointers) {
+  // A PTR answer whose name and data point back into the question.
+  Bytes message = Message(0, 0x8400, {{TypeName(), kMdnsTypePtr, false}});
+  message[7] = 1;
+  Bytes answer = {0xc0, 12};
+  AppendU16(kMdnsTypePtr, &answer);
+  AppendU16(1, &answer);
+  AppendU16(0, &answer);
+  AppendU16(4500, &answer);
+  AppendU16(8, &answer);
+  Bytes rdata = {5, 'K', 'I', 'C', 'K', 'R', 0xc0, 12};
+  answer.insert(answer.end(), rdata.begin(), rdata.end());
+  message.insert(message.end(), answer.begin(), answer.end());
+
+  MdnsMessage parsed;
+  ASSERT_TRUE(ParseMdnsMessage(message.data(), message.size(), &parsed));
+  ASSERT_EQ(parsed.answers.size(), 1u);
+  EXPECT_EQ(parsed.answers[0].name, TypeName());
+  EXPECT_EQ(parsed.answers[0].ttl, 4500u);
+  EXPECT_EQ(parsed.answers[0].rdata, InstanceName("KICKR"));
+}
+
+TEST(MdnsMessage, RejectsMalformedMessages) {
+  Bytes message = Message(0, 0, {{TypeName(), kMdnsTypePtr, false}});
+  MdnsMessage parsed;
+  // Cut off.
+  EXPECT_FALSE(ParseMdnsMessage(message.data(), message.size() - 1, &parsed));
+  // A name pointing at itself.
+  message[12] = 0xc0;
+  message[13] = 12;
+  EXPECT_FALSE(ParseMdnsMessage(message.data(), message.size(), &parsed));
+  // More records than could fit.
+  Bytes header = {0, 0, 0, 0, 0, 0, 0xff, 0xff, 0, 0, 0, 0};
+  EXPECT_FALSE(ParseMdnsMessage(header.data(), header.size(), &parsed));
+}
+
+TEST(MdnsResponder, ProbesThenAnnouncesOnEveryInterface) {
+  MdnsResponder responder(Kickr(), TwoInterfaces());
+  std::vector<MdnsPacket> packets;
+  responder.Start(0, &packets);
+  ASSERT_EQ(packets.size(), 2u);
+  EXPECT_EQ(packets[0].interface, kEthernet);
+  EXPECT_EQ(packets[1].interface, kWifi);
+  MdnsMessage probe = Parse(packets[0]);
+  EXPECT_FALSE(probe.is_response());
+  ASSERT_EQ(probe.questions.size(), 2u);
+  EXPECT_EQ(probe.questions[0].name, InstanceName());
+  EXPECT_EQ(probe.questions[0].type, kMdnsTypeAny);
+  EXPECT_TRUE(probe.questions[0].unicast_response);
+  ASSERT_EQ(probe.authorities.size(), 3u);
+  EXPECT_FALSE(probe.authorities[0].cache_flush);
+  EXPECT_EQ(probe.authorities[2].rdata, (Bytes{192, 168, 1, 20}));
+  EXPECT_FALSE(responder.announced());
+
+  std::vector<int64_t> deadlines;
+  std::vector<size_t> sent;
+  while (responder.NextDeadline()) {
+    int64_t deadline = *responder.NextDeadline();
+    deadlines.push_back(deadline);
+    packets.clear();
+    responder.Advance(deadline, &packets);
+    sent.push_back(packets.size());
+  }
+  EXPECT_EQ(deadlines,
+            (std::vector<int64_t>{250000, 500000, 750000, 1750000}));
+  EXPECT_EQ(sent, (std::vector<size_t>{2, 2, 2, 2}));
+  EXPECT_TRUE(responder.announced());
+
+  MdnsMessage announcement = Parse(packets[1]);
+  EXPECT_TRUE(announcement.is_response());
+  ASSERT_EQ(announcement.answers.size(), 5u);
+  EXPECT_FALSE(announcement.answers[0].cache_flush);
+  EXPECT_EQ(announcement.answers[1].rdata, InstanceName());
+  EXPECT_TRUE(announcement.answers[2].cache_flush);
+  EXPECT_EQ(announcement.answers[2].ttl, MdnsResponder::kHostTtl);
+  EXPECT_EQ(announcement.answers[4].rdata, (Bytes{10, 0, 0, 7}));
+}
+
+TEST(MdnsResponder, AnswersBrowsingWithTheWholeService) {
+  MdnsResponder responder = Announced();
+  std::vector<MdnsPacket> packets =
+      Ask(&responder, Message(0, 0, {{TypeName(), kMdnsTypePtr, false}}),
+          kWifi);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_TRUE(packets[0].multicast);
+  EXPECT_EQ(packets[0].interface, kWifi);
+  MdnsMessage answer = Parse(packets[0]);
+  EXPECT_EQ(answer.id, 0);
+  EXPECT_TRUE(answer.questions.empty());
+  ASSERT_EQ(answer.answers.size(), 1u);
+  EXPECT_EQ(answer.answers[0].rdata, InstanceName());
+  ASSERT_EQ(answer.additionals.size(), 3u);
+
+  Bytes srv = {0, 0, 0, 0, 0x90, 0x03};
+  MdnsName host = EncodeMdnsName({"bikecontrol", "local"});
+  srv.insert(srv.end(), host.begin(), host.end());
+  EXPECT_EQ(answer.additionals[0].rdata, srv);
+  std::string txt(answer.additionals[1].rdata.begin(),
+                  answer.additionals[1].rdata.end());
+  EXPECT_EQ(txt, "\x16" "ble-service-uuids=FC82" "\x12" "serial-number=2447");
+  // The address of the interface asked on.
+  EXPECT_EQ(answer.additionals[2].rdata, (Bytes{10, 0, 0, 7}));
+
+  packets = Ask(&responder,
+                Message(0, 0, {{EncodeMdnsName({"_services", "_dns-sd", "_udp",
+                                                "local"}),
+                                kMdnsTypePtr, false}}));
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_EQ(Parse(packets[0]).answers[0].rdata, TypeName());
+}
+
+TEST(MdnsResponder, AnswersOneShotQueriesLikeUnicastDns) {
+  MdnsResponder responder = Announced();
+  std::vector<MdnsPacket> packets = Ask(
+      &responder, Message(0x1234, 0, {{InstanceName(), kMdnsTypeSrv, false}}),
+      kEthernet, kOneShotPort);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_FALSE(packets[0].multicast);
+  MdnsMessage answer = Parse(packets[0]);
+  EXPECT_EQ(answer.id, 0x1234);
+  ASSERT_EQ(answer.questions.size(), 1u);
+  EXPECT_EQ(answer.questions[0].name, InstanceName());
+  ASSERT_EQ(answer.answers.size(), 1u);
+  EXPECT_EQ(answer.answers[0].type, kMdnsTypeSrv);
+  EXPECT_EQ(answer.answers[0].ttl, MdnsResponder::kLegacyUnicastTtl);
+  EXPECT_FALSE(answer.answers[0].cache_flush);
+  ASSERT_EQ(answer.additionals.size(), 1u);
+  EXPECT_EQ(answer.additionals[0].rdata, (Bytes{192, 168, 1, 20}));
+}
+
+TEST(MdnsResponder, AnswersUnicastWhenAsked) {
+  MdnsResponder responder = Announced();
+  std::vector<MdnsPacket> packets = Ask(
+      &responder,
+      Message(0, 0, {{EncodeMdnsName({"BIKECONTROL", "local"}), kMdnsTypeA,
+                      true}}));
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_FALSE(packets[0].multicast);
+  MdnsMessage answer = Parse(packets[0]);
+  ASSERT_EQ(answer.answers.size(), 1u);
+  EXPECT_TRUE(answer.answers[0].cache_flush);
+  EXPECT_EQ(answer.answers[0].ttl, MdnsResponder::kHostTtl);
+}
+
+TEST(MdnsResponder, LeavesOutWhatTheQuerierKnows) {
+  MdnsResponder responder = Announced();
+  MdnsQuestion browse = {TypeName(), kMdnsTypePtr, false};
+  MdnsRecord known = {TypeName(), kMdnsTypePtr, false, 4000, InstanceName()};
+  EXPECT_TRUE(Ask(&responder, Message(0, 0, {browse}, {known})).empty());
+  // Known for less than half its TTL: refreshed.
+  known.ttl = 2000;
+  EXPECT_EQ(Ask(&responder, Message(0, 0, {browse}, {known})).size(), 1u);
+}
+
+TEST(MdnsResponder, IgnoresWhatIsNotItsOwn) {
+  MdnsResponder responder = Announced();
+  EXPECT_TRUE(Ask(&responder,
+                  Message(0, 0, {{EncodeMdnsName({"_ipp", "_tcp", "local"}),
+                                  kMdnsTypePtr, false}}))
+                  .empty());
+  EXPECT_TRUE(
+      Ask(&responder, Message(0, 0, {{TypeName(), kMdnsTypePtr, false}}), 9)
+          .empty());
+
+  // Nothing is answered while probing.
+  MdnsResponder probing(Kickr(), TwoInterfaces());
+  std::vector<MdnsPacket> packets;
+  probing.Start(0, &packets);
+  EXPECT_TRUE(
+      Ask(&probing, Message(0, 0, {{TypeName(), kMdnsTypePtr, false}}))
+          .empty());
+}
+
+TEST(MdnsResponder, RenamesItselfWhenTheNameIsTaken) {
+  MdnsResponder responder(Kickr(), TwoInterfaces());
+  std::vector<MdnsPacket> packets;
+  responder.Start(0, &packets);
+
+  // Its own announcements, looped back, are no conflict.
+  MdnsResponder other(Kickr(), TwoInterfaces());
+  other.Start(0, &packets);
+  while (!other.announced()) {
+    packets.clear();
+    other.Advance(*other.NextDeadline(), &packets);
+  }
+  Bytes own = packets[0].data;
+  packets.clear();
+  responder.OnPacket(own.data(), own.size(), kEthernet, kMdnsPort, 100000,
+                     &packets);
+  EXPECT_TRUE(packets.empty());
+
+  // Another host with the same instance name on another port.
+  Bytes srv = {0, 0, 0, 0, 0x1f, 0x90, 3, 'p', 'c', '2', 5,
+               'l', 'o', 'c', 'a', 'l', 0};
+  Bytes taken = Message(0, 0x8400, {},
+                        {{InstanceName(), kMdnsTypeSrv, true, 120, srv}});
+  responder.OnPacket(taken.data(), taken.size(), kEthernet, kOneShotPort,
+                     100000, &packets);
+  EXPECT_TRUE(packets.empty());
+  responder.OnPacket(taken.data(), taken.size(), kEthernet, kMdnsPort, 100000,
+                     &packets);
+  EXPECT_EQ(responder.instance(), "KICKR BIKE PRO 1337 (2)");
+  ASSERT_EQ(packets.size(), 2u);
+  MdnsMessage probe = Parse(packets[0]);
+  EXPECT_EQ(probe.questions[0].name, InstanceName("KICKR BIKE PRO 1337 (2)"));
+  EXPECT_EQ(probe.questions[1].name,
+            EncodeMdnsName({"bikecontrol-2", "local"}));
+  EXPECT_EQ(*responder.NextDeadline(), 350000);
+}
+
+TEST(MdnsResponder, SaysGoodbyeOnceAnnounced) {
+  MdnsResponder probing(Kickr(), TwoInterfaces());
+  std::vector<MdnsPacket> packets;
+  probing.Start(0, &packets);
+  packets.clear();
+  probing.Stop(&packets);
+  EXPECT_TRUE(packets.empty());
+
+  MdnsResponder responder = Announced();
+  responder.Stop(&packets);
+  ASSERT_EQ(packets.size(), 2u);
+  for (const MdnsRecord& record : Parse(packets[0]).answers) {
+    EXPECT_EQ(record.ttl, 0u);
+  }
+  EXPECT_FALSE(responder.NextDeadline());
+  EXPECT_TRUE(
+      Ask(&responder, Message(0, 0, {{TypeName(), kMdnsTypePtr, false}}))
+          .empty());
+}
+
+}  // namespace test
+}  // namespace trainer_network_core
@@ -0,0 +1,28 @@
+#include "trainer_network_core/trainer_network_ffi.h"
+
+#include "trainer_network_core/ffi_bridge.h"
+
+extern "C" {
+
+int32_t tn_abi_version(void) {
+  return TN_ABI_VERSION;
+}
+
+int32_t tn_dircon_notify(const uint8_t* characteristic,
+                         const uint8_t* data,
+                         int64_t size) {
+  if (characteristic == nullptr || size < 0 || (data == nullptr && size > 0)) {
+    return TN_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lock(trainer_network_core::FfiBridgeMutex());
+  trainer_network_core::DirConNotifier* notifier =
+      trainer_network_core::InstalledDirConNotifier();
+  if (notifier == nullptr) {
+    return TN_ERROR_UNAVAILABLE;
+  }
+  int clients =
+      notifier->Notify(characteristic, data, static_cast<size_t>(size));
+  return clients < 0 ? TN_ERROR_INVALID_ARGUMENT : clients;
+}
+
+}  // extern "C"